@@ -72,6 +72,7 @@ if(THIRDPARTY_DIRECTORY)
     HarfBuzz
     JPEG
     LibSquish
+    LZ4
     ODE
     Ogg
     OpenAL
@@ -85,6 +86,7 @@ if(THIRDPARTY_DIRECTORY)
     VorbisFile
     VRPN
     ZLIB
+    Zstd
   )
 
     string(TOLOWER "${_Package}" _package)
@@ -340,6 +342,23 @@ package_option(ZLIB
 
 package_status(ZLIB "zlib")
 
+# LZ4
+find_package(LZ4 QUIET)
+
+package_option(LZ4
+  "Enables LZ4 compression, which is used to quickly compress vertex data
+that is paged out of memory.")
+
+package_status(LZ4 "LZ4")
+
+# Zstandard
+find_package(Zstd QUIET)
+
+package_option(Zstd
+  "Enables support for Zstandard compression of Panda assets.")
+
+package_status(Zstd "Zstandard")
+
 
 #
 # ------------ Image formats ------------
@@ -18,6 +18,7 @@
 #include "collisionSegment.h"
 #include "collisionParabola.h"
 #include "collisionCapsule.h"
+#include "collisionSweep.h"
 #include "collisionHandler.h"
 #include "collisionEntry.h"
 #include "config_collide.h"
@@ -203,6 +204,12 @@ compute_internal_bounds() const {
  */
 PT(CollisionEntry) CollisionBox::
 test_intersection_from_sphere(const CollisionEntry &entry) const {
+  if (entry.get_continuous()) {
+    PT(CollisionEntry) result;
+    if (test_swept_intersection(entry, result)) {
+      return result;
+    }
+  }
 
   const CollisionSphere *sphere;
   DCAST_INTO_R(sphere, entry.get_from(), nullptr);
@@ -629,6 +636,13 @@ test_intersection_from_segment(const CollisionEntry &entry) const {
  */
 PT(CollisionEntry) CollisionBox::
 test_intersection_from_capsule(const CollisionEntry &entry) const {
+  if (entry.get_continuous()) {
+    PT(CollisionEntry) result;
+    if (test_swept_intersection(entry, result)) {
+      return result;
+    }
+  }
+
   const CollisionCapsule *capsule;
   DCAST_INTO_R(capsule, entry.get_from(), nullptr);
 
@@ -1031,6 +1045,35 @@ fill_viz_geom() {
   _bounds_viz_geom->add_geom(geom, get_solid_bounds_viz_state());
 }
 
+/**
+ * Called in continuous mode, when the "from" object is a sphere or capsule.
+ * If it moved since the previous frame, sweeps it along its path against the
+ * box, stores a new CollisionEntry for the first contact in result, or NULL if
+ * there was none, and returns true.  Returns false if the box should be tested
+ * the usual way instead, because the "from" object didn't move, or it already
+ * touched the box at its previous position.
+ */
+bool CollisionBox::
+test_swept_intersection(const CollisionEntry &entry,
+                        PT(CollisionEntry) &result) const {
+  CollisionSweep sweep(entry);
+  if (!sweep.is_moving()) {
+    return false;
+  }
+
+  sweep.sweep_box(_min, _max);
+  if (sweep.started_inside()) {
+    return false;
+  }
+
+  result = sweep.make_entry(entry);
+  if (result != nullptr && has_effective_normal() &&
+      entry.get_from()->get_respect_effective_normal()) {
+    result->set_surface_normal(get_effective_normal());
+  }
+  return true;
+}
+
 /**
  * Determine the point(s) of intersection of a parametric line with the box.
  * The line is infinite in both directions, and passes through "from" and
@@ -95,6 +95,10 @@ protected:
                        const LPoint3 &from, const LVector3 &delta,
                        PN_stdfloat inflate_size=0) const;
 
+private:
+  bool test_swept_intersection(const CollisionEntry &entry,
+                               PT(CollisionEntry) &result) const;
+
 private:
   LPoint3 _center;
   LPoint3 _min;
@@ -0,0 +1,418 @@
+/**
+ * PANDA 3D SOFTWARE
+ * Copyright (c) Carnegie Mellon University.  All rights reserved.
+ *
+ * All use of this software is subject to the terms of the revised BSD
+ * license.  You should have received a copy of this license along
+ * with this source code in a file named "LICENSE."
+ *
+ * @file collisionBroadphase.cxx
+ * @author blablabla94
+ * @date 2026-10-17
+ */
+
+#include "collisionBroadphase.h"
+#include "config_collide.h"
+
+/**
+ *
+ */
+CollisionBroadphase::
+CollisionBroadphase() :
+  _root(-1),
+  _free_list(-1),
+  _num_proxies(0),
+  _margin(0.1f)
+{
+}
+
+/**
+ * Adds a new object with the indicated bounding box to the tree, and returns
+ * the proxy index that identifies it.  The data pointer is returned by
+ * query() for each proxy that is found; it is not otherwise used.
+ */
+int CollisionBroadphase::
+add_proxy(const LPoint3 &min_point, const LPoint3 &max_point, void *data) {
+  int proxy = alloc_node();
+  Node &node = _nodes[proxy];
+  LVector3 margin(_margin, _margin, _margin);
+  node._min = min_point - margin;
+  node._max = max_point + margin;
+  node._data = data;
+  node._height = 0;
+
+  insert_leaf(proxy);
+  ++_num_proxies;
+  return proxy;
+}
+
+/**
+ * Removes the indicated proxy, as returned by add_proxy(), from the tree.
+ */
+void CollisionBroadphase::
+remove_proxy(int proxy) {
+  nassertv(proxy >= 0 && proxy < (int)_nodes.size());
+  nassertv(_nodes[proxy].is_leaf());
+
+  remove_leaf(proxy);
+  free_node(proxy);
+  --_num_proxies;
+}
+
+/**
+ * Updates the bounding box of the indicated proxy.  If the new box still
+ * fits within the enlarged box stored in the tree, nothing needs to be done
+ * and false is returned; otherwise, the proxy is moved within the tree and
+ * true is returned.
+ */
+bool CollisionBroadphase::
+move_proxy(int proxy, const LPoint3 &min_point, const LPoint3 &max_point) {
+  nassertr(proxy >= 0 && proxy < (int)_nodes.size(), false);
+  nassertr(_nodes[proxy].is_leaf(), false);
+
+  if (_nodes[proxy].contains(min_point, max_point)) {
+    return false;
+  }
+
+  remove_leaf(proxy);
+
+  Node &node = _nodes[proxy];
+  LVector3 margin(_margin, _margin, _margin);
+
+  // Guess that the object will keep moving the same way, and enlarge the box
+  // in that direction, so that we don't have to move it again next time.
+  LVector3 displacement = ((min_point + max_point) - (node._min + node._max)) * 0.5f;
+  node._min = min_point - margin;
+  node._max = max_point + margin;
+  for (int i = 0; i < 3; ++i) {
+    if (displacement[i] < 0) {
+      node._min[i] += displacement[i] * 2.0f;
+    } else {
+      node._max[i] += displacement[i] * 2.0f;
+    }
+  }
+
+  insert_leaf(proxy);
+  return true;
+}
+
+/**
+ * Removes all proxies from the tree.
+ */
+void CollisionBroadphase::
+clear() {
+  _nodes.clear();
+  _root = -1;
+  _free_list = -1;
+  _num_proxies = 0;
+}
+
+/**
+ * Appends to the results the data pointer of each proxy whose box overlaps
+ * the indicated box.  This does not modify the tree, so it may be called
+ * from several threads at once.
+ */
+void CollisionBroadphase::
+query(const LPoint3 &min_point, const LPoint3 &max_point,
+      Results &results) const {
+  if (_root < 0) {
+    return;
+  }
+
+  // The tree is balanced, so its height is logarithmic in the number of
+  // proxies; a small stack is more than enough.
+  static const int max_stack = 256;
+  int stack[max_stack];
+  int stack_size = 0;
+  stack[stack_size++] = _root;
+
+  while (stack_size > 0) {
+    const Node &node = _nodes[stack[--stack_size]];
+    if (node.overlaps(min_point, max_point)) {
+      if (node.is_leaf()) {
+        results.push_back(node._data);
+      } else {
+        nassertv(stack_size + 2 <= max_stack);
+        stack[stack_size++] = node._child1;
+        stack[stack_size++] = node._child2;
+      }
+    }
+  }
+}
+
+/**
+ *
+ */
+void CollisionBroadphase::
+output(std::ostream &out) const {
+  out << "CollisionBroadphase, " << _num_proxies << " proxies, height "
+      << get_height();
+}
+
+/**
+ * Returns the index of an unused node, growing the node array if necessary.
+ */
+int CollisionBroadphase::
+alloc_node() {
+  int index;
+  if (_free_list >= 0) {
+    index = _free_list;
+    _free_list = _nodes[index]._parent;
+  } else {
+    index = (int)_nodes.size();
+    _nodes.push_back(Node());
+  }
+
+  Node &node = _nodes[index];
+  node._data = nullptr;
+  node._parent = -1;
+  node._child1 = -1;
+  node._child2 = -1;
+  node._height = 0;
+  return index;
+}
+
+/**
+ * Returns the indicated node to the free list.
+ */
+void CollisionBroadphase::
+free_node(int index) {
+  Node &node = _nodes[index];
+  node._parent = _free_list;
+  node._height = -1;
+  node._data = nullptr;
+  _free_list = index;
+}
+
+/**
+ * Inserts the indicated leaf into the tree, next to the existing node that
+ * makes the combined box grow the least.
+ */
+void CollisionBroadphase::
+insert_leaf(int leaf) {
+  if (_root < 0) {
+    _root = leaf;
+    _nodes[leaf]._parent = -1;
+    return;
+  }
+
+  // Walk down the tree, looking for the best sibling for the new leaf.
+  Node combined;
+  int index = _root;
+  while (!_nodes[index].is_leaf()) {
+    const Node &node = _nodes[index];
+    const Node &child1 = _nodes[node._child1];
+    const Node &child2 = _nodes[node._child2];
+
+    PN_stdfloat area = get_perimeter(node._min, node._max);
+    combined.set_union(node, _nodes[leaf]);
+    PN_stdfloat combined_area = get_perimeter(combined._min, combined._max);
+
+    // This is the cost of making a new parent for this node and the leaf.
+    PN_stdfloat cost = 2.0f * combined_area;
+
+    // This is the minimum cost of pushing the leaf further down the tree.
+    PN_stdfloat inheritance_cost = 2.0f * (combined_area - area);
+
+    combined.set_union(child1, _nodes[leaf]);
+    PN_stdfloat cost1 = get_perimeter(combined._min, combined._max) + inheritance_cost;
+    if (!child1.is_leaf()) {
+      cost1 -= get_perimeter(child1._min, child1._max);
+    }
+
+    combined.set_union(child2, _nodes[leaf]);
+    PN_stdfloat cost2 = get_perimeter(combined._min, combined._max) + inheritance_cost;
+    if (!child2.is_leaf()) {
+      cost2 -= get_perimeter(child2._min, child2._max);
+    }
+
+    if (cost < cost1 && cost < cost2) {
+      break;
+    }
+    index = (cost1 < cost2) ? node._child1 : node._child2;
+  }
+
+  // Make a new parent for the sibling and the leaf.  Note that this may
+  // reallocate the node array.
+  int sibling = index;
+  int new_parent = alloc_node();
+  int old_parent = _nodes[sibling]._parent;
+
+  Node &parent = _nodes[new_parent];
+  parent._parent = old_parent;
+  parent.set_union(_nodes[sibling], _nodes[leaf]);
+  parent._height = _nodes[sibling]._height + 1;
+  parent._child1 = sibling;
+  parent._child2 = leaf;
+  _nodes[sibling]._parent = new_parent;
+  _nodes[leaf]._parent = new_parent;
+
+  if (old_parent >= 0) {
+    if (_nodes[old_parent]._child1 == sibling) {
+      _nodes[old_parent]._child1 = new_parent;
+    } else {
+      _nodes[old_parent]._child2 = new_parent;
+    }
+  } else {
+    _root = new_parent;
+  }
+
+  refit(_nodes[leaf]._parent);
+}
+
+/**
+ * Removes the indicated leaf from the tree, without freeing it.
+ */
+void CollisionBroadphase::
+remove_leaf(int leaf) {
+  if (leaf == _root) {
+    _root = -1;
+    return;
+  }
+
+  int parent = _nodes[leaf]._parent;
+  int grandparent = _nodes[parent]._parent;
+  int sibling = (_nodes[parent]._child1 == leaf) ? _nodes[parent]._child2 : _nodes[parent]._child1;
+
+  // The sibling takes the place of the parent.
+  if (grandparent >= 0) {
+    if (_nodes[grandparent]._child1 == parent) {
+      _nodes[grandparent]._child1 = sibling;
+    } else {
+      _nodes[grandparent]._child2 = sibling;
+    }
+    _nodes[sibling]._parent = grandparent;
+    free_node(parent);
+    refit(grandparent);
+
+  } else {
+    _root = sibling;
+    _nodes[sibling]._parent = -1;
+    free_node(parent);
+  }
+}
+
+/**
+ * Walks up the tree from the indicated node, rebalancing it and recomputing
+ * the boxes and heights of the nodes along the way.
+ */
+void CollisionBroadphase::
+refit(int index) {
+  while (index >= 0) {
+    index = balance(index);
+
+    Node &node = _nodes[index];
+    const Node &child1 = _nodes[node._child1];
+    const Node &child2 = _nodes[node._child2];
+    node._height = 1 + std::max(child1._height, child2._height);
+    node.set_union(child1, child2);
+
+    index = node._parent;
+  }
+}
+
+/**
+ * If the subtrees of the indicated node differ in height by more than one,
+ * rotates the taller one up to take the node's place.  Returns the index of
+ * the node that is now at this position in the tree.
+ */
+int CollisionBroadphase::
+balance(int ia) {
+  Node &a = _nodes[ia];
+  if (a.is_leaf() || a._height < 2) {
+    return ia;
+  }
+
+  int ib = a._child1;
+  int ic = a._child2;
+  Node &b = _nodes[ib];
+  Node &c = _nodes[ic];
+
+  int balance = c._height - b._height;
+
+  if (balance > 1) {
+    // Rotate c up.
+    int i_f = c._child1;
+    int i_g = c._child2;
+    Node &f = _nodes[i_f];
+    Node &g = _nodes[i_g];
+
+    c._child1 = ia;
+    c._parent = a._parent;
+    a._parent = ic;
+
+    if (c._parent >= 0) {
+      if (_nodes[c._parent]._child1 == ia) {
+        _nodes[c._parent]._child1 = ic;
+      } else {
+        _nodes[c._parent]._child2 = ic;
+      }
+    } else {
+      _root = ic;
+    }
+
+    // The taller of c's children stays with c; the other goes to a.
+    if (f._height > g._height) {
+      c._child2 = i_f;
+      a._child2 = i_g;
+      g._parent = ia;
+      a.set_union(b, g);
+      c.set_union(a, f);
+      a._height = 1 + std::max(b._height, g._height);
+      c._height = 1 + std::max(a._height, f._height);
+    } else {
+      c._child2 = i_g;
+      a._child2 = i_f;
+      f._parent = ia;
+      a.set_union(b, f);
+      c.set_union(a, g);
+      a._height = 1 + std::max(b._height, f._height);
+      c._height = 1 + std::max(a._height, g._height);
+    }
+    return ic;
+  }
+
+  if (balance < -1) {
+    // Rotate b up.
+    int id = b._child1;
+    int ie = b._child2;
+    Node &d = _nodes[id];
+    Node &e = _nodes[ie];
+
+    b._child1 = ia;
+    b._parent = a._parent;
+    a._parent = ib;
+
+    if (b._parent >= 0) {
+      if (_nodes[b._parent]._child1 == ia) {
+        _nodes[b._parent]._child1 = ib;
+      } else {
+        _nodes[b._parent]._child2 = ib;
+      }
+    } else {
+      _root = ib;
+    }
+
+    // The taller of b's children stays with b; the other goes to a.
+    if (d._height > e._height) {
+      b._child2 = id;
+      a._child1 = ie;
+      e._parent = ia;
+      a.set_union(c, e);
+      b.set_union(a, d);
+      a._height = 1 + std::max(c._height, e._height);
+      b._height = 1 + std::max(a._height, d._height);
+    } else {
+      b._child2 = ie;
+      a._child1 = id;
+      d._parent = ia;
+      a.set_union(c, d);
+      b.set_union(a, e);
+      a._height = 1 + std::max(c._height, d._height);
+      b._height = 1 + std::max(a._height, e._height);
+    }
+    return ib;
+  }
+
+  return ia;
+}
@@ -0,0 +1,102 @@
+/**
+ * PANDA 3D SOFTWARE
+ * Copyright (c) Carnegie Mellon University.  All rights reserved.
+ *
+ * All use of this software is subject to the terms of the revised BSD
+ * license.  You should have received a copy of this license along
+ * with this source code in a file named "LICENSE."
+ *
+ * @file collisionBroadphase.h
+ * @author blablabla94
+ * @date 2026-10-17
+ */
+
+#ifndef COLLISIONBROADPHASE_H
+#define COLLISIONBROADPHASE_H
+
+#include "pandabase.h"
+#include "luse.h"
+#include "pvector.h"
+
+/**
+ * A dynamic tree of axis-aligned bounding boxes, used by the
+ * CollisionTraverser to quickly find the nodes whose bounding volumes might
+ * overlap a given collider.
+ *
+ * Each object in the tree is called a proxy.  The box stored for each proxy
+ * is enlarged by get_margin(), so that an object that moves only a little
+ * does not need to be moved within the tree.  The tree is kept balanced as
+ * proxies are added, moved and removed.
+ */
+class EXPCL_PANDA_COLLIDE CollisionBroadphase {
+public:
+  CollisionBroadphase();
+
+  INLINE void set_margin(PN_stdfloat margin);
+  INLINE PN_stdfloat get_margin() const;
+
+  int add_proxy(const LPoint3 &min_point, const LPoint3 &max_point, void *data);
+  void remove_proxy(int proxy);
+  bool move_proxy(int proxy, const LPoint3 &min_point, const LPoint3 &max_point);
+  void clear();
+
+  INLINE void *get_data(int proxy) const;
+  INLINE int get_num_proxies() const;
+  INLINE int get_height() const;
+
+  typedef pvector<void *> Results;
+  void query(const LPoint3 &min_point, const LPoint3 &max_point,
+             Results &results) const;
+
+  void output(std::ostream &out) const;
+
+private:
+  int alloc_node();
+  void free_node(int index);
+  void insert_leaf(int leaf);
+  void remove_leaf(int leaf);
+  void refit(int index);
+  int balance(int index);
+
+  INLINE static PN_stdfloat get_perimeter(const LPoint3 &min_point,
+                                          const LPoint3 &max_point);
+
+  class Node {
+  public:
+    INLINE Node();
+
+    INLINE bool is_leaf() const;
+    INLINE bool overlaps(const LPoint3 &min_point, const LPoint3 &max_point) const;
+    INLINE bool contains(const LPoint3 &min_point, const LPoint3 &max_point) const;
+    INLINE void set_union(const Node &a, const Node &b);
+
+    LPoint3 _min;
+    LPoint3 _max;
+    void *_data;
+
+    // This is the index of the parent node, or of the next node in the free
+    // list if this node is not in use.
+    int _parent;
+    int _child1;
+    int _child2;
+
+    // This is 0 for a leaf, and -1 if the node is not in use.
+    int _height;
+  };
+
+  typedef pvector<Node> Nodes;
+  Nodes _nodes;
+  int _root;
+  int _free_list;
+  int _num_proxies;
+  PN_stdfloat _margin;
+};
+
+INLINE std::ostream &operator << (std::ostream &out, const CollisionBroadphase &bp) {
+  bp.output(out);
+  return out;
+}
+
+#include "collisionBroadphase.I"
+
+#endif
@@ -61,6 +61,7 @@ PUBLISHED:
   INLINE void reset_collided();
 
   INLINE bool get_respect_prev_transform() const;
+  INLINE bool get_continuous() const;
 
   INLINE void set_surface_point(const LPoint3 &point);
   INLINE void set_surface_normal(const LVector3 &normal);
@@ -103,6 +104,7 @@ PUBLISHED:
 
   MAKE_PROPERTY(t, get_t, set_t);
   MAKE_PROPERTY(respect_prev_transform, get_respect_prev_transform);
+  MAKE_PROPERTY(continuous, get_continuous);
 
 public:
   INLINE CPT(TransformState) get_wrt_space() const;
@@ -138,6 +140,7 @@ private:
     F_checked_clip_planes     = 0x0010,
     F_has_contact_pos         = 0x0020,
     F_has_contact_normal      = 0x0040,
+    F_continuous              = 0x0080,
   };
 
   int _flags;
@@ -149,6 +152,12 @@ private:
   LPoint3 _contact_pos;
   LVector3 _contact_normal;
 
+  // Further contacts with the same "into" solid, for solids such as
+  // CollisionMesh that may touch the "from" solid in several places at once.
+  // This is only set on the result of a test, and is emptied when the entries
+  // are passed on to the handler.
+  PT(CollisionEntry) _next_contact;
+
 public:
   static TypeHandle get_class_type() {
     return _type_handle;
@@ -168,6 +177,8 @@ private:
 
   friend class CollisionTraverser;
   friend class CollisionHandlerFluidPusher;
+  friend class CollisionMesh;
+  friend class CollisionRayBatch;
 };
 
 INLINE std::ostream &operator << (std::ostream &out, const CollisionEntry &entry);
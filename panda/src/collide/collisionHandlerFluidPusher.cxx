@@ -16,6 +16,7 @@
 #include "collisionEntry.h"
 #include "collisionPolygon.h"
 #include "collisionSphere.h"
+#include "collisionCapsule.h"
 #include "config_collide.h"
 #include "dcast.h"
 
@@ -52,6 +53,17 @@ add_entry(CollisionEntry *entry) {
   }
 }
 
+/**
+ * Returns true if the two entries are between the same pair of solids, as
+ * happens when a solid such as CollisionMesh reports several contacts at once.
+ */
+static bool
+is_same_contact(const CollisionEntry *a, const CollisionEntry *b) {
+  return a->get_from() == b->get_from() &&
+         a->get_into() == b->get_into() &&
+         a->get_into_node_path() == b->get_into_node_path();
+}
+
 /**
  * Calculates a reasonable final position for a collider given a set of
  * collidees
@@ -134,12 +146,25 @@ handle_entries() {
       CPT(TransformState) prev_trans(from_node_path.get_prev_transform(wrt_node));
       const LPoint3 orig_prev_pos(prev_trans->get_pos());
 
-      // currently we only support spheres as the collider
-      const CollisionSphere *sphere;
-      DCAST_INTO_R(sphere, entries.front()->get_from(), false);
+      // we support spheres and capsules as the collider; the contact
+      // position is that of the sphere's center, or the middle of the
+      // capsule's axis
+      LPoint3 center;
+      const CollisionSolid *solid = entries.front()->get_from();
+      if (solid->is_of_type(CollisionSphere::get_class_type())) {
+        center = ((const CollisionSphere *)solid)->get_center();
+      } else if (solid->is_of_type(CollisionCapsule::get_class_type())) {
+        const CollisionCapsule *capsule = (const CollisionCapsule *)solid;
+        center = (capsule->get_point_a() + capsule->get_point_b()) * 0.5f;
+      } else {
+        collide_cat.error()
+          << "CollisionHandlerFluidPusher only supports spheres and capsules, "
+          << "not " << solid->get_type() << ".\n";
+        return false;
+      }
 
       from_node_path.set_pos(wrt_node, 0,0,0);
-      LPoint3 sphere_offset = (sphere->get_center() *
+      LPoint3 sphere_offset = (center *
                                 from_node_path.get_transform(wrt_node)->get_mat());
       from_node_path.set_pos(wrt_node, orig_pos);
 
@@ -225,16 +250,23 @@ handle_entries() {
         // calculate new collisions given new movement vector
         Entries::iterator ei;
         Entries new_entries;
+        const CollisionEntry *prev = nullptr;
         for (ei = entries.begin(); ei != entries.end(); ++ei) {
           CollisionEntry *entry = (*ei);
           nassertr(entry != nullptr, false);
-          // skip the one we just collided against
-          if (entry != C) {
+          // skip the one we just collided against, along with any other
+          // contacts that the same solid reported at the same time; and test
+          // a solid that reported several contacts only once
+          bool same_as_prev = (prev != nullptr && is_same_contact(entry, prev));
+          prev = entry;
+          if (!is_same_contact(entry, C) && !same_as_prev) {
             entry->_from_node_path = from_node_path;
             entry->reset_collided();
             PT(CollisionEntry) result = entry->get_from()->test_intersection(**ei);
-            if (result != nullptr && result != nullptr) {
+            while (result != nullptr) {
+              PT(CollisionEntry) next = std::move(result->_next_contact);
               new_entries.push_back(result);
+              result = std::move(next);
             }
           }
         }
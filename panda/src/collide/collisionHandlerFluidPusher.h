@@ -22,6 +22,11 @@
 /**
  * A CollisionHandlerPusher that makes use of timing and spatial information
  * from fluid collisions to improve collision response
+ *
+ * The collider may be a CollisionSphere or a CollisionCapsule.  If the
+ * traverser is in continuous mode (see CollisionTraverser::set_continuous()),
+ * a fast collider is stopped at the first point of contact along its path, so
+ * that it cannot pass through thin walls.
  */
 class EXPCL_PANDA_COLLIDE CollisionHandlerFluidPusher : public CollisionHandlerPusher {
 PUBLISHED:
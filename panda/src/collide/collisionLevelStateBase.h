@@ -58,6 +58,8 @@ public:
   void clear();
   void reserve(int num_colliders);
   void prepare_collider(const ColliderDef &def, const NodePath &root);
+  static PT(GeometricBoundingVolume) make_collider_bound(const ColliderDef &def,
+                                                        const NodePath &root);
 
   INLINE NodePath get_node_path() const;
   INLINE PandaNode *node() const;
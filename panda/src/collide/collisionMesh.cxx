@@ -0,0 +1,1056 @@
+/**
+ * PANDA 3D SOFTWARE
+ * Copyright (c) Carnegie Mellon University.  All rights reserved.
+ *
+ * All use of this software is subject to the terms of the revised BSD
+ * license.  You should have received a copy of this license along
+ * with this source code in a file named "LICENSE."
+ *
+ * @file collisionMesh.cxx
+ * @author blablabla94
+ * @date 2026-10-17
+ */
+
+#include "collisionMesh.h"
+#include "collisionEntry.h"
+#include "collisionPolygon.h"
+#include "collisionLine.h"
+#include "collisionRay.h"
+#include "collisionSegment.h"
+#include "collisionParabola.h"
+#include "config_collide.h"
+#include "boundingBox.h"
+#include "finiteBoundingVolume.h"
+#include "geom.h"
+#include "geomNode.h"
+#include "geomTriangles.h"
+#include "geomLines.h"
+#include "geomVertexReader.h"
+#include "geomVertexWriter.h"
+#include "datagram.h"
+#include "datagramIterator.h"
+#include "bamReader.h"
+#include "bamWriter.h"
+#include "indent.h"
+
+#include <algorithm>
+#include <limits>
+
+PStatCollector CollisionMesh::_volume_pcollector("Collision Volumes:CollisionMesh");
+PStatCollector CollisionMesh::_test_pcollector("Collision Tests:CollisionMesh");
+TypeHandle CollisionMesh::_type_handle;
+
+// A node of the hierarchy is split if it has more than this many triangles.
+static const int max_leaf_triangles = 4;
+
+// The number of candidate split planes considered along the longest axis of
+// each node.
+static const int num_split_bins = 16;
+
+// Beyond this depth, no more nodes are split.  This keeps the stack used by
+// the queries bounded, even for pathological meshes.
+static const int max_tree_depth = 64;
+static const int max_stack = 2 * max_tree_depth;
+
+/**
+ * Returns half of the surface area of the indicated box.  This is the
+ * quantity that the surface area heuristic tries to minimize.
+ */
+static PN_stdfloat
+get_half_area(const LPoint3 &min_point, const LPoint3 &max_point) {
+  LVector3 size = max_point - min_point;
+  return size[0] * size[1] + size[1] * size[2] + size[2] * size[0];
+}
+
+/**
+ * Enlarges the box given by min_point and max_point to include the other box.
+ */
+static void
+extend_box(LPoint3 &min_point, LPoint3 &max_point,
+           const LPoint3 &other_min, const LPoint3 &other_max) {
+  for (int i = 0; i < 3; ++i) {
+    min_point[i] = std::min(min_point[i], other_min[i]);
+    max_point[i] = std::max(max_point[i], other_max[i]);
+  }
+}
+
+/**
+ * Computes the box around the indicated bounding volume, after transforming
+ * it by the indicated matrix.  Returns false if the volume is empty or
+ * infinite.
+ */
+static bool
+get_bounding_box(LPoint3 &min_point, LPoint3 &max_point,
+                 const BoundingVolume *bv, const LMatrix4 &mat) {
+  const GeometricBoundingVolume *gbv = bv->as_geometric_bounding_volume();
+  if (gbv == nullptr || gbv->is_empty() || gbv->is_infinite()) {
+    return false;
+  }
+
+  PT(GeometricBoundingVolume) xformed = gbv->make_copy()->as_geometric_bounding_volume();
+  xformed->xform(mat);
+  const FiniteBoundingVolume *fbv = xformed->as_finite_bounding_volume();
+  if (fbv == nullptr) {
+    return false;
+  }
+  min_point = fbv->get_min();
+  max_point = fbv->get_max();
+  return true;
+}
+
+/**
+ * Computes the box around the part of the indicated parabola between t1 and
+ * t2.
+ */
+static void
+get_parabola_box(LPoint3 &min_point, LPoint3 &max_point,
+                 const LParabola &parabola, PN_stdfloat t1, PN_stdfloat t2) {
+  min_point = parabola.calc_point(t1);
+  max_point = min_point;
+  LPoint3 p2 = parabola.calc_point(t2);
+  extend_box(min_point, max_point, p2, p2);
+
+  // Each coordinate is a quadratic function of t, which may reach its extreme
+  // value between the two ends.
+  const LVecBase3 &a = parabola.get_a();
+  const LVecBase3 &b = parabola.get_b();
+  for (int i = 0; i < 3; ++i) {
+    if (a[i] != 0.0f) {
+      PN_stdfloat t = -b[i] / (2.0f * a[i]);
+      if (t > t1 && t < t2) {
+        LPoint3 p = parabola.calc_point(t);
+        min_point[i] = std::min(min_point[i], p[i]);
+        max_point[i] = std::max(max_point[i], p[i]);
+      }
+    }
+  }
+}
+
+/**
+ *
+ */
+CollisionMesh::
+CollisionMesh() :
+  _tree_stale(0)
+{
+}
+
+/**
+ *
+ */
+CollisionMesh::
+CollisionMesh(const CollisionMesh &copy) :
+  CollisionSolid(copy),
+  _vertices(copy._vertices),
+  _triangles(copy._triangles)
+{
+  LightMutexHolder holder(copy._tree_lock);
+  _nodes = copy._nodes;
+  _tree_triangles = copy._tree_triangles;
+  _tree_stale = AtomicAdjust::get(copy._tree_stale);
+}
+
+/**
+ *
+ */
+CollisionSolid *CollisionMesh::
+make_copy() {
+  return new CollisionMesh(*this);
+}
+
+/**
+ * Adds a new triangle to the mesh, given the indices of three vertices
+ * previously added with add_vertex().  Like a CollisionPolygon, the triangle
+ * faces the side from which its vertices appear in counterclockwise order.
+ */
+void CollisionMesh::
+add_triangle(int a, int b, int c) {
+  int num_vertices = (int)_vertices.size();
+  nassertv(a >= 0 && a < num_vertices);
+  nassertv(b >= 0 && b < num_vertices);
+  nassertv(c >= 0 && c < num_vertices);
+
+  Triangle tri;
+  tri._v[0] = a;
+  tri._v[1] = b;
+  tri._v[2] = c;
+  _triangles.push_back(tri);
+
+  AtomicAdjust::set(_tree_stale, 1);
+  mark_viz_stale();
+}
+
+/**
+ * Adds all of the triangles of the indicated Geom to the mesh, after
+ * transforming them by the indicated matrix.  This is a convenient way to
+ * make a mesh from visible geometry, such as a terrain.  Geoms that contain
+ * anything other than polygons are ignored.
+ */
+void CollisionMesh::
+add_geom(const Geom *geom, const LMatrix4 &mat) {
+  nassertv(geom != nullptr);
+  if (geom->get_primitive_type() != Geom::PT_polygons) {
+    return;
+  }
+
+  Thread *current_thread = Thread::get_current_thread();
+  CPT(GeomVertexData) vdata = geom->get_animated_vertex_data(true, current_thread);
+  GeomVertexReader vertex(vdata, InternalName::get_vertex(), current_thread);
+  if (!vertex.has_column()) {
+    return;
+  }
+
+  int first_vertex = (int)_vertices.size();
+  _vertices.reserve(first_vertex + vdata->get_num_rows());
+  while (!vertex.is_at_end()) {
+    _vertices.push_back(mat.xform_point(vertex.get_data3()));
+  }
+  mark_internal_bounds_stale();
+
+  int num_primitives = geom->get_num_primitives();
+  for (int i = 0; i < num_primitives; ++i) {
+    CPT(GeomPrimitive) tris = geom->get_primitive(i)->decompose();
+    int num_vertices = tris->get_num_vertices();
+    for (int v = 0; v + 2 < num_vertices; v += 3) {
+      add_triangle(first_vertex + tris->get_vertex(v),
+                   first_vertex + tris->get_vertex(v + 1),
+                   first_vertex + tris->get_vertex(v + 2));
+    }
+  }
+}
+
+/**
+ * Builds the bounding volume hierarchy over the triangles of the mesh.  This
+ * happens automatically the first time the mesh is tested after it has been
+ * modified, but it may be called explicitly to avoid a delay at that time.
+ */
+void CollisionMesh::
+build_tree() {
+  LightMutexHolder holder(_tree_lock);
+  do_build_tree();
+  AtomicAdjust::set(_tree_stale, 0);
+}
+
+/**
+ * Returns the point in space deemed to be the "origin" of the solid for
+ * collision purposes.  The closest intersection point to this origin point is
+ * considered to be the most significant.
+ */
+LPoint3 CollisionMesh::
+get_collision_origin() const {
+  if (_vertices.empty()) {
+    return LPoint3::origin();
+  }
+
+  LPoint3 min_point = _vertices[0];
+  LPoint3 max_point = _vertices[0];
+  for (const LPoint3 &vertex : _vertices) {
+    extend_box(min_point, max_point, vertex, vertex);
+  }
+  return (min_point + max_point) * 0.5f;
+}
+
+/**
+ * Finds the first triangle that the indicated ray passes through before
+ * t_max.  If there is one, fills in the parametric distance to it and its
+ * surface normal, and returns true.  This is used by CollisionRayBatch, and
+ * does not create a CollisionEntry.
+ */
+bool CollisionMesh::
+trace_ray(const LPoint3 &origin, const LVector3 &direction,
+          PN_stdfloat t_max, PN_stdfloat &t, LVector3 &normal) const {
+  int best_tri = -1;
+  walk_line(origin, direction, 0.0f, t_max, [&](int tri, PN_stdfloat tri_t) {
+    if (tri_t < 0.0f) {
+      return false;
+    }
+    best_tri = tri;
+    t = tri_t;
+    return true;
+  });
+
+  if (best_tri < 0) {
+    return false;
+  }
+
+  if (has_effective_normal()) {
+    normal = get_effective_normal();
+  } else {
+    const Triangle &tri = _triangles[best_tri];
+    const LPoint3 &a = _vertices[tri._v[0]];
+    normal = (_vertices[tri._v[1]] - a).cross(_vertices[tri._v[2]] - a);
+    normal.normalize();
+  }
+  return true;
+}
+
+/**
+ * Transforms the solid by the indicated matrix.
+ */
+void CollisionMesh::
+xform(const LMatrix4 &mat) {
+  for (LPoint3 &vertex : _vertices) {
+    vertex = vertex * mat;
+  }
+  AtomicAdjust::set(_tree_stale, 1);
+
+  CollisionSolid::xform(mat);
+}
+
+/**
+ * Returns a PStatCollector that is used to count the number of bounding
+ * volume tests made against a solid of this type in a given frame.  For a
+ * mesh, this counts the nodes of the hierarchy that are visited.
+ */
+PStatCollector &CollisionMesh::
+get_volume_pcollector() {
+  return _volume_pcollector;
+}
+
+/**
+ * Returns a PStatCollector that is used to count the number of intersection
+ * tests made against a solid of this type in a given frame.
+ */
+PStatCollector &CollisionMesh::
+get_test_pcollector() {
+  return _test_pcollector;
+}
+
+/**
+ *
+ */
+void CollisionMesh::
+output(std::ostream &out) const {
+  out << "cmesh, " << _triangles.size() << " triangles";
+}
+
+/**
+ *
+ */
+void CollisionMesh::
+write(std::ostream &out, int indent_level) const {
+  indent(out, indent_level) << (*this) << "\n";
+}
+
+/**
+ *
+ */
+PT(BoundingVolume) CollisionMesh::
+compute_internal_bounds() const {
+  if (_vertices.empty()) {
+    return new BoundingBox;
+  }
+
+  LPoint3 min_point = _vertices[0];
+  LPoint3 max_point = _vertices[0];
+  for (const LPoint3 &vertex : _vertices) {
+    extend_box(min_point, max_point, vertex, vertex);
+  }
+  return new BoundingBox(min_point, max_point);
+}
+
+/**
+ * This is part of the double-dispatch implementation of test_intersection().
+ * It is called when the "from" object is a sphere.
+ */
+PT(CollisionEntry) CollisionMesh::
+test_intersection_from_sphere(const CollisionEntry &entry) const {
+  return test_volume(entry, &CollisionSolid::test_intersection_from_sphere);
+}
+
+/**
+ * This is part of the double-dispatch implementation of test_intersection().
+ * It is called when the "from" object is a line.
+ */
+PT(CollisionEntry) CollisionMesh::
+test_intersection_from_line(const CollisionEntry &entry) const {
+  const CollisionLine *line;
+  DCAST_INTO_R(line, entry.get_from(), nullptr);
+
+  const LMatrix4 &wrt_mat = entry.get_wrt_mat();
+  return test_line(entry, &CollisionSolid::test_intersection_from_line,
+                   line->get_origin() * wrt_mat, line->get_direction() * wrt_mat,
+                   -std::numeric_limits<PN_stdfloat>::max(),
+                   std::numeric_limits<PN_stdfloat>::max());
+}
+
+/**
+ * This is part of the double-dispatch implementation of test_intersection().
+ * It is called when the "from" object is a ray.
+ */
+PT(CollisionEntry) CollisionMesh::
+test_intersection_from_ray(const CollisionEntry &entry) const {
+  const CollisionRay *ray;
+  DCAST_INTO_R(ray, entry.get_from(), nullptr);
+
+  const LMatrix4 &wrt_mat = entry.get_wrt_mat();
+  return test_line(entry, &CollisionSolid::test_intersection_from_ray,
+                   ray->get_origin() * wrt_mat, ray->get_direction() * wrt_mat,
+                   0.0f, std::numeric_limits<PN_stdfloat>::max());
+}
+
+/**
+ * This is part of the double-dispatch implementation of test_intersection().
+ * It is called when the "from" object is a segment.
+ */
+PT(CollisionEntry) CollisionMesh::
+test_intersection_from_segment(const CollisionEntry &entry) const {
+  const CollisionSegment *segment;
+  DCAST_INTO_R(segment, entry.get_from(), nullptr);
+
+  const LMatrix4 &wrt_mat = entry.get_wrt_mat();
+  LPoint3 from_a = segment->get_point_a() * wrt_mat;
+  LPoint3 from_b = segment->get_point_b() * wrt_mat;
+  return test_line(entry, &CollisionSolid::test_intersection_from_segment,
+                   from_a, from_b - from_a, 0.0f, 1.0f);
+}
+
+/**
+ * This is part of the double-dispatch implementation of test_intersection().
+ * It is called when the "from" object is a capsule.
+ */
+PT(CollisionEntry) CollisionMesh::
+test_intersection_from_capsule(const CollisionEntry &entry) const {
+  return test_volume(entry, &CollisionSolid::test_intersection_from_capsule);
+}
+
+/**
+ * This is part of the double-dispatch implementation of test_intersection().
+ * It is called when the "from" object is a parabola.
+ */
+PT(CollisionEntry) CollisionMesh::
+test_intersection_from_parabola(const CollisionEntry &entry) const {
+  const CollisionParabola *parabola;
+  DCAST_INTO_R(parabola, entry.get_from(), nullptr);
+
+  return test_volume(entry, &CollisionSolid::test_intersection_from_parabola,
+                     parabola);
+}
+
+/**
+ * This is part of the double-dispatch implementation of test_intersection().
+ * It is called when the "from" object is a box.
+ */
+PT(CollisionEntry) CollisionMesh::
+test_intersection_from_box(const CollisionEntry &entry) const {
+  return test_volume(entry, &CollisionSolid::test_intersection_from_box);
+}
+
+/**
+ * Fills the _viz_geom GeomNode up with Geoms suitable for rendering this
+ * solid.
+ */
+void CollisionMesh::
+fill_viz_geom() {
+  if (collide_cat.is_debug()) {
+    collide_cat.debug()
+      << "Recomputing viz for " << *this << "\n";
+  }
+
+  PT(GeomVertexData) vdata = new GeomVertexData
+    ("collision", GeomVertexFormat::get_v3(), Geom::UH_static);
+  vdata->unclean_set_num_rows(_vertices.size());
+  GeomVertexWriter vertex(vdata, InternalName::get_vertex());
+  for (const LPoint3 &point : _vertices) {
+    vertex.set_data3(point);
+  }
+
+  PT(GeomTriangles) mesh = new GeomTriangles(Geom::UH_static);
+  PT(GeomLines) wire = new GeomLines(Geom::UH_static);
+  for (const Triangle &tri : _triangles) {
+    mesh->add_vertices(tri._v[0], tri._v[1], tri._v[2]);
+    wire->add_vertices(tri._v[0], tri._v[1]);
+    wire->add_vertices(tri._v[1], tri._v[2]);
+    wire->add_vertices(tri._v[2], tri._v[0]);
+  }
+
+  PT(Geom) geom = new Geom(vdata);
+  geom->add_primitive(mesh);
+  PT(Geom) geom2 = new Geom(vdata);
+  geom2->add_primitive(wire);
+
+  _viz_geom->add_geom(geom, get_solid_viz_state());
+  _viz_geom->add_geom(geom2, get_wireframe_viz_state());
+
+  _bounds_viz_geom->add_geom(geom, get_solid_bounds_viz_state());
+  _bounds_viz_geom->add_geom(geom2, get_wireframe_bounds_viz_state());
+}
+
+/**
+ * Tests a solid that occupies a volume against the triangles whose boxes
+ * overlap its bounding volume.  Returns the entry for the first triangle
+ * touched, or for the most deeply penetrated one, with the entries for the
+ * other triangles it touches chained onto it, so that a pusher can resolve
+ * the collider against each of them, such as in a corner.  If a parabola is
+ * given, only the entry for the triangle it reaches first is returned.
+ */
+PT(CollisionEntry) CollisionMesh::
+test_volume(const CollisionEntry &entry, TestFunc func,
+            const CollisionParabola *parabola) const {
+  check_tree();
+  if (_nodes.empty()) {
+    return nullptr;
+  }
+
+  CPT(TransformState) wrt_space = entry.get_wrt_space();
+
+  LPoint3 min_point, max_point;
+  LParabola local_p;
+  if (parabola != nullptr) {
+    // The bounding volume of a parabola only roughly follows its arc, so we
+    // compute the exact box around the arc instead.
+    local_p = parabola->get_parabola();
+    local_p.xform(wrt_space->get_mat());
+    get_parabola_box(min_point, max_point, local_p,
+                     parabola->get_t1(), parabola->get_t2());
+
+  } else {
+    // Find the box around the "from" solid in our own space, including its
+    // previous position if it is moving.  Without one, we have to test
+    // everything.
+    CPT(BoundingVolume) from_bv = entry.get_from()->get_bounds();
+    if (!get_bounding_box(min_point, max_point, from_bv, wrt_space->get_mat())) {
+      min_point = _nodes[0]._min;
+      max_point = _nodes[0]._max;
+
+    } else if (entry.get_respect_prev_transform()) {
+      CPT(TransformState) wrt_prev_space = entry.get_wrt_prev_space();
+      if (wrt_prev_space != wrt_space) {
+        LPoint3 prev_min, prev_max;
+        if (get_bounding_box(prev_min, prev_max, from_bv, wrt_prev_space->get_mat())) {
+          extend_box(min_point, max_point, prev_min, prev_max);
+        } else {
+          min_point = _nodes[0]._min;
+          max_point = _nodes[0]._max;
+        }
+      }
+    }
+  }
+
+  LPoint3 center = (min_point + max_point) * 0.5f;
+  LVector3 extents = (max_point - min_point) * 0.5f;
+
+  PT(CollisionEntry) best;
+  PN_stdfloat best_t = 0.0f;
+  PN_stdfloat best_depth = 0.0f;
+  PT(CollisionEntry) others;
+
+  int stack[max_stack];
+  int stack_size = 0;
+  stack[stack_size++] = 0;
+  int num_visited = 0;
+
+  while (stack_size > 0) {
+    int index = stack[--stack_size];
+    const Node &node = _nodes[index];
+    ++num_visited;
+    if (!node.overlaps(min_point, max_point)) {
+      continue;
+    }
+
+    if (!node.is_leaf()) {
+      nassertr(stack_size + 2 <= max_stack, best);
+      stack[stack_size++] = node._index;
+      stack[stack_size++] = index + 1;
+      continue;
+    }
+
+    int end = node._index + node._num_triangles;
+    for (int i = node._index; i < end; ++i) {
+      int tri = _tree_triangles[i];
+      if (!triangle_overlaps_box(tri, center, extents)) {
+        continue;
+      }
+
+      PT(CollisionEntry) result = test_triangle(entry, func, tri);
+      if (result == nullptr) {
+        continue;
+      }
+
+      PN_stdfloat t;
+      PN_stdfloat depth = 0.0f;
+      if (parabola != nullptr) {
+        // Find where the parabola meets the plane of this triangle, as the
+        // polygon test did.
+        const Triangle &tr = _triangles[tri];
+        LPlane plane(_vertices[tr._v[0]], _vertices[tr._v[1]], _vertices[tr._v[2]]);
+        PN_stdfloat t1, t2;
+        if (!plane.intersects_parabola(t1, t2, local_p)) {
+          continue;
+        }
+        bool t1_ok = (t1 >= parabola->get_t1() && t1 <= parabola->get_t2());
+        bool t2_ok = (t2 >= parabola->get_t1() && t2 <= parabola->get_t2());
+        t = (t1_ok && t2_ok) ? std::min(t1, t2) : (t1_ok ? t1 : t2);
+      } else {
+        t = result->_t;
+        depth = (result->_surface_point - result->_interior_point).length_squared();
+      }
+
+      if (best == nullptr || t < best_t || (t == best_t && depth > best_depth)) {
+        std::swap(best, result);
+        best_t = t;
+        best_depth = depth;
+      }
+      if (result != nullptr && parabola == nullptr) {
+        result->_next_contact = std::move(others);
+        others = std::move(result);
+      }
+    }
+  }
+
+  if (best != nullptr) {
+    best->_next_contact = std::move(others);
+  }
+
+  _volume_pcollector.add_level(num_visited);
+  return best;
+}
+
+/**
+ * Tests the part of the indicated line between t_min and t_max against the
+ * triangles, and returns the entry for the first one it passes through.
+ * The line is given in our own space; the "from" solid itself is tested by
+ * the indicated CollisionPolygon method.
+ */
+PT(CollisionEntry) CollisionMesh::
+test_line(const CollisionEntry &entry, TestFunc func,
+          const LPoint3 &origin, const LVector3 &direction,
+          PN_stdfloat t_min, PN_stdfloat t_max) const {
+  PT(CollisionEntry) best;
+  walk_line(origin, direction, t_min, t_max, [&](int tri, PN_stdfloat t) {
+    PT(CollisionEntry) result = test_triangle(entry, func, tri);
+    if (result == nullptr) {
+      return false;
+    }
+    best = std::move(result);
+    return true;
+  });
+  return best;
+}
+
+/**
+ * Visits the triangles that the part of the indicated line between t_min and
+ * t_max may pass through, nearest first as far as the hierarchy can tell.
+ * func is called with each triangle and the parametric distance at which the
+ * line meets it, and returns true if it accepts the triangle, after which only
+ * nearer triangles are visited.
+ */
+template<class Func>
+void CollisionMesh::
+walk_line(const LPoint3 &origin, const LVector3 &direction,
+          PN_stdfloat t_min, PN_stdfloat t_max, Func func) const {
+  check_tree();
+  if (_nodes.empty()) {
+    return;
+  }
+
+  LVector3 inv_direction;
+  for (int i = 0; i < 3; ++i) {
+    inv_direction[i] = (direction[i] != 0.0f) ? 1.0f / direction[i] : 0.0f;
+  }
+
+  PN_stdfloat best_t = t_max;
+
+  int stack[max_stack];
+  int stack_size = 0;
+  stack[stack_size++] = 0;
+  int num_visited = 0;
+
+  while (stack_size > 0) {
+    int index = stack[--stack_size];
+    const Node &node = _nodes[index];
+    ++num_visited;
+
+    // Nodes beyond the closest triangle found so far can be skipped.
+    PN_stdfloat t_near;
+    if (!node.intersects_line(origin, inv_direction, t_min, best_t, t_near)) {
+      continue;
+    }
+
+    if (!node.is_leaf()) {
+      // Visit the nearer child first, so that we find the closest triangle
+      // early and can skip more of the tree.
+      int child1 = index + 1;
+      int child2 = node._index;
+      PN_stdfloat t1, t2;
+      bool hit1 = _nodes[child1].intersects_line(origin, inv_direction, t_min, best_t, t1);
+      bool hit2 = _nodes[child2].intersects_line(origin, inv_direction, t_min, best_t, t2);
+      nassertv(stack_size + 2 <= max_stack);
+      if (hit1 && hit2) {
+        if (t1 <= t2) {
+          stack[stack_size++] = child2;
+          stack[stack_size++] = child1;
+        } else {
+          stack[stack_size++] = child1;
+          stack[stack_size++] = child2;
+        }
+      } else if (hit1) {
+        stack[stack_size++] = child1;
+      } else if (hit2) {
+        stack[stack_size++] = child2;
+      }
+      continue;
+    }
+
+    int end = node._index + node._num_triangles;
+    for (int i = node._index; i < end; ++i) {
+      int tri = _tree_triangles[i];
+      PN_stdfloat t;
+      if (!triangle_intersects_line(tri, origin, direction, t) ||
+          t > best_t || t < t_min - 0.001f) {
+        continue;
+      }
+
+      if (func(tri, t)) {
+        best_t = t;
+      }
+    }
+  }
+
+  _volume_pcollector.add_level(num_visited);
+}
+
+/**
+ * Tests the indicated triangle in detail, by making a temporary
+ * CollisionPolygon for it, and calling the indicated test method on that.
+ */
+PT(CollisionEntry) CollisionMesh::
+test_triangle(const CollisionEntry &entry, TestFunc func, int tri) const {
+  const Triangle &t = _triangles[tri];
+  CollisionPolygon poly(_vertices[t._v[0]], _vertices[t._v[1]], _vertices[t._v[2]]);
+  poly.local_object();
+  if (has_effective_normal()) {
+    poly.set_effective_normal(get_effective_normal());
+  }
+
+  return (poly.*func)(entry);
+}
+
+/**
+ * Rebuilds the bounding volume hierarchy.  The caller must hold _tree_lock.
+ */
+void CollisionMesh::
+do_build_tree() {
+  _nodes.clear();
+  _tree_triangles.clear();
+
+  BuildTriangles build;
+  build.reserve(_triangles.size());
+  for (size_t i = 0; i < _triangles.size(); ++i) {
+    const Triangle &tri = _triangles[i];
+    const LPoint3 &a = _vertices[tri._v[0]];
+    const LPoint3 &b = _vertices[tri._v[1]];
+    const LPoint3 &c = _vertices[tri._v[2]];
+    if (!CollisionPolygon::verify_points(a, b, c)) {
+      // A degenerate triangle can't be collided with.
+      continue;
+    }
+
+    BuildTriangle bt;
+    bt._min = a;
+    bt._max = a;
+    extend_box(bt._min, bt._max, b, b);
+    extend_box(bt._min, bt._max, c, c);
+    bt._centroid = (a + b + c) / 3.0f;
+    bt._index = (int)i;
+    build.push_back(bt);
+  }
+
+  if (build.empty()) {
+    return;
+  }
+
+  _nodes.reserve(build.size() * 2 / max_leaf_triangles + 1);
+  r_build_tree(build, 0, (int)build.size(), 0);
+
+  _tree_triangles.reserve(build.size());
+  for (const BuildTriangle &bt : build) {
+    _tree_triangles.push_back(bt._index);
+  }
+}
+
+/**
+ * Builds the part of the hierarchy for the indicated range of triangles, and
+ * returns the index of the node at its root.  The triangles are reordered so
+ * that each child's triangles are contiguous.
+ */
+int CollisionMesh::
+r_build_tree(BuildTriangles &build, int begin, int end, int depth) {
+  int index = (int)_nodes.size();
+  _nodes.push_back(Node());
+
+  LPoint3 min_point = build[begin]._min;
+  LPoint3 max_point = build[begin]._max;
+  LPoint3 min_centroid = build[begin]._centroid;
+  LPoint3 max_centroid = build[begin]._centroid;
+  for (int i = begin + 1; i < end; ++i) {
+    extend_box(min_point, max_point, build[i]._min, build[i]._max);
+    extend_box(min_centroid, max_centroid, build[i]._centroid, build[i]._centroid);
+  }
+  _nodes[index]._min = min_point;
+  _nodes[index]._max = max_point;
+
+  int num_triangles = end - begin;
+  if (num_triangles <= max_leaf_triangles || depth >= max_tree_depth) {
+    _nodes[index]._index = begin;
+    _nodes[index]._num_triangles = num_triangles;
+    return index;
+  }
+
+  // Split along the axis in which the centroids are most spread out.
+  LVector3 spread = max_centroid - min_centroid;
+  int axis = 0;
+  if (spread[1] > spread[axis]) {
+    axis = 1;
+  }
+  if (spread[2] > spread[axis]) {
+    axis = 2;
+  }
+
+  int mid = begin;
+  if (spread[axis] > 0.0f) {
+    // Sort the triangles into bins by their centroids, and choose the
+    // boundary between bins with the lowest surface area heuristic cost.
+    int bin_count[num_split_bins];
+    LPoint3 bin_min[num_split_bins];
+    LPoint3 bin_max[num_split_bins];
+    for (int b = 0; b < num_split_bins; ++b) {
+      bin_count[b] = 0;
+    }
+
+    PN_stdfloat scale = num_split_bins / spread[axis];
+    auto get_bin = [&](const BuildTriangle &bt) {
+      int b = (int)((bt._centroid[axis] - min_centroid[axis]) * scale);
+      return std::max(0, std::min(b, num_split_bins - 1));
+    };
+
+    for (int i = begin; i < end; ++i) {
+      int b = get_bin(build[i]);
+      if (bin_count[b]++ == 0) {
+        bin_min[b] = build[i]._min;
+        bin_max[b] = build[i]._max;
+      } else {
+        extend_box(bin_min[b], bin_max[b], build[i]._min, build[i]._max);
+      }
+    }
+
+    // right_cost[b] is the cost of putting bins b and up on the right.
+    PN_stdfloat right_cost[num_split_bins];
+    LPoint3 side_min, side_max;
+    int side_count = 0;
+    for (int b = num_split_bins - 1; b > 0; --b) {
+      if (bin_count[b] != 0) {
+        if (side_count == 0) {
+          side_min = bin_min[b];
+          side_max = bin_max[b];
+        } else {
+          extend_box(side_min, side_max, bin_min[b], bin_max[b]);
+        }
+        side_count += bin_count[b];
+      }
+      right_cost[b] = (side_count != 0) ? side_count * get_half_area(side_min, side_max) : 0.0f;
+    }
+
+    int best_split = -1;
+    PN_stdfloat best_cost = 0.0f;
+    side_count = 0;
+    for (int b = 0; b < num_split_bins - 1; ++b) {
+      if (bin_count[b] != 0) {
+        if (side_count == 0) {
+          side_min = bin_min[b];
+          side_max = bin_max[b];
+        } else {
+          extend_box(side_min, side_max, bin_min[b], bin_max[b]);
+        }
+        side_count += bin_count[b];
+      }
+      if (side_count == 0 || side_count == num_triangles) {
+        continue;
+      }
+      PN_stdfloat cost = side_count * get_half_area(side_min, side_max) + right_cost[b + 1];
+      if (best_split < 0 || cost < best_cost) {
+        best_split = b;
+        best_cost = cost;
+      }
+    }
+
+    if (best_split >= 0) {
+      mid = (int)(std::partition(build.begin() + begin, build.begin() + end,
+                                 [&](const BuildTriangle &bt) {
+                                   return get_bin(bt) <= best_split;
+                                 }) - build.begin());
+    }
+  }
+
+  if (mid == begin || mid == end) {
+    // The centroids are too close together to separate this way; just split
+    // the triangles in half.
+    mid = begin + num_triangles / 2;
+    std::nth_element(build.begin() + begin, build.begin() + mid,
+                     build.begin() + end,
+                     [axis](const BuildTriangle &a, const BuildTriangle &b) {
+                       return a._centroid[axis] < b._centroid[axis];
+                     });
+  }
+
+  // The first child goes right after this node.
+  r_build_tree(build, begin, mid, depth + 1);
+  int second_child = r_build_tree(build, mid, end, depth + 1);
+
+  _nodes[index]._index = second_child;
+  _nodes[index]._num_triangles = 0;
+  return index;
+}
+
+/**
+ * Tells the BamReader how to create objects of type CollisionMesh.
+ */
+void CollisionMesh::
+register_with_read_factory() {
+  BamReader::get_factory()->register_factory(get_class_type(), make_from_bam);
+}
+
+/**
+ * Writes the contents of this object to the datagram for shipping out to a
+ * Bam file.  The bounding volume hierarchy is written too, so that it need
+ * not be built again when the file is read.
+ */
+void CollisionMesh::
+write_datagram(BamWriter *manager, Datagram &me) {
+  CollisionSolid::write_datagram(manager, me);
+  check_tree();
+
+  me.add_uint32(_vertices.size());
+  for (const LPoint3 &vertex : _vertices) {
+    vertex.write_datagram(me);
+  }
+
+  me.add_uint32(_triangles.size());
+  for (const Triangle &tri : _triangles) {
+    me.add_uint32(tri._v[0]);
+    me.add_uint32(tri._v[1]);
+    me.add_uint32(tri._v[2]);
+  }
+
+  me.add_uint32(_nodes.size());
+  for (const Node &node : _nodes) {
+    node._min.write_datagram(me);
+    node._max.write_datagram(me);
+    me.add_uint32(node._index);
+    me.add_uint32(node._num_triangles);
+  }
+
+  me.add_uint32(_tree_triangles.size());
+  for (int tri : _tree_triangles) {
+    me.add_uint32(tri);
+  }
+}
+
+/**
+ * This function is called by the BamReader's factory when a new object of
+ * type CollisionMesh is encountered in the Bam file.  It should create the
+ * CollisionMesh and extract its information from the file.
+ */
+TypedWritable *CollisionMesh::
+make_from_bam(const FactoryParams &params) {
+  CollisionMesh *node = new CollisionMesh;
+  DatagramIterator scan;
+  BamReader *manager;
+
+  parse_params(params, scan, manager);
+  node->fillin(scan, manager);
+
+  if (!node->check_indices()) {
+    collide_cat.error()
+      << "CollisionMesh in bam file refers to nonexistent vertices, triangles "
+         "or tree nodes.\n";
+    delete node;
+    return nullptr;
+  }
+
+  return node;
+}
+
+/**
+ * Returns true if all of the vertex, triangle and tree node indices stored in
+ * the mesh are in range, false if the data is corrupt.  This is called after
+ * the mesh has been read from a bam file.
+ */
+bool CollisionMesh::
+check_indices() const {
+  int num_vertices = (int)_vertices.size();
+  for (const Triangle &tri : _triangles) {
+    for (int i = 0; i < 3; ++i) {
+      if (tri._v[i] < 0 || tri._v[i] >= num_vertices) {
+        return false;
+      }
+    }
+  }
+
+  int num_triangles = (int)_triangles.size();
+  for (int tri : _tree_triangles) {
+    if (tri < 0 || tri >= num_triangles) {
+      return false;
+    }
+  }
+
+  // Each interior node is followed by its first child, and its second child
+  // comes after that, so that walking the tree always terminates.
+  int num_nodes = (int)_nodes.size();
+  int num_tree_triangles = (int)_tree_triangles.size();
+  for (int n = 0; n < num_nodes; ++n) {
+    const Node &node = _nodes[n];
+    if (node._num_triangles < 0) {
+      return false;
+    }
+    if (node.is_leaf()) {
+      if (node._index < 0 || node._index > num_tree_triangles - node._num_triangles) {
+        return false;
+      }
+    } else if (n + 1 >= num_nodes || node._index <= n + 1 || node._index >= num_nodes) {
+      return false;
+    }
+  }
+
+  return true;
+}
+
+/**
+ * This internal function is called by make_from_bam to read in all of the
+ * relevant data from the BamFile for the new CollisionMesh.
+ */
+void CollisionMesh::
+fillin(DatagramIterator &scan, BamReader *manager) {
+  CollisionSolid::fillin(scan, manager);
+
+  size_t num_vertices = scan.get_uint32();
+  _vertices.resize(num_vertices);
+  for (LPoint3 &vertex : _vertices) {
+    vertex.read_datagram(scan);
+  }
+
+  size_t num_triangles = scan.get_uint32();
+  _triangles.resize(num_triangles);
+  for (Triangle &tri : _triangles) {
+    tri._v[0] = scan.get_uint32();
+    tri._v[1] = scan.get_uint32();
+    tri._v[2] = scan.get_uint32();
+  }
+
+  size_t num_nodes = scan.get_uint32();
+  _nodes.resize(num_nodes);
+  for (Node &node : _nodes) {
+    node._min.read_datagram(scan);
+    node._max.read_datagram(scan);
+    node._index = scan.get_uint32();
+    node._num_triangles = scan.get_uint32();
+  }
+
+  size_t num_tree_triangles = scan.get_uint32();
+  _tree_triangles.resize(num_tree_triangles);
+  for (int &tri : _tree_triangles) {
+    tri = scan.get_uint32();
+  }
+
+  _tree_stale = (_nodes.empty() && !_triangles.empty()) ? 1 : 0;
+}
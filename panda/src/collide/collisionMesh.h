@@ -0,0 +1,221 @@
+/**
+ * PANDA 3D SOFTWARE
+ * Copyright (c) Carnegie Mellon University.  All rights reserved.
+ *
+ * All use of this software is subject to the terms of the revised BSD
+ * license.  You should have received a copy of this license along
+ * with this source code in a file named "LICENSE."
+ *
+ * @file collisionMesh.h
+ * @author blablabla94
+ * @date 2026-10-17
+ */
+
+#ifndef COLLISIONMESH_H
+#define COLLISIONMESH_H
+
+#include "pandabase.h"
+#include "collisionSolid.h"
+#include "lightMutex.h"
+#include "lightMutexHolder.h"
+#include "pvector.h"
+#include "atomicAdjust.h"
+
+class Geom;
+class CollisionParabola;
+
+/**
+ * A collision solid made of an arbitrary number of triangles, such as a
+ * terrain or the walls of a level.  Each triangle behaves just like a
+ * CollisionPolygon, and may be tested against spheres, lines, rays,
+ * segments, capsules, parabolas and boxes.
+ *
+ * The triangles are organized into a bounding volume hierarchy, so that only
+ * the few triangles near a given collider need to be tested.  The hierarchy
+ * is built the first time the mesh is tested, or when build_tree() is called,
+ * and it is stored in the bam file, so that it need not be built again when
+ * the model is loaded.
+ *
+ * Only the first collision along a ray, line, segment or parabola is
+ * reported.  A sphere, capsule or box is reported to collide with each of the
+ * triangles it touches, so that a pusher can push it out of a corner; the
+ * entries all name the mesh as their "into" solid.
+ */
+class EXPCL_PANDA_COLLIDE CollisionMesh : public CollisionSolid {
+PUBLISHED:
+  CollisionMesh();
+
+  INLINE int add_vertex(const LPoint3 &vertex);
+  void add_triangle(int a, int b, int c);
+  void add_geom(const Geom *geom, const LMatrix4 &mat = LMatrix4::ident_mat());
+
+  INLINE int get_num_vertices() const;
+  INLINE const LPoint3 &get_vertex(int n) const;
+  MAKE_SEQ(get_vertices, get_num_vertices, get_vertex);
+  INLINE int get_num_triangles() const;
+  INLINE LVecBase3i get_triangle(int n) const;
+  MAKE_SEQ(get_triangles, get_num_triangles, get_triangle);
+
+  void build_tree();
+  INLINE int get_num_tree_nodes() const;
+
+  virtual LPoint3 get_collision_origin() const;
+
+PUBLISHED:
+  MAKE_SEQ_PROPERTY(vertices, get_num_vertices, get_vertex);
+  MAKE_SEQ_PROPERTY(triangles, get_num_triangles, get_triangle);
+  MAKE_PROPERTY(num_tree_nodes, get_num_tree_nodes);
+
+public:
+  CollisionMesh(const CollisionMesh &copy);
+  virtual CollisionSolid *make_copy();
+
+  virtual void xform(const LMatrix4 &mat);
+
+  bool trace_ray(const LPoint3 &origin, const LVector3 &direction,
+                 PN_stdfloat t_max, PN_stdfloat &t, LVector3 &normal) const;
+
+  virtual PStatCollector &get_volume_pcollector();
+  virtual PStatCollector &get_test_pcollector();
+
+  virtual void output(std::ostream &out) const;
+  virtual void write(std::ostream &out, int indent_level = 0) const;
+
+  INLINE static void flush_level();
+
+protected:
+  virtual PT(BoundingVolume) compute_internal_bounds() const;
+
+  virtual PT(CollisionEntry)
+    test_intersection_from_sphere(const CollisionEntry &entry) const;
+  virtual PT(CollisionEntry)
+    test_intersection_from_line(const CollisionEntry &entry) const;
+  virtual PT(CollisionEntry)
+    test_intersection_from_ray(const CollisionEntry &entry) const;
+  virtual PT(CollisionEntry)
+    test_intersection_from_segment(const CollisionEntry &entry) const;
+  virtual PT(CollisionEntry)
+    test_intersection_from_capsule(const CollisionEntry &entry) const;
+  virtual PT(CollisionEntry)
+    test_intersection_from_parabola(const CollisionEntry &entry) const;
+  virtual PT(CollisionEntry)
+    test_intersection_from_box(const CollisionEntry &entry) const;
+
+  virtual void fill_viz_geom();
+
+private:
+  typedef PT(CollisionEntry) (CollisionSolid::*TestFunc)(const CollisionEntry &entry) const;
+
+  PT(CollisionEntry) test_volume(const CollisionEntry &entry, TestFunc func,
+                                 const CollisionParabola *parabola = nullptr) const;
+  PT(CollisionEntry) test_line(const CollisionEntry &entry, TestFunc func,
+                               const LPoint3 &origin, const LVector3 &direction,
+                               PN_stdfloat t_min, PN_stdfloat t_max) const;
+  template<class Func>
+  void walk_line(const LPoint3 &origin, const LVector3 &direction,
+                 PN_stdfloat t_min, PN_stdfloat t_max, Func func) const;
+  PT(CollisionEntry) test_triangle(const CollisionEntry &entry, TestFunc func,
+                                   int tri) const;
+
+  class BuildTriangle {
+  public:
+    LPoint3 _min;
+    LPoint3 _max;
+    LPoint3 _centroid;
+    int _index;
+  };
+  typedef pvector<BuildTriangle> BuildTriangles;
+
+  INLINE void check_tree() const;
+  void do_build_tree();
+  int r_build_tree(BuildTriangles &build, int begin, int end, int depth);
+
+  INLINE bool triangle_overlaps_box(int tri, const LPoint3 &center,
+                                    const LVector3 &extents) const;
+  INLINE bool triangle_intersects_line(int tri, const LPoint3 &origin,
+                                       const LVector3 &direction,
+                                       PN_stdfloat &t) const;
+
+  class Triangle {
+  public:
+    int _v[3];
+  };
+
+  // A node of the bounding volume hierarchy.  The nodes are stored in
+  // depth-first order, so that the first child of an interior node directly
+  // follows it.
+  class Node {
+  public:
+    INLINE Node();
+
+    INLINE bool is_leaf() const;
+    INLINE bool overlaps(const LPoint3 &min_point, const LPoint3 &max_point) const;
+    INLINE bool intersects_line(const LPoint3 &origin, const LVector3 &inv_direction,
+                                PN_stdfloat t_min, PN_stdfloat t_max,
+                                PN_stdfloat &t_near) const;
+
+    LPoint3 _min;
+    LPoint3 _max;
+
+    // For a leaf, this is the first of its entries in _tree_triangles; for
+    // an interior node, this is the index of its second child.
+    int _index;
+
+    // The number of triangles in a leaf, or 0 for an interior node.
+    int _num_triangles;
+  };
+
+  typedef pvector<LPoint3> Vertices;
+  typedef pvector<Triangle> Triangles;
+  typedef pvector<Node> Nodes;
+  typedef pvector<int> TriangleIndices;
+
+  Vertices _vertices;
+  Triangles _triangles;
+
+  // The hierarchy, and the indices of the triangles in the order the leaves
+  // refer to them.  Degenerate triangles are left out.
+  Nodes _nodes;
+  TriangleIndices _tree_triangles;
+
+  // This is nonzero when the hierarchy needs to be rebuilt.  The mesh may be
+  // tested from several threads at once, so the tree is built while holding
+  // the lock.
+  mutable AtomicAdjust::Integer _tree_stale;
+  mutable LightMutex _tree_lock;
+
+  static PStatCollector _volume_pcollector;
+  static PStatCollector _test_pcollector;
+
+public:
+  static void register_with_read_factory();
+  virtual void write_datagram(BamWriter *manager, Datagram &me);
+
+protected:
+  static TypedWritable *make_from_bam(const FactoryParams &params);
+  void fillin(DatagramIterator &scan, BamReader *manager);
+
+private:
+  bool check_indices() const;
+
+public:
+  static TypeHandle get_class_type() {
+    return _type_handle;
+  }
+  static void init_type() {
+    CollisionSolid::init_type();
+    register_type(_type_handle, "CollisionMesh",
+                  CollisionSolid::get_class_type());
+  }
+  virtual TypeHandle get_type() const {
+    return get_class_type();
+  }
+  virtual TypeHandle force_init_type() {init_type(); return get_class_type();}
+
+private:
+  static TypeHandle _type_handle;
+};
+
+#include "collisionMesh.I"
+
+#endif
@@ -381,10 +381,17 @@ int CollisionNode::
 complete_pointers(TypedWritable **p_list, BamReader *manager) {
   int pi = PandaNode::complete_pointers(p_list, manager);
 
+  // A solid that could not be read is left out.
+  Solids solids;
+  solids.reserve(_solids.size());
   int num_solids = _solids.size();
   for (int i = 0; i < num_solids; i++) {
-    _solids[i] = DCAST(CollisionSolid, p_list[pi++]);
+    CollisionSolid *solid = DCAST(CollisionSolid, p_list[pi++]);
+    if (solid != nullptr) {
+      solids.push_back(solid);
+    }
   }
+  _solids.swap(solids);
 
   return pi;
 }
@@ -21,6 +21,7 @@
 #include "collisionRay.h"
 #include "collisionSegment.h"
 #include "collisionParabola.h"
+#include "collisionSweep.h"
 #include "config_collide.h"
 #include "cullTraverserData.h"
 #include "boundingBox.h"
@@ -385,6 +386,13 @@ test_intersection_from_sphere(const CollisionEntry &entry) const {
     return nullptr;
   }
 
+  if (entry.get_continuous()) {
+    PT(CollisionEntry) result;
+    if (test_swept_intersection(entry, result)) {
+      return result;
+    }
+  }
+
   const CollisionSphere *sphere;
   DCAST_INTO_R(sphere, entry.get_from(), nullptr);
 
@@ -571,6 +579,52 @@ test_intersection_from_sphere(const CollisionEntry &entry) const {
   return new_entry;
 }
 
+/**
+ * Called in continuous mode, when the "from" object is a sphere or capsule.
+ * If it moved since the previous frame, sweeps it along its path against the
+ * polygon, stores a new CollisionEntry for the first contact in result, or
+ * NULL if there was none, and returns true.  Returns false if the polygon
+ * should be tested the usual way instead, because the "from" object didn't
+ * move, or it already touched the polygon at its previous position.
+ *
+ * Clip planes are not taken into account.
+ */
+bool CollisionPolygon::
+test_swept_intersection(const CollisionEntry &entry,
+                        PT(CollisionEntry) &result) const {
+  CollisionSweep sweep(entry);
+  if (!sweep.is_moving()) {
+    return false;
+  }
+
+  // As with the fluid sphere test, there is no collision if the "from" object
+  // is moving in the same direction as the polygon's normal.
+  result = nullptr;
+  if (sweep.get_delta().dot(get_normal()) > 0.0f) {
+    return true;
+  }
+
+  pvector<LPoint3> points;
+  points.reserve(_points.size());
+  LMatrix4 to_3d_mat;
+  rederive_to_3d_mat(to_3d_mat);
+  for (const PointDef &pd : _points) {
+    points.push_back(to_3d(pd._p, to_3d_mat));
+  }
+
+  sweep.sweep_polygon(&points[0], points.size());
+  if (sweep.started_inside()) {
+    return false;
+  }
+
+  result = sweep.make_entry(entry);
+  if (result != nullptr && has_effective_normal() &&
+      entry.get_from()->get_respect_effective_normal()) {
+    result->set_surface_normal(get_effective_normal());
+  }
+  return true;
+}
+
 /**
  * This is part of the double-dispatch implementation of test_intersection().
  * It is called when the "from" object is a line.
@@ -886,6 +940,13 @@ test_intersection_from_capsule(const CollisionEntry &entry) const {
     return nullptr;
   }
 
+  if (entry.get_continuous()) {
+    PT(CollisionEntry) result;
+    if (test_swept_intersection(entry, result)) {
+      return result;
+    }
+  }
+
   const CollisionCapsule *capsule;
   DCAST_INTO_R(capsule, entry.get_from(), nullptr);
 
@@ -127,6 +127,8 @@ private:
   bool point_is_inside(const LPoint2 &p, const Points &points) const;
   PN_stdfloat dist_to_polygon(const LPoint2 &p, LPoint2 &edge_p, const Points &points) const;
   void project(const LVector3 &axis, PN_stdfloat &center, PN_stdfloat &extent) const;
+  bool test_swept_intersection(const CollisionEntry &entry,
+                               PT(CollisionEntry) &result) const;
 
   void setup_points(const LPoint3 *begin, const LPoint3 *end);
   INLINE LPoint2 to_2d(const LVecBase3 &point3d) const;
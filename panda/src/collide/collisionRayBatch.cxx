@@ -0,0 +1,850 @@
+/**
+ * PANDA 3D SOFTWARE
+ * Copyright (c) Carnegie Mellon University.  All rights reserved.
+ *
+ * All use of this software is subject to the terms of the revised BSD
+ * license.  You should have received a copy of this license along
+ * with this source code in a file named "LICENSE."
+ *
+ * @file collisionRayBatch.cxx
+ * @author blablabla94
+ * @date 2026-10-17
+ */
+
+#include "collisionRayBatch.h"
+#include "collisionEntry.h"
+#include "collisionNode.h"
+#include "collisionRay.h"
+#include "collisionSphere.h"
+#include "collisionBox.h"
+#include "collisionPolygon.h"
+#include "collisionMesh.h"
+#include "config_collide.h"
+#include "geomNode.h"
+#include "geom.h"
+#include "geomVertexReader.h"
+#include "lodNode.h"
+#include "workingNodePath.h"
+#include "finiteBoundingVolume.h"
+#include "lightMutexHolder.h"
+#include "pdeque.h"
+
+// The rays are traced through the scene in packets of up to this many rays.
+static const int packet_size = 64;
+
+/**
+ * Traces a range of the rays through the scene, one packet at a time.  Each
+ * thread that takes part in a raycast has its own Tracer.
+ */
+class CollisionRayBatch::Tracer {
+public:
+  Tracer(CollisionRayBatch *batch, CollideMask mask);
+
+  void trace(const NodePath &root, int begin, int end);
+
+  // A set of rays, in the coordinate space of one node.  Each component is
+  // stored in its own array, so that the rays can be tested against a solid
+  // in a tight loop.
+  class Packet {
+  public:
+    void clear();
+    void add(const Packet &from, size_t i, PN_stdfloat t);
+    void add(int ray, const LPoint3 &origin, const LVector3 &direction,
+             PN_stdfloat t);
+    size_t size() const { return _rays.size(); }
+
+    pvector<int> _rays;
+    pvector<PN_stdfloat> _origin[3];
+    pvector<PN_stdfloat> _direction[3];
+    pvector<PN_stdfloat> _inv_direction[3];
+
+    // The distance to the closest hit found so far.  This may be out of date,
+    // if a closer hit was found at a lower node, so it is only used to skip
+    // work.
+    pvector<PN_stdfloat> _t;
+  };
+
+  // The rays that reach one level of the scene graph.
+  class Level {
+  public:
+    Packet _packet;
+    LMatrix4 _root_to_local;
+
+    // The index of this node's path in _paths, once a ray has hit it.
+    int _path;
+  };
+
+private:
+  void r_trace(const WorkingNodePath &node_path, size_t depth,
+               CollideMask include_mask);
+  void visit_child(const WorkingNodePath &parent_path, size_t depth,
+                   PandaNode *child, CollideMask include_mask);
+  bool select(const Packet &packet, const BoundingVolume *bounds,
+              Packet &result, const LMatrix4 *mat);
+
+  void trace_solid(Level &level, const CollisionSolid *solid,
+                   CollisionNode *cnode, const WorkingNodePath &node_path);
+  void trace_sphere(Level &level, const CollisionSphere *sphere,
+                    const WorkingNodePath &node_path);
+  void trace_box(Level &level, const CollisionBox *box,
+                 const WorkingNodePath &node_path);
+  void trace_polygon(Level &level, const CollisionPolygon *polygon,
+                     const WorkingNodePath &node_path);
+  void trace_mesh(Level &level, const CollisionMesh *mesh,
+                  const WorkingNodePath &node_path);
+  void trace_geom(Level &level, const Geom *geom, bool cull,
+                  const WorkingNodePath &node_path);
+  void trace_triangle(Level &level, Packet &packet, const LPoint3 &a,
+                      const LPoint3 &b, const LPoint3 &c,
+                      const WorkingNodePath &node_path);
+
+  void record_hit(Level &level, Packet &packet, size_t i, PN_stdfloat t,
+                  const LVector3 &normal, const WorkingNodePath &node_path);
+
+public:
+  CollisionRayBatch *_batch;
+  CollideMask _mask;
+  Thread *_current_thread;
+
+  // Indexed by depth in the scene graph.  A deque, so that a Level stays put
+  // while deeper levels are added.
+  pdeque<Level> _levels;
+
+  // The paths to the nodes that were hit, in the order they were found.
+  pvector<NodePath> _paths;
+
+  // Scratch space for the rays that reach a particular solid or Geom.
+  Packet _subset;
+  pvector<unsigned char> _flags;
+  pvector<LPoint3> _points;
+  pvector<LVector3> _edge_normals;
+};
+
+/**
+ *
+ */
+CollisionRayBatch::
+CollisionRayBatch() :
+  _num_hits(0)
+{
+}
+
+/**
+ * Forgets the hits of the last cast, in preparation for casting the rays
+ * again.
+ */
+void CollisionRayBatch::
+clear_hits() {
+  size_t num_rays = _rays.size();
+  for (size_t i = 0; i < num_rays; ++i) {
+    _hits[i]._t = _rays[i]._max_t;
+    _hits[i]._path = -1;
+  }
+  _hit_paths.clear();
+  _num_hits = 0;
+}
+
+/**
+ * Casts the rays with indices between begin and end into the scene below the
+ * indicated root, recording the first hit of each one.  This is called by
+ * CollisionTraverser::raycast_batch(); several threads may trace different
+ * ranges of the same batch at once.
+ */
+void CollisionRayBatch::
+trace(const NodePath &root, CollideMask mask, int begin, int end) {
+  nassertv(begin >= 0 && begin <= end && end <= (int)_rays.size());
+
+  Tracer tracer(this, mask);
+  tracer.trace(root, begin, end);
+
+  // Now add the paths that this tracer found to the shared list, and point
+  // our rays at them.
+  LightMutexHolder holder(_lock);
+  int first_path = (int)_hit_paths.size();
+  _hit_paths.insert(_hit_paths.end(), tracer._paths.begin(), tracer._paths.end());
+  for (int i = begin; i < end; ++i) {
+    if (_hits[i]._path >= 0) {
+      _hits[i]._path += first_path;
+      ++_num_hits;
+    }
+  }
+}
+
+/**
+ * Tests a ray against a solid the usual way, with a temporary CollisionRay.
+ * The ray is given in the solid's own coordinate space.  If there is an
+ * intersection, fills in the parametric distance to it and its surface
+ * normal, and returns true.
+ */
+bool CollisionRayBatch::
+test_solid(const CollisionSolid *solid, const LPoint3 &origin,
+           const LVector3 &direction, CollisionNode *cnode,
+           const NodePath &node_path, PN_stdfloat &t, LVector3 &normal) {
+  PT(CollisionRay) ray = new CollisionRay(origin, direction);
+
+  // The ray is in the same space as the solid, so both sides of the entry
+  // have the same path.
+  CollisionEntry entry;
+  entry._from = ray;
+  entry._into = solid;
+  entry._from_node = cnode;
+  entry._into_node = cnode;
+  entry._from_node_path = node_path;
+  entry._into_node_path = node_path;
+
+  PT(CollisionEntry) result = ray->test_intersection(entry);
+  if (result == nullptr || !result->has_surface_point()) {
+    return false;
+  }
+
+  PN_stdfloat length_squared = direction.length_squared();
+  if (length_squared == 0.0f) {
+    return false;
+  }
+  t = (result->_surface_point - origin).dot(direction) / length_squared;
+  normal = result->has_surface_normal() ? result->_surface_normal : LVector3::zero();
+  return true;
+}
+
+/**
+ *
+ */
+CollisionRayBatch::Tracer::
+Tracer(CollisionRayBatch *batch, CollideMask mask) :
+  _batch(batch),
+  _mask(mask),
+  _current_thread(Thread::get_current_thread())
+{
+}
+
+/**
+ * Traces the rays with indices between begin and end.
+ */
+void CollisionRayBatch::Tracer::
+trace(const NodePath &root, int begin, int end) {
+  PandaNode *node = root.node();
+  if ((node->get_net_collide_mask() & _mask).is_zero()) {
+    return;
+  }
+
+  if (_levels.empty()) {
+    _levels.push_back(Level());
+  }
+
+  for (int first = begin; first < end; first += packet_size) {
+    int last = std::min(first + packet_size, end);
+
+    // The rays are given in the space of the root node.
+    Level &level = _levels[0];
+    level._packet.clear();
+    level._root_to_local = LMatrix4::ident_mat();
+    for (int r = first; r < last; ++r) {
+      const Ray &ray = _batch->_rays[r];
+      level._packet.add(r, ray._origin, ray._direction, _batch->_hits[r]._t);
+    }
+
+    r_trace(WorkingNodePath(root), 0, _mask);
+  }
+}
+
+/**
+ * Tests the rays that reach the indicated node against its solids or
+ * geometry, and continues with its children.  The rays have already been
+ * transformed into the node's space.
+ */
+void CollisionRayBatch::Tracer::
+r_trace(const WorkingNodePath &node_path, size_t depth, CollideMask include_mask) {
+  PandaNode *node = node_path.node();
+  Level &level = _levels[depth];
+  level._path = -1;
+
+  if (node->is_collision_node()) {
+    CollisionNode *cnode;
+    DCAST_INTO_V(cnode, node);
+    if (!(cnode->get_into_collide_mask() & include_mask).is_zero()) {
+      int num_solids = cnode->get_num_solids();
+      for (int s = 0; s < num_solids; ++s) {
+        CPT(CollisionSolid) solid = cnode->get_solid(s);
+        trace_solid(level, solid, cnode, node_path);
+      }
+    }
+
+  } else if (node->is_geom_node()) {
+    GeomNode *gnode;
+    DCAST_INTO_V(gnode, node);
+    if (!(gnode->get_into_collide_mask() & include_mask).is_zero()) {
+      int num_geoms = gnode->get_num_geoms();
+      for (int s = 0; s < num_geoms; ++s) {
+        // If there is just one Geom, the node's bounds, which we already
+        // tested, are the same as its bounds.
+        trace_geom(level, gnode->get_geom(s), num_geoms > 1, node_path);
+      }
+    }
+  }
+
+  // Choose the children the same way the CollisionTraverser does.
+  if (node->has_single_child_visibility()) {
+    int index = node->get_visible_child();
+    if (index >= 0 && index < node->get_num_children()) {
+      visit_child(node_path, depth, node->get_child(index), include_mask);
+    }
+
+  } else if (node->is_lod_node()) {
+    int index = DCAST(LODNode, node)->get_lowest_switch();
+    PandaNode::Children children = node->get_children();
+    int num_children = children.get_num_children();
+    for (int i = 0; i < num_children; ++i) {
+      CollideMask child_mask = include_mask;
+      if (i != index) {
+        child_mask &= ~GeomNode::get_default_collide_mask();
+      }
+      visit_child(node_path, depth, children.get_child(i), child_mask);
+    }
+
+  } else {
+    PandaNode::Children children = node->get_children();
+    int num_children = children.get_num_children();
+    for (int i = 0; i < num_children; ++i) {
+      visit_child(node_path, depth, children.get_child(i), include_mask);
+    }
+  }
+}
+
+/**
+ * Traces the rays of the indicated level that pass through the bounding
+ * volume of the indicated child.
+ */
+void CollisionRayBatch::Tracer::
+visit_child(const WorkingNodePath &parent_path, size_t depth,
+            PandaNode *child, CollideMask include_mask) {
+  if ((child->get_net_collide_mask() & include_mask).is_zero()) {
+    return;
+  }
+
+  CPT(TransformState) transform = child->get_transform(_current_thread);
+  if (transform->is_invalid()) {
+    return;
+  }
+
+  if (_levels.size() <= depth + 1) {
+    _levels.push_back(Level());
+  }
+  const Level &parent = _levels[depth];
+  Level &level = _levels[depth + 1];
+
+  // The child's bounds are in our space, so we test our rays before
+  // transforming them into the child's space.
+  CPT(BoundingVolume) bounds = child->get_bounds(_current_thread);
+  if (transform->is_identity()) {
+    if (!select(parent._packet, bounds, level._packet, nullptr)) {
+      return;
+    }
+    level._root_to_local = parent._root_to_local;
+
+  } else {
+    CPT(TransformState) inv_transform = transform->get_inverse();
+    if (!inv_transform->has_mat()) {
+      return;
+    }
+    const LMatrix4 &mat = inv_transform->get_mat();
+    if (!select(parent._packet, bounds, level._packet, &mat)) {
+      return;
+    }
+    level._root_to_local = parent._root_to_local * mat;
+  }
+
+  r_trace(WorkingNodePath(parent_path, child), depth + 1, include_mask);
+}
+
+/**
+ * Fills result with the rays of the packet that pass through the indicated
+ * bounding volume before their closest hit so far, transformed by the
+ * indicated matrix, if any.  Returns true if there are any.
+ */
+bool CollisionRayBatch::Tracer::
+select(const Packet &packet, const BoundingVolume *bounds, Packet &result,
+       const LMatrix4 *mat) {
+  result.clear();
+
+  size_t num_rays = packet.size();
+  _flags.resize(num_rays);
+
+  const GeometricBoundingVolume *gbv = bounds->as_geometric_bounding_volume();
+  const FiniteBoundingVolume *fbv = nullptr;
+  if (gbv != nullptr) {
+    if (gbv->is_empty()) {
+      return false;
+    }
+    if (!gbv->is_infinite()) {
+      fbv = gbv->as_finite_bounding_volume();
+    }
+  }
+
+  if (fbv == nullptr) {
+    // We can't rule out any of the rays.
+    std::fill(_flags.begin(), _flags.end(), 1);
+
+  } else {
+    // Intersect each ray with the slabs of the box around the volume.
+    LPoint3 min_point = fbv->get_min();
+    LPoint3 max_point = fbv->get_max();
+
+    const PN_stdfloat *ox = packet._origin[0].data();
+    const PN_stdfloat *oy = packet._origin[1].data();
+    const PN_stdfloat *oz = packet._origin[2].data();
+    const PN_stdfloat *ix = packet._inv_direction[0].data();
+    const PN_stdfloat *iy = packet._inv_direction[1].data();
+    const PN_stdfloat *iz = packet._inv_direction[2].data();
+    const PN_stdfloat *pt = packet._t.data();
+    unsigned char *flags = _flags.data();
+
+    for (size_t i = 0; i < num_rays; ++i) {
+      PN_stdfloat x0 = (min_point[0] - ox[i]) * ix[i];
+      PN_stdfloat x1 = (max_point[0] - ox[i]) * ix[i];
+      PN_stdfloat y0 = (min_point[1] - oy[i]) * iy[i];
+      PN_stdfloat y1 = (max_point[1] - oy[i]) * iy[i];
+      PN_stdfloat z0 = (min_point[2] - oz[i]) * iz[i];
+      PN_stdfloat z1 = (max_point[2] - oz[i]) * iz[i];
+
+      PN_stdfloat t_near = std::max(std::max(std::min(x0, x1), std::min(y0, y1)),
+                                    std::max(std::min(z0, z1), (PN_stdfloat)0.0f));
+      PN_stdfloat t_far = std::min(std::min(std::max(x0, x1), std::max(y0, y1)),
+                                   std::min(std::max(z0, z1), pt[i]));
+      flags[i] = (t_near <= t_far);
+    }
+  }
+
+  for (size_t i = 0; i < num_rays; ++i) {
+    if (!_flags[i]) {
+      continue;
+    }
+    int ray = packet._rays[i];
+    PN_stdfloat t = _batch->_hits[ray]._t;
+    if (mat == nullptr) {
+      result.add(packet, i, t);
+    } else {
+      LPoint3 origin(packet._origin[0][i], packet._origin[1][i], packet._origin[2][i]);
+      LVector3 direction(packet._direction[0][i], packet._direction[1][i], packet._direction[2][i]);
+      result.add(ray, mat->xform_point(origin), mat->xform_vec(direction), t);
+    }
+  }
+
+  return result.size() != 0;
+}
+
+/**
+ * Tests the rays of the level against the indicated solid.
+ */
+void CollisionRayBatch::Tracer::
+trace_solid(Level &level, const CollisionSolid *solid, CollisionNode *cnode,
+            const WorkingNodePath &node_path) {
+  TypeHandle type = solid->get_type();
+  if (type == CollisionPolygon::get_class_type()) {
+    trace_polygon(level, (const CollisionPolygon *)solid, node_path);
+
+  } else if (type == CollisionSphere::get_class_type()) {
+    trace_sphere(level, (const CollisionSphere *)solid, node_path);
+
+  } else if (type == CollisionBox::get_class_type()) {
+    trace_box(level, (const CollisionBox *)solid, node_path);
+
+  } else if (type == CollisionMesh::get_class_type()) {
+    trace_mesh(level, (const CollisionMesh *)solid, node_path);
+
+  } else {
+    // Some other kind of solid.  Test it the usual way, but only with the
+    // rays that reach its bounding volume.
+    CPT(BoundingVolume) bounds = solid->get_bounds();
+    if (!select(level._packet, bounds, _subset, nullptr)) {
+      return;
+    }
+
+    NodePath path = node_path.get_node_path();
+    size_t num_rays = _subset.size();
+    for (size_t i = 0; i < num_rays; ++i) {
+      LPoint3 origin(_subset._origin[0][i], _subset._origin[1][i], _subset._origin[2][i]);
+      LVector3 direction(_subset._direction[0][i], _subset._direction[1][i], _subset._direction[2][i]);
+      PN_stdfloat t;
+      LVector3 normal;
+      if (test_solid(solid, origin, direction, cnode, path, t, normal) &&
+          t < _subset._t[i]) {
+        record_hit(level, _subset, i, t, normal, node_path);
+      }
+    }
+  }
+}
+
+/**
+ * Tests the rays of the level against the indicated sphere.
+ */
+void CollisionRayBatch::Tracer::
+trace_sphere(Level &level, const CollisionSphere *sphere,
+             const WorkingNodePath &node_path) {
+  Packet &packet = level._packet;
+  LPoint3 center = sphere->get_center();
+  PN_stdfloat radius = sphere->get_radius();
+  PN_stdfloat radius_squared = radius * radius;
+
+  size_t num_rays = packet.size();
+  for (size_t i = 0; i < num_rays; ++i) {
+    PN_stdfloat dx = packet._direction[0][i];
+    PN_stdfloat dy = packet._direction[1][i];
+    PN_stdfloat dz = packet._direction[2][i];
+    PN_stdfloat cx = packet._origin[0][i] - center[0];
+    PN_stdfloat cy = packet._origin[1][i] - center[1];
+    PN_stdfloat cz = packet._origin[2][i] - center[2];
+
+    // Solve for the points along the ray at the sphere's radius.
+    PN_stdfloat a = dx * dx + dy * dy + dz * dz;
+    PN_stdfloat b = cx * dx + cy * dy + cz * dz;
+    PN_stdfloat c = cx * cx + cy * cy + cz * cz - radius_squared;
+    PN_stdfloat discriminant = b * b - a * c;
+    if (discriminant < 0.0f || a == 0.0f) {
+      continue;
+    }
+
+    PN_stdfloat root = csqrt(discriminant);
+    if (-b + root < 0.0f) {
+      // The sphere is behind the ray.
+      continue;
+    }
+
+    // If the ray starts inside the sphere, the hit is at its origin.
+    PN_stdfloat t = std::max((-b - root) / a, (PN_stdfloat)0.0f);
+    if (t >= packet._t[i]) {
+      continue;
+    }
+
+    LVector3 normal;
+    if (sphere->has_effective_normal()) {
+      normal = sphere->get_effective_normal();
+    } else {
+      normal.set(cx + t * dx, cy + t * dy, cz + t * dz);
+      normal.normalize();
+    }
+    record_hit(level, packet, i, t, normal, node_path);
+  }
+}
+
+/**
+ * Tests the rays of the level against the indicated box.
+ */
+void CollisionRayBatch::Tracer::
+trace_box(Level &level, const CollisionBox *box,
+          const WorkingNodePath &node_path) {
+  Packet &packet = level._packet;
+  const LPoint3 &min_point = box->get_min();
+  const LPoint3 &max_point = box->get_max();
+  const PN_stdfloat huge = std::numeric_limits<PN_stdfloat>::max();
+
+  size_t num_rays = packet.size();
+  for (size_t i = 0; i < num_rays; ++i) {
+    // Keep track of which slab the ray enters and leaves last and first, so
+    // that we know which face it hits.
+    PN_stdfloat t_near = -huge;
+    PN_stdfloat t_far = huge;
+    int near_axis = 0;
+    int far_axis = 0;
+    for (int k = 0; k < 3; ++k) {
+      PN_stdfloat t0 = (min_point[k] - packet._origin[k][i]) * packet._inv_direction[k][i];
+      PN_stdfloat t1 = (max_point[k] - packet._origin[k][i]) * packet._inv_direction[k][i];
+      if (std::min(t0, t1) > t_near) {
+        t_near = std::min(t0, t1);
+        near_axis = k;
+      }
+      if (std::max(t0, t1) < t_far) {
+        t_far = std::max(t0, t1);
+        far_axis = k;
+      }
+    }
+    if (t_near > t_far || t_far < 0.0f) {
+      continue;
+    }
+
+    // As with a CollisionRay, if the origin is inside the box, the hit is
+    // where the ray leaves it.
+    bool inside = (t_near < 0.0f);
+    PN_stdfloat t = inside ? t_far : t_near;
+    if (t >= packet._t[i]) {
+      continue;
+    }
+
+    LVector3 normal;
+    if (box->has_effective_normal()) {
+      normal = box->get_effective_normal();
+    } else {
+      // The face faces against the ray where it enters, and along it where
+      // it leaves.
+      int axis = inside ? far_axis : near_axis;
+      bool positive = (packet._direction[axis][i] > 0.0f) == inside;
+      normal = LVector3::zero();
+      normal[axis] = positive ? 1.0f : -1.0f;
+    }
+    record_hit(level, packet, i, t, normal, node_path);
+  }
+}
+
+/**
+ * Tests the rays of the level against the indicated polygon.
+ */
+void CollisionRayBatch::Tracer::
+trace_polygon(Level &level, const CollisionPolygon *polygon,
+              const WorkingNodePath &node_path) {
+  size_t num_points = polygon->get_num_points();
+  if (num_points < 3) {
+    return;
+  }
+
+  LPlane plane = polygon->get_plane();
+  LVector3 plane_normal = plane.get_normal();
+
+  // The polygon is convex, so a point of its plane is inside it if it is on
+  // the inner side of every edge.
+  _points.clear();
+  _edge_normals.clear();
+  for (size_t p = 0; p < num_points; ++p) {
+    _points.push_back(polygon->get_point(p));
+  }
+  for (size_t p = 0; p < num_points; ++p) {
+    const LPoint3 &next = _points[(p + 1) % num_points];
+    _edge_normals.push_back(plane_normal.cross(next - _points[p]));
+  }
+
+  LVector3 normal = polygon->has_effective_normal()
+    ? polygon->get_effective_normal() : plane_normal;
+
+  Packet &packet = level._packet;
+  size_t num_rays = packet.size();
+  for (size_t i = 0; i < num_rays; ++i) {
+    LPoint3 origin(packet._origin[0][i], packet._origin[1][i], packet._origin[2][i]);
+    LVector3 direction(packet._direction[0][i], packet._direction[1][i], packet._direction[2][i]);
+
+    PN_stdfloat denominator = plane_normal.dot(direction);
+    if (denominator == 0.0f) {
+      continue;
+    }
+    PN_stdfloat t = -plane.dist_to_plane(origin) / denominator;
+    if (t < 0.0f || t >= packet._t[i]) {
+      continue;
+    }
+
+    LPoint3 point = origin + t * direction;
+    bool inside = true;
+    for (size_t p = 0; p < num_points && inside; ++p) {
+      inside = (_edge_normals[p].dot(point - _points[p]) >= 0.0f);
+    }
+    if (inside) {
+      record_hit(level, packet, i, t, normal, node_path);
+    }
+  }
+}
+
+/**
+ * Tests the rays of the level against the indicated mesh.
+ */
+void CollisionRayBatch::Tracer::
+trace_mesh(Level &level, const CollisionMesh *mesh,
+           const WorkingNodePath &node_path) {
+  Packet &packet = level._packet;
+  size_t num_rays = packet.size();
+  for (size_t i = 0; i < num_rays; ++i) {
+    LPoint3 origin(packet._origin[0][i], packet._origin[1][i], packet._origin[2][i]);
+    LVector3 direction(packet._direction[0][i], packet._direction[1][i], packet._direction[2][i]);
+    PN_stdfloat t;
+    LVector3 normal;
+    if (mesh->trace_ray(origin, direction, packet._t[i], t, normal) &&
+        t < packet._t[i]) {
+      record_hit(level, packet, i, t, normal, node_path);
+    }
+  }
+}
+
+/**
+ * Tests the rays of the level against the triangles of the indicated Geom.
+ * If cull is true, the rays are first tested against the Geom's bounding
+ * volume.
+ */
+void CollisionRayBatch::Tracer::
+trace_geom(Level &level, const Geom *geom, bool cull,
+           const WorkingNodePath &node_path) {
+  if (geom->get_primitive_type() != Geom::PT_polygons) {
+    return;
+  }
+
+  Packet *packet = &level._packet;
+  if (cull) {
+    CPT(BoundingVolume) bounds = geom->get_bounds(_current_thread);
+    if (!select(level._packet, bounds, _subset, nullptr)) {
+      return;
+    }
+    packet = &_subset;
+  }
+
+  CPT(GeomVertexData) data = geom->get_animated_vertex_data(true, _current_thread);
+  GeomVertexReader vertex(data, InternalName::get_vertex(), _current_thread);
+  if (!vertex.has_column()) {
+    return;
+  }
+
+  int num_primitives = geom->get_num_primitives();
+  for (int i = 0; i < num_primitives; ++i) {
+    CPT(GeomPrimitive) tris = geom->get_primitive(i)->decompose();
+    int num_vertices = tris->get_num_vertices();
+
+    LPoint3 v[3];
+    if (tris->is_indexed()) {
+      GeomVertexReader index(tris->get_vertices(), 0);
+      for (int n = 0; n + 2 < num_vertices; n += 3) {
+        for (int k = 0; k < 3; ++k) {
+          vertex.set_row_unsafe(index.get_data1i());
+          v[k] = vertex.get_data3();
+        }
+        if (CollisionPolygon::verify_points(v[0], v[1], v[2])) {
+          trace_triangle(level, *packet, v[0], v[1], v[2], node_path);
+        }
+      }
+    } else {
+      vertex.set_row_unsafe(tris->get_first_vertex());
+      for (int n = 0; n + 2 < num_vertices; n += 3) {
+        for (int k = 0; k < 3; ++k) {
+          v[k] = vertex.get_data3();
+        }
+        if (CollisionPolygon::verify_points(v[0], v[1], v[2])) {
+          trace_triangle(level, *packet, v[0], v[1], v[2], node_path);
+        }
+      }
+    }
+  }
+}
+
+/**
+ * Tests the rays of the packet against the indicated triangle, which faces
+ * the side from which its vertices appear counterclockwise.
+ */
+void CollisionRayBatch::Tracer::
+trace_triangle(Level &level, Packet &packet, const LPoint3 &a,
+               const LPoint3 &b, const LPoint3 &c,
+               const WorkingNodePath &node_path) {
+  LVector3 e1 = b - a;
+  LVector3 e2 = c - a;
+
+  const PN_stdfloat *ox = packet._origin[0].data();
+  const PN_stdfloat *oy = packet._origin[1].data();
+  const PN_stdfloat *oz = packet._origin[2].data();
+  const PN_stdfloat *dx = packet._direction[0].data();
+  const PN_stdfloat *dy = packet._direction[1].data();
+  const PN_stdfloat *dz = packet._direction[2].data();
+
+  size_t num_rays = packet.size();
+  for (size_t i = 0; i < num_rays; ++i) {
+    // This is the Moller-Trumbore test, one component at a time.
+    PN_stdfloat px = dy[i] * e2[2] - dz[i] * e2[1];
+    PN_stdfloat py = dz[i] * e2[0] - dx[i] * e2[2];
+    PN_stdfloat pz = dx[i] * e2[1] - dy[i] * e2[0];
+    PN_stdfloat det = e1[0] * px + e1[1] * py + e1[2] * pz;
+    if (det == 0.0f) {
+      continue;
+    }
+    PN_stdfloat inv_det = 1.0f / det;
+
+    PN_stdfloat sx = ox[i] - a[0];
+    PN_stdfloat sy = oy[i] - a[1];
+    PN_stdfloat sz = oz[i] - a[2];
+    PN_stdfloat u = (sx * px + sy * py + sz * pz) * inv_det;
+    if (u < 0.0f || u > 1.0f) {
+      continue;
+    }
+
+    PN_stdfloat qx = sy * e1[2] - sz * e1[1];
+    PN_stdfloat qy = sz * e1[0] - sx * e1[2];
+    PN_stdfloat qz = sx * e1[1] - sy * e1[0];
+    PN_stdfloat v = (dx[i] * qx + dy[i] * qy + dz[i] * qz) * inv_det;
+    if (v < 0.0f || u + v > 1.0f) {
+      continue;
+    }
+
+    PN_stdfloat t = (e2[0] * qx + e2[1] * qy + e2[2] * qz) * inv_det;
+    if (t < 0.0f || t >= packet._t[i]) {
+      continue;
+    }
+
+    LVector3 normal = e1.cross(e2);
+    normal.normalize();
+    record_hit(level, packet, i, t, normal, node_path);
+  }
+}
+
+/**
+ * Records a hit of the ith ray of the packet at the indicated distance, if it
+ * is closer than any found so far.  The normal is in the level's space.
+ */
+void CollisionRayBatch::Tracer::
+record_hit(Level &level, Packet &packet, size_t i, PN_stdfloat t,
+           const LVector3 &normal, const WorkingNodePath &node_path) {
+  Hit &hit = _batch->_hits[packet._rays[i]];
+  if (t >= hit._t) {
+    return;
+  }
+  hit._t = t;
+  packet._t[i] = t;
+
+  // Normals are transformed by the inverse transpose, so we apply the
+  // root-to-local matrix from the other side to get back to the root's space.
+  const LMatrix4 &m = level._root_to_local;
+  hit._normal.set(m(0, 0) * normal[0] + m(0, 1) * normal[1] + m(0, 2) * normal[2],
+                  m(1, 0) * normal[0] + m(1, 1) * normal[1] + m(1, 2) * normal[2],
+                  m(2, 0) * normal[0] + m(2, 1) * normal[1] + m(2, 2) * normal[2]);
+  hit._normal.normalize();
+
+  if (level._path < 0) {
+    level._path = (int)_paths.size();
+    _paths.push_back(node_path.get_node_path());
+  }
+  hit._path = level._path;
+}
+
+/**
+ *
+ */
+void CollisionRayBatch::Tracer::Packet::
+clear() {
+  _rays.clear();
+  for (int k = 0; k < 3; ++k) {
+    _origin[k].clear();
+    _direction[k].clear();
+    _inv_direction[k].clear();
+  }
+  _t.clear();
+}
+
+/**
+ * Adds the ith ray of the other packet.
+ */
+void CollisionRayBatch::Tracer::Packet::
+add(const Packet &from, size_t i, PN_stdfloat t) {
+  _rays.push_back(from._rays[i]);
+  for (int k = 0; k < 3; ++k) {
+    _origin[k].push_back(from._origin[k][i]);
+    _direction[k].push_back(from._direction[k][i]);
+    _inv_direction[k].push_back(from._inv_direction[k][i]);
+  }
+  _t.push_back(t);
+}
+
+/**
+ * Adds the indicated ray.
+ */
+void CollisionRayBatch::Tracer::Packet::
+add(int ray, const LPoint3 &origin, const LVector3 &direction, PN_stdfloat t) {
+  _rays.push_back(ray);
+  for (int k = 0; k < 3; ++k) {
+    _origin[k].push_back(origin[k]);
+    _direction[k].push_back(direction[k]);
+
+    // A huge value in place of infinity keeps the slab tests free of NaNs
+    // for rays parallel to an axis.
+    _inv_direction[k].push_back((direction[k] != 0.0f)
+      ? 1.0f / direction[k] : std::numeric_limits<PN_stdfloat>::max());
+  }
+  _t.push_back(t);
+}
@@ -0,0 +1,112 @@
+/**
+ * PANDA 3D SOFTWARE
+ * Copyright (c) Carnegie Mellon University.  All rights reserved.
+ *
+ * All use of this software is subject to the terms of the revised BSD
+ * license.  You should have received a copy of this license along
+ * with this source code in a file named "LICENSE."
+ *
+ * @file collisionRayBatch.h
+ * @author blablabla94
+ * @date 2026-10-17
+ */
+
+#ifndef COLLISIONRAYBATCH_H
+#define COLLISIONRAYBATCH_H
+
+#include "pandabase.h"
+#include "referenceCount.h"
+#include "collideMask.h"
+#include "nodePath.h"
+#include "lightMutex.h"
+#include "pvector.h"
+
+#include <limits>
+
+class CollisionSolid;
+class CollisionNode;
+
+/**
+ * A list of rays to be cast into the scene all at once, with
+ * CollisionTraverser::raycast_batch(), along with the first thing that each
+ * of them hits.  This is intended for the many line-of-sight and picking
+ * queries that a game may need each frame.
+ *
+ * This is much faster than testing each ray with its own CollisionRay and
+ * CollisionHandlerQueue.  The rays are traced through the scene graph in
+ * packets, so that the work of visiting each node is shared by all of the
+ * rays that reach it, and the results are stored in flat arrays instead of
+ * in a CollisionEntry for each hit.
+ *
+ * CollisionPolygon, CollisionSphere, CollisionBox and CollisionMesh solids and
+ * visible geometry are tested directly; other solids are tested as they would
+ * be with a CollisionRay.  Clip planes are not taken into account.
+ */
+class EXPCL_PANDA_COLLIDE CollisionRayBatch : public ReferenceCount {
+PUBLISHED:
+  CollisionRayBatch();
+
+  INLINE void clear();
+  INLINE void reserve(int num_rays);
+  INLINE int add_ray(const LPoint3 &origin, const LVector3 &direction);
+  INLINE int add_segment(const LPoint3 &point_a, const LPoint3 &point_b);
+
+  INLINE int get_num_rays() const;
+  INLINE const LPoint3 &get_origin(int n) const;
+  INLINE const LVector3 &get_direction(int n) const;
+
+  INLINE int get_num_hits() const;
+  INLINE bool has_hit(int n) const;
+  INLINE PN_stdfloat get_hit_t(int n) const;
+  INLINE LPoint3 get_hit_pos(int n) const;
+  INLINE const LVector3 &get_hit_normal(int n) const;
+  INLINE NodePath get_hit_node_path(int n) const;
+
+  MAKE_PROPERTY(num_rays, get_num_rays);
+  MAKE_PROPERTY(num_hits, get_num_hits);
+
+public:
+  void clear_hits();
+  void trace(const NodePath &root, CollideMask mask, int begin, int end);
+
+private:
+  static bool test_solid(const CollisionSolid *solid, const LPoint3 &origin,
+                         const LVector3 &direction, CollisionNode *cnode,
+                         const NodePath &node_path, PN_stdfloat &t,
+                         LVector3 &normal);
+
+  class Tracer;
+
+  class Ray {
+  public:
+    LPoint3 _origin;
+    LVector3 _direction;
+    PN_stdfloat _max_t;
+  };
+
+  // The closest hit found so far for each ray.  _t starts out at the ray's
+  // _max_t, and _path is the index of the hit node in _hit_paths, or -1 if
+  // the ray hasn't hit anything.
+  class Hit {
+  public:
+    PN_stdfloat _t;
+    LVector3 _normal;
+    int _path;
+  };
+
+  typedef pvector<Ray> Rays;
+  typedef pvector<Hit> Hits;
+  typedef pvector<NodePath> HitPaths;
+
+  Rays _rays;
+  Hits _hits;
+  HitPaths _hit_paths;
+  int _num_hits;
+
+  // Protects _hit_paths and _num_hits while several threads are tracing.
+  LightMutex _lock;
+};
+
+#include "collisionRayBatch.I"
+
+#endif
@@ -0,0 +1,368 @@
+/**
+ * PANDA 3D SOFTWARE
+ * Copyright (c) Carnegie Mellon University.  All rights reserved.
+ *
+ * All use of this software is subject to the terms of the revised BSD
+ * license.  You should have received a copy of this license along
+ * with this source code in a file named "LICENSE."
+ *
+ * @file collisionSweep.cxx
+ * @author blablabla94
+ * @date 2026-10-17
+ */
+
+#include "collisionSweep.h"
+#include "collisionEntry.h"
+#include "collisionSphere.h"
+#include "collisionCapsule.h"
+#include "config_collide.h"
+
+/**
+ * Sets up the path of the "from" solid of the indicated entry, in the space
+ * of its "into" solid.  If the "from" solid is not a sphere or a capsule, or
+ * it hasn't moved, is_moving() will return false.
+ */
+CollisionSweep::
+CollisionSweep(const CollisionEntry &entry) :
+  _radius(0.0f),
+  _moving(false),
+  _started_inside(false),
+  _has_hit(false),
+  _t(0.0f)
+{
+  CPT(TransformState) wrt_space = entry.get_wrt_space();
+  CPT(TransformState) wrt_prev_space = entry.get_wrt_prev_space();
+  if (wrt_prev_space == wrt_space) {
+    return;
+  }
+
+  const CollisionSolid *from = entry.get_from();
+  LPoint3 point_a, point_b;
+  PN_stdfloat radius;
+  if (from->is_of_type(CollisionSphere::get_class_type())) {
+    const CollisionSphere *sphere = (const CollisionSphere *)from;
+    point_a = sphere->get_center();
+    point_b = point_a;
+    radius = sphere->get_radius();
+
+  } else if (from->is_of_type(CollisionCapsule::get_class_type())) {
+    const CollisionCapsule *capsule = (const CollisionCapsule *)from;
+    point_a = capsule->get_point_a();
+    point_b = capsule->get_point_b();
+    radius = capsule->get_radius();
+
+  } else {
+    return;
+  }
+
+  // Only the first end of the segment is followed from its previous position;
+  // the segment keeps its current orientation along the way.
+  const LMatrix4 &wrt_mat = wrt_space->get_mat();
+  _origin = point_a * wrt_prev_space->get_mat();
+  _axis = wrt_mat.xform_vec(point_b - point_a);
+  _radius = (LVector3(radius, 0.0f, 0.0f) * wrt_mat).length();
+  _delta = point_a * wrt_mat - _origin;
+  _moving = (_delta != LVector3::zero());
+}
+
+/**
+ * Sweeps the mover against the indicated convex polygon, whose points are
+ * given in order around it.
+ */
+void CollisionSweep::
+sweep_polygon(const LPoint3 *points, size_t num_points) {
+  Range range;
+  add_faces(range, points, num_points);
+  finish(range);
+}
+
+/**
+ * Sweeps the mover against the indicated axis-aligned box.
+ */
+void CollisionSweep::
+sweep_box(const LPoint3 &min_point, const LPoint3 &max_point) {
+  LPoint3 corners[8];
+  for (int i = 0; i < 8; ++i) {
+    corners[i].set((i & 1) ? max_point[0] : min_point[0],
+                   (i & 2) ? max_point[1] : min_point[1],
+                   (i & 4) ? max_point[2] : min_point[2]);
+  }
+
+  // The corners of each face, in order around it.
+  static const int faces[6][4] = {
+    { 0, 2, 6, 4 }, { 1, 5, 7, 3 },
+    { 0, 4, 5, 1 }, { 2, 3, 7, 6 },
+    { 0, 1, 3, 2 }, { 4, 6, 7, 5 },
+  };
+
+  // The box is convex, so all of its faces go into the same range.
+  Range range;
+  for (int f = 0; f < 6; ++f) {
+    LPoint3 points[4];
+    for (int i = 0; i < 4; ++i) {
+      points[i] = corners[faces[f][i]];
+    }
+    add_faces(range, points, 4);
+  }
+  finish(range);
+}
+
+/**
+ * Returns a new CollisionEntry for the first contact that was found, or NULL
+ * if the mover didn't touch anything along its path.
+ *
+ * The interior point is as far below the surface point, along the normal, as
+ * the mover would have ended up past the point of contact if nothing had
+ * stopped it, so that a CollisionHandlerPusher pushes it back to the side it
+ * came from, even if it passed all the way through.
+ */
+PT(CollisionEntry) CollisionSweep::
+make_entry(const CollisionEntry &entry) const {
+  if (!_has_hit) {
+    return nullptr;
+  }
+
+  if (collide_cat.is_debug()) {
+    collide_cat.debug()
+      << "swept intersection detected from " << entry.get_from_node_path()
+      << " into " << entry.get_into_node_path() << " at t = " << _t << "\n";
+  }
+  PT(CollisionEntry) new_entry = new CollisionEntry(entry);
+
+  PN_stdfloat depth = std::max(-(1.0f - _t) * _delta.dot(_surface_normal),
+                               (PN_stdfloat)0.0f);
+
+  new_entry->set_surface_point(_surface_point);
+  new_entry->set_surface_normal(_surface_normal);
+  new_entry->set_interior_point(_surface_point - _surface_normal * depth);
+  new_entry->set_contact_pos(_origin + _axis * 0.5f + _delta * _t);
+  new_entry->set_contact_normal(_surface_normal);
+  new_entry->set_t(_t);
+
+  return new_entry;
+}
+
+/**
+ * Adds the pieces of the Minkowski sum of the indicated convex polygon and the
+ * mover to the range: a sphere around each vertex, a cylinder around each
+ * edge and a slab around each face, of the polygon and of its copy shifted
+ * back along the segment, and of the sides joining the two.
+ */
+void CollisionSweep::
+add_faces(Range &range, const LPoint3 *points, size_t num_points) const {
+  if (num_points < 3) {
+    return;
+  }
+
+  // Newell's method gives a normal that agrees with the order of the points.
+  LVector3 normal = LVector3::zero();
+  for (size_t i = 0; i < num_points; ++i) {
+    const LPoint3 &next = points[(i + 1) % num_points];
+    normal += LVector3(points[i]).cross(LVector3(next));
+  }
+  if (!normal.normalize()) {
+    return;
+  }
+
+  bool is_capsule = (_axis != LVector3::zero());
+  for (size_t i = 0; i < num_points; ++i) {
+    const LPoint3 &point = points[i];
+    const LPoint3 &next = points[(i + 1) % num_points];
+    add_vertex(range, point, 0.0f);
+    add_edge(range, point, next, 0.0f, 0.0f);
+
+    if (is_capsule) {
+      add_vertex(range, point - _axis, 1.0f);
+      add_edge(range, point - _axis, next - _axis, 1.0f, 1.0f);
+      add_edge(range, point, point - _axis, 0.0f, 1.0f);
+      add_side(range, point, next - point);
+    }
+  }
+
+  add_face(range, points, num_points, normal, 0.0f);
+  if (is_capsule) {
+    LPoint3 shifted[4];
+    pvector<LPoint3> shifted_vector;
+    LPoint3 *shifted_points = shifted;
+    if (num_points > 4) {
+      shifted_vector.resize(num_points);
+      shifted_points = &shifted_vector[0];
+    }
+    for (size_t i = 0; i < num_points; ++i) {
+      shifted_points[i] = points[i] - _axis;
+    }
+    add_face(range, shifted_points, num_points, normal, 1.0f);
+  }
+}
+
+/**
+ * Adds the times at which the path comes within the radius of the indicated
+ * point, which is a vertex of the solid shifted back by s times the segment.
+ */
+void CollisionSweep::
+add_vertex(Range &range, const LPoint3 &vertex, PN_stdfloat s) const {
+  LVector3 m = _origin - vertex;
+  PN_stdfloat t[2];
+  if (!solve_quadratic(_delta.dot(_delta), m.dot(_delta),
+                       m.dot(m) - _radius * _radius, t[0], t[1])) {
+    return;
+  }
+
+  for (int i = 0; i < 2; ++i) {
+    LVector3 normal = (_origin + _delta * t[i]) - vertex;
+    normal.normalize();
+    range.add(t[i], normal, vertex + _axis * s);
+  }
+}
+
+/**
+ * Adds the times at which the path comes within the radius of the inside of
+ * the indicated edge.  The ends of the edge are shifted back by s_from and s_to
+ * times the segment.
+ */
+void CollisionSweep::
+add_edge(Range &range, const LPoint3 &from, const LPoint3 &to,
+         PN_stdfloat s_from, PN_stdfloat s_to) const {
+  LVector3 edge = to - from;
+  PN_stdfloat length_2 = edge.dot(edge);
+  if (length_2 == 0.0f) {
+    return;
+  }
+
+  // Only the parts perpendicular to the edge matter.
+  LVector3 m = _origin - from;
+  LVector3 m_perp = m - edge * (m.dot(edge) / length_2);
+  LVector3 d_perp = _delta - edge * (_delta.dot(edge) / length_2);
+  PN_stdfloat t[2];
+  if (!solve_quadratic(d_perp.dot(d_perp), m_perp.dot(d_perp),
+                       m_perp.dot(m_perp) - _radius * _radius, t[0], t[1])) {
+    return;
+  }
+
+  for (int i = 0; i < 2; ++i) {
+    LPoint3 point = _origin + _delta * t[i];
+    PN_stdfloat f = (point - from).dot(edge) / length_2;
+    if (f < 0.0f || f > 1.0f) {
+      // The ends are covered by the vertices.
+      continue;
+    }
+    LPoint3 closest = from + edge * f;
+    LVector3 normal = point - closest;
+    normal.normalize();
+    PN_stdfloat s = s_from + (s_to - s_from) * f;
+    range.add(t[i], normal, closest + _axis * s);
+  }
+}
+
+/**
+ * Adds the times at which the path crosses the planes at the radius above and
+ * below the indicated face, within the face.  The face is shifted back by s
+ * times the segment.
+ */
+void CollisionSweep::
+add_face(Range &range, const LPoint3 *points, size_t num_points,
+         const LVector3 &normal, PN_stdfloat s) const {
+  PN_stdfloat d_normal = _delta.dot(normal);
+  if (d_normal == 0.0f) {
+    return;
+  }
+  PN_stdfloat dist = (_origin - points[0]).dot(normal);
+
+  for (int side = -1; side <= 1; side += 2) {
+    PN_stdfloat t = (side * _radius - dist) / d_normal;
+    LPoint3 point = _origin + _delta * t - normal * (side * _radius);
+
+    // The edges are covered by the cylinders, so the point need only be
+    // inside the face.
+    bool inside = true;
+    for (size_t i = 0; i < num_points && inside; ++i) {
+      const LPoint3 &next = points[(i + 1) % num_points];
+      inside = (normal.cross(next - points[i]).dot(point - points[i]) >= 0.0f);
+    }
+    if (inside) {
+      range.add(t, normal * (PN_stdfloat)side, point + _axis * s);
+    }
+  }
+}
+
+/**
+ * Adds the times at which the path crosses the planes at the radius on either
+ * side of the parallelogram swept by the indicated edge of a face, as it is
+ * shifted back along the segment, within that parallelogram.  This is where
+ * the inside of the segment touches the edge.
+ */
+void CollisionSweep::
+add_side(Range &range, const LPoint3 &point, const LVector3 &edge) const {
+  LVector3 normal = edge.cross(_axis);
+  if (!normal.normalize()) {
+    // The segment is parallel to the edge; the vertices and edges cover it.
+    return;
+  }
+  PN_stdfloat d_normal = _delta.dot(normal);
+  if (d_normal == 0.0f) {
+    return;
+  }
+  PN_stdfloat dist = (_origin - point).dot(normal);
+
+  PN_stdfloat ee = edge.dot(edge);
+  PN_stdfloat eu = edge.dot(_axis);
+  PN_stdfloat uu = _axis.dot(_axis);
+  PN_stdfloat det = eu * eu - ee * uu;
+
+  for (int side = -1; side <= 1; side += 2) {
+    PN_stdfloat t = (side * _radius - dist) / d_normal;
+    LVector3 q = (_origin + _delta * t - normal * (side * _radius)) - point;
+
+    // Find where on the parallelogram we are: q = alpha * edge - beta * axis.
+    PN_stdfloat qe = q.dot(edge);
+    PN_stdfloat qu = q.dot(_axis);
+    PN_stdfloat alpha = (eu * qu - uu * qe) / det;
+    PN_stdfloat beta = (ee * qu - eu * qe) / det;
+    if (alpha >= 0.0f && alpha <= 1.0f && beta >= 0.0f && beta <= 1.0f) {
+      range.add(t, normal * (PN_stdfloat)side, point + edge * alpha);
+    }
+  }
+}
+
+/**
+ * Checks the range of one convex piece, and keeps its first contact if it is
+ * the earliest one so far.
+ */
+void CollisionSweep::
+finish(const Range &range) {
+  if (range._t_in > range._t_out) {
+    // The path never comes near this piece.
+    return;
+  }
+
+  if (range._t_in <= 0.0f && range._t_out >= 0.0f) {
+    _started_inside = true;
+    return;
+  }
+
+  if (range._t_in > 0.0f && range._t_in <= 1.0f &&
+      (!_has_hit || range._t_in < _t)) {
+    _has_hit = true;
+    _t = range._t_in;
+    _surface_point = range._point;
+    _surface_normal = range._normal;
+  }
+}
+
+/**
+ * Solves a * t^2 + 2 * b * t + c = 0, returning the roots in increasing order.
+ * Returns false if there are none, or if a is zero.
+ */
+bool CollisionSweep::
+solve_quadratic(PN_stdfloat a, PN_stdfloat b, PN_stdfloat c,
+                PN_stdfloat &t1, PN_stdfloat &t2) {
+  PN_stdfloat discriminant = b * b - a * c;
+  if (a <= 0.0f || discriminant < 0.0f) {
+    return false;
+  }
+
+  PN_stdfloat root = csqrt(discriminant);
+  t1 = (-b - root) / a;
+  t2 = (-b + root) / a;
+  return true;
+}
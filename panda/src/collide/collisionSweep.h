@@ -0,0 +1,99 @@
+/**
+ * PANDA 3D SOFTWARE
+ * Copyright (c) Carnegie Mellon University.  All rights reserved.
+ *
+ * All use of this software is subject to the terms of the revised BSD
+ * license.  You should have received a copy of this license along
+ * with this source code in a file named "LICENSE."
+ *
+ * @file collisionSweep.h
+ * @author blablabla94
+ * @date 2026-10-17
+ */
+
+#ifndef COLLISIONSWEEP_H
+#define COLLISIONSWEEP_H
+
+#include "pandabase.h"
+#include "luse.h"
+#include "pointerTo.h"
+#include "cmath.h"
+
+class CollisionEntry;
+
+/**
+ * The path of a CollisionSphere or CollisionCapsule that moved in a straight
+ * line from its previous position to its current one, as seen in the space of
+ * a solid that it may have collided with.  This finds the time of impact: the
+ * first moment along the path at which the mover touched the solid.  It is
+ * used by the solids when the traverser is in continuous mode; see
+ * CollisionTraverser::set_continuous().
+ *
+ * The mover is treated as a segment with a radius around it, which is a single
+ * point for a sphere, and it is assumed to have moved without turning.  Each
+ * convex piece of the solid is tested against the Minkowski sum of itself, the
+ * segment and the radius, by finding where the path of one end of the segment
+ * enters and leaves that sum.
+ */
+class EXPCL_PANDA_COLLIDE CollisionSweep {
+public:
+  explicit CollisionSweep(const CollisionEntry &entry);
+
+  INLINE bool is_moving() const;
+  INLINE const LVector3 &get_delta() const;
+
+  void sweep_polygon(const LPoint3 *points, size_t num_points);
+  void sweep_box(const LPoint3 &min_point, const LPoint3 &max_point);
+
+  INLINE bool started_inside() const;
+  INLINE bool has_hit() const;
+  INLINE PN_stdfloat get_t() const;
+  INLINE const LPoint3 &get_surface_point() const;
+  INLINE const LVector3 &get_surface_normal() const;
+
+  PT(CollisionEntry) make_entry(const CollisionEntry &entry) const;
+
+private:
+  // The range of times during which the mover overlaps one convex piece,
+  // along with the point and normal of the first contact.
+  class Range {
+  public:
+    INLINE Range();
+    INLINE void add(PN_stdfloat t, const LVector3 &normal, const LPoint3 &point);
+
+    PN_stdfloat _t_in;
+    PN_stdfloat _t_out;
+    LVector3 _normal;
+    LPoint3 _point;
+  };
+
+  void add_faces(Range &range, const LPoint3 *points, size_t num_points) const;
+  void add_vertex(Range &range, const LPoint3 &vertex, PN_stdfloat s) const;
+  void add_edge(Range &range, const LPoint3 &from, const LPoint3 &to,
+                PN_stdfloat s_from, PN_stdfloat s_to) const;
+  void add_face(Range &range, const LPoint3 *points, size_t num_points,
+                const LVector3 &normal, PN_stdfloat s) const;
+  void add_side(Range &range, const LPoint3 &point, const LVector3 &edge) const;
+  void finish(const Range &range);
+
+  static bool solve_quadratic(PN_stdfloat a, PN_stdfloat b, PN_stdfloat c,
+                              PN_stdfloat &t1, PN_stdfloat &t2);
+
+  // The first end of the segment at its previous position, the vector to its
+  // other end, its radius, and the distance it moved.
+  LPoint3 _origin;
+  LVector3 _axis;
+  PN_stdfloat _radius;
+  LVector3 _delta;
+  bool _moving;
+
+  bool _started_inside;
+  bool _has_hit;
+  PN_stdfloat _t;
+  LPoint3 _surface_point;
+  LVector3 _surface_normal;
+};
+
+#include "collisionSweep.I"
+
+#endif
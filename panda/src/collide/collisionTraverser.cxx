@@ -23,8 +23,11 @@
 #include "collisionCapsule.h"
 #include "collisionPolygon.h"
 #include "collisionPlane.h"
+#include "collisionMesh.h"
+#include "collisionRayBatch.h"
 #include "config_collide.h"
 #include "boundingSphere.h"
+#include "finiteBoundingVolume.h"
 #include "transformState.h"
 #include "geomNode.h"
 #include "geom.h"
@@ -34,6 +37,7 @@
 #include "lodNode.h"
 #include "nodePath.h"
 #include "pStatTimer.h"
+#include "mutexHolder.h"
 #include "indent.h"
 
 #include <algorithm>
@@ -45,6 +49,7 @@ PStatCollector CollisionTraverser::_collisions_pcollector("App:Collisions");
 PStatCollector CollisionTraverser::_cnode_volume_pcollector("Collision Volumes:CollisionNode");
 PStatCollector CollisionTraverser::_gnode_volume_pcollector("Collision Volumes:GeomNode");
 PStatCollector CollisionTraverser::_geom_volume_pcollector("Collision Volumes:Geom");
+PStatCollector CollisionTraverser::_broadphase_volume_pcollector("Collision Volumes:Broadphase");
 
 TypeHandle CollisionTraverser::_type_handle;
 
@@ -65,15 +70,194 @@ public:
   const CollisionTraverser &_trav;
 };
 
+/**
+ * Stands in for the handlers of the colliders during one job of a parallel
+ * traversal.  It keeps the entries detected by the job, along with the
+ * handler each one is meant for, so that they may be passed on to the
+ * handlers afterwards, in the same order a single-threaded traversal would
+ * have produced them.
+ */
+class CollisionTraverser::DeferredHandler : public CollisionHandler {
+public:
+  DeferredHandler() : _handler(nullptr) {}
+
+  void set_handler(CollisionHandler *handler) {
+    _handler = handler;
+    _wants_all_potential_collidees = handler->wants_all_potential_collidees();
+  }
+
+  virtual void add_entry(CollisionEntry *entry) {
+    _entries.push_back(Entry(_handler, entry));
+  }
+
+  void flush();
+
+private:
+  typedef std::pair<CollisionHandler *, PT(CollisionEntry)> Entry;
+  typedef pvector<Entry> Entries;
+
+  CollisionHandler *_handler;
+  Entries _entries;
+};
+
+/**
+ * Passes the collected entries on to their handlers.
+ */
+void CollisionTraverser::DeferredHandler::
+flush() {
+  for (const Entry &entry : _entries) {
+    entry.first->add_entry(entry.second);
+  }
+  _entries.clear();
+}
+
+/**
+ * The state shared by the jobs of a parallel traversal.  Each job is either
+ * one pass of the usual traverser, or, when the broadphase is in use, a range
+ * of the colliders.
+ */
+class CollisionTraverser::ParallelCollide {
+public:
+  ParallelCollide(CollisionTraverser *trav, size_t num_jobs);
+  ~ParallelCollide();
+
+  void run(Thread *current_thread);
+  static void collide_job(void *user_data, int job_index,
+                          Thread *current_thread);
+
+  CollisionTraverser *_trav;
+  pvector<PT(DeferredHandler)> _handlers;
+
+  LevelStatesSingle *_single;
+  LevelStatesQuad *_quad;
+
+  const ColliderDefs *_defs;
+  const ColliderBounds *_bounds;
+  size_t _defs_per_job;
+};
+
+/**
+ *
+ */
+CollisionTraverser::ParallelCollide::
+ParallelCollide(CollisionTraverser *trav, size_t num_jobs) :
+  _trav(trav),
+  _single(nullptr),
+  _quad(nullptr),
+  _defs(nullptr),
+  _bounds(nullptr),
+  _defs_per_job(0)
+{
+  nassertv(trav->_deferred_handlers.empty());
+  _handlers.reserve(num_jobs);
+  for (size_t i = 0; i < num_jobs; ++i) {
+    DeferredHandler *handler = new DeferredHandler;
+    _handlers.push_back(handler);
+    trav->_deferred_handlers.push_back(handler);
+  }
+}
+
+/**
+ *
+ */
+CollisionTraverser::ParallelCollide::
+~ParallelCollide() {
+  _trav->_deferred_handlers.clear();
+}
+
+/**
+ * Runs all of the jobs on the worker threads, then passes the detected
+ * collisions on to the handlers, in job order.
+ */
+void CollisionTraverser::ParallelCollide::
+run(Thread *current_thread) {
+#ifdef DO_PSTATS
+  if (_defs == nullptr) {
+    // Make sure all of the pass collectors exist before the threads start.
+    _trav->get_pass_collector((int)_handlers.size() - 1);
+  }
+#endif
+
+  get_worker_pool()->run((int)_handlers.size(), &collide_job, this,
+                         current_thread);
+
+  for (DeferredHandler *handler : _handlers) {
+    handler->flush();
+  }
+}
+
+/**
+ * The WorkerThreadPool job function for a parallel traversal.
+ */
+void CollisionTraverser::ParallelCollide::
+collide_job(void *user_data, int job_index, Thread *current_thread) {
+  ParallelCollide *parallel = (ParallelCollide *)user_data;
+  CollisionTraverser *trav = parallel->_trav;
+  size_t job = (size_t)job_index;
+
+  if (parallel->_defs != nullptr) {
+    size_t begin = job * parallel->_defs_per_job;
+    size_t end = std::min(begin + parallel->_defs_per_job, parallel->_defs->size());
+
+    CollisionBroadphase::Results results;
+    for (size_t d = begin; d < end; ++d) {
+      trav->compare_collider_to_leaves((*parallel->_defs)[d],
+                                       (*parallel->_bounds)[d], results, job);
+    }
+
+  } else {
+#ifdef DO_PSTATS
+    PStatTimer pass_timer(trav->_pass_collectors[job], current_thread);
+#endif
+    if (parallel->_single != nullptr) {
+      trav->r_traverse_single((*parallel->_single)[job], job);
+    } else {
+      trav->r_traverse_quad((*parallel->_quad)[job], job);
+    }
+  }
+}
+
+/**
+ * The state shared by the jobs of a parallel raycast_batch().  Each job
+ * traces a range of the rays.
+ */
+class CollisionTraverser::ParallelRaycast {
+public:
+  static void raycast_job(void *user_data, int job_index,
+                          Thread *current_thread);
+
+  CollisionRayBatch *_rays;
+  NodePath _root;
+  CollideMask _mask;
+  int _rays_per_job;
+};
+
+/**
+ * The WorkerThreadPool job function for a parallel raycast.
+ */
+void CollisionTraverser::ParallelRaycast::
+raycast_job(void *user_data, int job_index, Thread *current_thread) {
+  ParallelRaycast *parallel = (ParallelRaycast *)user_data;
+  int begin = job_index * parallel->_rays_per_job;
+  int end = std::min(begin + parallel->_rays_per_job,
+                     parallel->_rays->get_num_rays());
+  parallel->_rays->trace(parallel->_root, parallel->_mask, begin, end);
+}
+
 /**
  *
  */
 CollisionTraverser::
 CollisionTraverser(const std::string &name) :
   Namable(name),
-  _this_pcollector(_collisions_pcollector, name)
+  _this_pcollector(_collisions_pcollector, name),
+  _broadphase_pcollector(_this_pcollector, "Broadphase"),
+  _raycast_pcollector(_this_pcollector, "Raycast")
 {
   _respect_prev_transform = respect_prev_transform;
+  _continuous = collision_continuous;
+  _use_broadphase = collision_broadphase;
+  _broadphase_update = 0;
   #ifdef DO_COLLISION_RECORDING
   _recorder = nullptr;
   #endif
@@ -247,6 +431,30 @@ clear_colliders() {
   _handlers.clear();
 }
 
+/**
+ * Specifies whether the traverser should use a broadphase to find the nodes
+ * that each collider might touch, rather than walking the scene graph once
+ * for every group of colliders.
+ *
+ * The broadphase keeps the bounding boxes of the CollisionNodes and GeomNodes
+ * in the scene in a dynamic tree, which is updated incrementally as the nodes
+ * move, and compares each collider only with the nodes whose boxes it
+ * overlaps.  There is no limit on the number of colliders handled in one
+ * pass, so this is usually faster when there are many colliders.  The
+ * default is set by the collision-broadphase config variable.
+ */
+void CollisionTraverser::
+set_use_broadphase(bool flag) {
+  _use_broadphase = flag;
+  if (!flag) {
+    // Release the memory used by the broadphase.
+    _broadphase.clear();
+    _broadphase_leaves.clear();
+    _unbounded_leaves.clear();
+    _broadphase_root.clear();
+  }
+}
+
 /**
  * Perform the traversal. Begins at the indicated root and detects all
  * collisions with any of its collider objects against nodes at or below the
@@ -272,8 +480,14 @@ traverse(const NodePath &root) {
   }
 
   bool traversal_done = false;
-  if ((int)_colliders.size() <= CollisionLevelStateSingle::get_max_colliders() ||
-      !allow_collider_multiple) {
+  if (_use_broadphase) {
+    traverse_broadphase(root);
+    traversal_done = true;
+  }
+
+  if (!traversal_done &&
+      ((int)_colliders.size() <= CollisionLevelStateSingle::get_max_colliders() ||
+       !allow_collider_multiple)) {
     // Use the single-word-at-a-time traverser, which might need to make lots
     // of passes.
     LevelStatesSingle level_states;
@@ -283,12 +497,21 @@ traverse(const NodePath &root) {
       traversal_done = true;
 
       // Make a number of passes, one for each group of 32 Colliders (or
-      // whatever number of bits we have available in CurrentMask).
-      for (size_t pass = 0; pass < level_states.size(); ++pass) {
+      // whatever number of bits we have available in CurrentMask).  The
+      // passes are independent of each other, so they may be made in
+      // parallel.
+      if (level_states.size() > 1 && is_parallel_ok()) {
+        ParallelCollide parallel(this, level_states.size());
+        parallel._single = &level_states;
+        parallel.run(Thread::get_current_thread());
+
+      } else {
+        for (size_t pass = 0; pass < level_states.size(); ++pass) {
 #ifdef DO_PSTATS
-        PStatTimer pass_timer(get_pass_collector(pass));
+          PStatTimer pass_timer(get_pass_collector(pass));
 #endif
-        r_traverse_single(level_states[pass], pass);
+          r_traverse_single(level_states[pass], pass);
+        }
       }
     }
   }
@@ -318,11 +541,18 @@ traverse(const NodePath &root) {
 
     traversal_done = true;
 
-    for (size_t pass = 0; pass < level_states.size(); ++pass) {
+    if (level_states.size() > 1 && is_parallel_ok()) {
+      ParallelCollide parallel(this, level_states.size());
+      parallel._quad = &level_states;
+      parallel.run(Thread::get_current_thread());
+
+    } else {
+      for (size_t pass = 0; pass < level_states.size(); ++pass) {
 #ifdef DO_PSTATS
-      PStatTimer pass_timer(get_pass_collector(pass));
+        PStatTimer pass_timer(get_pass_collector(pass));
 #endif
-      r_traverse_quad(level_states[pass], pass);
+        r_traverse_quad(level_states[pass], pass);
+      }
     }
   }
 
@@ -346,12 +576,61 @@ traverse(const NodePath &root) {
   _cnode_volume_pcollector.flush_level();
   _gnode_volume_pcollector.flush_level();
   _geom_volume_pcollector.flush_level();
+  _broadphase_volume_pcollector.flush_level();
 
   CollisionSphere::flush_level();
   CollisionCapsule::flush_level();
   CollisionPolygon::flush_level();
   CollisionPlane::flush_level();
   CollisionBox::flush_level();
+  CollisionMesh::flush_level();
+}
+
+/**
+ * Casts each of the rays in the batch into the scene at and below the
+ * indicated root, and records the first thing that each one hits.  Only
+ * CollisionNodes and GeomNodes whose into collide mask has bits in common
+ * with the indicated mask are considered.  The rays are given in the
+ * coordinate space of the root.  Returns the number of rays that hit
+ * something.
+ *
+ * This has nothing to do with the colliders that have been added to the
+ * traverser.  It is much faster than testing many CollisionRays with
+ * traverse(); see CollisionRayBatch.  If collision-threads is set, a large
+ * batch is split among the worker threads.
+ */
+int CollisionTraverser::
+raycast_batch(CollisionRayBatch *rays, const NodePath &root, CollideMask mask) {
+  nassertr(rays != nullptr && !root.is_empty(), 0);
+  PStatTimer timer(_raycast_pcollector);
+
+  rays->clear_hits();
+  int num_rays = rays->get_num_rays();
+
+  // The rays are independent of each other, so ranges of them may be traced
+  // in parallel, as long as the ranges are big enough to fill a few packets.
+  int rays_per_job = num_rays;
+  if (is_parallel_ok()) {
+    static const int jobs_per_thread = 4;
+    static const int min_rays_per_job = 256;
+    int num_jobs = (get_worker_pool()->get_num_threads() + 1) * jobs_per_thread;
+    rays_per_job = std::max((num_rays + num_jobs - 1) / num_jobs, min_rays_per_job);
+  }
+
+  if (rays_per_job < num_rays) {
+    ParallelRaycast parallel;
+    parallel._rays = rays;
+    parallel._root = root;
+    parallel._mask = mask;
+    parallel._rays_per_job = rays_per_job;
+    get_worker_pool()->run((num_rays + rays_per_job - 1) / rays_per_job,
+                           &ParallelRaycast::raycast_job, &parallel,
+                           Thread::get_current_thread());
+  } else {
+    rays->trace(root, mask, 0, num_rays);
+  }
+
+  return rays->get_num_hits();
 }
 
 #if defined(DO_COLLISION_RECORDING) || !defined(CPPPARSER)
@@ -582,8 +861,11 @@ r_traverse_single(CollisionLevelStateSingle &level_state, size_t pass) {
     CollisionEntry entry;
     entry._into_node = cnode;
     entry._into_node_path = level_state.get_node_path();
-    if (_respect_prev_transform) {
+    if (_respect_prev_transform || _continuous) {
       entry._flags |= CollisionEntry::F_respect_prev_transform;
+      if (_continuous) {
+        entry._flags |= CollisionEntry::F_continuous;
+      }
     }
 
     int num_colliders = level_state.get_num_colliders();
@@ -603,7 +885,7 @@ r_traverse_single(CollisionLevelStateSingle &level_state, size_t pass) {
               entry,
               level_state.get_parent_bound(c),
               level_state.get_local_bound(c),
-              node_gbv);
+              node_gbv, pass);
         }
       }
     }
@@ -627,8 +909,11 @@ r_traverse_single(CollisionLevelStateSingle &level_state, size_t pass) {
     CollisionEntry entry;
     entry._into_node = gnode;
     entry._into_node_path = level_state.get_node_path();
-    if (_respect_prev_transform) {
+    if (_respect_prev_transform || _continuous) {
       entry._flags |= CollisionEntry::F_respect_prev_transform;
+      if (_continuous) {
+        entry._flags |= CollisionEntry::F_continuous;
+      }
     }
 
     int num_colliders = level_state.get_num_colliders();
@@ -648,7 +933,7 @@ r_traverse_single(CollisionLevelStateSingle &level_state, size_t pass) {
               entry,
               level_state.get_parent_bound(c),
               level_state.get_local_bound(c),
-              node_gbv);
+              node_gbv, pass);
         }
       }
     }
@@ -793,8 +1078,11 @@ r_traverse_double(CollisionLevelStateDouble &level_state, size_t pass) {
     CollisionEntry entry;
     entry._into_node = cnode;
     entry._into_node_path = level_state.get_node_path();
-    if (_respect_prev_transform) {
+    if (_respect_prev_transform || _continuous) {
       entry._flags |= CollisionEntry::F_respect_prev_transform;
+      if (_continuous) {
+        entry._flags |= CollisionEntry::F_continuous;
+      }
     }
 
     int num_colliders = level_state.get_num_colliders();
@@ -814,7 +1102,7 @@ r_traverse_double(CollisionLevelStateDouble &level_state, size_t pass) {
               entry,
               level_state.get_parent_bound(c),
               level_state.get_local_bound(c),
-              node_gbv);
+              node_gbv, pass);
         }
       }
     }
@@ -838,8 +1126,11 @@ r_traverse_double(CollisionLevelStateDouble &level_state, size_t pass) {
     CollisionEntry entry;
     entry._into_node = gnode;
     entry._into_node_path = level_state.get_node_path();
-    if (_respect_prev_transform) {
+    if (_respect_prev_transform || _continuous) {
       entry._flags |= CollisionEntry::F_respect_prev_transform;
+      if (_continuous) {
+        entry._flags |= CollisionEntry::F_continuous;
+      }
     }
 
     int num_colliders = level_state.get_num_colliders();
@@ -859,7 +1150,7 @@ r_traverse_double(CollisionLevelStateDouble &level_state, size_t pass) {
               entry,
               level_state.get_parent_bound(c),
               level_state.get_local_bound(c),
-              node_gbv);
+              node_gbv, pass);
         }
       }
     }
@@ -1004,8 +1295,11 @@ r_traverse_quad(CollisionLevelStateQuad &level_state, size_t pass) {
     CollisionEntry entry;
     entry._into_node = cnode;
     entry._into_node_path = level_state.get_node_path();
-    if (_respect_prev_transform) {
+    if (_respect_prev_transform || _continuous) {
       entry._flags |= CollisionEntry::F_respect_prev_transform;
+      if (_continuous) {
+        entry._flags |= CollisionEntry::F_continuous;
+      }
     }
 
     int num_colliders = level_state.get_num_colliders();
@@ -1025,7 +1319,7 @@ r_traverse_quad(CollisionLevelStateQuad &level_state, size_t pass) {
               entry,
               level_state.get_parent_bound(c),
               level_state.get_local_bound(c),
-              node_gbv);
+              node_gbv, pass);
         }
       }
     }
@@ -1049,8 +1343,11 @@ r_traverse_quad(CollisionLevelStateQuad &level_state, size_t pass) {
     CollisionEntry entry;
     entry._into_node = gnode;
     entry._into_node_path = level_state.get_node_path();
-    if (_respect_prev_transform) {
+    if (_respect_prev_transform || _continuous) {
       entry._flags |= CollisionEntry::F_respect_prev_transform;
+      if (_continuous) {
+        entry._flags |= CollisionEntry::F_continuous;
+      }
     }
 
     int num_colliders = level_state.get_num_colliders();
@@ -1070,7 +1367,7 @@ r_traverse_quad(CollisionLevelStateQuad &level_state, size_t pass) {
               entry,
               level_state.get_parent_bound(c),
               level_state.get_local_bound(c),
-              node_gbv);
+              node_gbv, pass);
         }
       }
     }
@@ -1114,6 +1411,425 @@ r_traverse_quad(CollisionLevelStateQuad &level_state, size_t pass) {
   }
 }
 
+/**
+ * Performs the traversal using the broadphase.  The colliders are each
+ * compared with just the nodes whose bounding boxes they overlap, in a single
+ * pass.
+ */
+void CollisionTraverser::
+traverse_broadphase(const NodePath &root) {
+  int num_colliders = _ordered_colliders.size();
+
+  // Walk through the colliders in sorted order, as the other traversers do.
+  int *indirect = (int *)alloca(sizeof(int) * num_colliders);
+  int i;
+  for (i = 0; i < num_colliders; ++i) {
+    indirect[i] = i;
+  }
+  std::sort(indirect, indirect + num_colliders, SortByColliderSort(*this));
+
+  ColliderDefs defs;
+  ColliderBounds bounds;
+  defs.reserve(num_colliders);
+  bounds.reserve(num_colliders);
+  CollideMask from_mask;
+
+  for (i = 0; i < num_colliders; ++i) {
+    OrderedColliderDef &ocd = _ordered_colliders[indirect[i]];
+    NodePath cnode_path = ocd._node_path;
+
+    if (!cnode_path.is_same_graph(root)) {
+      if (ocd._in_graph) {
+        // Only report this warning once.
+        collide_cat.info()
+          << "Collider " << cnode_path
+          << " is not in scene graph.  Ignoring.\n";
+        ocd._in_graph = false;
+      }
+
+    } else {
+      ocd._in_graph = true;
+      CollisionNode *cnode = DCAST(CollisionNode, cnode_path.node());
+      from_mask |= cnode->get_from_collide_mask();
+
+      CollisionLevelStateBase::ColliderDef def;
+      def._node = cnode;
+      def._node_path = cnode_path;
+
+      int num_solids = cnode->get_num_solids();
+      for (int s = 0; s < num_solids; ++s) {
+        def._collider = cnode->get_solid(s);
+        defs.push_back(def);
+        bounds.push_back(CollisionLevelStateBase::make_collider_bound(def, root));
+      }
+    }
+  }
+
+  {
+    PStatTimer timer(_broadphase_pcollector);
+    update_broadphase(root, from_mask);
+  }
+
+  // The colliders are independent of each other, so groups of them may be
+  // compared in parallel.
+  size_t num_defs = defs.size();
+  size_t defs_per_job = num_defs;
+  if (is_parallel_ok()) {
+    // Make a few jobs per thread, so that the threads stay busy even if some
+    // groups take longer than others, but not so many that the jobs become
+    // trivially small.
+    static const size_t jobs_per_thread = 4;
+    static const size_t min_defs_per_job = 8;
+    size_t num_jobs = (size_t)(get_worker_pool()->get_num_threads() + 1) * jobs_per_thread;
+    defs_per_job = std::max((num_defs + num_jobs - 1) / num_jobs, min_defs_per_job);
+  }
+
+  if (defs_per_job < num_defs) {
+    ParallelCollide parallel(this, (num_defs + defs_per_job - 1) / defs_per_job);
+    parallel._defs = &defs;
+    parallel._bounds = &bounds;
+    parallel._defs_per_job = defs_per_job;
+    parallel.run(Thread::get_current_thread());
+
+  } else {
+    CollisionBroadphase::Results results;
+    for (size_t d = 0; d < num_defs; ++d) {
+      compare_collider_to_leaves(defs[d], bounds[d], results, 0);
+    }
+  }
+}
+
+/**
+ * Compares the indicated collider with each of the nodes that the broadphase
+ * finds near it.  The results vector is used as scratch space.
+ */
+void CollisionTraverser::
+compare_collider_to_leaves(const CollisionLevelStateBase::ColliderDef &def,
+                           const GeometricBoundingVolume *gbv,
+                           CollisionBroadphase::Results &results, size_t job) {
+  if (gbv != nullptr && gbv->is_empty()) {
+    // This collider can't intersect anything.
+    return;
+  }
+
+  CollisionEntry entry;
+  entry._from_node = def._node;
+  entry._from_node_path = def._node_path;
+  entry._from = def._collider;
+
+  const FiniteBoundingVolume *fbv = nullptr;
+  if (gbv != nullptr) {
+    fbv = gbv->as_finite_bounding_volume();
+  }
+
+  if (fbv == nullptr) {
+    // The collider has no bounds, or infinite bounds; it must be compared
+    // with every node.
+    BroadphaseLeaves::const_iterator li;
+    for (li = _broadphase_leaves.begin(); li != _broadphase_leaves.end(); ++li) {
+      compare_collider_to_leaf(entry, gbv, (*li).second, job);
+    }
+    _broadphase_volume_pcollector.add_level(_broadphase_leaves.size());
+
+  } else {
+    results.clear();
+    _broadphase.query(fbv->get_min(), fbv->get_max(), results);
+    for (void *data : results) {
+      compare_collider_to_leaf(entry, gbv, *(const BroadphaseLeaf *)data, job);
+    }
+    for (const BroadphaseLeaf *leaf : _unbounded_leaves) {
+      compare_collider_to_leaf(entry, gbv, *leaf, job);
+    }
+    _broadphase_volume_pcollector.add_level(results.size() + _unbounded_leaves.size());
+  }
+}
+
+/**
+ * Brings the broadphase up to date with the nodes at and below the indicated
+ * root.  Nodes that have not moved since the last traversal are left alone;
+ * nodes that have disappeared are removed.  Only nodes that might collide
+ * with the indicated from_mask are considered.
+ */
+void CollisionTraverser::
+update_broadphase(const NodePath &root, CollideMask from_mask) {
+  if (root != _broadphase_root) {
+    // The boxes are relative to the root, so we have to start over.
+    _broadphase.clear();
+    _broadphase_leaves.clear();
+    _broadphase_root = root;
+  }
+
+  _broadphase.set_margin((PN_stdfloat)collision_broadphase_margin);
+  _unbounded_leaves.clear();
+  ++_broadphase_update;
+
+  // As in the other traversers, the bounding volumes are all computed in the
+  // space of the root's parent.
+  r_update_broadphase(root, TransformState::make_identity(),
+                      CollideMask::all_on(), from_mask, nullptr, nullptr,
+                      Thread::get_current_thread());
+
+  // Remove the nodes we didn't encounter this time.
+  BroadphaseLeaves::iterator li = _broadphase_leaves.begin();
+  while (li != _broadphase_leaves.end()) {
+    BroadphaseLeaf &leaf = (*li).second;
+    if (leaf._last_update != _broadphase_update) {
+      if (leaf._proxy >= 0) {
+        _broadphase.remove_proxy(leaf._proxy);
+      }
+      li = _broadphase_leaves.erase(li);
+    } else {
+      ++li;
+    }
+  }
+}
+
+/**
+ * The recursive implementation of update_broadphase().  This visits the
+ * scene graph in the same way as r_traverse_single() and friends, recording
+ * each CollisionNode and GeomNode it reaches.
+ *
+ * parent_transform is the net transform of the node's parent, relative to the
+ * root's parent.  If the node is below a node that is flagged final, the
+ * final node's bounds and parent transform are passed in as well, since the
+ * other traversers do not test any bounding volumes below such a node.
+ */
+void CollisionTraverser::
+r_update_broadphase(const NodePath &node_path,
+                    const TransformState *parent_transform,
+                    CollideMask include_mask, CollideMask from_mask,
+                    const BoundingVolume *final_bounds,
+                    const TransformState *final_transform,
+                    Thread *current_thread) {
+  PandaNode *node = node_path.node();
+
+  CollideMask net_mask = node->get_net_collide_mask(current_thread) & include_mask;
+  if ((net_mask & from_mask).is_zero()) {
+    // No collider can collide with anything at or below this node.
+    return;
+  }
+
+  CPT(BoundingVolume) node_bv = node->get_bounds(current_thread);
+  if (final_bounds == nullptr && node_bv->is_empty()) {
+    return;
+  }
+
+  bool is_final = node->is_final(current_thread);
+  const TransformState *transform = node->get_transform(current_thread);
+  if (!is_final && !transform->is_identity() && transform->is_singular()) {
+    // The other traversers can't transform the colliders into the space of
+    // this node, so they ignore it and everything below.
+    return;
+  }
+  CPT(TransformState) net_transform = parent_transform->compose(transform);
+
+  if (node->is_collision_node() || node->is_geom_node()) {
+    BroadphaseLeaf &leaf = _broadphase_leaves[node_path];
+    if (leaf._last_update == 0) {
+      // This is a new leaf.
+      leaf._node_path = node_path;
+    }
+    leaf._last_update = _broadphase_update;
+    leaf._parent_transform = parent_transform;
+    leaf._net_transform = net_transform;
+    leaf._net_mask = net_mask;
+    leaf._is_final = is_final;
+    leaf._below_final = (final_bounds != nullptr);
+
+    // Below a final node, we use the final node's bounds instead.
+    const BoundingVolume *bounds = node_bv;
+    const TransformState *bounds_transform = parent_transform;
+    if (final_bounds != nullptr) {
+      bounds = final_bounds;
+      bounds_transform = final_transform;
+    }
+
+    if (bounds != leaf._bounds || bounds_transform != leaf._bounds_transform) {
+      // The node has moved or changed shape since the last traversal.
+      leaf._bounds = bounds;
+      leaf._bounds_transform = bounds_transform;
+      leaf._world_bounds = nullptr;
+
+      const GeometricBoundingVolume *gbv = bounds->as_geometric_bounding_volume();
+      if (gbv != nullptr && !bounds->is_infinite()) {
+        if (bounds_transform->is_identity()) {
+          leaf._world_bounds = gbv;
+        } else {
+          PT(GeometricBoundingVolume) world_gbv = gbv->make_copy()->as_geometric_bounding_volume();
+          world_gbv->xform(bounds_transform->get_mat());
+          leaf._world_bounds = world_gbv;
+        }
+      }
+
+      const FiniteBoundingVolume *fbv = nullptr;
+      if (leaf._world_bounds != nullptr) {
+        fbv = leaf._world_bounds->as_finite_bounding_volume();
+      }
+
+      if (fbv != nullptr && fbv->is_empty()) {
+        // Nothing can collide with this node.
+        leaf._unbounded = false;
+        if (leaf._proxy >= 0) {
+          _broadphase.remove_proxy(leaf._proxy);
+          leaf._proxy = -1;
+        }
+
+      } else if (fbv != nullptr) {
+        leaf._unbounded = false;
+        if (leaf._proxy >= 0) {
+          _broadphase.move_proxy(leaf._proxy, fbv->get_min(), fbv->get_max());
+        } else {
+          leaf._proxy = _broadphase.add_proxy(fbv->get_min(), fbv->get_max(), &leaf);
+        }
+
+      } else {
+        // We can't put a box around this node, so every collider will have to
+        // be compared with it.
+        leaf._unbounded = true;
+        if (leaf._proxy >= 0) {
+          _broadphase.remove_proxy(leaf._proxy);
+          leaf._proxy = -1;
+        }
+      }
+    }
+
+    if (leaf._unbounded) {
+      _unbounded_leaves.push_back(&leaf);
+    }
+  }
+
+  if (is_final && final_bounds == nullptr) {
+    final_bounds = node_bv;
+    final_transform = parent_transform;
+  }
+
+  if (node->has_single_child_visibility()) {
+    // If it's a switch node or sequence node, visit just the one visible
+    // child.
+    int index = node->get_visible_child();
+    if (index >= 0 && index < node->get_num_children(current_thread)) {
+      r_update_broadphase(NodePath(node_path, node->get_child(index, current_thread), current_thread),
+                          net_transform, include_mask, from_mask,
+                          final_bounds, final_transform, current_thread);
+    }
+
+  } else if (node->is_lod_node()) {
+    // If it's an LODNode, visit the lowest level of detail with all bits, and
+    // all other levels without GeomNode::get_default_collide_mask(), as
+    // r_traverse_single() does.
+    int index = DCAST(LODNode, node)->get_lowest_switch();
+    PandaNode::Children children = node->get_children(current_thread);
+    int num_children = children.get_num_children();
+    for (int i = 0; i < num_children; ++i) {
+      CollideMask child_mask = include_mask;
+      if (i != index) {
+        child_mask &= ~GeomNode::get_default_collide_mask();
+      }
+      r_update_broadphase(NodePath(node_path, children.get_child(i), current_thread),
+                          net_transform, child_mask, from_mask,
+                          final_bounds, final_transform, current_thread);
+    }
+
+  } else {
+    // Otherwise, visit all the children.
+    PandaNode::Children children = node->get_children(current_thread);
+    int num_children = children.get_num_children();
+    for (int i = 0; i < num_children; ++i) {
+      r_update_broadphase(NodePath(node_path, children.get_child(i), current_thread),
+                          net_transform, include_mask, from_mask,
+                          final_bounds, final_transform, current_thread);
+    }
+  }
+}
+
+/**
+ * Compares the indicated collider with one of the nodes found by the
+ * broadphase.  The collider's bounding volume is given in the space of the
+ * root's parent.
+ */
+void CollisionTraverser::
+compare_collider_to_leaf(CollisionEntry &entry,
+                         const GeometricBoundingVolume *from_gbv,
+                         const BroadphaseLeaf &leaf, size_t job) {
+  PandaNode *node = leaf._node_path.node();
+  if (node == entry._from_node) {
+    // Don't test a node with itself.
+    return;
+  }
+
+  CollideMask from_mask = entry._from_node->get_from_collide_mask();
+  if ((from_mask & leaf._net_mask).is_zero()) {
+    return;
+  }
+
+  // The boxes in the broadphase are only approximate; a quick test of the
+  // bounding volumes in the root's space rules out most pairs before we go
+  // to the trouble of transforming the collider's bounding volume.
+  if (from_gbv != nullptr && leaf._world_bounds != nullptr &&
+      !leaf._world_bounds->contains(from_gbv)) {
+    return;
+  }
+
+  // Bring the collider's bounding volume into the space of the node's parent
+  // and of the node itself, as the level states would have done.  No
+  // bounding volumes are tested below a final node.
+  CPT(GeometricBoundingVolume) parent_gbv;
+  CPT(GeometricBoundingVolume) node_gbv;
+  if (from_gbv != nullptr && !leaf._below_final) {
+    if (leaf._parent_transform->is_identity()) {
+      parent_gbv = from_gbv;
+    } else {
+      CPT(TransformState) inv_transform = leaf._parent_transform->get_inverse();
+      if (!inv_transform->has_mat()) {
+        return;
+      }
+      PT(GeometricBoundingVolume) gbv = from_gbv->make_copy()->as_geometric_bounding_volume();
+      gbv->xform(inv_transform->get_mat());
+      parent_gbv = gbv;
+    }
+
+    if (!leaf._is_final) {
+      if (leaf._net_transform == leaf._parent_transform) {
+        node_gbv = parent_gbv;
+      } else {
+        CPT(TransformState) inv_transform = leaf._net_transform->get_inverse();
+        if (!inv_transform->has_mat()) {
+          return;
+        }
+        PT(GeometricBoundingVolume) gbv = from_gbv->make_copy()->as_geometric_bounding_volume();
+        gbv->xform(inv_transform->get_mat());
+        node_gbv = gbv;
+      }
+    }
+  }
+
+  CPT(BoundingVolume) node_bv = node->get_bounds();
+  const GeometricBoundingVolume *into_node_gbv = node_bv->as_geometric_bounding_volume();
+
+  CollisionEntry pair_entry(entry);
+  pair_entry._into_node = node;
+  pair_entry._into_node_path = leaf._node_path;
+  if (_respect_prev_transform || _continuous) {
+    pair_entry._flags |= CollisionEntry::F_respect_prev_transform;
+    if (_continuous) {
+      pair_entry._flags |= CollisionEntry::F_continuous;
+    }
+  }
+
+  if (node->is_collision_node()) {
+    CollisionNode *cnode = (CollisionNode *)node;
+    if ((from_mask & cnode->get_into_collide_mask()) != 0) {
+      compare_collider_to_node(pair_entry, parent_gbv, node_gbv, into_node_gbv, job);
+    }
+
+  } else if (node->is_geom_node()) {
+    GeomNode *gnode = (GeomNode *)node;
+    if ((from_mask & gnode->get_into_collide_mask()) != 0) {
+      compare_collider_to_geom_node(pair_entry, parent_gbv, node_gbv, into_node_gbv, job);
+    }
+  }
+}
+
 /**
  *
  */
@@ -1121,7 +1837,8 @@ void CollisionTraverser::
 compare_collider_to_node(CollisionEntry &entry,
                          const GeometricBoundingVolume *from_parent_gbv,
                          const GeometricBoundingVolume *from_node_gbv,
-                         const GeometricBoundingVolume *into_node_gbv) {
+                         const GeometricBoundingVolume *into_node_gbv,
+                         size_t job) {
   bool within_node_bounds = true;
   if (from_parent_gbv != nullptr &&
       into_node_gbv != nullptr) {
@@ -1151,7 +1868,7 @@ compare_collider_to_node(CollisionEntry &entry,
       Colliders::const_iterator ci;
       ci = _colliders.find(entry.get_from_node_path());
       nassertv(ci != _colliders.end());
-      entry.test_intersection((*ci).second, this);
+      test_intersection(entry, (*ci).second, job);
     } else {
       CollisionNode::Solids::const_iterator si;
       for (si = cnode->_solids.begin(); si != cnode->_solids.end(); ++si) {
@@ -1167,7 +1884,7 @@ compare_collider_to_node(CollisionEntry &entry,
           solid_gbv = (const GeometricBoundingVolume *)solid_bv.p();
         }
 
-        compare_collider_to_solid(entry, from_node_gbv, solid_gbv);
+        compare_collider_to_solid(entry, from_node_gbv, solid_gbv, job);
       }
     }
   }
@@ -1180,7 +1897,8 @@ void CollisionTraverser::
 compare_collider_to_geom_node(CollisionEntry &entry,
                               const GeometricBoundingVolume *from_parent_gbv,
                               const GeometricBoundingVolume *from_node_gbv,
-                              const GeometricBoundingVolume *into_node_gbv) {
+                              const GeometricBoundingVolume *into_node_gbv,
+                              size_t job) {
   bool within_node_bounds = true;
   if (from_parent_gbv != nullptr &&
       into_node_gbv != nullptr) {
@@ -1208,7 +1926,7 @@ compare_collider_to_geom_node(CollisionEntry &entry,
           DCAST_INTO_V(geom_gbv, geom_bv);
         }
 
-        compare_collider_to_geom(entry, geom, from_node_gbv, geom_gbv);
+        compare_collider_to_geom(entry, geom, from_node_gbv, geom_gbv, job);
       }
     }
   }
@@ -1220,7 +1938,8 @@ compare_collider_to_geom_node(CollisionEntry &entry,
 void CollisionTraverser::
 compare_collider_to_solid(CollisionEntry &entry,
                           const GeometricBoundingVolume *from_node_gbv,
-                          const GeometricBoundingVolume *solid_gbv) {
+                          const GeometricBoundingVolume *solid_gbv,
+                          size_t job) {
   bool within_solid_bounds = true;
   if (from_node_gbv != nullptr &&
       solid_gbv != nullptr) {
@@ -1241,7 +1960,7 @@ compare_collider_to_solid(CollisionEntry &entry,
     Colliders::const_iterator ci;
     ci = _colliders.find(entry.get_from_node_path());
     nassertv(ci != _colliders.end());
-    entry.test_intersection((*ci).second, this);
+    test_intersection(entry, (*ci).second, job);
   }
 }
 
@@ -1251,7 +1970,8 @@ compare_collider_to_solid(CollisionEntry &entry,
 void CollisionTraverser::
 compare_collider_to_geom(CollisionEntry &entry, const Geom *geom,
                          const GeometricBoundingVolume *from_node_gbv,
-                         const GeometricBoundingVolume *geom_gbv) {
+                         const GeometricBoundingVolume *geom_gbv,
+                         size_t job) {
   bool within_geom_bounds = true;
   if (from_node_gbv != nullptr &&
       geom_gbv != nullptr) {
@@ -1302,7 +2022,7 @@ compare_collider_to_geom(CollisionEntry &entry, const Geom *geom,
               if (within_solid_bounds) {
                 PT(CollisionGeom) cgeom = new CollisionGeom(v[0], v[1], v[2]);
                 entry._into = cgeom;
-                entry.test_intersection((*ci).second, this);
+                test_intersection(entry, (*ci).second, job);
               }
             }
           }
@@ -1332,7 +2052,7 @@ compare_collider_to_geom(CollisionEntry &entry, const Geom *geom,
               if (within_solid_bounds) {
                 PT(CollisionGeom) cgeom = new CollisionGeom(v[0], v[1], v[2]);
                 entry._into = cgeom;
-                entry.test_intersection((*ci).second, this);
+                test_intersection(entry, (*ci).second, job);
               }
             }
           }
@@ -1342,6 +2062,60 @@ compare_collider_to_geom(CollisionEntry &entry, const Geom *geom,
   }
 }
 
+/**
+ * Tests the indicated entry for an intersection, and passes the result to the
+ * indicated handler.  During a parallel traversal, the result is held by the
+ * DeferredHandler for the indicated job instead, to be passed on to the
+ * handler once all of the jobs have finished.
+ */
+void CollisionTraverser::
+test_intersection(CollisionEntry &entry, CollisionHandler *handler,
+                  size_t job) const {
+  if (job < _deferred_handlers.size()) {
+    DeferredHandler *deferred = _deferred_handlers[job];
+    deferred->set_handler(handler);
+    entry.test_intersection(deferred, this);
+  } else {
+    entry.test_intersection(handler, this);
+  }
+}
+
+/**
+ * Returns true if the traversal may be split across the worker threads, as
+ * configured by collision-threads.
+ */
+bool CollisionTraverser::
+is_parallel_ok() const {
+  if (collision_threads <= 0) {
+    return false;
+  }
+#ifdef DO_COLLISION_RECORDING
+  if (has_recorder()) {
+    // The recorder expects to see the tests in order, from one thread.
+    return false;
+  }
+#endif
+  return true;
+}
+
+/**
+ * Returns the pool of worker threads shared by all parallel collision
+ * traversals, creating it on first use.
+ */
+WorkerThreadPool *CollisionTraverser::
+get_worker_pool() {
+  // Once the pool is created, we hold its reference count and never free it.
+  static Mutex lock("CollisionTraverser::get_worker_pool");
+  static WorkerThreadPool *pool = nullptr;
+
+  MutexHolder holder(lock);
+  if (pool == nullptr) {
+    pool = new WorkerThreadPool("Collision", collision_threads);
+    pool->ref();
+  }
+  return pool;
+}
+
 /**
  * Removes the indicated CollisionHandler from the list of handlers to be
  * processed, and returns the iterator to the next handler in the list.  This
@@ -18,6 +18,8 @@
 
 #include "collisionHandler.h"
 #include "collisionLevelState.h"
+#include "collisionBroadphase.h"
+#include "workerThreadPool.h"
 
 #include "pointerTo.h"
 #include "pStatCollector.h"
@@ -31,6 +33,7 @@ class CollisionVisualizer;
 class Geom;
 class NodePath;
 class CollisionEntry;
+class CollisionRayBatch;
 
 /**
  * This class manages the traversal through the scene graph to detect
@@ -52,6 +55,14 @@ PUBLISHED:
   MAKE_PROPERTY(respect_prev_transform, get_respect_prev_transform,
                                         set_respect_prev_transform);
 
+  INLINE void set_continuous(bool flag);
+  INLINE bool get_continuous() const;
+  MAKE_PROPERTY(continuous, get_continuous, set_continuous);
+
+  void set_use_broadphase(bool flag);
+  INLINE bool get_use_broadphase() const;
+  MAKE_PROPERTY(use_broadphase, get_use_broadphase, set_use_broadphase);
+
   void add_collider(const NodePath &collider, CollisionHandler *handler);
   bool remove_collider(const NodePath &collider);
   bool has_collider(const NodePath &collider) const;
@@ -64,6 +75,9 @@ PUBLISHED:
 
   void traverse(const NodePath &root);
 
+  int raycast_batch(CollisionRayBatch *rays, const NodePath &root,
+                    CollideMask mask = CollideMask::all_on());
+
 #if defined(DO_COLLISION_RECORDING) || !defined(CPPPARSER)
   void set_recorder(CollisionRecorder *recorder);
   INLINE bool has_recorder() const;
@@ -92,20 +106,52 @@ private:
   void prepare_colliders_quad(LevelStatesQuad &level_states, const NodePath &root);
   void r_traverse_quad(CollisionLevelStateQuad &level_state, size_t pass);
 
+  class ParallelCollide;
+  class DeferredHandler;
+  class ParallelRaycast;
+  bool is_parallel_ok() const;
+  static WorkerThreadPool *get_worker_pool();
+
+  typedef pvector<CollisionLevelStateBase::ColliderDef> ColliderDefs;
+  typedef pvector<PT(GeometricBoundingVolume)> ColliderBounds;
+
+  class BroadphaseLeaf;
+  void traverse_broadphase(const NodePath &root);
+  void compare_collider_to_leaves(const CollisionLevelStateBase::ColliderDef &def,
+                                  const GeometricBoundingVolume *gbv,
+                                  CollisionBroadphase::Results &results,
+                                  size_t job);
+  void update_broadphase(const NodePath &root, CollideMask from_mask);
+  void r_update_broadphase(const NodePath &node_path,
+                           const TransformState *parent_transform,
+                           CollideMask include_mask, CollideMask from_mask,
+                           const BoundingVolume *final_bounds,
+                           const TransformState *final_transform,
+                           Thread *current_thread);
+  void compare_collider_to_leaf(CollisionEntry &entry,
+                                const GeometricBoundingVolume *from_gbv,
+                                const BroadphaseLeaf &leaf, size_t job);
+
   void compare_collider_to_node(CollisionEntry &entry,
                                 const GeometricBoundingVolume *from_parent_gbv,
                                 const GeometricBoundingVolume *from_node_gbv,
-                                const GeometricBoundingVolume *into_node_gbv);
+                                const GeometricBoundingVolume *into_node_gbv,
+                                size_t job);
   void compare_collider_to_geom_node(CollisionEntry &entry,
                                      const GeometricBoundingVolume *from_parent_gbv,
                                      const GeometricBoundingVolume *from_node_gbv,
-                                     const GeometricBoundingVolume *into_node_gbv);
+                                     const GeometricBoundingVolume *into_node_gbv,
+                                     size_t job);
   void compare_collider_to_solid(CollisionEntry &entry,
                                  const GeometricBoundingVolume *from_node_gbv,
-                                 const GeometricBoundingVolume *solid_gbv);
+                                 const GeometricBoundingVolume *solid_gbv,
+                                 size_t job);
   void compare_collider_to_geom(CollisionEntry &entry, const Geom *geom,
                                 const GeometricBoundingVolume *from_node_gbv,
-                                const GeometricBoundingVolume *solid_gbv);
+                                const GeometricBoundingVolume *solid_gbv,
+                                size_t job);
+  void test_intersection(CollisionEntry &entry, CollisionHandler *handler,
+                         size_t job) const;
 
   PStatCollector &get_pass_collector(int pass);
 
@@ -129,6 +175,47 @@ private:
   Handlers::iterator remove_handler(Handlers::iterator hi);
 
   bool _respect_prev_transform;
+  bool _continuous;
+
+  // The nodes that the broadphase knows about, as of the last traversal.
+  // Each has a proxy in the broadphase tree, unless its bounding volume is
+  // empty or infinite.
+  class BroadphaseLeaf {
+  public:
+    BroadphaseLeaf() : _proxy(-1), _unbounded(false), _last_update(0) {}
+
+    NodePath _node_path;
+    CPT(TransformState) _parent_transform;
+    CPT(TransformState) _net_transform;
+    CollideMask _net_mask;
+    bool _is_final;
+    bool _below_final;
+
+    // The bounding volume and the transform from which the proxy's box was
+    // computed, so we can tell when it needs to be recomputed, and the
+    // bounding volume transformed into the space of the root's parent.
+    CPT(BoundingVolume) _bounds;
+    CPT(TransformState) _bounds_transform;
+    CPT(GeometricBoundingVolume) _world_bounds;
+    int _proxy;
+    bool _unbounded;
+    int _last_update;
+  };
+  typedef pmap<NodePath, BroadphaseLeaf> BroadphaseLeaves;
+  typedef pvector<BroadphaseLeaf *> UnboundedLeaves;
+
+  bool _use_broadphase;
+  CollisionBroadphase _broadphase;
+  BroadphaseLeaves _broadphase_leaves;
+  UnboundedLeaves _unbounded_leaves;
+  NodePath _broadphase_root;
+  int _broadphase_update;
+
+  // While a parallel traversal is in progress, this holds one handler per
+  // job, which collects the entries found by that job.  See
+  // test_intersection().
+  pvector<DeferredHandler *> _deferred_handlers;
+
 #ifdef DO_COLLISION_RECORDING
   CollisionRecorder *_recorder;
   NodePath _collision_visualizer_np;
@@ -143,8 +230,11 @@ private:
   static PStatCollector _cnode_volume_pcollector;
   static PStatCollector _gnode_volume_pcollector;
   static PStatCollector _geom_volume_pcollector;
+  static PStatCollector _broadphase_volume_pcollector;
 
   PStatCollector _this_pcollector;
+  PStatCollector _broadphase_pcollector;
+  PStatCollector _raycast_pcollector;
   typedef pvector<PStatCollector> PassCollectors;
   PassCollectors _pass_collectors;
   // pstats category for actual collision detection (vs.  bounding heirarchy
@@ -33,6 +33,7 @@
 #include "collisionPlane.h"
 #include "collisionPolygon.h"
 #include "collisionFloorMesh.h"
+#include "collisionMesh.h"
 #include "collisionRay.h"
 #include "collisionRecorder.h"
 #include "collisionSegment.h"
@@ -62,6 +63,14 @@ ConfigVariableBool respect_prev_transform
           "is false by default to force programmers to decide on a "
           "case-by-case basis whether they really need this feature."));
 
+ConfigVariableBool collision_continuous
+("collision-continuous", false,
+ PRC_DESC("Set this true to make new CollisionTraversers sweep moving "
+          "spheres and capsules continuously along their path from the "
+          "previous frame's position, so that fast movers cannot pass "
+          "through thin walls; see CollisionTraverser::set_continuous().  "
+          "This implies respect-prev-transform."));
+
 ConfigVariableBool respect_effective_normal
 ("respect-effective-normal", true,
  PRC_DESC("This should be true to support the effective_normal interface of "
@@ -77,6 +86,33 @@ ConfigVariableBool allow_collider_multiple
           "false, a one-word BitMask is always used instead, which is faster "
           "per pass, but may require more passes."));
 
+ConfigVariableBool collision_broadphase
+("collision-broadphase", false,
+ PRC_DESC("Set this true to make new CollisionTraversers use a broadphase "
+          "by default; see CollisionTraverser::set_use_broadphase().  The "
+          "broadphase keeps the bounding boxes of the collision and geometry "
+          "nodes in a dynamic tree, so that each collider is only compared "
+          "with the nodes it might touch, and there is no limit on the "
+          "number of colliders that are handled in one pass.  This is "
+          "usually faster when there are many colliders."));
+
+ConfigVariableDouble collision_broadphase_margin
+("collision-broadphase-margin", 0.1,
+ PRC_DESC("The distance by which the bounding box of each node is enlarged "
+          "when it is stored in the collision broadphase.  A node that "
+          "moves less than this need not be moved within the broadphase."));
+
+ConfigVariableInt collision_threads
+("collision-threads", 0,
+ PRC_DESC("Set this to a number greater than zero to split the work of each "
+          "CollisionTraverser::traverse() across that many additional worker "
+          "threads.  The passes of the usual traverser, or groups of "
+          "colliders when the broadphase is in use, are tested in parallel, "
+          "and the detected collisions are then passed to the handlers in "
+          "the same order as a single-threaded traversal would have produced "
+          "them.  This has no effect while a CollisionRecorder is attached, "
+          "or on builds without true threading support."));
+
 ConfigVariableBool flatten_collision_nodes
 ("flatten-collision-nodes", false,
  PRC_DESC("Set this true to allow NodePath::flatten_medium() and "
@@ -146,6 +182,7 @@ init_libcollide() {
   CollisionPlane::init_type();
   CollisionPolygon::init_type();
   CollisionFloorMesh::init_type();
+  CollisionMesh::init_type();
   CollisionRay::init_type();
   CollisionSegment::init_type();
   CollisionSolid::init_type();
@@ -170,6 +207,7 @@ init_libcollide() {
   CollisionPlane::register_with_read_factory();
   CollisionPolygon::register_with_read_factory();
   CollisionFloorMesh::register_with_read_factory();
+  CollisionMesh::register_with_read_factory();
   CollisionRay::register_with_read_factory();
   CollisionSegment::register_with_read_factory();
   CollisionSphere::register_with_read_factory();
@@ -6,10 +6,13 @@
 #include "collisionPlane.cxx"
 #include "collisionPolygon.cxx"
 #include "collisionFloorMesh.cxx"
+#include "collisionMesh.cxx"
 #include "collisionRay.cxx"
+#include "collisionRayBatch.cxx"
 #include "collisionRecorder.cxx"
 #include "collisionSegment.cxx"
 #include "collisionSolid.cxx"
 #include "collisionSphere.cxx"
+#include "collisionSweep.cxx"
 #include "collisionTraverser.cxx"
 #include "collisionVisualizer.cxx"
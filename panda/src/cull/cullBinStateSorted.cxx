@@ -15,7 +15,10 @@
 #include "graphicsStateGuardianBase.h"
 #include "cullableObject.h"
 #include "cullHandler.h"
+#include "cullBatchCache.h"
+#include "config_pgraph.h"
 #include "pStatTimer.h"
+#include "pdeque.h"
 
 #include <algorithm>
 
@@ -60,35 +63,122 @@ void CullBinStateSorted::
 finish_cull(SceneSetup *, Thread *current_thread) {
   PStatTimer timer(_cull_this_pcollector, current_thread);
   sort(_objects.begin(), _objects.end());
+
+  if (dynamic_batching) {
+    batch_objects(current_thread);
+  }
 }
 
 
 /**
- * Draws all the geoms in the bin, in the appropriate order.
+ * Draws all the geoms in the bin, in the appropriate order.  Consecutive
+ * objects that differ only in their Geom are handed to the GSG together, so
+ * that it may draw them with a single call.
  */
 void CullBinStateSorted::
 draw(bool force, Thread *current_thread) {
   PStatTimer timer(_draw_this_pcollector, current_thread);
 
-  Objects::const_iterator oi;
-  for (oi = _objects.begin(); oi != _objects.end(); ++oi) {
-    CullableObject *object = (*oi)._object;
+  pdeque<GeomPipelineReader> geom_readers;
+  pvector<const GeomPipelineReader *> run;
+
+  size_t num_objects = _objects.size();
+  size_t i = 0;
+  while (i < num_objects) {
+    CullableObject *object = _objects[i]._object;
+
+    if (object->_draw_callback != nullptr) {
+      // It has a callback associated.
+      object->draw_callback(_gsg, force, current_thread);
+      // Now the callback has taken care of drawing.
+      ++i;
+      continue;
+    }
+    nassertd(object->_geom != nullptr) {
+      ++i;
+      continue;
+    }
 
-    if (object->_draw_callback == nullptr) {
-      nassertd(object->_geom != nullptr) continue;
+    _gsg->set_state_and_transform(object->_state, object->_internal_transform);
 
-      _gsg->set_state_and_transform(object->_state, object->_internal_transform);
+    GeomVertexDataPipelineReader data_reader(object->_munged_data, current_thread);
+    data_reader.check_array_readers();
 
+    size_t j = i + 1;
+    while (j < num_objects && is_same_draw(object, _objects[j]._object)) {
+      ++j;
+    }
+
+    if (j - i == 1) {
       GeomPipelineReader geom_reader(object->_geom, current_thread);
-      GeomVertexDataPipelineReader data_reader(object->_munged_data, current_thread);
-      data_reader.check_array_readers();
       geom_reader.draw(_gsg, &data_reader, force);
     } else {
-      // It has a callback associated.
-      object->draw_callback(_gsg, force, current_thread);
-      // Now the callback has taken care of drawing.
+      geom_readers.clear();
+      run.clear();
+      for (size_t k = i; k < j; ++k) {
+        geom_readers.emplace_back(_objects[k]._object->_geom, current_thread);
+        run.push_back(&geom_readers.back());
+      }
+      if (!_gsg->draw_geoms(&run[0], run.size(), &data_reader, force)) {
+        for (const GeomPipelineReader *geom_reader : run) {
+          geom_reader->draw(_gsg, &data_reader, force);
+        }
+      }
+    }
+    i = j;
+  }
+}
+
+/**
+ * Replaces runs of small objects that share the same state with merged
+ * objects from the CullBatchCache.  The objects must already be sorted.
+ */
+void CullBinStateSorted::
+batch_objects(Thread *current_thread) {
+  Objects new_objects(get_class_type());
+  new_objects.reserve(_objects.size());
+  pvector<CullableObject *> run;
+
+  size_t num_objects = _objects.size();
+  size_t i = 0;
+  while (i < num_objects) {
+    CullableObject *object = _objects[i]._object;
+    if (!CullBatchCache::is_batchable(object)) {
+      new_objects.push_back(_objects[i]);
+      ++i;
+      continue;
+    }
+
+    // Collect the following objects that may be merged with this one.
+    run.clear();
+    run.push_back(object);
+    size_t j = i + 1;
+    while (j < num_objects) {
+      CullableObject *next = _objects[j]._object;
+      if (!CullBatchCache::is_batchable(next) ||
+          !CullBatchCache::is_compatible(object, next)) {
+        break;
+      }
+      run.push_back(next);
+      ++j;
+    }
+
+    CullableObject *batch = nullptr;
+    if (run.size() > 1) {
+      batch = CullBatchCache::make_batch(&run[0], run.size(), current_thread);
+    }
+    if (batch != nullptr) {
+      for (CullableObject *merged : run) {
+        delete merged;
+      }
+      new_objects.push_back(ObjectData(batch));
+    } else {
+      new_objects.insert(new_objects.end(), _objects.begin() + i, _objects.begin() + j);
     }
+    i = j;
   }
+
+  _objects.swap(new_objects);
 }
 
 /**
@@ -50,6 +50,11 @@ public:
 protected:
   virtual void fill_result_graph(ResultGraphBuilder &builder);
 
+private:
+  void batch_objects(Thread *current_thread);
+  INLINE static bool is_same_draw(const CullableObject *object,
+                                  const CullableObject *next);
+
 private:
   class ObjectData {
   public:
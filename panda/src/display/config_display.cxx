@@ -294,6 +294,15 @@ ConfigVariableBool alpha_scale_via_texture
           "application specifically enables it.  See also "
           "color-scale-via-lighting."));
 
+ConfigVariableBool auto_shader_skinning
+("auto-shader-skinning", true,
+ PRC_DESC("When this is true, vertex animation on geometry rendered with the "
+          "shader generator is performed by the generated shader, even if "
+          "hardware-animated-vertices is false.  This is only done for "
+          "vertex tables without morphs that refer to few enough transforms "
+          "to fit in the generated shader's matrix palette; others are "
+          "still animated on the CPU."));
+
 ConfigVariableBool allow_incomplete_render
 ("allow-incomplete-render", true,
  PRC_DESC("When this is true, the frame may be rendered even if some of the "
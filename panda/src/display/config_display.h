@@ -67,6 +67,7 @@ extern EXPCL_PANDA_DISPLAY ConfigVariableBool swap_eyes;
 extern EXPCL_PANDA_DISPLAY ConfigVariableBool default_stereo_camera;
 extern EXPCL_PANDA_DISPLAY ConfigVariableBool color_scale_via_lighting;
 extern EXPCL_PANDA_DISPLAY ConfigVariableBool alpha_scale_via_texture;
+extern EXPCL_PANDA_DISPLAY ConfigVariableBool auto_shader_skinning;
 extern EXPCL_PANDA_DISPLAY ConfigVariableBool allow_incomplete_render;
 extern EXPCL_PANDA_DISPLAY ConfigVariableBool old_alpha_blend;
 
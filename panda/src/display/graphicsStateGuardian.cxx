@@ -301,9 +301,11 @@ GraphicsStateGuardian::
   // Note that if uniquify-states is false, we can't iterate over all the
   // states, and some GSGs will linger.  Let's hope this isn't a problem.
   LightReMutexHolder holder(*RenderState::_states_lock);
-  size_t size = RenderState::_states.get_num_entries();
+  pvector<const RenderState *> states;
+  RenderState::collect_states(states);
+  size_t size = states.size();
   for (size_t si = 0; si < size; ++si) {
-    const RenderState *state = RenderState::_states.get_key(si);
+    const RenderState *state = states[si];
     state->_mungers.remove(_id);
     state->_munged_states.remove(_id);
   }
@@ -2605,6 +2607,22 @@ end_draw_primitives() {
   _data_reader = nullptr;
 }
 
+/**
+ * Draws all of the indicated Geoms, which use the same vertex data, in as few
+ * calls as possible.  The render state and transform must already have been
+ * set up.  This is called by the state-sorted cull bin for runs of objects
+ * that differ only in their Geom.
+ *
+ * Returns false, without drawing anything, if the GSG can't draw these Geoms
+ * together, in which case the caller should draw them one at a time.  This
+ * default implementation always does.
+ */
+bool GraphicsStateGuardian::
+draw_geoms(const GeomPipelineReader * const *, size_t,
+           const GeomVertexDataPipelineReader *, bool) {
+  return false;
+}
+
 /**
  * Resets all internal state as if the gsg were newly created.
  */
@@ -399,6 +399,10 @@ public:
   virtual bool draw_points(const GeomPrimitivePipelineReader *reader,
                            bool force);
   virtual void end_draw_primitives();
+  virtual bool draw_geoms(const GeomPipelineReader * const *geom_readers,
+                          size_t num_geoms,
+                          const GeomVertexDataPipelineReader *data_reader,
+                          bool force);
 
   INLINE bool reset_if_new();
   INLINE void mark_new();
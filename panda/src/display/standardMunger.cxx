@@ -14,6 +14,7 @@
 #include "standardMunger.h"
 
 #include "config_gobj.h"
+#include "config_display.h"
 
 #include "displayRegion.h"
 #include "graphicsStateGuardian.h"
@@ -127,6 +128,12 @@ munge_data_impl(const GeomVertexData *data) {
       !basic_shaders_only && animation.get_animation_type() == AT_panda)) {
     animation.set_hardware(4, true);
 
+  } else if (_auto_shader && auto_shader_skinning && !basic_shaders_only &&
+             animation.get_animation_type() == AT_panda &&
+             can_shader_skin(new_data)) {
+    // The generated shader can do the animation instead.
+    animation.set_hardware(4, true);
+
   } else if (hardware_animated_vertices &&
              animation.get_animation_type() == AT_panda &&
              new_data->get_slider_table() == nullptr) {
@@ -171,6 +178,29 @@ munge_data_impl(const GeomVertexData *data) {
   return new_data->convert_to(new_format);
 }
 
+/**
+ * Returns true if the vertex animation of the indicated data can be performed
+ * by a shader made by the ShaderGenerator, or false if it will have to be
+ * done on the CPU.
+ */
+bool StandardMunger::
+can_shader_skin(const GeomVertexData *data) {
+#ifdef HAVE_CG
+  if (data->get_slider_table() != nullptr) {
+    // The generated shader doesn't do morphs.
+    return false;
+  }
+
+  const TransformBlendTable *table = data->get_transform_blend_table();
+  return table != nullptr &&
+         table->get_num_transforms() != 0 &&
+         table->get_num_transforms() <= ShaderGenerator::max_indexed_transforms &&
+         table->get_max_simultaneous_transforms() <= 4;
+#else
+  return false;
+#endif
+}
+
 /**
  * Converts a Geom and/or its data as necessary.
  */
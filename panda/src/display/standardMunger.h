@@ -47,6 +47,8 @@ protected:
   virtual CPT(RenderState) munge_state_impl(const RenderState *state);
 
 private:
+  static bool can_shader_skin(const GeomVertexData *data);
+
   int _num_components;
   NumericType _numeric_type;
   Contents _contents;
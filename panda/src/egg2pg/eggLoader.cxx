@@ -2386,16 +2386,31 @@ make_vertex_data(const EggRenderState *render_state,
     vertex_data->set_slider_table(SliderTable::register_table(slider_table));
   }
 
-  // And fill in the data from the vertex pool.
+  // And fill in the data from the vertex pool.  The positions are collected
+  // first and written in one go, since every vertex has one.
   EggVertexPool::const_iterator vi;
+  int num_rows = 0;
+  for (vi = vertex_pool->begin(); vi != vertex_pool->end(); ++vi) {
+    num_rows = std::max(num_rows, (*vi)->get_index() + 1);
+  }
+  vertex_data->set_num_rows(num_rows);
+  {
+    epvector<LVecBase4d> positions(num_rows, LVecBase4d::zero());
+    for (vi = vertex_pool->begin(); vi != vertex_pool->end(); ++vi) {
+      EggVertex *vertex = (*vi);
+      positions[vertex->get_index()] = vertex->get_pos4() * transform;
+    }
+    if (num_rows > 0) {
+      GeomVertexWriter gvw(vertex_data, InternalName::get_vertex());
+      gvw.set_data4d_n(&positions[0], num_rows);
+    }
+  }
+
   for (vi = vertex_pool->begin(); vi != vertex_pool->end(); ++vi) {
     GeomVertexWriter gvw(vertex_data);
     EggVertex *vertex = (*vi);
     gvw.set_row(vertex->get_index());
 
-    gvw.set_column(InternalName::get_vertex());
-    gvw.add_data4d(vertex->get_pos4() * transform);
-
     if (is_dynamic) {
       EggMorphVertexList::const_iterator mvi;
       for (mvi = vertex->_dxyzs.begin(); mvi != vertex->_dxyzs.end(); ++mvi) {
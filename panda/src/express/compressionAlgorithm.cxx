@@ -0,0 +1,339 @@
+/**
+ * PANDA 3D SOFTWARE
+ * Copyright (c) Carnegie Mellon University.  All rights reserved.
+ *
+ * All use of this software is subject to the terms of the revised BSD
+ * license.  You should have received a copy of this license along
+ * with this source code in a file named "LICENSE."
+ *
+ * @file compressionAlgorithm.cxx
+ * @author blablabla94
+ * @date 2026-10-17
+ */
+
+#include "compressionAlgorithm.h"
+#include "config_express.h"
+#include "string_utils.h"
+
+#include <climits>
+
+#ifdef HAVE_ZLIB
+#include <zlib.h>
+#endif
+
+#ifdef HAVE_LZ4
+#include <lz4.h>
+#include <lz4hc.h>
+#endif
+
+#ifdef HAVE_ZSTD
+#include <zstd.h>
+#endif
+
+using std::istream;
+using std::ostream;
+using std::string;
+
+/**
+ * Returns true if Panda was compiled with support for the indicated
+ * compression algorithm, false otherwise.  CA_none is always available.
+ */
+bool
+is_compression_algorithm_available(CompressionAlgorithm algorithm) {
+  switch (algorithm) {
+  case CA_none:
+    return true;
+
+  case CA_zlib:
+#ifdef HAVE_ZLIB
+    return true;
+#else
+    return false;
+#endif
+
+  case CA_lz4:
+#ifdef HAVE_LZ4
+    return true;
+#else
+    return false;
+#endif
+
+  case CA_zstd:
+#ifdef HAVE_ZSTD
+    return true;
+#else
+    return false;
+#endif
+  }
+
+  return false;
+}
+
+/**
+ * Compresses the indicated buffer with the indicated algorithm, and returns
+ * the compressed data, or an empty buffer if the algorithm is not available.
+ * The compression level is interpreted as for zlib, 1 through 9; it is
+ * passed on to Zstandard, and LZ4 uses its high-compression mode at levels 3
+ * and above.
+ *
+ * Unlike compress_string(), the result does not record the size of the
+ * uncompressed data, which must be given again to decompress_buffer().
+ */
+vector_uchar
+compress_buffer(CompressionAlgorithm algorithm, const vector_uchar &source,
+                int compression_level) {
+  vector_uchar dest(get_compress_bound(algorithm, source.size()));
+  if (dest.empty()) {
+    return vector_uchar();
+  }
+  size_t size = compress_buffer(algorithm, compression_level,
+                                source.data(), source.size(),
+                                dest.data(), dest.size());
+  dest.resize(size);
+  return dest;
+}
+
+/**
+ * Decompresses the data produced by a previous call to compress_buffer() with
+ * the same algorithm.  The size of the original data must be given.  Returns
+ * an empty buffer on failure.
+ */
+vector_uchar
+decompress_buffer(CompressionAlgorithm algorithm, const vector_uchar &source,
+                  size_t uncompressed_size) {
+  vector_uchar dest(uncompressed_size);
+  if (!decompress_buffer(algorithm, source.data(), source.size(),
+                         dest.data(), dest.size())) {
+    return vector_uchar();
+  }
+  return dest;
+}
+
+/**
+ * Returns the number of bytes that compress_buffer() may need to write for a
+ * buffer of the indicated size, or 0 if the algorithm is not available.
+ */
+size_t
+get_compress_bound(CompressionAlgorithm algorithm, size_t source_size) {
+  switch (algorithm) {
+  case CA_none:
+    return source_size;
+
+  case CA_zlib:
+#ifdef HAVE_ZLIB
+    return (size_t)compressBound((uLong)source_size);
+#else
+    break;
+#endif
+
+  case CA_lz4:
+#ifdef HAVE_LZ4
+    if (source_size > (size_t)LZ4_MAX_INPUT_SIZE) {
+      return 0;
+    }
+    return (size_t)LZ4_compressBound((int)source_size);
+#else
+    break;
+#endif
+
+  case CA_zstd:
+#ifdef HAVE_ZSTD
+    return ZSTD_compressBound(source_size);
+#else
+    break;
+#endif
+  }
+
+  return 0;
+}
+
+/**
+ * Compresses source_size bytes from source into the dest buffer, which should
+ * be at least get_compress_bound() bytes.  Returns the number of bytes
+ * written, or 0 on failure.
+ */
+size_t
+compress_buffer(CompressionAlgorithm algorithm, int compression_level,
+                const unsigned char *source, size_t source_size,
+                unsigned char *dest, size_t dest_size) {
+  switch (algorithm) {
+  case CA_none:
+    if (dest_size < source_size) {
+      return 0;
+    }
+    memcpy(dest, source, source_size);
+    return source_size;
+
+  case CA_zlib:
+#ifdef HAVE_ZLIB
+    {
+      uLongf size = (uLongf)dest_size;
+      int result = compress2((Bytef *)dest, &size, (const Bytef *)source,
+                             (uLong)source_size, compression_level);
+      if (result != Z_OK) {
+        express_cat.warning()
+          << "zlib error " << result << " while compressing buffer\n";
+        return 0;
+      }
+      return (size_t)size;
+    }
+#else
+    break;
+#endif
+
+  case CA_lz4:
+#ifdef HAVE_LZ4
+    if (source_size > (size_t)LZ4_MAX_INPUT_SIZE) {
+      return 0;
+    }
+    {
+      int dest_capacity = (int)std::min(dest_size, (size_t)INT_MAX);
+      int size;
+      if (compression_level >= LZ4HC_CLEVEL_MIN) {
+        size = LZ4_compress_HC((const char *)source, (char *)dest,
+                               (int)source_size, dest_capacity,
+                               compression_level);
+      } else {
+        size = LZ4_compress_default((const char *)source, (char *)dest,
+                                    (int)source_size, dest_capacity);
+      }
+      return (size > 0) ? (size_t)size : 0;
+    }
+#else
+    break;
+#endif
+
+  case CA_zstd:
+#ifdef HAVE_ZSTD
+    {
+      size_t size = ZSTD_compress(dest, dest_size, source, source_size,
+                                  compression_level);
+      if (ZSTD_isError(size)) {
+        express_cat.warning()
+          << "Zstandard error while compressing buffer: "
+          << ZSTD_getErrorName(size) << "\n";
+        return 0;
+      }
+      return size;
+    }
+#else
+    break;
+#endif
+  }
+
+  express_cat.error()
+    << "Compression algorithm " << algorithm << " is not available.\n";
+  return 0;
+}
+
+/**
+ * Decompresses source_size bytes from source, which must have been produced
+ * by compress_buffer() with the same algorithm, into the dest buffer.
+ * dest_size must be exactly the size of the original data.  Returns true on
+ * success, false on failure.
+ */
+bool
+decompress_buffer(CompressionAlgorithm algorithm,
+                  const unsigned char *source, size_t source_size,
+                  unsigned char *dest, size_t dest_size) {
+  switch (algorithm) {
+  case CA_none:
+    if (source_size != dest_size) {
+      return false;
+    }
+    memcpy(dest, source, source_size);
+    return true;
+
+  case CA_zlib:
+#ifdef HAVE_ZLIB
+    {
+      uLongf size = (uLongf)dest_size;
+      int result = uncompress((Bytef *)dest, &size, (const Bytef *)source,
+                              (uLong)source_size);
+      return (result == Z_OK && size == (uLongf)dest_size);
+    }
+#else
+    break;
+#endif
+
+  case CA_lz4:
+#ifdef HAVE_LZ4
+    if (source_size > (size_t)INT_MAX || dest_size > (size_t)INT_MAX) {
+      return false;
+    }
+    {
+      int size = LZ4_decompress_safe((const char *)source, (char *)dest,
+                                     (int)source_size, (int)dest_size);
+      return (size >= 0 && (size_t)size == dest_size);
+    }
+#else
+    break;
+#endif
+
+  case CA_zstd:
+#ifdef HAVE_ZSTD
+    {
+      size_t size = ZSTD_decompress(dest, dest_size, source, source_size);
+      return (!ZSTD_isError(size) && size == dest_size);
+    }
+#else
+    break;
+#endif
+  }
+
+  express_cat.error()
+    << "Compression algorithm " << algorithm << " is not available.\n";
+  return false;
+}
+
+/**
+ *
+ */
+ostream &
+operator << (ostream &out, CompressionAlgorithm algorithm) {
+  switch (algorithm) {
+  case CA_none:
+    return out << "none";
+
+  case CA_zlib:
+    return out << "zlib";
+
+  case CA_lz4:
+    return out << "lz4";
+
+  case CA_zstd:
+    return out << "zstd";
+  }
+
+  return out << "**invalid CompressionAlgorithm(" << (int)algorithm << ")**";
+}
+
+/**
+ *
+ */
+istream &
+operator >> (istream &in, CompressionAlgorithm &algorithm) {
+  string word;
+  in >> word;
+
+  if (cmp_nocase(word, "none") == 0) {
+    algorithm = CA_none;
+
+  } else if (cmp_nocase(word, "zlib") == 0) {
+    algorithm = CA_zlib;
+
+  } else if (cmp_nocase(word, "lz4") == 0) {
+    algorithm = CA_lz4;
+
+  } else if (cmp_nocase(word, "zstd") == 0 ||
+             cmp_nocase(word, "zstandard") == 0) {
+    algorithm = CA_zstd;
+
+  } else {
+    express_cat.error()
+      << "Invalid CompressionAlgorithm value: " << word << "\n";
+    algorithm = CA_none;
+  }
+
+  return in;
+}
@@ -0,0 +1,58 @@
+/**
+ * PANDA 3D SOFTWARE
+ * Copyright (c) Carnegie Mellon University.  All rights reserved.
+ *
+ * All use of this software is subject to the terms of the revised BSD
+ * license.  You should have received a copy of this license along
+ * with this source code in a file named "LICENSE."
+ *
+ * @file compressionAlgorithm.h
+ * @author blablabla94
+ * @date 2026-10-17
+ */
+
+#ifndef COMPRESSIONALGORITHM_H
+#define COMPRESSIONALGORITHM_H
+
+#include "pandabase.h"
+#include "vector_uchar.h"
+
+BEGIN_PUBLISH
+// An enumerated type used to select one of the general-purpose compression
+// libraries that Panda may have been compiled with.
+enum CompressionAlgorithm {
+  CA_none,
+  CA_zlib,
+  CA_lz4,
+  CA_zstd,
+};
+
+EXPCL_PANDA_EXPRESS bool
+is_compression_algorithm_available(CompressionAlgorithm algorithm);
+
+EXPCL_PANDA_EXPRESS vector_uchar
+compress_buffer(CompressionAlgorithm algorithm, const vector_uchar &source,
+                int compression_level = 6);
+EXPCL_PANDA_EXPRESS vector_uchar
+decompress_buffer(CompressionAlgorithm algorithm, const vector_uchar &source,
+                  size_t uncompressed_size);
+END_PUBLISH
+
+EXPCL_PANDA_EXPRESS size_t
+get_compress_bound(CompressionAlgorithm algorithm, size_t source_size);
+
+EXPCL_PANDA_EXPRESS size_t
+compress_buffer(CompressionAlgorithm algorithm, int compression_level,
+                const unsigned char *source, size_t source_size,
+                unsigned char *dest, size_t dest_size);
+EXPCL_PANDA_EXPRESS bool
+decompress_buffer(CompressionAlgorithm algorithm,
+                  const unsigned char *source, size_t source_size,
+                  unsigned char *dest, size_t dest_size);
+
+EXPCL_PANDA_EXPRESS std::ostream &
+operator << (std::ostream &out, CompressionAlgorithm algorithm);
+EXPCL_PANDA_EXPRESS std::istream &
+operator >> (std::istream &in, CompressionAlgorithm &algorithm);
+
+#endif
@@ -76,6 +76,16 @@ ConfigVariableBool multifile_always_binary
           "or extracted in either binary or text mode, according to the "
           "set_binary() or set_text() flag on the Filename."));
 
+ConfigVariableEnum<CompressionAlgorithm> file_compression_algorithm
+("file-compression-algorithm", CA_zlib,
+ PRC_DESC("Specifies the algorithm used to compress .pz files, compressed "
+          "subfiles of a Multifile, and anything else written through an "
+          "OCompressStream.  The default, zlib, can be read by any version "
+          "of Panda3D; zstd gives smaller files that decompress several "
+          "times faster, but can only be read by a build of Panda3D with "
+          "Zstandard support.  Files are read correctly regardless of this "
+          "setting."));
+
 ConfigVariableBool collect_tcp
 ("collect-tcp", false,
  PRC_DESC("Set this true to enable accumulation of several small consecutive "
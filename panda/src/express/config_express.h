@@ -23,6 +23,8 @@
 #include "configVariableDouble.h"
 #include "configVariableList.h"
 #include "configVariableFilename.h"
+#include "configVariableEnum.h"
+#include "compressionAlgorithm.h"
 
 // Include these so interrogate can find them.
 #include "executionEnvironment.h"
@@ -50,6 +52,7 @@ extern ConfigVariableInt patchfile_zone_size;
 
 extern EXPCL_PANDA_EXPRESS ConfigVariableBool keep_temporary_files;
 extern ConfigVariableBool multifile_always_binary;
+extern EXPCL_PANDA_EXPRESS ConfigVariableEnum<CompressionAlgorithm> file_compression_algorithm;
 
 extern EXPCL_PANDA_EXPRESS ConfigVariableBool collect_tcp;
 extern EXPCL_PANDA_EXPRESS ConfigVariableDouble collect_tcp_interval;
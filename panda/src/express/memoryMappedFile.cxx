@@ -0,0 +1,315 @@
+/**
+ * PANDA 3D SOFTWARE
+ * Copyright (c) Carnegie Mellon University.  All rights reserved.
+ *
+ * All use of this software is subject to the terms of the revised BSD
+ * license.  You should have received a copy of this license along
+ * with this source code in a file named "LICENSE."
+ *
+ * @file memoryMappedFile.cxx
+ * @author blablabla94
+ * @date 2026-10-17
+ */
+
+#include "memoryMappedFile.h"
+#include "config_express.h"
+#include "virtualFileSystem.h"
+#include "virtualFileSimple.h"
+#include "dcast.h"
+
+#ifdef _WIN32
+#ifndef WIN32_LEAN_AND_MEAN
+#define WIN32_LEAN_AND_MEAN 1
+#endif
+#include <windows.h>
+#else
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
+MemoryMappedFile::Files *MemoryMappedFile::_files = nullptr;
+MutexImpl MemoryMappedFile::_files_lock;
+
+/**
+ * Use get_file() to create a MemoryMappedFile.
+ */
+MemoryMappedFile::
+MemoryMappedFile(const Filename &filename) :
+  _filename(filename),
+  _data(nullptr),
+  _size(0)
+{
+#ifdef _WIN32
+  _handle = INVALID_HANDLE_VALUE;
+  _mapping = nullptr;
+#endif
+}
+
+/**
+ *
+ */
+MemoryMappedFile::
+~MemoryMappedFile() {
+#ifdef _WIN32
+  if (_data != nullptr) {
+    UnmapViewOfFile((LPCVOID)_data);
+  }
+  if (_mapping != nullptr) {
+    CloseHandle((HANDLE)_mapping);
+  }
+  if (_handle != INVALID_HANDLE_VALUE) {
+    CloseHandle((HANDLE)_handle);
+  }
+#else
+  if (_data != nullptr) {
+    munmap((void *)_data, _size);
+  }
+#endif
+}
+
+/**
+ * Returns a mapping of the indicated file on disk, sharing an existing
+ * mapping of the same file if there is one, and the file has not changed
+ * since it was mapped.  Returns NULL if the file cannot be mapped.
+ */
+PT(MemoryMappedFile) MemoryMappedFile::
+get_file(const Filename &filename) {
+  std::string key = filename.to_os_specific();
+
+  Identity identity;
+  if (!get_identity(filename, identity)) {
+    return nullptr;
+  }
+
+  _files_lock.lock();
+  if (_files == nullptr) {
+    _files = new Files;
+  }
+  Files::iterator fi = _files->find(key);
+  if (fi != _files->end()) {
+    PT(MemoryMappedFile) file = (*fi).second.lock();
+    if (file != nullptr && file->_identity == identity) {
+      _files_lock.unlock();
+      return file;
+    }
+  }
+  _files_lock.unlock();
+
+  PT(MemoryMappedFile) file = new MemoryMappedFile(filename);
+  if (!file->open()) {
+    return nullptr;
+  }
+
+  _files_lock.lock();
+  fi = _files->find(key);
+  if (fi != _files->end()) {
+    // Another thread may have mapped the same file in the meantime.
+    PT(MemoryMappedFile) other = (*fi).second.lock();
+    if (other != nullptr && other->_identity == file->_identity) {
+      _files_lock.unlock();
+      return other;
+    }
+
+    // Otherwise, the file has changed, and the new mapping replaces the old
+    // one.  Whoever still holds the old one keeps it.
+    (*fi).second = file;
+  } else {
+    _files->insert(Files::value_type(key, file));
+  }
+  _files_lock.unlock();
+  return file;
+}
+
+/**
+ * Maps the file that contains the indicated subfile, and fills pointer with
+ * the address of its first byte.  The SubfileInfo may name a file within the
+ * vfs; it is resolved to the file on disk that holds it, which may be a
+ * Multifile.  Returns NULL if the subfile is not stored directly on disk, for
+ * instance because it is compressed.
+ */
+PT(MemoryMappedFile) MemoryMappedFile::
+map_subfile(const SubfileInfo &info, const unsigned char *&pointer) {
+  if (info.is_empty()) {
+    return nullptr;
+  }
+
+  Filename filename = info.get_filename();
+  std::streamoff start = info.get_start();
+
+  VirtualFileSystem *vfs = VirtualFileSystem::get_global_ptr();
+  PT(VirtualFile) vfile = vfs->get_file(filename, true);
+  if (vfile != nullptr) {
+    // If the file was read through a decompressing stream, the offset is not
+    // meaningful in the file on disk.
+    if (filename.get_extension() == "pz" || filename.get_extension() == "gz") {
+      return nullptr;
+    }
+    if (vfile->is_of_type(VirtualFileSimple::get_class_type()) &&
+        DCAST(VirtualFileSimple, vfile)->is_implicit_pz_file()) {
+      return nullptr;
+    }
+
+    SubfileInfo system_info;
+    if (!vfile->get_system_info(system_info)) {
+      return nullptr;
+    }
+    filename = system_info.get_filename();
+    start += (std::streamoff)system_info.get_start();
+  }
+
+  PT(MemoryMappedFile) file = get_file(filename);
+  if (file == nullptr) {
+    return nullptr;
+  }
+  if (start < 0 || (size_t)start + (size_t)info.get_size() > file->get_size()) {
+    express_cat.warning()
+      << "Subfile " << info << " lies outside of " << filename << "\n";
+    return nullptr;
+  }
+
+  pointer = file->get_data() + start;
+  return file;
+}
+
+/**
+ * Fills in the size, modification time and file index of the indicated file
+ * on disk.  Returns true on success, false if the file does not exist.
+ */
+bool MemoryMappedFile::
+get_identity(const Filename &filename, Identity &identity) {
+#ifdef _WIN32
+  std::wstring os_filename = filename.to_os_specific_w();
+  HANDLE handle = CreateFileW(os_filename.c_str(), 0,
+                              FILE_SHARE_READ | FILE_SHARE_WRITE | FILE_SHARE_DELETE,
+                              nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+  if (handle == INVALID_HANDLE_VALUE) {
+    return false;
+  }
+  bool success = read_identity(handle, identity);
+  CloseHandle(handle);
+#else
+  int fd = ::open(filename.to_os_specific().c_str(), O_RDONLY);
+  if (fd < 0) {
+    return false;
+  }
+  bool success = read_identity(fd, identity);
+  close(fd);
+#endif
+  return success;
+}
+
+#ifdef _WIN32
+/**
+ * Fills in the identity of the file that the indicated handle is open on.
+ */
+bool MemoryMappedFile::
+read_identity(void *handle, Identity &identity) {
+  BY_HANDLE_FILE_INFORMATION info;
+  if (!GetFileInformationByHandle((HANDLE)handle, &info)) {
+    return false;
+  }
+  identity._size = ((uint64_t)info.nFileSizeHigh << 32) | info.nFileSizeLow;
+  identity._mtime = ((uint64_t)info.ftLastWriteTime.dwHighDateTime << 32) |
+    info.ftLastWriteTime.dwLowDateTime;
+  identity._device = info.dwVolumeSerialNumber;
+  identity._inode = ((uint64_t)info.nFileIndexHigh << 32) | info.nFileIndexLow;
+  return true;
+}
+
+#else
+/**
+ * Fills in the identity of the file that the indicated descriptor is open on.
+ */
+bool MemoryMappedFile::
+read_identity(int fd, Identity &identity) {
+  struct stat st;
+  if (fstat(fd, &st) != 0) {
+    return false;
+  }
+  identity._size = (uint64_t)st.st_size;
+#if defined(__APPLE__)
+  identity._mtime = (uint64_t)st.st_mtimespec.tv_sec * 1000000000 +
+    st.st_mtimespec.tv_nsec;
+#elif defined(__linux__)
+  identity._mtime = (uint64_t)st.st_mtim.tv_sec * 1000000000 +
+    st.st_mtim.tv_nsec;
+#else
+  identity._mtime = (uint64_t)st.st_mtime * 1000000000;
+#endif
+  identity._device = (uint64_t)st.st_dev;
+  identity._inode = (uint64_t)st.st_ino;
+  return true;
+}
+#endif  // _WIN32
+
+/**
+ * Maps the file into memory.  Returns true on success.
+ */
+bool MemoryMappedFile::
+open() {
+#ifdef _WIN32
+  std::wstring os_filename = _filename.to_os_specific_w();
+  HANDLE handle = CreateFileW(os_filename.c_str(), GENERIC_READ,
+                              FILE_SHARE_READ | FILE_SHARE_DELETE, nullptr,
+                              OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+  if (handle == INVALID_HANDLE_VALUE) {
+    return false;
+  }
+  _handle = handle;
+
+  LARGE_INTEGER size;
+  if (!GetFileSizeEx(handle, &size) || size.QuadPart == 0 ||
+      (uint64_t)size.QuadPart != (uint64_t)(size_t)size.QuadPart ||
+      !read_identity(handle, _identity)) {
+    return false;
+  }
+
+  HANDLE mapping = CreateFileMappingW(handle, nullptr, PAGE_READONLY, 0, 0, nullptr);
+  if (mapping == nullptr) {
+    return false;
+  }
+  _mapping = mapping;
+
+  void *data = MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+  if (data == nullptr) {
+    express_cat.warning()
+      << "Could not map " << _filename << " into memory.\n";
+    return false;
+  }
+  _size = (size_t)size.QuadPart;
+
+#else
+  std::string os_filename = _filename.to_os_specific();
+  int fd = ::open(os_filename.c_str(), O_RDONLY);
+  if (fd < 0) {
+    return false;
+  }
+
+  struct stat st;
+  if (fstat(fd, &st) != 0 || st.st_size == 0 ||
+      (uint64_t)st.st_size != (uint64_t)(size_t)st.st_size ||
+      !read_identity(fd, _identity)) {
+    close(fd);
+    return false;
+  }
+
+  void *data = mmap(nullptr, (size_t)st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+  close(fd);
+  if (data == MAP_FAILED) {
+    express_cat.warning()
+      << "Could not map " << _filename << " into memory.\n";
+    return false;
+  }
+  _size = (size_t)st.st_size;
+#endif
+
+  _data = (const unsigned char *)data;
+
+  if (express_cat.is_debug()) {
+    express_cat.debug()
+      << "Mapped " << _filename << " (" << _size << " bytes) into memory.\n";
+  }
+  return true;
+}
@@ -0,0 +1,94 @@
+/**
+ * PANDA 3D SOFTWARE
+ * Copyright (c) Carnegie Mellon University.  All rights reserved.
+ *
+ * All use of this software is subject to the terms of the revised BSD
+ * license.  You should have received a copy of this license along
+ * with this source code in a file named "LICENSE."
+ *
+ * @file memoryMappedFile.h
+ * @author blablabla94
+ * @date 2026-10-17
+ */
+
+#ifndef MEMORYMAPPEDFILE_H
+#define MEMORYMAPPEDFILE_H
+
+#include "pandabase.h"
+#include "referenceCount.h"
+#include "weakPointerTo.h"
+#include "filename.h"
+#include "subfileInfo.h"
+#include "mutexImpl.h"
+#include "pmap.h"
+
+/**
+ * A read-only view of an entire file on disk, mapped into the address space
+ * of the process.  The operating system pages the contents in on demand, and
+ * several processes that map the same file share the same physical pages.
+ *
+ * Mappings are shared: get_file() returns the existing mapping of a file if
+ * there is one still in use, and the file on disk is still the one that was
+ * mapped, with the same size and modification time.  A file that has been
+ * replaced gets a new mapping, while the old one stays valid for as long as
+ * it is in use.  The file is unmapped when the last reference goes away.
+ *
+ * A mapped file must not be modified or truncated in place: the mapping would
+ * see the new contents, and reading past a truncated end raises SIGBUS on
+ * most systems.  Replace it with a new file (e.g.  by renaming over it)
+ * instead.
+ */
+class EXPCL_PANDA_EXPRESS MemoryMappedFile : public ReferenceCount {
+private:
+  MemoryMappedFile(const Filename &filename);
+
+public:
+  ~MemoryMappedFile();
+
+  static PT(MemoryMappedFile) get_file(const Filename &filename);
+  static PT(MemoryMappedFile) map_subfile(const SubfileInfo &info,
+                                          const unsigned char *&pointer);
+
+  INLINE const Filename &get_filename() const;
+  INLINE const unsigned char *get_data() const;
+  INLINE size_t get_size() const;
+
+private:
+  // Identifies the version of a file on disk, so that the mapping of a file
+  // that has since been rewritten is not reused.
+  class Identity {
+  public:
+    INLINE Identity();
+    INLINE bool operator == (const Identity &other) const;
+
+    uint64_t _size;
+    uint64_t _mtime;
+    uint64_t _device;
+    uint64_t _inode;
+  };
+
+  static bool get_identity(const Filename &filename, Identity &identity);
+#ifdef _WIN32
+  static bool read_identity(void *handle, Identity &identity);
+#else
+  static bool read_identity(int fd, Identity &identity);
+#endif
+  bool open();
+
+  Filename _filename;
+  Identity _identity;
+  const unsigned char *_data;
+  size_t _size;
+#ifdef _WIN32
+  void *_handle;
+  void *_mapping;
+#endif
+
+  typedef pmap<std::string, WPT(MemoryMappedFile)> Files;
+  static Files *_files;
+  static MutexImpl _files_lock;
+};
+
+#include "memoryMappedFile.I"
+
+#endif
@@ -2,6 +2,7 @@
 #include "checksumHashGenerator.cxx"
 #include "config_express.cxx"
 #include "compress_string.cxx"
+#include "compressionAlgorithm.cxx"
 #include "copy_stream.cxx"
 #include "datagram.cxx"
 #include "datagramGenerator.cxx"
@@ -14,6 +15,7 @@
 #include "hashGeneratorBase.cxx"
 #include "hashVal.cxx"
 #include "memoryInfo.cxx"
+#include "memoryMappedFile.cxx"
 #include "memoryUsage.cxx"
 #include "memoryUsagePointerCounts.cxx"
 #include "memoryUsagePointers.cxx"
@@ -18,6 +18,10 @@
 #include "pnotify.h"
 #include "config_express.h"
 
+#ifdef HAVE_ZSTD
+#include <zstd.h>
+#endif
+
 using std::ios;
 using std::streamoff;
 using std::streampos;
@@ -96,8 +100,16 @@ open_read(std::istream *source, bool owns_source, std::streamsize source_length,
   if (result < 0) {
     show_zlib_error("inflateInit2", result, _z_source);
     close_read();
+    return;
   }
   thread_consider_yield();
+
+#ifdef HAVE_ZSTD
+  // A raw deflate stream can't be told apart from Zstandard data.
+  _sniff_source = header;
+  _zstd_avail_in = 0;
+  _zstd_total_out = 0;
+#endif
 }
 
 /**
@@ -115,6 +127,14 @@ close_read() {
     }
     thread_consider_yield();
 
+#ifdef HAVE_ZSTD
+    if (_zstd_source != nullptr) {
+      ZSTD_freeDCtx(_zstd_source);
+      _zstd_source = nullptr;
+    }
+    _sniff_source = false;
+#endif
+
     if (_owns_source) {
       delete _source;
       _owns_source = false;
@@ -131,6 +151,20 @@ open_write(std::ostream *dest, bool owns_dest, int compression_level, bool heade
   _dest = dest;
   _owns_dest = owns_dest;
 
+#ifdef HAVE_ZSTD
+  if (header && file_compression_algorithm == CA_zstd) {
+    _zstd_dest = ZSTD_createCCtx();
+    size_t result = ZSTD_CCtx_setParameter(_zstd_dest, ZSTD_c_compressionLevel,
+                                           compression_level);
+    if (ZSTD_isError(result)) {
+      express_cat.warning()
+        << "Zstandard error in ZSTD_CCtx_setParameter: "
+        << ZSTD_getErrorName(result) << "\n";
+    }
+    return;
+  }
+#endif
+
   _z_dest.next_in = Z_NULL;
   _z_dest.avail_in = 0;
   _z_dest.next_out = Z_NULL;
@@ -164,11 +198,19 @@ close_write() {
     write_chars(pbase(), n, Z_FINISH);
     pbump(-(int)n);
 
-    int result = deflateEnd(&_z_dest);
-    if (result < 0) {
-      show_zlib_error("deflateEnd", result, _z_dest);
+#ifdef HAVE_ZSTD
+    if (_zstd_dest != nullptr) {
+      ZSTD_freeCCtx(_zstd_dest);
+      _zstd_dest = nullptr;
+    } else
+#endif
+    {
+      int result = deflateEnd(&_z_dest);
+      if (result < 0) {
+        show_zlib_error("deflateEnd", result, _z_dest);
+      }
+      thread_consider_yield();
     }
-    thread_consider_yield();
 
     if (_owns_dest) {
       delete _dest;
@@ -192,6 +234,11 @@ seekoff(streamoff off, ios_seekdir dir, ios_openmode which) {
   // Determine the current position.
   size_t n = egptr() - gptr();
   streampos gpos = _z_source.total_out - n;
+#ifdef HAVE_ZSTD
+  if (_zstd_source != nullptr) {
+    gpos = _zstd_total_out - n;
+  }
+#endif
 
   // Implement tellg() and seeks to current position.
   if ((dir == ios::cur && off == 0) ||
@@ -208,6 +255,14 @@ seekoff(streamoff off, ios_seekdir dir, ios_openmode which) {
 
   if (_source->rdbuf()->pubseekpos(0, ios::in) == (streampos)0) {
     _source->clear();
+#ifdef HAVE_ZSTD
+    if (_zstd_source != nullptr) {
+      ZSTD_DCtx_reset(_zstd_source, ZSTD_reset_session_only);
+      _zstd_avail_in = 0;
+      _zstd_total_out = 0;
+      return 0;
+    }
+#endif
     _z_source.next_in = Z_NULL;
     _z_source.avail_in = 0;
     _z_source.next_out = Z_NULL;
@@ -311,27 +366,38 @@ underflow() {
  */
 size_t ZStreamBuf::
 read_chars(char *start, size_t length) {
+  bool eof = (_source_bytes_left == 0 || _source->eof() || _source->fail());
+
+#ifdef HAVE_ZSTD
+  if (_sniff_source) {
+    // Look at the first few bytes to see if this is Zstandard data.  Either
+    // way, they are kept to be decompressed below.
+    _sniff_source = false;
+    size_t read_count = read_source(decompress_buffer, decompress_buffer_size, eof);
+    _z_source.next_in = (Bytef *)decompress_buffer;
+    _z_source.avail_in = read_count;
+
+    static const unsigned char zstd_magic[4] = { 0x28, 0xb5, 0x2f, 0xfd };
+    if (read_count >= 4 && memcmp(decompress_buffer, zstd_magic, 4) == 0) {
+      _zstd_source = ZSTD_createDCtx();
+      _zstd_next_in = decompress_buffer;
+      _zstd_avail_in = read_count;
+      _z_source.avail_in = 0;
+    }
+  }
+  if (_zstd_source != nullptr) {
+    return read_chars_zstd(start, length);
+  }
+#endif
+
   _z_source.next_out = (Bytef *)start;
   _z_source.avail_out = length;
 
-  bool eof = (_source_bytes_left == 0 || _source->eof() || _source->fail());
   int flush = 0;
 
   while (_z_source.avail_out > 0) {
     if (_z_source.avail_in == 0 && !eof) {
-      size_t read_count = 0;
-      if (_source_bytes_left >= 0) {
-        // Don't read more than the specified limit.
-        _source->read(decompress_buffer,
-          std::min(_source_bytes_left, (std::streamsize)decompress_buffer_size));
-        read_count = _source->gcount();
-        _source_bytes_left -= read_count;
-      } else {
-        _source->read(decompress_buffer, decompress_buffer_size);
-        read_count = _source->gcount();
-      }
-      eof = (read_count == 0 || _source->eof() || _source->fail());
-
+      size_t read_count = read_source(decompress_buffer, decompress_buffer_size, eof);
       _z_source.next_in = (Bytef *)decompress_buffer;
       _z_source.avail_in = read_count;
     }
@@ -358,12 +424,40 @@ read_chars(char *start, size_t length) {
   return length;
 }
 
+/**
+ * Reads up to length bytes of compressed data from the source stream, without
+ * reading past the source_length given to open_read().  Sets eof to true if
+ * there is no more data to be read.
+ */
+size_t ZStreamBuf::
+read_source(char *buffer, size_t length, bool &eof) {
+  size_t read_count = 0;
+  if (_source_bytes_left >= 0) {
+    // Don't read more than the specified limit.
+    _source->read(buffer, std::min(_source_bytes_left, (std::streamsize)length));
+    read_count = _source->gcount();
+    _source_bytes_left -= read_count;
+  } else {
+    _source->read(buffer, length);
+    read_count = _source->gcount();
+  }
+  eof = (read_count == 0 || _source->eof() || _source->fail());
+  return read_count;
+}
+
 /**
  * Sends some characters to the dest stream.  The flush parameter is passed to
  * deflate().
  */
 void ZStreamBuf::
 write_chars(const char *start, size_t length, int flush) {
+#ifdef HAVE_ZSTD
+  if (_zstd_dest != nullptr) {
+    write_chars_zstd(start, length, flush);
+    return;
+  }
+#endif
+
   static const size_t compress_buffer_size = 4096;
   char compress_buffer[compress_buffer_size];
 
@@ -404,6 +498,86 @@ write_chars(const char *start, size_t length, int flush) {
   }
 }
 
+#ifdef HAVE_ZSTD
+/**
+ * The Zstandard equivalent of read_chars().
+ */
+size_t ZStreamBuf::
+read_chars_zstd(char *start, size_t length) {
+  ZSTD_outBuffer output = { start, length, 0 };
+  bool eof = (_source_bytes_left == 0 || _source->eof() || _source->fail());
+
+  while (output.pos < output.size) {
+    if (_zstd_avail_in == 0 && !eof) {
+      _zstd_avail_in = read_source(decompress_buffer, decompress_buffer_size, eof);
+      _zstd_next_in = decompress_buffer;
+    }
+
+    // Several frames may follow each other; the decoder handles that.
+    ZSTD_inBuffer input = { _zstd_next_in, _zstd_avail_in, 0 };
+    size_t prev_pos = output.pos;
+    size_t result = ZSTD_decompressStream(_zstd_source, &output, &input);
+    thread_consider_yield();
+    _zstd_next_in += input.pos;
+    _zstd_avail_in -= input.pos;
+
+    if (ZSTD_isError(result)) {
+      express_cat.warning()
+        << "Zstandard error in ZSTD_decompressStream: "
+        << ZSTD_getErrorName(result) << "\n";
+      break;
+    }
+    if (input.pos == 0 && output.pos == prev_pos) {
+      // No more progress is possible; this is the end of the file.
+      break;
+    }
+  }
+
+  _zstd_total_out += output.pos;
+  return output.pos;
+}
+
+/**
+ * The Zstandard equivalent of write_chars().  The flush parameter is
+ * interpreted as for deflate().
+ */
+void ZStreamBuf::
+write_chars_zstd(const char *start, size_t length, int flush) {
+  static const size_t compress_buffer_size = 4096;
+  char compress_buffer[compress_buffer_size];
+
+  ZSTD_EndDirective directive = ZSTD_e_continue;
+  if (flush == Z_FINISH) {
+    directive = ZSTD_e_end;
+  } else if (flush != 0) {
+    directive = ZSTD_e_flush;
+  }
+
+  ZSTD_inBuffer input = { start, length, 0 };
+  bool done;
+  do {
+    ZSTD_outBuffer output = { compress_buffer, compress_buffer_size, 0 };
+    size_t remaining = ZSTD_compressStream2(_zstd_dest, &output, &input, directive);
+    if (ZSTD_isError(remaining)) {
+      express_cat.warning()
+        << "Zstandard error in ZSTD_compressStream2: "
+        << ZSTD_getErrorName(remaining) << "\n";
+      return;
+    }
+    if (output.pos != 0) {
+      _dest->write(compress_buffer, output.pos);
+    }
+    thread_consider_yield();
+
+    if (directive == ZSTD_e_continue) {
+      done = (input.pos == input.size);
+    } else {
+      done = (remaining == 0);
+    }
+  } while (!done);
+}
+#endif  // HAVE_ZSTD
+
 /**
  * Reports a recent error code returned by zlib.
  */
@@ -21,8 +21,17 @@
 
 #include <zlib.h>
 
+#ifdef HAVE_ZSTD
+struct ZSTD_CCtx_s;
+struct ZSTD_DCtx_s;
+#endif
+
 /**
  * The streambuf object that implements IDecompressStream and OCompressStream.
+ *
+ * If Panda was built with Zstandard support, a stream opened with header=true
+ * may also read Zstandard data, which is recognized by its magic number, and
+ * writes Zstandard data if file-compression-algorithm is set to zstd.
  */
 class EXPCL_PANDA_EXPRESS ZStreamBuf : public std::streambuf {
 public:
@@ -48,6 +57,12 @@ private:
   void write_chars(const char *start, size_t length, int flush);
   void show_zlib_error(const char *function, int error_code, z_stream &z);
 
+  size_t read_source(char *buffer, size_t length, bool &eof);
+#ifdef HAVE_ZSTD
+  size_t read_chars_zstd(char *start, size_t length);
+  void write_chars_zstd(const char *start, size_t length, int flush);
+#endif
+
 private:
   std::istream *_source;
   std::streamsize _source_bytes_left = -1;
@@ -59,6 +74,17 @@ private:
   z_stream _z_source;
   z_stream _z_dest;
 
+#ifdef HAVE_ZSTD
+  // If _sniff_source is true, we haven't yet looked at the first bytes of the
+  // source to see whether it is zlib or Zstandard data.
+  bool _sniff_source = false;
+  ZSTD_DCtx_s *_zstd_source = nullptr;
+  const char *_zstd_next_in = nullptr;
+  size_t _zstd_avail_in = 0;
+  size_t _zstd_total_out = 0;
+  ZSTD_CCtx_s *_zstd_dest = nullptr;
+#endif
+
   char *_buffer;
 
   // We need to store the decompression buffer on the class object, because
@@ -755,22 +755,14 @@ void CLP(CgShaderContext)::
 update_transform_table(const TransformTable *table) {
   LMatrix4f *matrices = (LMatrix4f *)alloca(_transform_table_size * 64);
 
-  int i = 0;
   if (table != nullptr) {
-    int num_transforms = std::min(_transform_table_size, (long)table->get_num_transforms());
-    for (; i < num_transforms; ++i) {
-#ifdef STDFLOAT_DOUBLE
-      LMatrix4 matrix;
-      table->get_transform(i)->get_matrix(matrix);
-      matrices[i] = LCAST(float, matrix);
-#else
-      table->get_transform(i)->get_matrix(matrices[i]);
-#endif
+    table->get_matrices(matrices, _transform_table_size,
+                        Thread::get_current_thread());
+  } else {
+    for (long i = 0; i < _transform_table_size; ++i) {
+      matrices[i] = LMatrix4f::ident_mat();
     }
   }
-  for (; i < _transform_table_size; ++i) {
-    matrices[i] = LMatrix4f::ident_mat();
-  }
 
   cgGLSetMatrixParameterArrayfc(_transform_table_param, 0,
                                 _transform_table_size, (float *)matrices);
@@ -12,6 +12,7 @@
  */
 
 #include "dcast.h"
+#include "shaderAttrib.h"
 
 TypeHandle CLP(GeomMunger)::_type_handle;
 
@@ -34,6 +35,13 @@ CLP(GeomMunger)(GraphicsStateGuardian *gsg, const RenderState *state) :
     _flags |= F_parallel_arrays;
   }
 
+  const ShaderAttrib *shader_attrib;
+  state->get_attrib_def(shader_attrib);
+  if (shader_attrib->get_shader() == nullptr && !shader_attrib->auto_shader()) {
+    // The fixed-function pipeline can't decode octahedral normals.
+    _flags |= F_decode_octahedral;
+  }
+
   if ((_flags & F_parallel_arrays) == 0) {
     // Set a callback to unregister ourselves when either the Texture or the
     // TexGen object gets deleted.
@@ -126,6 +134,32 @@ munge_format_impl(const GeomVertexFormat *orig,
   }
 #endif  // !OPENGLES
 
+  for (size_t i = 0; i < orig->get_num_columns(); ++i) {
+    const GeomVertexColumn *column = orig->get_column(i);
+    int array = orig->get_array_with(column->get_name());
+
+    if (column->get_numeric_type() == NT_float16 &&
+        !glgsg->_supports_vertex_half_float) {
+      PT(GeomVertexArrayFormat) array_format = new_format->modify_array(array);
+      array_format->add_column(column->get_name(), column->get_num_components(),
+                               NT_float32, column->get_contents(),
+                               column->get_start(),
+                               column->get_column_alignment());
+
+    } else if ((_flags & F_decode_octahedral) != 0 &&
+               (column->get_contents() == C_octahedral_normal ||
+                column->get_contents() == C_octahedral_vector)) {
+      // An octahedrally-encoded normal; only the shader generator knows how
+      // to decode these on the GPU, so expand it to three floats here.
+      PT(GeomVertexArrayFormat) array_format = new_format->modify_array(array);
+      Contents contents = (column->get_contents() == C_octahedral_normal)
+        ? C_normal : C_vector;
+      array_format->add_column(column->get_name(), 3, NT_float32,
+                               contents, column->get_start(),
+                               column->get_column_alignment());
+    }
+  }
+
   const GeomVertexColumn *color_type = orig->get_color_column();
   if (color_type != nullptr &&
       color_type->get_numeric_type() == NT_packed_dabc &&
@@ -312,6 +346,19 @@ premunge_format_impl(const GeomVertexFormat *orig) {
   }
 #endif  // !OPENGLES
 
+  for (size_t i = 0; i < orig->get_num_columns(); ++i) {
+    const GeomVertexColumn *column = orig->get_column(i);
+    if (column->get_numeric_type() == NT_float16 &&
+        !glgsg->_supports_vertex_half_float) {
+      int array = orig->get_array_with(column->get_name());
+      PT(GeomVertexArrayFormat) array_format = new_format->modify_array(array);
+      array_format->add_column(column->get_name(), column->get_num_components(),
+                               NT_float32, column->get_contents(),
+                               column->get_start(),
+                               column->get_column_alignment());
+    }
+  }
+
   CPT(GeomVertexFormat) format = GeomVertexFormat::register_format(new_format);
 
   if ((_flags & F_parallel_arrays) != 0) {
@@ -53,6 +53,7 @@ private:
   enum Flags {
     F_interleaved_arrays   = 0x0001,
     F_parallel_arrays      = 0x0002,
+    F_decode_octahedral    = 0x0004,
   };
   int _flags;
 
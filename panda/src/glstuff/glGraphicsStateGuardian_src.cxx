@@ -25,6 +25,7 @@
 #include "geomLines.h"
 #include "geomLinestrips.h"
 #include "geomPoints.h"
+#include "pdeque.h"
 #include "geomVertexReader.h"
 #include "graphicsWindow.h"
 #include "lens.h"
@@ -523,6 +524,16 @@ CLP(GraphicsStateGuardian)(GraphicsEngine *engine, GraphicsPipe *pipe) :
 
   _white_texture = 0;
 
+#ifndef OPENGLES
+  _supports_multi_draw_indirect = false;
+  _indirect_buffer = 0;
+  _indirect_buffer_size = 0;
+  _indirect_buffer_offset = 0;
+
+  _supports_sync = false;
+  _vertex_stream_buffer = nullptr;
+#endif
+
 #ifndef OPENGLES
   _shader_point_size = false;
 #endif
@@ -550,6 +561,10 @@ CLP(GraphicsStateGuardian)::
   }
 
   close_gsg();
+
+#ifndef OPENGLES
+  delete _vertex_stream_buffer;
+#endif
 }
 
 /**
@@ -1342,12 +1357,22 @@ reset() {
 #ifdef OPENGLES
   _supports_packed_dabc = false;
   _supports_packed_ufloat = false;
+#endif
+
+#if defined(OPENGLES_1)
+  _supports_vertex_half_float = false;
+#elif defined(OPENGLES)
+  // GL_OES_vertex_half_float uses a different enum value, so we only use
+  // half-float vertices on OpenGL ES 3.
+  _supports_vertex_half_float = is_at_least_gles_version(3, 0);
 #else
   _supports_packed_dabc = is_at_least_gl_version(3, 2) ||
                           has_extension("GL_ARB_vertex_array_bgra") ||
                           has_extension("GL_EXT_vertex_array_bgra");
   _supports_packed_ufloat = is_at_least_gl_version(4, 4) ||
                             has_extension("GL_ARB_vertex_type_10f_11f_11f_rev");
+  _supports_vertex_half_float = is_at_least_gl_version(3, 0) ||
+                                has_extension("GL_ARB_half_float_vertex");
 #endif
 
 #ifdef OPENGLES
@@ -2275,6 +2300,61 @@ reset() {
   }
 #endif
 
+#ifndef OPENGLES
+  // Check if we can submit several indirect draws in one call.
+  _supports_multi_draw_indirect = false;
+  if (_supports_indirect_draw && _supports_buffers &&
+      (is_at_least_gl_version(4, 3) || has_extension("GL_ARB_multi_draw_indirect"))) {
+    _glMultiDrawArraysIndirect = (PFNGLMULTIDRAWARRAYSINDIRECTPROC)
+      get_extension_func("glMultiDrawArraysIndirect");
+    _glMultiDrawElementsIndirect = (PFNGLMULTIDRAWELEMENTSINDIRECTPROC)
+      get_extension_func("glMultiDrawElementsIndirect");
+
+    if (_glMultiDrawArraysIndirect == nullptr || _glMultiDrawElementsIndirect == nullptr) {
+      GLCAT.warning()
+        << "Multi-draw indirect advertised as supported by OpenGL runtime, but could not get pointers to extension functions.\n";
+    } else {
+      _supports_multi_draw_indirect = true;
+    }
+  }
+
+  // The context is current during reset(), so we can free the buffer we used
+  // before, if any.  It is made again when it is next needed.
+  if (_indirect_buffer != 0) {
+    _glDeleteBuffers(1, &_indirect_buffer);
+    _indirect_buffer = 0;
+  }
+  _indirect_buffer_size = 0;
+  _indirect_buffer_offset = 0;
+
+  // Fence sync objects are needed for the vertex stream buffer.
+  _supports_sync = false;
+  if (is_at_least_gl_version(3, 2) || has_extension("GL_ARB_sync")) {
+    _glFenceSync = (PFNGLFENCESYNCPROC)
+      get_extension_func("glFenceSync");
+    _glDeleteSync = (PFNGLDELETESYNCPROC)
+      get_extension_func("glDeleteSync");
+    _glClientWaitSync = (PFNGLCLIENTWAITSYNCPROC)
+      get_extension_func("glClientWaitSync");
+
+    if (_glFenceSync == nullptr || _glDeleteSync == nullptr ||
+        _glClientWaitSync == nullptr) {
+      GLCAT.warning()
+        << "Sync objects advertised as supported by OpenGL runtime, but could not get pointers to extension functions.\n";
+    } else {
+      _supports_sync = true;
+    }
+  }
+
+  // As above, the context is current, so the stream buffer can be released
+  // properly.
+  if (_vertex_stream_buffer != nullptr) {
+    _vertex_stream_buffer->release();
+    delete _vertex_stream_buffer;
+    _vertex_stream_buffer = nullptr;
+  }
+#endif
+
 #ifdef OPENGLES_1
   _supports_framebuffer_multisample = false;
   _supports_framebuffer_blit = false;
@@ -5027,6 +5107,14 @@ draw_tristrips(const GeomPrimitivePipelineReader *reader, bool force) {
         nassertr(reader->get_mins()->get_num_rows() == (int)ends.size() &&
                  reader->get_maxs()->get_num_rows() == (int)ends.size(), false);
 
+#ifndef OPENGLES
+        if (draw_multi_indirect(GL_TRIANGLE_STRIP, reader, client_pointer, ends, 2,
+                                _vertices_tristrip_pcollector)) {
+          report_my_gl_errors();
+          return true;
+        }
+#endif  // !OPENGLES
+
         unsigned int start = 0;
         for (size_t i = 0; i < ends.size(); i++) {
           _vertices_tristrip_pcollector.add_level(ends[i] - start);
@@ -5048,6 +5136,14 @@ draw_tristrips(const GeomPrimitivePipelineReader *reader, bool force) {
           start = ends[i] + 2;
         }
       } else {
+#ifndef OPENGLES
+        if (draw_multi_indirect(GL_TRIANGLE_STRIP, reader, nullptr, ends, 2,
+                                _vertices_tristrip_pcollector)) {
+          report_my_gl_errors();
+          return true;
+        }
+#endif  // !OPENGLES
+
         unsigned int start = 0;
         int first_vertex = reader->get_first_vertex();
         for (size_t i = 0; i < ends.size(); i++) {
@@ -5230,6 +5326,14 @@ draw_trifans(const GeomPrimitivePipelineReader *reader, bool force) {
       nassertr(reader->get_mins()->get_num_rows() == (int)ends.size() &&
                reader->get_maxs()->get_num_rows() == (int)ends.size(), false);
 
+#ifndef OPENGLES
+      if (draw_multi_indirect(GL_TRIANGLE_FAN, reader, client_pointer, ends, 0,
+                              _vertices_trifan_pcollector)) {
+        report_my_gl_errors();
+        return true;
+      }
+#endif  // !OPENGLES
+
       unsigned int start = 0;
       for (size_t i = 0; i < ends.size(); i++) {
         _vertices_trifan_pcollector.add_level(ends[i] - start);
@@ -5250,6 +5354,14 @@ draw_trifans(const GeomPrimitivePipelineReader *reader, bool force) {
         start = ends[i];
       }
     } else {
+#ifndef OPENGLES
+      if (draw_multi_indirect(GL_TRIANGLE_FAN, reader, nullptr, ends, 0,
+                              _vertices_trifan_pcollector)) {
+        report_my_gl_errors();
+        return true;
+      }
+#endif  // !OPENGLES
+
       unsigned int start = 0;
       int first_vertex = reader->get_first_vertex();
       for (size_t i = 0; i < ends.size(); i++) {
@@ -5551,6 +5663,14 @@ draw_linestrips(const GeomPrimitivePipelineReader *reader, bool force) {
         nassertr(reader->get_mins()->get_num_rows() == (int)ends.size() &&
                  reader->get_maxs()->get_num_rows() == (int)ends.size(), false);
 
+#ifndef OPENGLES
+        if (draw_multi_indirect(GL_LINE_STRIP, reader, client_pointer, ends, 1,
+                                _vertices_other_pcollector)) {
+          report_my_gl_errors();
+          return true;
+        }
+#endif  // !OPENGLES
+
         unsigned int start = 0;
         for (size_t i = 0; i < ends.size(); i++) {
           _vertices_other_pcollector.add_level(ends[i] - start);
@@ -5572,6 +5692,14 @@ draw_linestrips(const GeomPrimitivePipelineReader *reader, bool force) {
           start = ends[i] + 1;
         }
       } else {
+#ifndef OPENGLES
+        if (draw_multi_indirect(GL_LINE_STRIP, reader, nullptr, ends, 1,
+                                _vertices_other_pcollector)) {
+          report_my_gl_errors();
+          return true;
+        }
+#endif  // !OPENGLES
+
         unsigned int start = 0;
         int first_vertex = reader->get_first_vertex();
         for (size_t i = 0; i < ends.size(); i++) {
@@ -5768,6 +5896,180 @@ draw_points(const GeomPrimitivePipelineReader *reader, bool force) {
   return true;
 }
 
+/**
+ * Draws all of the indicated Geoms, which use the same vertex data, with a
+ * single glMultiDrawElementsIndirect call.  The index data of the primitives
+ * is copied into the stream buffer, where it is reused for as long as it is
+ * not modified, and is followed by one command for each primitive.  The
+ * stream buffer is fenced off again by end_draw_primitives().
+ *
+ * Returns false, without drawing anything, if this is not possible, in which
+ * case the caller should draw the Geoms one at a time.  All of the primitives
+ * must be indexed triangles, lines or points of the same kind and index type,
+ * and all of the vertex arrays must be in buffer objects.
+ */
+bool CLP(GraphicsStateGuardian)::
+draw_geoms(const GeomPipelineReader * const *geom_readers, size_t num_geoms,
+           const GeomVertexDataPipelineReader *data_reader, bool force) {
+#ifndef OPENGLES
+  if (!_supports_multi_draw_indirect || !gl_multi_draw_indirect ||
+      num_geoms < 2 || !vertex_buffers || !vertex_arrays) {
+    return false;
+  }
+
+#ifdef SUPPORT_FIXED_FUNCTION
+  if (has_fixed_function_pipeline() && display_lists &&
+      data_reader->get_usage_hint() == Geom::UH_static) {
+    // begin_draw_primitives() would compile a display list for the first
+    // Geom, which must not contain the others.
+    return false;
+  }
+#endif
+
+  CLP(StreamBuffer) *stream_buffer = get_stream_buffer();
+  if (stream_buffer == nullptr) {
+    return false;
+  }
+
+  // begin_draw_primitives() copies the UH_stream vertex arrays into the same
+  // stream buffer after the index data has been written, so these count
+  // towards the amount of data that must fit in one section.  Otherwise, the
+  // buffer might wrap around onto the index data before the draw is issued.
+  size_t num_bytes = 0;
+  int num_arrays = data_reader->get_num_arrays();
+  for (int ai = 0; ai < num_arrays; ++ai) {
+    const GeomVertexArrayDataHandle *array_reader = data_reader->get_array_reader(ai);
+    if (array_reader->get_usage_hint() < gl_min_buffer_usage_hint) {
+      return false;
+    }
+    if (array_reader->get_usage_hint() == Geom::UH_stream) {
+      num_bytes += array_reader->get_data_size_bytes() + 16;
+    }
+  }
+
+  // Collect the primitives, and make sure that they can all be drawn with
+  // the same call, and that their index data and commands fit in one section
+  // of the stream buffer, together with the streamed vertex arrays.
+  Thread *current_thread = data_reader->get_current_thread();
+  pdeque<GeomPrimitivePipelineReader> readers;
+  TypeHandle prim_type = TypeHandle::none();
+  GeomEnums::NumericType index_type = GeomEnums::NT_uint16;
+  for (size_t gi = 0; gi < num_geoms; ++gi) {
+    const GeomPipelineReader *geom_reader = geom_readers[gi];
+    int num_primitives = geom_reader->get_num_primitives();
+    for (int pi = 0; pi < num_primitives; ++pi) {
+      readers.emplace_back(geom_reader->get_primitive(pi), current_thread);
+      const GeomPrimitivePipelineReader &reader = readers.back();
+      if (reader.get_num_vertices() == 0) {
+        readers.pop_back();
+        continue;
+      }
+
+      TypeHandle type = reader.get_object()->get_type();
+      if (!reader.is_indexed() ||
+          (type != GeomTriangles::get_class_type() &&
+           type != GeomLines::get_class_type() &&
+           type != GeomPoints::get_class_type())) {
+        return false;
+      }
+      if (readers.size() == 1) {
+        prim_type = type;
+        index_type = reader.get_index_type();
+      } else if (type != prim_type || reader.get_index_type() != index_type) {
+        return false;
+      }
+      num_bytes += reader.get_data_size_bytes() + reader.get_index_stride() +
+                   5 * sizeof(GLuint);
+    }
+  }
+  if (readers.size() < 2 || num_bytes > stream_buffer->get_section_size()) {
+    return false;
+  }
+
+  // Copy the index data, and build a DrawElementsIndirectCommand for each
+  // primitive.  The firstIndex field is counted in indices from the start of
+  // the stream buffer, which is bound as the element array buffer.
+  GLuint instance_count = 1;
+  if (_supports_geometry_instancing && _instance_count > 0) {
+    instance_count = (GLuint)_instance_count;
+  }
+
+  size_t num_draws = readers.size();
+  _indirect_commands.resize(num_draws * 5);
+  GLuint *command = &_indirect_commands[0];
+  int num_vertices = 0;
+  for (GeomPrimitivePipelineReader &reader : readers) {
+    reader.check_minmax();
+    nassertr(reader.check_valid(data_reader), false);
+
+    int index_stride = reader.get_index_stride();
+    GLintptr offset = stream_buffer->find(reader.get_modified());
+    if (offset < 0) {
+      const unsigned char *client_pointer = reader.get_read_pointer(force);
+      if (client_pointer == nullptr) {
+        return false;
+      }
+      offset = stream_buffer->write(reader.get_modified(), client_pointer,
+                                    reader.get_data_size_bytes(), index_stride);
+      nassertr(offset >= 0, false);
+      _data_transferred_pcollector.add_level(reader.get_data_size_bytes());
+    }
+
+    command[0] = (GLuint)reader.get_num_vertices();
+    command[1] = instance_count;
+    command[2] = (GLuint)(offset / index_stride);
+    command[3] = 0;
+    command[4] = 0;
+    command += 5;
+    num_vertices += reader.get_num_vertices();
+  }
+
+  if (!begin_draw_primitives(geom_readers[0], data_reader, force)) {
+    // The vertex data could not be set up, so none of the Geoms could have
+    // been drawn.
+    return true;
+  }
+
+  if (prim_type == GeomTriangles::get_class_type()) {
+    _vertices_tri_pcollector.add_level(num_vertices);
+    _primitive_batches_tri_pcollector.add_level(1);
+  } else {
+    _vertices_other_pcollector.add_level(num_vertices);
+    _primitive_batches_other_pcollector.add_level(1);
+  }
+
+  GLenum mode;
+  if (prim_type == GeomTriangles::get_class_type()) {
+    mode = GL_TRIANGLES;
+  } else if (prim_type == GeomLines::get_class_type()) {
+    mode = GL_LINES;
+  } else {
+    mode = GL_POINTS;
+  }
+
+  const void *indirect = write_indirect_commands(_indirect_commands);
+
+  GLuint index = stream_buffer->get_index();
+  if (_current_ibuffer_index != index) {
+    if (GLCAT.is_spam() && gl_debug_buffers) {
+      GLCAT.spam()
+        << "binding index stream buffer " << (int)index << "\n";
+    }
+    _glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, index);
+    _current_ibuffer_index = index;
+  }
+
+  _glMultiDrawElementsIndirect(mode, get_numeric_type(index_type), indirect,
+                               (GLsizei)num_draws, 0);
+  _glBindBuffer(GL_DRAW_INDIRECT_BUFFER, 0);
+
+  end_draw_primitives();
+  return true;
+#else
+  return false;
+#endif  // OPENGLES
+}
+
 /**
  * Called after a sequence of draw_primitive() functions are called, this
  * should do whatever cleanup is appropriate.
@@ -5803,6 +6105,14 @@ end_draw_primitives() {
   }
 #endif
 
+#ifndef OPENGLES
+  if (_vertex_stream_buffer != nullptr) {
+    // Now that the draw calls have been issued, we can fence off any stream
+    // buffer sections they read from.
+    _vertex_stream_buffer->fence();
+  }
+#endif
+
   GraphicsStateGuardian::end_draw_primitives();
   maybe_gl_finish();
   report_my_gl_errors();
@@ -6524,6 +6834,23 @@ setup_array_data(const unsigned char *&client_pointer,
     return (client_pointer != nullptr);
   }
 
+#ifndef OPENGLES
+  GLintptr offset;
+  if (stream_array_data(offset, array_reader, force)) {
+    GLuint index = _vertex_stream_buffer->get_index();
+    if (_current_vbuffer_index != index) {
+      if (GLCAT.is_spam() && gl_debug_buffers) {
+        GLCAT.spam()
+          << "binding vertex stream buffer " << (int)index << "\n";
+      }
+      _glBindBuffer(GL_ARRAY_BUFFER, index);
+      _current_vbuffer_index = index;
+    }
+    client_pointer = (const unsigned char *)offset;
+    return true;
+  }
+#endif
+
   // Prepare the buffer object and bind it.
   CLP(VertexBufferContext) *gvbc = DCAST(CLP(VertexBufferContext),
     array_reader->prepare_now(get_prepared_objects(), this));
@@ -6547,6 +6874,78 @@ setup_array_data(const unsigned char *&client_pointer,
   return true;
 }
 
+#ifndef OPENGLES
+/**
+ * Returns the stream buffer, creating it first if necessary, or nullptr if it
+ * is disabled or not supported.
+ */
+CLP(StreamBuffer) *CLP(GraphicsStateGuardian)::
+get_stream_buffer() {
+  if (gl_stream_buffer_size <= 0 || !_supports_buffer_storage ||
+      !_supports_sync) {
+    return nullptr;
+  }
+
+  if (_vertex_stream_buffer == nullptr) {
+    _vertex_stream_buffer =
+      new CLP(StreamBuffer)(this, GL_ARRAY_BUFFER, (size_t)gl_stream_buffer_size);
+
+    // Creating the buffer disturbed the GL_ARRAY_BUFFER binding.
+    _current_vbuffer_index = 0;
+  }
+  if (!_vertex_stream_buffer->is_valid()) {
+    return nullptr;
+  }
+  return _vertex_stream_buffer;
+}
+
+/**
+ * Copies the indicated array into the vertex stream buffer, if it has the
+ * UH_stream usage hint and the stream buffer is enabled, and sets offset to
+ * the location of the copy within the stream buffer, which is not bound.
+ * Arrays that are drawn more than once without being modified are only copied
+ * once.
+ *
+ * Returns false if the array should instead be loaded into its own buffer
+ * object.  This is also returned if the data is not currently available, in
+ * which case the regular path will report the failure.
+ */
+bool CLP(GraphicsStateGuardian)::
+stream_array_data(GLintptr &offset,
+                  const GeomVertexArrayDataHandle *array_reader,
+                  bool force) {
+  if (array_reader->get_usage_hint() != Geom::UH_stream ||
+      get_stream_buffer() == nullptr) {
+    return false;
+  }
+
+  UpdateSeq modified = array_reader->get_modified();
+  offset = _vertex_stream_buffer->find(modified);
+  if (offset >= 0) {
+    return true;
+  }
+
+  size_t num_bytes = array_reader->get_data_size_bytes();
+  if (num_bytes == 0 || num_bytes > _vertex_stream_buffer->get_section_size()) {
+    return false;
+  }
+
+  const unsigned char *client_pointer = array_reader->get_read_pointer(force);
+  if (client_pointer == nullptr) {
+    return false;
+  }
+
+  PStatGPUTimer timer(this, _load_vertex_buffer_pcollector, array_reader->get_current_thread());
+  if (GLCAT.is_debug() && gl_debug_buffers) {
+    GLCAT.debug()
+      << "copying " << num_bytes << " bytes into vertex stream buffer\n";
+  }
+  offset = _vertex_stream_buffer->write(modified, client_pointer, num_bytes, 16);
+  _data_transferred_pcollector.add_level(num_bytes);
+  return (offset >= 0);
+}
+#endif  // !OPENGLES
+
 /**
  * Creates a new retained-mode representation of the given data, and returns a
  * newly-allocated IndexBufferContext pointer to reference it.  It is the
@@ -6771,6 +7170,126 @@ setup_primitive(const unsigned char *&client_pointer,
   return true;
 }
 
+#ifndef OPENGLES
+/**
+ * Draws the individual strips or fans of a composite primitive using a single
+ * glMultiDraw*Indirect call, instead of issuing one draw call per strip.
+ * ends is the list of end indices as returned by get_ends(), and gap is the
+ * number of vertices between the end of one strip and the start of the next.
+ *
+ * Returns true if the primitive was drawn, or false if multi-draw indirect
+ * can't be used for it, in which case the caller should fall back to drawing
+ * the strips individually.  All of the vertex and index data must live in
+ * buffer objects, since the commands can't reference client memory.
+ */
+bool CLP(GraphicsStateGuardian)::
+draw_multi_indirect(GLenum mode, const GeomPrimitivePipelineReader *reader,
+                    const unsigned char *client_pointer, const CPTA_int &ends,
+                    int gap, PStatCollector &vertices_pcollector) {
+  size_t num_draws = ends.size();
+  if (!_supports_multi_draw_indirect || !gl_multi_draw_indirect ||
+      num_draws < 2 || !vertex_buffers || _geom_display_list != 0) {
+    return false;
+  }
+
+  bool indexed = reader->is_indexed();
+  if (indexed && client_pointer != nullptr) {
+    // The index data is not in a buffer object.
+    return false;
+  }
+
+  nassertr(_data_reader != nullptr, false);
+  int num_arrays = _data_reader->get_num_arrays();
+  for (int ai = 0; ai < num_arrays; ++ai) {
+    if (_data_reader->get_array_reader(ai)->get_usage_hint() < gl_min_buffer_usage_hint) {
+      return false;
+    }
+  }
+
+  GLuint instance_count = 1;
+  if (_supports_geometry_instancing && _instance_count > 0) {
+    instance_count = (GLuint)_instance_count;
+  }
+
+  // Build the command list.  DrawElementsIndirectCommand has an additional
+  // baseVertex field compared to DrawArraysIndirectCommand.
+  size_t command_size = indexed ? 5 : 4;
+  _indirect_commands.resize(num_draws * command_size);
+  GLuint *command = &_indirect_commands[0];
+
+  GLuint first = indexed ? 0 : (GLuint)reader->get_first_vertex();
+  unsigned int start = 0;
+  for (size_t i = 0; i < num_draws; ++i) {
+    vertices_pcollector.add_level(ends[i] - start);
+    command[0] = ends[i] - start;
+    command[1] = instance_count;
+    command[2] = first + start;
+    command[3] = 0;
+    if (indexed) {
+      command[4] = 0;
+    }
+    command += command_size;
+    start = ends[i] + gap;
+  }
+
+  const void *indirect = write_indirect_commands(_indirect_commands);
+  if (indexed) {
+    _glMultiDrawElementsIndirect(mode, get_numeric_type(reader->get_index_type()),
+                                 indirect, (GLsizei)num_draws, 0);
+  } else {
+    _glMultiDrawArraysIndirect(mode, indirect, (GLsizei)num_draws, 0);
+  }
+
+  _glBindBuffer(GL_DRAW_INDIRECT_BUFFER, 0);
+  return true;
+}
+
+/**
+ * Copies the indicated commands into a buffer object, which is left bound to
+ * GL_DRAW_INDIRECT_BUFFER, and returns their offset in the form expected by
+ * the indirect draw calls.
+ *
+ * The commands are written to the stream buffer if it is available.
+ * Otherwise, they are appended to a separate streaming buffer, which is
+ * orphaned whenever it fills up, so that we never have to wait for the GPU
+ * to finish reading the commands we submitted earlier.
+ */
+const void *CLP(GraphicsStateGuardian)::
+write_indirect_commands(const pvector<GLuint> &commands) {
+  nassertr(!commands.empty(), nullptr);
+  GLsizeiptr num_bytes = (GLsizeiptr)(commands.size() * sizeof(GLuint));
+
+  CLP(StreamBuffer) *stream_buffer = get_stream_buffer();
+  if (stream_buffer != nullptr) {
+    GLintptr offset = stream_buffer->write(&commands[0], num_bytes, sizeof(GLuint));
+    if (offset >= 0) {
+      _glBindBuffer(GL_DRAW_INDIRECT_BUFFER, stream_buffer->get_index());
+      return (const void *)offset;
+    }
+  }
+
+  if (_indirect_buffer == 0) {
+    _glGenBuffers(1, &_indirect_buffer);
+  }
+  _glBindBuffer(GL_DRAW_INDIRECT_BUFFER, _indirect_buffer);
+  if (_indirect_buffer_offset + num_bytes > _indirect_buffer_size) {
+    GLsizeiptr new_size = std::max(_indirect_buffer_size, (GLsizeiptr)65536);
+    while (new_size < num_bytes) {
+      new_size *= 2;
+    }
+    _glBufferData(GL_DRAW_INDIRECT_BUFFER, new_size, nullptr, GL_STREAM_DRAW);
+    _indirect_buffer_size = new_size;
+    _indirect_buffer_offset = 0;
+  }
+  _glBufferSubData(GL_DRAW_INDIRECT_BUFFER, _indirect_buffer_offset, num_bytes,
+                   &commands[0]);
+
+  GLintptr offset = _indirect_buffer_offset;
+  _indirect_buffer_offset += num_bytes;
+  return (const void *)offset;
+}
+#endif  // !OPENGLES
+
 #ifndef OPENGLES
 /**
  * Creates a new retained-mode representation of the given data, and returns a
@@ -9230,6 +9749,13 @@ get_numeric_type(Geom::NumericType numeric_type) {
 #else
     break;
 #endif
+
+  case Geom::NT_float16:
+#ifndef OPENGLES_1
+    return GL_HALF_FLOAT;
+#else
+    break;
+#endif
   }
 
   GLCAT.error()
@@ -326,6 +326,10 @@ public:
   virtual bool draw_points(const GeomPrimitivePipelineReader *reader,
                            bool force);
   virtual void end_draw_primitives();
+  virtual bool draw_geoms(const GeomPipelineReader * const *geom_readers,
+                          size_t num_geoms,
+                          const GeomVertexDataPipelineReader *data_reader,
+                          bool force);
 
 #ifndef OPENGLES_1
   void issue_memory_barrier(GLbitfield barrier);
@@ -360,6 +364,12 @@ public:
   bool setup_array_data(const unsigned char *&client_pointer,
                         const GeomVertexArrayDataHandle *data,
                         bool force);
+#ifndef OPENGLES
+  CLP(StreamBuffer) *get_stream_buffer();
+  bool stream_array_data(GLintptr &offset,
+                         const GeomVertexArrayDataHandle *data,
+                         bool force);
+#endif
 
   virtual IndexBufferContext *prepare_index_buffer(GeomPrimitive *data);
   bool apply_index_buffer(IndexBufferContext *ibc,
@@ -370,6 +380,14 @@ public:
   bool setup_primitive(const unsigned char *&client_pointer,
                        const GeomPrimitivePipelineReader *reader,
                        bool force);
+#ifndef OPENGLES
+  bool draw_multi_indirect(GLenum mode,
+                           const GeomPrimitivePipelineReader *reader,
+                           const unsigned char *client_pointer,
+                           const CPTA_int &ends, int gap,
+                           PStatCollector &vertices_pcollector);
+  const void *write_indirect_commands(const pvector<GLuint> &commands);
+#endif
 
 #ifndef OPENGLES
   virtual BufferContext *prepare_shader_buffer(ShaderBuffer *data);
@@ -818,6 +836,7 @@ public:
   bool _supports_bgra_read;
   bool _supports_packed_dabc;
   bool _supports_packed_ufloat;
+  bool _supports_vertex_half_float;
 
 #ifdef SUPPORT_FIXED_FUNCTION
   bool _supports_rescale_normal;
@@ -894,6 +913,28 @@ public:
   PFNGLDRAWELEMENTSINDIRECTPROC _glDrawElementsIndirect;
 #endif
 
+#ifndef OPENGLES
+  bool _supports_multi_draw_indirect;
+  PFNGLMULTIDRAWARRAYSINDIRECTPROC _glMultiDrawArraysIndirect;
+  PFNGLMULTIDRAWELEMENTSINDIRECTPROC _glMultiDrawElementsIndirect;
+
+  // Streaming buffer holding the indirect commands when the stream buffer
+  // is not available.
+  GLuint _indirect_buffer;
+  GLsizeiptr _indirect_buffer_size;
+  GLintptr _indirect_buffer_offset;
+  pvector<GLuint> _indirect_commands;
+
+  bool _supports_sync;
+  PFNGLFENCESYNCPROC _glFenceSync;
+  PFNGLDELETESYNCPROC _glDeleteSync;
+  PFNGLCLIENTWAITSYNCPROC _glClientWaitSync;
+
+  // Ring buffer holding the vertex arrays copied by stream_array_data(), and
+  // the index data and commands of the multi-draw indirect calls.
+  CLP(StreamBuffer) *_vertex_stream_buffer;
+#endif
+
   bool _supports_framebuffer_object;
   PFNGLISRENDERBUFFEREXTPROC _glIsRenderbuffer;
   PFNGLBINDRENDERBUFFEREXTPROC _glBindRenderbuffer;
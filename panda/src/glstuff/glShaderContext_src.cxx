@@ -487,6 +487,9 @@ reflect_attribute(int i, char *name_buffer, GLsizei name_buflen) {
       bind._name = InternalName::get_texcoord();
       bind._append_uv = atoi(noprefix.substr(13).c_str());
 
+    } else if (noprefix == "InstanceMatrix") {
+      bind._name = InternalName::get_instance_matrix();
+
     } else {
       GLCAT.error() << "Unrecognized vertex attrib '" << name_buffer << "'!\n";
       return;
@@ -2248,22 +2251,14 @@ void CLP(ShaderContext)::
 update_transform_table(const TransformTable *table) {
   LMatrix4f *matrices = (LMatrix4f *)alloca(_transform_table_size * 64);
 
-  size_t i = 0;
   if (table != nullptr) {
-    size_t num_transforms = min((size_t)_transform_table_size, table->get_num_transforms());
-    for (; i < num_transforms; ++i) {
-#ifdef STDFLOAT_DOUBLE
-      LMatrix4 matrix;
-      table->get_transform(i)->get_matrix(matrix);
-      matrices[i] = LCAST(float, matrix);
-#else
-      table->get_transform(i)->get_matrix(matrices[i]);
-#endif
+    table->get_matrices(matrices, _transform_table_size,
+                        Thread::get_current_thread());
+  } else {
+    for (size_t i = 0; i < (size_t)_transform_table_size; ++i) {
+      matrices[i] = LMatrix4f::ident_mat();
     }
   }
-  for (; i < (size_t)_transform_table_size; ++i) {
-    matrices[i] = LMatrix4f::ident_mat();
-  }
 
   _glgsg->_glUniformMatrix4fv(_transform_table_index, _transform_table_size,
                               GL_FALSE, (float *)matrices);
@@ -2332,6 +2327,24 @@ update_shader_vertex_arrays(ShaderContext *prev, bool force) {
     for (size_t ai = 0; ai < data_reader->get_num_arrays(); ++ai) {
       array_reader = data_reader->get_array_reader(ai);
 
+      GLintptr stride = array_reader->get_array_format()->get_stride();
+      if (ai >= _glgsg->_current_vertex_buffers.size()) {
+        GLuint zero = 0;
+        _glgsg->_current_vertex_buffers.resize(ai + 1, zero);
+      }
+
+#ifndef OPENGLES
+      GLintptr offset;
+      if (_glgsg->stream_array_data(offset, array_reader, force)) {
+        // The array was copied into the stream buffer.  The offset changes
+        // every time, so we don't record the binding.
+        _glgsg->_glBindVertexBuffer(ai, _glgsg->_vertex_stream_buffer->get_index(),
+                                    offset, stride);
+        _glgsg->_current_vertex_buffers[ai] = 0;
+        continue;
+      }
+#endif
+
       // Make sure the vertex buffer is up-to-date.
       CLP(VertexBufferContext) *gvbc = DCAST(CLP(VertexBufferContext),
         array_reader->prepare_now(_glgsg->get_prepared_objects(), _glgsg));
@@ -2341,13 +2354,7 @@ update_shader_vertex_arrays(ShaderContext *prev, bool force) {
         return false;
       }
 
-      GLintptr stride = array_reader->get_array_format()->get_stride();
-
       // Bind the vertex buffer to the binding index.
-      if (ai >= _glgsg->_current_vertex_buffers.size()) {
-        GLuint zero = 0;
-        _glgsg->_current_vertex_buffers.resize(ai + 1, zero);
-      }
       if (_glgsg->_current_vertex_buffers[ai] != gvbc->_index) {
         _glgsg->_glBindVertexBuffer(ai, gvbc->_index, 0, stride);
         _glgsg->_current_vertex_buffers[ai] = gvbc->_index;
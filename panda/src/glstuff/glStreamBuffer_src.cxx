@@ -0,0 +1,214 @@
+/**
+ * PANDA 3D SOFTWARE
+ * Copyright (c) Carnegie Mellon University.  All rights reserved.
+ *
+ * All use of this software is subject to the terms of the revised BSD
+ * license.  You should have received a copy of this license along
+ * with this source code in a file named "LICENSE."
+ *
+ * @file glStreamBuffer_src.cxx
+ * @author blablabla94
+ * @date 2026-10-16
+ */
+
+#ifndef OPENGLES
+
+/**
+ * Creates and maps a buffer object of the indicated size.  Check is_valid()
+ * afterwards to find out whether this succeeded.  The GSG must be current.
+ */
+CLP(StreamBuffer)::
+CLP(StreamBuffer)(CLP(GraphicsStateGuardian) *glgsg, GLenum target,
+                  size_t size) :
+  _glgsg(glgsg),
+  _target(target),
+  _index(0),
+  _mapped(nullptr),
+  _section_size(size / num_sections / max_alignment * max_alignment),
+  _section(0),
+  _head(0),
+  _section_end(_section_size),
+  _fence_pending(false)
+{
+  for (int i = 0; i < num_sections; ++i) {
+    _fences[i] = 0;
+    _needs_fence[i] = false;
+  }
+
+  nassertv(_glgsg->_supports_buffer_storage && _glgsg->_supports_sync);
+  size = _section_size * num_sections;
+
+  GLbitfield flags = GL_MAP_WRITE_BIT | GL_MAP_PERSISTENT_BIT | GL_MAP_COHERENT_BIT;
+  _glgsg->_glGenBuffers(1, &_index);
+  _glgsg->_glBindBuffer(_target, _index);
+  _glgsg->_glBufferStorage(_target, size, nullptr, flags);
+  _mapped = (unsigned char *)_glgsg->_glMapBufferRange(_target, 0, size, flags);
+  _glgsg->_glBindBuffer(_target, 0);
+
+  if (_mapped == nullptr) {
+    GLCAT.warning()
+      << "Failed to map stream buffer of " << size << " bytes.\n";
+  } else if (GLCAT.is_debug()) {
+    GLCAT.debug()
+      << "Created stream buffer " << _index << " of " << size << " bytes\n";
+  }
+  _glgsg->report_my_gl_errors();
+}
+
+/**
+ * The GL objects are not released here, since the context may no longer be
+ * current; call release() first if it still is.
+ */
+CLP(StreamBuffer)::
+~CLP(StreamBuffer)() {
+}
+
+/**
+ * Unmaps and deletes the buffer object, and deletes any outstanding fences.
+ * The GSG must be current.  The stream buffer may not be used afterwards.
+ */
+void CLP(StreamBuffer)::
+release() {
+  for (int i = 0; i < num_sections; ++i) {
+    if (_fences[i] != 0) {
+      _glgsg->_glDeleteSync(_fences[i]);
+      _fences[i] = 0;
+    }
+    _needs_fence[i] = false;
+  }
+  _fence_pending = false;
+
+  if (_index != 0) {
+    if (_mapped != nullptr) {
+      _glgsg->_glBindBuffer(_target, _index);
+      _glgsg->_glUnmapBuffer(_target);
+      _glgsg->_glBindBuffer(_target, 0);
+      _mapped = nullptr;
+    }
+    _glgsg->_glDeleteBuffers(1, &_index);
+    _index = 0;
+  }
+  _written.clear();
+  _glgsg->report_my_gl_errors();
+}
+
+/**
+ * Returns the offset at which the data with the indicated key was written, if
+ * it is still available for drawing, or -1 if it must be written again.
+ */
+GLintptr CLP(StreamBuffer)::
+find(UpdateSeq key) const {
+  Written::const_iterator wi = _written.find(key);
+  if (wi != _written.end()) {
+    return (*wi).second;
+  }
+  return -1;
+}
+
+/**
+ * Copies the indicated data into the next free region of the buffer, and
+ * returns the offset of that region, which will be a multiple of alignment.
+ * The offset is recorded under the given key, for future calls to find().
+ *
+ * Returns -1 if the data is too large to fit in a single section.
+ */
+GLintptr CLP(StreamBuffer)::
+write(UpdateSeq key, const void *data, size_t size, size_t alignment) {
+  GLintptr offset = write(data, size, alignment);
+  if (offset >= 0) {
+    _written[key] = offset;
+  }
+  return offset;
+}
+
+/**
+ * Copies the indicated data into the next free region of the buffer, and
+ * returns the offset of that region, which will be a multiple of alignment.
+ * The data may be used by draw calls issued until the buffer wraps around,
+ * which is at least until the rest of the current section has been filled.
+ *
+ * Returns -1 if the data is too large to fit in a single section.  The
+ * alignment may not exceed 256 bytes.
+ */
+GLintptr CLP(StreamBuffer)::
+write(const void *data, size_t size, size_t alignment) {
+  nassertr(_mapped != nullptr, -1);
+  nassertr(alignment > 0 && alignment <= max_alignment, -1);
+  if (size > _section_size) {
+    return -1;
+  }
+
+  size_t offset = (_head + alignment - 1) / alignment * alignment;
+  if (offset + size > _section_end) {
+    next_section();
+    offset = (_head + alignment - 1) / alignment * alignment;
+  }
+
+  memcpy(_mapped + offset, data, size);
+  _head = offset + size;
+  return (GLintptr)offset;
+}
+
+/**
+ * Inserts a fence for each of the sections that were filled since the last
+ * call.  Called by fence().
+ */
+void CLP(StreamBuffer)::
+do_fence() {
+  for (int i = 0; i < num_sections; ++i) {
+    if (_needs_fence[i]) {
+      nassertd(_fences[i] == 0) {
+        _glgsg->_glDeleteSync(_fences[i]);
+      }
+      _fences[i] = _glgsg->_glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+      _needs_fence[i] = false;
+    }
+  }
+  _fence_pending = false;
+}
+
+/**
+ * Moves on to the next section, waiting for the GPU to finish reading from it
+ * if necessary.  The section that was just filled will be fenced off by the
+ * next call to fence().
+ */
+void CLP(StreamBuffer)::
+next_section() {
+  _needs_fence[_section] = true;
+  _fence_pending = true;
+  _written.clear();
+
+  _section = (_section + 1) % num_sections;
+  if (_needs_fence[_section]) {
+    // We have gone around the whole buffer without a call to fence(), which
+    // means a single draw call needs more data than fits in the buffer.
+    GLCAT.warning()
+      << "Stream buffer overflowed; increase gl-stream-buffer-size\n";
+    do_fence();
+  }
+
+  GLsync fence = _fences[_section];
+  if (fence != 0) {
+    GLenum result = _glgsg->_glClientWaitSync(fence, 0, 0);
+    if (result == GL_TIMEOUT_EXPIRED) {
+      // We caught up with the GPU.  This means the buffer is too small for
+      // the amount of data being streamed; we have no choice but to wait.
+      if (GLCAT.is_debug()) {
+        GLCAT.debug()
+          << "Waiting for GPU to release stream buffer section; consider "
+             "increasing gl-stream-buffer-size\n";
+      }
+      do {
+        result = _glgsg->_glClientWaitSync(fence, GL_SYNC_FLUSH_COMMANDS_BIT,
+                                           1000000);
+      } while (result == GL_TIMEOUT_EXPIRED);
+    }
+    _glgsg->_glDeleteSync(fence);
+    _fences[_section] = 0;
+  }
+
+  _head = _section * _section_size;
+  _section_end = _head + _section_size;
+}
+
+#endif  // !OPENGLES
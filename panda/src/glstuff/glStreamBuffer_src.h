@@ -0,0 +1,94 @@
+/**
+ * PANDA 3D SOFTWARE
+ * Copyright (c) Carnegie Mellon University.  All rights reserved.
+ *
+ * All use of this software is subject to the terms of the revised BSD
+ * license.  You should have received a copy of this license along
+ * with this source code in a file named "LICENSE."
+ *
+ * @file glStreamBuffer_src.h
+ * @author blablabla94
+ * @date 2026-10-16
+ */
+
+#ifndef OPENGLES
+
+#include "pandabase.h"
+#include "updateSeq.h"
+#include "pmap.h"
+
+class CLP(GraphicsStateGuardian);
+
+/**
+ * A persistently mapped buffer object that is used as a ring buffer for
+ * uploading vertex data that changes every frame, such as the vertices of
+ * particles or of CPU-animated characters, as well as the index data and
+ * commands for multi-draw indirect calls.  Rather than respecifying the
+ * contents of a dedicated buffer object for each array, which may cause the
+ * driver to stall or reallocate, the data is copied into the next free region
+ * of this buffer, and the array is rendered from there.
+ *
+ * The buffer is divided into a number of sections.  When writing moves on to
+ * the next section, we wait for the fence that was inserted after the
+ * commands that used that section the last time it was filled, and the
+ * section that was just filled is fenced off as soon as the pending draw call
+ * has been issued; see fence().  This means that, as long as each section is
+ * large enough to hold about a frame's worth of data, we never have to wait
+ * for the GPU.
+ *
+ * Writes may be keyed by the modification stamp of the data, so that data
+ * that is drawn several times without changing only needs to be copied once.
+ *
+ * This requires ARB_buffer_storage and ARB_sync.  It does not release its GL
+ * objects when it is destructed, since that may happen when the context is
+ * no longer current; call release() beforehand while it still is.  Otherwise,
+ * like other GL objects, they go away with the context.
+ */
+class EXPCL_GL CLP(StreamBuffer) {
+public:
+  CLP(StreamBuffer)(CLP(GraphicsStateGuardian) *glgsg, GLenum target,
+                    size_t size);
+  CLP(StreamBuffer)(const CLP(StreamBuffer) &copy) = delete;
+  ~CLP(StreamBuffer)();
+
+  void release();
+
+  INLINE bool is_valid() const;
+  INLINE GLuint get_index() const;
+  INLINE size_t get_section_size() const;
+  INLINE void fence();
+
+  GLintptr find(UpdateSeq key) const;
+  GLintptr write(UpdateSeq key, const void *data, size_t size,
+                 size_t alignment);
+  GLintptr write(const void *data, size_t size, size_t alignment);
+
+private:
+  void do_fence();
+  void next_section();
+
+  // Each section starts at a multiple of max_alignment, which is the largest
+  // alignment that may be passed to write().
+  enum { num_sections = 3, max_alignment = 256 };
+
+  CLP(GraphicsStateGuardian) *_glgsg;
+  GLenum _target;
+  GLuint _index;
+  unsigned char *_mapped;
+  size_t _section_size;
+  int _section;
+  size_t _head;
+  size_t _section_end;
+  GLsync _fences[num_sections];
+  bool _needs_fence[num_sections];
+  bool _fence_pending;
+
+  // The offsets of the data written since we last moved to a new section,
+  // keyed by the modification stamp of the data.
+  typedef pmap<UpdateSeq, GLintptr> Written;
+  Written _written;
+};
+
+#include "glStreamBuffer_src.I"
+
+#endif  // !OPENGLES
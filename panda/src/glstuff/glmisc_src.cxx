@@ -291,6 +291,27 @@ ConfigVariableBool gl_support_primitive_restart_index
             "segment primitives.  Set to false if you suspect a bug "
             "in the driver implementation."));
 
+ConfigVariableBool gl_multi_draw_indirect
+  ("gl-multi-draw-indirect", true,
+   PRC_DESC("Setting this causes Panda to make use of multi-draw indirect "
+            "to render all of the strips or fans of a primitive that can't "
+            "be connected with a primitive restart index using a single "
+            "draw call.  It is also used to render a run of objects in a "
+            "state-sorted bin that share the same state, transform and "
+            "vertex data with a single draw call.  Set to false if you "
+            "suspect a bug in the driver implementation."));
+
+ConfigVariableInt gl_stream_buffer_size
+  ("gl-stream-buffer-size", 4 * 1024 * 1024,
+   PRC_DESC("This is the size in bytes of the persistently mapped buffer "
+            "that vertex arrays with the \"stream\" usage hint are copied "
+            "into, instead of each being loaded into a buffer object of "
+            "its own.  The commands and index data for multi-draw indirect "
+            "calls are also written to this buffer.  It should be large "
+            "enough to hold several frames worth of streamed data.  Set "
+            "this to 0 to disable the stream buffer.  This requires "
+            "OpenGL 4.4 or GL_ARB_buffer_storage."));
+
 ConfigVariableBool gl_support_sampler_objects
   ("gl-support-sampler-objects", true,
    PRC_DESC("Setting this allows Panda to make use of sampler "
@@ -79,6 +79,8 @@ extern ConfigVariableBool gl_enable_memory_barriers;
 extern ConfigVariableBool gl_vertex_array_objects;
 extern ConfigVariableBool gl_fixed_vertex_attrib_locations;
 extern ConfigVariableBool gl_support_primitive_restart_index;
+extern ConfigVariableBool gl_multi_draw_indirect;
+extern ConfigVariableInt gl_stream_buffer_size;
 extern ConfigVariableBool gl_support_sampler_objects;
 extern ConfigVariableBool gl_support_shadow_filter;
 extern ConfigVariableBool gl_force_image_bindings_writeonly;
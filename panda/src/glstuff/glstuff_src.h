@@ -34,6 +34,7 @@
 #include "glVertexBufferContext_src.h"
 #include "glIndexBufferContext_src.h"
 #include "glBufferContext_src.h"
+#include "glStreamBuffer_src.h"
 #include "glOcclusionQueryContext_src.h"
 #include "glTimerQueryContext_src.h"
 #include "glLatencyQueryContext_src.h"
@@ -358,6 +358,23 @@ ConfigVariableInt geom_cache_size
           "temporarily exceeded if many different Geoms are "
           "pre-processed during the space of a single frame."));
 
+ConfigVariableInt64 geom_cache_max_bytes
+("geom-cache-max-bytes", 256 * 1024 * 1024,
+ PRC_DESC("Specifies the maximum number of bytes of munged vertex data "
+          "that may be held in the geom cache, counting only data that "
+          "the munger actually had to create rather than data that is "
+          "shared with the original Geom.  Like geom-cache-size, this "
+          "limit is flexible.  Set this to 0 to limit the cache by "
+          "geom-cache-size alone."));
+
+ConfigVariableInt geom_cache_thread_slots
+("geom-cache-thread-slots", 256,
+ PRC_DESC("Specifies the number of slots in the small per-thread cache of "
+          "recent munge results that is consulted before the shared geom "
+          "cache, so that Geoms rendered every frame can be munged "
+          "without taking any shared lock.  Set this to 0 to disable "
+          "the per-thread cache."));
+
 ConfigVariableInt geom_cache_min_frames
 ("geom-cache-min-frames", 1,
  PRC_DESC("Specifies the minimum number of frames any one particular "
@@ -447,6 +464,40 @@ ConfigVariableInt vertex_data_page_threads
           "is 0, this work will be done in the main thread, which may "
           "introduce occasional random chugs in rendering."));
 
+ConfigVariableInt bam_vertex_data_alignment
+("bam-vertex-data-alignment", 0,
+ PRC_DESC("When this is nonzero, vertex arrays written to a bam file are "
+          "stored outside of the object records, each aligned to a multiple "
+          "of this many bytes within the file, so that they may be mapped "
+          "directly into memory when the file is loaded.  This requires "
+          "bam-version 6.46 or later; it should be a multiple of the "
+          "memory alignment Panda uses for vertex buffers, such as 4096."));
+
+ConfigVariableBool bam_map_vertex_data
+("bam-map-vertex-data", true,
+ PRC_DESC("Set this true to map the vertex arrays of a bam file written "
+          "with bam-vertex-data-alignment directly from the file on disk, "
+          "rather than copying them into memory.  The arrays are still "
+          "copied if they are modified, or if the file is compressed.  "
+          "A mapped file must not be modified in place while models loaded "
+          "from it are in use; replace it with a new file instead."));
+
+ConfigVariableInt animation_threads
+("animation-threads", 0,
+ PRC_DESC("Set this to a number greater than zero to split the CPU skinning "
+          "of large animated vertex tables across that many additional "
+          "worker threads.  This has no effect on builds without true "
+          "threading support, or when the animation is performed on the "
+          "graphics card."));
+
+ConfigVariableInt animation_parallel_min_rows
+("animation-parallel-min-rows", 4096,
+ PRC_DESC("When animation-threads is nonzero, this is the minimum number of "
+          "animated vertices a table must have before its skinning is split "
+          "across the worker threads.  Smaller tables are skinned on the "
+          "calling thread, since the cost of handing them off would outweigh "
+          "the benefit."));
+
 ConfigVariableInt graphics_memory_limit
 ("graphics-memory-limit", -1,
  PRC_DESC("This is a default limit that is imposed on each GSG at "
@@ -18,6 +18,7 @@
 #include "notifyCategoryProxy.h"
 #include "configVariableBool.h"
 #include "configVariableInt.h"
+#include "configVariableInt64.h"
 #include "configVariableEnum.h"
 #include "configVariableDouble.h"
 #include "configVariableFilename.h"
@@ -63,6 +64,8 @@ extern EXPCL_PANDA_GOBJ ConfigVariableInt simple_image_size;
 extern EXPCL_PANDA_GOBJ ConfigVariableDouble simple_image_threshold;
 
 extern EXPCL_PANDA_GOBJ ConfigVariableInt geom_cache_size;
+extern EXPCL_PANDA_GOBJ ConfigVariableInt64 geom_cache_max_bytes;
+extern EXPCL_PANDA_GOBJ ConfigVariableInt geom_cache_thread_slots;
 extern EXPCL_PANDA_GOBJ ConfigVariableInt geom_cache_min_frames;
 extern EXPCL_PANDA_GOBJ ConfigVariableInt released_vbuffer_cache_size;
 extern EXPCL_PANDA_GOBJ ConfigVariableInt released_ibuffer_cache_size;
@@ -79,6 +82,10 @@ extern EXPCL_PANDA_GOBJ ConfigVariableFilename vertex_save_file_directory;
 extern EXPCL_PANDA_GOBJ ConfigVariableString vertex_save_file_prefix;
 extern EXPCL_PANDA_GOBJ ConfigVariableInt vertex_data_small_size;
 extern EXPCL_PANDA_GOBJ ConfigVariableInt vertex_data_page_threads;
+extern EXPCL_PANDA_GOBJ ConfigVariableInt bam_vertex_data_alignment;
+extern EXPCL_PANDA_GOBJ ConfigVariableBool bam_map_vertex_data;
+extern EXPCL_PANDA_GOBJ ConfigVariableInt animation_threads;
+extern EXPCL_PANDA_GOBJ ConfigVariableInt animation_parallel_min_rows;
 extern EXPCL_PANDA_GOBJ ConfigVariableInt graphics_memory_limit;
 extern EXPCL_PANDA_GOBJ ConfigVariableInt sampler_object_limit;
 extern EXPCL_PANDA_GOBJ ConfigVariableDouble adaptive_lru_weight;
@@ -927,6 +927,120 @@ make_adjacency_in_place() {
   nassertv(all_is_valid);
 }
 
+/**
+ * Reorders the triangles of all of the primitives within this Geom for the
+ * post-transform vertex cache, leaving the results in place.  See
+ * GeomPrimitive::optimize_vertex_cache().
+ *
+ * Don't call this in a downstream thread unless you don't mind it blowing
+ * away other changes you might have recently made in an upstream thread.
+ */
+void Geom::
+optimize_vertex_cache_in_place(int cache_size) {
+  Thread *current_thread = Thread::get_current_thread();
+  CDWriter cdata(_cycler, true, current_thread);
+
+  Primitives::iterator pi;
+  for (pi = cdata->_primitives.begin(); pi != cdata->_primitives.end(); ++pi) {
+    CPT(GeomPrimitive) new_prim = (*pi).get_read_pointer(current_thread)->optimize_vertex_cache(cache_size);
+    (*pi) = (GeomPrimitive *)new_prim.p();
+  }
+
+  cdata->_modified = Geom::get_next_modified();
+  clear_cache_stage(current_thread);
+}
+
+/**
+ * Reorders the triangles of all of the primitives within this Geom to reduce
+ * overdraw, leaving the results in place.  See
+ * GeomPrimitive::optimize_overdraw().
+ *
+ * Don't call this in a downstream thread unless you don't mind it blowing
+ * away other changes you might have recently made in an upstream thread.
+ */
+void Geom::
+optimize_overdraw_in_place(PN_stdfloat threshold, int cache_size) {
+  Thread *current_thread = Thread::get_current_thread();
+  CDWriter cdata(_cycler, true, current_thread);
+  CPT(GeomVertexData) data = cdata->_data.get_read_pointer(current_thread);
+
+  Primitives::iterator pi;
+  for (pi = cdata->_primitives.begin(); pi != cdata->_primitives.end(); ++pi) {
+    CPT(GeomPrimitive) new_prim = (*pi).get_read_pointer(current_thread)->optimize_overdraw(data, threshold, cache_size);
+    (*pi) = (GeomPrimitive *)new_prim.p();
+  }
+
+  cdata->_modified = Geom::get_next_modified();
+  clear_cache_stage(current_thread);
+}
+
+/**
+ * Reorders the rows of the vertex data so that they appear in the order in
+ * which the primitives first reference them, and drops the rows that are not
+ * referenced at all, leaving the results in place.  This improves the
+ * locality of the vertex fetches; it should be done after the triangles have
+ * been reordered with optimize_vertex_cache() or optimize_overdraw().
+ *
+ * The Geom receives its own copy of the vertex data.  Use the static
+ * optimize_vertex_fetch() to reorder vertex data that is shared between
+ * several Geoms.
+ */
+void Geom::
+optimize_vertex_fetch_in_place() {
+  pvector<PT(Geom)> geoms(1, this);
+  optimize_vertex_fetch(geoms);
+}
+
+/**
+ * Reduces each triangle primitive within this Geom to approximately
+ * target_ratio times as many triangles, leaving the results in place.  See
+ * GeomPrimitive::simplify().
+ *
+ * Don't call this in a downstream thread unless you don't mind it blowing
+ * away other changes you might have recently made in an upstream thread.
+ */
+void Geom::
+simplify_in_place(PN_stdfloat target_ratio) {
+  Thread *current_thread = Thread::get_current_thread();
+  CDWriter cdata(_cycler, true, current_thread);
+  CPT(GeomVertexData) data = cdata->_data.get_read_pointer(current_thread);
+
+  Primitives::iterator pi;
+  for (pi = cdata->_primitives.begin(); pi != cdata->_primitives.end(); ++pi) {
+    CPT(GeomPrimitive) new_prim = (*pi).get_read_pointer(current_thread)->simplify(data, target_ratio);
+    (*pi) = (GeomPrimitive *)new_prim.p();
+  }
+
+  cdata->_modified = Geom::get_next_modified();
+  reset_geom_rendering(cdata);
+  clear_cache_stage(current_thread);
+  mark_internal_bounds_stale(cdata);
+}
+
+/**
+ * Returns the average cache miss ratio over all of the triangles in this
+ * Geom, or 0 if it has no triangles.  See GeomPrimitive::calc_acmr().
+ */
+PN_stdfloat Geom::
+calc_acmr(int cache_size) const {
+  Thread *current_thread = Thread::get_current_thread();
+  CDReader cdata(_cycler, current_thread);
+
+  PN_stdfloat misses = 0;
+  int num_faces = 0;
+  Primitives::const_iterator pi;
+  for (pi = cdata->_primitives.begin(); pi != cdata->_primitives.end(); ++pi) {
+    CPT(GeomPrimitive) prim = (*pi).get_read_pointer(current_thread);
+    if (prim->get_primitive_type() == PT_polygons) {
+      int prim_faces = prim->get_num_faces();
+      misses += prim->calc_acmr(cache_size) * prim_faces;
+      num_faces += prim_faces;
+    }
+  }
+
+  return (num_faces != 0) ? misses / num_faces : 0;
+}
+
 /**
  * Copies the primitives from the indicated Geom into this one.  This does
  * require that both Geoms contain the same fundamental type primitives, both
@@ -1019,6 +1133,37 @@ request_resident() const {
   return resident;
 }
 
+/**
+ * Asks for all of the data needed to render this Geom, including its
+ * GeomVertexData, to be brought back into memory in the background, at a
+ * lower priority than data requested with request_resident().  Call this for
+ * Geoms that are expected to come into view soon.  Returns true if the data
+ * is already resident.
+ */
+bool Geom::
+request_prefetch() const {
+  Thread *current_thread = Thread::get_current_thread();
+
+  CDReader cdata(_cycler, current_thread);
+
+  bool resident = true;
+
+  Primitives::const_iterator pi;
+  for (pi = cdata->_primitives.begin();
+       pi != cdata->_primitives.end();
+       ++pi) {
+    if (!(*pi).get_read_pointer(current_thread)->request_prefetch(current_thread)) {
+      resident = false;
+    }
+  }
+
+  if (!cdata->_data.get_read_pointer(current_thread)->request_prefetch()) {
+    resident = false;
+  }
+
+  return resident;
+}
+
 /**
  * Applies the indicated transform to all of the vertices in the Geom.  If the
  * Geom happens to share a vertex table with another Geom, this operation will
@@ -1326,6 +1471,93 @@ get_next_modified() {
   return _next_modified;
 }
 
+/**
+ * Reorders the rows of the GeomVertexData shared by all of the indicated
+ * Geoms into the order of first reference by their primitives, dropping any
+ * rows that none of them reference, and reindexes the primitives to match.
+ * All of the Geoms must reference the same GeomVertexData, and should be all
+ * of the Geoms that do, or the others will be left holding the old data.
+ *
+ * Returns true if the vertex data was changed, false if it was already in
+ * order.
+ */
+bool Geom::
+optimize_vertex_fetch(const pvector<PT(Geom)> &geoms, Thread *current_thread) {
+  if (geoms.empty()) {
+    return false;
+  }
+
+  CPT(GeomVertexData) orig_data = geoms[0]->get_vertex_data(current_thread);
+  int num_rows = orig_data->get_num_rows();
+
+  // Number the rows in the order that the primitives use them.
+  pvector<int> remap(num_rows, -1);
+  pvector<int> old_rows;
+  old_rows.reserve(num_rows);
+
+  pvector<PT(Geom)>::const_iterator gi;
+  for (gi = geoms.begin(); gi != geoms.end(); ++gi) {
+    CDReader cdata((*gi)->_cycler, current_thread);
+    nassertr(cdata->_data.get_read_pointer(current_thread) == orig_data, false);
+
+    Primitives::const_iterator pi;
+    for (pi = cdata->_primitives.begin(); pi != cdata->_primitives.end(); ++pi) {
+      GeomPrimitivePipelineReader reader((*pi).get_read_pointer(current_thread), current_thread);
+      int num_vertices = reader.get_num_vertices();
+      int strip_cut_index = reader.get_strip_cut_index();
+      for (int i = 0; i < num_vertices; ++i) {
+        int v = reader.get_vertex(i);
+        if (v == strip_cut_index) {
+          continue;
+        }
+        nassertr(v >= 0 && v < num_rows, false);
+        if (remap[v] < 0) {
+          remap[v] = (int)old_rows.size();
+          old_rows.push_back(v);
+        }
+      }
+    }
+  }
+
+  bool in_order = ((int)old_rows.size() == num_rows);
+  for (int i = 0; in_order && i < (int)old_rows.size(); ++i) {
+    in_order = (old_rows[i] == i);
+  }
+  if (in_order) {
+    return false;
+  }
+
+  PT(GeomVertexData) new_data = orig_data->reorder_rows(old_rows, current_thread);
+
+  for (gi = geoms.begin(); gi != geoms.end(); ++gi) {
+    Geom *geom = (*gi);
+    CDWriter cdata(geom->_cycler, true, current_thread);
+    cdata->_data = new_data.p();
+
+    Primitives::iterator pi;
+    for (pi = cdata->_primitives.begin(); pi != cdata->_primitives.end(); ++pi) {
+      PT(GeomPrimitive) prim = (*pi).get_write_pointer();
+      prim->make_indexed();
+      int strip_cut_index = prim->get_strip_cut_index();
+
+      GeomVertexRewriter index(prim->modify_vertices(), 0, current_thread);
+      while (!index.is_at_end()) {
+        int v = index.get_data1i();
+        if (v != strip_cut_index) {
+          index.set_data1i(remap[v]);
+        } else {
+          index.set_data1i(v);
+        }
+      }
+    }
+
+    cdata->_modified = Geom::get_next_modified();
+    geom->clear_cache_stage(current_thread);
+  }
+
+  return true;
+}
+
 /**
  * Recomputes the dynamic bounding volume for this Geom.  This includes all of
  * the vertices.
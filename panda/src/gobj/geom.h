@@ -109,6 +109,11 @@ PUBLISHED:
   INLINE PT(Geom) make_lines() const;
   INLINE PT(Geom) make_patches() const;
   INLINE PT(Geom) make_adjacency() const;
+  INLINE PT(Geom) optimize_vertex_cache(int cache_size = 32) const;
+  INLINE PT(Geom) optimize_overdraw(PN_stdfloat threshold = 1.05f,
+                                    int cache_size = 32) const;
+  INLINE PT(Geom) optimize_vertex_fetch() const;
+  INLINE PT(Geom) simplify(PN_stdfloat target_ratio) const;
 
   void decompose_in_place();
   void doubleside_in_place();
@@ -119,6 +124,13 @@ PUBLISHED:
   void make_lines_in_place();
   void make_patches_in_place();
   void make_adjacency_in_place();
+  void optimize_vertex_cache_in_place(int cache_size = 32);
+  void optimize_overdraw_in_place(PN_stdfloat threshold = 1.05f,
+                                  int cache_size = 32);
+  void optimize_vertex_fetch_in_place();
+  void simplify_in_place(PN_stdfloat target_ratio);
+
+  PN_stdfloat calc_acmr(int cache_size = 32) const;
 
   virtual bool copy_primitives_from(const Geom *other);
 
@@ -128,6 +140,7 @@ PUBLISHED:
   MAKE_PROPERTY(modified, get_modified);
 
   bool request_resident() const;
+  bool request_prefetch() const;
 
   void transform_vertices(const LMatrix4 &mat);
   bool check_valid() const;
@@ -177,6 +190,9 @@ public:
 
   static UpdateSeq get_next_modified();
 
+  static bool optimize_vertex_fetch(const pvector<PT(Geom)> &geoms,
+                                    Thread *current_thread = Thread::get_current_thread());
+
 private:
   class CData;
 
@@ -45,9 +45,11 @@ record(Thread *current_thread) {
 
   insert_before(cache_mgr->_list);
   ++cache_mgr->_total_size;
+  cache_mgr->_total_bytes += _num_bytes;
   cache_mgr->_geom_cache_size_pcollector.set_level(cache_mgr->_total_size);
+  cache_mgr->_geom_cache_bytes_pcollector.set_level((double)cache_mgr->_total_bytes);
   cache_mgr->_geom_cache_record_pcollector.add_level(1);
-  _last_frame_used = ClockObject::get_global_clock()->get_frame_count(current_thread);
+  AtomicAdjust::set(_last_frame_used, ClockObject::get_global_clock()->get_frame_count(current_thread));
 
   if (PStatClient::is_connected()) {
     GeomCacheManager::_geom_cache_active_pcollector.add_level(1);
@@ -67,24 +69,40 @@ record(Thread *current_thread) {
 
 /**
  * Marks the cache entry recently used, so it will not be evicted for a while.
+ * Returns true if the entry is still in the cache, or false if it has since
+ * been evicted or erased (in which case its result should not be trusted to
+ * remain accounted for).
+ *
+ * An entry that has already been refreshed during the current frame is not
+ * moved again, and in that case the cache manager's lock is not taken at all;
+ * this keeps the common case of a Geom rendered many times per frame, or from
+ * several threads, free of contention.
  */
-void GeomCacheEntry::
+bool GeomCacheEntry::
 refresh(Thread *current_thread) {
+  int current_frame = ClockObject::get_global_clock()->get_frame_count(current_thread);
+  if (AtomicAdjust::get(_last_frame_used) == current_frame) {
+    return true;
+  }
+
   GeomCacheManager *cache_mgr = GeomCacheManager::get_global_ptr();
   LightMutexHolder holder(cache_mgr->_lock);
-  nassertv(_next != nullptr && _prev != nullptr);
+  if (_next == nullptr) {
+    // Someone evicted us in the meantime.
+    return false;
+  }
 
   remove_from_list();
   insert_before(cache_mgr->_list);
 
-  int current_frame = ClockObject::get_global_clock()->get_frame_count(current_thread);
   if (PStatClient::is_connected()) {
     if (_last_frame_used != current_frame) {
       GeomCacheManager::_geom_cache_active_pcollector.add_level(1);
     }
   }
 
-  _last_frame_used = current_frame;
+  AtomicAdjust::set(_last_frame_used, current_frame);
+  return true;
 }
 
 /**
@@ -108,7 +126,9 @@ erase() {
 
   remove_from_list();
   --cache_mgr->_total_size;
+  cache_mgr->_total_bytes -= _num_bytes;
   cache_mgr->_geom_cache_size_pcollector.set_level(cache_mgr->_total_size);
+  cache_mgr->_geom_cache_bytes_pcollector.set_level((double)cache_mgr->_total_bytes);
   cache_mgr->_geom_cache_erase_pcollector.add_level(1);
 
   if (PStatClient::is_connected()) {
@@ -117,10 +137,41 @@ erase() {
       GeomCacheManager::_geom_cache_active_pcollector.sub_level(1);
     }
   }
+  AtomicAdjust::set(_last_frame_used, -1);
 
   return this;
 }
 
+/**
+ * Specifies the number of bytes of memory held by the cached result, which is
+ * counted against geom-cache-max-bytes.  This should only count memory that
+ * is owned by the result alone, not anything it shares with its source.
+ *
+ * This is normally called once the result has been computed, after
+ * record().  If the cache is now over its byte limit, old entries are evicted
+ * (which may include this one).
+ */
+void GeomCacheEntry::
+set_num_bytes(size_t num_bytes) {
+  PT(GeomCacheEntry) keepme = this;
+
+  GeomCacheManager *cache_mgr = GeomCacheManager::get_global_ptr();
+  LightMutexHolder holder(cache_mgr->_lock);
+
+  if (_next == nullptr) {
+    // Not (or no longer) in the cache; nothing to account for.
+    _num_bytes = num_bytes;
+    return;
+  }
+
+  cache_mgr->_total_bytes -= _num_bytes;
+  cache_mgr->_total_bytes += num_bytes;
+  _num_bytes = num_bytes;
+  cache_mgr->_geom_cache_bytes_pcollector.set_level((double)cache_mgr->_total_bytes);
+
+  cache_mgr->evict_old_entries();
+}
+
 /**
  * Called when the entry is evicted from the cache, this should clean up the
  * owning object appropriately.
@@ -20,6 +20,7 @@
 #include "config_gobj.h"
 #include "pointerTo.h"
 #include "mutexHolder.h"
+#include "atomicAdjust.h"
 
 class Geom;
 class GeomPrimitive;
@@ -34,14 +35,21 @@ public:
   virtual ~GeomCacheEntry();
 
   PT(GeomCacheEntry) record(Thread *current_thread);
-  void refresh(Thread *current_thread);
+  bool refresh(Thread *current_thread);
   PT(GeomCacheEntry) erase();
 
+  INLINE size_t get_num_bytes() const;
+  void set_num_bytes(size_t num_bytes);
+
   virtual void evict_callback();
   virtual void output(std::ostream &out) const;
 
 private:
-  int _last_frame_used;
+  // This is read without holding the cache manager's lock, in refresh(), so
+  // it must be updated atomically.  It is -1 when the entry is not in the
+  // cache.
+  AtomicAdjust::Integer _last_frame_used;
+  size_t _num_bytes;
 
   INLINE void remove_from_list();
   INLINE void insert_before(GeomCacheEntry *node);
@@ -22,9 +22,12 @@ GeomCacheManager *GeomCacheManager::_global_ptr = nullptr;
 
 PStatCollector GeomCacheManager::_geom_cache_size_pcollector("Geom cache size");
 PStatCollector GeomCacheManager::_geom_cache_active_pcollector("Geom cache size:Active");
+PStatCollector GeomCacheManager::_geom_cache_bytes_pcollector("Geom cache memory");
 PStatCollector GeomCacheManager::_geom_cache_record_pcollector("Geom cache operations:record");
 PStatCollector GeomCacheManager::_geom_cache_erase_pcollector("Geom cache operations:erase");
 PStatCollector GeomCacheManager::_geom_cache_evict_pcollector("Geom cache operations:evict");
+PStatCollector GeomCacheManager::_geom_cache_hit_pcollector("Geom cache operations:hit");
+PStatCollector GeomCacheManager::_geom_cache_miss_pcollector("Geom cache operations:miss");
 
 /**
  *
@@ -32,7 +35,8 @@ PStatCollector GeomCacheManager::_geom_cache_evict_pcollector("Geom cache operat
 GeomCacheManager::
 GeomCacheManager() :
   _lock("GeomCacheManager"),
-  _total_size(0)
+  _total_size(0),
+  _total_bytes(0)
 {
   // We deliberately hang on to this pointer forever.
   _list = new GeomCacheEntry;
@@ -59,7 +63,7 @@ flush() {
   LightReMutexHolder registry_holder(GeomMunger::get_registry()->_registry_lock);
 
   LightMutexHolder holder(_lock);
-  evict_old_entries(0, false);
+  evict_old_entries(0, 0, false);
 }
 
 /**
@@ -74,16 +78,18 @@ get_global_ptr() {
 }
 
 /**
- * Trims the cache size down to the specified size by evicting old cache
- * entries as needed.  It is assumed that you already hold the lock before
+ * Trims the cache size down to the specified number of entries and bytes by
+ * evicting old cache entries as needed.  A max_bytes of 0 means not to limit
+ * the number of bytes.  It is assumed that you already hold the lock before
  * calling this method.
  */
 void GeomCacheManager::
-evict_old_entries(int max_size, bool keep_current) {
+evict_old_entries(int max_size, size_t max_bytes, bool keep_current) {
   int current_frame = ClockObject::get_global_clock()->get_frame_count();
   int min_frames = geom_cache_min_frames;
 
-  while (_total_size > max_size) {
+  while (_total_size > max_size ||
+         (max_bytes != 0 && _total_bytes > max_bytes)) {
     PT(GeomCacheEntry) entry = _list->_next;
     nassertv(entry != _list);
 
@@ -93,7 +99,8 @@ evict_old_entries(int max_size, bool keep_current) {
         gobj_cat.debug()
           << "Oldest element in cache is "
           << current_frame - entry->_last_frame_used
-          << " frames; keeping cache at " << _total_size << " entries.\n";
+          << " frames; keeping cache at " << _total_size << " entries, "
+          << _total_bytes << " bytes.\n";
       }
       break;
     }
@@ -102,8 +109,9 @@ evict_old_entries(int max_size, bool keep_current) {
 
     if (gobj_cat.is_debug()) {
       gobj_cat.debug()
-        << "cache total_size = " << _total_size << " entries, max_size = "
-        << max_size << ", removing " << *entry << "\n";
+        << "cache total_size = " << _total_size << " entries, "
+        << _total_bytes << " bytes, max_size = " << max_size
+        << ", max_bytes = " << max_bytes << ", removing " << *entry << "\n";
     }
 
     entry->evict_callback();
@@ -115,8 +123,27 @@ evict_old_entries(int max_size, bool keep_current) {
     }
 
     --_total_size;
+    _total_bytes -= entry->_num_bytes;
     entry->remove_from_list();
+    AtomicAdjust::set(entry->_last_frame_used, -1);
     _geom_cache_evict_pcollector.add_level(1);
   }
   _geom_cache_size_pcollector.set_level(_total_size);
+  _geom_cache_bytes_pcollector.set_level((double)_total_bytes);
+}
+
+/**
+ * Flushes the PStatCollectors used during traversal.
+ */
+void GeomCacheManager::
+flush_level() {
+  _geom_cache_size_pcollector.flush_level();
+  _geom_cache_active_pcollector.flush_level();
+  _geom_cache_bytes_pcollector.flush_level();
+  _geom_cache_record_pcollector.flush_level();
+  _geom_cache_erase_pcollector.flush_level();
+  _geom_cache_evict_pcollector.flush_level();
+  _geom_cache_hit_pcollector.flush_level();
+  _geom_cache_miss_pcollector.flush_level();
+  GeomMunger::flush_level();
 }
@@ -45,14 +45,19 @@ PUBLISHED:
 
   INLINE int get_total_size() const;
 
+  INLINE void set_max_bytes(size_t max_bytes) const;
+  INLINE size_t get_max_bytes() const;
+
+  INLINE size_t get_total_bytes() const;
+
   void flush();
 
   static GeomCacheManager *get_global_ptr();
 
 public:
   INLINE void evict_old_entries();
-  void evict_old_entries(int max_size, bool keep_current);
-  INLINE static void flush_level();
+  void evict_old_entries(int max_size, size_t max_bytes, bool keep_current);
+  static void flush_level();
 
 private:
   // This mutex protects all operations on this object, especially the linked-
@@ -60,6 +65,7 @@ private:
   LightMutex _lock;
 
   int _total_size;
+  size_t _total_bytes;
 
   // We maintain a doubly-linked list to keep the cache entries in least-
   // recently-used order: the items at the head of the list are ready to be
@@ -78,9 +84,12 @@ private:
 public:
   static PStatCollector _geom_cache_size_pcollector;
   static PStatCollector _geom_cache_active_pcollector;
+  static PStatCollector _geom_cache_bytes_pcollector;
   static PStatCollector _geom_cache_record_pcollector;
   static PStatCollector _geom_cache_erase_pcollector;
   static PStatCollector _geom_cache_evict_pcollector;
+  static PStatCollector _geom_cache_hit_pcollector;
+  static PStatCollector _geom_cache_miss_pcollector;
 
   friend class GeomCacheEntry;
 };
@@ -113,6 +113,9 @@ operator << (ostream &out, GeomEnums::NumericType numeric_type) {
 
   case GeomEnums::NT_packed_ufloat:
     return out << "packed_ufloat";
+
+  case GeomEnums::NT_float16:
+    return out << "float16";
   }
 
   return out << "**invalid numeric type (" << (int)numeric_type << ")**";
@@ -153,6 +156,12 @@ operator << (ostream &out, GeomEnums::Contents contents) {
 
   case GeomEnums::C_normal:
     return out << "normal";
+
+  case GeomEnums::C_octahedral_normal:
+    return out << "octahedral_normal";
+
+  case GeomEnums::C_octahedral_vector:
+    return out << "octahedral_vector";
   }
 
   return out << "**invalid contents (" << (int)contents << ")**";
@@ -187,6 +187,7 @@ PUBLISHED:
     NT_int16,        // An integer -32768..32767
     NT_int32,        // An integer -2147483648..2147483647
     NT_packed_ufloat,// Three 10/11-bit float components packed in a uint32
+    NT_float16,      // A half-precision float
   };
 
   // The contents determine the semantic meaning of a numeric value within the
@@ -209,6 +210,12 @@ PUBLISHED:
     // A special version of C_vector that should be used for normal vectors,
     // which are scaled differently from other vectors.
     C_normal,
+
+    // A unit normal or other vector, octahedrally encoded into two NT_int16
+    // components.  These are read and written as three-component vectors,
+    // and are transformed like C_normal and C_vector respectively.
+    C_octahedral_normal,
+    C_octahedral_vector,
   };
 
   // The type of animation data that is represented by a particular
@@ -17,6 +17,7 @@
 #include "lightMutexHolder.h"
 #include "lightReMutexHolder.h"
 #include "pStatTimer.h"
+#include "weakPointerTo.h"
 
 GeomMunger::Registry *GeomMunger::_registry = nullptr;
 TypeHandle GeomMunger::_type_handle;
@@ -29,7 +30,8 @@ PStatCollector GeomMunger::_munge_pcollector("*:Munge");
 GeomMunger::
 GeomMunger(GraphicsStateGuardianBase *gsg) :
   _gsg(gsg),
-  _is_registered(false)
+  _is_registered(false),
+  _cache_pcollectors(nullptr)
 {
 #ifndef NDEBUG
   Registry *registry = get_registry();
@@ -43,7 +45,8 @@ GeomMunger(GraphicsStateGuardianBase *gsg) :
  */
 GeomMunger::
 GeomMunger(const GeomMunger &copy) :
-  _is_registered(false)
+  _is_registered(false),
+  _cache_pcollectors(nullptr)
 {
 #ifndef NDEBUG
   Registry *registry = get_registry();
@@ -95,6 +98,44 @@ bool GeomMunger::
 munge_geom(CPT(Geom) &geom, CPT(GeomVertexData) &data,
            bool force, Thread *current_thread) {
 
+  // First, check the small per-thread cache of recent results.  This doesn't
+  // require taking any lock that is shared with other threads.
+  nassertr(_is_registered, false);
+  WPT(Geom::CacheEntry) *slot = nullptr;
+  int num_slots = geom_cache_thread_slots;
+  if (num_slots > 0) {
+    // The slots only hold weak pointers, so that an entry evicted from the
+    // cache is freed, along with the data and munger it references, rather
+    // than being kept alive here until the slot happens to be reused.
+    static thread_local pvector<WPT(Geom::CacheEntry)> slots;
+    if (slots.size() != (size_t)num_slots) {
+      slots.clear();
+      slots.resize(num_slots);
+    }
+    size_t hash = ((size_t)geom.p() >> 4) ^ ((size_t)data.p() >> 4) * 31u ^
+                  ((size_t)this >> 4) * 131u;
+    slot = &slots[hash % (size_t)num_slots];
+
+    // While the entry lives, it holds a reference to its data and munger, so
+    // neither pointer can have been recycled; and a Geom destroyed in the
+    // meantime will have erased the entry, which refresh() reports below.
+    PT(Geom::CacheEntry) entry = slot->lock();
+    if (entry != nullptr && entry->_source == geom &&
+        entry->_key._source_data == data && entry->_key._modifier == this &&
+        entry->refresh(current_thread)) {
+      Geom::CDCacheReader cdata(entry->_cycler, current_thread);
+      if (cdata->_source == geom &&
+          cdata->_geom_result != nullptr &&
+          geom->get_modified(current_thread) <= cdata->_geom_result->get_modified(current_thread) &&
+          data->get_modified(current_thread) <= cdata->_data_result->get_modified(current_thread)) {
+        _cache_pcollectors->_hit_pcollector.add_level(1);
+        geom = cdata->_geom_result;
+        data = cdata->_data_result;
+        return true;
+      }
+    }
+  }
+
   // Look up the munger in the geom's cache--maybe we've recently applied it.
   PT(Geom::CacheEntry) entry;
 
@@ -120,6 +161,10 @@ munge_geom(CPT(Geom) &geom, CPT(GeomVertexData) &data,
         geom->get_modified(current_thread) <= cdata->_geom_result->get_modified(current_thread) &&
         data->get_modified(current_thread) <= cdata->_data_result->get_modified(current_thread)) {
       // The cache entry is still good; use it.
+      _cache_pcollectors->_hit_pcollector.add_level(1);
+      if (slot != nullptr) {
+        (*slot) = entry.p();
+      }
 
       geom = cdata->_geom_result;
       data = cdata->_data_result;
@@ -138,10 +183,12 @@ munge_geom(CPT(Geom) &geom, CPT(GeomVertexData) &data,
   }
 
   // Ok, invoke the munger.
+  _cache_pcollectors->_miss_pcollector.add_level(1);
   PStatTimer timer(_munge_pcollector, current_thread);
 
   PT(Geom) orig_geom = (Geom *)geom.p();
   data = munge_data(data);
+  CPT(GeomVertexData) munged_data = data;
   munge_geom_impl(geom, data, current_thread);
 
   // Record the new result in the cache.
@@ -165,13 +212,83 @@ munge_geom(CPT(Geom) &geom, CPT(GeomVertexData) &data,
   }
 
   // Finally, store the cached result on the entry.
-  Geom::CDCacheWriter cdata(entry->_cycler, true, current_thread);
-  cdata->_source = (Geom *)orig_geom.p();
-  cdata->set_result(geom, data);
+  {
+    Geom::CDCacheWriter cdata(entry->_cycler, true, current_thread);
+    cdata->_source = (Geom *)orig_geom.p();
+    cdata->set_result(geom, data);
+  }
+
+  // Charge the entry for whatever memory munge_geom_impl() allocated.  The
+  // result of munge_data() is not counted here, since it is shared by all
+  // Geoms using the same data, and is accounted for in its own cache entry.
+  entry->set_num_bytes(calc_result_bytes(orig_geom, munged_data, geom, data));
 
+  if (slot != nullptr) {
+    (*slot) = entry.p();
+  }
   return true;
 }
 
+/**
+ * Flushes the PStatCollectors that count the cache hits and misses of each
+ * type of munger.
+ */
+void GeomMunger::
+flush_level() {
+  if (_registry == nullptr) {
+    return;
+  }
+
+  LightReMutexHolder holder(_registry->_registry_lock);
+  for (auto &item : _registry->_cache_pcollectors) {
+    item.second._hit_pcollector.flush_level();
+    item.second._miss_pcollector.flush_level();
+  }
+}
+
+/**
+ * Returns the number of bytes of the munged geom and data that are not shared
+ * with the source geom or the munged source data.
+ */
+size_t GeomMunger::
+calc_result_bytes(const Geom *orig_geom, const GeomVertexData *orig_data,
+                  const Geom *geom, const GeomVertexData *data) {
+  size_t num_bytes = 0;
+
+  if (data != orig_data) {
+    int num_orig_arrays = orig_data->get_num_arrays();
+    int num_arrays = data->get_num_arrays();
+    for (int i = 0; i < num_arrays; ++i) {
+      CPT(GeomVertexArrayData) array = data->get_array(i);
+      bool shared = false;
+      for (int j = 0; j < num_orig_arrays && !shared; ++j) {
+        shared = (orig_data->get_array(j) == array);
+      }
+      if (!shared) {
+        num_bytes += array->get_data_size_bytes();
+      }
+    }
+  }
+
+  if (geom != orig_geom) {
+    num_bytes += sizeof(Geom);
+    size_t num_orig_primitives = orig_geom->get_num_primitives();
+    size_t num_primitives = geom->get_num_primitives();
+    for (size_t i = 0; i < num_primitives; ++i) {
+      CPT(GeomPrimitive) prim = geom->get_primitive(i);
+      bool shared = false;
+      for (size_t j = 0; j < num_orig_primitives && !shared; ++j) {
+        shared = (orig_geom->get_primitive(j) == prim);
+      }
+      if (!shared) {
+        num_bytes += prim->get_num_bytes();
+      }
+    }
+  }
+
+  return num_bytes;
+}
+
 /**
  * The protected implementation of munge_format().  This exists just to cast
  * away the const pointer.
@@ -355,6 +472,22 @@ do_register(Thread *current_thread) {
   entry->_munger = this;
   entry->record(current_thread);
 
+  // We are called with the registry lock held.
+  Registry *registry = get_registry();
+  TypeHandle type = get_type();
+  Registry::CachePCollectorsByType::iterator pi =
+    registry->_cache_pcollectors.find(type);
+  if (pi == registry->_cache_pcollectors.end()) {
+    Registry::CachePCollectors pcollectors;
+    pcollectors._hit_pcollector =
+      PStatCollector(GeomCacheManager::_geom_cache_hit_pcollector, type.get_name());
+    pcollectors._miss_pcollector =
+      PStatCollector(GeomCacheManager::_geom_cache_miss_pcollector, type.get_name());
+    pi = registry->_cache_pcollectors.insert(
+      Registry::CachePCollectorsByType::value_type(type, pcollectors)).first;
+  }
+  _cache_pcollectors = &(*pi).second;
+
   _is_registered = true;
 }
 
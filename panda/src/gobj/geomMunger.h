@@ -69,6 +69,8 @@ public:
   bool munge_geom(CPT(Geom) &geom, CPT(GeomVertexData) &data,
                   bool force, Thread *current_thread);
 
+  static void flush_level();
+
   INLINE CPT(GeomVertexFormat) premunge_format(const GeomVertexFormat *format) const;
   INLINE CPT(GeomVertexData) premunge_data(const GeomVertexData *data) const;
   INLINE void premunge_geom(CPT(Geom) &geom, CPT(GeomVertexData) &data) const;
@@ -106,6 +108,11 @@ private:
   void do_register(Thread *current_thread);
   void do_unregister();
 
+  static size_t calc_result_bytes(const Geom *orig_geom,
+                                  const GeomVertexData *orig_data,
+                                  const Geom *geom,
+                                  const GeomVertexData *data);
+
 private:
   class CacheEntry : public GeomCacheEntry {
   public:
@@ -135,6 +142,15 @@ private:
 
     Mungers _mungers;
     LightReMutex _registry_lock;
+
+    // The cache hit and miss collectors, one pair per type of munger.
+    class CachePCollectors {
+    public:
+      PStatCollector _hit_pcollector;
+      PStatCollector _miss_pcollector;
+    };
+    typedef pmap<TypeHandle, CachePCollectors> CachePCollectorsByType;
+    CachePCollectorsByType _cache_pcollectors;
   };
 
   // We store the iterator into the above registry, while we are registered.
@@ -149,6 +165,10 @@ private:
 
   static PStatCollector _munge_pcollector;
 
+  // This points into the Registry's table, and is filled in when we are
+  // registered.
+  Registry::CachePCollectors *_cache_pcollectors;
+
   friend class GeomCacheManager;
 
 public:
@@ -23,6 +23,7 @@
 #include "geomPoints.h"
 #include "geomLines.h"
 #include "geomTriangles.h"
+#include "quadricSimplifier.h"
 #include "preparedGraphicsObjects.h"
 #include "internalName.h"
 #include "bamReader.h"
@@ -30,6 +31,7 @@
 #include "ioPtaDatagramInt.h"
 #include "indent.h"
 #include "pStatTimer.h"
+#include "cmath.h"
 
 using std::max;
 using std::min;
@@ -42,6 +44,8 @@ PStatCollector GeomPrimitive::_decompose_pcollector("*:Munge:Decompose");
 PStatCollector GeomPrimitive::_doubleside_pcollector("*:Munge:Doubleside");
 PStatCollector GeomPrimitive::_reverse_pcollector("*:Munge:Reverse");
 PStatCollector GeomPrimitive::_rotate_pcollector("*:Munge:Rotate");
+PStatCollector GeomPrimitive::_optimize_pcollector("*:Munge:Optimize");
+PStatCollector GeomPrimitive::_simplify_pcollector("*:Munge:Simplify");
 
 /**
  * Constructs an invalid object.  Only used when reading from bam.
@@ -1049,6 +1053,509 @@ make_adjacency() const {
   return nullptr;
 }
 
+/**
+ * Returns the score of a vertex for Forsyth's vertex cache optimization,
+ * given its position in the modeled LRU cache (or -1 if it is not in the
+ * cache) and the number of triangles not yet emitted that still use it.
+ */
+static float
+vertex_cache_score(int cache_pos, int num_live_triangles, int cache_size) {
+  if (num_live_triangles == 0) {
+    // No triangle needs this vertex anymore.
+    return -1.0f;
+  }
+
+  float score = 0.0f;
+  if (cache_pos >= 0) {
+    if (cache_pos < 3) {
+      // The vertices of the triangle that was just emitted get a fixed
+      // score, so that we don't favor whichever one happened to be last.
+      score = 0.75f;
+    } else {
+      float scaler = 1.0f / (float)(cache_size - 3);
+      score = 1.0f - (float)(cache_pos - 3) * scaler;
+      score = cpow(score, 1.5f);
+    }
+  }
+
+  // Boost vertices with few remaining triangles, so that we finish off
+  // lone triangles rather than leaving them for last.
+  score += 2.0f / csqrt((float)num_live_triangles);
+  return score;
+}
+
+/**
+ * Simulates a FIFO post-transform vertex cache of the indicated size, for
+ * counting cache misses.  reset() flushes the cache in constant time.
+ */
+class VertexCacheFifo {
+public:
+  VertexCacheFifo(int num_vertices, int cache_size) :
+    _stamps(num_vertices, -cache_size - 1),
+    _cache_size(cache_size),
+    _time(0) {}
+
+  int add_triangle(int a, int b, int c) {
+    return add_vertex(a) + add_vertex(b) + add_vertex(c);
+  }
+
+  int add_vertex(int v) {
+    if (_time - _stamps[v] > _cache_size) {
+      // The vertex was never loaded, or it has been pushed out since.
+      ++_time;
+      _stamps[v] = _time;
+      return 1;
+    }
+    return 0;
+  }
+
+  void reset() {
+    _time += _cache_size + 1;
+  }
+
+private:
+  pvector<int> _stamps;
+  int _cache_size;
+  int _time;
+};
+
+/**
+ * Returns a new GeomTriangles primitive with the same triangles, reordered to
+ * make better use of the post-transform vertex cache.  This uses Tom
+ * Forsyth's linear-speed greedy algorithm, which models an LRU cache of the
+ * indicated number of entries but performs well for any cache size and
+ * replacement policy in practice.
+ *
+ * The vertices within each triangle keep their original order, so the facing
+ * and flat shading of the triangles are unchanged.  Only indexed GeomTriangles
+ * are reordered; other primitives are returned unchanged.  Call decompose()
+ * first to optimize strips and fans.
+ *
+ * Use calc_acmr() to measure the result.
+ */
+CPT(GeomPrimitive) GeomPrimitive::
+optimize_vertex_cache(int cache_size) const {
+  if (!is_exact_type(GeomTriangles::get_class_type()) || !is_indexed()) {
+    return this;
+  }
+  nassertr(cache_size > 3, this);
+
+  int num_indices = get_num_vertices();
+  int num_triangles = num_indices / 3;
+  if (num_triangles < 2) {
+    return this;
+  }
+
+  if (gobj_cat.is_debug()) {
+    gobj_cat.debug()
+      << "Optimizing vertex cache for " << get_type() << ": " << (void *)this << "\n";
+  }
+
+  PStatTimer timer(_optimize_pcollector);
+
+  int num_vertices = get_max_vertex() + 1;
+  pvector<int> indices(num_indices);
+  {
+    GeomVertexReader index(get_vertices(), 0);
+    for (int i = 0; i < num_indices; ++i) {
+      indices[i] = index.get_data1i();
+    }
+  }
+
+  // Build the vertex-to-triangle adjacency, stored as one flat list with an
+  // offset per vertex.  The live triangles of each vertex are kept at the
+  // front of its range.
+  pvector<int> num_live(num_vertices, 0);
+  for (int i = 0; i < num_indices; ++i) {
+    ++num_live[indices[i]];
+  }
+  pvector<int> tri_start(num_vertices + 1, 0);
+  for (int v = 0; v < num_vertices; ++v) {
+    tri_start[v + 1] = tri_start[v] + num_live[v];
+  }
+  pvector<int> vertex_tris(num_indices);
+  {
+    pvector<int> fill(&tri_start[0], &tri_start[0] + num_vertices);
+    for (int i = 0; i < num_indices; ++i) {
+      vertex_tris[fill[indices[i]]++] = i / 3;
+    }
+  }
+
+  pvector<int> cache_pos(num_vertices, -1);
+  pvector<float> vertex_score(num_vertices);
+  for (int v = 0; v < num_vertices; ++v) {
+    vertex_score[v] = vertex_cache_score(-1, num_live[v], cache_size);
+  }
+
+  pvector<float> tri_score(num_triangles);
+  pvector<bool> emitted(num_triangles, false);
+  int best_tri = 0;
+  for (int t = 0; t < num_triangles; ++t) {
+    const int *tri = &indices[t * 3];
+    tri_score[t] = vertex_score[tri[0]] + vertex_score[tri[1]] + vertex_score[tri[2]];
+    if (tri_score[t] > tri_score[best_tri]) {
+      best_tri = t;
+    }
+  }
+
+  PT(GeomVertexArrayData) new_vertices = make_index_data();
+  new_vertices->unclean_set_num_rows(num_triangles * 3);
+  GeomVertexWriter new_index(new_vertices, 0);
+
+  pvector<int> cache, new_cache;
+  cache.reserve(cache_size + 3);
+  new_cache.reserve(cache_size + 3);
+
+  int next_unemitted = 0;
+  for (int n = 0; n < num_triangles; ++n) {
+    if (best_tri < 0) {
+      // Nothing in the cache is connected to any remaining triangle; start
+      // over with the next triangle in the original order.
+      while (emitted[next_unemitted]) {
+        ++next_unemitted;
+      }
+      best_tri = next_unemitted;
+    }
+
+    const int *tri = &indices[best_tri * 3];
+    new_index.set_data1i(tri[0]);
+    new_index.set_data1i(tri[1]);
+    new_index.set_data1i(tri[2]);
+    emitted[best_tri] = true;
+
+    // Remove the triangle from the live lists of its vertices, and move the
+    // vertices to the front of the cache.
+    new_cache.clear();
+    for (int k = 0; k < 3; ++k) {
+      int v = tri[k];
+      int *begin = &vertex_tris[tri_start[v]];
+      int *end = begin + num_live[v];
+      int *found = std::find(begin, end, best_tri);
+      nassertr(found != end, this);
+      std::swap(*found, *(end - 1));
+      --num_live[v];
+
+      if (std::find(new_cache.begin(), new_cache.end(), v) == new_cache.end()) {
+        new_cache.push_back(v);
+      }
+    }
+    for (int v : cache) {
+      if (std::find(new_cache.begin(), new_cache.end(), v) == new_cache.end()) {
+        new_cache.push_back(v);
+      }
+    }
+
+    // Rescore the vertices that are in the cache, as well as those that just
+    // fell out of it.
+    for (size_t i = 0; i < new_cache.size(); ++i) {
+      int v = new_cache[i];
+      cache_pos[v] = ((int)i < cache_size) ? (int)i : -1;
+      vertex_score[v] = vertex_cache_score(cache_pos[v], num_live[v], cache_size);
+    }
+
+    // The best next triangle is most likely one that uses a cached vertex.
+    best_tri = -1;
+    float best_score = -1.0f;
+    for (int v : new_cache) {
+      const int *begin = &vertex_tris[tri_start[v]];
+      const int *end = begin + num_live[v];
+      for (const int *ti = begin; ti != end; ++ti) {
+        const int *other = &indices[(*ti) * 3];
+        float score = vertex_score[other[0]] + vertex_score[other[1]] + vertex_score[other[2]];
+        tri_score[*ti] = score;
+        if (score > best_score) {
+          best_score = score;
+          best_tri = *ti;
+        }
+      }
+    }
+
+    if ((int)new_cache.size() > cache_size) {
+      new_cache.resize(cache_size);
+    }
+    cache.swap(new_cache);
+  }
+
+  PT(GeomPrimitive) new_prim = make_copy();
+  new_prim->set_vertices(new_vertices);
+  return new_prim;
+}
+
+/**
+ * Returns a new GeomTriangles primitive with the same triangles, reordered to
+ * reduce overdraw while keeping most of the vertex cache efficiency of the
+ * current order.  This should be called on the result of
+ * optimize_vertex_cache().
+ *
+ * This follows the approach of Sander et al.'s "Tipsify": the triangle list
+ * is cut into clusters at the points where the vertex cache would be flushed
+ * anyway, and further wherever a cluster's ACMR is already within threshold
+ * times that of the surrounding stretch, and the clusters are then sorted so
+ * that those facing outwards from the center of the mesh are drawn first.
+ * Higher thresholds produce more, smaller clusters, trading vertex cache
+ * efficiency for less overdraw.
+ *
+ * The vertex_data is used to look up the vertex positions.  Only indexed
+ * GeomTriangles are reordered; other primitives are returned unchanged.
+ */
+CPT(GeomPrimitive) GeomPrimitive::
+optimize_overdraw(const GeomVertexData *vertex_data, PN_stdfloat threshold,
+                  int cache_size) const {
+  if (!is_exact_type(GeomTriangles::get_class_type()) || !is_indexed()) {
+    return this;
+  }
+  nassertr(vertex_data != nullptr, this);
+  nassertr(cache_size > 0, this);
+
+  int num_indices = get_num_vertices();
+  int num_triangles = num_indices / 3;
+  if (num_triangles < 2 || !vertex_data->has_column(InternalName::get_vertex())) {
+    return this;
+  }
+
+  if (gobj_cat.is_debug()) {
+    gobj_cat.debug()
+      << "Optimizing overdraw for " << get_type() << ": " << (void *)this << "\n";
+  }
+
+  PStatTimer timer(_optimize_pcollector);
+
+  int num_vertices = get_max_vertex() + 1;
+  nassertr(num_vertices <= vertex_data->get_num_rows(), this);
+
+  pvector<int> indices(num_indices);
+  {
+    GeomVertexReader index(get_vertices(), 0);
+    for (int i = 0; i < num_indices; ++i) {
+      indices[i] = index.get_data1i();
+    }
+  }
+
+  pvector<LPoint3> positions(num_vertices, LPoint3::zero());
+  {
+    GeomVertexReader vertex(vertex_data, InternalName::get_vertex());
+    for (int v = 0; v < num_vertices; ++v) {
+      positions[v] = vertex.get_data3();
+    }
+  }
+
+  // Find the hard cluster boundaries, at the triangles that miss the cache
+  // on all three vertices.
+  pvector<int> boundaries;
+  {
+    VertexCacheFifo fifo(num_vertices, cache_size);
+    for (int t = 0; t < num_triangles; ++t) {
+      const int *tri = &indices[t * 3];
+      if (fifo.add_triangle(tri[0], tri[1], tri[2]) == 3) {
+        boundaries.push_back(t);
+      }
+    }
+    if (boundaries.empty() || boundaries.front() != 0) {
+      boundaries.insert(boundaries.begin(), 0);
+    }
+    boundaries.push_back(num_triangles);
+  }
+
+  // Subdivide each hard cluster wherever the ACMR of the cluster so far is
+  // already within the threshold of the hard cluster as a whole.
+  pvector<int> clusters;
+  {
+    VertexCacheFifo fifo(num_vertices, cache_size);
+    for (size_t bi = 0; bi + 1 < boundaries.size(); ++bi) {
+      int begin = boundaries[bi];
+      int end = boundaries[bi + 1];
+
+      fifo.reset();
+      int misses = 0;
+      for (int t = begin; t < end; ++t) {
+        const int *tri = &indices[t * 3];
+        misses += fifo.add_triangle(tri[0], tri[1], tri[2]);
+      }
+      PN_stdfloat limit = threshold * (PN_stdfloat)misses / (PN_stdfloat)(end - begin);
+
+      fifo.reset();
+      clusters.push_back(begin);
+      int cluster_begin = begin;
+      misses = 0;
+      for (int t = begin; t < end; ++t) {
+        const int *tri = &indices[t * 3];
+        misses += fifo.add_triangle(tri[0], tri[1], tri[2]);
+        if (t + 1 < end &&
+            (PN_stdfloat)misses <= limit * (PN_stdfloat)(t + 1 - cluster_begin)) {
+          cluster_begin = t + 1;
+          clusters.push_back(cluster_begin);
+          fifo.reset();
+          misses = 0;
+        }
+      }
+    }
+    clusters.push_back(num_triangles);
+  }
+
+  // Compute the area-weighted centroid of the whole mesh, and the centroid
+  // and average normal of each cluster.
+  size_t num_clusters = clusters.size() - 1;
+  pvector<LPoint3> cluster_centers(num_clusters, LPoint3::zero());
+  pvector<LVector3> cluster_normals(num_clusters, LVector3::zero());
+  LPoint3 mesh_center(0);
+  PN_stdfloat mesh_area = 0;
+  for (size_t ci = 0; ci < num_clusters; ++ci) {
+    LVecBase3 center(0);
+    LVector3 normal(0);
+    PN_stdfloat area = 0;
+    for (int t = clusters[ci]; t < clusters[ci + 1]; ++t) {
+      const int *tri = &indices[t * 3];
+      const LPoint3 &p0 = positions[tri[0]];
+      const LPoint3 &p1 = positions[tri[1]];
+      const LPoint3 &p2 = positions[tri[2]];
+      LVector3 n = (p1 - p0).cross(p2 - p0);
+      PN_stdfloat a = n.length();
+      center += (p0 + p1 + p2) * (a / 3);
+      normal += n;
+      area += a;
+    }
+    mesh_center += center;
+    mesh_area += area;
+    cluster_centers[ci] = (area > 0) ? LPoint3(center / area) : positions[indices[clusters[ci] * 3]];
+    normal.normalize();
+    cluster_normals[ci] = normal;
+  }
+  if (mesh_area > 0) {
+    mesh_center /= mesh_area;
+  }
+
+  // Draw the clusters that face away from the center first; these are the
+  // most likely to occlude the rest of the mesh.
+  pvector<std::pair<PN_stdfloat, int> > order(num_clusters);
+  for (size_t ci = 0; ci < num_clusters; ++ci) {
+    PN_stdfloat key = (cluster_centers[ci] - mesh_center).dot(cluster_normals[ci]);
+    order[ci] = std::pair<PN_stdfloat, int>(-key, (int)ci);
+  }
+  std::sort(order.begin(), order.end());
+
+  PT(GeomVertexArrayData) new_vertices = make_index_data();
+  new_vertices->unclean_set_num_rows(num_triangles * 3);
+  GeomVertexWriter new_index(new_vertices, 0);
+  for (size_t oi = 0; oi < num_clusters; ++oi) {
+    int ci = order[oi].second;
+    for (int i = clusters[ci] * 3; i < clusters[ci + 1] * 3; ++i) {
+      new_index.set_data1i(indices[i]);
+    }
+  }
+
+  PT(GeomPrimitive) new_prim = make_copy();
+  new_prim->set_vertices(new_vertices);
+  return new_prim;
+}
+
+/**
+ * Returns the average cache miss ratio (ACMR) of the primitive: the number of
+ * vertices that a FIFO post-transform vertex cache of the indicated size
+ * would have to process, per triangle drawn.  This ranges from 3.0 for the
+ * worst case down to about 0.5 for a regular grid with an ideal ordering.
+ *
+ * Strips and fans are decomposed to triangles first.  Returns 0 for
+ * primitives that are not made of triangles.
+ */
+PN_stdfloat GeomPrimitive::
+calc_acmr(int cache_size) const {
+  nassertr(cache_size > 0, 0);
+  if (!is_exact_type(GeomTriangles::get_class_type())) {
+    if (get_primitive_type() != PT_polygons) {
+      return 0;
+    }
+    CPT(GeomPrimitive) triangles = decompose();
+    if (!triangles->is_exact_type(GeomTriangles::get_class_type())) {
+      return 0;
+    }
+    return triangles->calc_acmr(cache_size);
+  }
+
+  int num_triangles = get_num_vertices() / 3;
+  if (num_triangles == 0) {
+    return 0;
+  }
+
+  GeomPrimitivePipelineReader reader(this, Thread::get_current_thread());
+  reader.check_minmax();
+  VertexCacheFifo fifo(reader.get_max_vertex() + 1, cache_size);
+  int misses = 0;
+  for (int t = 0; t < num_triangles; ++t) {
+    misses += fifo.add_triangle(reader.get_vertex(t * 3),
+                                reader.get_vertex(t * 3 + 1),
+                                reader.get_vertex(t * 3 + 2));
+  }
+
+  return (PN_stdfloat)misses / (PN_stdfloat)num_triangles;
+}
+
+/**
+ * Returns a new GeomTriangles primitive that approximates the same surface
+ * with fewer triangles, about target_ratio times as many as the original.
+ * The triangles are reduced with quadric error metric edge collapses; see
+ * QuadricSimplifier.
+ *
+ * The result references a subset of the original vertices, which are not
+ * modified, so that the normals and texture coordinates of the surviving
+ * vertices are unchanged; vertices along UV seams and other attribute
+ * discontinuities are kept in place.  Because of this, the target may not be
+ * reached on meshes with many seams.  The unused vertices may be removed
+ * afterwards with SceneGraphReducer::remove_unused_vertices().
+ *
+ * Strips and fans are decomposed to triangles first.  Primitives that are not
+ * made of triangles are returned unchanged.
+ */
+CPT(GeomPrimitive) GeomPrimitive::
+simplify(const GeomVertexData *vertex_data, PN_stdfloat target_ratio) const {
+  nassertr(vertex_data != nullptr, this);
+  if (!is_exact_type(GeomTriangles::get_class_type())) {
+    if (get_primitive_type() != PT_polygons) {
+      return this;
+    }
+    CPT(GeomPrimitive) triangles = decompose();
+    if (!triangles->is_exact_type(GeomTriangles::get_class_type())) {
+      return this;
+    }
+    return triangles->simplify(vertex_data, target_ratio);
+  }
+
+  int num_triangles = get_num_vertices() / 3;
+  if (target_ratio >= 1.0f || num_triangles < 2 ||
+      !vertex_data->has_column(InternalName::get_vertex())) {
+    return this;
+  }
+
+  if (gobj_cat.is_debug()) {
+    gobj_cat.debug()
+      << "Simplifying " << get_type() << ": " << (void *)this << "\n";
+  }
+
+  PStatTimer timer(_simplify_pcollector);
+
+  CPT(GeomPrimitive) indexed = this;
+  if (!is_indexed()) {
+    PT(GeomPrimitive) copy = make_copy();
+    copy->make_indexed();
+    indexed = copy;
+  }
+
+  int target = std::max((int)(num_triangles * target_ratio + 0.5f), 1);
+  QuadricSimplifier simplifier(indexed, vertex_data);
+  simplifier.simplify(target);
+
+  const pvector<int> &indices = simplifier.get_indices();
+  PT(GeomVertexArrayData) new_vertices = indexed->make_index_data();
+  new_vertices->unclean_set_num_rows((int)indices.size());
+  GeomVertexWriter new_index(new_vertices, 0);
+  for (int v : indices) {
+    new_index.set_data1i(v);
+  }
+
+  PT(GeomPrimitive) new_prim = indexed->make_copy();
+  new_prim->set_vertices(new_vertices);
+  return new_prim;
+}
+
 /**
  * Returns the number of bytes consumed by the primitive and its index
  * table(s).
@@ -1094,6 +1601,36 @@ request_resident(Thread *current_thread) const {
   return resident;
 }
 
+/**
+ * Like request_resident(), but asks for any non-resident data to be brought
+ * into memory at a lower priority, since it is not needed yet.  Returns true
+ * if the primitive data is already resident.
+ */
+bool GeomPrimitive::
+request_prefetch(Thread *current_thread) const {
+  CDReader cdata(_cycler, current_thread);
+
+  bool resident = true;
+
+  if (!cdata->_vertices.is_null() &&
+      !cdata->_vertices.get_read_pointer(current_thread)->request_prefetch(current_thread)) {
+    resident = false;
+  }
+
+  if (is_composite() && cdata->_got_minmax) {
+    if (!cdata->_mins.is_null() &&
+        !cdata->_mins.get_read_pointer(current_thread)->request_prefetch(current_thread)) {
+      resident = false;
+    }
+    if (!cdata->_maxs.is_null() &&
+        !cdata->_maxs.get_read_pointer(current_thread)->request_prefetch(current_thread)) {
+      resident = false;
+    }
+  }
+
+  return resident;
+}
+
 /**
  *
  */
@@ -136,6 +136,15 @@ PUBLISHED:
   CPT(GeomPrimitive) make_patches() const;
   virtual CPT(GeomPrimitive) make_adjacency() const;
 
+  CPT(GeomPrimitive) optimize_vertex_cache(int cache_size = 32) const;
+  CPT(GeomPrimitive) optimize_overdraw(const GeomVertexData *vertex_data,
+                                       PN_stdfloat threshold = 1.05f,
+                                       int cache_size = 32) const;
+  PN_stdfloat calc_acmr(int cache_size = 32) const;
+
+  CPT(GeomPrimitive) simplify(const GeomVertexData *vertex_data,
+                              PN_stdfloat target_ratio) const;
+
   int get_num_bytes() const;
   INLINE int get_data_size_bytes() const;
   INLINE UpdateSeq get_modified() const;
@@ -144,6 +153,7 @@ PUBLISHED:
   MAKE_PROPERTY(modified, get_modified);
 
   bool request_resident(Thread *current_thread = Thread::get_current_thread()) const;
+  bool request_prefetch(Thread *current_thread = Thread::get_current_thread()) const;
 
   INLINE bool check_valid(const GeomVertexData *vertex_data) const;
   INLINE bool check_valid(const GeomVertexDataPipelineReader *data_reader) const;
@@ -313,6 +323,8 @@ private:
   static PStatCollector _doubleside_pcollector;
   static PStatCollector _reverse_pcollector;
   static PStatCollector _rotate_pcollector;
+  static PStatCollector _optimize_pcollector;
+  static PStatCollector _simplify_pcollector;
 
 public:
   virtual void write_datagram(BamWriter *manager, Datagram &dg);
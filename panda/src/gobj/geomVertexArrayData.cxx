@@ -24,6 +24,8 @@
 #include "simpleAllocator.h"
 #include "vertexDataBuffer.h"
 #include "pbitops.h"
+#include "memoryMappedFile.h"
+#include "virtualFileSystem.h"
 
 using std::max;
 using std::min;
@@ -311,6 +313,7 @@ lru_epoch() {
   _independent_lru.begin_epoch();
   VertexDataPage::get_global_lru(VertexDataPage::RC_resident)->begin_epoch();
   VertexDataPage::get_global_lru(VertexDataPage::RC_compressed)->begin_epoch();
+  VertexDataPage::flush_latency_pstats();
 }
 
 /**
@@ -528,6 +531,27 @@ write_datagram(BamWriter *manager, Datagram &dg, void *extra_data) const {
 
   dg.add_uint32(_buffer.get_size());
 
+  if (manager->get_file_minor_ver() >= 46) {
+    // The data may be stored in a separate file data record, aligned within
+    // the file so that the reader can map it straight into memory.  This only
+    // makes sense for native-endian data going to an uncompressed file.
+    const Filename &filename = manager->get_filename();
+    bool external = bam_vertex_data_alignment > 0 &&
+      _buffer.get_size() != 0 &&
+      manager->get_file_endian() == BamWriter::BE_native &&
+      !filename.empty() &&
+      filename.get_extension() != "pz" &&
+      filename.get_extension() != "gz";
+
+    dg.add_bool(external);
+    if (external) {
+      manager->write_file_data(_buffer.get_read_pointer(true),
+                               _buffer.get_size(),
+                               (size_t)bam_vertex_data_alignment);
+      return;
+    }
+  }
+
   if (manager->get_file_endian() == BamWriter::BE_native) {
     // For native endianness, we only have to write the data directly.
     dg.append_data(_buffer.get_read_pointer(true), _buffer.get_size());
@@ -558,15 +582,29 @@ fillin(DatagramIterator &scan, BamReader *manager, void *extra_data) {
     memcpy(_buffer.get_write_pointer(), &new_data[0], new_data.size());
 
   } else {
-    // Now, the array data is just stored directly.
     size_t size = scan.get_uint32();
-    _buffer.unclean_realloc(size);
-    _buffer.set_size(size);
+    bool external = false;
+    if (manager->get_file_minor_ver() >= 46) {
+      external = scan.get_bool();
+    }
+
+    if (external) {
+      // As of bam version 6.46, the array data may be stored in a separate
+      // file data record, which we can often map directly from the file.
+      SubfileInfo info;
+      manager->read_file_data(info);
+      read_file_data(info, size, manager);
 
-    const unsigned char *source_data =
-      (const unsigned char *)scan.get_datagram().get_data();
-    memcpy(_buffer.get_write_pointer(), source_data + scan.get_current_index(), size);
-    scan.skip_bytes(size);
+    } else {
+      // Now, the array data is just stored directly.
+      _buffer.unclean_realloc(size);
+      _buffer.set_size(size);
+
+      const unsigned char *source_data =
+        (const unsigned char *)scan.get_datagram().get_data();
+      memcpy(_buffer.get_write_pointer(), source_data + scan.get_current_index(), size);
+      scan.skip_bytes(size);
+    }
   }
 
   bool endian_reversed = false;
@@ -598,6 +636,47 @@ fillin(DatagramIterator &scan, BamReader *manager, void *extra_data) {
   _modified = Geom::get_next_modified();
 }
 
+/**
+ * Called by fillin() to load the array data from the indicated file data
+ * record.  If possible, the buffer is made to reference a memory mapping of
+ * the file; otherwise, the data is read into memory.
+ */
+void GeomVertexArrayData::CData::
+read_file_data(const SubfileInfo &info, size_t size, BamReader *manager) {
+  nassertv(info.get_size() == (std::streamsize)size);
+
+  if (bam_map_vertex_data &&
+      manager->get_file_endian() == BamReader::BE_native) {
+    const unsigned char *pointer = nullptr;
+    PT(MemoryMappedFile) file = MemoryMappedFile::map_subfile(info, pointer);
+    if (file != nullptr &&
+        ((uintptr_t)pointer % MEMORY_HOOK_ALIGNMENT) == 0) {
+      _buffer.set_mapped_data(file, pointer, size);
+      return;
+    }
+  }
+
+  // We can't map it, so we have to read it in the old-fashioned way.
+  _buffer.unclean_realloc(size);
+  _buffer.set_size(size);
+
+  VirtualFileSystem *vfs = VirtualFileSystem::get_global_ptr();
+  std::istream *in = vfs->open_read_file(info.get_filename(), true);
+  if (in == nullptr) {
+    gobj_cat.error()
+      << "Unable to read vertex data from " << info << "\n";
+    memset(_buffer.get_write_pointer(), 0, size);
+    return;
+  }
+  in->seekg(info.get_start());
+  in->read((char *)_buffer.get_write_pointer(), size);
+  if (in->gcount() != (std::streamsize)size) {
+    gobj_cat.error()
+      << "Unable to read vertex data from " << info << "\n";
+  }
+  vfs->close_read_file(in);
+}
+
 /**
  * Returns a writable pointer to the beginning of the actual data stream.
  */
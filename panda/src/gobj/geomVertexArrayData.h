@@ -96,6 +96,7 @@ PUBLISHED:
   void write(std::ostream &out, int indent_level = 0) const;
 
   INLINE bool request_resident(Thread *current_thread = Thread::get_current_thread()) const;
+  INLINE bool request_prefetch(Thread *current_thread = Thread::get_current_thread()) const;
 
   INLINE CPT(GeomVertexArrayDataHandle) get_handle(Thread *current_thread = Thread::get_current_thread()) const;
   INLINE PT(GeomVertexArrayDataHandle) modify_handle(Thread *current_thread = Thread::get_current_thread());
@@ -162,6 +163,8 @@ private:
                                 void *extra_data) const;
     virtual void fillin(DatagramIterator &scan, BamReader *manager,
                         void *extra_data);
+    void read_file_data(const SubfileInfo &info, size_t size,
+                        BamReader *manager);
     virtual TypeHandle get_parent_type() const {
       return GeomVertexArrayData::get_class_type();
     }
@@ -602,6 +602,10 @@ get_format_string(bool pad) const {
       fmt_code = 'i';
       break;
 
+    case NT_float16:
+      fmt_code = 'e';
+      break;
+
     default:
       gobj_cat.error()
         << "Unknown numeric type " << column->get_numeric_type() << "!\n";
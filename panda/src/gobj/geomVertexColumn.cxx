@@ -16,6 +16,13 @@
 #include "bamReader.h"
 #include "bamWriter.h"
 
+// The bulk conversions of the packed color formats can make use of SIMD
+// instructions when they are available at compile time.
+#if defined(__SSE2__) || (_M_IX86_FP >= 2) || defined(_M_X64) || defined(_M_AMD64)
+#include <emmintrin.h>
+#define PACKER_SSE2
+#endif
+
 using std::max;
 using std::min;
 
@@ -134,6 +141,10 @@ output(std::ostream &out) const {
     out << "d";
     break;
 
+  case NT_float16:
+    out << "h";
+    break;
+
   case NT_stdfloat:
   case NT_packed_ufloat:
     out << "?";
@@ -195,6 +206,10 @@ setup() {
     _component_bytes = 8;  // sizeof(PN_float64)
     break;
 
+  case NT_float16:
+    _component_bytes = 2;  // sizeof(uint16_t)
+    break;
+
   case NT_stdfloat:
     nassertv(false);
     break;
@@ -329,6 +344,16 @@ make_packer() const {
     }
     return new Packer_color;
 
+  case C_octahedral_normal:
+  case C_octahedral_vector:
+    if (get_num_values() == 2 && get_numeric_type() == NT_int16) {
+      return new Packer_octahedral_int16;
+    }
+    gobj_cat.error()
+      << "GeomVertexColumn with contents " << get_contents()
+      << " must have 2 int16 components!\n";
+    return new Packer;
+
   case C_normal:
     if (get_num_values() != 3 && get_num_values() != 4) {
       gobj_cat.error()
@@ -383,13 +408,29 @@ void GeomVertexColumn::
 write_datagram(BamWriter *manager, Datagram &dg) {
   manager->write_pointer(dg, _name);
   dg.add_uint8(_num_components);
-  dg.add_uint8(_numeric_type);
 
-  if (_contents == C_normal && manager->get_file_minor_ver() < 38) {
+  NumericType numeric_type = _numeric_type;
+  Contents contents = _contents;
+  if (manager->get_file_minor_ver() < 47 &&
+      (numeric_type == NT_float16 || contents == C_octahedral_normal ||
+       contents == C_octahedral_vector)) {
+    // Half floats and octahedral vectors were added in bam 6.47; an older
+    // reader would misinterpret them.  The data can't be converted here, so
+    // it is labeled as plain integers, which such a reader can at least load
+    // safely.
+    gobj_cat.error()
+      << "Column " << *_name << " cannot be represented in bam version 6."
+      << manager->get_file_minor_ver() << "; set bam-version 6 47.\n";
+    numeric_type = (numeric_type == NT_float16) ? NT_uint16 : numeric_type;
+    contents = C_other;
+  }
+  dg.add_uint8(numeric_type);
+
+  if (contents == C_normal && manager->get_file_minor_ver() < 38) {
     // Panda 1.9 did not have C_normal.
     dg.add_uint8(C_vector);
   } else {
-    dg.add_uint8(_contents);
+    dg.add_uint8(contents);
   }
 
   dg.add_uint16(_start);
@@ -432,6 +473,22 @@ fillin(DatagramIterator &scan, BamReader *manager) {
   _contents = (Contents)scan.get_uint8();
   _start = scan.get_uint16();
 
+  // Reject values that this file's version doesn't define, rather than
+  // guessing at the layout of the data.
+  bool invalid = (_numeric_type > NT_float16 || _contents > C_octahedral_vector);
+  if (manager->get_file_minor_ver() < 47) {
+    invalid = invalid || _numeric_type == NT_float16 ||
+      _contents == C_octahedral_normal || _contents == C_octahedral_vector;
+  }
+  if (invalid) {
+    gobj_cat.error()
+      << "Invalid numeric type " << (int)_numeric_type << " or contents "
+      << (int)_contents << " in bam version 6."
+      << manager->get_file_minor_ver() << "\n";
+    _numeric_type = NT_uint8;
+    _contents = C_other;
+  }
+
   _column_alignment = 1;
   if (manager->get_file_minor_ver() >= 29) {
     _column_alignment = scan.get_uint8();
@@ -492,6 +549,9 @@ get_data1f(const unsigned char *pointer) {
   case NT_int32:
     return *(const int32_t *)pointer;
 
+  case NT_float16:
+    return GeomVertexData::unpack_half(*(const uint16_t *)pointer);
+
   case NT_packed_ufloat:
     {
       uint32_t dword = *(const uint32_t *)pointer;
@@ -592,6 +652,14 @@ get_data2f(const unsigned char *pointer) {
       }
       return _v2;
 
+    case NT_float16:
+      {
+        const uint16_t *pi = (const uint16_t *)pointer;
+        _v2.set(GeomVertexData::unpack_half(pi[0]),
+                GeomVertexData::unpack_half(pi[1]));
+      }
+      return _v2;
+
     case NT_packed_ufloat:
       nassertr(false, _v2);
       return _v2;
@@ -698,6 +766,15 @@ get_data3f(const unsigned char *pointer) {
       }
       return _v3;
 
+    case NT_float16:
+      {
+        const uint16_t *pi = (const uint16_t *)pointer;
+        _v3.set(GeomVertexData::unpack_half(pi[0]),
+                GeomVertexData::unpack_half(pi[1]),
+                GeomVertexData::unpack_half(pi[2]));
+      }
+      return _v3;
+
     case NT_packed_ufloat:
       {
         uint32_t dword = *(const uint32_t *)pointer;
@@ -818,6 +895,16 @@ get_data4f(const unsigned char *pointer) {
       }
       return _v4;
 
+    case NT_float16:
+      {
+        const uint16_t *pi = (const uint16_t *)pointer;
+        _v4.set(GeomVertexData::unpack_half(pi[0]),
+                GeomVertexData::unpack_half(pi[1]),
+                GeomVertexData::unpack_half(pi[2]),
+                GeomVertexData::unpack_half(pi[3]));
+      }
+      return _v4;
+
     case NT_packed_ufloat:
       nassertr(false, _v4);
       break;
@@ -873,6 +960,9 @@ get_data1d(const unsigned char *pointer) {
   case NT_int32:
     return *(const int32_t *)pointer;
 
+  case NT_float16:
+    return GeomVertexData::unpack_half(*(const uint16_t *)pointer);
+
   case NT_packed_ufloat:
     {
       uint32_t dword = *(const uint32_t *)pointer;
@@ -970,6 +1060,14 @@ get_data2d(const unsigned char *pointer) {
       }
       return _v2d;
 
+    case NT_float16:
+      {
+        const uint16_t *pi = (const uint16_t *)pointer;
+        _v2d.set(GeomVertexData::unpack_half(pi[0]),
+                 GeomVertexData::unpack_half(pi[1]));
+      }
+      return _v2d;
+
     case NT_packed_ufloat:
       nassertr(false, _v2d);
       break;
@@ -1076,6 +1174,15 @@ get_data3d(const unsigned char *pointer) {
       }
       return _v3d;
 
+    case NT_float16:
+      {
+        const uint16_t *pi = (const uint16_t *)pointer;
+        _v3d.set(GeomVertexData::unpack_half(pi[0]),
+                 GeomVertexData::unpack_half(pi[1]),
+                 GeomVertexData::unpack_half(pi[2]));
+      }
+      return _v3d;
+
     case NT_packed_ufloat:
       {
         uint32_t dword = *(const uint32_t *)pointer;
@@ -1196,6 +1303,16 @@ get_data4d(const unsigned char *pointer) {
       }
       return _v4d;
 
+    case NT_float16:
+      {
+        const uint16_t *pi = (const uint16_t *)pointer;
+        _v4d.set(GeomVertexData::unpack_half(pi[0]),
+                 GeomVertexData::unpack_half(pi[1]),
+                 GeomVertexData::unpack_half(pi[2]),
+                 GeomVertexData::unpack_half(pi[3]));
+      }
+      return _v4d;
+
     case NT_packed_ufloat:
       nassertr(false, _v4d);
       break;
@@ -1251,6 +1368,9 @@ get_data1i(const unsigned char *pointer) {
   case NT_int32:
     return *(const int32_t *)pointer;
 
+  case NT_float16:
+    return GeomVertexData::unpack_half(*(const uint16_t *)pointer);
+
   case NT_packed_ufloat:
     {
       uint32_t dword = *(const uint32_t *)pointer;
@@ -1346,6 +1466,14 @@ get_data2i(const unsigned char *pointer) {
       }
       return _v2i;
 
+    case NT_float16:
+      {
+        const uint16_t *pi = (const uint16_t *)pointer;
+        _v2i.set((int)GeomVertexData::unpack_half(pi[0]),
+                 (int)GeomVertexData::unpack_half(pi[1]));
+      }
+      return _v2i;
+
     case NT_packed_ufloat:
       nassertr(false, _v2i);
       break;
@@ -1449,6 +1577,15 @@ get_data3i(const unsigned char *pointer) {
       }
       return _v3i;
 
+    case NT_float16:
+      {
+        const uint16_t *pi = (const uint16_t *)pointer;
+        _v3i.set((int)GeomVertexData::unpack_half(pi[0]),
+                 (int)GeomVertexData::unpack_half(pi[1]),
+                 (int)GeomVertexData::unpack_half(pi[2]));
+      }
+      return _v3i;
+
     case NT_packed_ufloat:
       {
         uint32_t dword = *(const uint32_t *)pointer;
@@ -1566,6 +1703,16 @@ get_data4i(const unsigned char *pointer) {
       }
       return _v4i;
 
+    case NT_float16:
+      {
+        const uint16_t *pi = (const uint16_t *)pointer;
+        _v4i.set((int)GeomVertexData::unpack_half(pi[0]),
+                 (int)GeomVertexData::unpack_half(pi[1]),
+                 (int)GeomVertexData::unpack_half(pi[2]),
+                 (int)GeomVertexData::unpack_half(pi[3]));
+      }
+      return _v4i;
+
     case NT_packed_ufloat:
       nassertr(false, _v4i);
       break;
@@ -1624,6 +1771,10 @@ set_data1f(unsigned char *pointer, float data) {
       *(int32_t *)pointer = (int)data;
       break;
 
+    case NT_float16:
+      *(uint16_t *)pointer = GeomVertexData::pack_half(data);
+      break;
+
     case NT_packed_ufloat:
       nassertv(false);
       break;
@@ -1729,6 +1880,14 @@ set_data2f(unsigned char *pointer, const LVecBase2f &data) {
       }
       break;
 
+    case NT_float16:
+      {
+        uint16_t *pi = (uint16_t *)pointer;
+        pi[0] = GeomVertexData::pack_half(data[0]);
+        pi[1] = GeomVertexData::pack_half(data[1]);
+      }
+      break;
+
     case NT_packed_ufloat:
       nassertv(false);
       break;
@@ -1842,6 +2001,15 @@ set_data3f(unsigned char *pointer, const LVecBase3f &data) {
       }
       break;
 
+    case NT_float16:
+      {
+        uint16_t *pi = (uint16_t *)pointer;
+        pi[0] = GeomVertexData::pack_half(data[0]);
+        pi[1] = GeomVertexData::pack_half(data[1]);
+        pi[2] = GeomVertexData::pack_half(data[2]);
+      }
+      break;
+
     case NT_packed_ufloat:
       *(uint32_t *)pointer = GeomVertexData::pack_ufloat(data[0], data[1], data[2]);
       break;
@@ -1966,6 +2134,16 @@ set_data4f(unsigned char *pointer, const LVecBase4f &data) {
       }
       break;
 
+    case NT_float16:
+      {
+        uint16_t *pi = (uint16_t *)pointer;
+        pi[0] = GeomVertexData::pack_half(data[0]);
+        pi[1] = GeomVertexData::pack_half(data[1]);
+        pi[2] = GeomVertexData::pack_half(data[2]);
+        pi[3] = GeomVertexData::pack_half(data[3]);
+      }
+      break;
+
     case NT_packed_ufloat:
       nassertv(false);
       break;
@@ -2023,6 +2201,10 @@ set_data1d(unsigned char *pointer, double data) {
       *(int32_t *)pointer = (int)data;
       break;
 
+    case NT_float16:
+      *(uint16_t *)pointer = GeomVertexData::pack_half(data);
+      break;
+
     case NT_packed_ufloat:
       nassertv(false);
       break;
@@ -2127,6 +2309,14 @@ set_data2d(unsigned char *pointer, const LVecBase2d &data) {
       }
       break;
 
+    case NT_float16:
+      {
+        uint16_t *pi = (uint16_t *)pointer;
+        pi[0] = GeomVertexData::pack_half(data[0]);
+        pi[1] = GeomVertexData::pack_half(data[1]);
+      }
+      break;
+
     case NT_packed_ufloat:
       nassertv(false);
       break;
@@ -2240,6 +2430,15 @@ set_data3d(unsigned char *pointer, const LVecBase3d &data) {
       }
       break;
 
+    case NT_float16:
+      {
+        uint16_t *pi = (uint16_t *)pointer;
+        pi[0] = GeomVertexData::pack_half(data[0]);
+        pi[1] = GeomVertexData::pack_half(data[1]);
+        pi[2] = GeomVertexData::pack_half(data[2]);
+      }
+      break;
+
     case NT_packed_ufloat:
       *(uint32_t *)pointer = GeomVertexData::pack_ufloat(data[0], data[1], data[2]);
       break;
@@ -2364,6 +2563,16 @@ set_data4d(unsigned char *pointer, const LVecBase4d &data) {
       }
       break;
 
+    case NT_float16:
+      {
+        uint16_t *pi = (uint16_t *)pointer;
+        pi[0] = GeomVertexData::pack_half(data[0]);
+        pi[1] = GeomVertexData::pack_half(data[1]);
+        pi[2] = GeomVertexData::pack_half(data[2]);
+        pi[3] = GeomVertexData::pack_half(data[3]);
+      }
+      break;
+
     case NT_packed_ufloat:
       nassertv(false);
       break;
@@ -2425,6 +2634,10 @@ set_data1i(unsigned char *pointer, int data) {
       *(int32_t *)pointer = data;
       break;
 
+    case NT_float16:
+      *(uint16_t *)pointer = GeomVertexData::pack_half(data);
+      break;
+
     case NT_packed_ufloat:
       nassertv(false);
       break;
@@ -2527,6 +2740,14 @@ set_data2i(unsigned char *pointer, const LVecBase2i &data) {
       }
       break;
 
+    case NT_float16:
+      {
+        uint16_t *pi = (uint16_t *)pointer;
+        pi[0] = GeomVertexData::pack_half(data[0]);
+        pi[1] = GeomVertexData::pack_half(data[1]);
+      }
+      break;
+
     case NT_packed_ufloat:
       nassertv(false);
       break;
@@ -2637,6 +2858,15 @@ set_data3i(unsigned char *pointer, const LVecBase3i &data) {
       }
       break;
 
+    case NT_float16:
+      {
+        uint16_t *pi = (uint16_t *)pointer;
+        pi[0] = GeomVertexData::pack_half(data[0]);
+        pi[1] = GeomVertexData::pack_half(data[1]);
+        pi[2] = GeomVertexData::pack_half(data[2]);
+      }
+      break;
+
     case NT_packed_ufloat:
       *(uint32_t *)pointer = GeomVertexData::pack_ufloat(data[0], data[1], data[2]);
       break;
@@ -2758,6 +2988,16 @@ set_data4i(unsigned char *pointer, const LVecBase4i &data) {
       }
       break;
 
+    case NT_float16:
+      {
+        uint16_t *pi = (uint16_t *)pointer;
+        pi[0] = GeomVertexData::pack_half(data[0]);
+        pi[1] = GeomVertexData::pack_half(data[1]);
+        pi[2] = GeomVertexData::pack_half(data[2]);
+        pi[3] = GeomVertexData::pack_half(data[3]);
+      }
+      break;
+
     case NT_packed_ufloat:
       nassertv(false);
       break;
@@ -2766,6 +3006,106 @@ set_data4i(unsigned char *pointer, const LVecBase4i &data) {
   }
 }
 
+/**
+ * Fills in num_rows values, reading them from consecutive rows starting at
+ * pointer.
+ */
+void GeomVertexColumn::Packer::
+get_data3f_n(LVecBase3f *data, const unsigned char *pointer, size_t stride,
+             size_t num_rows) {
+  for (size_t i = 0; i < num_rows; ++i) {
+    data[i] = get_data3f(pointer);
+    pointer += stride;
+  }
+}
+
+/**
+ * Fills in num_rows values, reading them from consecutive rows starting at
+ * pointer.
+ */
+void GeomVertexColumn::Packer::
+get_data4f_n(LVecBase4f *data, const unsigned char *pointer, size_t stride,
+             size_t num_rows) {
+  for (size_t i = 0; i < num_rows; ++i) {
+    data[i] = get_data4f(pointer);
+    pointer += stride;
+  }
+}
+
+/**
+ * Fills in num_rows values, reading them from consecutive rows starting at
+ * pointer.
+ */
+void GeomVertexColumn::Packer::
+get_data3d_n(LVecBase3d *data, const unsigned char *pointer, size_t stride,
+             size_t num_rows) {
+  for (size_t i = 0; i < num_rows; ++i) {
+    data[i] = get_data3d(pointer);
+    pointer += stride;
+  }
+}
+
+/**
+ * Fills in num_rows values, reading them from consecutive rows starting at
+ * pointer.
+ */
+void GeomVertexColumn::Packer::
+get_data4d_n(LVecBase4d *data, const unsigned char *pointer, size_t stride,
+             size_t num_rows) {
+  for (size_t i = 0; i < num_rows; ++i) {
+    data[i] = get_data4d(pointer);
+    pointer += stride;
+  }
+}
+
+/**
+ * Writes num_rows values to consecutive rows starting at pointer.
+ */
+void GeomVertexColumn::Packer::
+set_data3f_n(unsigned char *pointer, size_t stride, const LVecBase3f *data,
+             size_t num_rows) {
+  for (size_t i = 0; i < num_rows; ++i) {
+    set_data3f(pointer, data[i]);
+    pointer += stride;
+  }
+}
+
+/**
+ * Writes num_rows values to consecutive rows starting at pointer.
+ */
+void GeomVertexColumn::Packer::
+set_data4f_n(unsigned char *pointer, size_t stride, const LVecBase4f *data,
+             size_t num_rows) {
+  for (size_t i = 0; i < num_rows; ++i) {
+    set_data4f(pointer, data[i]);
+    pointer += stride;
+  }
+}
+
+/**
+ * Writes num_rows values to consecutive rows starting at pointer.
+ */
+void GeomVertexColumn::Packer::
+set_data3d_n(unsigned char *pointer, size_t stride, const LVecBase3d *data,
+             size_t num_rows) {
+  for (size_t i = 0; i < num_rows; ++i) {
+    set_data3d(pointer, data[i]);
+    pointer += stride;
+  }
+}
+
+/**
+ * Writes num_rows values to consecutive rows starting at pointer.
+ */
+void GeomVertexColumn::Packer::
+set_data4d_n(unsigned char *pointer, size_t stride, const LVecBase4d *data,
+             size_t num_rows) {
+  for (size_t i = 0; i < num_rows; ++i) {
+    set_data4d(pointer, data[i]);
+    pointer += stride;
+  }
+}
+
 /**
  *
  */
@@ -2913,6 +3253,16 @@ get_data4f(const unsigned char *pointer) {
       }
       return _v4;
 
+    case NT_float16:
+      {
+        const uint16_t *pi = (const uint16_t *)pointer;
+        _v4.set(GeomVertexData::unpack_half(pi[0]),
+                GeomVertexData::unpack_half(pi[1]),
+                GeomVertexData::unpack_half(pi[2]),
+                GeomVertexData::unpack_half(pi[3]));
+      }
+      return _v4;
+
     case NT_packed_ufloat:
       nassertr(false, _v4);
       break;
@@ -3069,6 +3419,16 @@ get_data4d(const unsigned char *pointer) {
       }
       return _v4d;
 
+    case NT_float16:
+      {
+        const uint16_t *pi = (const uint16_t *)pointer;
+        _v4d.set(GeomVertexData::unpack_half(pi[0]),
+                 GeomVertexData::unpack_half(pi[1]),
+                 GeomVertexData::unpack_half(pi[2]),
+                 GeomVertexData::unpack_half(pi[3]));
+      }
+      return _v4d;
+
     case NT_packed_ufloat:
       nassertr(false, _v4d);
       break;
@@ -3226,6 +3586,16 @@ set_data4f(unsigned char *pointer, const LVecBase4f &data) {
       }
       break;
 
+    case NT_float16:
+      {
+        uint16_t *pi = (uint16_t *)pointer;
+        pi[0] = GeomVertexData::pack_half(data[0]);
+        pi[1] = GeomVertexData::pack_half(data[1]);
+        pi[2] = GeomVertexData::pack_half(data[2]);
+        pi[3] = GeomVertexData::pack_half(data[3]);
+      }
+      break;
+
     case NT_packed_ufloat:
       nassertv(false);
       break;
@@ -3382,6 +3752,16 @@ set_data4d(unsigned char *pointer, const LVecBase4d &data) {
       }
       break;
 
+    case NT_float16:
+      {
+        uint16_t *pi = (uint16_t *)pointer;
+        pi[0] = GeomVertexData::pack_half(data[0]);
+        pi[1] = GeomVertexData::pack_half(data[1]);
+        pi[2] = GeomVertexData::pack_half(data[2]);
+        pi[3] = GeomVertexData::pack_half(data[3]);
+      }
+      break;
+
     case NT_packed_ufloat:
       nassertv(false);
       break;
@@ -3423,6 +3803,9 @@ get_data1f(const unsigned char *pointer) {
   case NT_float64:
     return *(const PN_float64 *)pointer;
 
+  case NT_float16:
+    return GeomVertexData::unpack_half(*(const uint16_t *)pointer);
+
   default:
     nassertr(false, 0.0f);
   }
@@ -3503,6 +3886,15 @@ get_data3f(const unsigned char *pointer) {
       nassertr(false, _v3);
       return _v3;
 
+    case NT_float16:
+      {
+        const uint16_t *pi = (const uint16_t *)pointer;
+        _v3.set(GeomVertexData::unpack_half(pi[0]),
+                GeomVertexData::unpack_half(pi[1]),
+                GeomVertexData::unpack_half(pi[2]));
+      }
+      return _v3;
+
     case NT_packed_ufloat:
       {
         uint32_t dword = *(const uint32_t *)pointer;
@@ -3596,6 +3988,16 @@ get_data4f(const unsigned char *pointer) {
     case NT_int8:
     case NT_int16:
     case NT_int32:
+    case NT_float16:
+      {
+        const uint16_t *pi = (const uint16_t *)pointer;
+        _v4.set(GeomVertexData::unpack_half(pi[0]),
+                GeomVertexData::unpack_half(pi[1]),
+                GeomVertexData::unpack_half(pi[2]),
+                GeomVertexData::unpack_half(pi[3]));
+      }
+      return _v4;
+
     case NT_packed_ufloat:
       nassertr(false, _v4);
       return _v4;
@@ -3638,6 +4040,9 @@ get_data1d(const unsigned char *pointer) {
   case NT_float64:
     return *(const PN_float64 *)pointer;
 
+  case NT_float16:
+    return GeomVertexData::unpack_half(*(const uint16_t *)pointer);
+
   default:
     nassertr(false, 0.0);
   }
@@ -3718,6 +4123,15 @@ get_data3d(const unsigned char *pointer) {
       nassertr(false, _v3d);
       return _v3d;
 
+    case NT_float16:
+      {
+        const uint16_t *pi = (const uint16_t *)pointer;
+        _v3d.set(GeomVertexData::unpack_half(pi[0]),
+                 GeomVertexData::unpack_half(pi[1]),
+                 GeomVertexData::unpack_half(pi[2]));
+      }
+      return _v3d;
+
     case NT_packed_ufloat:
       {
         uint32_t dword = *(const uint32_t *)pointer;
@@ -3811,6 +4225,16 @@ get_data4d(const unsigned char *pointer) {
     case NT_int8:
     case NT_int16:
     case NT_int32:
+    case NT_float16:
+      {
+        const uint16_t *pi = (const uint16_t *)pointer;
+        _v4d.set(GeomVertexData::unpack_half(pi[0]),
+                 GeomVertexData::unpack_half(pi[1]),
+                 GeomVertexData::unpack_half(pi[2]),
+                 GeomVertexData::unpack_half(pi[3]));
+      }
+      return _v4d;
+
     case NT_packed_ufloat:
       nassertr(false, _v4d);
       return _v4d;
@@ -3922,6 +4346,15 @@ set_data3f(unsigned char *pointer, const LVecBase3f &data) {
       nassertv(false);
       break;
 
+    case NT_float16:
+      {
+        uint16_t *pi = (uint16_t *)pointer;
+        pi[0] = GeomVertexData::pack_half(data[0]);
+        pi[1] = GeomVertexData::pack_half(data[1]);
+        pi[2] = GeomVertexData::pack_half(data[2]);
+      }
+      break;
+
     case NT_packed_ufloat:
       *(uint32_t *)pointer = GeomVertexData::pack_ufloat(data[0], data[1], data[2]);
       break;
@@ -4016,6 +4449,16 @@ set_data4f(unsigned char *pointer, const LVecBase4f &data) {
       nassertv(false);
       break;
 
+    case NT_float16:
+      {
+        uint16_t *pi = (uint16_t *)pointer;
+        pi[0] = GeomVertexData::pack_half(data[0]);
+        pi[1] = GeomVertexData::pack_half(data[1]);
+        pi[2] = GeomVertexData::pack_half(data[2]);
+        pi[3] = GeomVertexData::pack_half(data[3]);
+      }
+      break;
+
     case NT_packed_ufloat:
       nassertv(false);
       break;
@@ -4125,6 +4568,15 @@ set_data3d(unsigned char *pointer, const LVecBase3d &data) {
       nassertv(false);
       break;
 
+    case NT_float16:
+      {
+        uint16_t *pi = (uint16_t *)pointer;
+        pi[0] = GeomVertexData::pack_half(data[0]);
+        pi[1] = GeomVertexData::pack_half(data[1]);
+        pi[2] = GeomVertexData::pack_half(data[2]);
+      }
+      break;
+
     case NT_packed_ufloat:
       *(uint32_t *)pointer = GeomVertexData::pack_ufloat(data[0], data[1], data[2]);
       break;
@@ -4219,6 +4671,16 @@ set_data4d(unsigned char *pointer, const LVecBase4d &data) {
       nassertv(false);
       break;
 
+    case NT_float16:
+      {
+        uint16_t *pi = (uint16_t *)pointer;
+        pi[0] = GeomVertexData::pack_half(data[0]);
+        pi[1] = GeomVertexData::pack_half(data[1]);
+        pi[2] = GeomVertexData::pack_half(data[2]);
+        pi[3] = GeomVertexData::pack_half(data[3]);
+      }
+      break;
+
     case NT_packed_ufloat:
       nassertv(false);
       break;
@@ -4247,6 +4709,34 @@ set_data3f(unsigned char *pointer, const LVecBase3f &data) {
   pi[2] = data[2];
 }
 
+/**
+ *
+ */
+void GeomVertexColumn::Packer_float32_3::
+get_data3f_n(LVecBase3f *data, const unsigned char *pointer, size_t stride,
+             size_t num_rows) {
+  for (size_t i = 0; i < num_rows; ++i) {
+    const PN_float32 *pi = (const PN_float32 *)pointer;
+    data[i].set(pi[0], pi[1], pi[2]);
+    pointer += stride;
+  }
+}
+
+/**
+ *
+ */
+void GeomVertexColumn::Packer_float32_3::
+set_data3f_n(unsigned char *pointer, size_t stride, const LVecBase3f *data,
+             size_t num_rows) {
+  for (size_t i = 0; i < num_rows; ++i) {
+    PN_float32 *pi = (PN_float32 *)pointer;
+    pi[0] = data[i][0];
+    pi[1] = data[i][1];
+    pi[2] = data[i][2];
+    pointer += stride;
+  }
+}
+
 /**
  *
  */
@@ -4288,6 +4778,47 @@ set_data3f(unsigned char *pointer, const LVecBase3f &data) {
   pi[2] = data[2];
 }
 
+/**
+ *
+ */
+void GeomVertexColumn::Packer_point_float32_3::
+get_data3f_n(LVecBase3f *data, const unsigned char *pointer, size_t stride,
+             size_t num_rows) {
+  for (size_t i = 0; i < num_rows; ++i) {
+    const PN_float32 *pi = (const PN_float32 *)pointer;
+    data[i].set(pi[0], pi[1], pi[2]);
+    pointer += stride;
+  }
+}
+
+/**
+ *
+ */
+void GeomVertexColumn::Packer_point_float32_3::
+set_data3f_n(unsigned char *pointer, size_t stride, const LVecBase3f *data,
+             size_t num_rows) {
+  for (size_t i = 0; i < num_rows; ++i) {
+    PN_float32 *pi = (PN_float32 *)pointer;
+    pi[0] = data[i][0];
+    pi[1] = data[i][1];
+    pi[2] = data[i][2];
+    pointer += stride;
+  }
+}
+
+/**
+ *
+ */
+void GeomVertexColumn::Packer_point_float32_3::
+get_data4f_n(LVecBase4f *data, const unsigned char *pointer, size_t stride,
+             size_t num_rows) {
+  for (size_t i = 0; i < num_rows; ++i) {
+    const PN_float32 *pi = (const PN_float32 *)pointer;
+    data[i].set(pi[0], pi[1], pi[2], 1.0f);
+    pointer += stride;
+  }
+}
+
 /**
  *
  */
@@ -4310,6 +4841,35 @@ set_data4f(unsigned char *pointer, const LVecBase4f &data) {
   pi[3] = data[3];
 }
 
+/**
+ *
+ */
+void GeomVertexColumn::Packer_point_float32_4::
+get_data4f_n(LVecBase4f *data, const unsigned char *pointer, size_t stride,
+             size_t num_rows) {
+  for (size_t i = 0; i < num_rows; ++i) {
+    const PN_float32 *pi = (const PN_float32 *)pointer;
+    data[i].set(pi[0], pi[1], pi[2], pi[3]);
+    pointer += stride;
+  }
+}
+
+/**
+ *
+ */
+void GeomVertexColumn::Packer_point_float32_4::
+set_data4f_n(unsigned char *pointer, size_t stride, const LVecBase4f *data,
+             size_t num_rows) {
+  for (size_t i = 0; i < num_rows; ++i) {
+    PN_float32 *pi = (PN_float32 *)pointer;
+    pi[0] = data[i][0];
+    pi[1] = data[i][1];
+    pi[2] = data[i][2];
+    pi[3] = data[i][3];
+    pointer += stride;
+  }
+}
+
 /**
  *
  */
@@ -4486,6 +5046,66 @@ set_data4f(unsigned char *pointer, const LVecBase4f &data) {
      (unsigned int)(min(max(data[2], 0.0f), 1.0f) * 255.0f));
 }
 
+/**
+ *
+ */
+void GeomVertexColumn::Packer_argb_packed::
+get_data4f_n(LVecBase4f *data, const unsigned char *pointer, size_t stride,
+             size_t num_rows) {
+#ifdef PACKER_SSE2
+  // The bytes are stored in BGRA order.
+  const __m128i zero = _mm_setzero_si128();
+  const __m128 scale = _mm_set1_ps(1.0f / 255.0f);
+  for (size_t i = 0; i < num_rows; ++i) {
+    uint32_t dword;
+    memcpy(&dword, pointer, sizeof(dword));
+    __m128i v = _mm_cvtsi32_si128((int)dword);
+    v = _mm_unpacklo_epi16(_mm_unpacklo_epi8(v, zero), zero);
+    __m128 f = _mm_mul_ps(_mm_cvtepi32_ps(v), scale);
+    _mm_storeu_ps(&data[i][0], _mm_shuffle_ps(f, f, _MM_SHUFFLE(3, 0, 1, 2)));
+    pointer += stride;
+  }
+#else
+  for (size_t i = 0; i < num_rows; ++i) {
+    uint32_t dword = *(const uint32_t *)pointer;
+    data[i].set(GeomVertexData::unpack_abcd_b(dword),
+                GeomVertexData::unpack_abcd_c(dword),
+                GeomVertexData::unpack_abcd_d(dword),
+                GeomVertexData::unpack_abcd_a(dword));
+    data[i] /= 255.0f;
+    pointer += stride;
+  }
+#endif
+}
+
+/**
+ *
+ */
+void GeomVertexColumn::Packer_argb_packed::
+set_data4f_n(unsigned char *pointer, size_t stride, const LVecBase4f *data,
+             size_t num_rows) {
+#ifdef PACKER_SSE2
+  const __m128 zero = _mm_setzero_ps();
+  const __m128 one = _mm_set1_ps(1.0f);
+  const __m128 scale = _mm_set1_ps(255.0f);
+  for (size_t i = 0; i < num_rows; ++i) {
+    __m128 f = _mm_loadu_ps(data[i].get_data());
+    f = _mm_mul_ps(_mm_min_ps(_mm_max_ps(f, zero), one), scale);
+    f = _mm_shuffle_ps(f, f, _MM_SHUFFLE(3, 0, 1, 2));
+    __m128i v = _mm_cvttps_epi32(f);
+    v = _mm_packus_epi16(_mm_packs_epi32(v, v), v);
+    uint32_t dword = (uint32_t)_mm_cvtsi128_si32(v);
+    memcpy(pointer, &dword, sizeof(dword));
+    pointer += stride;
+  }
+#else
+  for (size_t i = 0; i < num_rows; ++i) {
+    set_data4f(pointer, data[i]);
+    pointer += stride;
+  }
+#endif
+}
+
 /**
  *
  */
@@ -4508,6 +5128,60 @@ set_data4f(unsigned char *pointer, const LVecBase4f &data) {
   pointer[3] = (unsigned int)(min(max(data[3], 0.0f), 1.0f) * 255.0f);
 }
 
+/**
+ *
+ */
+void GeomVertexColumn::Packer_rgba_uint8_4::
+get_data4f_n(LVecBase4f *data, const unsigned char *pointer, size_t stride,
+             size_t num_rows) {
+#ifdef PACKER_SSE2
+  const __m128i zero = _mm_setzero_si128();
+  const __m128 scale = _mm_set1_ps(1.0f / 255.0f);
+  for (size_t i = 0; i < num_rows; ++i) {
+    uint32_t dword;
+    memcpy(&dword, pointer, sizeof(dword));
+    __m128i v = _mm_cvtsi32_si128((int)dword);
+    v = _mm_unpacklo_epi16(_mm_unpacklo_epi8(v, zero), zero);
+    _mm_storeu_ps(&data[i][0], _mm_mul_ps(_mm_cvtepi32_ps(v), scale));
+    pointer += stride;
+  }
+#else
+  for (size_t i = 0; i < num_rows; ++i) {
+    data[i].set((float)pointer[0], (float)pointer[1],
+                (float)pointer[2], (float)pointer[3]);
+    data[i] /= 255.0f;
+    pointer += stride;
+  }
+#endif
+}
+
+/**
+ *
+ */
+void GeomVertexColumn::Packer_rgba_uint8_4::
+set_data4f_n(unsigned char *pointer, size_t stride, const LVecBase4f *data,
+             size_t num_rows) {
+#ifdef PACKER_SSE2
+  const __m128 zero = _mm_setzero_ps();
+  const __m128 one = _mm_set1_ps(1.0f);
+  const __m128 scale = _mm_set1_ps(255.0f);
+  for (size_t i = 0; i < num_rows; ++i) {
+    __m128 f = _mm_loadu_ps(data[i].get_data());
+    f = _mm_mul_ps(_mm_min_ps(_mm_max_ps(f, zero), one), scale);
+    __m128i v = _mm_cvttps_epi32(f);
+    v = _mm_packus_epi16(_mm_packs_epi32(v, v), v);
+    uint32_t dword = (uint32_t)_mm_cvtsi128_si32(v);
+    memcpy(pointer, &dword, sizeof(dword));
+    pointer += stride;
+  }
+#else
+  for (size_t i = 0; i < num_rows; ++i) {
+    set_data4f(pointer, data[i]);
+    pointer += stride;
+  }
+#endif
+}
+
 /**
  *
  */
@@ -4530,6 +5204,35 @@ set_data4f(unsigned char *pointer, const LVecBase4f &data) {
   pi[3] = data[3];
 }
 
+/**
+ *
+ */
+void GeomVertexColumn::Packer_rgba_float32_4::
+get_data4f_n(LVecBase4f *data, const unsigned char *pointer, size_t stride,
+             size_t num_rows) {
+  for (size_t i = 0; i < num_rows; ++i) {
+    const PN_float32 *pi = (const PN_float32 *)pointer;
+    data[i].set(pi[0], pi[1], pi[2], pi[3]);
+    pointer += stride;
+  }
+}
+
+/**
+ *
+ */
+void GeomVertexColumn::Packer_rgba_float32_4::
+set_data4f_n(unsigned char *pointer, size_t stride, const LVecBase4f *data,
+             size_t num_rows) {
+  for (size_t i = 0; i < num_rows; ++i) {
+    PN_float32 *pi = (PN_float32 *)pointer;
+    pi[0] = data[i][0];
+    pi[1] = data[i][1];
+    pi[2] = data[i][2];
+    pi[3] = data[i][3];
+    pointer += stride;
+  }
+}
+
 /**
  *
  */
@@ -4554,3 +5257,81 @@ set_data1i(unsigned char *pointer, int data) {
   *(uint16_t *)pointer = data;
   nassertv(*(uint16_t *)pointer == data);
 }
+
+/**
+ *
+ */
+const LVecBase3f &GeomVertexColumn::Packer_octahedral_int16::
+get_data3f(const unsigned char *pointer) {
+  const int16_t *pi = (const int16_t *)pointer;
+  _v3 = GeomVertexData::unpack_octahedral(pi[0], pi[1]);
+  return _v3;
+}
+
+/**
+ *
+ */
+const LVecBase4f &GeomVertexColumn::Packer_octahedral_int16::
+get_data4f(const unsigned char *pointer) {
+  const int16_t *pi = (const int16_t *)pointer;
+  LVecBase3f v3 = GeomVertexData::unpack_octahedral(pi[0], pi[1]);
+  _v4.set(v3[0], v3[1], v3[2], 0.0f);
+  return _v4;
+}
+
+/**
+ *
+ */
+const LVecBase3d &GeomVertexColumn::Packer_octahedral_int16::
+get_data3d(const unsigned char *pointer) {
+  const int16_t *pi = (const int16_t *)pointer;
+  _v3d = LCAST(double, GeomVertexData::unpack_octahedral(pi[0], pi[1]));
+  return _v3d;
+}
+
+/**
+ *
+ */
+const LVecBase4d &GeomVertexColumn::Packer_octahedral_int16::
+get_data4d(const unsigned char *pointer) {
+  const int16_t *pi = (const int16_t *)pointer;
+  LVecBase3f v3 = GeomVertexData::unpack_octahedral(pi[0], pi[1]);
+  _v4d.set(v3[0], v3[1], v3[2], 0.0);
+  return _v4d;
+}
+
+/**
+ *
+ */
+void GeomVertexColumn::Packer_octahedral_int16::
+set_data3f(unsigned char *pointer, const LVecBase3f &data) {
+  int16_t *pi = (int16_t *)pointer;
+  GeomVertexData::pack_octahedral(data, pi[0], pi[1]);
+}
+
+/**
+ *
+ */
+void GeomVertexColumn::Packer_octahedral_int16::
+set_data4f(unsigned char *pointer, const LVecBase4f &data) {
+  int16_t *pi = (int16_t *)pointer;
+  GeomVertexData::pack_octahedral(data.get_xyz(), pi[0], pi[1]);
+}
+
+/**
+ *
+ */
+void GeomVertexColumn::Packer_octahedral_int16::
+set_data3d(unsigned char *pointer, const LVecBase3d &data) {
+  int16_t *pi = (int16_t *)pointer;
+  GeomVertexData::pack_octahedral(LCAST(float, data), pi[0], pi[1]);
+}
+
+/**
+ *
+ */
+void GeomVertexColumn::Packer_octahedral_int16::
+set_data4d(unsigned char *pointer, const LVecBase4d &data) {
+  int16_t *pi = (int16_t *)pointer;
+  GeomVertexData::pack_octahedral(LCAST(float, data.get_xyz()), pi[0], pi[1]);
+}
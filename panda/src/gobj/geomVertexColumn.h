@@ -143,6 +143,27 @@ private:
     virtual void set_data3i(unsigned char *pointer, const LVecBase3i &data);
     virtual void set_data4i(unsigned char *pointer, const LVecBase4i &data);
 
+    // These process num_rows consecutive rows, spaced stride bytes apart, at
+    // once.  The default implementations simply call the above methods for
+    // each row, but the common formats override them with tight loops.
+    virtual void get_data3f_n(LVecBase3f *data, const unsigned char *pointer,
+                              size_t stride, size_t num_rows);
+    virtual void get_data4f_n(LVecBase4f *data, const unsigned char *pointer,
+                              size_t stride, size_t num_rows);
+    virtual void get_data3d_n(LVecBase3d *data, const unsigned char *pointer,
+                              size_t stride, size_t num_rows);
+    virtual void get_data4d_n(LVecBase4d *data, const unsigned char *pointer,
+                              size_t stride, size_t num_rows);
+
+    virtual void set_data3f_n(unsigned char *pointer, size_t stride,
+                              const LVecBase3f *data, size_t num_rows);
+    virtual void set_data4f_n(unsigned char *pointer, size_t stride,
+                              const LVecBase4f *data, size_t num_rows);
+    virtual void set_data3d_n(unsigned char *pointer, size_t stride,
+                              const LVecBase3d *data, size_t num_rows);
+    virtual void set_data4d_n(unsigned char *pointer, size_t stride,
+                              const LVecBase4d *data, size_t num_rows);
+
     virtual const char *get_name() const {
       return "Packer";
     }
@@ -231,6 +252,11 @@ private:
     virtual const LVecBase3f &get_data3f(const unsigned char *pointer);
     virtual void set_data3f(unsigned char *pointer, const LVecBase3f &value);
 
+    virtual void get_data3f_n(LVecBase3f *data, const unsigned char *pointer,
+                              size_t stride, size_t num_rows);
+    virtual void set_data3f_n(unsigned char *pointer, size_t stride,
+                              const LVecBase3f *data, size_t num_rows);
+
     virtual const char *get_name() const {
       return "Packer_float32_3";
     }
@@ -251,6 +277,13 @@ private:
     virtual const LVecBase3f &get_data3f(const unsigned char *pointer);
     virtual void set_data3f(unsigned char *pointer, const LVecBase3f &value);
 
+    virtual void get_data3f_n(LVecBase3f *data, const unsigned char *pointer,
+                              size_t stride, size_t num_rows);
+    virtual void set_data3f_n(unsigned char *pointer, size_t stride,
+                              const LVecBase3f *data, size_t num_rows);
+    virtual void get_data4f_n(LVecBase4f *data, const unsigned char *pointer,
+                              size_t stride, size_t num_rows);
+
     virtual const char *get_name() const {
       return "Packer_point_float32_3";
     }
@@ -261,6 +294,11 @@ private:
     virtual const LVecBase4f &get_data4f(const unsigned char *pointer);
     virtual void set_data4f(unsigned char *pointer, const LVecBase4f &value);
 
+    virtual void get_data4f_n(LVecBase4f *data, const unsigned char *pointer,
+                              size_t stride, size_t num_rows);
+    virtual void set_data4f_n(unsigned char *pointer, size_t stride,
+                              const LVecBase4f *data, size_t num_rows);
+
     virtual const char *get_name() const {
       return "Packer_point_float32_4";
     }
@@ -383,6 +421,11 @@ private:
     virtual const LVecBase4f &get_data4f(const unsigned char *pointer);
     virtual void set_data4f(unsigned char *pointer, const LVecBase4f &value);
 
+    virtual void get_data4f_n(LVecBase4f *data, const unsigned char *pointer,
+                              size_t stride, size_t num_rows);
+    virtual void set_data4f_n(unsigned char *pointer, size_t stride,
+                              const LVecBase4f *data, size_t num_rows);
+
     virtual const char *get_name() const {
       return "Packer_argb_packed";
     }
@@ -393,6 +436,11 @@ private:
     virtual const LVecBase4f &get_data4f(const unsigned char *pointer);
     virtual void set_data4f(unsigned char *pointer, const LVecBase4f &value);
 
+    virtual void get_data4f_n(LVecBase4f *data, const unsigned char *pointer,
+                              size_t stride, size_t num_rows);
+    virtual void set_data4f_n(unsigned char *pointer, size_t stride,
+                              const LVecBase4f *data, size_t num_rows);
+
     virtual const char *get_name() const {
       return "Packer_rgba_uint8_4";
     }
@@ -403,6 +451,11 @@ private:
     virtual const LVecBase4f &get_data4f(const unsigned char *pointer);
     virtual void set_data4f(unsigned char *pointer, const LVecBase4f &value);
 
+    virtual void get_data4f_n(LVecBase4f *data, const unsigned char *pointer,
+                              size_t stride, size_t num_rows);
+    virtual void set_data4f_n(unsigned char *pointer, size_t stride,
+                              const LVecBase4f *data, size_t num_rows);
+
     virtual const char *get_name() const {
       return "Packer_rgba_float32_4";
     }
@@ -427,6 +480,26 @@ private:
     }
   };
 
+  // A C_octahedral_normal or C_octahedral_vector column holds a unit vector
+  // in octahedral encoding, in two NT_int16 components.  This decodes it to
+  // (and encodes it from) an ordinary three-component vector.
+  class Packer_octahedral_int16 final : public Packer {
+  public:
+    virtual const LVecBase3f &get_data3f(const unsigned char *pointer);
+    virtual const LVecBase4f &get_data4f(const unsigned char *pointer);
+    virtual const LVecBase3d &get_data3d(const unsigned char *pointer);
+    virtual const LVecBase4d &get_data4d(const unsigned char *pointer);
+
+    virtual void set_data3f(unsigned char *pointer, const LVecBase3f &value);
+    virtual void set_data4f(unsigned char *pointer, const LVecBase4f &value);
+    virtual void set_data3d(unsigned char *pointer, const LVecBase3d &value);
+    virtual void set_data4d(unsigned char *pointer, const LVecBase4d &value);
+
+    virtual const char *get_name() const {
+      return "Packer_octahedral_int16";
+    }
+  };
+
   friend class GeomVertexArrayFormat;
   friend class GeomVertexData;
   friend class GeomVertexReader;
@@ -12,6 +12,7 @@
  */
 
 #include "geomVertexData.h"
+#include "config_gobj.h"
 #include "geom.h"
 #include "geomVertexReader.h"
 #include "geomVertexWriter.h"
@@ -21,6 +22,16 @@
 #include "bamWriter.h"
 #include "pset.h"
 #include "indent.h"
+#include "workerThreadPool.h"
+#include "mutexHolder.h"
+#include "epvector.h"
+
+// The transform loops for 3-component float tables can make use of SIMD
+// instructions when they are available at compile time.
+#if defined(__SSE2__) || (_M_IX86_FP >= 2) || defined(_M_X64) || defined(_M_AMD64)
+#include <emmintrin.h>
+#define XFORM_SSE2
+#endif
 
 using std::ostream;
 
@@ -36,6 +47,30 @@ PStatCollector GeomVertexData::_scale_color_pcollector("*:Munge:Scale color");
 PStatCollector GeomVertexData::_set_color_pcollector("*:Munge:Set color");
 PStatCollector GeomVertexData::_animation_pcollector("*:Animation");
 
+// The number of rows that are converted at a time by the bulk conversion
+// loops below, which go through a temporary buffer on the stack.
+static const int bulk_batch_rows = 64;
+
+#ifdef XFORM_SSE2
+/**
+ * Transforms the three floats at v in place by a matrix whose rows have been
+ * loaded into r0 through r3.  Pass zero for r3 to transform a vector rather
+ * than a point.
+ */
+static INLINE void
+sse2_xform3f(float *v, __m128 r0, __m128 r1, __m128 r2, __m128 r3) {
+  __m128 result =
+    _mm_add_ps(_mm_add_ps(_mm_mul_ps(_mm_set1_ps(v[0]), r0),
+                          _mm_mul_ps(_mm_set1_ps(v[1]), r1)),
+               _mm_add_ps(_mm_mul_ps(_mm_set1_ps(v[2]), r2), r3));
+
+  // Store only the first three components, since the next value in the row
+  // follows immediately.
+  _mm_storel_pi((__m64 *)v, result);
+  _mm_store_ss(v + 2, _mm_movehl_ps(result, result));
+}
+#endif  // XFORM_SSE2
+
 
 /**
  * Constructs an invalid object.  This is only used when reading from the bam
@@ -459,6 +494,29 @@ request_resident() const {
   return resident;
 }
 
+/**
+ * Like request_resident(), but asks for any non-resident data to be brought
+ * into memory at a lower priority, since it is not needed yet.  Returns true
+ * if the vertex data is already resident.
+ */
+bool GeomVertexData::
+request_prefetch() const {
+  CDReader cdata(_cycler);
+
+  bool resident = true;
+
+  Arrays::const_iterator ai;
+  for (ai = cdata->_arrays.begin();
+       ai != cdata->_arrays.end();
+       ++ai) {
+    if (!(*ai).get_read_pointer()->request_prefetch()) {
+      resident = false;
+    }
+  }
+
+  return resident;
+}
+
 /**
  * Copies all the data from the other array into the corresponding data types
  * in this array, by matching data types name-by-name.
@@ -590,8 +648,13 @@ copy_from(const GeomVertexData *source, bool keep_data_objects,
           GeomVertexReader from(source);
           from.set_column(source_i, source_column);
 
-          while (!from.is_at_end()) {
-            to.set_data4(from.get_data4());
+          LVecBase4 buffer[bulk_batch_rows];
+          int row = 0;
+          while (row < num_rows) {
+            int batch_rows = std::min(num_rows - row, bulk_batch_rows);
+            from.get_data4_n(buffer, batch_rows);
+            to.set_data4_n(buffer, batch_rows);
+            row += batch_rows;
           }
         }
       }
@@ -774,8 +837,11 @@ convert_to(const GeomVertexFormat *new_format) const {
   }
 
   // Finally, store the cached result on the entry.
-  CDCacheWriter cdata(entry->_cycler, true, current_thread);
-  cdata->_result = new_data;
+  {
+    CDCacheWriter cdata(entry->_cycler, true, current_thread);
+    cdata->_result = new_data;
+  }
+  entry->set_num_bytes(new_data->get_num_bytes());
 
   return new_data;
 }
@@ -919,6 +985,82 @@ reverse_normals() const {
   return new_data;
 }
 
+/**
+ * Returns a new GeomVertexData whose row i is a copy of row old_rows[i] of
+ * this one.  Rows that are not listed are dropped, and rows may be listed
+ * more than once.  The rows of the TransformBlendTable and SliderTable, if
+ * any, are remapped accordingly.
+ *
+ * This is the vertex data half of vertex fetch optimization; the caller is
+ * responsible for reindexing the primitives that reference this data.  See
+ * Geom::optimize_vertex_fetch_in_place().
+ */
+PT(GeomVertexData) GeomVertexData::
+reorder_rows(const pvector<int> &old_rows, Thread *current_thread) const {
+  int num_rows = get_num_rows();
+  int new_num_rows = (int)old_rows.size();
+
+  PT(GeomVertexData) new_data = new GeomVertexData(*this);
+  new_data->unclean_set_num_rows(new_num_rows);
+
+  {
+    GeomVertexDataPipelineReader reader(this, current_thread);
+    reader.check_array_readers();
+    GeomVertexDataPipelineWriter writer(new_data, true, current_thread);
+    writer.check_array_writers();
+
+    size_t num_arrays = reader.get_num_arrays();
+    nassertr(num_arrays == (size_t)writer.get_num_arrays(), new_data);
+
+    for (size_t a = 0; a < num_arrays; ++a) {
+      const GeomVertexArrayDataHandle *array_reader = reader.get_array_reader(a);
+      GeomVertexArrayDataHandle *array_writer = writer.get_array_writer(a);
+
+      int stride = array_reader->get_array_format()->get_stride();
+      nassertr(stride == array_writer->get_array_format()->get_stride(), new_data);
+
+      for (int i = 0; i < new_num_rows; ++i) {
+        int row = old_rows[i];
+        nassertr(row >= 0 && row < num_rows, new_data);
+        array_writer->copy_subdata_from(i * stride, stride,
+                                        array_reader, row * stride, stride);
+      }
+    }
+  }
+
+  // The rows of the animation tables follow the vertices they belong to.
+  const TransformBlendTable *old_blends = get_transform_blend_table();
+  if (old_blends != nullptr) {
+    const SparseArray &rows = old_blends->get_rows();
+    SparseArray new_rows;
+    for (int i = 0; i < new_num_rows; ++i) {
+      if (rows.get_bit(old_rows[i])) {
+        new_rows.set_bit(i);
+      }
+    }
+    new_data->modify_transform_blend_table()->set_rows(new_rows);
+  }
+
+  const SliderTable *old_sliders = get_slider_table();
+  if (old_sliders != nullptr) {
+    PT(SliderTable) new_sliders = new SliderTable;
+    size_t num_sliders = old_sliders->get_num_sliders();
+    for (size_t si = 0; si < num_sliders; ++si) {
+      const SparseArray &rows = old_sliders->get_slider_rows(si);
+      SparseArray new_rows;
+      for (int i = 0; i < new_num_rows; ++i) {
+        if (rows.get_bit(old_rows[i])) {
+          new_rows.set_bit(i);
+        }
+      }
+      new_sliders->add_slider(old_sliders->get_slider(si), new_rows);
+    }
+    new_data->set_slider_table(SliderTable::register_table(new_sliders));
+  }
+
+  return new_data;
+}
+
 /**
  * Returns a GeomVertexData that represents the results of computing the
  * vertex animation on the CPU for this GeomVertexData.
@@ -1587,6 +1729,12 @@ update_animated_vertices(GeomVertexData::CData *cdata, Thread *current_thread) {
       return;
     }
 
+    if (animation_threads > 0 &&
+        do_skinning_parallel(cdata, new_data, new_format, tb_table,
+                             blend_array_index, current_thread)) {
+      return;
+    }
+
     CPT(GeomVertexArrayFormat) blend_array_format = orig_format->get_array(blend_array_index);
 
     if (blend_array_format->get_stride() == 2 &&
@@ -1770,25 +1918,251 @@ update_animated_vertices(GeomVertexData::CData *cdata, Thread *current_thread) {
 }
 
 
+/**
+ * The working state of a parallel skinning pass, shared between the jobs
+ * submitted to the animation worker threads.  Everything the jobs need is
+ * gathered up front by the calling thread, so that the jobs themselves touch
+ * nothing but the vertex memory.
+ */
+class GeomVertexData::ParallelSkinning {
+public:
+  class Column {
+  public:
+    const GeomVertexColumn *_column;
+    unsigned char *_array_data;
+    size_t _stride;
+    bool _is_vector;
+  };
+  typedef pvector<Column> Columns;
+  typedef pvector<std::pair<int, int> > Ranges;
+
+  Columns _columns;
+  pvector<PT(GeomVertexArrayDataHandle)> _handles;
+  pvector<int> _blend_indices;
+  epvector<LMatrix4> _blend_mats;
+  Ranges _ranges;
+};
+
+/**
+ * Applies the transforms of the TransformBlendTable to new_data, splitting
+ * the rows across the animation worker threads.  Returns true on success, or
+ * false if the table is too small to be worth splitting (or the threads are
+ * not available), in which case the caller should do the work itself.
+ *
+ * The blends must already have been updated.
+ */
+bool GeomVertexData::
+do_skinning_parallel(CData *cdata, GeomVertexData *new_data,
+                     const GeomVertexFormat *new_format,
+                     const TransformBlendTable *tb_table,
+                     int blend_array_index, Thread *current_thread) {
+  const SparseArray &rows = tb_table->get_rows();
+  int num_animated = rows.get_num_on_bits();
+  if (num_animated < animation_parallel_min_rows) {
+    return false;
+  }
+
+  WorkerThreadPool *pool = get_animation_pool();
+  if (pool->get_num_threads() == 0) {
+    return false;
+  }
+
+  ParallelSkinning skin;
+  int num_subranges = rows.get_num_subranges();
+  int num_blends = tb_table->get_num_blends();
+
+  // Read the blend index of every animated row up front.
+  skin._blend_indices.resize(rows.get_highest_on_bit() + 1, 0);
+  CPT(GeomVertexArrayFormat) blend_array_format = cdata->_format->get_array(blend_array_index);
+  if (blend_array_format->get_stride() == 2 &&
+      blend_array_format->get_column(0)->get_component_bytes() == 2) {
+    // The blend indices are a table of ushorts.
+    CPT(GeomVertexArrayDataHandle) blend_array_handle =
+      new GeomVertexArrayDataHandle(cdata->_arrays[blend_array_index].get_read_pointer(current_thread), current_thread);
+    const unsigned short *blendt = (const unsigned short *)blend_array_handle->get_read_pointer(true);
+    for (int i = 0; i < num_subranges; ++i) {
+      int begin = rows.get_subrange_begin(i);
+      int end = rows.get_subrange_end(i);
+      for (int j = begin; j < end; ++j) {
+        skin._blend_indices[j] = blendt[j];
+      }
+    }
+  } else {
+    GeomVertexReader blendi(this, InternalName::get_transform_blend());
+    nassertr(blendi.has_column(), false);
+    for (int i = 0; i < num_subranges; ++i) {
+      int begin = rows.get_subrange_begin(i);
+      int end = rows.get_subrange_end(i);
+      blendi.set_row_unsafe(begin);
+      for (int j = begin; j < end; ++j) {
+        skin._blend_indices[j] = blendi.get_data1i();
+      }
+    }
+  }
+
+  for (int i = 0; i < num_subranges; ++i) {
+    int begin = rows.get_subrange_begin(i);
+    int end = rows.get_subrange_end(i);
+    for (int j = begin; j < end; ++j) {
+      nassertr(skin._blend_indices[j] >= 0 &&
+               skin._blend_indices[j] < num_blends, false);
+    }
+  }
+
+  // Compute each blend matrix only once, rather than once per run of rows.
+  skin._blend_mats.resize(num_blends);
+  for (int bi = 0; bi < num_blends; ++bi) {
+    tb_table->get_blend(bi).get_blend(skin._blend_mats[bi], current_thread);
+  }
+
+  // Get a write pointer to each array that holds a column we will modify.
+  skin._handles.resize(new_format->get_num_arrays());
+  size_t num_points = new_format->get_num_points();
+  size_t num_vectors = new_format->get_num_vectors();
+  for (size_t ci = 0; ci < num_points + num_vectors; ++ci) {
+    bool is_vector = (ci >= num_points);
+    const InternalName *name = is_vector
+      ? new_format->get_vector(ci - num_points)
+      : new_format->get_point(ci);
+    int array_index = new_format->get_array_with(name);
+    nassertr(array_index >= 0, false);
+
+    PT(GeomVertexArrayDataHandle) &handle = skin._handles[array_index];
+    if (handle == nullptr) {
+      handle = new_data->modify_array_handle(array_index);
+    }
+
+    ParallelSkinning::Column column;
+    column._column = new_format->get_column(name);
+    column._array_data = handle->get_write_pointer();
+    column._stride = new_format->get_array(array_index)->get_stride();
+    column._is_vector = is_vector;
+    skin._columns.push_back(column);
+  }
+
+  // Divide the rows into a few more jobs than there are threads, so that an
+  // unlucky thread doesn't hold up the rest.
+  int num_jobs = (pool->get_num_threads() + 1) * 4;
+  int rows_per_job = std::max((num_animated + num_jobs - 1) / num_jobs, bulk_batch_rows);
+  for (int i = 0; i < num_subranges; ++i) {
+    int begin = rows.get_subrange_begin(i);
+    int end = rows.get_subrange_end(i);
+    while (begin < end) {
+      int next = std::min(begin + rows_per_job, end);
+      skin._ranges.push_back(std::pair<int, int>(begin, next));
+      begin = next;
+    }
+  }
+
+  pool->run((int)skin._ranges.size(), &skin_rows, &skin, current_thread);
+  return true;
+}
+
+/**
+ * The WorkerThreadPool job function for a parallel skinning pass.  Applies
+ * the blend transforms to one range of rows, for each of the animated
+ * columns.
+ */
+void GeomVertexData::
+skin_rows(void *user_data, int job_index, Thread *current_thread) {
+  const ParallelSkinning *skin = (const ParallelSkinning *)user_data;
+  int begin = skin->_ranges[job_index].first;
+  int end = skin->_ranges[job_index].second;
+  const int *blendt = &skin->_blend_indices[0];
+
+  for (const ParallelSkinning::Column &column : skin->_columns) {
+    int first_vertex = begin;
+    while (first_vertex < end) {
+      // Transform each series of vertices that shares the same blend index
+      // as a block.
+      int bi = blendt[first_vertex];
+      int next_vertex = first_vertex + 1;
+      while (next_vertex < end && blendt[next_vertex] == bi) {
+        ++next_vertex;
+      }
+
+      const LMatrix4 &mat = skin->_blend_mats[bi];
+      if (column._is_vector) {
+        LMatrix4 xform;
+        bool normalize = get_vector_xform(column._column, mat, xform);
+        do_transform_vector_rows(column._column, column._array_data,
+                                 column._stride, xform, normalize,
+                                 first_vertex, next_vertex);
+      } else {
+        do_transform_point_rows(column._column, column._array_data,
+                                column._stride, mat,
+                                first_vertex, next_vertex);
+      }
+
+      first_vertex = next_vertex;
+    }
+  }
+}
+
+/**
+ * Returns the pool of worker threads shared by all parallel skinning passes,
+ * creating it on first use.
+ */
+WorkerThreadPool *GeomVertexData::
+get_animation_pool() {
+  // Once the pool is created, we hold its reference count and never free it.
+  static Mutex lock("GeomVertexData::get_animation_pool");
+  static WorkerThreadPool *pool = nullptr;
+
+  MutexHolder holder(lock);
+  if (pool == nullptr) {
+    pool = new WorkerThreadPool("Animation", animation_threads);
+    pool->ref();
+  }
+  return pool;
+}
+
 /**
  * Transforms a range of vertices for one particular column, as a point.
  */
 void GeomVertexData::
 do_transform_point_column(const GeomVertexFormat *format, GeomVertexRewriter &data,
                           const LMatrix4 &mat, int begin_row, int end_row) {
+  unsigned char *array_data = data.get_array_handle()->get_write_pointer();
+  do_transform_point_rows(data.get_column(), array_data, data.get_stride(),
+                          mat, begin_row, end_row);
+}
+
+/**
+ * Transforms a range of vertices for one particular column, as a vector.
+ */
+void GeomVertexData::
+do_transform_vector_column(const GeomVertexFormat *format, GeomVertexRewriter &data,
+                           const LMatrix4 &mat, int begin_row, int end_row) {
   const GeomVertexColumn *data_column = data.get_column();
-  int num_values = data_column->get_num_values();
+
+  LMatrix4 xform;
+  bool normalize = get_vector_xform(data_column, mat, xform);
+
+  unsigned char *array_data = data.get_array_handle()->get_write_pointer();
+  do_transform_vector_rows(data_column, array_data, data.get_stride(),
+                           xform, normalize, begin_row, end_row);
+}
+
+/**
+ * Transforms a range of rows of the indicated column, as points.  array_data
+ * is the beginning of the array that contains the column.
+ *
+ * This touches nothing but the indicated memory, so it may be called from a
+ * worker thread.
+ */
+void GeomVertexData::
+do_transform_point_rows(const GeomVertexColumn *column,
+                        unsigned char *array_data, size_t stride,
+                        const LMatrix4 &mat, int begin_row, int end_row) {
+  int num_values = column->get_num_values();
+  unsigned char *datat = array_data + column->get_start() + begin_row * stride;
 
   if ((num_values == 3 || num_values == 4) &&
-      data_column->get_numeric_type() == NT_float32) {
+      column->get_numeric_type() == NT_float32) {
     // The table of points is a table of LPoint3f's or LPoint4f's.  Optimize
     // this common case.
-    GeomVertexArrayDataHandle *data_handle = data.get_array_handle();
-
-    size_t stride = data.get_stride();
     size_t num_rows = end_row - begin_row;
-    unsigned char *datat = data_handle->get_write_pointer();
-    datat += data_column->get_start() + begin_row * stride;
     LMatrix4f matf = LCAST(float, mat);
 
     if (num_values == 3) {
@@ -1798,75 +2172,74 @@ do_transform_point_column(const GeomVertexFormat *format, GeomVertexRewriter &da
     }
 
   } else if (num_values == 4) {
-    // Use the GeomVertexRewriter to adjust the 4-component points.
-
-    data.set_row_unsafe(begin_row);
-    for (int j = begin_row; j < end_row; ++j) {
-      LPoint4 vertex = data.get_data4();
-      data.set_data4(vertex * mat);
+    // Use the packer to adjust the 4-component points, a batch of rows at a
+    // time.
+    GeomVertexColumn::Packer *packer = column->_packer;
+    LVecBase4 buffer[bulk_batch_rows];
+    for (int j = begin_row; j < end_row; j += bulk_batch_rows) {
+      int batch_rows = std::min(end_row - j, bulk_batch_rows);
+#ifndef STDFLOAT_DOUBLE
+      packer->get_data4f_n(buffer, datat, stride, batch_rows);
+#else
+      packer->get_data4d_n(buffer, datat, stride, batch_rows);
+#endif
+      for (int i = 0; i < batch_rows; ++i) {
+        buffer[i] = buffer[i] * mat;
+      }
+#ifndef STDFLOAT_DOUBLE
+      packer->set_data4f_n(datat, stride, buffer, batch_rows);
+#else
+      packer->set_data4d_n(datat, stride, buffer, batch_rows);
+#endif
+      datat += batch_rows * stride;
     }
 
   } else {
-    // Use the GeomVertexRewriter to adjust the 3-component points.
-
-    data.set_row_unsafe(begin_row);
-    for (int j = begin_row; j < end_row; ++j) {
-      LPoint3 vertex = data.get_data3();
-      data.set_data3(vertex * mat);
+    // Use the packer to adjust the 3-component points, a batch of rows at a
+    // time.
+    GeomVertexColumn::Packer *packer = column->_packer;
+    LVecBase3 buffer[bulk_batch_rows];
+    for (int j = begin_row; j < end_row; j += bulk_batch_rows) {
+      int batch_rows = std::min(end_row - j, bulk_batch_rows);
+#ifndef STDFLOAT_DOUBLE
+      packer->get_data3f_n(buffer, datat, stride, batch_rows);
+#else
+      packer->get_data3d_n(buffer, datat, stride, batch_rows);
+#endif
+      for (int i = 0; i < batch_rows; ++i) {
+        buffer[i] = mat.xform_point(buffer[i]);
+      }
+#ifndef STDFLOAT_DOUBLE
+      packer->set_data3f_n(datat, stride, buffer, batch_rows);
+#else
+      packer->set_data3d_n(datat, stride, buffer, batch_rows);
+#endif
+      datat += batch_rows * stride;
     }
   }
 }
 
 /**
- * Transforms a range of vertices for one particular column, as a vector.
+ * Transforms a range of rows of the indicated column, as vectors, by the
+ * matrix returned from get_vector_xform().  array_data is the beginning of
+ * the array that contains the column.
+ *
+ * This touches nothing but the indicated memory, so it may be called from a
+ * worker thread.
  */
 void GeomVertexData::
-do_transform_vector_column(const GeomVertexFormat *format, GeomVertexRewriter &data,
-                           const LMatrix4 &mat, int begin_row, int end_row) {
-  const GeomVertexColumn *data_column = data.get_column();
-  int num_values = data_column->get_num_values();
-
-  LMatrix4 xform;
-  bool normalize = false;
-  if (data_column->get_contents() == C_normal) {
-    // This is to preserve perpendicularity to the surface.
-    LVecBase3 scale_sq(mat.get_row3(0).length_squared(),
-                       mat.get_row3(1).length_squared(),
-                       mat.get_row3(2).length_squared());
-    if (IS_THRESHOLD_EQUAL(scale_sq[0], scale_sq[1], 2.0e-3f) &&
-        IS_THRESHOLD_EQUAL(scale_sq[0], scale_sq[2], 2.0e-3f)) {
-      // There is a uniform scale.
-      LVecBase3 scale, shear, hpr;
-      if (IS_THRESHOLD_EQUAL(scale_sq[0], 1, 2.0e-3f)) {
-        // No scale to worry about.
-        xform = mat;
-      } else if (decompose_matrix(mat.get_upper_3(), scale, shear, hpr)) {
-        // Make a new matrix with scale/translate taken out of the equation.
-        compose_matrix(xform, LVecBase3(1, 1, 1), shear, hpr, LVecBase3::zero());
-      } else {
-        normalize = true;
-      }
-    } else {
-      // There is a non-uniform scale, so we need to do all this to preserve
-      // orthogonality to the surface.
-      xform.invert_from(mat);
-      xform.transpose_in_place();
-      normalize = true;
-    }
-  } else {
-    xform = mat;
-  }
+do_transform_vector_rows(const GeomVertexColumn *column,
+                         unsigned char *array_data, size_t stride,
+                         const LMatrix4 &xform, bool normalize,
+                         int begin_row, int end_row) {
+  int num_values = column->get_num_values();
+  unsigned char *datat = array_data + column->get_start() + begin_row * stride;
 
   if ((num_values == 3 || num_values == 4) &&
-      data_column->get_numeric_type() == NT_float32) {
+      column->get_numeric_type() == NT_float32) {
     // The table of vectors is a table of LVector3f's or LVector4f's.
     // Optimize this common case.
-    GeomVertexArrayDataHandle *data_handle = data.get_array_handle();
-
-    size_t stride = data.get_stride();
     size_t num_rows = end_row - begin_row;
-    unsigned char *datat = data_handle->get_write_pointer();
-    datat += data_column->get_start() + begin_row * stride;
     LMatrix4f matf = LCAST(float, xform);
 
     if (normalize) {
@@ -1878,23 +2251,75 @@ do_transform_vector_column(const GeomVertexFormat *format, GeomVertexRewriter &d
     }
 
   } else {
-    // Use the GeomVertexRewriter to transform the vectors.
-    data.set_row_unsafe(begin_row);
-
-    if (normalize) {
-      for (int j = begin_row; j < end_row; ++j) {
-        LVector3 vector = data.get_data3();
-        vector *= xform;
-        vector.normalize();
-        data.set_data3(vector);
+    // Use the packer to transform the vectors, a batch of rows at a time.
+    GeomVertexColumn::Packer *packer = column->_packer;
+    LVecBase3 buffer[bulk_batch_rows];
+    for (int j = begin_row; j < end_row; j += bulk_batch_rows) {
+      int batch_rows = std::min(end_row - j, bulk_batch_rows);
+#ifndef STDFLOAT_DOUBLE
+      packer->get_data3f_n(buffer, datat, stride, batch_rows);
+#else
+      packer->get_data3d_n(buffer, datat, stride, batch_rows);
+#endif
+      for (int i = 0; i < batch_rows; ++i) {
+        LVector3 vector = xform.xform_vec(buffer[i]);
+        if (normalize) {
+          vector.normalize();
+        }
+        buffer[i] = vector;
       }
+#ifndef STDFLOAT_DOUBLE
+      packer->set_data3f_n(datat, stride, buffer, batch_rows);
+#else
+      packer->set_data3d_n(datat, stride, buffer, batch_rows);
+#endif
+      datat += batch_rows * stride;
+    }
+  }
+}
+
+/**
+ * Computes the matrix by which the vectors in the indicated column should be
+ * transformed when the vertices are transformed by mat.  For normals, this
+ * takes out any scale, so that they remain perpendicular to the surface.
+ * Returns true if the vectors also need to be normalized afterwards.
+ */
+bool GeomVertexData::
+get_vector_xform(const GeomVertexColumn *column, const LMatrix4 &mat,
+                 LMatrix4 &xform) {
+  if (column->get_contents() != C_normal &&
+      column->get_contents() != C_octahedral_normal) {
+    xform = mat;
+    return false;
+  }
+
+  // This is to preserve perpendicularity to the surface.
+  LVecBase3 scale_sq(mat.get_row3(0).length_squared(),
+                     mat.get_row3(1).length_squared(),
+                     mat.get_row3(2).length_squared());
+  if (IS_THRESHOLD_EQUAL(scale_sq[0], scale_sq[1], 2.0e-3f) &&
+      IS_THRESHOLD_EQUAL(scale_sq[0], scale_sq[2], 2.0e-3f)) {
+    // There is a uniform scale.
+    LVecBase3 scale, shear, hpr;
+    if (IS_THRESHOLD_EQUAL(scale_sq[0], 1, 2.0e-3f)) {
+      // No scale to worry about.
+      xform = mat;
+      return false;
+    } else if (decompose_matrix(mat.get_upper_3(), scale, shear, hpr)) {
+      // Make a new matrix with scale/translate taken out of the equation.
+      compose_matrix(xform, LVecBase3(1, 1, 1), shear, hpr, LVecBase3::zero());
+      return false;
     } else {
-      for (int j = begin_row; j < end_row; ++j) {
-        LVector3 vector = data.get_data3();
-        data.set_data3(vector * xform);
-      }
+      xform = mat;
+      return true;
     }
   }
+
+  // There is a non-uniform scale, so we need to do all this to preserve
+  // orthogonality to the surface.
+  xform.invert_from(mat);
+  xform.transpose_in_place();
+  return true;
 }
 
 /**
@@ -1904,12 +2329,23 @@ do_transform_vector_column(const GeomVertexFormat *format, GeomVertexRewriter &d
 void GeomVertexData::
 table_xform_point3f(unsigned char *datat, size_t num_rows, size_t stride,
                     const LMatrix4f &matf) {
+#ifdef XFORM_SSE2
+  const float *m = matf.get_data();
+  __m128 r0 = _mm_loadu_ps(m);
+  __m128 r1 = _mm_loadu_ps(m + 4);
+  __m128 r2 = _mm_loadu_ps(m + 8);
+  __m128 r3 = _mm_loadu_ps(m + 12);
+  for (size_t i = 0; i < num_rows; ++i) {
+    sse2_xform3f((float *)(&datat[i * stride]), r0, r1, r2, r3);
+  }
+#else
   // We don't bother checking for the unaligned case here, because in practice
   // it doesn't matter with a 3-component point.
   for (size_t i = 0; i < num_rows; ++i) {
     LPoint3f &vertex = *(LPoint3f *)(&datat[i * stride]);
     vertex *= matf;
   }
+#endif
 }
 
 /**
@@ -1919,6 +2355,18 @@ table_xform_point3f(unsigned char *datat, size_t num_rows, size_t stride,
 void GeomVertexData::
 table_xform_normal3f(unsigned char *datat, size_t num_rows, size_t stride,
                      const LMatrix4f &matf) {
+#ifdef XFORM_SSE2
+  const float *m = matf.get_data();
+  __m128 r0 = _mm_loadu_ps(m);
+  __m128 r1 = _mm_loadu_ps(m + 4);
+  __m128 r2 = _mm_loadu_ps(m + 8);
+  __m128 r3 = _mm_setzero_ps();
+  for (size_t i = 0; i < num_rows; ++i) {
+    LNormalf &vertex = *(LNormalf *)(&datat[i * stride]);
+    sse2_xform3f(&vertex[0], r0, r1, r2, r3);
+    vertex.normalize();
+  }
+#else
   // We don't bother checking for the unaligned case here, because in practice
   // it doesn't matter with a 3-component vector.
   for (size_t i = 0; i < num_rows; ++i) {
@@ -1926,6 +2374,7 @@ table_xform_normal3f(unsigned char *datat, size_t num_rows, size_t stride,
     vertex *= matf;
     vertex.normalize();
   }
+#endif
 }
 
 /**
@@ -1935,12 +2384,23 @@ table_xform_normal3f(unsigned char *datat, size_t num_rows, size_t stride,
 void GeomVertexData::
 table_xform_vector3f(unsigned char *datat, size_t num_rows, size_t stride,
                      const LMatrix4f &matf) {
+#ifdef XFORM_SSE2
+  const float *m = matf.get_data();
+  __m128 r0 = _mm_loadu_ps(m);
+  __m128 r1 = _mm_loadu_ps(m + 4);
+  __m128 r2 = _mm_loadu_ps(m + 8);
+  __m128 r3 = _mm_setzero_ps();
+  for (size_t i = 0; i < num_rows; ++i) {
+    sse2_xform3f((float *)(&datat[i * stride]), r0, r1, r2, r3);
+  }
+#else
   // We don't bother checking for the unaligned case here, because in practice
   // it doesn't matter with a 3-component vector.
   for (size_t i = 0; i < num_rows; ++i) {
     LVector3f &vertex = *(LVector3f *)(&datat[i * stride]);
     vertex *= matf;
   }
+#endif
 }
 
 /**
@@ -2487,6 +2947,16 @@ set_num_rows(int n) {
         pointer += stride;
       }
       break;
+
+    case NT_float16:
+      while (pointer < stop) {
+        uint16_t *pi = (uint16_t *)pointer;
+        for (int i = 0; i < num_values; i++) {
+          pi[i] = 0x3c00;
+        }
+        pointer += stride;
+      }
+      break;
     }
   }
 
@@ -42,6 +42,7 @@
 class FactoryParams;
 class GeomVertexColumn;
 class GeomVertexRewriter;
+class WorkerThreadPool;
 
 /**
  * This defines the actual numeric vertex data stored in a Geom, in the
@@ -135,6 +136,7 @@ PUBLISHED:
   MAKE_PROPERTY(modified, get_modified);
 
   bool request_resident() const;
+  bool request_prefetch() const;
 
   void copy_from(const GeomVertexData *source, bool keep_data_objects,
                  Thread *current_thread = Thread::get_current_thread());
@@ -184,6 +186,16 @@ public:
   static INLINE float unpack_ufloat_b(uint32_t data);
   static INLINE float unpack_ufloat_c(uint32_t data);
 
+  static INLINE uint16_t pack_half(float data);
+  static INLINE float unpack_half(uint16_t data);
+
+  static INLINE void pack_octahedral(const LVecBase3f &vec,
+                                     int16_t &a, int16_t &b);
+  static INLINE LVecBase3f unpack_octahedral(int16_t a, int16_t b);
+
+  PT(GeomVertexData) reorder_rows(const pvector<int> &old_rows,
+                                  Thread *current_thread = Thread::get_current_thread()) const;
+
 private:
   static void do_set_color(GeomVertexData *vdata, const LColor &color);
 
@@ -339,6 +351,25 @@ private:
                                  const LMatrix4 &mat, int begin_row, int end_row);
   void do_transform_vector_column(const GeomVertexFormat *format, GeomVertexRewriter &data,
                                   const LMatrix4 &mat, int begin_row, int end_row);
+  static void do_transform_point_rows(const GeomVertexColumn *column,
+                                      unsigned char *array_data, size_t stride,
+                                      const LMatrix4 &mat,
+                                      int begin_row, int end_row);
+  static void do_transform_vector_rows(const GeomVertexColumn *column,
+                                       unsigned char *array_data, size_t stride,
+                                       const LMatrix4 &xform, bool normalize,
+                                       int begin_row, int end_row);
+  static bool get_vector_xform(const GeomVertexColumn *column,
+                               const LMatrix4 &mat, LMatrix4 &xform);
+
+  class ParallelSkinning;
+  bool do_skinning_parallel(CData *cdata, GeomVertexData *new_data,
+                            const GeomVertexFormat *new_format,
+                            const TransformBlendTable *tb_table,
+                            int blend_array_index, Thread *current_thread);
+  static void skin_rows(void *user_data, int job_index, Thread *current_thread);
+  static WorkerThreadPool *get_animation_pool();
+
   static void table_xform_point3f(unsigned char *datat, size_t num_rows,
                                   size_t stride, const LMatrix4f &matf);
   static void table_xform_normal3f(unsigned char *datat, size_t num_rows,
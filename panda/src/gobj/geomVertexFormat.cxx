@@ -746,6 +746,8 @@ do_register() {
 
     case C_vector:
     case C_normal:
+    case C_octahedral_normal:
+    case C_octahedral_vector:
       // It's a vector.
       _vectors.push_back(column->get_name());
       break;
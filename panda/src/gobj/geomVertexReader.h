@@ -119,6 +119,15 @@ PUBLISHED:
   INLINE const LVecBase3i &get_data3i();
   INLINE const LVecBase4i &get_data4i();
 
+public:
+  INLINE void get_data3f_n(LVecBase3f *data, int num_rows);
+  INLINE void get_data4f_n(LVecBase4f *data, int num_rows);
+  INLINE void get_data3d_n(LVecBase3d *data, int num_rows);
+  INLINE void get_data4d_n(LVecBase4d *data, int num_rows);
+  INLINE void get_data3_n(LVecBase3 *data, int num_rows);
+  INLINE void get_data4_n(LVecBase4 *data, int num_rows);
+
+PUBLISHED:
   void output(std::ostream &out) const;
 
 protected:
@@ -130,6 +139,7 @@ private:
   INLINE bool set_pointer(int row);
   INLINE void quick_set_pointer(int row);
   INLINE const unsigned char *inc_pointer();
+  INLINE const unsigned char *inc_pointer_n(int num_rows);
 
   bool set_vertex_column(int array, const GeomVertexColumn *column,
                          const GeomVertexDataPipelineReader *data_reader);
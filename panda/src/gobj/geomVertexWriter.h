@@ -174,6 +174,15 @@ PUBLISHED:
   INLINE void add_data4i(int a, int b, int c, int d);
   INLINE void add_data4i(const LVecBase4i &data);
 
+public:
+  INLINE void set_data3f_n(const LVecBase3f *data, int num_rows);
+  INLINE void set_data4f_n(const LVecBase4f *data, int num_rows);
+  INLINE void set_data3d_n(const LVecBase3d *data, int num_rows);
+  INLINE void set_data4d_n(const LVecBase4d *data, int num_rows);
+  INLINE void set_data3_n(const LVecBase3 *data, int num_rows);
+  INLINE void set_data4_n(const LVecBase4 *data, int num_rows);
+
+PUBLISHED:
   void output(std::ostream &out) const;
 
 protected:
@@ -187,6 +196,7 @@ private:
   INLINE void set_pointer(int row);
   INLINE void quick_set_pointer(int row);
   INLINE unsigned char *inc_pointer();
+  INLINE unsigned char *inc_pointer_n(int num_rows);
   INLINE unsigned char *inc_add_pointer();
 
   bool set_vertex_column(int array, const GeomVertexColumn *column,
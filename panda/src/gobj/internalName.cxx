@@ -35,6 +35,7 @@ PT(InternalName) InternalName::_aspect_ratio;
 PT(InternalName) InternalName::_transform_blend;
 PT(InternalName) InternalName::_transform_weight;
 PT(InternalName) InternalName::_transform_index;
+PT(InternalName) InternalName::_instance_matrix;
 PT(InternalName) InternalName::_index;
 PT(InternalName) InternalName::_world;
 PT(InternalName) InternalName::_camera;
@@ -86,6 +86,7 @@ PUBLISHED:
   INLINE static PT(InternalName) get_transform_blend();
   INLINE static PT(InternalName) get_transform_weight();
   INLINE static PT(InternalName) get_transform_index();
+  INLINE static PT(InternalName) get_instance_matrix();
   INLINE static PT(InternalName) get_morph(InternalName *column, const std::string &slider);
   INLINE static PT(InternalName) get_index();
   INLINE static PT(InternalName) get_world();
@@ -136,6 +137,7 @@ private:
   static PT(InternalName) _transform_blend;
   static PT(InternalName) _transform_weight;
   static PT(InternalName) _transform_index;
+  static PT(InternalName) _instance_matrix;
   static PT(InternalName) _index;
   static PT(InternalName) _world;
   static PT(InternalName) _camera;
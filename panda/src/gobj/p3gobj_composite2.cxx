@@ -1,6 +1,7 @@
 #include "paramTexture.cxx"
 #include "perspectiveLens.cxx"
 #include "preparedGraphicsObjects.cxx"
+#include "quadricSimplifier.cxx"
 #include "queryContext.cxx"
 #include "samplerContext.cxx"
 #include "samplerState.cxx"
@@ -0,0 +1,366 @@
+/**
+ * PANDA 3D SOFTWARE
+ * Copyright (c) Carnegie Mellon University.  All rights reserved.
+ *
+ * All use of this software is subject to the terms of the revised BSD
+ * license.  You should have received a copy of this license along
+ * with this source code in a file named "LICENSE."
+ *
+ * @file quadricSimplifier.cxx
+ * @author blablabla94
+ * @date 2026-10-16
+ */
+
+#include "quadricSimplifier.h"
+#include "geomPrimitive.h"
+#include "geomVertexData.h"
+#include "geomVertexReader.h"
+#include "pmap.h"
+
+#include <algorithm>
+
+// Open borders are held in place by planes perpendicular to the border
+// triangle, weighted this much more heavily than the surface itself.
+static const double border_weight = 10.0;
+
+// A collapse may not rotate any remaining triangle by more than about 75
+// degrees.
+static const double min_normal_dot = 0.25;
+
+/**
+ * Reads the triangles of the indicated GeomTriangles, which must be indexed,
+ * and the positions of the vertices they reference.
+ */
+QuadricSimplifier::
+QuadricSimplifier(const GeomPrimitive *triangles,
+                  const GeomVertexData *vertex_data) {
+  int num_indices = triangles->get_num_vertices();
+  num_indices -= num_indices % 3;
+  int num_vertices = triangles->get_max_vertex() + 1;
+  nassertv(num_vertices <= vertex_data->get_num_rows());
+
+  // Degenerate triangles don't contribute anything, and would confuse the
+  // adjacency tables.
+  _indices.reserve(num_indices);
+  {
+    GeomVertexReader index(triangles->get_vertices(), 0);
+    for (int i = 0; i < num_indices; i += 3) {
+      int a = index.get_data1i();
+      int b = index.get_data1i();
+      int c = index.get_data1i();
+      if (a != b && b != c && c != a) {
+        _indices.push_back(a);
+        _indices.push_back(b);
+        _indices.push_back(c);
+      }
+    }
+  }
+  num_indices = (int)_indices.size();
+
+  _positions.resize(num_vertices);
+  {
+    GeomVertexReader vertex(vertex_data, InternalName::get_vertex());
+    for (int v = 0; v < num_vertices; ++v) {
+      _positions[v] = LCAST(double, vertex.get_data3());
+    }
+  }
+
+  if (vertex_data->has_column(InternalName::get_normal())) {
+    _normals.resize(num_vertices);
+    GeomVertexReader normal(vertex_data, InternalName::get_normal());
+    for (int v = 0; v < num_vertices; ++v) {
+      _normals[v] = LCAST(double, normal.get_data3());
+    }
+  }
+
+  build_adjacency();
+
+  // Count the vertex rows at each position, to find the seams.
+  pmap<LPoint3d, int> rows_at_position;
+  for (int v = 0; v < num_vertices; ++v) {
+    if (_tri_start[v + 1] != _tri_start[v]) {
+      ++rows_at_position[_positions[v]];
+    }
+  }
+
+  // Classify the vertices by the border edges that touch them.
+  pvector<int> num_border_edges(num_vertices, 0);
+  for (int i = 0; i < num_indices; ++i) {
+    int a = _indices[i];
+    int b = _indices[i - (i % 3) + ((i + 1) % 3)];
+    if (!has_edge(b, a)) {
+      ++num_border_edges[a];
+      ++num_border_edges[b];
+    }
+  }
+
+  _kinds.resize(num_vertices, VK_locked);
+  for (int v = 0; v < num_vertices; ++v) {
+    if (_tri_start[v + 1] == _tri_start[v] ||
+        rows_at_position[_positions[v]] != 1) {
+      continue;
+    }
+    if (num_border_edges[v] == 0) {
+      _kinds[v] = VK_manifold;
+    } else if (num_border_edges[v] == 2) {
+      _kinds[v] = VK_border;
+    }
+  }
+
+  // Accumulate the planes of the triangles around each vertex, weighted by
+  // area, and the planes that keep the borders in place.
+  _quadrics.resize(num_vertices);
+  for (int i = 0; i < num_indices; i += 3) {
+    const int *tri = &_indices[i];
+    const LPoint3d &p0 = _positions[tri[0]];
+    LVector3d normal = (_positions[tri[1]] - p0).cross(_positions[tri[2]] - p0);
+    double area = normal.length();
+    if (area == 0.0) {
+      continue;
+    }
+    normal /= area;
+
+    Quadric quadric;
+    quadric.add_plane(normal, -normal.dot(p0), area * 0.5);
+    for (int k = 0; k < 3; ++k) {
+      _quadrics[tri[k]] += quadric;
+    }
+
+    for (int k = 0; k < 3; ++k) {
+      int a = tri[k];
+      int b = tri[(k + 1) % 3];
+      if (!has_edge(b, a)) {
+        LVector3d edge = _positions[b] - _positions[a];
+        LVector3d border_normal = edge.cross(normal);
+        double length_sq = border_normal.length_squared();
+        if (length_sq != 0.0) {
+          border_normal /= csqrt(length_sq);
+          Quadric border;
+          border.add_plane(border_normal, -border_normal.dot(_positions[a]),
+                           edge.length_squared() * border_weight);
+          _quadrics[a] += border;
+          _quadrics[b] += border;
+        }
+      }
+    }
+  }
+}
+
+/**
+ * Collapses edges until the mesh has no more than the indicated number of
+ * triangles, or until no edge can be collapsed without folding over a
+ * triangle or breaking a seam.  Returns the number of triangles remaining.
+ *
+ * The collapses are made in passes: each pass sorts all of the candidate
+ * collapses by error, and performs as many of the cheapest ones as it can
+ * without two of them touching the same triangle.
+ */
+int QuadricSimplifier::
+simplify(int target_num_triangles) {
+  int num_vertices = (int)_positions.size();
+  pvector<Collapse> collapses;
+  pvector<bool> touched;
+
+  while (get_num_triangles() > target_num_triangles) {
+    int num_indices = (int)_indices.size();
+
+    collapses.clear();
+    for (int i = 0; i < num_indices; ++i) {
+      int a = _indices[i];
+      int b = _indices[i - (i % 3) + ((i + 1) % 3)];
+      for (int dir = 0; dir < 2; ++dir) {
+        int from = dir ? b : a;
+        int to = dir ? a : b;
+        if (_kinds[from] == VK_locked ||
+            (_kinds[from] == VK_border && !is_border_edge(from, to))) {
+          continue;
+        }
+        Quadric quadric = _quadrics[from];
+        quadric += _quadrics[to];
+
+        Collapse collapse;
+        collapse._error = quadric.get_error(_positions[to]);
+        collapse._from = from;
+        collapse._to = to;
+        collapses.push_back(collapse);
+      }
+    }
+    std::sort(collapses.begin(), collapses.end());
+
+    pvector<int> remap(num_vertices);
+    for (int v = 0; v < num_vertices; ++v) {
+      remap[v] = v;
+    }
+    touched.assign(num_vertices, false);
+
+    int num_triangles = get_num_triangles();
+    int num_collapsed = 0;
+    for (const Collapse &collapse : collapses) {
+      if (num_triangles <= target_num_triangles) {
+        break;
+      }
+      int from = collapse._from;
+      int to = collapse._to;
+      if (touched[from] || touched[to] || !can_collapse(from, to)) {
+        continue;
+      }
+
+      remap[from] = to;
+      _quadrics[to] += _quadrics[from];
+      ++num_collapsed;
+
+      // Don't let another collapse in this pass change the triangles we
+      // have just checked.
+      for (int ti = _tri_start[from]; ti < _tri_start[from + 1]; ++ti) {
+        const int *tri = &_indices[_vertex_tris[ti] * 3];
+        touched[tri[0]] = touched[tri[1]] = touched[tri[2]] = true;
+        if (tri[0] == to || tri[1] == to || tri[2] == to) {
+          --num_triangles;
+        }
+      }
+    }
+
+    if (num_collapsed == 0) {
+      break;
+    }
+
+    // Apply the collapses, dropping the triangles that have become
+    // degenerate.
+    int write = 0;
+    for (int i = 0; i < num_indices; i += 3) {
+      int a = remap[_indices[i]];
+      int b = remap[_indices[i + 1]];
+      int c = remap[_indices[i + 2]];
+      if (a != b && b != c && c != a) {
+        _indices[write++] = a;
+        _indices[write++] = b;
+        _indices[write++] = c;
+      }
+    }
+    _indices.resize(write);
+
+    build_adjacency();
+  }
+
+  return get_num_triangles();
+}
+
+/**
+ * Rebuilds the tables of the triangles around each vertex and of the directed
+ * edges, from the current list of triangles.
+ */
+void QuadricSimplifier::
+build_adjacency() {
+  int num_vertices = (int)_positions.size();
+  int num_indices = (int)_indices.size();
+
+  _tri_start.assign(num_vertices + 1, 0);
+  for (int i = 0; i < num_indices; ++i) {
+    ++_tri_start[_indices[i] + 1];
+  }
+  for (int v = 0; v < num_vertices; ++v) {
+    _tri_start[v + 1] += _tri_start[v];
+  }
+
+  _vertex_tris.resize(num_indices);
+  pvector<int> fill(&_tri_start[0], &_tri_start[0] + num_vertices);
+  for (int i = 0; i < num_indices; ++i) {
+    _vertex_tris[fill[_indices[i]]++] = i / 3;
+  }
+
+  _edges.resize(num_indices);
+  for (int i = 0; i < num_indices; ++i) {
+    int a = _indices[i];
+    int b = _indices[i - (i % 3) + ((i + 1) % 3)];
+    _edges[i] = ((uint64_t)(uint32_t)a << 32) | (uint32_t)b;
+  }
+  std::sort(_edges.begin(), _edges.end());
+}
+
+/**
+ * Returns true if the vertex from can be moved onto the vertex to without
+ * changing the topology of the mesh or folding over any of the remaining
+ * triangles around it.
+ */
+bool QuadricSimplifier::
+can_collapse(int from, int to) const {
+  // The only vertices that may be adjacent to both ends of the edge are the
+  // ones opposite it; otherwise the collapse would pinch the surface.
+  pvector<int> from_neighbors;
+  int num_shared = 0;
+  for (int ti = _tri_start[from]; ti < _tri_start[from + 1]; ++ti) {
+    const int *tri = &_indices[_vertex_tris[ti] * 3];
+    bool shared = (tri[0] == to || tri[1] == to || tri[2] == to);
+    if (shared) {
+      ++num_shared;
+    }
+    for (int k = 0; k < 3; ++k) {
+      if (tri[k] != from && tri[k] != to) {
+        from_neighbors.push_back(tri[k]);
+      }
+    }
+
+    if (!shared) {
+      // Make sure the triangle doesn't flip over.
+      LPoint3d p[3], q[3];
+      for (int k = 0; k < 3; ++k) {
+        p[k] = _positions[tri[k]];
+        q[k] = (tri[k] == from) ? _positions[to] : p[k];
+      }
+      LVector3d old_normal = (p[1] - p[0]).cross(p[2] - p[0]);
+      LVector3d new_normal = (q[1] - q[0]).cross(q[2] - q[0]);
+      double limit = min_normal_dot * csqrt(old_normal.length_squared() * new_normal.length_squared());
+      if (old_normal.dot(new_normal) <= limit) {
+        return false;
+      }
+
+      // Small rotations can add up over many collapses, so also keep the
+      // triangle facing the same way as the vertex normals, if there are any.
+      if (!_normals.empty()) {
+        for (int k = 0; k < 3; ++k) {
+          int v = (tri[k] == from) ? to : tri[k];
+          if (new_normal.dot(_normals[v]) <= 0.0) {
+            return false;
+          }
+        }
+      }
+    }
+  }
+  if (num_shared == 0) {
+    return false;
+  }
+
+  std::sort(from_neighbors.begin(), from_neighbors.end());
+  from_neighbors.erase(std::unique(from_neighbors.begin(), from_neighbors.end()),
+                       from_neighbors.end());
+
+  pvector<int> to_neighbors;
+  for (int ti = _tri_start[to]; ti < _tri_start[to + 1]; ++ti) {
+    const int *tri = &_indices[_vertex_tris[ti] * 3];
+    for (int k = 0; k < 3; ++k) {
+      if (tri[k] != from && tri[k] != to) {
+        to_neighbors.push_back(tri[k]);
+      }
+    }
+  }
+  std::sort(to_neighbors.begin(), to_neighbors.end());
+  to_neighbors.erase(std::unique(to_neighbors.begin(), to_neighbors.end()),
+                     to_neighbors.end());
+
+  int num_common = 0;
+  pvector<int>::const_iterator fi = from_neighbors.begin();
+  pvector<int>::const_iterator ti = to_neighbors.begin();
+  while (fi != from_neighbors.end() && ti != to_neighbors.end()) {
+    if (*fi < *ti) {
+      ++fi;
+    } else if (*ti < *fi) {
+      ++ti;
+    } else {
+      ++num_common;
+      ++fi;
+      ++ti;
+    }
+  }
+
+  return num_common == num_shared;
+}
@@ -0,0 +1,99 @@
+/**
+ * PANDA 3D SOFTWARE
+ * Copyright (c) Carnegie Mellon University.  All rights reserved.
+ *
+ * All use of this software is subject to the terms of the revised BSD
+ * license.  You should have received a copy of this license along
+ * with this source code in a file named "LICENSE."
+ *
+ * @file quadricSimplifier.h
+ * @author blablabla94
+ * @date 2026-10-16
+ */
+
+#ifndef QUADRICSIMPLIFIER_H
+#define QUADRICSIMPLIFIER_H
+
+#include "pandabase.h"
+#include "luse.h"
+#include "pvector.h"
+
+class GeomPrimitive;
+class GeomVertexData;
+
+/**
+ * Reduces the number of triangles in an indexed triangle list by repeatedly
+ * collapsing the edge that introduces the least error, as measured by the
+ * quadric error metric of Garland and Heckbert.  This is the implementation
+ * of GeomPrimitive::simplify().
+ *
+ * Each collapse moves a vertex onto one of its neighbors rather than onto a
+ * newly computed position, so no vertices are created or modified, and the
+ * normals, texture coordinates and other columns of the vertices that remain
+ * are preserved exactly.  Vertices that share their position with another
+ * vertex row--as happens along UV seams and normal creases--are locked in
+ * place so that the seams don't tear open, and vertices on an open border
+ * may only slide along that border.
+ */
+class EXPCL_PANDA_GOBJ QuadricSimplifier {
+public:
+  QuadricSimplifier(const GeomPrimitive *triangles,
+                    const GeomVertexData *vertex_data);
+
+  int simplify(int target_num_triangles);
+
+  INLINE int get_num_triangles() const;
+  INLINE const pvector<int> &get_indices() const;
+
+private:
+  enum VertexKind {
+    VK_manifold,
+    VK_border,
+    VK_locked,
+  };
+
+  // A symmetric 4x4 matrix measuring the sum of squared distances of a point
+  // to a set of planes.
+  class Quadric {
+  public:
+    INLINE Quadric();
+    INLINE void add_plane(const LVector3d &normal, double dist, double weight);
+    INLINE void operator += (const Quadric &other);
+    INLINE double get_error(const LPoint3d &point) const;
+
+    double _a00, _a01, _a02, _a11, _a12, _a22;
+    double _b0, _b1, _b2;
+    double _c;
+  };
+
+  class Collapse {
+  public:
+    INLINE bool operator < (const Collapse &other) const;
+
+    double _error;
+    int _from;
+    int _to;
+  };
+
+  void build_adjacency();
+  INLINE bool has_edge(int a, int b) const;
+  INLINE bool is_border_edge(int a, int b) const;
+  bool can_collapse(int from, int to) const;
+
+  pvector<int> _indices;
+  pvector<LPoint3d> _positions;
+  pvector<LVector3d> _normals;
+  pvector<VertexKind> _kinds;
+  pvector<Quadric> _quadrics;
+
+  // Rebuilt on every pass: the live triangles around each vertex, in the
+  // order of a flat list with an offset per vertex, and the sorted list of
+  // directed edges.
+  pvector<int> _tri_start;
+  pvector<int> _vertex_tris;
+  pvector<uint64_t> _edges;
+};
+
+#include "quadricSimplifier.I"
+
+#endif
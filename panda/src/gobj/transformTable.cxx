@@ -14,6 +14,7 @@
 #include "transformTable.h"
 #include "bamReader.h"
 #include "bamWriter.h"
+#include "lightMutexHolder.h"
 
 TypeHandle TransformTable::_type_handle;
 
@@ -55,6 +56,58 @@ TransformTable::
   }
 }
 
+/**
+ * Fills the indicated array with the current matrix of each of the
+ * transforms in the table, for uploading to the graphics card.  If the array
+ * is longer than the table, the remaining entries are filled with the
+ * identity matrix.
+ *
+ * For a registered table, the matrices are only recomputed when one of the
+ * transforms has changed, so all of the Geoms that share a table (such as the
+ * parts of one Character) reuse the same matrices each frame.
+ */
+void TransformTable::
+get_matrices(LMatrix4f *matrices, size_t num_matrices,
+             Thread *current_thread) const {
+  size_t num_transforms = std::min(num_matrices, _transforms.size());
+
+  if (!_is_registered) {
+    // An unregistered table isn't told when its transforms change, so we
+    // can't cache anything.
+    for (size_t i = 0; i < num_transforms; ++i) {
+#ifdef STDFLOAT_DOUBLE
+      LMatrix4 matrix;
+      _transforms[i]->get_matrix(matrix);
+      matrices[i] = LCAST(float, matrix);
+#else
+      _transforms[i]->get_matrix(matrices[i]);
+#endif
+    }
+
+  } else {
+    LightMutexHolder holder(_matrices_lock);
+    UpdateSeq modified = get_modified(current_thread);
+    if (_matrices_modified != modified || _matrices.size() != _transforms.size()) {
+      _matrices.resize(_transforms.size());
+      for (size_t i = 0; i < _transforms.size(); ++i) {
+#ifdef STDFLOAT_DOUBLE
+        LMatrix4 matrix;
+        _transforms[i]->get_matrix(matrix);
+        _matrices[i] = LCAST(float, matrix);
+#else
+        _transforms[i]->get_matrix(_matrices[i]);
+#endif
+      }
+      _matrices_modified = modified;
+    }
+    std::copy(_matrices.begin(), _matrices.begin() + num_transforms, matrices);
+  }
+
+  for (size_t i = num_transforms; i < num_matrices; ++i) {
+    matrices[i] = LMatrix4f::ident_mat();
+  }
+}
+
 /**
  * Replaces the nth transform.  Only valid for unregistered tables.
  */
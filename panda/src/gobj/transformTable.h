@@ -20,6 +20,8 @@
 #include "pointerTo.h"
 #include "luse.h"
 #include "pvector.h"
+#include "epvector.h"
+#include "lightMutex.h"
 #include "cycleData.h"
 #include "cycleDataReader.h"
 #include "cycleDataWriter.h"
@@ -57,6 +59,11 @@ PUBLISHED:
 
   void write(std::ostream &out) const;
 
+public:
+  void get_matrices(LMatrix4f *matrices, size_t num_matrices,
+                    Thread *current_thread) const;
+
+PUBLISHED:
   MAKE_PROPERTY(registered, is_registered);
   MAKE_PROPERTY(modified, get_modified);
   MAKE_SEQ_PROPERTY(transforms, get_num_transforms, get_transform, set_transform,
@@ -73,6 +80,13 @@ private:
   typedef pvector< CPT(VertexTransform) > Transforms;
   Transforms _transforms;
 
+  // The matrices of the transforms, cached by get_matrices() so that they
+  // are computed only once for all the Geoms that share this table.
+  typedef epvector<LMatrix4f> Matrices;
+  mutable LightMutex _matrices_lock;
+  mutable Matrices _matrices;
+  mutable UpdateSeq _matrices_modified;
+
   // This is the data that must be cycled between pipeline stages.
   class EXPCL_PANDA_GOBJ CData : public CycleData {
   public:
@@ -39,6 +39,8 @@ operator = (const VertexDataBuffer &copy) {
   _size = copy._size;
   _reserved_size = copy._size;
   _block = copy._block;
+  _mapped_file = copy._mapped_file;
+  _mapped_data = copy._mapped_data;
   nassertv(_reserved_size >= _size);
 }
 
@@ -55,6 +57,8 @@ swap(VertexDataBuffer &other) {
   size_t reserved_size = _reserved_size;
 
   _block.swap(other._block);
+  _mapped_file.swap(other._mapped_file);
+  std::swap(_mapped_data, other._mapped_data);
 
   _resident_data = other._resident_data;
   _size = other._size;
@@ -119,8 +123,10 @@ do_unclean_realloc(size_t reserved_size) {
         << this << ".unclean_realloc(" << reserved_size << ")\n";
     }
 
-    // If we're paged out, discard the page.
+    // If we're paged out or mapped, discard the page.
     _block = nullptr;
+    _mapped_file = nullptr;
+    _mapped_data = nullptr;
 
     if (_resident_data != nullptr) {
       nassertv(_reserved_size != 0);
@@ -151,8 +157,9 @@ do_unclean_realloc(size_t reserved_size) {
  */
 void VertexDataBuffer::
 do_page_out(VertexDataBook &book) {
-  if (_block != nullptr || _reserved_size == 0) {
-    // We're already paged out.
+  if (_block != nullptr || _mapped_data != nullptr || _reserved_size == 0) {
+    // We're already paged out, or backed by a file that the OS can page out
+    // for us.
     return;
   }
   nassertv(_resident_data != nullptr);
@@ -194,11 +201,43 @@ do_page_in() {
     return;
   }
 
-  nassertv(_block != nullptr);
   nassertv(_reserved_size == _size);
 
+  if (_mapped_data != nullptr) {
+    // Copy the data out of the mapped file, which we no longer need.
+    _resident_data = (unsigned char *)get_class_type().allocate_array(_size);
+    nassertv(_resident_data != nullptr);
+    memcpy(_resident_data, _mapped_data, _size);
+    _mapped_file = nullptr;
+    _mapped_data = nullptr;
+    return;
+  }
+
+  nassertv(_block != nullptr);
+
   _resident_data = (unsigned char *)get_class_type().allocate_array(_size);
   nassertv(_resident_data != nullptr);
 
   memcpy(_resident_data, _block->get_pointer(true), _size);
 }
+
+/**
+ * Makes the buffer reference the indicated read-only range of a memory-mapped
+ * file, instead of holding its own copy of the data.  The pointer must be
+ * aligned to MEMORY_HOOK_ALIGNMENT.  The data is copied into independent
+ * memory the first time the buffer is modified.
+ */
+void VertexDataBuffer::
+set_mapped_data(MemoryMappedFile *file, const unsigned char *pointer,
+                size_t size) {
+  LightMutexHolder holder(_lock);
+  nassertv(((uintptr_t)pointer % MEMORY_HOOK_ALIGNMENT) == 0);
+
+  do_unclean_realloc(0);
+  if (size != 0) {
+    _mapped_file = file;
+    _mapped_data = pointer;
+    _reserved_size = size;
+    _size = size;
+  }
+}
@@ -22,12 +22,13 @@
 #include "pStatCollector.h"
 #include "lightMutex.h"
 #include "lightMutexHolder.h"
+#include "memoryMappedFile.h"
 
 /**
  * A block of bytes that stores the actual raw vertex data referenced by a
  * GeomVertexArrayData object.
  *
- * At any point, a buffer may be in any of two states:
+ * At any point, a buffer may be in any of three states:
  *
  * independent - the buffer's memory is resident, and owned by the
  * VertexDataBuffer object itself (in _resident_data).  In this state,
@@ -39,6 +40,10 @@
  * memory is considered read-only.  In this state, _reserved_size will always
  * equal _size.
  *
+ * mapped - the buffer's memory is a read-only range of a MemoryMappedFile,
+ * typically the bam file it was loaded from.  Like the paged state, any
+ * attempt to modify the buffer first copies it into independent memory.
+ *
  * VertexDataBuffers start out in independent state.  They get moved to paged
  * state when their owning GeomVertexArrayData objects get evicted from the
  * _independent_lru.  They can get moved back to independent state if they are
@@ -68,6 +73,10 @@ public:
   INLINE void clear();
 
   INLINE void page_out(VertexDataBook &book);
+  INLINE bool request_prefetch() const;
+  void set_mapped_data(MemoryMappedFile *file, const unsigned char *pointer,
+                       size_t size);
+  INLINE bool is_mapped() const;
 
   void swap(VertexDataBuffer &other);
 
@@ -82,6 +91,8 @@ private:
   size_t _size;
   size_t _reserved_size;
   PT(VertexDataBlock) _block;
+  PT(MemoryMappedFile) _mapped_file;
+  const unsigned char *_mapped_data;
   LightMutex _lock;
 
 public:
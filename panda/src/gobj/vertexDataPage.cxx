@@ -13,13 +13,16 @@
 
 #include "vertexDataPage.h"
 #include "configVariableInt.h"
+#include "configVariableEnum.h"
 #include "vertexDataSaveFile.h"
 #include "vertexDataBook.h"
 #include "vertexDataBlock.h"
 #include "pStatTimer.h"
 #include "memoryHook.h"
 #include "config_gobj.h"
+#include "trueClock.h"
 #include <algorithm>
+#include <limits>
 
 #ifdef HAVE_ZLIB
 #include <zlib.h>
@@ -41,9 +44,23 @@ ConfigVariableInt max_compressed_vertex_data
           "the least-recently-used ones will be temporarily flushed to "
           "disk until they are needed.  Set it to -1 for no limit."));
 
+ConfigVariableEnum<CompressionAlgorithm> vertex_data_compression_algorithm
+("vertex-data-compression-algorithm",
+#ifdef HAVE_LZ4
+ CA_lz4,
+#else
+ CA_zlib,
+#endif
+ PRC_DESC("Specifies the algorithm used to compress vertex data that is "
+          "evicted by max-resident-vertex-data.  lz4, the default if it is "
+          "available, decompresses many times faster than zlib, which "
+          "matters since a page is decompressed on the render path when it "
+          "is next needed; zlib and zstd compress better.  If the chosen "
+          "algorithm is not available, zlib is used instead."));
+
 ConfigVariableInt vertex_data_compression_level
 ("vertex-data-compression-level", 1,
- PRC_DESC("Specifies the zlib compression level to use when compressing "
+ PRC_DESC("Specifies the compression level to use when compressing "
           "vertex data.  The number should be in the range 1 to 9, where "
           "larger values are slower but give better compression."));
 
@@ -83,6 +100,20 @@ PStatCollector VertexDataPage::_vdata_restore_pcollector("*:Vertex Data:Restore"
 PStatCollector VertexDataPage::_thread_wait_pcollector("Wait:Idle");
 PStatCollector VertexDataPage::_alloc_pages_pcollector("System memory:MMap:Vertex data");
 
+AtomicAdjust::Integer VertexDataPage::_latency_counts[VertexDataPage::num_latency_buckets];
+AtomicAdjust::Integer VertexDataPage::_latency_reported[VertexDataPage::num_latency_buckets];
+PStatCollector VertexDataPage::_latency_pcollectors[VertexDataPage::num_latency_buckets] = {
+  PStatCollector("Vertex page-in latency:0-1 ms"),
+  PStatCollector("Vertex page-in latency:1-2 ms"),
+  PStatCollector("Vertex page-in latency:2-4 ms"),
+  PStatCollector("Vertex page-in latency:4-8 ms"),
+  PStatCollector("Vertex page-in latency:8-16 ms"),
+  PStatCollector("Vertex page-in latency:16-32 ms"),
+  PStatCollector("Vertex page-in latency:32-64 ms"),
+  PStatCollector("Vertex page-in latency:64-128 ms"),
+  PStatCollector("Vertex page-in latency:128+ ms"),
+};
+
 TypeHandle VertexDataPage::_type_handle;
 TypeHandle VertexDataPage::DeflatePage::_type_handle;
 
@@ -114,8 +145,11 @@ VertexDataPage(size_t book_size) :
   _page_data = nullptr;
   _size = 0;
   _uncompressed_size = 0;
+  _compression = CA_none;
   _ram_class = RC_resident;
   _pending_ram_class = RC_resident;
+  _prefetch_pending = false;
+  _request_time = 0.0;
 }
 
 /**
@@ -134,7 +168,10 @@ VertexDataPage(VertexDataBook *book, size_t page_size, size_t block_size) :
   _size = page_size;
 
   _uncompressed_size = _size;
+  _compression = CA_none;
   _pending_ram_class = RC_resident;
+  _prefetch_pending = false;
+  _request_time = 0.0;
   set_ram_class(RC_resident);
 }
 
@@ -207,6 +244,60 @@ flush_threads() {
   }
 }
 
+/**
+ * Returns the upper limit, in seconds, of the nth bucket of the page-in
+ * latency histogram.  The last bucket has no upper limit.
+ */
+double VertexDataPage::
+get_latency_bucket_limit(int n) {
+  nassertr(n >= 0 && n < num_latency_buckets, 0.0);
+  if (n == num_latency_buckets - 1) {
+    return std::numeric_limits<double>::infinity();
+  }
+  return 0.001 * (double)(1 << n);
+}
+
+/**
+ * Returns the number of pages that have been brought back into memory, since
+ * the last call to reset_latency_counts(), whose latency fell into the nth
+ * bucket of the histogram.  The latency is measured from the time the page
+ * was first requested (or prefetched) until it became resident.
+ *
+ * The same histogram is reported to PStats each frame, under "Vertex page-in
+ * latency".
+ */
+int VertexDataPage::
+get_latency_count(int n) {
+  nassertr(n >= 0 && n < num_latency_buckets, 0);
+  return (int)AtomicAdjust::get(_latency_counts[n]);
+}
+
+/**
+ * Resets the histogram of page-in latencies.
+ */
+void VertexDataPage::
+reset_latency_counts() {
+  for (int n = 0; n < num_latency_buckets; ++n) {
+    AtomicAdjust::set(_latency_counts[n], 0);
+    AtomicAdjust::set(_latency_reported[n], 0);
+  }
+}
+
+/**
+ * Reports the page-ins that have completed since the last call to PStats.
+ * This is called once per frame, by GeomVertexArrayData::lru_epoch().
+ */
+void VertexDataPage::
+flush_latency_pstats() {
+#ifdef DO_PSTATS
+  for (int n = 0; n < num_latency_buckets; ++n) {
+    AtomicAdjust::Integer count = AtomicAdjust::get(_latency_counts[n]);
+    AtomicAdjust::Integer reported = AtomicAdjust::set(_latency_reported[n], count);
+    _latency_pcollectors[n].set_level((double)std::max(count - reported, (AtomicAdjust::Integer)0));
+  }
+#endif
+}
+
 /**
  *
  */
@@ -320,12 +411,25 @@ do_alloc(size_t size) {
 void VertexDataPage::
 make_resident_now() {
   MutexHolder holder(_tlock);
+  double request_time;
+  if (_pending_ram_class == RC_resident && _ram_class != RC_resident) {
+    // It was already requested; count the time since then.
+    request_time = _request_time;
+  } else {
+    request_time = TrueClock::get_global_ptr()->get_short_time();
+  }
+
   if (_pending_ram_class != _ram_class) {
     nassertv(_thread_mgr != nullptr);
     _thread_mgr->remove_page(this);
   }
 
-  make_resident();
+  if (_ram_class != RC_resident) {
+    make_resident();
+    record_page_in_latency(request_time);
+  } else {
+    make_resident();
+  }
   _pending_ram_class = RC_resident;
 }
 
@@ -348,76 +452,19 @@ make_resident() {
   }
 
   if (_ram_class == RC_compressed) {
-#ifdef HAVE_ZLIB
     PStatTimer timer(_vdata_decompress_pcollector);
 
     if (gobj_cat.is_debug()) {
       gobj_cat.debug()
         << "Expanding page from " << _size
-        << " to " << _uncompressed_size << "\n";
+        << " to " << _uncompressed_size << " with " << _compression << "\n";
     }
-    size_t new_allocated_size = round_up(_uncompressed_size);
-    unsigned char *new_data = alloc_page_data(new_allocated_size);
-    unsigned char *end_data = new_data + new_allocated_size;
-
-    z_stream z_source;
-#ifdef USE_MEMORY_NOWRAPPERS
-    z_source.zalloc = Z_NULL;
-    z_source.zfree = Z_NULL;
-#else
-    z_source.zalloc = (alloc_func)&do_zlib_alloc;
-    z_source.zfree = (free_func)&do_zlib_free;
-#endif
-
-    z_source.opaque = Z_NULL;
-    z_source.msg = (char *) "no error message";
 
-    z_source.next_in = (Bytef *)(char *)_page_data;
-    z_source.avail_in = _size;
-    z_source.next_out = (Bytef *)new_data;
-    z_source.avail_out = new_allocated_size;
-
-    int result = inflateInit(&z_source);
-    if (result < 0) {
-      nassert_raise("zlib error");
-      return;
-    }
-    Thread::consider_yield();
-
-    size_t output_size = 0;
-
-    int flush = 0;
-    result = 0;
-    while (result != Z_STREAM_END) {
-      unsigned char *start_out = (unsigned char *)z_source.next_out;
-      nassertv(start_out < end_data);
-      z_source.avail_out = std::min((size_t)(end_data - start_out), (size_t)inflate_page_size);
-      nassertv(z_source.avail_out != 0);
-      result = inflate(&z_source, flush);
-      if (result < 0 && result != Z_BUF_ERROR) {
-        nassert_raise("zlib error");
-        return;
-      }
-      size_t bytes_produced = (size_t)((unsigned char *)z_source.next_out - start_out);
-      output_size += bytes_produced;
-      if (bytes_produced == 0) {
-        // If we ever produce no bytes, then start flushing the output.
-        flush = Z_FINISH;
-      }
-
-      Thread::consider_yield();
+    if (_compression == CA_zlib) {
+      do_decompress_zlib();
+    } else if (_compression != CA_none) {
+      do_decompress_buffer();
     }
-    nassertv(z_source.avail_in == 0);
-    nassertv(output_size == _uncompressed_size);
-
-    result = inflateEnd(&z_source);
-    nassertv(result == Z_OK);
-
-    free_page_data(_page_data, _allocated_size);
-    _page_data = new_data;
-    _size = _uncompressed_size;
-    _allocated_size = new_allocated_size;
-#endif
 
     set_lru_size(_size);
     set_ram_class(RC_resident);
@@ -445,109 +492,262 @@ make_compressed() {
   if (_ram_class == RC_resident) {
     nassertv(_size == _uncompressed_size);
 
-#ifdef HAVE_ZLIB
     PStatTimer timer(_vdata_compress_pcollector);
 
-    DeflatePage *page = new DeflatePage;
-    DeflatePage *head = page;
+    _compression = vertex_data_compression_algorithm;
+    if (!is_compression_algorithm_available(_compression)) {
+#ifdef HAVE_ZLIB
+      _compression = CA_zlib;
+#else
+      _compression = CA_none;
+#endif
+    }
+
+    if (_compression == CA_zlib) {
+      do_compress_zlib();
+    } else if (_compression != CA_none) {
+      do_compress_buffer();
+    }
+
+    if (gobj_cat.is_debug()) {
+      gobj_cat.debug()
+        << "Compressed " << *this << " from " << _uncompressed_size
+        << " to " << _size << " with " << _compression << "\n";
+    }
+    set_lru_size(_size);
+    set_ram_class(RC_compressed);
+  }
+}
+
+/**
+ * Compresses the resident page data with zlib.
+ *
+ * Assumes the lock is already held.
+ */
+void VertexDataPage::
+do_compress_zlib() {
+#ifdef HAVE_ZLIB
+  DeflatePage *page = new DeflatePage;
+  DeflatePage *head = page;
 
-    z_stream z_dest;
+  z_stream z_dest;
 #ifdef USE_MEMORY_NOWRAPPERS
-    z_dest.zalloc = Z_NULL;
-    z_dest.zfree = Z_NULL;
+  z_dest.zalloc = Z_NULL;
+  z_dest.zfree = Z_NULL;
 #else
-    z_dest.zalloc = (alloc_func)&do_zlib_alloc;
-    z_dest.zfree = (free_func)&do_zlib_free;
+  z_dest.zalloc = (alloc_func)&do_zlib_alloc;
+  z_dest.zfree = (free_func)&do_zlib_free;
 #endif
 
-    z_dest.opaque = Z_NULL;
-    z_dest.msg = (char *) "no error message";
+  z_dest.opaque = Z_NULL;
+  z_dest.msg = (char *) "no error message";
+
+  int result = deflateInit(&z_dest, vertex_data_compression_level);
+  if (result < 0) {
+    nassert_raise("zlib error");
+    return;
+  }
+  Thread::consider_yield();
+
+  z_dest.next_in = (Bytef *)(char *)_page_data;
+  z_dest.avail_in = _uncompressed_size;
+  size_t output_size = 0;
+
+  // Compress the data into one or more individual pages.  We have to
+  // compress it page-at-a-time, since we're not really sure how big the
+  // result will be (so we can't easily pre-allocate a buffer).
+  int flush = 0;
+  result = 0;
+  while (result != Z_STREAM_END) {
+    unsigned char *start_out = (page->_buffer + page->_used_size);
+    z_dest.next_out = (Bytef *)start_out;
+    z_dest.avail_out = (size_t)deflate_page_size - page->_used_size;
+    if (z_dest.avail_out == 0) {
+      DeflatePage *new_page = new DeflatePage;
+      page->_next = new_page;
+      page = new_page;
+      start_out = page->_buffer;
+      z_dest.next_out = (Bytef *)start_out;
+      z_dest.avail_out = deflate_page_size;
+    }
 
-    int result = deflateInit(&z_dest, vertex_data_compression_level);
-    if (result < 0) {
+    result = deflate(&z_dest, flush);
+    if (result < 0 && result != Z_BUF_ERROR) {
       nassert_raise("zlib error");
       return;
     }
+    size_t bytes_produced = (size_t)((unsigned char *)z_dest.next_out - start_out);
+    page->_used_size += bytes_produced;
+    nassertv(page->_used_size <= deflate_page_size);
+    output_size += bytes_produced;
+    if (bytes_produced == 0) {
+      // If we ever produce no bytes, then start flushing the output.
+      flush = Z_FINISH;
+    }
+
     Thread::consider_yield();
+  }
+  nassertv(z_dest.avail_in == 0);
+
+  result = deflateEnd(&z_dest);
+  nassertv(result == Z_OK);
+
+  // Now we know how big the result will be.  Allocate a buffer, and copy the
+  // data from the various pages.
+
+  size_t new_allocated_size = round_up(output_size);
+  unsigned char *new_data = alloc_page_data(new_allocated_size);
+
+  size_t copied_size = 0;
+  unsigned char *p = new_data;
+  page = head;
+  while (page != nullptr) {
+    memcpy(p, page->_buffer, page->_used_size);
+    copied_size += page->_used_size;
+    p += page->_used_size;
+    DeflatePage *next = page->_next;
+    delete page;
+    page = next;
+  }
+  nassertv(copied_size == output_size);
+
+  // Now free the original, uncompressed data, and put this new compressed
+  // buffer in its place.
+  free_page_data(_page_data, _allocated_size);
+  _page_data = new_data;
+  _size = output_size;
+  _allocated_size = new_allocated_size;
+#endif  // HAVE_ZLIB
+}
 
-    z_dest.next_in = (Bytef *)(char *)_page_data;
-    z_dest.avail_in = _uncompressed_size;
-    size_t output_size = 0;
-
-    // Compress the data into one or more individual pages.  We have to
-    // compress it page-at-a-time, since we're not really sure how big the
-    // result will be (so we can't easily pre-allocate a buffer).
-    int flush = 0;
-    result = 0;
-    while (result != Z_STREAM_END) {
-      unsigned char *start_out = (page->_buffer + page->_used_size);
-      z_dest.next_out = (Bytef *)start_out;
-      z_dest.avail_out = (size_t)deflate_page_size - page->_used_size;
-      if (z_dest.avail_out == 0) {
-        DeflatePage *new_page = new DeflatePage;
-        page->_next = new_page;
-        page = new_page;
-        start_out = page->_buffer;
-        z_dest.next_out = (Bytef *)start_out;
-        z_dest.avail_out = deflate_page_size;
-      }
+/**
+ * Expands the page data previously compressed by do_compress_zlib().
+ *
+ * Assumes the lock is already held.
+ */
+void VertexDataPage::
+do_decompress_zlib() {
+#ifdef HAVE_ZLIB
+  size_t new_allocated_size = round_up(_uncompressed_size);
+  unsigned char *new_data = alloc_page_data(new_allocated_size);
+  unsigned char *end_data = new_data + new_allocated_size;
 
-      result = deflate(&z_dest, flush);
-      if (result < 0 && result != Z_BUF_ERROR) {
-        nassert_raise("zlib error");
-        return;
-      }
-      size_t bytes_produced = (size_t)((unsigned char *)z_dest.next_out - start_out);
-      page->_used_size += bytes_produced;
-      nassertv(page->_used_size <= deflate_page_size);
-      output_size += bytes_produced;
-      if (bytes_produced == 0) {
-        // If we ever produce no bytes, then start flushing the output.
-        flush = Z_FINISH;
-      }
+  z_stream z_source;
+#ifdef USE_MEMORY_NOWRAPPERS
+  z_source.zalloc = Z_NULL;
+  z_source.zfree = Z_NULL;
+#else
+  z_source.zalloc = (alloc_func)&do_zlib_alloc;
+  z_source.zfree = (free_func)&do_zlib_free;
+#endif
+
+  z_source.opaque = Z_NULL;
+  z_source.msg = (char *) "no error message";
 
-      Thread::consider_yield();
+  z_source.next_in = (Bytef *)(char *)_page_data;
+  z_source.avail_in = _size;
+  z_source.next_out = (Bytef *)new_data;
+  z_source.avail_out = new_allocated_size;
+
+  int result = inflateInit(&z_source);
+  if (result < 0) {
+    nassert_raise("zlib error");
+    return;
+  }
+  Thread::consider_yield();
+
+  size_t output_size = 0;
+
+  int flush = 0;
+  result = 0;
+  while (result != Z_STREAM_END) {
+    unsigned char *start_out = (unsigned char *)z_source.next_out;
+    nassertv(start_out < end_data);
+    z_source.avail_out = std::min((size_t)(end_data - start_out), (size_t)inflate_page_size);
+    nassertv(z_source.avail_out != 0);
+    result = inflate(&z_source, flush);
+    if (result < 0 && result != Z_BUF_ERROR) {
+      nassert_raise("zlib error");
+      return;
+    }
+    size_t bytes_produced = (size_t)((unsigned char *)z_source.next_out - start_out);
+    output_size += bytes_produced;
+    if (bytes_produced == 0) {
+      // If we ever produce no bytes, then start flushing the output.
+      flush = Z_FINISH;
     }
-    nassertv(z_dest.avail_in == 0);
 
-    result = deflateEnd(&z_dest);
-    nassertv(result == Z_OK);
+    Thread::consider_yield();
+  }
+  nassertv(z_source.avail_in == 0);
+  nassertv(output_size == _uncompressed_size);
 
-    // Now we know how big the result will be.  Allocate a buffer, and copy
-    // the data from the various pages.
+  result = inflateEnd(&z_source);
+  nassertv(result == Z_OK);
 
-    size_t new_allocated_size = round_up(output_size);
-    unsigned char *new_data = alloc_page_data(new_allocated_size);
+  free_page_data(_page_data, _allocated_size);
+  _page_data = new_data;
+  _size = _uncompressed_size;
+  _allocated_size = new_allocated_size;
+#endif  // HAVE_ZLIB
+}
 
-    size_t copied_size = 0;
-    unsigned char *p = new_data;
-    page = head;
-    while (page != nullptr) {
-      memcpy(p, page->_buffer, page->_used_size);
-      copied_size += page->_used_size;
-      p += page->_used_size;
-      DeflatePage *next = page->_next;
-      delete page;
-      page = next;
-    }
-    nassertv(copied_size == output_size);
+/**
+ * Compresses the resident page data in one step with the algorithm in
+ * _compression, which should be one of the block compressors, LZ4 or
+ * Zstandard.
+ *
+ * Assumes the lock is already held.
+ */
+void VertexDataPage::
+do_compress_buffer() {
+  size_t bound = get_compress_bound(_compression, _uncompressed_size);
+  nassertv(bound != 0);
+  unsigned char *buffer = (unsigned char *)PANDA_MALLOC_ARRAY(bound);
+
+  size_t output_size =
+    compress_buffer(_compression, vertex_data_compression_level,
+                    _page_data, _uncompressed_size, buffer, bound);
+  if (output_size == 0) {
+    PANDA_FREE_ARRAY(buffer);
+    nassert_raise("compression error");
+    return;
+  }
+  Thread::consider_yield();
 
-    // Now free the original, uncompressed data, and put this new compressed
-    // buffer in its place.
-    free_page_data(_page_data, _allocated_size);
-    _page_data = new_data;
-    _size = output_size;
-    _allocated_size = new_allocated_size;
+  size_t new_allocated_size = round_up(output_size);
+  unsigned char *new_data = alloc_page_data(new_allocated_size);
+  memcpy(new_data, buffer, output_size);
+  PANDA_FREE_ARRAY(buffer);
 
-    if (gobj_cat.is_debug()) {
-      gobj_cat.debug()
-        << "Compressed " << *this << " from " << _uncompressed_size
-        << " to " << _size << "\n";
-    }
-#endif
-    set_lru_size(_size);
-    set_ram_class(RC_compressed);
+  free_page_data(_page_data, _allocated_size);
+  _page_data = new_data;
+  _size = output_size;
+  _allocated_size = new_allocated_size;
+}
+
+/**
+ * Expands the page data previously compressed by do_compress_buffer().
+ *
+ * Assumes the lock is already held.
+ */
+void VertexDataPage::
+do_decompress_buffer() {
+  size_t new_allocated_size = round_up(_uncompressed_size);
+  unsigned char *new_data = alloc_page_data(new_allocated_size);
+
+  if (!decompress_buffer(_compression, _page_data, _size,
+                         new_data, _uncompressed_size)) {
+    free_page_data(new_data, new_allocated_size);
+    nassert_raise("decompression error");
+    return;
   }
+  Thread::consider_yield();
+
+  free_page_data(_page_data, _allocated_size);
+  _page_data = new_data;
+  _size = _uncompressed_size;
+  _allocated_size = new_allocated_size;
 }
 
 /**
@@ -688,13 +888,19 @@ adjust_book_size() {
  * Assumes the page's lock is already held.
  */
 void VertexDataPage::
-request_ram_class(RamClass ram_class) {
+request_ram_class(RamClass ram_class, bool prefetch) {
   int num_threads = vertex_data_page_threads;
   if (num_threads == 0 || !Thread::is_threading_supported()) {
     // No threads.  Do it immediately.
     switch (ram_class) {
     case RC_resident:
-      make_resident();
+      if (_ram_class != RC_resident) {
+        double request_time = TrueClock::get_global_ptr()->get_short_time();
+        make_resident();
+        record_page_in_latency(request_time);
+      } else {
+        make_resident();
+      }
       break;
 
     case RC_compressed:
@@ -720,7 +926,22 @@ request_ram_class(RamClass ram_class) {
     _thread_mgr = new PageThreadManager(num_threads);
   }
 
-  _thread_mgr->add_page(this, ram_class);
+  _thread_mgr->add_page(this, ram_class, prefetch);
+}
+
+/**
+ * Adds a page that has just become resident to the histogram of page-in
+ * latencies.
+ */
+void VertexDataPage::
+record_page_in_latency(double request_time) {
+  double latency = TrueClock::get_global_ptr()->get_short_time() - request_time;
+
+  int n = 0;
+  while (n < num_latency_buckets - 1 && latency >= get_latency_bucket_limit(n)) {
+    ++n;
+  }
+  AtomicAdjust::inc(_latency_counts[n]);
 }
 
 /**
@@ -767,18 +988,29 @@ PageThreadManager(int num_threads) :
 
 /**
  * Enqueues the indicated page on the thread queue to convert it to the
- * specified ram class.
+ * specified ram class.  If prefetch is true, a request for RC_resident is
+ * queued behind all of the other read requests.
  *
  * It is assumed the page's lock is already held, and that _tlock is already
  * held.
  */
 void VertexDataPage::PageThreadManager::
-add_page(VertexDataPage *page, RamClass ram_class) {
+add_page(VertexDataPage *page, RamClass ram_class, bool prefetch) {
   nassertv(!_shutdown);
 
   if (page->_pending_ram_class == ram_class) {
     // It's already queued.
     nassertv(page->get_lru() == &_pending_lru);
+
+    if (page->_prefetch_pending && !prefetch) {
+      // But only as a prefetch, and now it's needed.  Promote it.
+      PendingPages::iterator pi =
+        find(_pending_prefetches.begin(), _pending_prefetches.end(), page);
+      nassertv(pi != _pending_prefetches.end());
+      _pending_prefetches.erase(pi);
+      _pending_reads.push_back(page);
+      page->_prefetch_pending = false;
+    }
     return;
   }
 
@@ -796,7 +1028,13 @@ add_page(VertexDataPage *page, RamClass ram_class) {
 
     page->_pending_ram_class = ram_class;
     if (ram_class == RC_resident) {
-      _pending_reads.push_back(page);
+      page->_request_time = TrueClock::get_global_ptr()->get_short_time();
+      if (prefetch) {
+        _pending_prefetches.push_back(page);
+        page->_prefetch_pending = true;
+      } else {
+        _pending_reads.push_back(page);
+      }
     } else {
       _pending_writes.push_back(page);
     }
@@ -829,7 +1067,13 @@ remove_page(VertexDataPage *page) {
     }
   }
 
-  if (page->_pending_ram_class == RC_resident) {
+  if (page->_prefetch_pending) {
+    PendingPages::iterator pi =
+      find(_pending_prefetches.begin(), _pending_prefetches.end(), page);
+    nassertv(pi != _pending_prefetches.end());
+    _pending_prefetches.erase(pi);
+    page->_prefetch_pending = false;
+  } else if (page->_pending_ram_class == RC_resident) {
     PendingPages::iterator pi =
       find(_pending_reads.begin(), _pending_reads.end(), page);
     nassertv(pi != _pending_reads.end());
@@ -874,6 +1118,15 @@ get_num_pending_writes() const {
   return (int)_pending_writes.size();
 }
 
+/**
+ * Returns the number of prefetch requests waiting on the queue.  Assumes
+ * _tlock is held.
+ */
+int VertexDataPage::PageThreadManager::
+get_num_pending_prefetches() const {
+  return (int)_pending_prefetches.size();
+}
+
 /**
  * Adds the indicated of threads to the list of active threads.  Assumes
  * _tlock is held.
@@ -912,7 +1165,8 @@ stop_threads() {
     thread->join();
   }
 
-  nassertv(_pending_reads.empty() && _pending_writes.empty());
+  nassertv(_pending_reads.empty() && _pending_writes.empty() &&
+           _pending_prefetches.empty());
 }
 
 /**
@@ -937,6 +1191,7 @@ thread_main() {
     PStatClient::thread_tick(get_sync_name());
 
     while (_manager->_pending_reads.empty() &&
+           _manager->_pending_prefetches.empty() &&
            _manager->_pending_writes.empty()) {
       if (_manager->_shutdown) {
         _tlock.release();
@@ -946,16 +1201,21 @@ thread_main() {
       _manager->_pending_cvar.wait();
     }
 
-    // Reads always have priority.
+    // Reads always have priority, followed by prefetches.
     if (!_manager->_pending_reads.empty()) {
       _working_page = _manager->_pending_reads.front();
       _manager->_pending_reads.pop_front();
+    } else if (!_manager->_pending_prefetches.empty()) {
+      _working_page = _manager->_pending_prefetches.front();
+      _manager->_pending_prefetches.pop_front();
+      _working_page->_prefetch_pending = false;
     } else {
       _working_page = _manager->_pending_writes.front();
       _manager->_pending_writes.pop_front();
     }
 
     RamClass ram_class = _working_page->_pending_ram_class;
+    double request_time = _working_page->_request_time;
     _tlock.release();
 
     {
@@ -963,6 +1223,7 @@ thread_main() {
       switch (ram_class) {
       case RC_resident:
         _working_page->make_resident();
+        record_page_in_latency(request_time);
         break;
 
       case RC_compressed:
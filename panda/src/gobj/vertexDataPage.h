@@ -24,6 +24,8 @@
 #include "thread.h"
 #include "mutexHolder.h"
 #include "pdeque.h"
+#include "atomicAdjust.h"
+#include "compressionAlgorithm.h"
 
 class VertexDataBook;
 class VertexDataBlock;
@@ -53,7 +55,9 @@ PUBLISHED:
 
   INLINE RamClass get_ram_class() const;
   INLINE RamClass get_pending_ram_class() const;
+  INLINE CompressionAlgorithm get_compression_algorithm() const;
   INLINE void request_resident();
+  INLINE bool request_prefetch();
 
   INLINE VertexDataBlock *alloc(size_t size);
   INLINE VertexDataBlock *get_first_block() const;
@@ -70,9 +74,15 @@ PUBLISHED:
   INLINE static int get_num_threads();
   INLINE static int get_num_pending_reads();
   INLINE static int get_num_pending_writes();
+  INLINE static int get_num_pending_prefetches();
   static void stop_threads();
   static void flush_threads();
 
+  INLINE static int get_num_latency_buckets();
+  static double get_latency_bucket_limit(int n);
+  static int get_latency_count(int n);
+  static void reset_latency_counts();
+
   virtual void output(std::ostream &out) const;
   virtual void write(std::ostream &out, int indent_level) const;
 
@@ -80,6 +90,8 @@ public:
   INLINE unsigned char *get_page_data(bool force);
   INLINE bool operator < (const VertexDataPage &other) const;
 
+  static void flush_latency_pstats();
+
 protected:
   virtual SimpleAllocatorBlock *make_block(size_t start, size_t size);
   virtual void changed_contiguous();
@@ -95,12 +107,18 @@ private:
   void make_compressed();
   void make_disk();
 
+  void do_compress_zlib();
+  void do_decompress_zlib();
+  void do_compress_buffer();
+  void do_decompress_buffer();
+
   bool do_save_to_disk();
   void do_restore_from_disk();
 
   void adjust_book_size();
 
-  void request_ram_class(RamClass ram_class);
+  void request_ram_class(RamClass ram_class, bool prefetch = false);
+  static void record_page_in_latency(double request_time);
   INLINE void set_ram_class(RamClass ram_class);
   static void make_save_file();
 
@@ -131,17 +149,19 @@ private:
   class EXPCL_PANDA_GOBJ PageThreadManager : public ReferenceCount {
   public:
     PageThreadManager(int num_threads);
-    void add_page(VertexDataPage *page, RamClass ram_class);
+    void add_page(VertexDataPage *page, RamClass ram_class, bool prefetch);
     void remove_page(VertexDataPage *page);
     int get_num_threads() const;
     int get_num_pending_reads() const;
     int get_num_pending_writes() const;
+    int get_num_pending_prefetches() const;
     void start_threads(int num_threads);
     void stop_threads();
 
   private:
     PendingPages _pending_writes;
     PendingPages _pending_reads;
+    PendingPages _pending_prefetches;
     bool _shutdown;
 
     // Signaled when anything new is added to either of the above queues, or
@@ -157,6 +177,7 @@ private:
 
   unsigned char *_page_data;
   size_t _size, _allocated_size, _uncompressed_size;
+  CompressionAlgorithm _compression;
   RamClass _ram_class;
   PT(VertexDataSaveBlock) _saved_block;
   size_t _book_size;
@@ -164,6 +185,8 @@ private:
 
   // Mutex _lock;   Inherited from SimpleAllocator.  Protects above members.
   RamClass _pending_ram_class;  // Protected by _tlock.
+  bool _prefetch_pending;       // Protected by _tlock.
+  double _request_time;         // Protected by _tlock.
 
   VertexDataBook *_book;  // never changes.
 
@@ -212,6 +235,14 @@ private:
   static PStatCollector _thread_wait_pcollector;
   static PStatCollector _alloc_pages_pcollector;
 
+  // A histogram of the time taken to bring pages back into memory, from the
+  // time they were requested.  Bucket n counts the page-ins that took less
+  // than 2^n ms; the last bucket counts everything else.
+  enum { num_latency_buckets = 9 };
+  static AtomicAdjust::Integer _latency_counts[num_latency_buckets];
+  static AtomicAdjust::Integer _latency_reported[num_latency_buckets];
+  static PStatCollector _latency_pcollectors[num_latency_buckets];
+
 public:
   static TypeHandle get_class_type() {
     return _type_handle;
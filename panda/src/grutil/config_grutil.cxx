@@ -12,6 +12,7 @@
  */
 
 #include "config_grutil.h"
+#include "cullSnapshotNode.h"
 #include "frameRateMeter.h"
 #include "sceneGraphAnalyzerMeter.h"
 #include "meshDrawer.h"
@@ -120,6 +121,7 @@ init_libgrutil() {
   }
   initialized = true;
 
+  CullSnapshotNode::init_type();
   FrameRateMeter::init_type();
   MeshDrawer::init_type();
   MeshDrawer2D::init_type();
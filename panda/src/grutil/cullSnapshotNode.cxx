@@ -0,0 +1,99 @@
+/**
+ * PANDA 3D SOFTWARE
+ * Copyright (c) Carnegie Mellon University.  All rights reserved.
+ *
+ * All use of this software is subject to the terms of the revised BSD
+ * license.  You should have received a copy of this license along
+ * with this source code in a file named "LICENSE."
+ *
+ * @file cullSnapshotNode.cxx
+ * @author blablabla94
+ * @date 2026-10-16
+ */
+
+#include "cullSnapshotNode.h"
+#include "cullTraverser.h"
+#include "cullTraverserData.h"
+#include "lightMutexHolder.h"
+
+TypeHandle CullSnapshotNode::_type_handle;
+
+/**
+ *
+ */
+CullSnapshotNode::
+CullSnapshotNode(const std::string &name) : PandaNode(name) {
+  set_cull_callback();
+}
+
+/**
+ *
+ */
+CullSnapshotNode::
+CullSnapshotNode(const CullSnapshotNode &copy) : PandaNode(copy) {
+  set_cull_callback();
+}
+
+/**
+ * Returns a newly-allocated PandaNode that is a shallow copy of this one.  It
+ * will be a different pointer, but its internal data may or may not be shared
+ * with that of the original PandaNode.  No children will be copied.
+ */
+PandaNode *CullSnapshotNode::
+make_copy() const {
+  return new CullSnapshotNode(*this);
+}
+
+/**
+ * Discards the current snapshot, forcing it to be rebuilt from scratch on the
+ * next cull traversal.  This is only necessary after adding or removing a
+ * RenderEffect or tag below this node, since those changes are not otherwise
+ * detected.
+ */
+void CullSnapshotNode::
+mark_snapshot_stale() {
+  LightMutexHolder holder(_lock);
+  _snapshot = nullptr;
+}
+
+/**
+ * This function will be called during the cull traversal to perform any
+ * additional operations that should be performed at cull time.  This may
+ * include additional manipulation of render state or additional
+ * visible/invisible decisions, or any other arbitrary operation.
+ *
+ * Note that this function will *not* be called unless set_cull_callback() is
+ * called in the constructor of the derived class.  It is necessary to call
+ * set_cull_callback() to indicated that we require cull_callback() to be
+ * called.
+ *
+ * By the time this function is called, the node has already passed the
+ * bounding-volume test for the viewing frustum, and the node's transform and
+ * state have already been applied to the indicated CullTraverserData object.
+ *
+ * The return value is true if this node should be visible, or false if it
+ * should be culled.
+ */
+bool CullSnapshotNode::
+cull_callback(CullTraverser *trav, CullTraverserData &data) {
+  if (!data._cull_planes->is_empty() || trav->get_portal_clipper() != nullptr) {
+    // The snapshot doesn't handle clip planes, occluders or portals; fall
+    // back to the normal traversal.
+    return true;
+  }
+
+  Thread *current_thread = trav->get_current_thread();
+  CPT(CullSnapshot) snapshot;
+  {
+    LightMutexHolder holder(_lock);
+    if (_snapshot == nullptr || !_snapshot->is_current(current_thread)) {
+      _snapshot = new CullSnapshot(this, _snapshot, current_thread);
+    }
+    snapshot = _snapshot;
+  }
+
+  trav->traverse_snapshot(data, snapshot);
+
+  // We have already visited the nodes beneath this node.
+  return false;
+}
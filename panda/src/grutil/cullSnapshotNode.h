@@ -0,0 +1,78 @@
+/**
+ * PANDA 3D SOFTWARE
+ * Copyright (c) Carnegie Mellon University.  All rights reserved.
+ *
+ * All use of this software is subject to the terms of the revised BSD
+ * license.  You should have received a copy of this license along
+ * with this source code in a file named "LICENSE."
+ *
+ * @file cullSnapshotNode.h
+ * @author blablabla94
+ * @date 2026-10-16
+ */
+
+#ifndef CULLSNAPSHOTNODE_H
+#define CULLSNAPSHOTNODE_H
+
+#include "pandabase.h"
+
+#include "pandaNode.h"
+#include "cullSnapshot.h"
+#include "lightMutex.h"
+
+/**
+ * This is a special node that speeds up the cull traversal of a large,
+ * mostly static subgraph, such as a level with many thousands of props.
+ *
+ * Rather than walking its children one node at a time, it keeps a
+ * CullSnapshot of the subgraph: a flat list of the GeomNodes below it, with
+ * their net transforms, states and bounding spheres.  Each frame, the view
+ * frustum is tested against all of the bounding spheres in a single loop, and
+ * the GeomNodes that pass are drawn directly.
+ *
+ * The snapshot is rebuilt automatically when a transform, state, draw mask or
+ * child list below this node changes; only the children of this node whose
+ * subgraph actually changed are walked again.  Nodes that need special cull
+ * handling, such as billboards, LODNodes or nodes with a cull callback, are
+ * traversed normally.
+ *
+ * This is not worthwhile for subgraphs in which most of the nodes move every
+ * frame.
+ */
+class EXPCL_PANDA_GRUTIL CullSnapshotNode : public PandaNode {
+PUBLISHED:
+  explicit CullSnapshotNode(const std::string &name);
+protected:
+  CullSnapshotNode(const CullSnapshotNode &copy);
+  virtual PandaNode *make_copy() const;
+
+PUBLISHED:
+  void mark_snapshot_stale();
+
+public:
+  // From parent class PandaNode
+  virtual bool cull_callback(CullTraverser *trav, CullTraverserData &data);
+
+private:
+  LightMutex _lock;
+  CPT(CullSnapshot) _snapshot;
+
+public:
+  static TypeHandle get_class_type() {
+    return _type_handle;
+  }
+  static void init_type() {
+    PandaNode::init_type();
+    register_type(_type_handle, "CullSnapshotNode",
+                  PandaNode::get_class_type());
+  }
+  virtual TypeHandle get_type() const {
+    return get_class_type();
+  }
+  virtual TypeHandle force_init_type() {init_type(); return get_class_type();}
+
+private:
+  static TypeHandle _type_handle;
+};
+
+#endif
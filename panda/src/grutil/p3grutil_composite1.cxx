@@ -3,6 +3,7 @@
 #include "geoMipTerrain.cxx"
 #include "shaderTerrainMesh.cxx"
 #include "config_grutil.cxx"
+#include "cullSnapshotNode.cxx"
 #include "lineSegs.cxx"
 #include "fisheyeMaker.cxx"
 #include "frameRateMeter.cxx"
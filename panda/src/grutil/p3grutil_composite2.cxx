@@ -5,4 +5,6 @@
 #include "pipeOcclusionCullTraverser.cxx"
 #include "pfmVizzer.cxx"
 #include "rigidBodyCombiner.cxx"
+#include "textureArrayReducer.cxx"
+#include "vertexDataPrefetcher.cxx"
 
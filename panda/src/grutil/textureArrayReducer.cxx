@@ -0,0 +1,366 @@
+/**
+ * PANDA 3D SOFTWARE
+ * Copyright (c) Carnegie Mellon University.  All rights reserved.
+ *
+ * All use of this software is subject to the terms of the revised BSD
+ * license.  You should have received a copy of this license along
+ * with this source code in a file named "LICENSE."
+ *
+ * @file textureArrayReducer.cxx
+ * @author blablabla94
+ * @date 2026-10-16
+ */
+
+#include "textureArrayReducer.h"
+#include "pandaNode.h"
+#include "geomNode.h"
+#include "geom.h"
+#include "geomVertexData.h"
+#include "geomVertexFormat.h"
+#include "geomVertexArrayFormat.h"
+#include "geomVertexRewriter.h"
+#include "renderState.h"
+#include "textureAttrib.h"
+#include "shaderAttrib.h"
+#include "config_grutil.h"
+#include "dcast.h"
+
+#include <algorithm>
+
+/**
+ *
+ */
+TextureArrayReducer::
+TextureArrayReducer() :
+  _num_textures(0),
+  _layer_in_texcoord(false),
+  _max_layers(256)
+{
+}
+
+/**
+ *
+ */
+TextureArrayReducer::
+~TextureArrayReducer() {
+}
+
+/**
+ * Removes the record of nodes that were previously discovered by scan().
+ */
+void TextureArrayReducer::
+clear() {
+  _groups.clear();
+}
+
+/**
+ * Starts scanning the hierarchy beginning at the indicated node.  Any
+ * GeomNodes discovered in the hierarchy with a suitable texture will be
+ * added to the list of Geoms to be modified by the next call to flatten().
+ *
+ * The state is the net state above the indicated node.
+ */
+void TextureArrayReducer::
+scan(PandaNode *node, const RenderState *state) {
+  if (grutil_cat.is_debug()) {
+    grutil_cat.debug()
+      << "scan(" << *node << ", " << *state << ")\n";
+  }
+
+  CPT(RenderState) next_state = state->compose(node->get_state());
+
+  if (node->is_geom_node()) {
+    scan_geom_node(DCAST(GeomNode, node), next_state);
+  }
+
+  PandaNode::Children cr = node->get_children();
+  int num_children = cr.get_num_children();
+  for (int i = 0; i < num_children; i++) {
+    scan(cr.get_child(i), next_state);
+  }
+}
+
+/**
+ * Packs the textures of the Geoms discovered by scan() into array textures,
+ * and modifies the Geoms to use them.  Textures are only packed if there are
+ * at least two different ones with the same properties.  Returns the number
+ * of Geoms that were modified.
+ *
+ * This also clears the list of scanned nodes.
+ */
+int TextureArrayReducer::
+flatten() {
+  _arrays.clear();
+  _num_textures = 0;
+
+  Layers layers;
+  for (Groups::const_iterator gi = _groups.begin(); gi != _groups.end(); ++gi) {
+    const Group &group = (*gi).second;
+    if (group._textures.size() >= 2) {
+      make_arrays(group._textures, layers);
+    }
+  }
+
+  CPT(InternalName) input_name = get_layer_input_name();
+  LayerGeoms layer_geoms;
+  int num_modified = 0;
+
+  for (Groups::const_iterator gi = _groups.begin(); gi != _groups.end(); ++gi) {
+    const GeomList &geoms = (*gi).second._geoms;
+    for (const GeomInfo &info : geoms) {
+      Layers::const_iterator li = layers.find(info._tex);
+      if (li == layers.end()) {
+        continue;
+      }
+      Texture *array = (*li).second._array;
+      int layer = (*li).second._layer;
+
+      GeomNode *geom_node = info._geom_node;
+      CPT(RenderState) geom_state = geom_node->get_geom_state(info._index);
+
+      // Replace the texture on the Geom.  We use the same override as the
+      // TextureAttrib that was in effect, so that it takes precedence over
+      // one that may be inherited from above.
+      const TextureAttrib *ta;
+      geom_state->get_attrib_def(ta);
+      geom_state = geom_state->set_attrib(ta->add_on_stage(info._stage, array),
+                                          info._override);
+
+      if (_layer_in_texcoord) {
+        CPT(Geom) geom = set_texcoord_layer(geom_node->get_geom(info._index),
+                                            info._stage->get_texcoord_name(),
+                                            layer, layer_geoms);
+        if (geom == nullptr) {
+          continue;
+        }
+        geom_node->set_geom(info._index, (Geom *)geom.p());
+      } else {
+        CPT(RenderAttrib) sa = geom_state->get_attrib(ShaderAttrib::get_class_slot());
+        if (sa == nullptr) {
+          sa = ShaderAttrib::make();
+        }
+        sa = DCAST(ShaderAttrib, sa)->set_shader_input(
+          ShaderInput(input_name, LVecBase4i(layer, 0, 0, 0)));
+        geom_state = geom_state->set_attrib(sa);
+      }
+
+      geom_node->set_geom_state(info._index, geom_state);
+      ++num_modified;
+    }
+  }
+
+  if (grutil_cat.is_debug()) {
+    grutil_cat.debug()
+      << "Packed " << _num_textures << " textures into " << _arrays.size()
+      << " arrays, modified " << num_modified << " Geoms\n";
+  }
+
+  _groups.clear();
+  return num_modified;
+}
+
+/**
+ * Returns the name of the shader input that receives the layer index of the
+ * texture, unless set_layer_in_texcoord() is set.
+ */
+CPT(InternalName) TextureArrayReducer::
+get_layer_input_name() {
+  static CPT(InternalName) name = InternalName::make("texture_layer");
+  return name;
+}
+
+/**
+ *
+ */
+TextureArrayReducer::TextureKey::
+TextureKey(Texture *tex) :
+  _x_size(tex->get_x_size()),
+  _y_size(tex->get_y_size()),
+  _num_components(tex->get_num_components()),
+  _component_type(tex->get_component_type()),
+  _format(tex->get_format()),
+  _compression(tex->get_ram_image_compression()),
+  _sampler(tex->get_default_sampler())
+{
+}
+
+/**
+ *
+ */
+bool TextureArrayReducer::TextureKey::
+operator < (const TextureKey &other) const {
+  if (_x_size != other._x_size) {
+    return _x_size < other._x_size;
+  }
+  if (_y_size != other._y_size) {
+    return _y_size < other._y_size;
+  }
+  if (_num_components != other._num_components) {
+    return _num_components < other._num_components;
+  }
+  if (_component_type != other._component_type) {
+    return _component_type < other._component_type;
+  }
+  if (_format != other._format) {
+    return _format < other._format;
+  }
+  if (_compression != other._compression) {
+    return _compression < other._compression;
+  }
+  return _sampler < other._sampler;
+}
+
+/**
+ * Records the Geoms of the indicated GeomNode that have a suitable texture.
+ */
+void TextureArrayReducer::
+scan_geom_node(GeomNode *node, const RenderState *state) {
+  GeomNode::Geoms geoms = node->get_geoms();
+  int num_geoms = geoms.get_num_geoms();
+  for (int i = 0; i < num_geoms; ++i) {
+    CPT(RenderState) geom_net_state = state->compose(geoms.get_geom_state(i));
+
+    const TextureAttrib *ta;
+    if (!geom_net_state->get_attrib(ta) || ta->get_num_on_stages() != 1) {
+      continue;
+    }
+    TextureStage *stage = ta->get_on_stage(0);
+    Texture *tex = ta->get_on_texture(stage);
+    if (!is_eligible(tex)) {
+      continue;
+    }
+
+    Group &group = _groups[TextureKey(tex)];
+    if (std::find(group._textures.begin(), group._textures.end(), tex) == group._textures.end()) {
+      group._textures.push_back(tex);
+    }
+
+    GeomInfo info;
+    info._geom_node = node;
+    info._index = i;
+    info._stage = stage;
+    info._tex = tex;
+    info._override = geom_net_state->get_override(TextureAttrib::get_class_slot());
+    group._geoms.push_back(std::move(info));
+  }
+}
+
+/**
+ * Returns true if the indicated texture may be packed into an array.
+ */
+bool TextureArrayReducer::
+is_eligible(Texture *tex) const {
+  return tex != nullptr &&
+    tex->get_texture_type() == Texture::TT_2d_texture &&
+    tex->might_have_ram_image() &&
+    tex->get_x_size() > 0 && tex->get_y_size() > 0;
+}
+
+/**
+ * Creates array textures holding the indicated textures, which all share the
+ * same properties, and records the layer that each texture ended up in.
+ */
+void TextureArrayReducer::
+make_arrays(const pvector<PT(Texture)> &textures, Layers &layers) {
+  // Fetch the images first, since some of the textures may turn out not to
+  // have one after all.
+  pvector<PT(Texture)> packed;
+  pvector<CPTA_uchar> images;
+  size_t page_size = 0;
+  for (Texture *tex : textures) {
+    CPTA_uchar image = tex->get_ram_image();
+    if (image.is_null() || tex->get_z_size() != 1) {
+      continue;
+    }
+    size_t tex_page_size = tex->get_ram_page_size();
+    if (page_size == 0) {
+      page_size = tex_page_size;
+    } else if (tex_page_size != page_size) {
+      continue;
+    }
+    packed.push_back(tex);
+    images.push_back(image);
+  }
+
+  if (packed.size() < 2) {
+    return;
+  }
+
+  const Texture *first = packed[0];
+  size_t start = 0;
+  while (start < packed.size()) {
+    size_t num_layers = std::min(packed.size() - start, (size_t)_max_layers);
+
+    PT(Texture) array = new Texture(first->get_name() + "_array");
+    array->setup_2d_texture_array(first->get_x_size(), first->get_y_size(),
+                                  (int)num_layers, first->get_component_type(),
+                                  first->get_format());
+    array->set_default_sampler(first->get_default_sampler());
+
+    PTA_uchar image = PTA_uchar::empty_array(page_size * num_layers);
+    for (size_t i = 0; i < num_layers; ++i) {
+      memcpy(image.p() + page_size * i, images[start + i].p(), page_size);
+
+      Layer &layer = layers[packed[start + i]];
+      layer._array = array;
+      layer._layer = (int)i;
+    }
+    array->set_ram_image(image, first->get_ram_image_compression(), page_size);
+
+    _arrays.push_back(array);
+    _num_textures += (int)num_layers;
+    start += num_layers;
+  }
+}
+
+/**
+ * Returns a copy of the indicated Geom, in which the named texture
+ * coordinates have been extended with a third component that contains the
+ * layer index.  Returns nullptr if the Geom has no such texture coordinates.
+ */
+CPT(Geom) TextureArrayReducer::
+set_texcoord_layer(const Geom *geom, const InternalName *name, int layer,
+                   LayerGeoms &layer_geoms) const {
+  LayerGeoms::const_iterator lgi = layer_geoms.find(std::make_pair(geom, layer));
+  if (lgi != layer_geoms.end()) {
+    return (*lgi).second;
+  }
+
+  CPT(GeomVertexData) vdata = geom->get_vertex_data();
+  const GeomVertexFormat *format = vdata->get_format();
+  int array_index = format->get_array_with(name);
+  if (array_index < 0) {
+    return nullptr;
+  }
+
+  const GeomVertexColumn *column = format->get_column(name);
+  PT(GeomVertexData) new_vdata;
+  if (column->get_num_components() >= 3) {
+    new_vdata = new GeomVertexData(*vdata);
+  } else {
+    // Widen the column to hold the layer index.
+    PT(GeomVertexArrayFormat) array_format =
+      new GeomVertexArrayFormat(*format->get_array(array_index));
+    array_format->remove_column(name);
+    array_format->add_column(name, 3, column->get_numeric_type(),
+                             column->get_contents());
+
+    PT(GeomVertexFormat) new_format = new GeomVertexFormat(*format);
+    new_format->set_array(array_index, array_format);
+    new_vdata = new GeomVertexData(
+      *vdata->convert_to(GeomVertexFormat::register_format(new_format)));
+  }
+
+  GeomVertexRewriter texcoord(new_vdata, name);
+  while (!texcoord.is_at_end()) {
+    LTexCoord uv = texcoord.get_data2();
+    texcoord.set_data3(uv[0], uv[1], (PN_stdfloat)layer);
+  }
+
+  PT(Geom) new_geom = geom->make_copy();
+  new_geom->set_vertex_data(new_vdata);
+
+  CPT(Geom) result = new_geom;
+  layer_geoms[std::make_pair(geom, layer)] = result;
+  return result;
+}
@@ -0,0 +1,131 @@
+/**
+ * PANDA 3D SOFTWARE
+ * Copyright (c) Carnegie Mellon University.  All rights reserved.
+ *
+ * All use of this software is subject to the terms of the revised BSD
+ * license.  You should have received a copy of this license along
+ * with this source code in a file named "LICENSE."
+ *
+ * @file textureArrayReducer.h
+ * @author blablabla94
+ * @date 2026-10-16
+ */
+
+#ifndef TEXTUREARRAYREDUCER_H
+#define TEXTUREARRAYREDUCER_H
+
+#include "pandabase.h"
+#include "texture.h"
+#include "textureStage.h"
+#include "samplerState.h"
+#include "geomNode.h"
+#include "nodePath.h"
+#include "internalName.h"
+#include "renderState.h"
+#include "pointerTo.h"
+#include "pmap.h"
+#include "pvector.h"
+
+class PandaNode;
+
+/**
+ * This object packs textures of the same size and format into 2-d texture
+ * arrays, so that Geoms that differ only in their texture end up sharing the
+ * same texture binding.  This reduces the number of texture changes when the
+ * Geoms are rendered in a state-sorted bin.
+ *
+ * Since a texture array must be sampled with a sampler2DArray, this requires
+ * that the Geoms are rendered with a shader that is written to expect this.
+ * The index of the layer to sample is made available to the shader either
+ * through the shader input named "texture_layer", or, if
+ * set_layer_in_texcoord() is set, as the third component of the texture
+ * coordinates.  In the latter case, the Geoms sharing an array texture also
+ * end up with identical states, which allows them to be merged by
+ * dynamic-batching.
+ *
+ * Only Geoms that have a single 2-d texture with a RAM image are considered.
+ * Only the base mipmap level of each texture is copied into the arrays.
+ */
+class EXPCL_PANDA_GRUTIL TextureArrayReducer {
+PUBLISHED:
+  TextureArrayReducer();
+  ~TextureArrayReducer();
+
+  void clear();
+  INLINE void scan(const NodePath &node);
+  void scan(PandaNode *node, const RenderState *state);
+
+  INLINE void set_layer_in_texcoord(bool layer_in_texcoord);
+  INLINE bool get_layer_in_texcoord() const;
+  INLINE void set_max_layers(int max_layers);
+  INLINE int get_max_layers() const;
+
+  int flatten();
+
+  INLINE int get_num_textures() const;
+  INLINE int get_num_arrays() const;
+  INLINE Texture *get_array(int n) const;
+  MAKE_SEQ(get_arrays, get_num_arrays, get_array);
+
+  static CPT(InternalName) get_layer_input_name();
+
+private:
+  class TextureKey {
+  public:
+    TextureKey(Texture *tex);
+    bool operator < (const TextureKey &other) const;
+
+    int _x_size;
+    int _y_size;
+    int _num_components;
+    Texture::ComponentType _component_type;
+    Texture::Format _format;
+    Texture::CompressionMode _compression;
+    SamplerState _sampler;
+  };
+
+  class GeomInfo {
+  public:
+    PT(GeomNode) _geom_node;
+    int _index;
+    PT(TextureStage) _stage;
+    PT(Texture) _tex;
+    int _override;
+  };
+  typedef pvector<GeomInfo> GeomList;
+
+  class Group {
+  public:
+    pvector<PT(Texture)> _textures;
+    GeomList _geoms;
+  };
+  typedef pmap<TextureKey, Group> Groups;
+
+  // Maps each original texture to the array and layer it was packed into.
+  class Layer {
+  public:
+    PT(Texture) _array;
+    int _layer;
+  };
+  typedef pmap<Texture *, Layer> Layers;
+
+  // Geoms that have been rewritten for a particular layer, so that a Geom
+  // shared by several nodes is only copied once per layer.
+  typedef pmap<std::pair<const Geom *, int>, CPT(Geom)> LayerGeoms;
+
+  void scan_geom_node(GeomNode *node, const RenderState *state);
+  bool is_eligible(Texture *tex) const;
+  void make_arrays(const pvector<PT(Texture)> &textures, Layers &layers);
+  CPT(Geom) set_texcoord_layer(const Geom *geom, const InternalName *name,
+                               int layer, LayerGeoms &layer_geoms) const;
+
+  Groups _groups;
+  pvector<PT(Texture)> _arrays;
+  int _num_textures;
+  bool _layer_in_texcoord;
+  int _max_layers;
+};
+
+#include "textureArrayReducer.I"
+
+#endif
@@ -0,0 +1,270 @@
+/**
+ * PANDA 3D SOFTWARE
+ * Copyright (c) Carnegie Mellon University.  All rights reserved.
+ *
+ * All use of this software is subject to the terms of the revised BSD
+ * license.  You should have received a copy of this license along
+ * with this source code in a file named "LICENSE."
+ *
+ * @file vertexDataPrefetcher.cxx
+ * @author blablabla94
+ * @date 2026-10-17
+ */
+
+#include "vertexDataPrefetcher.h"
+#include "config_grutil.h"
+#include "geomNode.h"
+#include "lensNode.h"
+#include "lens.h"
+#include "clockObject.h"
+#include "pStatTimer.h"
+#include "dcast.h"
+
+PStatCollector VertexDataPrefetcher::_prefetch_pcollector("App:Prefetch vertex data");
+PStatCollector VertexDataPrefetcher::_requests_pcollector("Vertex prefetch requests");
+
+/**
+ *
+ */
+VertexDataPrefetcher::
+VertexDataPrefetcher(const NodePath &scene, const NodePath &camera) :
+  _scene(scene),
+  _camera(camera),
+  _lookahead(0.5),
+  _margin(0.25f),
+  _max_distance(0.0f)
+{
+  reset();
+}
+
+/**
+ * Samples the camera's motion, and asks for the vertex data of the part of
+ * the scene that the camera is predicted to see get_lookahead() seconds from
+ * now to be brought into memory.  This should be called once per frame.
+ *
+ * Returns the number of Geoms whose data was not yet resident.
+ */
+int VertexDataPrefetcher::
+update() {
+  if (_scene.is_empty() || _camera.is_empty()) {
+    return 0;
+  }
+
+  PStatTimer timer(_prefetch_pcollector);
+
+  double now = ClockObject::get_global_clock()->get_frame_time();
+  CPT(TransformState) transform = _camera.get_transform(_scene);
+
+  if (_has_sample && now > _last_time) {
+    PN_stdfloat dt = (PN_stdfloat)(now - _last_time);
+    LVector3 velocity = (transform->get_pos() - _last_transform->get_pos()) / dt;
+
+    // Express the rotation since the last sample as an angular velocity: the
+    // direction is the axis, and the length is the rate in radians/second.
+    LQuaternion delta = invert(_last_transform->get_norm_quat()) * transform->get_norm_quat();
+    if (delta.get_r() < 0) {
+      delta = delta * -1;
+    }
+    LVector3 axis(delta.get_i(), delta.get_j(), delta.get_k());
+    PN_stdfloat sin_half = axis.length();
+    LVector3 angular_velocity = LVector3::zero();
+    if (sin_half > 1.0e-6f) {
+      PN_stdfloat angle = 2.0f * catan2(sin_half, delta.get_r());
+      angular_velocity = axis * (angle / (sin_half * dt));
+    }
+
+    // Smooth the samples a little, since the frame time is noisy.
+    _velocity = (_velocity + velocity) * 0.5f;
+    _angular_velocity = (_angular_velocity + angular_velocity) * 0.5f;
+  }
+
+  _has_sample = true;
+  _last_time = now;
+  _last_transform = transform;
+
+  PT(GeometricBoundingVolume) region = make_predicted_bounds();
+  if (region == nullptr) {
+    return 0;
+  }
+
+  int num_requested = prefetch(_scene, region);
+  _requests_pcollector.set_level(num_requested);
+  return num_requested;
+}
+
+/**
+ * Forgets the camera's past motion, for instance after the camera has been
+ * teleported to a new location.
+ */
+void VertexDataPrefetcher::
+reset() {
+  _has_sample = false;
+  _last_time = 0.0;
+  _last_transform = TransformState::make_identity();
+  _velocity = LVector3::zero();
+  _angular_velocity = LVector3::zero();
+}
+
+/**
+ * Returns the transform of the camera, relative to the scene, that update()
+ * predicts get_lookahead() seconds from now.
+ */
+CPT(TransformState) VertexDataPrefetcher::
+get_predicted_transform() const {
+  nassertr(!_scene.is_empty() && !_camera.is_empty(), TransformState::make_identity());
+
+  CPT(TransformState) transform = _camera.get_transform(_scene);
+  if (!_has_sample) {
+    return transform;
+  }
+
+  LPoint3 pos = transform->get_pos() + _velocity * (PN_stdfloat)_lookahead;
+
+  LQuaternion quat = transform->get_norm_quat();
+  PN_stdfloat rate = _angular_velocity.length();
+  if (rate > 1.0e-6f) {
+    // Don't extrapolate more than a quarter turn; beyond that the prediction
+    // is not likely to be useful.
+    PN_stdfloat angle = std::min(rate * (PN_stdfloat)_lookahead, (PN_stdfloat)(MathNumbers::pi * 0.5));
+    LQuaternion delta;
+    delta.set_from_axis_angle_rad(angle, _angular_velocity / rate);
+    quat = quat * delta;
+  }
+
+  return TransformState::make_pos_quat_scale_shear
+    (pos, quat, transform->get_scale(), transform->get_shear());
+}
+
+/**
+ * Returns the bounding volume, in the coordinate space of the scene, of the
+ * camera's predicted view frustum, widened by get_margin() and limited by
+ * get_max_distance().  Returns NULL if the camera does not have a lens.
+ */
+PT(GeometricBoundingVolume) VertexDataPrefetcher::
+make_predicted_bounds() const {
+  nassertr(!_scene.is_empty() && !_camera.is_empty(), nullptr);
+
+  if (!_camera.node()->is_of_type(LensNode::get_class_type())) {
+    grutil_cat.error()
+      << "VertexDataPrefetcher camera " << _camera << " is not a LensNode.\n";
+    return nullptr;
+  }
+  Lens *lens = DCAST(LensNode, _camera.node())->get_lens();
+  if (lens == nullptr) {
+    return nullptr;
+  }
+
+  PT(Lens) copy = lens->make_copy();
+  if (_margin > 0.0f) {
+    if (copy->is_perspective()) {
+      LVecBase2 fov = copy->get_fov() * (1.0f + _margin);
+      fov[0] = std::min(fov[0], (PN_stdfloat)170.0f);
+      fov[1] = std::min(fov[1], (PN_stdfloat)170.0f);
+      copy->set_fov(fov);
+    } else {
+      copy->set_film_size(copy->get_film_size() * (1.0f + _margin));
+    }
+  }
+  if (_max_distance > copy->get_near() && _max_distance < copy->get_far()) {
+    copy->set_far(_max_distance);
+  }
+
+  PT(BoundingVolume) bounds = copy->make_bounds();
+  if (bounds == nullptr) {
+    return nullptr;
+  }
+  PT(GeometricBoundingVolume) region = bounds->as_geometric_bounding_volume();
+  nassertr(region != nullptr, nullptr);
+  region->xform(get_predicted_transform()->get_mat());
+  return region;
+}
+
+/**
+ * Asks for the vertex data of all the Geoms at and below the indicated node
+ * to be brought into memory.  Returns the number of Geoms whose data was not
+ * yet resident.
+ */
+int VertexDataPrefetcher::
+prefetch(const NodePath &root) {
+  nassertr(!root.is_empty(), 0);
+  return r_prefetch(root.node(), nullptr, Thread::get_current_thread());
+}
+
+/**
+ * Asks for the vertex data of the Geoms at and below the indicated node that
+ * intersect the indicated region, which is given in the coordinate space of
+ * the root node, to be brought into memory.  Returns the number of Geoms
+ * whose data was not yet resident.
+ */
+int VertexDataPrefetcher::
+prefetch(const NodePath &root, const GeometricBoundingVolume *region) {
+  nassertr(!root.is_empty(), 0);
+  Thread *current_thread = Thread::get_current_thread();
+
+  // r_prefetch() expects the region in the space of the root's parent.
+  PT(GeometricBoundingVolume) xformed_region;
+  if (region != nullptr) {
+    CPT(TransformState) transform = root.node()->get_transform(current_thread);
+    if (!transform->is_identity()) {
+      xformed_region = region->make_copy()->as_geometric_bounding_volume();
+      xformed_region->xform(transform->get_mat());
+      region = xformed_region;
+    }
+  }
+  return r_prefetch(root.node(), region, current_thread);
+}
+
+/**
+ * The recursive implementation of prefetch().  The region, if not NULL, is in
+ * the coordinate space of the node's parent, which is also the space of the
+ * node's bounding volume.
+ */
+int VertexDataPrefetcher::
+r_prefetch(PandaNode *node, const GeometricBoundingVolume *region,
+           Thread *current_thread) {
+  PT(GeometricBoundingVolume) xformed_region;
+  if (region != nullptr) {
+    CPT(BoundingVolume) bounds = node->get_bounds(current_thread);
+    int result = region->contains(bounds->as_geometric_bounding_volume());
+    if (result == BoundingVolume::IF_no_intersection) {
+      return 0;
+    }
+    if ((result & BoundingVolume::IF_all) != 0) {
+      // Everything below here is within the region.
+      region = nullptr;
+
+    } else {
+      // Move the region into the node's own coordinate space.  If we can't,
+      // we just prefetch everything below.
+      CPT(TransformState) transform = node->get_transform(current_thread);
+      if (transform->is_singular()) {
+        region = nullptr;
+      } else if (!transform->is_identity()) {
+        xformed_region = region->make_copy()->as_geometric_bounding_volume();
+        xformed_region->xform(transform->get_inverse()->get_mat());
+        region = xformed_region;
+      }
+    }
+  }
+
+  int num_requested = 0;
+
+  if (node->is_geom_node()) {
+    GeomNode *gnode = (GeomNode *)node;
+    GeomNode::Geoms geoms = gnode->get_geoms(current_thread);
+    int num_geoms = geoms.get_num_geoms();
+    for (int i = 0; i < num_geoms; ++i) {
+      if (!geoms.get_geom(i)->request_prefetch()) {
+        ++num_requested;
+      }
+    }
+  }
+
+  PandaNode::Children children = node->get_children(current_thread);
+  int num_children = children.get_num_children();
+  for (int i = 0; i < num_children; ++i) {
+    num_requested += r_prefetch(children.get_child(i), region, current_thread);
+  }
+
+  return num_requested;
+}
@@ -0,0 +1,97 @@
+/**
+ * PANDA 3D SOFTWARE
+ * Copyright (c) Carnegie Mellon University.  All rights reserved.
+ *
+ * All use of this software is subject to the terms of the revised BSD
+ * license.  You should have received a copy of this license along
+ * with this source code in a file named "LICENSE."
+ *
+ * @file vertexDataPrefetcher.h
+ * @author blablabla94
+ * @date 2026-10-17
+ */
+
+#ifndef VERTEXDATAPREFETCHER_H
+#define VERTEXDATAPREFETCHER_H
+
+#include "pandabase.h"
+#include "nodePath.h"
+#include "geometricBoundingVolume.h"
+#include "transformState.h"
+#include "luse.h"
+#include "pStatCollector.h"
+
+class PandaNode;
+
+/**
+ * This object asks for the vertex data of a scene to be brought back into
+ * memory before it is needed, when vertex data paging is enabled via
+ * max-resident-vertex-data or max-compressed-vertex-data.  Ordinarily, paged-
+ * out vertex data is only requested when a Geom is about to be rendered,
+ * which can stall the render thread.
+ *
+ * The static prefetch() methods may be used to request the vertex data of
+ * a particular subgraph, or of the part of a subgraph that intersects a
+ * bounding volume.  Alternatively, call update() once per frame to prefetch
+ * the part of the scene that the camera is predicted to see a short time
+ * from now, extrapolated from the camera's recent motion.
+ *
+ * Prefetch requests are serviced by the vertex paging threads (see vertex-
+ * data-page-threads) after any data that is needed immediately.
+ */
+class EXPCL_PANDA_GRUTIL VertexDataPrefetcher {
+PUBLISHED:
+  explicit VertexDataPrefetcher(const NodePath &scene = NodePath(),
+                                const NodePath &camera = NodePath());
+
+  INLINE void set_scene(const NodePath &scene);
+  INLINE const NodePath &get_scene() const;
+  INLINE void set_camera(const NodePath &camera);
+  INLINE const NodePath &get_camera() const;
+
+  INLINE void set_lookahead(double lookahead);
+  INLINE double get_lookahead() const;
+  INLINE void set_margin(PN_stdfloat margin);
+  INLINE PN_stdfloat get_margin() const;
+  INLINE void set_max_distance(PN_stdfloat max_distance);
+  INLINE PN_stdfloat get_max_distance() const;
+
+  MAKE_PROPERTY(scene, get_scene, set_scene);
+  MAKE_PROPERTY(camera, get_camera, set_camera);
+  MAKE_PROPERTY(lookahead, get_lookahead, set_lookahead);
+  MAKE_PROPERTY(margin, get_margin, set_margin);
+  MAKE_PROPERTY(max_distance, get_max_distance, set_max_distance);
+
+  int update();
+  void reset();
+
+  CPT(TransformState) get_predicted_transform() const;
+  PT(GeometricBoundingVolume) make_predicted_bounds() const;
+
+  static int prefetch(const NodePath &root);
+  static int prefetch(const NodePath &root, const GeometricBoundingVolume *region);
+
+private:
+  static int r_prefetch(PandaNode *node, const GeometricBoundingVolume *region,
+                        Thread *current_thread);
+
+  NodePath _scene;
+  NodePath _camera;
+  double _lookahead;
+  PN_stdfloat _margin;
+  PN_stdfloat _max_distance;
+
+  // The camera motion, measured relative to the scene.
+  bool _has_sample;
+  double _last_time;
+  CPT(TransformState) _last_transform;
+  LVector3 _velocity;
+  LVector3 _angular_velocity;
+
+  static PStatCollector _prefetch_pcollector;
+  static PStatCollector _requests_pcollector;
+};
+
+#include "vertexDataPrefetcher.I"
+
+#endif
@@ -216,6 +216,10 @@ public:
   virtual bool draw_linestrips_adj(const GeomPrimitivePipelineReader *reader, bool force)=0;
   virtual bool draw_points(const GeomPrimitivePipelineReader *reader, bool force)=0;
   virtual void end_draw_primitives()=0;
+  virtual bool draw_geoms(const GeomPipelineReader * const *geom_readers,
+                          size_t num_geoms,
+                          const GeomVertexDataPipelineReader *data_reader,
+                          bool force)=0;
 
   virtual bool framebuffer_copy_to_texture
   (Texture *tex, int view, int z, const DisplayRegion *dr, const RenderBuffer &rb)=0;
@@ -20,11 +20,69 @@
 #include <math.h>
 #include <algorithm>
 
+// The batched tests in contains_spheres() and contains_boxes() can make use
+// of SIMD instructions when compiled for single-precision floats.
+#ifndef STDFLOAT_DOUBLE
+#if defined(__AVX__)
+#include <immintrin.h>
+#define HEXAHEDRON_AVX
+#elif defined(__SSE2__) || (_M_IX86_FP >= 2) || defined(_M_X64) || defined(_M_AMD64)
+#include <emmintrin.h>
+#define HEXAHEDRON_SSE2
+#elif defined(__ARM_NEON) || defined(_M_ARM64)
+#include <arm_neon.h>
+#define HEXAHEDRON_NEON
+#endif
+#endif
+
 using std::max;
 using std::min;
 
 TypeHandle BoundingHexahedron::_type_handle;
 
+/**
+ * Returns the IntersectionFlags for a volume, given whether it was found to be
+ * completely in front of any plane, and whether it was found to be at least
+ * partly in front of any plane.
+ */
+static INLINE unsigned char
+intersection_flags(bool outside, bool partial) {
+  if (outside) {
+    return BoundingVolume::IF_no_intersection;
+  } else if (partial) {
+    return BoundingVolume::IF_possible | BoundingVolume::IF_some;
+  } else {
+    return BoundingVolume::IF_possible | BoundingVolume::IF_some | BoundingVolume::IF_all;
+  }
+}
+
+#if defined(HEXAHEDRON_AVX) || defined(HEXAHEDRON_SSE2) || defined(HEXAHEDRON_NEON)
+/**
+ * Stores the results of a SIMD batch, given as a bitmask with one bit per
+ * lane for each of the two conditions.
+ */
+static INLINE void
+store_flags(unsigned char *results, int width, int outside, int partial) {
+  for (int j = 0; j < width; ++j) {
+    results[j] = intersection_flags((outside >> j) & 1, (partial >> j) & 1);
+  }
+}
+#endif
+
+#ifdef HEXAHEDRON_NEON
+/**
+ * Returns a bitmask with one bit for each lane of the comparison result that
+ * is set, like _mm_movemask_ps() does on SSE.
+ */
+static INLINE int
+neon_movemask(uint32x4_t mask) {
+  return (int)((vgetq_lane_u32(mask, 0) & 1) |
+               (vgetq_lane_u32(mask, 1) & 2) |
+               (vgetq_lane_u32(mask, 2) & 4) |
+               (vgetq_lane_u32(mask, 3) & 8));
+}
+#endif
+
 /**
  *
  */
@@ -194,6 +252,434 @@ as_bounding_hexahedron() const {
   return this;
 }
 
+/**
+ * Tests a batch of bounding spheres against the hexahedron at once.  The
+ * spheres are given as a structure of arrays, each of which must contain
+ * num_spheres elements.  On return, results[i] is filled in with the same
+ * IntersectionFlags that contains() would return for the ith sphere.
+ *
+ * This is intended for the benefit of the cull traversal, which tests many
+ * volumes against the same frustum; where available, four or eight spheres
+ * are tested in parallel using SIMD instructions.
+ */
+void BoundingHexahedron::
+contains_spheres(size_t num_spheres, const PN_stdfloat *center_x,
+                 const PN_stdfloat *center_y, const PN_stdfloat *center_z,
+                 const PN_stdfloat *radius, unsigned char *results) const {
+  nassertv(!is_empty());
+
+  size_t i = 0;
+
+#if defined(HEXAHEDRON_AVX)
+  __m256 pa[num_planes], pb[num_planes], pc[num_planes], pd[num_planes];
+  for (int p = 0; p < num_planes; ++p) {
+    pa[p] = _mm256_set1_ps(_planes[p][0]);
+    pb[p] = _mm256_set1_ps(_planes[p][1]);
+    pc[p] = _mm256_set1_ps(_planes[p][2]);
+    pd[p] = _mm256_set1_ps(_planes[p][3]);
+  }
+  for (; i + 8 <= num_spheres; i += 8) {
+    __m256 x = _mm256_loadu_ps(center_x + i);
+    __m256 y = _mm256_loadu_ps(center_y + i);
+    __m256 z = _mm256_loadu_ps(center_z + i);
+    __m256 r = _mm256_loadu_ps(radius + i);
+    __m256 neg_r = _mm256_sub_ps(_mm256_setzero_ps(), r);
+    __m256 outside = _mm256_setzero_ps();
+    __m256 partial = _mm256_setzero_ps();
+    for (int p = 0; p < num_planes; ++p) {
+      __m256 dist = _mm256_add_ps(
+        _mm256_add_ps(_mm256_mul_ps(pa[p], x), _mm256_mul_ps(pb[p], y)),
+        _mm256_add_ps(_mm256_mul_ps(pc[p], z), pd[p]));
+      outside = _mm256_or_ps(outside, _mm256_cmp_ps(dist, r, _CMP_GT_OQ));
+      partial = _mm256_or_ps(partial, _mm256_cmp_ps(dist, neg_r, _CMP_GT_OQ));
+    }
+    store_flags(results + i, 8, _mm256_movemask_ps(outside),
+                _mm256_movemask_ps(partial));
+  }
+
+#elif defined(HEXAHEDRON_SSE2)
+  __m128 pa[num_planes], pb[num_planes], pc[num_planes], pd[num_planes];
+  for (int p = 0; p < num_planes; ++p) {
+    pa[p] = _mm_set1_ps(_planes[p][0]);
+    pb[p] = _mm_set1_ps(_planes[p][1]);
+    pc[p] = _mm_set1_ps(_planes[p][2]);
+    pd[p] = _mm_set1_ps(_planes[p][3]);
+  }
+  for (; i + 4 <= num_spheres; i += 4) {
+    __m128 x = _mm_loadu_ps(center_x + i);
+    __m128 y = _mm_loadu_ps(center_y + i);
+    __m128 z = _mm_loadu_ps(center_z + i);
+    __m128 r = _mm_loadu_ps(radius + i);
+    __m128 neg_r = _mm_sub_ps(_mm_setzero_ps(), r);
+    __m128 outside = _mm_setzero_ps();
+    __m128 partial = _mm_setzero_ps();
+    for (int p = 0; p < num_planes; ++p) {
+      __m128 dist = _mm_add_ps(
+        _mm_add_ps(_mm_mul_ps(pa[p], x), _mm_mul_ps(pb[p], y)),
+        _mm_add_ps(_mm_mul_ps(pc[p], z), pd[p]));
+      outside = _mm_or_ps(outside, _mm_cmpgt_ps(dist, r));
+      partial = _mm_or_ps(partial, _mm_cmpgt_ps(dist, neg_r));
+    }
+    store_flags(results + i, 4, _mm_movemask_ps(outside),
+                _mm_movemask_ps(partial));
+  }
+
+#elif defined(HEXAHEDRON_NEON)
+  float32x4_t pa[num_planes], pb[num_planes], pc[num_planes], pd[num_planes];
+  for (int p = 0; p < num_planes; ++p) {
+    pa[p] = vdupq_n_f32(_planes[p][0]);
+    pb[p] = vdupq_n_f32(_planes[p][1]);
+    pc[p] = vdupq_n_f32(_planes[p][2]);
+    pd[p] = vdupq_n_f32(_planes[p][3]);
+  }
+  for (; i + 4 <= num_spheres; i += 4) {
+    float32x4_t x = vld1q_f32(center_x + i);
+    float32x4_t y = vld1q_f32(center_y + i);
+    float32x4_t z = vld1q_f32(center_z + i);
+    float32x4_t r = vld1q_f32(radius + i);
+    float32x4_t neg_r = vnegq_f32(r);
+    uint32x4_t outside = vdupq_n_u32(0);
+    uint32x4_t partial = vdupq_n_u32(0);
+    for (int p = 0; p < num_planes; ++p) {
+      float32x4_t dist = vmlaq_f32(vmlaq_f32(vmlaq_f32(pd[p], pa[p], x), pb[p], y), pc[p], z);
+      outside = vorrq_u32(outside, vcgtq_f32(dist, r));
+      partial = vorrq_u32(partial, vcgtq_f32(dist, neg_r));
+    }
+    store_flags(results + i, 4, neon_movemask(outside),
+                neon_movemask(partial));
+  }
+#endif
+
+  // Handle the remainder, or all of them if we have no SIMD support.
+  for (; i < num_spheres; ++i) {
+    bool outside = false;
+    bool partial = false;
+    for (int p = 0; p < num_planes; ++p) {
+      const LPlane &plane = _planes[p];
+      PN_stdfloat dist = plane[0] * center_x[i] + plane[1] * center_y[i] +
+                         plane[2] * center_z[i] + plane[3];
+      outside |= (dist > radius[i]);
+      partial |= (dist > -radius[i]);
+    }
+    results[i] = intersection_flags(outside, partial);
+  }
+}
+
+/**
+ * Tests a batch of axis-aligned boxes against the hexahedron at once.  The
+ * boxes are given by their minimum and maximum corners as a structure of
+ * arrays, each of which must contain num_boxes elements.  On return,
+ * results[i] is filled in with the same IntersectionFlags that contains()
+ * would return for the ith box.
+ *
+ * Rather than testing all eight corners of each box against each plane, this
+ * tests only the corners nearest to and furthest from the plane, which are
+ * found from the box's center and half-extents.
+ */
+void BoundingHexahedron::
+contains_boxes(size_t num_boxes,
+               const PN_stdfloat *min_x, const PN_stdfloat *min_y,
+               const PN_stdfloat *min_z, const PN_stdfloat *max_x,
+               const PN_stdfloat *max_y, const PN_stdfloat *max_z,
+               unsigned char *results) const {
+  nassertv(!is_empty());
+
+  size_t i = 0;
+
+#if defined(HEXAHEDRON_AVX)
+  __m256 pa[num_planes], pb[num_planes], pc[num_planes], pd[num_planes];
+  __m256 aa[num_planes], ab[num_planes], ac[num_planes];
+  for (int p = 0; p < num_planes; ++p) {
+    pa[p] = _mm256_set1_ps(_planes[p][0]);
+    pb[p] = _mm256_set1_ps(_planes[p][1]);
+    pc[p] = _mm256_set1_ps(_planes[p][2]);
+    pd[p] = _mm256_set1_ps(_planes[p][3]);
+    aa[p] = _mm256_set1_ps(cabs(_planes[p][0]));
+    ab[p] = _mm256_set1_ps(cabs(_planes[p][1]));
+    ac[p] = _mm256_set1_ps(cabs(_planes[p][2]));
+  }
+  const __m256 half = _mm256_set1_ps(0.5f);
+  for (; i + 8 <= num_boxes; i += 8) {
+    __m256 lx = _mm256_loadu_ps(min_x + i);
+    __m256 ly = _mm256_loadu_ps(min_y + i);
+    __m256 lz = _mm256_loadu_ps(min_z + i);
+    __m256 hx = _mm256_loadu_ps(max_x + i);
+    __m256 hy = _mm256_loadu_ps(max_y + i);
+    __m256 hz = _mm256_loadu_ps(max_z + i);
+    __m256 cx = _mm256_mul_ps(_mm256_add_ps(lx, hx), half);
+    __m256 cy = _mm256_mul_ps(_mm256_add_ps(ly, hy), half);
+    __m256 cz = _mm256_mul_ps(_mm256_add_ps(lz, hz), half);
+    __m256 ex = _mm256_mul_ps(_mm256_sub_ps(hx, lx), half);
+    __m256 ey = _mm256_mul_ps(_mm256_sub_ps(hy, ly), half);
+    __m256 ez = _mm256_mul_ps(_mm256_sub_ps(hz, lz), half);
+    __m256 outside = _mm256_setzero_ps();
+    __m256 partial = _mm256_setzero_ps();
+    for (int p = 0; p < num_planes; ++p) {
+      __m256 dist = _mm256_add_ps(
+        _mm256_add_ps(_mm256_mul_ps(pa[p], cx), _mm256_mul_ps(pb[p], cy)),
+        _mm256_add_ps(_mm256_mul_ps(pc[p], cz), pd[p]));
+      __m256 extent = _mm256_add_ps(
+        _mm256_add_ps(_mm256_mul_ps(aa[p], ex), _mm256_mul_ps(ab[p], ey)),
+        _mm256_mul_ps(ac[p], ez));
+      outside = _mm256_or_ps(outside, _mm256_cmp_ps(_mm256_sub_ps(dist, extent), _mm256_setzero_ps(), _CMP_GE_OQ));
+      partial = _mm256_or_ps(partial, _mm256_cmp_ps(_mm256_add_ps(dist, extent), _mm256_setzero_ps(), _CMP_GE_OQ));
+    }
+    store_flags(results + i, 8, _mm256_movemask_ps(outside),
+                _mm256_movemask_ps(partial));
+  }
+
+#elif defined(HEXAHEDRON_SSE2)
+  __m128 pa[num_planes], pb[num_planes], pc[num_planes], pd[num_planes];
+  __m128 aa[num_planes], ab[num_planes], ac[num_planes];
+  for (int p = 0; p < num_planes; ++p) {
+    pa[p] = _mm_set1_ps(_planes[p][0]);
+    pb[p] = _mm_set1_ps(_planes[p][1]);
+    pc[p] = _mm_set1_ps(_planes[p][2]);
+    pd[p] = _mm_set1_ps(_planes[p][3]);
+    aa[p] = _mm_set1_ps(cabs(_planes[p][0]));
+    ab[p] = _mm_set1_ps(cabs(_planes[p][1]));
+    ac[p] = _mm_set1_ps(cabs(_planes[p][2]));
+  }
+  const __m128 half = _mm_set1_ps(0.5f);
+  for (; i + 4 <= num_boxes; i += 4) {
+    __m128 lx = _mm_loadu_ps(min_x + i);
+    __m128 ly = _mm_loadu_ps(min_y + i);
+    __m128 lz = _mm_loadu_ps(min_z + i);
+    __m128 hx = _mm_loadu_ps(max_x + i);
+    __m128 hy = _mm_loadu_ps(max_y + i);
+    __m128 hz = _mm_loadu_ps(max_z + i);
+    __m128 cx = _mm_mul_ps(_mm_add_ps(lx, hx), half);
+    __m128 cy = _mm_mul_ps(_mm_add_ps(ly, hy), half);
+    __m128 cz = _mm_mul_ps(_mm_add_ps(lz, hz), half);
+    __m128 ex = _mm_mul_ps(_mm_sub_ps(hx, lx), half);
+    __m128 ey = _mm_mul_ps(_mm_sub_ps(hy, ly), half);
+    __m128 ez = _mm_mul_ps(_mm_sub_ps(hz, lz), half);
+    __m128 outside = _mm_setzero_ps();
+    __m128 partial = _mm_setzero_ps();
+    for (int p = 0; p < num_planes; ++p) {
+      __m128 dist = _mm_add_ps(
+        _mm_add_ps(_mm_mul_ps(pa[p], cx), _mm_mul_ps(pb[p], cy)),
+        _mm_add_ps(_mm_mul_ps(pc[p], cz), pd[p]));
+      __m128 extent = _mm_add_ps(
+        _mm_add_ps(_mm_mul_ps(aa[p], ex), _mm_mul_ps(ab[p], ey)),
+        _mm_mul_ps(ac[p], ez));
+      outside = _mm_or_ps(outside, _mm_cmpge_ps(_mm_sub_ps(dist, extent), _mm_setzero_ps()));
+      partial = _mm_or_ps(partial, _mm_cmpge_ps(_mm_add_ps(dist, extent), _mm_setzero_ps()));
+    }
+    store_flags(results + i, 4, _mm_movemask_ps(outside),
+                _mm_movemask_ps(partial));
+  }
+
+#elif defined(HEXAHEDRON_NEON)
+  float32x4_t pa[num_planes], pb[num_planes], pc[num_planes], pd[num_planes];
+  float32x4_t aa[num_planes], ab[num_planes], ac[num_planes];
+  for (int p = 0; p < num_planes; ++p) {
+    pa[p] = vdupq_n_f32(_planes[p][0]);
+    pb[p] = vdupq_n_f32(_planes[p][1]);
+    pc[p] = vdupq_n_f32(_planes[p][2]);
+    pd[p] = vdupq_n_f32(_planes[p][3]);
+    aa[p] = vdupq_n_f32(cabs(_planes[p][0]));
+    ab[p] = vdupq_n_f32(cabs(_planes[p][1]));
+    ac[p] = vdupq_n_f32(cabs(_planes[p][2]));
+  }
+  const float32x4_t zero = vdupq_n_f32(0.0f);
+  for (; i + 4 <= num_boxes; i += 4) {
+    float32x4_t lx = vld1q_f32(min_x + i);
+    float32x4_t ly = vld1q_f32(min_y + i);
+    float32x4_t lz = vld1q_f32(min_z + i);
+    float32x4_t hx = vld1q_f32(max_x + i);
+    float32x4_t hy = vld1q_f32(max_y + i);
+    float32x4_t hz = vld1q_f32(max_z + i);
+    float32x4_t cx = vmulq_n_f32(vaddq_f32(lx, hx), 0.5f);
+    float32x4_t cy = vmulq_n_f32(vaddq_f32(ly, hy), 0.5f);
+    float32x4_t cz = vmulq_n_f32(vaddq_f32(lz, hz), 0.5f);
+    float32x4_t ex = vmulq_n_f32(vsubq_f32(hx, lx), 0.5f);
+    float32x4_t ey = vmulq_n_f32(vsubq_f32(hy, ly), 0.5f);
+    float32x4_t ez = vmulq_n_f32(vsubq_f32(hz, lz), 0.5f);
+    uint32x4_t outside = vdupq_n_u32(0);
+    uint32x4_t partial = vdupq_n_u32(0);
+    for (int p = 0; p < num_planes; ++p) {
+      float32x4_t dist = vmlaq_f32(vmlaq_f32(vmlaq_f32(pd[p], pa[p], cx), pb[p], cy), pc[p], cz);
+      float32x4_t extent = vmlaq_f32(vmlaq_f32(vmulq_f32(aa[p], ex), ab[p], ey), ac[p], ez);
+      outside = vorrq_u32(outside, vcgeq_f32(vsubq_f32(dist, extent), zero));
+      partial = vorrq_u32(partial, vcgeq_f32(vaddq_f32(dist, extent), zero));
+    }
+    store_flags(results + i, 4, neon_movemask(outside),
+                neon_movemask(partial));
+  }
+#endif
+
+  // Handle the remainder, or all of them if we have no SIMD support.
+  for (; i < num_boxes; ++i) {
+    PN_stdfloat cx = (min_x[i] + max_x[i]) * 0.5f;
+    PN_stdfloat cy = (min_y[i] + max_y[i]) * 0.5f;
+    PN_stdfloat cz = (min_z[i] + max_z[i]) * 0.5f;
+    PN_stdfloat ex = (max_x[i] - min_x[i]) * 0.5f;
+    PN_stdfloat ey = (max_y[i] - min_y[i]) * 0.5f;
+    PN_stdfloat ez = (max_z[i] - min_z[i]) * 0.5f;
+
+    bool outside = false;
+    bool partial = false;
+    for (int p = 0; p < num_planes; ++p) {
+      const LPlane &plane = _planes[p];
+      PN_stdfloat dist = plane[0] * cx + plane[1] * cy + plane[2] * cz + plane[3];
+      PN_stdfloat extent = cabs(plane[0]) * ex + cabs(plane[1]) * ey + cabs(plane[2]) * ez;
+      // The nearest corner is at dist - extent, the furthest at dist + extent.
+      outside |= (dist - extent >= 0.0f);
+      partial |= (dist + extent >= 0.0f);
+    }
+    results[i] = intersection_flags(outside, partial);
+  }
+}
+
+/**
+ * Tests a batch of arbitrary bounding volumes against the hexahedron.  On
+ * return, results[i] is filled in with the IntersectionFlags that contains()
+ * would return for the ith volume.
+ *
+ * The BoundingSpheres and BoundingBoxes in the list are gathered up and
+ * tested with contains_spheres() and contains_boxes(); any other kinds of
+ * volumes are tested one at a time.
+ */
+void BoundingHexahedron::
+contains_volumes(size_t num_volumes,
+                 const GeometricBoundingVolume *const *volumes,
+                 unsigned char *results) const {
+  nassertv(!is_empty());
+  if (num_volumes == 0) {
+    return;
+  }
+
+  // The coordinates are stored as a structure of arrays, with the spheres
+  // filling the first four arrays and the boxes all six, from the front.
+  pvector<PN_stdfloat> coords(num_volumes * 6);
+  PN_stdfloat *a0 = &coords[0];
+  PN_stdfloat *a1 = a0 + num_volumes;
+  PN_stdfloat *a2 = a1 + num_volumes;
+  PN_stdfloat *a3 = a2 + num_volumes;
+  PN_stdfloat *a4 = a3 + num_volumes;
+  PN_stdfloat *a5 = a4 + num_volumes;
+
+  pvector<size_t> spheres, boxes;
+  for (size_t i = 0; i < num_volumes; ++i) {
+    const GeometricBoundingVolume *volume = volumes[i];
+    if (!volume->is_empty() && !volume->is_infinite()) {
+      const BoundingSphere *sphere = volume->as_bounding_sphere();
+      if (sphere != nullptr) {
+        spheres.push_back(i);
+        continue;
+      }
+      const BoundingBox *box = volume->as_bounding_box();
+      if (box != nullptr) {
+        boxes.push_back(i);
+        continue;
+      }
+    }
+    results[i] = (unsigned char)contains(volume);
+  }
+
+  size_t num_spheres = spheres.size();
+  if (num_spheres != 0) {
+    for (size_t j = 0; j < num_spheres; ++j) {
+      const BoundingSphere *sphere = (const BoundingSphere *)volumes[spheres[j]];
+      const LPoint3 &center = sphere->get_center();
+      a0[j] = center[0];
+      a1[j] = center[1];
+      a2[j] = center[2];
+      a3[j] = sphere->get_radius();
+    }
+    pvector<unsigned char> sphere_results(num_spheres);
+    contains_spheres(num_spheres, a0, a1, a2, a3, &sphere_results[0]);
+    for (size_t j = 0; j < num_spheres; ++j) {
+      results[spheres[j]] = sphere_results[j];
+    }
+  }
+
+  size_t num_boxes = boxes.size();
+  if (num_boxes != 0) {
+    for (size_t j = 0; j < num_boxes; ++j) {
+      const BoundingBox *box = (const BoundingBox *)volumes[boxes[j]];
+      const LPoint3 &min_point = box->get_minq();
+      const LPoint3 &max_point = box->get_maxq();
+      a0[j] = min_point[0];
+      a1[j] = min_point[1];
+      a2[j] = min_point[2];
+      a3[j] = max_point[0];
+      a4[j] = max_point[1];
+      a5[j] = max_point[2];
+    }
+    pvector<unsigned char> box_results(num_boxes);
+    contains_boxes(num_boxes, a0, a1, a2, a3, a4, a5, &box_results[0]);
+    for (size_t j = 0; j < num_boxes; ++j) {
+      results[boxes[j]] = box_results[j];
+    }
+  }
+}
+
+/**
+ * Tests a batch of bounding spheres against the hexahedron at once, and
+ * returns the IntersectionFlags that contains() would return for each one.
+ * Each sphere is given as its center and radius, in the form (x, y, z,
+ * radius).
+ */
+vector_uchar BoundingHexahedron::
+contains_spheres(CPTA_LVecBase4 spheres) const {
+  size_t num_spheres = spheres.size();
+  vector_uchar results(num_spheres);
+  if (num_spheres == 0) {
+    return results;
+  }
+
+  pvector<PN_stdfloat> coords(num_spheres * 4);
+  PN_stdfloat *a0 = &coords[0];
+  PN_stdfloat *a1 = a0 + num_spheres;
+  PN_stdfloat *a2 = a1 + num_spheres;
+  PN_stdfloat *a3 = a2 + num_spheres;
+  for (size_t i = 0; i < num_spheres; ++i) {
+    const LVecBase4 &sphere = spheres[i];
+    a0[i] = sphere[0];
+    a1[i] = sphere[1];
+    a2[i] = sphere[2];
+    a3[i] = sphere[3];
+  }
+  contains_spheres(num_spheres, a0, a1, a2, a3, &results[0]);
+  return results;
+}
+
+/**
+ * Tests a batch of axis-aligned bounding boxes against the hexahedron at
+ * once, and returns the IntersectionFlags that contains() would return for
+ * each one.  The two arrays give the minimum and maximum corners of the
+ * boxes, and must be the same length.
+ */
+vector_uchar BoundingHexahedron::
+contains_boxes(CPTA_LVecBase3 min_points, CPTA_LVecBase3 max_points) const {
+  size_t num_boxes = min_points.size();
+  nassertr(max_points.size() == num_boxes, vector_uchar());
+  vector_uchar results(num_boxes);
+  if (num_boxes == 0) {
+    return results;
+  }
+
+  pvector<PN_stdfloat> coords(num_boxes * 6);
+  PN_stdfloat *a0 = &coords[0];
+  PN_stdfloat *a1 = a0 + num_boxes;
+  PN_stdfloat *a2 = a1 + num_boxes;
+  PN_stdfloat *a3 = a2 + num_boxes;
+  PN_stdfloat *a4 = a3 + num_boxes;
+  PN_stdfloat *a5 = a4 + num_boxes;
+  for (size_t i = 0; i < num_boxes; ++i) {
+    a0[i] = min_points[i][0];
+    a1[i] = min_points[i][1];
+    a2[i] = min_points[i][2];
+    a3[i] = max_points[i][0];
+    a4[i] = max_points[i][1];
+    a5[i] = max_points[i][2];
+  }
+  contains_boxes(num_boxes, a0, a1, a2, a3, a4, a5, &results[0]);
+  return results;
+}
+
 /**
  *
  */
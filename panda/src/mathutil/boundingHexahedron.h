@@ -19,6 +19,9 @@
 #include "finiteBoundingVolume.h"
 #include "frustum.h"
 #include "plane.h"
+#include "pta_LVecBase3.h"
+#include "pta_LVecBase4.h"
+#include "vector_uchar.h"
 
 #include "coordinateSystem.h"
 
@@ -65,9 +68,27 @@ PUBLISHED:
   MAKE_SEQ_PROPERTY(points, get_num_points, get_point);
   MAKE_SEQ_PROPERTY(planes, get_num_planes, get_plane);
 
+  vector_uchar contains_spheres(CPTA_LVecBase4 spheres) const;
+  vector_uchar contains_boxes(CPTA_LVecBase3 min_points,
+                              CPTA_LVecBase3 max_points) const;
+
 public:
   virtual const BoundingHexahedron *as_bounding_hexahedron() const;
 
+  void contains_spheres(size_t num_spheres, const PN_stdfloat *center_x,
+                        const PN_stdfloat *center_y,
+                        const PN_stdfloat *center_z,
+                        const PN_stdfloat *radius,
+                        unsigned char *results) const;
+  void contains_boxes(size_t num_boxes,
+                      const PN_stdfloat *min_x, const PN_stdfloat *min_y,
+                      const PN_stdfloat *min_z, const PN_stdfloat *max_x,
+                      const PN_stdfloat *max_y, const PN_stdfloat *max_z,
+                      unsigned char *results) const;
+  void contains_volumes(size_t num_volumes,
+                        const GeometricBoundingVolume *const *volumes,
+                        unsigned char *results) const;
+
 protected:
   virtual bool extend_other(BoundingVolume *other) const;
   virtual bool around_other(BoundingVolume *other,
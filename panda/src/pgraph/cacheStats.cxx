@@ -36,7 +36,7 @@ init() {
 void CacheStats::
 reset(double now) {
 #ifndef NDEBUG
-  _cache_hits = 0;
+  AtomicAdjust::set(_cache_hits, 0);
   _cache_misses = 0;
   _cache_adds = 0;
   _cache_new_adds = 0;
@@ -51,7 +51,7 @@ reset(double now) {
 void CacheStats::
 write(std::ostream &out, const char *name) const {
 #ifndef NDEBUG
-  out << name << " cache: " << _cache_hits << " hits, "
+  out << name << " cache: " << AtomicAdjust::get(_cache_hits) << " hits, "
       << _cache_misses << " misses\n"
       << _cache_adds + _cache_new_adds << "(" << _cache_new_adds << ") adds(new), "
       << _cache_dels << " dels, "
@@ -17,6 +17,7 @@
 #include "pandabase.h"
 #include "clockObject.h"
 #include "pnotify.h"
+#include "atomicAdjust.h"
 
 /**
  * This is used to track the utilization of the TransformState and RenderState
@@ -39,7 +40,9 @@ public:
 
 private:
 #ifndef NDEBUG
-  int _cache_hits = 0;
+  // Cache hits are counted while holding only the lock on one shard of the
+  // state table, so this is incremented atomically.
+  AtomicAdjust::Integer _cache_hits = 0;
   int _cache_misses = 0;
   int _cache_adds = 0;
   int _cache_new_adds = 0;
@@ -42,6 +42,7 @@
 #include "geomDrawCallbackData.h"
 #include "geomNode.h"
 #include "geomTransformer.h"
+#include "instancedNode.h"
 #include "lensNode.h"
 #include "light.h"
 #include "lightAttrib.h"
@@ -130,6 +131,54 @@ ConfigVariableBool debug_portal_cull
           "(You first need to enable portal culling, using the allow-portal-cull"
           "variable.)"));
 
+ConfigVariableInt cull_threads
+("cull-threads", 0,
+ PRC_DESC("Set this to a number greater than zero to split the cull traversal "
+          "of each DisplayRegion across that many additional worker "
+          "threads.  Subtrees of the scene graph found at cull-parallel-depth "
+          "are traversed in parallel, and the resulting objects are passed "
+          "on in the same order as a single-threaded traversal would have "
+          "produced them.  Note that this means that cull callbacks on nodes "
+          "below that depth may be invoked from a worker thread.  If this is "
+          "changed at runtime, the threads are replaced at the next frame.  "
+          "This has no effect when portal culling is enabled, or on builds without "
+          "true threading support."));
+
+ConfigVariableInt cull_parallel_depth
+("cull-parallel-depth", 2,
+ PRC_DESC("When cull-threads is nonzero, this specifies the depth below the "
+          "scene root at which subtrees are handed off to the worker "
+          "threads.  A depth of 1 splits at the children of render; larger "
+          "values produce more, smaller jobs."));
+
+ConfigVariableInt cull_batch_threshold
+("cull-batch-threshold", 8,
+ PRC_DESC("When a node has at least this many children, or a GeomNode at "
+          "least this many Geoms, their bounding volumes are tested against "
+          "the view frustum all at once, which is faster than testing them "
+          "one at a time as they are visited.  Set this to 0 to disable "
+          "the batched test."));
+
+ConfigVariableBool dynamic_batching
+("dynamic-batching", false,
+ PRC_DESC("Set this true to merge small static Geoms that share the same "
+          "state into a single Geom at cull time, in bins that sort by "
+          "state, in order to reduce the number of draw calls without "
+          "having to flatten the scene graph.  The Geoms are grouped by "
+          "their parent node and state; the merged vertices of each group "
+          "are cached for as long as its Geoms keep the same transforms, "
+          "and only the Geoms that are in view are drawn each frame."));
+
+ConfigVariableInt dynamic_batching_max_vertices
+("dynamic-batching-max-vertices", 256,
+ PRC_DESC("Specifies the largest number of vertices a Geom may have to be "
+          "considered for dynamic-batching."));
+
+ConfigVariableInt dynamic_batching_cache_frames
+("dynamic-batching-cache-frames", 30,
+ PRC_DESC("Specifies the number of frames that a Geom merged by "
+          "dynamic-batching is kept around after it was last rendered."));
+
 ConfigVariableBool show_occluder_volumes
 ("show-occluder-volumes", false,
  PRC_DESC("Set this true to enable debug visualization of the volumes used "
@@ -204,6 +253,16 @@ ConfigVariableDouble garbage_collect_states_rate
           "performance if states accumulate faster than they can be "
           "cleaned up."));
 
+ConfigVariableDouble garbage_collect_states_budget
+("garbage-collect-states-budget", 0.0,
+ PRC_DESC("If this is positive, it is the maximum amount of time, in "
+          "seconds, that each garbage collection step may spend on the "
+          "TransformState (or RenderState) cache.  When the time runs out, "
+          "the collection stops and resumes where it left off on the next "
+          "step.  States created since the previous step are always "
+          "examined first, since most of them are short-lived; the rest "
+          "are walked at the rate given by garbage-collect-states-rate."));
+
 ConfigVariableBool transform_cache
 ("transform-cache", true,
  PRC_DESC("Set this true to enable the cache of TransformState objects.  "
@@ -279,6 +338,21 @@ ConfigVariableInt max_collect_indices
           "imposing a limit on the original size of any one "
           "GeomPrimitive."));
 
+ConfigVariableInt vertex_cache_size
+("vertex-cache-size", 32,
+ PRC_DESC("Specifies the number of entries of the post-transform vertex "
+          "cache that SceneGraphReducer::optimize_vertices() optimizes the "
+          "triangle order for.  Most hardware does well with the default; "
+          "the result is not very sensitive to the exact value."));
+
+ConfigVariableDouble overdraw_threshold
+("overdraw-threshold", 1.05,
+ PRC_DESC("Specifies how much vertex cache efficiency "
+          "SceneGraphReducer::optimize_vertices() may give up in order to "
+          "reorder triangles to reduce overdraw, as a ratio of cache misses.  "
+          "Larger values cut the mesh into more, smaller clusters that can be "
+          "sorted front to back more effectively."));
+
 ConfigVariableBool premunge_data
 ("premunge-data", true,
  PRC_DESC("Set this true to preconvert vertex data at model load time to "
@@ -416,6 +490,7 @@ init_libpgraph() {
   GeomDrawCallbackData::init_type();
   GeomNode::init_type();
   GeomTransformer::init_type();
+  InstancedNode::init_type();
   LensNode::init_type();
   Light::init_type();
   LightAttrib::init_type();
@@ -484,6 +559,7 @@ init_libpgraph() {
   Fog::register_with_read_factory();
   FogAttrib::register_with_read_factory();
   GeomNode::register_with_read_factory();
+  InstancedNode::register_with_read_factory();
   LensNode::register_with_read_factory();
   LightAttrib::register_with_read_factory();
   LightRampAttrib::register_with_read_factory();
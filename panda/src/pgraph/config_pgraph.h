@@ -34,6 +34,12 @@ extern ConfigVariableBool fake_view_frustum_cull;
 extern ConfigVariableBool clip_plane_cull;
 extern ConfigVariableBool allow_portal_cull;
 extern ConfigVariableBool debug_portal_cull;
+extern ConfigVariableInt cull_threads;
+extern ConfigVariableInt cull_parallel_depth;
+extern ConfigVariableInt cull_batch_threshold;
+extern ConfigVariableBool dynamic_batching;
+extern ConfigVariableInt dynamic_batching_max_vertices;
+extern ConfigVariableInt dynamic_batching_cache_frames;
 extern ConfigVariableBool show_occluder_volumes;
 extern ConfigVariableBool unambiguous_graph;
 extern ConfigVariableBool detect_graph_cycles;
@@ -45,6 +51,7 @@ extern ConfigVariableBool paranoid_const;
 extern ConfigVariableBool auto_break_cycles;
 extern EXPCL_PANDA_PGRAPH ConfigVariableBool garbage_collect_states;
 extern ConfigVariableDouble garbage_collect_states_rate;
+extern ConfigVariableDouble garbage_collect_states_budget;
 extern ConfigVariableBool transform_cache;
 extern ConfigVariableBool state_cache;
 extern ConfigVariableBool uniquify_transforms;
@@ -54,6 +61,8 @@ extern ConfigVariableBool retransform_sprites;
 extern ConfigVariableBool depth_offset_decals;
 extern ConfigVariableInt max_collect_vertices;
 extern ConfigVariableInt max_collect_indices;
+extern EXPCL_PANDA_PGRAPH ConfigVariableInt vertex_cache_size;
+extern EXPCL_PANDA_PGRAPH ConfigVariableDouble overdraw_threshold;
 extern EXPCL_PANDA_PGRAPH ConfigVariableBool premunge_data;
 extern ConfigVariableBool preserve_geom_nodes;
 extern ConfigVariableBool flatten_geoms;
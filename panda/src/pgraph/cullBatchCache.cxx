@@ -0,0 +1,458 @@
+/**
+ * PANDA 3D SOFTWARE
+ * Copyright (c) Carnegie Mellon University.  All rights reserved.
+ *
+ * All use of this software is subject to the terms of the revised BSD
+ * license.  You should have received a copy of this license along
+ * with this source code in a file named "LICENSE."
+ *
+ * @file cullBatchCache.cxx
+ * @author blablabla94
+ * @date 2026-10-16
+ */
+
+#include "cullBatchCache.h"
+#include "config_pgraph.h"
+#include "shaderAttrib.h"
+#include "geomVertexFormat.h"
+#include "geomVertexArrayFormat.h"
+#include "geomPrimitive.h"
+#include "geomVertexReader.h"
+#include "clockObject.h"
+#include "lightMutexHolder.h"
+#include "pStatTimer.h"
+
+#include <algorithm>
+
+LightMutex CullBatchCache::_lock("CullBatchCache::_lock");
+CullBatchCache::Entries CullBatchCache::_entries;
+int CullBatchCache::_last_sweep_frame = -1;
+
+PStatCollector CullBatchCache::_batch_pcollector("Cull:Batch");
+PStatCollector CullBatchCache::_build_pcollector("Cull:Batch:Build");
+
+/**
+ * Returns true if the indicated object is a candidate for dynamic batching.
+ * This requires a small, static Geom without animation, instancing or a draw
+ * callback, which was recorded with its net transform.
+ */
+bool CullBatchCache::
+is_batchable(const CullableObject *object) {
+  if (object->_draw_callback != nullptr ||
+      object->_instances != nullptr ||
+      object->_net_transform == nullptr ||
+      object->_geom == nullptr ||
+      object->_munged_data == nullptr) {
+    return false;
+  }
+
+  // Geom subclasses may render in special ways.
+  const Geom *geom = object->_geom;
+  if (geom->get_type() != Geom::get_class_type() ||
+      geom->get_usage_hint() != Geom::UH_static) {
+    return false;
+  }
+
+  const GeomVertexData *data = object->_munged_data;
+  if (data->get_usage_hint() != Geom::UH_static ||
+      data->get_num_rows() > dynamic_batching_max_vertices ||
+      data->get_transform_table() != nullptr ||
+      data->get_transform_blend_table() != nullptr ||
+      data->get_slider_table() != nullptr) {
+    return false;
+  }
+
+  const ShaderAttrib *sattr;
+  if (object->_state->get_attrib(sattr) && sattr->get_instance_count() > 0) {
+    return false;
+  }
+
+  return true;
+}
+
+/**
+ * Returns a new CullableObject that renders all of the indicated objects,
+ * which must all be batchable and compatible with each other, or nullptr if
+ * they cannot be batched (yet).  If a new object is returned, the caller
+ * should delete the original objects and render the new one in their place.
+ */
+CullableObject *CullBatchCache::
+make_batch(CullableObject **objects, size_t num_objects,
+           Thread *current_thread) {
+  nassertr(num_objects > 0, nullptr);
+  PStatTimer timer(_batch_pcollector, current_thread);
+
+  // Sort the objects in the same order as the members of an entry, so that
+  // they can be looked up quickly.
+  std::sort(objects, objects + num_objects,
+    [](const CullableObject *a, const CullableObject *b) {
+      if (a->_geom != b->_geom) {
+        return a->_geom < b->_geom;
+      }
+      if (a->_munged_data != b->_munged_data) {
+        return a->_munged_data < b->_munged_data;
+      }
+      return a->_net_transform < b->_net_transform;
+    });
+
+  const CullableObject *first = objects[0];
+  GroupKey key;
+  key._group = first->_batch_group;
+  key._state = first->_state;
+  key._format = first->_munged_data->get_format();
+  key._primitive_type = first->_geom->get_primitive_type();
+  key._shade_model = first->_geom->get_shade_model();
+
+  int frame = ClockObject::get_global_clock()->get_frame_count(current_thread);
+
+  CPT(Geom) geom;
+  CPT(TransformState) member_transform;
+  {
+    LightMutexHolder holder(_lock);
+    if (frame != _last_sweep_frame) {
+      sweep(frame);
+    }
+
+    Entries::iterator ei = _entries.find(key);
+    if (ei != _entries.end() && (*ei).second._group.was_deleted()) {
+      // The node has been deleted, and a new one allocated in its place.
+      _entries.erase(ei);
+      ei = _entries.end();
+    }
+    if (ei == _entries.end()) {
+      ei = _entries.insert(Entries::value_type(key, Entry())).first;
+      Entry &entry = (*ei).second;
+      entry._group = (PandaNode *)key._group;
+      entry._state = first->_state;
+      entry._format = key._format;
+      entry._changed_frame = frame;
+      entry._failed = false;
+    }
+
+    Entry &entry = (*ei).second;
+    entry._last_frame = frame;
+
+    if (update_members(entry, objects, num_objects, frame, current_thread)) {
+      // The members have changed.  Don't merge them until they have stayed
+      // the same for a frame.
+      entry._changed_frame = frame;
+      entry._data.clear();
+      entry._empty_primitive.clear();
+      entry._indices.clear();
+      entry._visible.clear();
+      entry._geom.clear();
+      entry._failed = false;
+      return nullptr;
+    }
+
+    if (entry._failed) {
+      return nullptr;
+    }
+
+    if (entry._data == nullptr) {
+      if (entry._changed_frame == frame) {
+        return nullptr;
+      }
+      PStatTimer timer(_build_pcollector, current_thread);
+      if (!build_batch(entry, current_thread)) {
+        // It could not be batched.  Don't try again until the members change.
+        entry._failed = true;
+        return nullptr;
+      }
+    }
+
+    // Draw only the members that are in view this frame.
+    pvector<bool> visible(entry._members.size(), false);
+    for (size_t i = 0; i < num_objects; ++i) {
+      Members::const_iterator mi =
+        std::lower_bound(entry._members.begin(), entry._members.end(),
+                         objects[i], &Member::sorts_before);
+      visible[mi - entry._members.begin()] = true;
+    }
+    if (entry._geom == nullptr || entry._visible != visible) {
+      entry._geom = make_geom(entry, visible);
+      entry._visible.swap(visible);
+    }
+
+    geom = entry._geom;
+    member_transform = entry._members[0]._net_transform;
+  }
+
+  // The vertices are in the coordinate space of the entry's first member,
+  // which need not be one of the objects.
+  CPT(TransformState) internal_transform = first->_internal_transform->compose(
+    first->_net_transform->invert_compose(member_transform));
+  if (internal_transform->is_invalid()) {
+    return nullptr;
+  }
+
+  CullableObject *batch =
+    new CullableObject(std::move(geom), first->_state, std::move(internal_transform));
+  batch->_munged_data = batch->_geom->get_vertex_data(current_thread);
+  return batch;
+}
+
+/**
+ * Removes all of the batches from the cache.
+ */
+void CullBatchCache::
+clear_cache() {
+  LightMutexHolder holder(_lock);
+  _entries.clear();
+}
+
+/**
+ * Returns the number of entries in the cache.  There is one entry for each
+ * group of objects that may be batched together, including those whose
+ * vertices have not been merged yet.
+ */
+int CullBatchCache::
+get_num_entries() {
+  LightMutexHolder holder(_lock);
+  return (int)_entries.size();
+}
+
+/**
+ * Returns the number of entries in the cache whose vertices have been merged,
+ * and are being drawn as one Geom.
+ */
+int CullBatchCache::
+get_num_batches() {
+  LightMutexHolder holder(_lock);
+  int num_batches = 0;
+  for (const Entries::value_type &value : _entries) {
+    if (value.second._data != nullptr) {
+      ++num_batches;
+    }
+  }
+  return num_batches;
+}
+
+/**
+ * Marks the members of the entry that match the indicated objects, which
+ * must be sorted, as seen in this frame.  If any of the objects is not yet a
+ * member, updates the list of members and returns true.
+ *
+ * Members that are not among the objects are kept, since they are presumably
+ * only out of view, unless they have not been seen for
+ * dynamic-batching-cache-frames frames.  Assumes the lock is held.
+ */
+bool CullBatchCache::
+update_members(Entry &entry, CullableObject **objects, size_t num_objects,
+               int frame, Thread *current_thread) {
+  Members &members = entry._members;
+
+  bool changed = false;
+  for (size_t i = 0; i < num_objects; ++i) {
+    Members::iterator mi =
+      std::lower_bound(members.begin(), members.end(), objects[i],
+                       &Member::sorts_before);
+    if (mi == members.end() || !(*mi).matches(objects[i], current_thread)) {
+      changed = true;
+      break;
+    }
+    (*mi)._last_frame = frame;
+  }
+  if (!changed) {
+    return false;
+  }
+
+  int max_age = dynamic_batching_cache_frames;
+  Members new_members;
+  new_members.reserve(members.size() + num_objects);
+  for (const Member &member : members) {
+    if (frame - member._last_frame > max_age) {
+      continue;
+    }
+
+    // If one of the objects has the same Geom, vertex data and transform,
+    // this member is an out-of-date copy of it, which is replaced below.
+    CullableObject **oi =
+      std::lower_bound(objects, objects + num_objects, member,
+        [](const CullableObject *object, const Member &member) {
+          return Member::compare_to(member, object) > 0;
+        });
+    if (oi != objects + num_objects && Member::compare_to(member, *oi) == 0) {
+      continue;
+    }
+    new_members.push_back(member);
+  }
+
+  for (size_t i = 0; i < num_objects; ++i) {
+    const CullableObject *object = objects[i];
+    if (!new_members.empty() &&
+        Member::compare_to(new_members.back(), object) == 0) {
+      // The same thing, drawn twice.
+      continue;
+    }
+
+    Member member;
+    member._geom = object->_geom;
+    member._geom_modified = object->_geom->get_modified(current_thread);
+    member._data = object->_munged_data;
+    member._data_modified = object->_munged_data->get_modified(current_thread);
+    member._net_transform = object->_net_transform;
+    member._last_frame = frame;
+    member._begin = 0;
+    member._end = 0;
+    new_members.push_back(std::move(member));
+  }
+
+  std::sort(new_members.begin(), new_members.end(),
+    [](const Member &a, const Member &b) {
+      if (a._geom != b._geom) {
+        return a._geom < b._geom;
+      }
+      if (a._data != b._data) {
+        return a._data < b._data;
+      }
+      return a._net_transform < b._net_transform;
+    });
+
+  members.swap(new_members);
+  return true;
+}
+
+/**
+ * Merges the vertices of all the members of the entry, and records the
+ * indices that draw each one.  Returns false if they cannot be merged.
+ * Assumes the lock is held.
+ */
+bool CullBatchCache::
+build_batch(Entry &entry, Thread *current_thread) {
+  const GeomVertexFormat *format = entry._format;
+  for (size_t ai = 0; ai < format->get_num_arrays(); ++ai) {
+    if (format->get_array(ai)->get_divisor() != 0) {
+      return false;
+    }
+  }
+
+  int total_rows = 0;
+  for (const Member &member : entry._members) {
+    total_rows += member._data->get_num_rows();
+  }
+
+  PT(GeomVertexData) data =
+    new GeomVertexData("batch", format, Geom::UH_static);
+  data->unclean_set_num_rows(total_rows);
+
+  // Copy the vertices of each member, and transform them into the coordinate
+  // space of the first one.
+  const TransformState *first_transform = entry._members[0]._net_transform;
+  int row = 0;
+  for (const Member &member : entry._members) {
+    int num_rows = member._data->get_num_rows();
+    for (size_t ai = 0; ai < format->get_num_arrays(); ++ai) {
+      size_t stride = format->get_array(ai)->get_stride();
+      PT(GeomVertexArrayDataHandle) to = data->modify_array_handle(ai);
+      CPT(GeomVertexArrayDataHandle) from = member._data->get_array_handle(ai);
+      to->copy_subdata_from(row * stride, num_rows * stride,
+                            from, 0, num_rows * stride);
+    }
+
+    CPT(TransformState) transform =
+      first_transform->invert_compose(member._net_transform);
+    if (transform->is_invalid()) {
+      return false;
+    }
+    if (!transform->is_identity()) {
+      data->transform_vertices(transform->get_mat(), row, row + num_rows);
+    }
+    row += num_rows;
+  }
+
+  // Now decompose the primitives of each member into a single list of
+  // indices that refer to the new rows.
+  PT(GeomPrimitive) empty_primitive;
+  entry._indices.clear();
+  row = 0;
+  for (Member &member : entry._members) {
+    member._begin = entry._indices.size();
+    int num_primitives = member._geom->get_num_primitives();
+    for (int pi = 0; pi < num_primitives; ++pi) {
+      CPT(GeomPrimitive) prim = member._geom->get_primitive(pi)->decompose();
+      if (empty_primitive == nullptr) {
+        empty_primitive = prim->make_copy();
+        empty_primitive->clear_vertices();
+      } else if (prim->get_type() != empty_primitive->get_type()) {
+        return false;
+      }
+
+      if (prim->is_indexed()) {
+        GeomVertexReader index(prim->get_vertices(), 0, current_thread);
+        while (!index.is_at_end()) {
+          entry._indices.push_back(row + index.get_data1i());
+        }
+      } else {
+        int first_vertex = prim->get_first_vertex();
+        int num_vertices = prim->get_num_vertices();
+        for (int i = 0; i < num_vertices; ++i) {
+          entry._indices.push_back(row + first_vertex + i);
+        }
+      }
+    }
+    member._end = entry._indices.size();
+    row += member._data->get_num_rows();
+  }
+
+  if (empty_primitive == nullptr) {
+    return false;
+  }
+
+  if (pgraph_cat.is_debug()) {
+    pgraph_cat.debug()
+      << "Merged " << entry._members.size() << " Geoms into " << *data << "\n";
+  }
+
+  entry._data = data;
+  entry._empty_primitive = empty_primitive;
+  return true;
+}
+
+/**
+ * Returns a new Geom that draws those members of the entry whose flag is set
+ * in the visible vector.  Assumes the lock is held.
+ */
+CPT(Geom) CullBatchCache::
+make_geom(Entry &entry, const pvector<bool> &visible) {
+  size_t num_indices = 0;
+  for (size_t i = 0; i < entry._members.size(); ++i) {
+    if (visible[i]) {
+      num_indices += entry._members[i]._end - entry._members[i]._begin;
+    }
+  }
+
+  PT(GeomPrimitive) prim = entry._empty_primitive->make_copy();
+  prim->reserve_num_vertices((int)num_indices);
+  for (size_t i = 0; i < entry._members.size(); ++i) {
+    if (visible[i]) {
+      const Member &member = entry._members[i];
+      for (size_t j = member._begin; j < member._end; ++j) {
+        prim->add_vertex(entry._indices[j]);
+      }
+    }
+  }
+
+  PT(Geom) geom = new Geom(entry._data);
+  geom->add_primitive(prim);
+  return geom;
+}
+
+/**
+ * Removes the entries that have not been used for the configured number of
+ * frames.  Assumes the lock is held.
+ */
+void CullBatchCache::
+sweep(int frame) {
+  _last_sweep_frame = frame;
+
+  int max_age = dynamic_batching_cache_frames;
+  Entries::iterator ei = _entries.begin();
+  while (ei != _entries.end()) {
+    if (frame - (*ei).second._last_frame > max_age) {
+      ei = _entries.erase(ei);
+    } else {
+      ++ei;
+    }
+  }
+}
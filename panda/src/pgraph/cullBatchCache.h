@@ -0,0 +1,146 @@
+/**
+ * PANDA 3D SOFTWARE
+ * Copyright (c) Carnegie Mellon University.  All rights reserved.
+ *
+ * All use of this software is subject to the terms of the revised BSD
+ * license.  You should have received a copy of this license along
+ * with this source code in a file named "LICENSE."
+ *
+ * @file cullBatchCache.h
+ * @author blablabla94
+ * @date 2026-10-16
+ */
+
+#ifndef CULLBATCHCACHE_H
+#define CULLBATCHCACHE_H
+
+#include "pandabase.h"
+#include "cullableObject.h"
+#include "geom.h"
+#include "geomPrimitive.h"
+#include "geomVertexData.h"
+#include "geomVertexFormat.h"
+#include "pandaNode.h"
+#include "renderState.h"
+#include "transformState.h"
+#include "pointerTo.h"
+#include "weakPointerTo.h"
+#include "updateSeq.h"
+#include "lightMutex.h"
+#include "pmap.h"
+#include "pvector.h"
+#include "pStatCollector.h"
+
+/**
+ * Implements dynamic batching: a cull bin may hand this a run of
+ * CullableObjects that share the same state and vertex format, and it will
+ * return a single CullableObject that renders all of them with one Geom,
+ * whose vertices have been transformed into the coordinate space of one of
+ * them.
+ *
+ * The merged vertices are kept in a global cache with one entry for each
+ * group of objects that are children of the same node and share a state,
+ * vertex format and primitive type.  An entry holds the vertices of every
+ * member of its group that has been seen, whether or not it is currently
+ * visible; each frame, only the index list is rebuilt to draw the members
+ * that are in view, so a moving camera does not cause the vertices to be
+ * merged again.  The vertices are merged only the second frame that the
+ * same members are seen, so a group containing an object whose transform
+ * changes every frame is not batched.  See the dynamic-batching config
+ * variable.
+ */
+class EXPCL_PANDA_PGRAPH CullBatchCache {
+public:
+  static bool is_batchable(const CullableObject *object);
+  INLINE static bool is_compatible(const CullableObject *a,
+                                   const CullableObject *b);
+
+  static CullableObject *make_batch(CullableObject **objects,
+                                    size_t num_objects,
+                                    Thread *current_thread);
+
+PUBLISHED:
+  static void clear_cache();
+  static int get_num_entries();
+  static int get_num_batches();
+
+private:
+  class GroupKey {
+  public:
+    INLINE bool operator < (const GroupKey &other) const;
+
+    const PandaNode *_group;
+    const RenderState *_state;
+    const GeomVertexFormat *_format;
+    int _primitive_type;
+    int _shade_model;
+  };
+
+  // One of the objects that have been seen in a group.  The members are
+  // sorted by their Geom, vertex data and net transform.
+  class Member {
+  public:
+    INLINE bool matches(const CullableObject *object,
+                        Thread *current_thread) const;
+    INLINE static bool sorts_before(const Member &member,
+                                    const CullableObject *object);
+    INLINE static int compare_to(const Member &member,
+                                 const CullableObject *object);
+
+    CPT(Geom) _geom;
+    UpdateSeq _geom_modified;
+    CPT(GeomVertexData) _data;
+    UpdateSeq _data_modified;
+    CPT(TransformState) _net_transform;
+    int _last_frame;
+
+    // The range of the merged index list that draws this member.
+    size_t _begin;
+    size_t _end;
+  };
+  typedef pvector<Member> Members;
+
+  class Entry {
+  public:
+    WPT(PandaNode) _group;
+    CPT(RenderState) _state;
+    CPT(GeomVertexFormat) _format;
+    Members _members;
+
+    // The frame in which the list of members last changed, and the frame in
+    // which the entry was last used.
+    int _changed_frame;
+    int _last_frame;
+
+    // The merged vertices of all the members, in the coordinate space of the
+    // first one, and their indices.  _data is NULL if the vertices have not
+    // been merged yet, or _failed is set if they could not be.
+    CPT(GeomVertexData) _data;
+    CPT(GeomPrimitive) _empty_primitive;
+    pvector<int> _indices;
+    bool _failed;
+
+    // The Geom that was last made to draw the visible members.
+    pvector<bool> _visible;
+    CPT(Geom) _geom;
+  };
+  typedef pmap<GroupKey, Entry> Entries;
+
+  static bool update_members(Entry &entry, CullableObject **objects,
+                             size_t num_objects, int frame,
+                             Thread *current_thread);
+  static bool build_batch(Entry &entry, Thread *current_thread);
+  static CPT(Geom) make_geom(Entry &entry, const pvector<bool> &visible);
+  static void sweep(int frame);
+
+  static LightMutex _lock;
+  static Entries _entries;
+  static int _last_sweep_frame;
+
+  static PStatCollector _batch_pcollector;
+  static PStatCollector _build_pcollector;
+};
+
+#include "cullBatchCache.I"
+
+#endif
@@ -0,0 +1,296 @@
+/**
+ * PANDA 3D SOFTWARE
+ * Copyright (c) Carnegie Mellon University.  All rights reserved.
+ *
+ * All use of this software is subject to the terms of the revised BSD
+ * license.  You should have received a copy of this license along
+ * with this source code in a file named "LICENSE."
+ *
+ * @file cullSnapshot.cxx
+ * @author blablabla94
+ * @date 2026-10-16
+ */
+
+#include "cullSnapshot.h"
+#include "geometricBoundingVolume.h"
+#include "boundingHexahedron.h"
+#include "boundingSphere.h"
+#include "pStatCollector.h"
+#include "pStatTimer.h"
+
+#include <limits>
+
+static PStatCollector build_snapshot_pcollector("Cull:Snapshot:Build");
+static PStatCollector find_visible_pcollector("Cull:Snapshot:Test");
+
+/**
+ * Builds a new snapshot of the subgraph below the indicated root node.  If a
+ * previous snapshot of the same root is given, the entries of any children of
+ * the root that have not changed since then are copied from it, rather than
+ * walking those subgraphs again.
+ */
+CullSnapshot::
+CullSnapshot(const PandaNode *root, const CullSnapshot *prev,
+             Thread *current_thread) :
+  _root(root)
+{
+  PStatTimer timer(build_snapshot_pcollector, current_thread);
+
+  root->get_bounds(_root_seq, current_thread);
+
+  if (prev != nullptr && prev->_root != root) {
+    prev = nullptr;
+  }
+
+  CPT(TransformState) identity = TransformState::make_identity();
+  CPT(RenderState) empty = RenderState::make_empty();
+  DrawMask all_off = DrawMask::all_off();
+  pvector<PandaNode *> path;
+
+  PandaNode::Children children = root->get_children(current_thread);
+  size_t num_children = children.get_num_children();
+  _child_ranges.reserve(num_children);
+
+  for (size_t i = 0; i < num_children; ++i) {
+    PandaNode *child = children.get_child(i);
+
+    ChildRange range;
+    range._child = child;
+    child->get_bounds(range._seq, current_thread);
+    range._begin = _nodes.size();
+
+    if (prev != nullptr && i < prev->_child_ranges.size() &&
+        prev->_child_ranges[i]._child == child &&
+        prev->_child_ranges[i]._seq == range._seq) {
+      // This child hasn't changed since the last snapshot.
+      const ChildRange &prev_range = prev->_child_ranges[i];
+      copy_entries(prev, prev_range._begin, prev_range._end);
+    } else {
+      r_collect(child, identity, empty, all_off, all_off, path, current_thread);
+    }
+
+    range._end = _nodes.size();
+    _child_ranges.push_back(range);
+  }
+}
+
+/**
+ * Returns true if nothing has changed in the subgraph since the snapshot was
+ * built, or false if it should be rebuilt.
+ *
+ * This relies on the bounding volume update counter of the root, which is
+ * incremented for any change to a transform, state, draw mask or child list
+ * at or below the root.  Adding or removing a RenderEffect or a tag does not
+ * increment this counter; if you do this below a node that is using a
+ * snapshot, you should also cause its bounds to be marked stale.
+ */
+bool CullSnapshot::
+is_current(Thread *current_thread) const {
+  UpdateSeq seq;
+  _root->get_bounds(seq, current_thread);
+  return seq == _root_seq;
+}
+
+/**
+ * Fills the indicated vector with the indices of all entries whose bounding
+ * sphere is at least partially within the indicated frustum, which should be
+ * given in the coordinate space of the root.  If frustum is NULL, all entries
+ * are considered visible.
+ */
+void CullSnapshot::
+find_visible(const GeometricBoundingVolume *frustum,
+             pvector<size_t> &visible) const {
+  PStatTimer timer(find_visible_pcollector);
+
+  size_t num_entries = _radius.size();
+  visible.clear();
+  if (num_entries == 0) {
+    return;
+  }
+  visible.reserve(num_entries);
+
+  if (frustum == nullptr) {
+    for (size_t i = 0; i < num_entries; ++i) {
+      visible.push_back(i);
+    }
+    return;
+  }
+
+  const BoundingHexahedron *hexahedron = frustum->as_bounding_hexahedron();
+  if (hexahedron != nullptr) {
+    // This is the common case, which can be tested in one batch.
+    pvector<unsigned char> results(num_entries);
+    hexahedron->contains_spheres(num_entries, &_center_x[0], &_center_y[0],
+                                 &_center_z[0], &_radius[0], &results[0]);
+    for (size_t i = 0; i < num_entries; ++i) {
+      if (results[i] != BoundingVolume::IF_no_intersection) {
+        visible.push_back(i);
+      }
+    }
+    return;
+  }
+
+  // Some other kind of frustum; fall back to the general test.
+  PN_stdfloat inf = std::numeric_limits<PN_stdfloat>::max();
+  for (size_t i = 0; i < num_entries; ++i) {
+    if (_radius[i] == inf) {
+      visible.push_back(i);
+    } else {
+      BoundingSphere sphere(LPoint3(_center_x[i], _center_y[i], _center_z[i]),
+                            _radius[i]);
+      sphere.local_object();
+      if (frustum->contains(&sphere) != BoundingVolume::IF_no_intersection) {
+        visible.push_back(i);
+      }
+    }
+  }
+}
+
+/**
+ * Recursively walks the subgraph below the indicated node, given the net
+ * transform, state and draw masks of its parent relative to the root, and
+ * appends an entry for each GeomNode and for each node that cannot be
+ * flattened.  The path holds the nodes between the root and this node.
+ */
+void CullSnapshot::
+r_collect(PandaNode *node, const TransformState *net_transform,
+          const RenderState *net_state, const DrawMask &draw_control_mask,
+          const DrawMask &draw_show_mask, pvector<PandaNode *> &path,
+          Thread *current_thread) {
+  static const int flat_bits =
+    PandaNode::FB_transform | PandaNode::FB_state | PandaNode::FB_draw_mask;
+
+  if ((node->get_fancy_bits(current_thread) & ~flat_bits) != 0 ||
+      node->has_selective_visibility() ||
+      node->is_final(current_thread) ||
+      (node->is_renderable() && !node->is_geom_node())) {
+    // This node needs to be visited by the traverser itself.
+    add_entry(node, ET_subtree, net_transform, net_state,
+              draw_control_mask, draw_show_mask,
+              node->get_bounds(current_thread), path);
+    return;
+  }
+
+  CPT(TransformState) transform = node->get_transform(current_thread);
+  if (transform->is_invalid()) {
+    // The traverser would not visit this node, or anything below it.
+    return;
+  }
+
+  CPT(TransformState) next_transform = net_transform->compose(transform);
+  CPT(RenderState) next_state = net_state->compose(node->get_state(current_thread));
+
+  DrawMask node_control_mask = node->get_draw_control_mask();
+  DrawMask next_control_mask = draw_control_mask | node_control_mask;
+  DrawMask next_show_mask = (draw_show_mask & ~node_control_mask) |
+    (node->get_draw_show_mask() & node_control_mask);
+
+  if (node->is_geom_node()) {
+    add_entry(node, ET_geom_node, next_transform, next_state,
+              next_control_mask, next_show_mask,
+              node->get_internal_bounds(current_thread), path);
+  }
+
+  PandaNode::Children children = node->get_children(current_thread);
+  int num_children = children.get_num_children();
+  path.push_back(node);
+  for (int i = 0; i < num_children; ++i) {
+    r_collect(children.get_child(i), next_transform, next_state,
+              next_control_mask, next_show_mask, path, current_thread);
+  }
+  path.pop_back();
+}
+
+/**
+ * Appends a new entry.  The bounding volume is given in the coordinate space
+ * of the indicated net transform.  The path is only stored for an ET_subtree
+ * entry, since the traversal below it may need the node's full NodePath.
+ */
+void CullSnapshot::
+add_entry(PandaNode *node, EntryType type,
+          const TransformState *net_transform, const RenderState *net_state,
+          const DrawMask &draw_control_mask, const DrawMask &draw_show_mask,
+          const BoundingVolume *bounds, const pvector<PandaNode *> &path) {
+  if (bounds->is_empty()) {
+    // There is nothing here that the traverser would draw.
+    return;
+  }
+
+  const LMatrix4 &mat = net_transform->get_mat();
+
+  LPoint3 center(0);
+  PN_stdfloat radius = std::numeric_limits<PN_stdfloat>::max();
+
+  const GeometricBoundingVolume *gbv = bounds->as_geometric_bounding_volume();
+  if (gbv != nullptr && !gbv->is_infinite()) {
+    const BoundingSphere *sphere = gbv->as_bounding_sphere();
+    const FiniteBoundingVolume *fbv = gbv->as_finite_bounding_volume();
+    if (sphere != nullptr) {
+      center = sphere->get_center();
+      radius = sphere->get_radius();
+    } else if (fbv != nullptr) {
+      LPoint3 min_point = fbv->get_min();
+      LPoint3 max_point = fbv->get_max();
+      center = (min_point + max_point) * 0.5f;
+      radius = (max_point - min_point).length() * 0.5f;
+    }
+
+    if (fbv != nullptr && !net_transform->is_identity()) {
+      // Transform the sphere into the root's space, scaling the radius by
+      // the largest axis scale, to remain conservative under nonuniform
+      // scales.
+      PN_stdfloat scale = std::max(mat.get_row3(0).length(),
+                                   std::max(mat.get_row3(1).length(),
+                                            mat.get_row3(2).length()));
+      center = center * mat;
+      radius *= scale;
+    }
+  }
+
+  _center_x.push_back(center[0]);
+  _center_y.push_back(center[1]);
+  _center_z.push_back(center[2]);
+  _radius.push_back(radius);
+  _draw_control_mask.push_back(draw_control_mask);
+  _draw_show_mask.push_back(draw_show_mask);
+  _net_mats.push_back(mat);
+  _net_transforms.push_back(net_transform);
+  _net_states.push_back(net_state);
+  _nodes.push_back(node);
+  _types.push_back((unsigned char)type);
+
+  _path_begin.push_back(_path_nodes.size());
+  if (type == ET_subtree) {
+    _path_nodes.insert(_path_nodes.end(), path.begin(), path.end());
+  }
+}
+
+/**
+ * Appends the indicated range of entries from another snapshot.
+ */
+void CullSnapshot::
+copy_entries(const CullSnapshot *other, size_t begin, size_t end) {
+  _center_x.insert(_center_x.end(), other->_center_x.begin() + begin, other->_center_x.begin() + end);
+  _center_y.insert(_center_y.end(), other->_center_y.begin() + begin, other->_center_y.begin() + end);
+  _center_z.insert(_center_z.end(), other->_center_z.begin() + begin, other->_center_z.begin() + end);
+  _radius.insert(_radius.end(), other->_radius.begin() + begin, other->_radius.begin() + end);
+  _draw_control_mask.insert(_draw_control_mask.end(), other->_draw_control_mask.begin() + begin, other->_draw_control_mask.begin() + end);
+  _draw_show_mask.insert(_draw_show_mask.end(), other->_draw_show_mask.begin() + begin, other->_draw_show_mask.begin() + end);
+  _net_mats.insert(_net_mats.end(), other->_net_mats.begin() + begin, other->_net_mats.begin() + end);
+  _net_transforms.insert(_net_transforms.end(), other->_net_transforms.begin() + begin, other->_net_transforms.begin() + end);
+  _net_states.insert(_net_states.end(), other->_net_states.begin() + begin, other->_net_states.begin() + end);
+  _nodes.insert(_nodes.end(), other->_nodes.begin() + begin, other->_nodes.begin() + end);
+  _types.insert(_types.end(), other->_types.begin() + begin, other->_types.begin() + end);
+
+  if (begin < end) {
+    // The paths are copied as one block, which moves all of the offsets by
+    // the same amount.
+    size_t path_begin = other->_path_begin[begin];
+    size_t path_end = other->get_path_end(end - 1);
+    size_t offset = _path_nodes.size();
+    for (size_t n = begin; n < end; ++n) {
+      _path_begin.push_back(other->_path_begin[n] - path_begin + offset);
+    }
+    _path_nodes.insert(_path_nodes.end(), other->_path_nodes.begin() + path_begin, other->_path_nodes.begin() + path_end);
+  }
+}
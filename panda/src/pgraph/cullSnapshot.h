@@ -0,0 +1,136 @@
+/**
+ * PANDA 3D SOFTWARE
+ * Copyright (c) Carnegie Mellon University.  All rights reserved.
+ *
+ * All use of this software is subject to the terms of the revised BSD
+ * license.  You should have received a copy of this license along
+ * with this source code in a file named "LICENSE."
+ *
+ * @file cullSnapshot.h
+ * @author blablabla94
+ * @date 2026-10-16
+ */
+
+#ifndef CULLSNAPSHOT_H
+#define CULLSNAPSHOT_H
+
+#include "pandabase.h"
+#include "referenceCount.h"
+#include "pointerTo.h"
+#include "pandaNode.h"
+#include "transformState.h"
+#include "renderState.h"
+#include "drawMask.h"
+#include "updateSeq.h"
+#include "pvector.h"
+#include "epvector.h"
+
+class GeometricBoundingVolume;
+
+/**
+ * A flattened, read-only view of the subgraph below a particular node, built
+ * for the benefit of the cull traversal.  For each GeomNode in the subgraph,
+ * this stores the net transform, the composed state, the bounding sphere and
+ * the draw mask relative to the root node in parallel arrays, so that the
+ * view-frustum test can be performed as a single loop over contiguous data
+ * instead of a recursive walk through the scene graph.
+ *
+ * Only nodes with a transform, state or draw mask are flattened.  Any node
+ * that requires special handling during the cull traversal (for instance
+ * because it has a RenderEffect, a cull callback or a tag, has selective
+ * visibility, or is a renderable node other than a GeomNode) is instead
+ * stored as an opaque subtree entry, which is traversed in the normal way.
+ *
+ * A snapshot is never modified once it has been built.  When the subgraph
+ * changes, a new snapshot is built, reusing the entries of any children of
+ * the root that have not changed since the previous one.
+ */
+class EXPCL_PANDA_PGRAPH CullSnapshot : public ReferenceCount {
+public:
+  CullSnapshot(const PandaNode *root, const CullSnapshot *prev,
+               Thread *current_thread);
+
+  bool is_current(Thread *current_thread) const;
+
+  enum EntryType {
+    // The node is a GeomNode whose transform and state have been folded
+    // into the entry; it can be drawn directly.
+    ET_geom_node,
+
+    // The node must be traversed normally.  The entry stores the net
+    // transform and state of its parent.
+    ET_subtree,
+  };
+
+  INLINE size_t get_num_entries() const;
+  INLINE PandaNode *get_node(size_t n) const;
+  INLINE EntryType get_entry_type(size_t n) const;
+  INLINE const TransformState *get_net_transform(size_t n) const;
+  INLINE const LMatrix4 &get_net_mat(size_t n) const;
+  INLINE const RenderState *get_net_state(size_t n) const;
+  INLINE DrawMask compose_draw_mask(size_t n, const DrawMask &running_draw_mask) const;
+  INLINE size_t get_num_path_nodes(size_t n) const;
+  INLINE PandaNode *get_path_node(size_t n, size_t i) const;
+
+  void find_visible(const GeometricBoundingVolume *frustum,
+                    pvector<size_t> &visible) const;
+
+private:
+  void r_collect(PandaNode *node, const TransformState *net_transform,
+                 const RenderState *net_state,
+                 const DrawMask &draw_control_mask,
+                 const DrawMask &draw_show_mask, pvector<PandaNode *> &path,
+                 Thread *current_thread);
+  void add_entry(PandaNode *node, EntryType type,
+                 const TransformState *net_transform,
+                 const RenderState *net_state,
+                 const DrawMask &draw_control_mask,
+                 const DrawMask &draw_show_mask,
+                 const BoundingVolume *bounds,
+                 const pvector<PandaNode *> &path);
+  INLINE size_t get_path_end(size_t n) const;
+  void copy_entries(const CullSnapshot *other, size_t begin, size_t end);
+
+private:
+  // We don't hold a reference to the root, since it is normally the root
+  // that holds a reference to us.
+  const PandaNode *_root;
+  UpdateSeq _root_seq;
+
+  // One of these is recorded for each child of the root, remembering the
+  // range of entries that were built from it, so that the entries can be
+  // carried over into the next snapshot if the child hasn't changed.
+  class ChildRange {
+  public:
+    const PandaNode *_child;
+    UpdateSeq _seq;
+    size_t _begin;
+    size_t _end;
+  };
+  typedef pvector<ChildRange> ChildRanges;
+  ChildRanges _child_ranges;
+
+  // The entries themselves, stored as a structure of arrays.  The bounding
+  // spheres are in the coordinate space of the root.
+  pvector<PN_stdfloat> _center_x;
+  pvector<PN_stdfloat> _center_y;
+  pvector<PN_stdfloat> _center_z;
+  pvector<PN_stdfloat> _radius;
+  pvector<DrawMask> _draw_control_mask;
+  pvector<DrawMask> _draw_show_mask;
+  epvector<LMatrix4> _net_mats;
+  pvector<CPT(TransformState)> _net_transforms;
+  pvector<CPT(RenderState)> _net_states;
+  pvector<PT(PandaNode)> _nodes;
+  pvector<unsigned char> _types;
+
+  // For each ET_subtree entry, the nodes between the root and the entry's
+  // node, so that the traverser can rebuild the full path to it.  Entry n
+  // owns the range from _path_begin[n] to the start of the next entry's.
+  pvector<size_t> _path_begin;
+  pvector<PT(PandaNode)> _path_nodes;
+};
+
+#include "cullSnapshot.I"
+
+#endif
@@ -21,6 +21,7 @@
 #include "cullFaceAttrib.h"
 #include "depthOffsetAttrib.h"
 #include "cullHandler.h"
+#include "cullSnapshot.h"
 #include "dcast.h"
 #include "geomNode.h"
 #include "config_pgraph.h"
@@ -34,6 +35,7 @@
 #include "geomLinestrips.h"
 #include "geomLines.h"
 #include "geomVertexWriter.h"
+#include "mutexHolder.h"
 
 PStatCollector CullTraverser::_nodes_pcollector("Nodes");
 PStatCollector CullTraverser::_geom_nodes_pcollector("Nodes:GeomNodes");
@@ -42,6 +44,94 @@ PStatCollector CullTraverser::_geoms_occluded_pcollector("Geoms:Occluded");
 
 TypeHandle CullTraverser::_type_handle;
 
+/**
+ * The bookkeeping for a parallel cull traversal.  While the calling thread
+ * walks the top levels of the scene graph, this receives the objects it
+ * records, and also notes each subtree that is to be handed off to a worker
+ * thread.  The result is an ordered list of segments that, once the workers
+ * have filled in the deferred subtrees, can be replayed to the real
+ * CullHandler in the same order a serial traversal would have produced.
+ */
+class CullTraverser::ParallelCull : public CullHandler {
+public:
+  class Segment {
+  public:
+    // If _start is not empty, this segment stands for a subtree that is to
+    // be traversed by a worker thread, with the indicated starting state.
+    NodePath _start;
+    CPT(TransformState) _net_transform;
+    CPT(RenderState) _state;
+    PT(GeometricBoundingVolume) _view_frustum;
+    CPT(CullPlanes) _cull_planes;
+    DrawMask _draw_mask;
+    int _portal_depth;
+    CPT(InstanceList) _instances;
+
+    pvector<CullableObject *> _objects;
+  };
+  typedef pvector<Segment> Segments;
+
+  /**
+   * Receives the objects recorded on a worker thread into a single segment.
+   */
+  class SegmentHandler : public CullHandler {
+  public:
+    SegmentHandler(Segment &segment) : _segment(segment) {}
+
+    virtual void record_object(CullableObject *object,
+                               const CullTraverser *traverser) {
+      _segment._objects.push_back(object);
+    }
+
+  private:
+    Segment &_segment;
+  };
+
+  ParallelCull(const CullTraverser *trav, int split_depth) :
+    _trav(trav),
+    _split_depth(split_depth) {}
+
+  virtual void record_object(CullableObject *object,
+                             const CullTraverser *traverser);
+  void defer_subtree(const NodePath &start, const CullTraverserData &parent);
+
+  const CullTraverser *_trav;
+  int _split_depth;
+  Segments _segments;
+  pvector<size_t> _subtrees;
+};
+
+/**
+ * Appends an object recorded by the calling thread to the current segment.
+ */
+void CullTraverser::ParallelCull::
+record_object(CullableObject *object, const CullTraverser *traverser) {
+  if (_segments.empty() || !_segments.back()._start.is_empty()) {
+    _segments.push_back(Segment());
+  }
+  _segments.back()._objects.push_back(object);
+}
+
+/**
+ * Adds a new segment for the indicated subtree, to be traversed later with
+ * the state accumulated in the given parent data.
+ */
+void CullTraverser::ParallelCull::
+defer_subtree(const NodePath &start, const CullTraverserData &parent) {
+  _subtrees.push_back(_segments.size());
+  _segments.push_back(Segment());
+
+  Segment &segment = _segments.back();
+  segment._start = start;
+  segment._net_transform = parent._net_transform;
+  segment._state = parent._state;
+  segment._view_frustum = parent._view_frustum;
+  segment._cull_planes = parent._cull_planes;
+  segment._draw_mask = parent._draw_mask;
+  segment._portal_depth = parent._portal_depth;
+  segment._instances = parent._instances;
+}
+
 /**
  *
  */
@@ -56,6 +146,8 @@ CullTraverser() :
   _cull_handler = nullptr;
   _portal_clipper = nullptr;
   _effective_incomplete_render = true;
+  _parallel = nullptr;
+  _depth = 0;
 }
 
 /**
@@ -73,7 +165,9 @@ CullTraverser(const CullTraverser &copy) :
   _view_frustum(copy._view_frustum),
   _cull_handler(copy._cull_handler),
   _portal_clipper(copy._portal_clipper),
-  _effective_incomplete_render(copy._effective_incomplete_render)
+  _effective_incomplete_render(copy._effective_incomplete_render),
+  _parallel(nullptr),
+  _depth(0)
 {
 }
 
@@ -152,7 +246,11 @@ traverse(const NodePath &root) {
                            _initial_state, _view_frustum,
                            _current_thread);
 
-    do_traverse(data);
+    if (cull_threads > 0 && get_type() == get_class_type()) {
+      do_traverse_parallel(data);
+    } else {
+      do_traverse(data);
+    }
   }
 }
 
@@ -199,10 +297,49 @@ traverse_below(CullTraverserData &data) {
   PandaNode::Children children = node_reader->get_children();
   node_reader->release();
   int num_children = children.get_num_children();
+
+  if (_parallel != nullptr && _depth + 1 >= _parallel->_split_depth) {
+    // We are setting up a parallel traversal, and we have reached the depth
+    // at which the children are handed off to the worker threads.
+    NodePath parent_path = data.get_node_path();
+    if (!node->has_selective_visibility()) {
+      for (int i = 0; i < num_children; ++i) {
+        NodePath child_path(parent_path, children.get_child(i), _current_thread);
+        _parallel->defer_subtree(child_path, data);
+      }
+    } else {
+      int i = node->get_first_visible_child();
+      while (i < num_children) {
+        NodePath child_path(parent_path, children.get_child(i), _current_thread);
+        _parallel->defer_subtree(child_path, data);
+        i = node->get_next_visible_child(i);
+      }
+    }
+    return;
+  }
+
+  // If there are enough children, we can test them against the view frustum
+  // all at once, rather than one at a time as we visit them.
+  const BoundingHexahedron *batch_frustum = nullptr;
+  if (data._view_frustum != nullptr &&
+      cull_batch_threshold > 0 && num_children >= cull_batch_threshold) {
+#ifndef NDEBUG
+    if (!fake_view_frustum_cull)
+#endif
+    {
+      batch_frustum = data._view_frustum->as_bounding_hexahedron();
+    }
+  }
+
+  ++_depth;
   if (!node->has_selective_visibility()) {
-    for (int i = 0; i < num_children; ++i) {
-      CullTraverserData next_data(data, children.get_child(i));
-      do_traverse(next_data);
+    if (batch_frustum != nullptr) {
+      traverse_children_batch(data, children, batch_frustum);
+    } else {
+      for (int i = 0; i < num_children; ++i) {
+        CullTraverserData next_data(data, children.get_child(i));
+        do_traverse(next_data);
+      }
     }
   } else {
     int i = node->get_first_visible_child();
@@ -212,6 +349,215 @@ traverse_below(CullTraverserData &data) {
       i = node->get_next_visible_child(i);
     }
   }
+  --_depth;
+}
+
+/**
+ * Visits all of the indicated children of the node, after first testing their
+ * bounding volumes against the view frustum in a single batch.  Children that
+ * are found to be completely outside the frustum are not visited at all; the
+ * others are visited with their result, so that is_in_view() need not test
+ * them again.
+ */
+void CullTraverser::
+traverse_children_batch(CullTraverserData &data,
+                        const PandaNode::Children &children,
+                        const BoundingHexahedron *frustum) {
+  int num_children = children.get_num_children();
+
+  pvector<CPT(BoundingVolume)> bounds(num_children);
+  pvector<const GeometricBoundingVolume *> volumes(num_children);
+  for (int i = 0; i < num_children; ++i) {
+    bounds[i] = children.get_child(i)->get_bounds(_current_thread);
+    volumes[i] = bounds[i]->as_geometric_bounding_volume();
+    nassertv(volumes[i] != nullptr);
+  }
+
+  pvector<unsigned char> results(num_children);
+  frustum->contains_volumes(num_children, &volumes[0], &results[0]);
+
+  for (int i = 0; i < num_children; ++i) {
+    if (results[i] == BoundingVolume::IF_no_intersection) {
+      continue;
+    }
+
+    CullTraverserData next_data(data, children.get_child(i));
+    next_data._view_frustum_result = results[i];
+    do_traverse(next_data);
+  }
+}
+
+/**
+ * Traverses the nodes below the indicated node, which has already been
+ * converted into the node's space, using a CullSnapshot of its subgraph in
+ * place of walking the scene graph.  The view-frustum test is performed for
+ * all of the snapshot's entries at once; the GeomNodes that pass are then
+ * drawn directly, while any other entries are traversed in the normal way.
+ *
+ * Note that the individual Geoms of a GeomNode reached this way are not
+ * culled separately; the node's bounding sphere is used for all of them.
+ * Also, the CullTraverserData of such a GeomNode links directly to the
+ * snapshot's root, so its get_node_path() leaves out the nodes in between.
+ * The path to any other entry is complete.
+ */
+void CullTraverser::
+traverse_snapshot(CullTraverserData &data, const CullSnapshot *snapshot) {
+  pvector<size_t> visible;
+  snapshot->find_visible(data._view_frustum, visible);
+
+  for (size_t n : visible) {
+    r_traverse_snapshot_entry(data, data, snapshot, n, 0);
+  }
+}
+
+/**
+ * Traverses the nth entry of the snapshot, on behalf of traverse_snapshot().
+ * The parent is the CullTraverserData of the ith node on the path from the
+ * snapshot's root to the entry, or data itself if i is 0.  The rest of the
+ * path is walked first, so that the entry's CullTraverserData describes its
+ * full NodePath.  The nodes on the path need no other processing, since the
+ * snapshot has already applied their transforms and states.
+ */
+void CullTraverser::
+r_traverse_snapshot_entry(const CullTraverserData &data,
+                          const CullTraverserData &parent,
+                          const CullSnapshot *snapshot, size_t n, size_t i) {
+  if (i < snapshot->get_num_path_nodes(n)) {
+    CullTraverserData path_data(parent, snapshot->get_path_node(n, i));
+    r_traverse_snapshot_entry(data, path_data, snapshot, n, i + 1);
+    return;
+  }
+
+  PandaNode *node = snapshot->get_node(n);
+  CullTraverserData next_data(parent, node);
+  next_data._draw_mask = snapshot->compose_draw_mask(n, data._draw_mask);
+  next_data._state = data._state->compose(snapshot->get_net_state(n));
+
+  const TransformState *net_transform = snapshot->get_net_transform(n);
+  if (!net_transform->is_identity()) {
+    if (next_data._instances != nullptr) {
+      next_data._instances = next_data._instances->compose(net_transform);
+    } else {
+      next_data._net_transform = data._net_transform->compose(net_transform);
+    }
+  }
+
+  if (snapshot->get_entry_type(n) == CullSnapshot::ET_geom_node) {
+    // The snapshot has already taken care of this node's transform and
+    // state, as well as the frustum test.
+    _nodes_pcollector.add_level(1);
+    if (!next_data.is_this_node_hidden(_camera_mask)) {
+      next_data._view_frustum = nullptr;
+      node->add_for_draw(this, next_data);
+    }
+
+  } else {
+    // This node has to be traversed normally.  We do have to move the
+    // view frustum into the space of its parent, though.
+    if (next_data._view_frustum != nullptr && !net_transform->is_identity()) {
+      if (net_transform->is_singular()) {
+        next_data._view_frustum = nullptr;
+      } else {
+        next_data._view_frustum = next_data._view_frustum->make_copy()->as_geometric_bounding_volume();
+        nassertv(next_data._view_frustum != nullptr);
+        next_data._view_frustum->xform(net_transform->get_inverse()->get_mat());
+      }
+    }
+    do_traverse(next_data);
+  }
+}
+
+/**
+ * Performs the traversal from the indicated root, splitting the subtrees
+ * found at cull-parallel-depth across the cull worker threads.  The top levels
+ * of the graph are walked by the current thread, which collects the subtrees
+ * to hand off; once all of them have been traversed, the recorded objects are
+ * passed to the CullHandler in the same order a serial traversal would have
+ * produced them.
+ */
+void CullTraverser::
+do_traverse_parallel(CullTraverserData &data) {
+  ParallelCull parallel(this, std::max((int)cull_parallel_depth, 1));
+
+  CullHandler *cull_handler = _cull_handler;
+  _cull_handler = &parallel;
+  _parallel = &parallel;
+  _depth = 0;
+
+  do_traverse(data);
+
+  _parallel = nullptr;
+  _cull_handler = cull_handler;
+
+  PT(WorkerThreadPool) pool = get_worker_pool();
+  pool->run((int)parallel._subtrees.size(), &cull_subtree, &parallel,
+            _current_thread);
+
+  for (ParallelCull::Segment &segment : parallel._segments) {
+    for (CullableObject *object : segment._objects) {
+      _cull_handler->record_object(object, this);
+    }
+  }
+}
+
+/**
+ * The WorkerThreadPool job function for a parallel traversal.  Traverses one
+ * of the deferred subtrees with a private copy of the traverser, collecting
+ * the objects into the subtree's segment.
+ */
+void CullTraverser::
+cull_subtree(void *user_data, int job_index, Thread *current_thread) {
+  ParallelCull *parallel = (ParallelCull *)user_data;
+  ParallelCull::Segment &segment =
+    parallel->_segments[parallel->_subtrees[job_index]];
+
+  ParallelCull::SegmentHandler handler(segment);
+  CullTraverser trav(*parallel->_trav);
+  trav.local_object();
+  trav._current_thread = current_thread;
+  trav._cull_handler = &handler;
+
+  CullTraverserData data(segment._start, segment._net_transform,
+                         segment._state, segment._view_frustum,
+                         current_thread);
+  data._cull_planes = segment._cull_planes;
+  data._draw_mask = segment._draw_mask;
+  data._portal_depth = segment._portal_depth;
+  data._instances = segment._instances;
+  if (!data._cull_planes->is_empty()) {
+    data.node_reader()->check_cached(true);
+  }
+
+  trav.do_traverse(data);
+}
+
+/**
+ * Returns the pool of worker threads shared by all parallel cull traversals,
+ * creating it on first use.  If cull-threads has been changed since the pool
+ * was created, a new pool is created with the new number of threads; the old
+ * pool goes away once any traversal still using it has finished.
+ */
+PT(WorkerThreadPool) CullTraverser::
+get_worker_pool() {
+  // We hold a reference count on the current pool, which is never released
+  // except to replace it, so that the threads aren't stopped at static
+  // destruction time.
+  static Mutex lock("CullTraverser::get_worker_pool");
+  static WorkerThreadPool *pool = nullptr;
+  static int pool_threads = 0;
+
+  int num_threads = cull_threads;
+
+  MutexHolder holder(lock);
+  if (pool == nullptr || pool_threads != num_threads) {
+    if (pool != nullptr) {
+      unref_delete(pool);
+    }
+    pool = new WorkerThreadPool("Cull", num_threads);
+    pool->ref();
+    pool_threads = num_threads;
+  }
+  return pool;
 }
 
 /**
@@ -23,10 +23,12 @@
 #include "geometricBoundingVolume.h"
 #include "pointerTo.h"
 #include "camera.h"
+#include "pandaNode.h"
 #include "drawMask.h"
 #include "typedReferenceCount.h"
 #include "pStatCollector.h"
 #include "fogAttrib.h"
+#include "workerThreadPool.h"
 
 class GraphicsStateGuardian;
 class PandaNode;
@@ -35,6 +37,8 @@ class CullableObject;
 class CullTraverserData;
 class PortalClipper;
 class NodePath;
+class CullSnapshot;
+class BoundingHexahedron;
 
 /**
  * This object performs a depth-first traversal of the scene graph, with
@@ -80,6 +84,8 @@ PUBLISHED:
   void traverse(const NodePath &root);
   void traverse(CullTraverserData &data);
   virtual void traverse_below(CullTraverserData &data);
+  void traverse_snapshot(CullTraverserData &data,
+                         const CullSnapshot *snapshot);
 
   virtual void end_traverse();
 
@@ -90,6 +96,10 @@ PUBLISHED:
 
 protected:
   INLINE void do_traverse(CullTraverserData &data);
+  void r_traverse_snapshot_entry(const CullTraverserData &data,
+                                 const CullTraverserData &parent,
+                                 const CullSnapshot *snapshot,
+                                 size_t n, size_t i);
 
   virtual bool is_in_view(CullTraverserData &data);
 
@@ -101,6 +111,17 @@ public:
   static PStatCollector _geoms_occluded_pcollector;
 
 private:
+  class ParallelCull;
+
+  void do_traverse_parallel(CullTraverserData &data);
+  static void cull_subtree(void *user_data, int job_index,
+                           Thread *current_thread);
+  static PT(WorkerThreadPool) get_worker_pool();
+
+  void traverse_children_batch(CullTraverserData &data,
+                               const PandaNode::Children &children,
+                               const BoundingHexahedron *frustum);
+
   void show_bounds(CullTraverserData &data, bool tight);
   static PT(Geom) make_bounds_viz(const BoundingVolume *vol);
   PT(Geom) make_tight_bounds_viz(PandaNode *node) const;
@@ -122,6 +143,11 @@ private:
   PortalClipper *_portal_clipper;
   bool _effective_incomplete_render;
 
+  // These are only used while a parallel traversal is being set up; see
+  // do_traverse_parallel().
+  ParallelCull *_parallel;
+  int _depth;
+
 public:
   static TypeHandle get_class_type() {
     return _type_handle;
@@ -77,6 +77,12 @@ apply_transform_and_state(CullTraverser *trav) {
 void CullTraverserData::
 apply_transform(const TransformState *node_transform) {
   if (!node_transform->is_identity()) {
+    if (_instances != nullptr) {
+      // Below an InstancedNode, the transform applies to each instance.
+      _instances = _instances->compose(node_transform);
+      return;
+    }
+
     _net_transform = _net_transform->compose(node_transform);
 
     if ((_view_frustum != nullptr) ||
@@ -153,7 +159,10 @@ is_in_view_impl() {
     node_gbv = _node_reader.get_bounds()->as_geometric_bounding_volume();
     nassertr(node_gbv != nullptr, false);
 
-    int result = _view_frustum->contains(node_gbv);
+    int result = _view_frustum_result;
+    if (result < 0) {
+      result = _view_frustum->contains(node_gbv);
+    }
 
     if (pgraph_cat.is_spam()) {
       pgraph_cat.spam()
@@ -16,6 +16,7 @@
 
 #include "pandabase.h"
 #include "cullPlanes.h"
+#include "instanceList.h"
 #include "workingNodePath.h"
 #include "renderState.h"
 #include "transformState.h"
@@ -55,6 +56,7 @@ public:
   INLINE const PandaNodePipelineReader *node_reader() const;
 
   INLINE NodePath get_node_path() const;
+  INLINE PandaNode *get_parent_node() const;
 
 PUBLISHED:
   INLINE CPT(TransformState) get_modelview_transform(const CullTraverser *trav) const;
@@ -84,6 +86,16 @@ public:
   DrawMask _draw_mask;
   int _portal_depth;
 
+  // If this is not null, we are below an InstancedNode, and the geometry is
+  // to be rendered once for each of these instances.  Transforms below the
+  // InstancedNode are applied to the instances instead of _net_transform.
+  CPT(InstanceList) _instances;
+
+  // If this is not -1, the node's bounding volume has already been tested
+  // against _view_frustum, with this result, so is_in_view() need not test
+  // it again.
+  int _view_frustum_result;
+
 private:
   PT(NodePathComponent) r_get_node_path() const;
 
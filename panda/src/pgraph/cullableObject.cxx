@@ -152,6 +152,15 @@ munge_geom(GraphicsStateGuardianBase *gsg, GeomMunger *munger,
         _state = _state->compose(state);
       }
 
+      // Likewise if the normals were left in octahedral encoding.
+      const GeomVertexColumn *normal_column = data_reader.get_format()->get_normal_column();
+      if (normal_column != nullptr &&
+          normal_column->get_contents() == Geom::C_octahedral_normal) {
+        static CPT(RenderState) state = RenderState::make(
+          DCAST(ShaderAttrib, ShaderAttrib::make())->set_flag(ShaderAttrib::F_octahedral_normals, true));
+        _state = _state->compose(state);
+      }
+
       gsg->ensure_generated_shader(_state);
     } else {
       // We may need to munge the state for the fixed-function pipeline.
@@ -173,6 +182,12 @@ munge_geom(GraphicsStateGuardianBase *gsg, GeomMunger *munger,
       std::swap(_munged_data, animated_vertices);
     }
 
+    // Now that the vertex data is in its final form, add the per-instance
+    // transforms to it, if we are using hardware instancing.
+    if (_instances != nullptr) {
+      _munged_data = _instances->add_instance_array(_munged_data, current_thread);
+    }
+
 #ifndef NDEBUG
     if (show_vertex_animation) {
       GeomVertexDataPipelineReader data_reader(_munged_data, current_thread);
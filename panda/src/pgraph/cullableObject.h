@@ -30,6 +30,7 @@
 #include "lightMutex.h"
 #include "callbackObject.h"
 #include "geomDrawCallbackData.h"
+#include "instanceList.h"
 
 class CullTraverser;
 class GeomMunger;
@@ -74,6 +75,16 @@ public:
   CPT(TransformState) _internal_transform;
   PT(CallbackObject) _draw_callback;
 
+  // If this is set, the object is rendered once for each of these instances,
+  // with hardware instancing.
+  CPT(InstanceList) _instances;
+
+  // The net transform of the node, and the node whose children may be
+  // batched together, which are only filled in when dynamic-batching is
+  // enabled.  See CullBatchCache.
+  CPT(TransformState) _net_transform;
+  const PandaNode *_batch_group;
+
 private:
   bool munge_points_to_quads(const CullTraverser *traverser, bool force);
 
@@ -37,6 +37,7 @@
 #include "graphicsStateGuardianBase.h"
 #include "boundingBox.h"
 #include "boundingSphere.h"
+#include "boundingHexahedron.h"
 #include "config_mathutil.h"
 #include "preparedGraphicsObjects.h"
 
@@ -515,6 +516,29 @@ add_for_draw(CullTraverser *trav, CullTraverserData &data) {
   trav->_geoms_pcollector.add_level(num_geoms);
   CPT(TransformState) internal_transform = data.get_internal_transform(trav);
 
+  // If we are below an InstancedNode, each Geom is drawn just once, with
+  // hardware instancing, for all of the instances.
+  const InstanceList *instances = data._instances;
+
+  // If there are many Geoms, test all of their bounding volumes against the
+  // view frustum at once, rather than one at a time in the loop below.
+  pvector<unsigned char> frustum_results;
+  if (data._view_frustum != nullptr && num_geoms > 1 &&
+      cull_batch_threshold > 0 && num_geoms >= cull_batch_threshold) {
+    const BoundingHexahedron *frustum = data._view_frustum->as_bounding_hexahedron();
+    if (frustum != nullptr) {
+      pvector<CPT(BoundingVolume)> bounds(num_geoms);
+      pvector<const GeometricBoundingVolume *> volumes(num_geoms);
+      for (int i = 0; i < num_geoms; i++) {
+        bounds[i] = geoms.get_geom(i)->get_bounds(current_thread);
+        volumes[i] = bounds[i]->as_geometric_bounding_volume();
+        nassertv(volumes[i] != nullptr);
+      }
+      frustum_results.resize(num_geoms);
+      frustum->contains_volumes(num_geoms, &volumes[0], &frustum_results[0]);
+    }
+  }
+
   for (int i = 0; i < num_geoms; i++) {
     CPT(Geom) geom = geoms.get_geom(i);
     if (geom->is_empty()) {
@@ -532,7 +556,12 @@ add_for_draw(CullTraverser *trav, CullTraverserData &data) {
     // otherwise the bounding volume of the GeomNode is (probably) the same as
     // that of the one Geom, and we've already culled against that.
     if (num_geoms > 1) {
-      if (data._view_frustum != nullptr) {
+      if (!frustum_results.empty()) {
+        if (frustum_results[i] == BoundingVolume::IF_no_intersection) {
+          // Cull this Geom.
+          continue;
+        }
+      } else if (data._view_frustum != nullptr) {
         // Cull the individual Geom against the view frustum.
         CPT(BoundingVolume) geom_volume = geom->get_bounds(current_thread);
         const GeometricBoundingVolume *geom_gbv =
@@ -558,8 +587,22 @@ add_for_draw(CullTraverser *trav, CullTraverserData &data) {
       }
     }
 
+    if (instances != nullptr) {
+      const ShaderAttrib *sattr;
+      state->get_attrib_def(sattr);
+      state = state->set_attrib(sattr->set_instance_count((int)instances->size()));
+    }
+
     CullableObject *object =
       new CullableObject(std::move(geom), std::move(state), internal_transform);
+    object->_instances = instances;
+    if (dynamic_batching && instances == nullptr) {
+      object->_net_transform = data.get_net_transform(trav);
+      object->_batch_group = data.get_parent_node();
+      if (object->_batch_group == nullptr) {
+        object->_batch_group = this;
+      }
+    }
     trav->get_cull_handler()->record_object(object, trav);
   }
 }
@@ -928,6 +928,29 @@ finish_apply() {
   _reversed_normals.clear();
 }
 
+/**
+ * Should be called after registering the Geoms of interest with
+ * register_vertices().  Reorders the rows of each of their GeomVertexDatas
+ * into the order in which the Geoms use them, once for all of the Geoms that
+ * share that GeomVertexData.  Returns the number of GeomVertexDatas that were
+ * changed.
+ */
+int GeomTransformer::
+finish_optimize_vertex_fetch() {
+  int num_changed = 0;
+  VertexDataAssocMap::iterator vi;
+  for (vi = _vdata_assoc.begin(); vi != _vdata_assoc.end(); ++vi) {
+    const GeomVertexData *vdata = (*vi).first;
+    VertexDataAssoc &assoc = (*vi).second;
+    if (assoc.optimize_vertex_fetch(vdata)) {
+      ++num_changed;
+    }
+  }
+  _vdata_assoc.clear();
+
+  return num_changed;
+}
+
 /**
  * Collects together GeomVertexDatas from different geoms into one big (or
  * several big) GeomVertexDatas.  Returns the number of unique GeomVertexDatas
@@ -1414,6 +1437,25 @@ update_geoms() {
   }
 }
 
+/**
+ * Reorders the indicated vertex data for all of the associated Geoms that
+ * still reference it.  See Geom::optimize_vertex_fetch().
+ */
+bool GeomTransformer::VertexDataAssoc::
+optimize_vertex_fetch(const GeomVertexData *vdata) {
+  GeomList geoms;
+  GeomList::iterator gi;
+  for (gi = _geoms.begin(); gi != _geoms.end(); ++gi) {
+    Geom *geom = (*gi);
+    if (geom->get_vertex_data() == vdata &&
+        std::find(geoms.begin(), geoms.end(), geom) == geoms.end()) {
+      geoms.push_back(geom);
+    }
+  }
+
+  return Geom::optimize_vertex_fetch(geoms);
+}
+
 /**
  *
  */
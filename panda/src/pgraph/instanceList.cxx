@@ -0,0 +1,211 @@
+/**
+ * PANDA 3D SOFTWARE
+ * Copyright (c) Carnegie Mellon University.  All rights reserved.
+ *
+ * All use of this software is subject to the terms of the revised BSD
+ * license.  You should have received a copy of this license along
+ * with this source code in a file named "LICENSE."
+ *
+ * @file instanceList.cxx
+ * @author blablabla94
+ * @date 2026-10-16
+ */
+
+#include "instanceList.h"
+#include "geomVertexData.h"
+#include "geomVertexFormat.h"
+#include "internalName.h"
+#include "lightMutexHolder.h"
+
+/**
+ * Removes the nth instance from the list.  This may not be called while the
+ * list is in use by the cull traversal.
+ */
+void InstanceList::
+remove_transform(size_t n) {
+  nassertv(n < _transforms.size());
+  _transforms.erase(_transforms.begin() + n);
+  _array.clear();
+  _datas.clear();
+  _composed_transforms.clear();
+  _composed_lists.clear();
+}
+
+/**
+ * Returns a list in which each instance transform has been composed with the
+ * indicated transform, which is applied first; that is, in the coordinate
+ * space of each instance.  This is used to account for transforms on the
+ * nodes below an InstancedNode.
+ *
+ * The result is cached, so that composing with the same transform again
+ * returns the same list, along with the arrays cached on it.
+ */
+CPT(InstanceList) InstanceList::
+compose(const TransformState *transform) const {
+  if (transform->is_identity()) {
+    return this;
+  }
+
+  {
+    LightMutexHolder holder(_lock);
+    for (const auto &entry : _composed_transforms) {
+      if (entry.first == transform) {
+        return entry.second;
+      }
+    }
+  }
+
+  PT(InstanceList) result = new InstanceList;
+  result->_transforms.reserve(_transforms.size());
+  for (const TransformState *instance : _transforms) {
+    result->_transforms.push_back(instance->compose(transform));
+  }
+
+  LightMutexHolder holder(_lock);
+  for (const auto &entry : _composed_transforms) {
+    if (entry.first == transform) {
+      // Another thread got here first.
+      return entry.second;
+    }
+  }
+  if (_composed_transforms.size() >= max_composed) {
+    _composed_transforms.erase(_composed_transforms.begin());
+  }
+  _composed_transforms.push_back(std::make_pair(CPT(TransformState)(transform), CPT(InstanceList)(result)));
+  return result;
+}
+
+/**
+ * Returns a list containing every instance of the other list within every
+ * instance of this list.  This is used when an InstancedNode is nested below
+ * another InstancedNode.
+ *
+ * As above, the result is cached for as long as the other list is unchanged.
+ */
+CPT(InstanceList) InstanceList::
+compose(const InstanceList *other) const {
+  {
+    LightMutexHolder holder(_lock);
+    for (const auto &entry : _composed_lists) {
+      if (entry.first == other) {
+        return entry.second;
+      }
+    }
+  }
+
+  PT(InstanceList) result = new InstanceList;
+  result->_transforms.reserve(_transforms.size() * other->_transforms.size());
+  for (const TransformState *instance : _transforms) {
+    for (const TransformState *other_instance : other->_transforms) {
+      result->_transforms.push_back(instance->compose(other_instance));
+    }
+  }
+
+  LightMutexHolder holder(_lock);
+  for (const auto &entry : _composed_lists) {
+    if (entry.first == other) {
+      return entry.second;
+    }
+  }
+  if (_composed_lists.size() >= max_composed) {
+    _composed_lists.erase(_composed_lists.begin());
+  }
+  _composed_lists.push_back(std::make_pair(CPT(InstanceList)(other), CPT(InstanceList)(result)));
+  return result;
+}
+
+/**
+ * Returns the vertex array containing the instance matrices, in the format
+ * returned by get_array_format().  This is computed the first time it is
+ * requested, and then cached for the lifetime of the list.
+ */
+CPT(GeomVertexArrayData) InstanceList::
+get_array(Thread *current_thread) const {
+  LightMutexHolder holder(_lock);
+  if (_array != nullptr) {
+    return _array;
+  }
+
+  PT(GeomVertexArrayData) array =
+    new GeomVertexArrayData(get_array_format(), GeomEnums::UH_dynamic);
+  {
+    PT(GeomVertexArrayDataHandle) handle = array->modify_handle(current_thread);
+    handle->unclean_set_num_rows((int)_transforms.size());
+    unsigned char *p = handle->get_write_pointer();
+    for (const TransformState *instance : _transforms) {
+      LMatrix4f mat = LCAST(float, instance->get_mat());
+      memcpy(p, mat.get_data(), sizeof(float) * 16);
+      p += sizeof(float) * 16;
+    }
+  }
+
+  _array = array;
+  return _array;
+}
+
+/**
+ * Returns a copy of the indicated vertex data, with the instance array
+ * returned by get_array() added to it, so that a Geom may be rendered once for
+ * all of the instances in the list.  This should be called on the munged
+ * vertex data, since the munger does not know how to convert the instance
+ * array.  The result is cached on the list, and shares all of the original
+ * vertex arrays.
+ */
+CPT(GeomVertexData) InstanceList::
+add_instance_array(const GeomVertexData *data, Thread *current_thread) const {
+  UpdateSeq modified = data->get_modified(current_thread);
+  {
+    LightMutexHolder holder(_lock);
+    InstancedDatas::const_iterator di = _datas.find(data);
+    if (di != _datas.end() && (*di).second._modified == modified) {
+      return (*di).second._result;
+    }
+  }
+
+  CPT(GeomVertexArrayData) array = get_array(current_thread);
+
+  // Append the instance array to the vertex format.
+  PT(GeomVertexFormat) new_format = new GeomVertexFormat(*data->get_format());
+  new_format->add_array(get_array_format());
+  CPT(GeomVertexFormat) format = GeomVertexFormat::register_format(new_format);
+
+  // Make a new GeomVertexData that shares the original arrays, so that they
+  // don't need to be uploaded to the graphics card again.
+  PT(GeomVertexData) new_data = new GeomVertexData(*data, format);
+  size_t num_arrays = data->get_num_arrays();
+  for (size_t i = 0; i < num_arrays; ++i) {
+    new_data->set_array(i, data->get_array(i));
+  }
+  new_data->set_array(num_arrays, array);
+
+  LightMutexHolder holder(_lock);
+  InstancedData &entry = _datas[data];
+  entry._source = data;
+  entry._modified = modified;
+  entry._result = new_data;
+  return new_data;
+}
+
+/**
+ * Returns the format of the vertex array that stores the instance matrices.
+ * It has a single matrix column named "instance_matrix", and a divisor of 1.
+ */
+const GeomVertexArrayFormat *InstanceList::
+get_array_format() {
+  static CPT(GeomVertexArrayFormat) format = [] {
+    PT(GeomVertexArrayFormat) new_format = new GeomVertexArrayFormat;
+    new_format->add_column(InternalName::get_instance_matrix(), 4,
+                           GeomEnums::NT_float32, GeomEnums::C_matrix);
+    new_format->set_divisor(1);
+    return GeomVertexArrayFormat::register_format(new_format);
+  }();
+  return format;
+}
+
+/**
+ *
+ */
+void InstanceList::
+output(std::ostream &out) const {
+  out << "InstanceList(" << _transforms.size() << " instances)";
+}
@@ -0,0 +1,105 @@
+/**
+ * PANDA 3D SOFTWARE
+ * Copyright (c) Carnegie Mellon University.  All rights reserved.
+ *
+ * All use of this software is subject to the terms of the revised BSD
+ * license.  You should have received a copy of this license along
+ * with this source code in a file named "LICENSE."
+ *
+ * @file instanceList.h
+ * @author blablabla94
+ * @date 2026-10-16
+ */
+
+#ifndef INSTANCELIST_H
+#define INSTANCELIST_H
+
+#include "pandabase.h"
+#include "referenceCount.h"
+#include "pointerTo.h"
+#include "transformState.h"
+#include "geom.h"
+#include "geomVertexArrayData.h"
+#include "geomVertexArrayFormat.h"
+#include "lightMutex.h"
+#include "pvector.h"
+#include "pmap.h"
+#include "updateSeq.h"
+
+/**
+ * A list of transforms, one for each instance of the geometry below an
+ * InstancedNode.  During the cull traversal, this is used to render each
+ * Geom just once, with hardware instancing: the transforms are stored in an
+ * additional vertex array with a divisor of 1, which is appended to the
+ * Geom's munged vertex data, and which the shader may access as
+ * p3d_InstanceMatrix.
+ *
+ * An InstanceList is not modified once it has been handed to the cull
+ * traversal; the vertex array and the extended vertex datas are cached on it and
+ * reused for as long as the list stays alive.  The lists composed from it with
+ * the transforms below the InstancedNode are cached on it as well.  InstancedNode makes a copy of
+ * its list before modifying it if the list is shared.
+ */
+class EXPCL_PANDA_PGRAPH InstanceList : public ReferenceCount {
+public:
+  INLINE InstanceList();
+  INLINE InstanceList(const InstanceList &copy);
+
+  INLINE bool empty() const;
+  INLINE size_t size() const;
+  INLINE const TransformState *get_transform(size_t n) const;
+  INLINE void reserve(size_t num_instances);
+  INLINE void append(const TransformState *transform);
+  INLINE void set_transform(size_t n, const TransformState *transform);
+  void remove_transform(size_t n);
+
+  CPT(InstanceList) compose(const TransformState *transform) const;
+  CPT(InstanceList) compose(const InstanceList *other) const;
+
+  CPT(GeomVertexArrayData) get_array(Thread *current_thread) const;
+  CPT(GeomVertexData) add_instance_array(const GeomVertexData *data,
+                                         Thread *current_thread) const;
+
+  static const GeomVertexArrayFormat *get_array_format();
+
+  void output(std::ostream &out) const;
+
+private:
+  typedef pvector<CPT(TransformState) > Transforms;
+  Transforms _transforms;
+
+  // The cached vertex array, and the vertex datas that have been extended
+  // with it.  These are filled in lazily by the cull traversal, which may run
+  // in several threads at once, hence the lock.
+  class InstancedData {
+  public:
+    CPT(GeomVertexData) _source;
+    UpdateSeq _modified;
+    CPT(GeomVertexData) _result;
+  };
+  typedef pmap<const GeomVertexData *, InstancedData> InstancedDatas;
+
+  mutable LightMutex _lock;
+  mutable CPT(GeomVertexArrayData) _array;
+  mutable InstancedDatas _datas;
+
+  // The lists most recently composed from this one.  Returning the same list
+  // each frame, for as long as the transforms below the InstancedNode don't
+  // change, lets the arrays cached on it be reused rather than recomputed
+  // and uploaded again.  Only the last few of each are kept.
+  typedef pvector<std::pair<CPT(TransformState), CPT(InstanceList) > > ComposedTransforms;
+  typedef pvector<std::pair<CPT(InstanceList), CPT(InstanceList) > > ComposedLists;
+  mutable ComposedTransforms _composed_transforms;
+  mutable ComposedLists _composed_lists;
+
+  enum { max_composed = 8 };
+};
+
+INLINE std::ostream &operator << (std::ostream &out, const InstanceList &list) {
+  list.output(out);
+  return out;
+}
+
+#include "instanceList.I"
+
+#endif
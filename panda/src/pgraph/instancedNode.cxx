@@ -0,0 +1,472 @@
+/**
+ * PANDA 3D SOFTWARE
+ * Copyright (c) Carnegie Mellon University.  All rights reserved.
+ *
+ * All use of this software is subject to the terms of the revised BSD
+ * license.  You should have received a copy of this license along
+ * with this source code in a file named "LICENSE."
+ *
+ * @file instancedNode.cxx
+ * @author blablabla94
+ * @date 2026-10-16
+ */
+
+#include "instancedNode.h"
+#include "cullTraverser.h"
+#include "cullTraverserData.h"
+#include "cullPlanes.h"
+#include "boundingBox.h"
+#include "boundingSphere.h"
+#include "boundingHexahedron.h"
+#include "lightMutexHolder.h"
+#include "bamReader.h"
+#include "bamWriter.h"
+#include "datagram.h"
+#include "datagramIterator.h"
+
+TypeHandle InstancedNode::_type_handle;
+
+/**
+ *
+ */
+CycleData *InstancedNode::CData::
+make_copy() const {
+  return new CData(*this);
+}
+
+/**
+ * Writes the contents of this object to the datagram for shipping out to a
+ * Bam file.
+ */
+void InstancedNode::CData::
+write_datagram(BamWriter *manager, Datagram &dg) const {
+  dg.add_uint32(_instances->size());
+  for (size_t i = 0; i < _instances->size(); ++i) {
+    manager->write_pointer(dg, _instances->get_transform(i));
+  }
+}
+
+/**
+ * Receives an array of pointers, one for each time manager->read_pointer()
+ * was called in fillin().  Returns the number of pointers processed.
+ */
+int InstancedNode::CData::
+complete_pointers(TypedWritable **p_list, BamReader *manager) {
+  int pi = CycleData::complete_pointers(p_list, manager);
+
+  PT(InstanceList) instances = new InstanceList;
+  instances->reserve(_num_bam_instances);
+  for (size_t i = 0; i < _num_bam_instances; ++i) {
+    TransformState *transform;
+    DCAST_INTO_R(transform, p_list[pi++], pi);
+    instances->append(transform);
+    manager->finalize_now(transform);
+  }
+  _instances = instances;
+  _num_bam_instances = 0;
+
+  return pi;
+}
+
+/**
+ * This internal function is called by make_from_bam to read in all of the
+ * relevant data from the BamFile for the new InstancedNode.
+ */
+void InstancedNode::CData::
+fillin(DatagramIterator &scan, BamReader *manager) {
+  _num_bam_instances = scan.get_uint32();
+  manager->read_pointers(scan, _num_bam_instances);
+}
+
+/**
+ *
+ */
+InstancedNode::
+InstancedNode(const std::string &name) :
+  PandaNode(name),
+  _cull_lock("InstancedNode::_cull_lock")
+{
+  set_cull_callback();
+}
+
+/**
+ *
+ */
+InstancedNode::
+InstancedNode(const InstancedNode &copy) :
+  PandaNode(copy),
+  _cycler(copy._cycler),
+  _cull_lock("InstancedNode::_cull_lock")
+{
+}
+
+/**
+ *
+ */
+InstancedNode::
+~InstancedNode() {
+}
+
+/**
+ * Returns a newly-allocated Node that is a shallow copy of this one.  It will
+ * be a different Node pointer, but its internal data may or may not be shared
+ * with that of the original Node.
+ */
+PandaNode *InstancedNode::
+make_copy() const {
+  return new InstancedNode(*this);
+}
+
+/**
+ * Returns true if it is generally safe to flatten out this particular kind of
+ * Node by duplicating instances, false otherwise (for instance, a Camera
+ * cannot be safely flattened, because the Camera pointer itself is
+ * meaningful).
+ */
+bool InstancedNode::
+safe_to_flatten() const {
+  return false;
+}
+
+/**
+ * Returns true if it is generally safe to transform this particular kind of
+ * Node by calling the xform() method, false otherwise.
+ */
+bool InstancedNode::
+safe_to_transform() const {
+  return false;
+}
+
+/**
+ * Returns true if it is generally safe to combine this particular kind of
+ * PandaNode with other kinds of PandaNodes of compatible type, adding
+ * children or whatever.  For instance, an LODNode should not be combined with
+ * any other PandaNode, because its set of children is meaningful.
+ */
+bool InstancedNode::
+safe_to_combine() const {
+  return false;
+}
+
+/**
+ * This function will be called during the cull traversal to perform any
+ * additional operations that should be performed at cull time.  This may
+ * include additional manipulation of render state or additional
+ * visible/invisible decisions, or any other arbitrary operation.
+ *
+ * Note that this function will *not* be called unless set_cull_callback() is
+ * called in the constructor of the derived class.  It is necessary to call
+ * set_cull_callback() to indicated that we require cull_callback() to be
+ * called.
+ *
+ * By the time this function is called, the node has already passed the
+ * bounding-volume test for the viewing frustum, and the node's transform and
+ * state have already been applied to the indicated CullTraverserData object.
+ *
+ * The return value is true if this node should be visible, or false if it
+ * should be culled.
+ */
+bool InstancedNode::
+cull_callback(CullTraverser *trav, CullTraverserData &data) {
+  Thread *current_thread = trav->get_current_thread();
+
+  CPT(InstanceList) instances = get_instances(current_thread);
+  if (instances->empty()) {
+    return false;
+  }
+
+  if (data._view_frustum != nullptr) {
+    instances = cull_instances(instances, data._view_frustum, current_thread);
+    if (instances->empty()) {
+      return false;
+    }
+  }
+
+  if (data._instances != nullptr) {
+    // We are nested below another InstancedNode.
+    instances = data._instances->compose(instances);
+  }
+  data._instances = std::move(instances);
+
+  // The nodes below are rendered at the location of each instance rather
+  // than where they are, so they can no longer be culled individually.
+  data._view_frustum = nullptr;
+  data._cull_planes = CullPlanes::make_empty();
+  return true;
+}
+
+/**
+ *
+ */
+void InstancedNode::
+output(std::ostream &out) const {
+  PandaNode::output(out);
+  out << " (" << get_num_instances() << " instances)";
+}
+
+/**
+ * Adds a new instance of the geometry below this node, at the indicated
+ * transform relative to this node.  Returns the index of the new instance.
+ */
+size_t InstancedNode::
+add_instance(const TransformState *transform) {
+  nassertr(transform != nullptr, 0);
+
+  size_t index;
+  {
+    CDWriter cdata(_cycler);
+    InstanceList *instances = modify_instances(cdata);
+    index = instances->size();
+    instances->append(transform);
+  }
+  mark_bounds_stale();
+  mark_bam_modified();
+  return index;
+}
+
+/**
+ * Changes the transform of the nth instance.
+ */
+void InstancedNode::
+set_instance_transform(size_t n, const TransformState *transform) {
+  nassertv(transform != nullptr);
+  {
+    CDWriter cdata(_cycler);
+    nassertv(n < cdata->_instances->size());
+    modify_instances(cdata)->set_transform(n, transform);
+  }
+  mark_bounds_stale();
+  mark_bam_modified();
+}
+
+/**
+ * Removes the nth instance.  The indices of the subsequent instances are
+ * shifted down by one.
+ */
+void InstancedNode::
+remove_instance(size_t n) {
+  {
+    CDWriter cdata(_cycler);
+    nassertv(n < cdata->_instances->size());
+    modify_instances(cdata)->remove_transform(n);
+  }
+  mark_bounds_stale();
+  mark_bam_modified();
+}
+
+/**
+ * Removes all of the instances, so that nothing is rendered below this node.
+ */
+void InstancedNode::
+clear_instances() {
+  {
+    CDWriter cdata(_cycler);
+    cdata->_instances = new InstanceList;
+  }
+  mark_bounds_stale();
+  mark_bam_modified();
+}
+
+/**
+ * Computes the external bounding volume of the node.  This is the volume
+ * around the children, placed at the location of each of the instances.
+ */
+void InstancedNode::
+compute_external_bounds(CPT(BoundingVolume) &external_bounds,
+                        BoundingVolume::BoundsType btype,
+                        const BoundingVolume **volumes, size_t num_volumes,
+                        int pipeline_stage, Thread *current_thread) const {
+  CPT(InstanceList) instances;
+  {
+    CDStageReader cdata(_cycler, pipeline_stage, current_thread);
+    instances = cdata->_instances;
+  }
+
+  PT(GeometricBoundingVolume) gbv;
+  if (btype == BoundingVolume::BT_box) {
+    gbv = new BoundingBox;
+  } else {
+    gbv = new BoundingSphere;
+  }
+
+  if (num_volumes == 0 || instances->empty()) {
+    external_bounds = gbv;
+    return;
+  }
+
+  PT(GeometricBoundingVolume) child_gbv =
+    gbv->make_copy()->as_geometric_bounding_volume();
+  ((BoundingVolume *)child_gbv)->around(volumes, volumes + num_volumes);
+
+  if (child_gbv->is_empty() || child_gbv->is_infinite()) {
+    gbv = child_gbv;
+  } else {
+    size_t num_instances = instances->size();
+    pvector<PT(GeometricBoundingVolume) > instance_gbvs(num_instances);
+    pvector<const BoundingVolume *> instance_volumes(num_instances);
+    for (size_t i = 0; i < num_instances; ++i) {
+      instance_gbvs[i] = child_gbv->make_copy()->as_geometric_bounding_volume();
+      instance_gbvs[i]->xform(instances->get_transform(i)->get_mat());
+      instance_volumes[i] = instance_gbvs[i];
+    }
+    const BoundingVolume **first = &instance_volumes[0];
+    ((BoundingVolume *)gbv)->around(first, first + num_instances);
+  }
+
+  CPT(TransformState) transform = get_transform(current_thread);
+  if (!transform->is_identity()) {
+    gbv->xform(transform->get_mat());
+  }
+
+  external_bounds = gbv;
+}
+
+/**
+ * Returns a writable pointer to the instance list stored in the indicated
+ * CData, making a copy of it first if it is shared with another pipeline
+ * stage or with the cull traversal.
+ */
+InstanceList *InstancedNode::
+modify_instances(CData *cdata) {
+  if (cdata->_instances->get_ref_count() > 1) {
+    cdata->_instances = new InstanceList(*cdata->_instances);
+  }
+  return (InstanceList *)cdata->_instances.p();
+}
+
+/**
+ * Tests each of the instances against the view frustum, and returns the list
+ * of the instances that are at least partially visible.  If the same
+ * instances are visible as the last time this was called, returns the same
+ * list as before, so that its cached vertex array may be reused.
+ */
+CPT(InstanceList) InstancedNode::
+cull_instances(const InstanceList *instances,
+               const GeometricBoundingVolume *view_frustum,
+               Thread *current_thread) {
+  // Find the bounding sphere around the children, in our coordinate space.
+  Children children = get_children(current_thread);
+  size_t num_children = children.get_num_children();
+  pvector<CPT(BoundingVolume) > child_volumes_ref(num_children);
+  pvector<const BoundingVolume *> child_volumes(num_children);
+  for (size_t ci = 0; ci < num_children; ++ci) {
+    child_volumes_ref[ci] = children.get_child(ci)->get_bounds(current_thread);
+    child_volumes[ci] = child_volumes_ref[ci];
+  }
+  BoundingSphere child_sphere;
+  if (num_children > 0) {
+    const BoundingVolume **first = &child_volumes[0];
+    ((BoundingVolume &)child_sphere).around(first, first + num_children);
+  }
+  if (child_sphere.is_empty() || child_sphere.is_infinite()) {
+    return instances;
+  }
+  LPoint3 center = child_sphere.get_center();
+  PN_stdfloat radius = child_sphere.get_radius();
+
+  // Place a copy of the sphere at each instance.
+  size_t num_instances = instances->size();
+  pvector<PN_stdfloat> center_x(num_instances), center_y(num_instances);
+  pvector<PN_stdfloat> center_z(num_instances), radii(num_instances);
+  for (size_t i = 0; i < num_instances; ++i) {
+    const LMatrix4 &mat = instances->get_transform(i)->get_mat();
+    LPoint3 instance_center = center * mat;
+    PN_stdfloat scale = std::max(mat.get_row3(0).length_squared(),
+                                 mat.get_row3(1).length_squared());
+    scale = std::max(scale, mat.get_row3(2).length_squared());
+    center_x[i] = instance_center[0];
+    center_y[i] = instance_center[1];
+    center_z[i] = instance_center[2];
+    radii[i] = radius * csqrt(scale);
+  }
+
+  pvector<unsigned char> results(num_instances);
+  const BoundingHexahedron *frustum = view_frustum->as_bounding_hexahedron();
+  if (frustum != nullptr) {
+    frustum->contains_spheres(num_instances, &center_x[0], &center_y[0],
+                              &center_z[0], &radii[0], &results[0]);
+  } else {
+    for (size_t i = 0; i < num_instances; ++i) {
+      BoundingSphere sphere(LPoint3(center_x[i], center_y[i], center_z[i]),
+                            radii[i]);
+      results[i] = (unsigned char)view_frustum->contains(&sphere);
+    }
+  }
+
+  // Reduce the results to a visible/invisible flag per instance, so that
+  // they can be compared with the previous frame's.
+  size_t num_visible = 0;
+  for (size_t i = 0; i < num_instances; ++i) {
+    results[i] = (results[i] != BoundingVolume::IF_no_intersection);
+    num_visible += results[i];
+  }
+
+  LightMutexHolder holder(_cull_lock);
+  if (_cull_source == instances && _cull_results == results) {
+    return _cull_instances;
+  }
+
+  CPT(InstanceList) visible;
+  if (num_visible == num_instances) {
+    visible = instances;
+  } else {
+    PT(InstanceList) list = new InstanceList;
+    list->reserve(num_visible);
+    for (size_t i = 0; i < num_instances; ++i) {
+      if (results[i]) {
+        list->append(instances->get_transform(i));
+      }
+    }
+    visible = list;
+  }
+
+  _cull_source = instances;
+  _cull_results.swap(results);
+  _cull_instances = visible;
+  return visible;
+}
+
+/**
+ * Tells the BamReader how to create objects of type InstancedNode.
+ */
+void InstancedNode::
+register_with_read_factory() {
+  BamReader::get_factory()->register_factory(get_class_type(), make_from_bam);
+}
+
+/**
+ * Writes the contents of this object to the datagram for shipping out to a
+ * Bam file.
+ */
+void InstancedNode::
+write_datagram(BamWriter *manager, Datagram &dg) {
+  PandaNode::write_datagram(manager, dg);
+  manager->write_cdata(dg, _cycler);
+}
+
+/**
+ * This function is called by the BamReader's factory when a new object of
+ * type InstancedNode is encountered in the Bam file.  It should create the
+ * InstancedNode and extract its information from the file.
+ */
+TypedWritable *InstancedNode::
+make_from_bam(const FactoryParams &params) {
+  InstancedNode *node = new InstancedNode("");
+  DatagramIterator scan;
+  BamReader *manager;
+
+  parse_params(params, scan, manager);
+  node->fillin(scan, manager);
+
+  return node;
+}
+
+/**
+ * This internal function is called by make_from_bam to read in all of the
+ * relevant data from the BamFile for the new InstancedNode.
+ */
+void InstancedNode::
+fillin(DatagramIterator &scan, BamReader *manager) {
+  PandaNode::fillin(scan, manager);
+  manager->read_cdata(scan, _cycler);
+}
@@ -0,0 +1,155 @@
+/**
+ * PANDA 3D SOFTWARE
+ * Copyright (c) Carnegie Mellon University.  All rights reserved.
+ *
+ * All use of this software is subject to the terms of the revised BSD
+ * license.  You should have received a copy of this license along
+ * with this source code in a file named "LICENSE."
+ *
+ * @file instancedNode.h
+ * @author blablabla94
+ * @date 2026-10-16
+ */
+
+#ifndef INSTANCEDNODE_H
+#define INSTANCEDNODE_H
+
+#include "pandabase.h"
+#include "pandaNode.h"
+#include "instanceList.h"
+#include "lightMutex.h"
+#include "cycleData.h"
+#include "cycleDataReader.h"
+#include "cycleDataWriter.h"
+#include "cycleDataStageReader.h"
+#include "pipelineCycler.h"
+
+/**
+ * This is a special node that renders the geometry below it many times, once
+ * for each of a list of instance transforms, using hardware instancing.
+ * Each Geom below the node is issued in a single draw call for all of the
+ * visible instances, regardless of how many instances there are.
+ *
+ * The instance transforms are relative to the InstancedNode.  They are made
+ * available to the shader as a per-instance vertex attribute, so the Geoms
+ * must be rendered with a shader that applies them, like so:
+ *
+ *   in mat4 p3d_InstanceMatrix;
+ *   gl_Position = p3d_ModelViewProjectionMatrix * (p3d_InstanceMatrix * p3d_Vertex);
+ *
+ * Each instance is culled individually against the view frustum.  Only
+ * GeomNodes are instanced; other renderable nodes below an InstancedNode are
+ * rendered just once.  Transforms on the nodes below an InstancedNode are
+ * folded into the instance matrices, which then have to be rebuilt every
+ * frame, so it is best to flatten the subgraph below it.
+ */
+class EXPCL_PANDA_PGRAPH InstancedNode : public PandaNode {
+PUBLISHED:
+  explicit InstancedNode(const std::string &name);
+
+protected:
+  InstancedNode(const InstancedNode &copy);
+
+public:
+  virtual ~InstancedNode();
+  virtual PandaNode *make_copy() const;
+
+  virtual bool safe_to_flatten() const;
+  virtual bool safe_to_transform() const;
+  virtual bool safe_to_combine() const;
+
+  virtual bool cull_callback(CullTraverser *trav, CullTraverserData &data);
+
+  virtual void output(std::ostream &out) const;
+
+PUBLISHED:
+  INLINE size_t get_num_instances() const;
+  INLINE CPT(TransformState) get_instance_transform(size_t n) const;
+  MAKE_SEQ(get_instance_transforms, get_num_instances, get_instance_transform);
+  size_t add_instance(const TransformState *transform);
+  void set_instance_transform(size_t n, const TransformState *transform);
+  void remove_instance(size_t n);
+  void clear_instances();
+
+  MAKE_SEQ_PROPERTY(instance_transforms, get_num_instances, get_instance_transform);
+
+public:
+  INLINE CPT(InstanceList) get_instances(Thread *current_thread = Thread::get_current_thread()) const;
+
+protected:
+  virtual void compute_external_bounds(CPT(BoundingVolume) &external_bounds,
+                                       BoundingVolume::BoundsType btype,
+                                       const BoundingVolume **volumes,
+                                       size_t num_volumes,
+                                       int pipeline_stage,
+                                       Thread *current_thread) const;
+
+private:
+  CPT(InstanceList) cull_instances(const InstanceList *instances,
+                                   const GeometricBoundingVolume *view_frustum,
+                                   Thread *current_thread);
+
+private:
+  // This is the data that must be cycled between pipeline stages.
+  class EXPCL_PANDA_PGRAPH CData : public CycleData {
+  public:
+    INLINE CData();
+    INLINE CData(const CData &copy);
+    virtual CycleData *make_copy() const;
+    virtual void write_datagram(BamWriter *manager, Datagram &dg) const;
+    virtual int complete_pointers(TypedWritable **p_list, BamReader *manager);
+    virtual void fillin(DatagramIterator &scan, BamReader *manager);
+    virtual TypeHandle get_parent_type() const {
+      return InstancedNode::get_class_type();
+    }
+
+    CPT(InstanceList) _instances;
+
+    // Only used while reading a bam file.
+    size_t _num_bam_instances;
+  };
+
+  PipelineCycler<CData> _cycler;
+  typedef CycleDataReader<CData> CDReader;
+  typedef CycleDataWriter<CData> CDWriter;
+  typedef CycleDataStageReader<CData> CDStageReader;
+
+  static InstanceList *modify_instances(CData *cdata);
+
+  // The result of the most recent frustum test, which is reused for as long
+  // as the same instances remain visible, so that the instance array and the
+  // instanced Geoms need not be rebuilt every frame.
+  LightMutex _cull_lock;
+  CPT(InstanceList) _cull_source;
+  pvector<unsigned char> _cull_results;
+  CPT(InstanceList) _cull_instances;
+
+public:
+  static void register_with_read_factory();
+  virtual void write_datagram(BamWriter *manager, Datagram &dg);
+
+protected:
+  static TypedWritable *make_from_bam(const FactoryParams &params);
+  void fillin(DatagramIterator &scan, BamReader *manager);
+
+public:
+  static TypeHandle get_class_type() {
+    return _type_handle;
+  }
+  static void init_type() {
+    PandaNode::init_type();
+    register_type(_type_handle, "InstancedNode",
+                  PandaNode::get_class_type());
+  }
+  virtual TypeHandle get_type() const {
+    return get_class_type();
+  }
+  virtual TypeHandle force_init_type() {init_type(); return get_class_type();}
+
+private:
+  static TypeHandle _type_handle;
+};
+
+#include "instancedNode.I"
+
+#endif
@@ -5591,6 +5591,22 @@ apply_texture_colors() {
   gr.apply_attribs(node(), SceneGraphReducer::TT_apply_texture_color | SceneGraphReducer::TT_tex_matrix | SceneGraphReducer::TT_other);
 }
 
+/**
+ * Reduces the triangles of all of the Geoms at this node and below to about
+ * target_ratio times as many, using quadric error metric edge collapses, and
+ * removes the vertices that are no longer used.  This is primarily useful to
+ * make a low-LOD model from a high-LOD one; see also
+ * LODNode::add_simplified_levels().  Returns the number of Geoms affected.
+ */
+int NodePath::
+simplify(PN_stdfloat target_ratio) {
+  nassertr_always(!is_empty(), 0);
+  SceneGraphReducer gr;
+  int num_geoms = gr.simplify(node(), target_ratio);
+  gr.remove_unused_vertices(node());
+  return num_geoms;
+}
+
 /**
  * Returns the lowest ancestor of this node that contains a tag definition
  * with the indicated key, if any, or an empty NodePath if no ancestor of this
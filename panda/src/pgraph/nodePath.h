@@ -908,6 +908,7 @@ PUBLISHED:
   int flatten_medium();
   int flatten_strong();
   void apply_texture_colors();
+  int simplify(PN_stdfloat target_ratio);
   INLINE int clear_model_nodes();
 
   INLINE void set_tag(const std::string &key, const std::string &value);
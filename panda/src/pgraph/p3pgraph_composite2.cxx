@@ -1,10 +1,12 @@
 #include "cullBin.cxx"
 #include "cullBinAttrib.cxx"
+#include "cullBatchCache.cxx"
 #include "cullBinManager.cxx"
 #include "cullFaceAttrib.cxx"
 #include "cullHandler.cxx"
 #include "cullPlanes.cxx"
 #include "cullResult.cxx"
+#include "cullSnapshot.cxx"
 #include "cullTraverser.cxx"
 #include "cullTraverserData.cxx"
 #include "cullableObject.cxx"
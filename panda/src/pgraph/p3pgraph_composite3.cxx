@@ -1,3 +1,5 @@
+#include "instancedNode.cxx"
+#include "instanceList.cxx"
 #include "internalNameCollection.cxx"
 #include "lensNode.cxx"
 #include "light.cxx"
@@ -2315,6 +2315,39 @@ compute_internal_bounds(CPT(BoundingVolume) &internal_bounds,
   internal_vertices = 0;
 }
 
+/**
+ * Computes the external bounding volume of the node, which encloses the
+ * indicated volumes of its internal bounds and its children, transformed by
+ * the node's own transform.  The bounds type will be either BT_box or
+ * BT_sphere.  May be overridden by nodes that render their children in some
+ * other place than where they are, such as InstancedNode.
+ */
+void PandaNode::
+compute_external_bounds(CPT(BoundingVolume) &external_bounds,
+                        BoundingVolume::BoundsType btype,
+                        const BoundingVolume **volumes, size_t num_volumes,
+                        int pipeline_stage, Thread *current_thread) const {
+  PT(GeometricBoundingVolume) gbv;
+  if (btype == BoundingVolume::BT_box) {
+    gbv = new BoundingBox;
+  } else {
+    gbv = new BoundingSphere;
+  }
+
+  if (num_volumes > 0) {
+    ((BoundingVolume *)gbv)->around(volumes, volumes + num_volumes);
+
+    // If we have a transform, apply it to the bounding volume we just
+    // computed.
+    CPT(TransformState) transform = get_transform(current_thread);
+    if (!transform->is_identity()) {
+      gbv->xform(transform->get_mat());
+    }
+  }
+
+  external_bounds = gbv;
+}
+
 /**
  * Called after a scene graph update that either adds or remove parents from
  * this node, this just provides a hook for derived PandaNode objects that
@@ -3486,7 +3519,6 @@ update_cached(bool update_bounds, int pipeline_stage, PandaNode::CDLockedStageRe
           cdataw->_nested_vertices = num_vertices;
 
           CPT(TransformState) transform = get_transform(current_thread);
-          PT(GeometricBoundingVolume) gbv;
 
           BoundingVolume::BoundsType btype = cdataw->_bounds_type;
           if (btype == BoundingVolume::BT_default) {
@@ -3497,26 +3529,18 @@ update_cached(bool update_bounds, int pipeline_stage, PandaNode::CDLockedStageRe
               (btype != BoundingVolume::BT_sphere && all_box && transform->is_identity())) {
             // If all of the child volumes are a BoundingBox, and we have no
             // transform, then our volume is also a BoundingBox.
-
-            gbv = new BoundingBox;
+            btype = BoundingVolume::BT_box;
           } else {
             // Otherwise, it's a sphere.
-            gbv = new BoundingSphere;
+            btype = BoundingVolume::BT_sphere;
           }
 
-          if (child_volumes_i > 0) {
-            const BoundingVolume **child_begin = &child_volumes[0];
-            const BoundingVolume **child_end = child_begin + child_volumes_i;
-            ((BoundingVolume *)gbv)->around(child_begin, child_end);
-
-            // If we have a transform, apply it to the bounding volume we just
-            // computed.
-            if (!transform->is_identity()) {
-              gbv->xform(transform->get_mat());
-            }
-          }
+          CPT(BoundingVolume) external_bounds;
+          compute_external_bounds(external_bounds, btype,
+                                  &child_volumes[0], child_volumes_i,
+                                  pipeline_stage, current_thread);
 
-          cdataw->_external_bounds = gbv;
+          cdataw->_external_bounds = external_bounds;
           cdataw->_last_bounds_update = next_update;
         }
 
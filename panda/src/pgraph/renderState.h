@@ -210,6 +210,7 @@ private:
 
   void release_new();
   void remove_cache_pointers();
+  static void collect_states(pvector<const RenderState *> &states);
 
   void determine_bin_index();
   void determine_cull_callback();
@@ -232,12 +233,42 @@ public:
   mutable UpdateSeq _generated_shader_seq;
 
 private:
-  // This mutex protects _states.  It also protects any modification to the
-  // cache, which is encoded in _composition_cache and
-  // _invert_composition_cache.
+  // This mutex protects any modification to the cache, which is encoded in
+  // _composition_cache and _invert_composition_cache.  It must also be held
+  // by anyone walking through all of the shards of the state table below.
   static LightReMutex *_states_lock;
   typedef SimpleHashMap<const RenderState *, std::nullptr_t, indirect_compare_to_hash<const RenderState *> > States;
-  static States _states;
+
+  // The table of unique RenderStates is split by hash into several shards,
+  // each with its own lock, as in TransformState.  If both locks are needed,
+  // the _states_lock must be acquired before the shard's lock.
+  // A state's composition caches are only modified while holding both locks
+  // (that of the state's own shard), so they may be read holding either one.
+  enum { num_shards = 16 };
+  class StatesShard {
+  public:
+    LightReMutex _lock;
+    States _states;
+
+    // These are the states that were added since the last garbage
+    // collection cycle, which have not yet been examined by it.
+    pvector<RenderState *> _young_states;
+
+    // This keeps track of our current position through the garbage
+    // collection cycle.
+    size_t _garbage_index = 0;
+  };
+  static StatesShard *_shards;
+  static size_t _garbage_shard;
+  INLINE StatesShard &get_shard() const;
+
+  static int garbage_collect_young(StatesShard &shard, bool break_and_uniquify,
+                                   double stop_time, bool &out_of_time);
+  static int garbage_collect_old(StatesShard &shard, bool break_and_uniquify,
+                                 double stop_time, bool &out_of_time);
+  static bool collect_state(RenderState *state, bool break_and_uniquify);
+  static bool is_out_of_time(double stop_time, size_t num_visited);
+
   static const RenderState *_empty_state;
 
   // This iterator records the entry corresponding to this RenderState object
@@ -245,6 +276,10 @@ private:
   // when the RenderState destructs.
   int _saved_entry;
 
+  // This is true while the state is in the young generation of the above
+  // set, ie. it has been added since the last garbage collection cycle.
+  bool _young;
+
   // This data structure manages the job of caching the composition of two
   // RenderStates.  It's complicated because we have to be sure to remove the
   // entry if *either* of the input RenderStates destructs.  To implement
@@ -286,12 +321,10 @@ private:
   UpdateSeq _cycle_detect;
   static UpdateSeq _last_cycle_detect;
 
-  // This keeps track of our current position through the garbage collection
-  // cycle.
-  static size_t _garbage_index;
-
   static PStatCollector _cache_update_pcollector;
+  static PStatCollector _lock_wait_pcollector;
   static PStatCollector _garbage_collect_pcollector;
+  static PStatCollector _garbage_collect_young_pcollector;
   static PStatCollector _state_compose_pcollector;
   static PStatCollector _state_invert_pcollector;
   static PStatCollector _state_break_cycles_pcollector;
@@ -120,13 +120,15 @@ get_states() {
   extern struct Dtool_PyTypedObject Dtool_RenderState;
   LightReMutexHolder holder(*RenderState::_states_lock);
 
-  size_t num_states = RenderState::_states.get_num_entries();
+  pvector<const RenderState *> states;
+  RenderState::collect_states(states);
+
+  size_t num_states = states.size();
   PyObject *list = PyList_New(num_states);
   size_t i = 0;
 
-  size_t size = RenderState::_states.get_num_entries();
-  for (size_t si = 0; si < size; ++si) {
-    const RenderState *state = RenderState::_states.get_key(si);
+  for (size_t si = 0; si < num_states; ++si) {
+    const RenderState *state = states[si];
     state->ref();
     PyObject *a =
       DTool_CreatePyInstanceTyped((void *)state, Dtool_RenderState,
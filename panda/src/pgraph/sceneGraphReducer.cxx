@@ -20,6 +20,8 @@
 #include "plist.h"
 #include "pmap.h"
 #include "geomNode.h"
+#include "geomVertexReader.h"
+#include "geomVertexWriter.h"
 #include "config_gobj.h"
 #include "thread.h"
 
@@ -31,6 +33,9 @@ PStatCollector SceneGraphReducer::_collect_collector("*:Flatten:collect");
 PStatCollector SceneGraphReducer::_make_nonindexed_collector("*:Flatten:make nonindexed");
 PStatCollector SceneGraphReducer::_unify_collector("*:Flatten:unify");
 PStatCollector SceneGraphReducer::_remove_unused_collector("*:Flatten:remove unused vertices");
+PStatCollector SceneGraphReducer::_optimize_vertices_collector("*:Flatten:optimize vertices");
+PStatCollector SceneGraphReducer::_simplify_collector("*:Flatten:simplify");
+PStatCollector SceneGraphReducer::_compress_vertices_collector("*:Flatten:compress vertices");
 PStatCollector SceneGraphReducer::_premunge_collector("*:Premunge");
 
 /**
@@ -202,6 +207,65 @@ remove_unused_vertices(PandaNode *root) {
   Thread::consider_yield();
 }
 
+/**
+ * Reorders the triangles, and optionally the vertices, of every Geom at this
+ * level and below for more efficient rendering.  The optimize_bits are the
+ * union of OptimizeVertices bits that select which passes to apply; see
+ * GeomPrimitive::optimize_vertex_cache(),
+ * GeomPrimitive::optimize_overdraw() and
+ * Geom::optimize_vertex_fetch_in_place().  The vertex-cache-size and
+ * overdraw-threshold config variables control the first two passes.
+ *
+ * Triangle strips and fans are left alone; call decompose() first to
+ * optimize those too.  Returns the number of Geoms that were processed.
+ */
+int SceneGraphReducer::
+optimize_vertices(PandaNode *root, int optimize_bits) {
+  nassertr(check_live_flatten(root), 0);
+  PStatTimer timer(_optimize_vertices_collector);
+
+  int count = r_optimize_vertices(root, optimize_bits, _transformer);
+  if ((optimize_bits & OV_vertex_fetch) != 0) {
+    _transformer.finish_optimize_vertex_fetch();
+  }
+  Thread::consider_yield();
+  return count;
+}
+
+/**
+ * Reduces the triangles of every Geom at this level and below to about
+ * target_ratio times as many; see GeomPrimitive::simplify().  The vertices
+ * that are no longer referenced are left in place; call
+ * remove_unused_vertices() afterwards to remove them.  Returns the number of
+ * Geoms that were processed.
+ */
+int SceneGraphReducer::
+simplify(PandaNode *root, PN_stdfloat target_ratio) {
+  nassertr(check_live_flatten(root), 0);
+  PStatTimer timer(_simplify_collector);
+
+  return r_simplify(root, target_ratio);
+}
+
+/**
+ * Converts the vertex data at this level and below to smaller numeric types,
+ * as selected by compress_bits (see CompressVertices).  Animated vertex data,
+ * and columns that are not stored as floats, are left alone.
+ *
+ * Since the quantized positions only make sense together with the transform
+ * on the new GeomNode, this should be the last operation applied to the
+ * scene graph; flattening it afterwards would apply the transform to the
+ * 16-bit vertices and lose the precision.  Returns the number of
+ * GeomVertexDatas that were converted.
+ */
+int SceneGraphReducer::
+compress_vertices(PandaNode *root, int compress_bits) {
+  nassertr(check_live_flatten(root), 0);
+  PStatTimer timer(_compress_vertices_collector);
+
+  return r_compress_vertices(root, compress_bits);
+}
+
 /**
  * In a non-release build, returns false if the node is correctly not in a
  * live scene graph.  (Calling flatten on a node that is part of a live scene
@@ -948,6 +1012,287 @@ r_decompose(PandaNode *node) {
   }
 }
 
+/**
+ * The recursive implementation of optimize_vertices().
+ */
+int SceneGraphReducer::
+r_optimize_vertices(PandaNode *node, int optimize_bits,
+                    GeomTransformer &transformer) {
+  int count = 0;
+  if (node->is_geom_node()) {
+    GeomNode *geom_node = DCAST(GeomNode, node);
+    int num_geoms = geom_node->get_num_geoms();
+    for (int i = 0; i < num_geoms; ++i) {
+      PT(Geom) geom = geom_node->modify_geom(i);
+      if ((optimize_bits & OV_vertex_cache) != 0) {
+        geom->optimize_vertex_cache_in_place(vertex_cache_size);
+      }
+      if ((optimize_bits & OV_overdraw) != 0) {
+        geom->optimize_overdraw_in_place(overdraw_threshold, vertex_cache_size);
+      }
+      if ((optimize_bits & OV_vertex_fetch) != 0) {
+        transformer.register_vertices(geom, false);
+      }
+      ++count;
+    }
+  }
+
+  PandaNode::Children children = node->get_children();
+  int num_children = children.get_num_children();
+  for (int i = 0; i < num_children; ++i) {
+    count += r_optimize_vertices(children.get_child(i), optimize_bits,
+                                 transformer);
+  }
+  Thread::consider_yield();
+  return count;
+}
+
+/**
+ * The recursive implementation of simplify().
+ */
+int SceneGraphReducer::
+r_simplify(PandaNode *node, PN_stdfloat target_ratio) {
+  int count = 0;
+  if (node->is_geom_node()) {
+    GeomNode *geom_node = DCAST(GeomNode, node);
+    int num_geoms = geom_node->get_num_geoms();
+    for (int i = 0; i < num_geoms; ++i) {
+      geom_node->modify_geom(i)->simplify_in_place(target_ratio);
+      ++count;
+    }
+  }
+
+  PandaNode::Children children = node->get_children();
+  int num_children = children.get_num_children();
+  for (int i = 0; i < num_children; ++i) {
+    count += r_simplify(children.get_child(i), target_ratio);
+  }
+  Thread::consider_yield();
+  return count;
+}
+
+/**
+ * The recursive implementation of compress_vertices().
+ */
+int SceneGraphReducer::
+r_compress_vertices(PandaNode *node, int compress_bits) {
+  int count = 0;
+
+  // Visit the children first, since we may be adding a new child below.
+  PandaNode::Children children = node->get_children();
+  int num_children = children.get_num_children();
+  for (int i = 0; i < num_children; ++i) {
+    count += r_compress_vertices(children.get_child(i), compress_bits);
+  }
+
+  if (!node->is_geom_node()) {
+    Thread::consider_yield();
+    return count;
+  }
+  GeomNode *geom_node = DCAST(GeomNode, node);
+  int num_geoms = geom_node->get_num_geoms();
+
+  // Texture coordinates within this range have a precision of at least
+  // 1/1024 when stored as half floats.
+  static const PN_stdfloat max_half_texcoord = 2.0f;
+
+  // First, decide on the new format of each GeomVertexData, and find the
+  // bounding box of the positions we are going to quantize.
+  typedef pmap<CPT(GeomVertexData), CPT(GeomVertexFormat)> Formats;
+  Formats formats;
+  LPoint3 min_point, max_point;
+  bool any_positions = false;
+
+  for (int gi = 0; gi < num_geoms; ++gi) {
+    CPT(GeomVertexData) vdata = geom_node->get_geom(gi)->get_vertex_data();
+    if (formats.count(vdata) != 0) {
+      continue;
+    }
+    const GeomVertexFormat *format = vdata->get_format();
+    if (format->get_animation().get_animation_type() != GeomEnums::AT_none) {
+      formats[vdata] = format;
+      continue;
+    }
+
+    bool quantize_positions = false;
+    if ((compress_bits & CV_positions) != 0) {
+      const GeomVertexColumn *column = format->get_vertex_column();
+      if (column != nullptr && column->get_num_components() == 3 &&
+          (column->get_numeric_type() == GeomEnums::NT_float32 ||
+           column->get_numeric_type() == GeomEnums::NT_float64)) {
+        quantize_positions = true;
+      }
+    }
+
+    bool encode_normals = false;
+    if ((compress_bits & CV_normals) != 0) {
+      const GeomVertexColumn *column = format->get_normal_column();
+      if (column != nullptr && column->get_num_components() == 3 &&
+          (column->get_numeric_type() == GeomEnums::NT_float32 ||
+           column->get_numeric_type() == GeomEnums::NT_float64)) {
+        encode_normals = true;
+      }
+    }
+
+    PT(GeomVertexFormat) new_format = new GeomVertexFormat;
+    bool any_changed = false;
+    for (size_t ai = 0; ai < format->get_num_arrays(); ++ai) {
+      const GeomVertexArrayFormat *array_format = format->get_array(ai);
+      PT(GeomVertexArrayFormat) new_array_format = new GeomVertexArrayFormat;
+      new_array_format->set_divisor(array_format->get_divisor());
+
+      for (int ci = 0; ci < array_format->get_num_columns(); ++ci) {
+        const GeomVertexColumn *column = array_format->get_column(ci);
+        const InternalName *name = column->get_name();
+        int num_components = column->get_num_components();
+        GeomEnums::NumericType numeric_type = column->get_numeric_type();
+        GeomEnums::Contents contents = column->get_contents();
+        bool is_float = (numeric_type == GeomEnums::NT_float32 || numeric_type == GeomEnums::NT_float64);
+
+        if (quantize_positions && name == InternalName::get_vertex()) {
+          num_components = 3;
+          numeric_type = GeomEnums::NT_int16;
+
+        } else if (encode_normals && is_float && num_components == 3 &&
+                   (name == InternalName::get_normal() ||
+                    name->get_top() == InternalName::get_tangent() ||
+                    name->get_top() == InternalName::get_binormal())) {
+          num_components = 2;
+          numeric_type = GeomEnums::NT_int16;
+          contents = (contents == GeomEnums::C_normal)
+            ? GeomEnums::C_octahedral_normal : GeomEnums::C_octahedral_vector;
+
+        } else if ((compress_bits & CV_texcoords) != 0 && is_float &&
+                   column->get_contents() == GeomEnums::C_texcoord &&
+                   (num_components == 2 || num_components == 3)) {
+          // Only convert the texcoords if they all fit.
+          bool fits = true;
+          GeomVertexReader reader(vdata, name);
+          while (fits && !reader.is_at_end()) {
+            const LVecBase3 &uvw = reader.get_data3();
+            fits = (cabs(uvw[0]) <= max_half_texcoord &&
+                    cabs(uvw[1]) <= max_half_texcoord &&
+                    cabs(uvw[2]) <= max_half_texcoord);
+          }
+          if (fits) {
+            numeric_type = GeomEnums::NT_float16;
+          }
+        }
+
+        if (numeric_type != column->get_numeric_type()) {
+          any_changed = true;
+        }
+        new_array_format->add_column(name, num_components, numeric_type,
+                                     contents, -1,
+                                     column->get_column_alignment());
+      }
+      new_format->add_array(new_array_format);
+    }
+
+    if (!any_changed) {
+      formats[vdata] = format;
+      continue;
+    }
+    formats[vdata] = GeomVertexFormat::register_format(new_format);
+
+    if (quantize_positions) {
+      GeomVertexReader reader(vdata, InternalName::get_vertex());
+      while (!reader.is_at_end()) {
+        const LPoint3 &point = reader.get_data3();
+        if (!any_positions) {
+          min_point = point;
+          max_point = point;
+          any_positions = true;
+        } else {
+          min_point.set(std::min(min_point[0], point[0]),
+                        std::min(min_point[1], point[1]),
+                        std::min(min_point[2], point[2]));
+          max_point.set(std::max(max_point[0], point[0]),
+                        std::max(max_point[1], point[1]),
+                        std::max(max_point[2], point[2]));
+        }
+      }
+    }
+  }
+
+  // The positions are quantized uniformly (so that normals are not skewed)
+  // into the range -32767 .. 32767 about the center of the bounding box.
+  LPoint3 center(0, 0, 0);
+  PN_stdfloat scale = 1.0f;
+  if (any_positions) {
+    center = (min_point + max_point) * 0.5f;
+    LVector3 size = max_point - min_point;
+    PN_stdfloat extent = std::max(size[0], std::max(size[1], size[2]));
+    if (extent > 0.0f) {
+      scale = extent / 65534.0f;
+    }
+  }
+
+  // Now convert the data.
+  typedef pmap<CPT(GeomVertexData), CPT(GeomVertexData)> Converted;
+  Converted converted;
+  PT(GeomNode) quantized_node;
+  pvector<int> moved_geoms;
+
+  for (int gi = 0; gi < num_geoms; ++gi) {
+    CPT(Geom) geom = geom_node->get_geom(gi);
+    CPT(GeomVertexData) vdata = geom->get_vertex_data();
+    const GeomVertexFormat *new_format = formats[vdata];
+    if (new_format == vdata->get_format()) {
+      continue;
+    }
+
+    const GeomVertexColumn *column = new_format->get_vertex_column();
+    bool quantized = (column != nullptr && column->get_numeric_type() == GeomEnums::NT_int16 &&
+                      vdata->get_format()->get_vertex_column()->get_numeric_type() != GeomEnums::NT_int16);
+
+    Converted::iterator cvi = converted.find(vdata);
+    if (cvi == converted.end()) {
+      PT(GeomVertexData) new_vdata = new GeomVertexData(*vdata->convert_to(new_format));
+      if (quantized) {
+        GeomVertexReader reader(vdata, InternalName::get_vertex());
+        GeomVertexWriter writer(new_vdata, InternalName::get_vertex());
+        while (!reader.is_at_end()) {
+          LVecBase3 point = (reader.get_data3() - center) / scale;
+          writer.set_data3i((int)floor(point[0] + 0.5f),
+                            (int)floor(point[1] + 0.5f),
+                            (int)floor(point[2] + 0.5f));
+        }
+      }
+      cvi = converted.insert(Converted::value_type(vdata, new_vdata)).first;
+      ++count;
+    }
+
+    PT(Geom) new_geom = geom->make_copy();
+    new_geom->set_vertex_data((*cvi).second);
+
+    if (quantized) {
+      // This Geom now needs the dequantizing transform, so it moves to the
+      // new child node.
+      if (quantized_node == nullptr) {
+        quantized_node = new GeomNode(geom_node->get_name());
+        quantized_node->set_transform(TransformState::make_pos_hpr_scale
+          (center, LVecBase3(0, 0, 0), LVecBase3(scale, scale, scale)));
+      }
+      quantized_node->add_geom(new_geom, geom_node->get_geom_state(gi));
+      moved_geoms.push_back(gi);
+    } else {
+      geom_node->set_geom(gi, new_geom);
+    }
+  }
+
+  if (quantized_node != nullptr) {
+    pvector<int>::reverse_iterator mi;
+    for (mi = moved_geoms.rbegin(); mi != moved_geoms.rend(); ++mi) {
+      geom_node->remove_geom(*mi);
+    }
+    geom_node->add_child(quantized_node);
+  }
+
+  Thread::consider_yield();
+  return count;
+}
+
 /**
  * The recursive implementation of premunge().
  */
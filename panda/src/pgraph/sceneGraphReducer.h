@@ -113,6 +113,36 @@ PUBLISHED:
     MN_avoid_dynamic   = 0x004,
   };
 
+  enum OptimizeVertices {
+    // If set, the triangles are reordered to make the best use of the
+    // post-transform vertex cache.
+    OV_vertex_cache    = 0x001,
+
+    // If set, the triangles are then reordered in clusters to reduce
+    // overdraw, at a small cost in vertex cache efficiency.
+    OV_overdraw        = 0x002,
+
+    // If set, the rows of each GeomVertexData are reordered to follow the
+    // order in which the triangles use them, and unused rows are removed.
+    OV_vertex_fetch    = 0x004,
+  };
+
+  enum CompressVertices {
+    // If set, vertex positions are quantized to 16-bit integers, and the
+    // Geoms are moved to a new child GeomNode whose transform scales them
+    // back to the original size.
+    CV_positions       = 0x001,
+
+    // If set, normals, tangents and binormals are octahedrally encoded into
+    // two 16-bit integers each.  These are decoded by the shader generator;
+    // other shaders must decode them themselves.
+    CV_normals         = 0x002,
+
+    // If set, texture coordinates that stay close enough to the unit square
+    // are stored as half-precision floats.
+    CV_texcoords       = 0x004,
+  };
+
   void set_gsg(GraphicsStateGuardianBase *gsg);
   void clear_gsg();
   INLINE GraphicsStateGuardianBase *get_gsg() const;
@@ -137,6 +167,10 @@ PUBLISHED:
   INLINE int make_nonindexed(PandaNode *root, int nonindexed_bits = ~0);
   void unify(PandaNode *root, bool preserve_order);
   void remove_unused_vertices(PandaNode *root);
+  int optimize_vertices(PandaNode *root, int optimize_bits = ~0);
+  int simplify(PandaNode *root, PN_stdfloat target_ratio);
+  int compress_vertices(PandaNode *root,
+                        int compress_bits = CV_positions | CV_texcoords);
 
   INLINE void premunge(PandaNode *root, const RenderState *initial_state);
   bool check_live_flatten(PandaNode *node);
@@ -177,6 +211,10 @@ protected:
   void r_unify(PandaNode *node, int max_indices, bool preserve_order);
   void r_register_vertices(PandaNode *node, GeomTransformer &transformer);
   void r_decompose(PandaNode *node);
+  int r_optimize_vertices(PandaNode *node, int optimize_bits,
+                          GeomTransformer &transformer);
+  int r_simplify(PandaNode *node, PN_stdfloat target_ratio);
+  int r_compress_vertices(PandaNode *node, int compress_bits);
 
   void r_premunge(PandaNode *node, const RenderState *state);
 
@@ -193,6 +231,9 @@ private:
   static PStatCollector _make_nonindexed_collector;
   static PStatCollector _unify_collector;
   static PStatCollector _remove_unused_collector;
+  static PStatCollector _optimize_vertices_collector;
+  static PStatCollector _simplify_collector;
+  static PStatCollector _compress_vertices_collector;
   static PStatCollector _premunge_collector;
 };
 
@@ -0,0 +1,43 @@
+/**
+ * PANDA 3D SOFTWARE
+ * Copyright (c) Carnegie Mellon University.  All rights reserved.
+ *
+ * All use of this software is subject to the terms of the revised BSD
+ * license.  You should have received a copy of this license along
+ * with this source code in a file named "LICENSE."
+ *
+ * @file stateCacheLockHolder.h
+ * @author blablabla94
+ * @date 2026-10-16
+ */
+
+#ifndef STATECACHELOCKHOLDER_H
+#define STATECACHELOCKHOLDER_H
+
+#include "pandabase.h"
+#include "lightReMutex.h"
+#include "pStatCollector.h"
+
+/**
+ * Similar to LightReMutexHolder, but if the mutex is already held by another
+ * thread, the time spent waiting for it is recorded in the indicated
+ * PStatCollector.  This is used by TransformState and RenderState to measure
+ * contention on their state caches.
+ */
+class EXPCL_PANDA_PGRAPH StateCacheLockHolder {
+public:
+  INLINE StateCacheLockHolder(LightReMutex &mutex, PStatCollector &wait_pcollector);
+  StateCacheLockHolder(const StateCacheLockHolder &copy) = delete;
+  INLINE ~StateCacheLockHolder();
+
+  StateCacheLockHolder &operator = (const StateCacheLockHolder &copy) = delete;
+
+private:
+#if defined(HAVE_THREADS) || defined(DEBUG_THREADS)
+  LightReMutex *_mutex;
+#endif
+};
+
+#include "stateCacheLockHolder.I"
+
+#endif
@@ -22,20 +22,25 @@
 #include "config_pgraph.h"
 #include "lightReMutexHolder.h"
 #include "lightMutexHolder.h"
+#include "stateCacheLockHolder.h"
+#include "trueClock.h"
+#include "pset.h"
 #include "thread.h"
 
 using std::ostream;
 
 LightReMutex *TransformState::_states_lock = nullptr;
-TransformState::States TransformState::_states;
+TransformState::StatesShard *TransformState::_shards = nullptr;
+size_t TransformState::_garbage_shard = 0;
 CPT(TransformState) TransformState::_identity_state;
 CPT(TransformState) TransformState::_invalid_state;
 UpdateSeq TransformState::_last_cycle_detect;
-size_t TransformState::_garbage_index = 0;
 bool TransformState::_uniquify_matrix = true;
 
 PStatCollector TransformState::_cache_update_pcollector("*:State Cache:Update");
+PStatCollector TransformState::_lock_wait_pcollector("*:State Cache:Lock Wait");
 PStatCollector TransformState::_garbage_collect_pcollector("*:State Cache:Garbage Collect");
+PStatCollector TransformState::_garbage_collect_young_pcollector("*:State Cache:Garbage Collect:Young");
 PStatCollector TransformState::_transform_compose_pcollector("*:State Cache:Compose Transform");
 PStatCollector TransformState::_transform_invert_pcollector("*:State Cache:Invert Transform");
 PStatCollector TransformState::_transform_calc_pcollector("*:State Cache:Calc Components");
@@ -61,6 +66,7 @@ TransformState() : _lock("TransformState") {
     init_states();
   }
   _saved_entry = -1;
+  _young = false;
   _flags = F_is_identity | F_singular_known | F_is_2d;
   _inv_mat = nullptr;
   _cache_stats.add_num_states(1);
@@ -600,16 +606,20 @@ compose(const TransformState *other) const {
     return do_compose(other);
   }
 
-  LightReMutexHolder holder(*_states_lock);
-
-  // Is this composition already cached?
-  int index = _composition_cache.find(other);
-  if (index != -1) {
-    const Composition &comp = _composition_cache.get_data(index);
-    if (comp._result != nullptr) {
-      // Success!
-      _cache_stats.inc_hits();
-      return comp._result;
+  // Is this composition already cached?  Our cache may be read while holding
+  // only the lock on our own shard, so that threads composing unrelated
+  // states don't contend for _states_lock.
+  StatesShard &shard = get_shard();
+  {
+    StateCacheLockHolder shard_holder(shard._lock, _lock_wait_pcollector);
+    int index = _composition_cache.find(other);
+    if (index != -1) {
+      const Composition &comp = _composition_cache.get_data(index);
+      if (comp._result != nullptr) {
+        // Success!
+        _cache_stats.inc_hits();
+        return comp._result;
+      }
     }
   }
 
@@ -618,8 +628,20 @@ compose(const TransformState *other) const {
   // parallelization.
   CPT(TransformState) result = do_compose(other);
 
+  // Storing the result modifies the caches of both states, which requires
+  // _states_lock as well as the lock on the shard of each of them.
+  StateCacheLockHolder holder(*_states_lock, _lock_wait_pcollector);
+  LightReMutexHolder shard_holder(shard._lock);
+  LightReMutexHolder other_shard_holder(other->get_shard()._lock);
+
+  // Another thread may have stored the same composition in the meantime.
+  int index = _composition_cache.find(other);
   if (index != -1) {
     Composition &comp = _composition_cache.modify_data(index);
+    if (comp._result != nullptr) {
+      _cache_stats.inc_hits();
+      return comp._result;
+    }
     // Well, it wasn't cached already, but we already had an entry (probably
     // created for the reverse direction), so use the same entry to store
     // the new result.
@@ -707,15 +729,18 @@ invert_compose(const TransformState *other) const {
     return do_invert_compose(other);
   }
 
-  LightReMutexHolder holder(*_states_lock);
-
-  int index = _invert_composition_cache.find(other);
-  if (index != -1) {
-    const Composition &comp = _invert_composition_cache.get_data(index);
-    if (comp._result != nullptr) {
-      // Success!
-      _cache_stats.inc_hits();
-      return comp._result;
+  // See compose() for the locking rules.
+  StatesShard &shard = get_shard();
+  {
+    StateCacheLockHolder shard_holder(shard._lock, _lock_wait_pcollector);
+    int index = _invert_composition_cache.find(other);
+    if (index != -1) {
+      const Composition &comp = _invert_composition_cache.get_data(index);
+      if (comp._result != nullptr) {
+        // Success!
+        _cache_stats.inc_hits();
+        return comp._result;
+      }
     }
   }
 
@@ -724,9 +749,18 @@ invert_compose(const TransformState *other) const {
   // parallelization.
   CPT(TransformState) result = do_invert_compose(other);
 
+  StateCacheLockHolder holder(*_states_lock, _lock_wait_pcollector);
+  LightReMutexHolder shard_holder(shard._lock);
+  LightReMutexHolder other_shard_holder(other->get_shard()._lock);
+
   // Is this composition already cached?
+  int index = _invert_composition_cache.find(other);
   if (index != -1) {
     Composition &comp = _invert_composition_cache.modify_data(index);
+    if (comp._result != nullptr) {
+      _cache_stats.inc_hits();
+      return comp._result;
+    }
     // Well, it wasn't cached already, but we already had an entry (probably
     // created for the reverse direction), so use the same entry to store
     // the new result.
@@ -792,11 +826,16 @@ unref() const {
   // garbage collection in effect.  In this case we will pull the object out
   // of the cache when its reference count goes to 0.
 
-  // We always have to grab the lock, since we will definitely need to be
-  // holding it if we happen to drop the reference count to 0. Having to grab
-  // the lock at every call to unref() is a big limiting factor on
-  // parallelization.
-  LightReMutexHolder holder(*_states_lock);
+  // As long as more references remain than are held by the cache, the count
+  // can't reach zero and there is no cycle to break, so we don't need the
+  // lock.  This is the common case.
+  if (unref_if_above(get_cache_ref_count() + 1)) {
+    return true;
+  }
+
+  // Otherwise we have to grab the lock, since we will need to be holding it
+  // if we happen to drop the reference count to 0.
+  StateCacheLockHolder holder(*_states_lock, _lock_wait_pcollector);
 
   if (auto_break_cycles && uniquify_transforms) {
     if (get_cache_ref_count() > 0 &&
@@ -808,15 +847,28 @@ unref() const {
     }
   }
 
-  if (ReferenceCount::unref()) {
-    // The reference count is still nonzero.
-    return true;
-  }
+  if (_saved_entry == -1) {
+    if (ReferenceCount::unref()) {
+      // The reference count is still nonzero.
+      return true;
+    }
+
+  } else {
+    // We're in the global object pool.  We must hold the lock on our shard of
+    // it while we drop the reference count, so that no other thread can find
+    // us there and ref us after it reaches zero.
+    StatesShard &shard = get_shard();
+    LightReMutexHolder shard_holder(shard._lock);
+    if (ReferenceCount::unref()) {
+      // The reference count is still nonzero.
+      return true;
+    }
 
-  // The reference count has just reached zero.  Make sure the object is
-  // removed from the global object pool, before anyone else finds it and
-  // tries to ref it.
-  ((TransformState *)this)->release_new();
+    // The reference count has just reached zero.  Make sure the object is
+    // removed from the global object pool, before anyone else finds it and
+    // tries to ref it.
+    ((TransformState *)this)->release_new();
+  }
   ((TransformState *)this)->remove_cache_pointers();
 
   return false;
@@ -987,7 +1039,12 @@ write_composition_cache(ostream &out, int indent_level) const {
 int TransformState::
 get_num_states() {
   LightReMutexHolder holder(*_states_lock);
-  return _states.get_num_entries();
+  size_t num_states = 0;
+  for (size_t shi = 0; shi < num_shards; ++shi) {
+    LightReMutexHolder shard_holder(_shards[shi]._lock);
+    num_states += _shards[shi]._states.get_num_entries();
+  }
+  return (int)num_states;
 }
 
 /**
@@ -1013,33 +1070,37 @@ get_num_unused_states() {
   typedef pmap<const TransformState *, int> StateCount;
   StateCount state_count;
 
-  size_t size = _states.get_num_entries();
-  for (size_t si = 0; si < size; ++si) {
-    const TransformState *state = _states.get_key(si);
-
-    size_t i;
-    size_t cache_size = state->_composition_cache.get_num_entries();
-    for (i = 0; i < cache_size; ++i) {
-      const TransformState *result = state->_composition_cache.get_data(i)._result;
-      if (result != nullptr && result != state) {
-        // Here's a TransformState that's recorded in the cache.  Count it.
-        std::pair<StateCount::iterator, bool> ir =
-          state_count.insert(StateCount::value_type(result, 1));
-        if (!ir.second) {
-          // If the above insert operation fails, then it's already in the
-          // cache; increment its value.
-          (*(ir.first)).second++;
+  for (size_t shi = 0; shi < num_shards; ++shi) {
+    LightReMutexHolder shard_holder(_shards[shi]._lock);
+    const States &states = _shards[shi]._states;
+    size_t size = states.get_num_entries();
+    for (size_t si = 0; si < size; ++si) {
+      const TransformState *state = states.get_key(si);
+
+      size_t i;
+      size_t cache_size = state->_composition_cache.get_num_entries();
+      for (i = 0; i < cache_size; ++i) {
+        const TransformState *result = state->_composition_cache.get_data(i)._result;
+        if (result != nullptr && result != state) {
+          // Here's a TransformState that's recorded in the cache.  Count it.
+          std::pair<StateCount::iterator, bool> ir =
+            state_count.insert(StateCount::value_type(result, 1));
+          if (!ir.second) {
+            // If the above insert operation fails, then it's already in the
+            // cache; increment its value.
+            (*(ir.first)).second++;
+          }
         }
       }
-    }
-    cache_size = state->_invert_composition_cache.get_num_entries();
-    for (i = 0; i < cache_size; ++i) {
-      const TransformState *result = state->_invert_composition_cache.get_data(i)._result;
-      if (result != nullptr && result != state) {
-        std::pair<StateCount::iterator, bool> ir =
-          state_count.insert(StateCount::value_type(result, 1));
-        if (!ir.second) {
-          (*(ir.first)).second++;
+      cache_size = state->_invert_composition_cache.get_num_entries();
+      for (i = 0; i < cache_size; ++i) {
+        const TransformState *result = state->_invert_composition_cache.get_data(i)._result;
+        if (result != nullptr && result != state) {
+          std::pair<StateCount::iterator, bool> ir =
+            state_count.insert(StateCount::value_type(result, 1));
+          if (!ir.second) {
+            (*(ir.first)).second++;
+          }
         }
       }
     }
@@ -1090,7 +1151,7 @@ clear_cache() {
   LightReMutexHolder holder(*_states_lock);
 
   PStatTimer timer(_cache_update_pcollector);
-  int orig_size = _states.get_num_entries();
+  int orig_size = get_num_states();
 
   // First, we need to copy the entire set of states to a temporary vector,
   // reference-counting each object.  That way we can walk through the copy,
@@ -1101,10 +1162,14 @@ clear_cache() {
     TempStates temp_states;
     temp_states.reserve(orig_size);
 
-    size_t size = _states.get_num_entries();
-    for (size_t si = 0; si < size; ++si) {
-      const TransformState *state = _states.get_key(si);
-      temp_states.push_back(state);
+    for (size_t shi = 0; shi < num_shards; ++shi) {
+      LightReMutexHolder shard_holder(_shards[shi]._lock);
+      const States &states = _shards[shi]._states;
+      size_t size = states.get_num_entries();
+      for (size_t si = 0; si < size; ++si) {
+        const TransformState *state = states.get_key(si);
+        temp_states.push_back(state);
+      }
     }
 
     // Now it's safe to walk through the list, destroying the cache within
@@ -1112,6 +1177,7 @@ clear_cache() {
     TempStates::iterator ti;
     for (ti = temp_states.begin(); ti != temp_states.end(); ++ti) {
       TransformState *state = (TransformState *)(*ti).p();
+      LightReMutexHolder shard_holder(state->get_shard()._lock);
 
       size_t i;
       size_t cache_size = state->_composition_cache.get_num_entries();
@@ -1142,7 +1208,7 @@ clear_cache() {
     // the various objects' caches will go away.
   }
 
-  int new_size = _states.get_num_entries();
+  int new_size = get_num_states();
   return orig_size - new_size;
 }
 
@@ -1151,6 +1217,13 @@ clear_cache() {
  * garbage-collect-states is true to ensure that TransformStates get cleaned
  * up appropriately.  It does no harm to call it even if this variable is not
  * true, but there is probably no advantage in that case.
+ *
+ * The states created since the last cycle are examined first, since most
+ * states are short-lived; those that are still in use are then considered
+ * long-lived, and are only revisited as part of the slower walk through the
+ * whole table, which is limited by garbage-collect-states-rate.  If
+ * garbage-collect-states-budget is set, the cycle stops when it runs out of
+ * time, and the next one resumes where it left off.
  */
 int TransformState::
 garbage_collect() {
@@ -1161,7 +1234,88 @@ garbage_collect() {
   LightReMutexHolder holder(*_states_lock);
 
   PStatTimer timer(_garbage_collect_pcollector);
-  size_t orig_size = _states.get_num_entries();
+
+  bool break_and_uniquify = (auto_break_cycles && uniquify_transforms);
+
+  double stop_time = 0.0;
+  if (garbage_collect_states_budget > 0.0) {
+    stop_time = TrueClock::get_global_ptr()->get_short_time() +
+      garbage_collect_states_budget;
+  }
+
+  int num_collected = 0;
+  bool out_of_time = false;
+
+  // First, the young generation.
+  {
+    PStatTimer timer2(_garbage_collect_young_pcollector);
+    for (size_t shi = 0; shi < num_shards && !out_of_time; ++shi) {
+      num_collected += garbage_collect_young(_shards[shi], break_and_uniquify,
+                                             stop_time, out_of_time);
+    }
+  }
+
+  // Then, as much of the old generation as we have time for, starting with
+  // the shard we got to last time.
+  size_t shi = _garbage_shard;
+  for (size_t i = 0; i < num_shards && !out_of_time; ++i) {
+    num_collected += garbage_collect_old(_shards[shi], break_and_uniquify,
+                                         stop_time, out_of_time);
+    if (!out_of_time) {
+      shi = (shi + 1) % num_shards;
+    }
+  }
+  _garbage_shard = shi;
+
+  return num_collected;
+}
+
+/**
+ * Collects the states in the indicated shard that have been added to the
+ * table since the last garbage collection cycle.  Those that are not
+ * collected are promoted to the old generation.  Returns the number of states
+ * collected.
+ *
+ * You must already be holding _states_lock before you call this method.
+ */
+int TransformState::
+garbage_collect_young(StatesShard &shard, bool break_and_uniquify,
+                      double stop_time, bool &out_of_time) {
+  LightReMutexHolder shard_holder(shard._lock);
+
+  int num_collected = 0;
+  size_t num_visited = 0;
+  while (!shard._young_states.empty()) {
+    TransformState *state = shard._young_states.back();
+    shard._young_states.pop_back();
+    state->_young = false;
+
+    if (collect_state(state, break_and_uniquify)) {
+      ++num_collected;
+    }
+
+    if (is_out_of_time(stop_time, ++num_visited)) {
+      out_of_time = true;
+      break;
+    }
+  }
+
+  return num_collected;
+}
+
+/**
+ * Walks through the next portion of the indicated shard of the table,
+ * collecting any of the long-lived states that are no longer in use.  Returns
+ * the number of states collected.
+ *
+ * You must already be holding _states_lock before you call this method.
+ */
+int TransformState::
+garbage_collect_old(StatesShard &shard, bool break_and_uniquify,
+                    double stop_time, bool &out_of_time) {
+  LightReMutexHolder shard_holder(shard._lock);
+  States &states = shard._states;
+  size_t orig_size = states.get_num_entries();
 
   // How many elements to process this pass?
   size_t size = orig_size;
@@ -1170,9 +1324,7 @@ garbage_collect() {
     return 0;
   }
 
-  bool break_and_uniquify = (auto_break_cycles && uniquify_transforms);
-
-  size_t si = _garbage_index;
+  size_t si = shard._garbage_index;
   if (si >= size) {
     si = 0;
   }
@@ -1180,31 +1332,12 @@ garbage_collect() {
   num_this_pass = std::min(num_this_pass, size);
   size_t stop_at_element = (si + num_this_pass) % size;
 
+  size_t num_visited = 0;
   do {
-    TransformState *state = (TransformState *)_states.get_key(si);
-    if (break_and_uniquify) {
-      if (state->get_cache_ref_count() > 0 &&
-          state->get_ref_count() == state->get_cache_ref_count()) {
-        // If we have removed all the references to this state not in the
-        // cache, leaving only references in the cache, then we need to
-        // check for a cycle involving this TransformState and break it if
-        // it exists.
-        state->detect_and_break_cycles();
-      }
-    }
-
-    if (!state->unref_if_one()) {
-      // This state has recently been unreffed to 1 (the one we added when
-      // we stored it in the cache).  Now it's time to delete it.  This is
-      // safe, because we're holding the _states_lock, so it's not possible
-      // for some other thread to find the state in the cache and ref it
-      // while we're doing this.  Also, we've just made sure to unref it to 0,
-      // to ensure that another thread can't get it via a weak pointer.
-      state->release_new();
-      state->remove_cache_pointers();
-      state->cache_unref_only();
-      delete state;
+    TransformState *state = (TransformState *)states.get_key(si);
 
+    // The young states are left for garbage_collect_young().
+    if (!state->_young && collect_state(state, break_and_uniquify)) {
       // When we removed it from the hash map, it swapped the last element
       // with the one we just removed.  So the current index contains one we
       // still need to visit.
@@ -1213,25 +1346,85 @@ garbage_collect() {
       if (stop_at_element > 0) {
         --stop_at_element;
       }
+      if (size == 0) {
+        // Unlike the table as a whole, a shard may become empty.
+        break;
+      }
     }
 
     si = (si + 1) % size;
+
+    if (is_out_of_time(stop_time, ++num_visited)) {
+      out_of_time = true;
+      break;
+    }
   } while (si != stop_at_element);
-  _garbage_index = si;
+  shard._garbage_index = si;
 
-  nassertr(_states.get_num_entries() == size, 0);
+  nassertr(states.get_num_entries() == size, 0);
 
 #ifdef _DEBUG
-  nassertr(_states.validate(), 0);
+  nassertr(states.validate(), 0);
 #endif
 
   // If we just cleaned up a lot of states, see if we can reduce the table in
   // size.  This will help reduce iteration overhead in the future.
-  _states.consider_shrink_table();
+  states.consider_shrink_table();
 
   return (int)orig_size - (int)size;
 }
 
+/**
+ * Deletes the indicated state if its only remaining reference is the one
+ * held by the table.  Returns true if it was deleted, false if it is still in
+ * use.
+ *
+ * You must already be holding _states_lock and the lock on the state's shard
+ * before you call this method.
+ */
+bool TransformState::
+collect_state(TransformState *state, bool break_and_uniquify) {
+  if (break_and_uniquify) {
+    if (state->get_cache_ref_count() > 0 &&
+        state->get_ref_count() == state->get_cache_ref_count()) {
+      // If we have removed all the references to this state not in the
+      // cache, leaving only references in the cache, then we need to check
+      // for a cycle involving this TransformState and break it if it exists.
+      state->detect_and_break_cycles();
+    }
+  }
+
+  if (state->unref_if_one()) {
+    return false;
+  }
+
+  // This state has recently been unreffed to 1 (the one we added when we
+  // stored it in the cache).  Now it's time to delete it.  This is safe,
+  // because we're holding the lock on its shard, so it's not possible for
+  // some other thread to find the state in the cache and ref it while we're
+  // doing this.  Also, we've just made sure to unref it to 0, to ensure that
+  // another thread can't get it via a weak pointer.
+  state->release_new();
+  state->remove_cache_pointers();
+  state->cache_unref_only();
+  delete state;
+  return true;
+}
+
+/**
+ * Returns true if the garbage collection cycle has run past the indicated
+ * stop time, or false if it may continue.  A stop time of 0 means there is no
+ * time limit.  The clock is only consulted every few states, to keep the
+ * overhead of this check low.
+ */
+bool TransformState::
+is_out_of_time(double stop_time, size_t num_visited) {
+  if (stop_time <= 0.0 || (num_visited & 0xf) != 0) {
+    return false;
+  }
+  return TrueClock::get_global_ptr()->get_short_time() >= stop_time;
+}
+
 /**
  * Detects all of the reference-count cycles in the cache and reports them to
  * standard output.
@@ -1253,9 +1446,12 @@ list_cycles(ostream &out) {
   VisitedStates visited;
   CompositionCycleDesc cycle_desc;
 
-  size_t size = _states.get_num_entries();
+  pvector<const TransformState *> states;
+  collect_states(states);
+
+  size_t size = states.size();
   for (size_t si = 0; si < size; ++si) {
-    const TransformState *state = _states.get_key(si);
+    const TransformState *state = states[si];
 
     bool inserted = visited.insert(state).second;
     if (inserted) {
@@ -1323,10 +1519,13 @@ void TransformState::
 list_states(ostream &out) {
   LightReMutexHolder holder(*_states_lock);
 
-  size_t size = _states.get_num_entries();
+  pvector<const TransformState *> states;
+  collect_states(states);
+
+  size_t size = states.size();
   out << size << " states:\n";
   for (size_t si = 0; si < size; ++si) {
-    const TransformState *state = _states.get_key(si);
+    const TransformState *state = states[si];
     state->write(out, 2);
   }
 }
@@ -1342,29 +1541,60 @@ validate_states() {
   PStatTimer timer(_transform_validate_pcollector);
 
   LightReMutexHolder holder(*_states_lock);
-  if (_states.is_empty()) {
-    return true;
+
+  for (size_t shi = 0; shi < num_shards; ++shi) {
+    StatesShard &shard = _shards[shi];
+    LightReMutexHolder shard_holder(shard._lock);
+    if (!shard._states.validate()) {
+      pgraph_cat.error()
+        << "TransformState::_states cache is invalid!\n";
+      return false;
+    }
+
+    // The young generation must list exactly the states in the shard that
+    // are marked young.  The list is checked by pointer only, since a stale
+    // entry would point to a deleted state.
+    pset<const TransformState *> young;
+    size_t size = shard._states.get_num_entries();
+    for (size_t si = 0; si < size; ++si) {
+      const TransformState *state = shard._states.get_key(si);
+      if (state->_young) {
+        young.insert(state);
+      }
+    }
+    if (young.size() != shard._young_states.size()) {
+      pgraph_cat.error()
+        << "TransformState young generation is invalid!\n";
+      return false;
+    }
+    for (const TransformState *state : shard._young_states) {
+      if (young.find(state) == young.end()) {
+        pgraph_cat.error()
+          << "TransformState young generation is invalid!\n";
+        return false;
+      }
+    }
   }
 
-  if (!_states.validate()) {
-    pgraph_cat.error()
-      << "TransformState::_states cache is invalid!\n";
-    return false;
+  pvector<const TransformState *> states;
+  collect_states(states);
+  if (states.empty()) {
+    return true;
   }
 
-  size_t size = _states.get_num_entries();
+  size_t size = states.size();
   size_t si = 0;
   nassertr(si < size, false);
-  nassertr(_states.get_key(si)->get_ref_count() >= 0, false);
+  nassertr(states[si]->get_ref_count() >= 0, false);
   size_t snext = si;
   ++snext;
   while (snext < size) {
-    nassertr(_states.get_key(snext)->get_ref_count() >= 0, false);
-    const TransformState *ssi = _states.get_key(si);
+    nassertr(states[snext]->get_ref_count() >= 0, false);
+    const TransformState *ssi = states[si];
     if (!ssi->validate_composition_cache()) {
       return false;
     }
-    const TransformState *ssnext = _states.get_key(snext);
+    const TransformState *ssnext = states[snext];
     bool c = (*ssi) == (*ssnext);
     bool ci = (*ssnext) == (*ssi);
     if (c != ci) {
@@ -1386,7 +1616,28 @@ validate_states() {
 }
 
 /**
- * Make sure the global _states map is allocated.  This only has to be done
+ * Fills the indicated vector with all of the TransformStates currently in the
+ * state table, from all of its shards.
+ *
+ * You must already be holding _states_lock before you call this method, which
+ * ensures that none of the returned states will be deleted while you hold it.
+ */
+void TransformState::
+collect_states(pvector<const TransformState *> &states) {
+  nassertv(_states_lock->debug_is_locked());
+
+  for (size_t shi = 0; shi < num_shards; ++shi) {
+    LightReMutexHolder shard_holder(_shards[shi]._lock);
+    const States &shard_states = _shards[shi]._states;
+    size_t size = shard_states.get_num_entries();
+    for (size_t si = 0; si < size; ++si) {
+      states.push_back(shard_states.get_key(si));
+    }
+  }
+}
+
+/**
+ * Make sure the global _shards table is allocated.  This only has to be done
  * once.  We could make this map static, but then we run into problems if
  * anyone creates a TransformState object at static init time; it also seems
  * to cause problems when the Panda shared library is unloaded at application
@@ -1411,6 +1662,7 @@ init_states() {
   // OK because we guarantee that this method is called at static init time,
   // presumably when there is still only one thread in the world.
   _states_lock = new LightReMutex("TransformState::_states_lock");
+  _shards = new StatesShard[num_shards];
   _cache_stats.init();
   nassertv(Thread::get_current_thread() == Thread::get_main_thread());
 }
@@ -1457,32 +1709,39 @@ return_unique(TransformState *state) {
 
   PStatTimer timer(_transform_new_pcollector);
 
-  LightReMutexHolder holder(*_states_lock);
+  // Save the state in a local PointerTo so that it will be freed at the end
+  // of this function if no one else uses it.  This is declared before the
+  // lock is grabbed so that it is released after the lock is, since
+  // releasing it may require grabbing _states_lock.
+  CPT(TransformState) pt_state = state;
+
+  // We only need to hold the lock on the shard of the table that this state
+  // belongs in; the rest of the table is not touched.
+  StatesShard &shard = state->get_shard();
+  StateCacheLockHolder holder(shard._lock, _lock_wait_pcollector);
 
   if (state->_saved_entry != -1) {
     // This state is already in the cache.  nassertr(_states.find(state) ==
     // state->_saved_entry, state);
-    return state;
+    return pt_state;
   }
 
-  // Save the state in a local PointerTo so that it will be freed at the end
-  // of this function if no one else uses it.
-  CPT(TransformState) pt_state = state;
-
-  int si = _states.find(state);
+  int si = shard._states.find(state);
   if (si != -1) {
     // There's an equivalent state already in the set.  Return it.
-    return _states.get_key(si);
+    return shard._states.get_key(si);
   }
 
   // Not already in the set; add it.
   if (garbage_collect_states) {
     // If we'll be garbage collecting states explicitly, we'll increment the
     // reference count when we store it in the cache, so that it won't be
-    // deleted while it's in it.
+    // deleted while it's in it.  It starts out in the young generation.
     state->cache_ref();
+    state->_young = true;
+    shard._young_states.push_back(state);
   }
-  si = _states.store(state, nullptr);
+  si = shard._states.store(state, nullptr);
 
   // Save the index and return the input state.
   state->_saved_entry = si;
@@ -1869,8 +2128,22 @@ release_new() {
   nassertv(_states_lock->debug_is_locked());
 
   if (_saved_entry != -1) {
+    StatesShard &shard = get_shard();
+    LightReMutexHolder shard_holder(shard._lock);
     _saved_entry = -1;
-    nassertv_always(_states.remove(this));
+    nassertv_always(shard._states.remove(this));
+
+    if (_young) {
+      // This state is still waiting in the young generation; this can only
+      // happen if garbage-collect-states has been turned off since it was
+      // added.
+      _young = false;
+      pvector<TransformState *>::iterator yi =
+        std::find(shard._young_states.begin(), shard._young_states.end(), this);
+      nassertv(yi != shard._young_states.end());
+      (*yi) = shard._young_states.back();
+      shard._young_states.pop_back();
+    }
   }
 }
 
@@ -1907,6 +2180,12 @@ remove_cache_pointers() {
   PStatTimer timer(_cache_update_pcollector);
 #endif  // DO_PSTATS
 
+  // Our caches may be read by other threads while holding only the lock on
+  // our shard, so we must hold it while we modify them, and likewise for the
+  // other states' caches.  Since we hold _states_lock, we may safely take
+  // the shard locks in any order.
+  LightReMutexHolder shard_holder(get_shard()._lock);
+
   // There are lots of ways to do this loop wrong.  Be very careful if you
   // need to modify it for any reason.
   size_t i = 0;
@@ -1932,6 +2211,7 @@ remove_cache_pointers() {
     _cache_stats.inc_dels();
 
     if (other != this) {
+      LightReMutexHolder other_shard_holder(other->get_shard()._lock);
       int oi = other->_composition_cache.find(this);
 
       // We may or may not still be listed in the other's cache (it might be
@@ -1970,6 +2250,7 @@ remove_cache_pointers() {
     _cache_stats.add_total_size(-1);
     _cache_stats.inc_dels();
     if (other != this) {
+      LightReMutexHolder other_shard_holder(other->get_shard()._lock);
       int oi = other->_invert_composition_cache.find(this);
       if (oi != -1) {
         Composition ocomp = other->_invert_composition_cache.get_data(oi);
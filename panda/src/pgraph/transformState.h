@@ -251,14 +251,46 @@ private:
 
   void release_new();
   void remove_cache_pointers();
+  static void collect_states(pvector<const TransformState *> &states);
 
 private:
-  // This mutex protects _states.  It also protects any modification to the
-  // cache, which is encoded in _composition_cache and
-  // _invert_composition_cache.
+  // This mutex protects any modification to the cache, which is encoded in
+  // _composition_cache and _invert_composition_cache.  It must also be held
+  // by anyone walking through all of the shards of the state table below.
   static LightReMutex *_states_lock;
   typedef SimpleHashMap<const TransformState *, std::nullptr_t, indirect_equals_hash<const TransformState *> > States;
-  static States _states;
+
+  // The table of unique TransformStates is split by hash into several
+  // shards, each with its own lock, so that threads creating new states do
+  // not all contend for _states_lock.  If both locks are needed, the
+  // _states_lock must be acquired before the shard's lock.
+  // A state's composition caches are only modified while holding both locks
+  // (that of the state's own shard), so they may be read holding either one.
+  enum { num_shards = 16 };
+  class StatesShard {
+  public:
+    LightReMutex _lock;
+    States _states;
+
+    // These are the states that were added since the last garbage
+    // collection cycle, which have not yet been examined by it.
+    pvector<TransformState *> _young_states;
+
+    // This keeps track of our current position through the garbage
+    // collection cycle.
+    size_t _garbage_index = 0;
+  };
+  static StatesShard *_shards;
+  static size_t _garbage_shard;
+  INLINE StatesShard &get_shard() const;
+
+  static int garbage_collect_young(StatesShard &shard, bool break_and_uniquify,
+                                   double stop_time, bool &out_of_time);
+  static int garbage_collect_old(StatesShard &shard, bool break_and_uniquify,
+                                 double stop_time, bool &out_of_time);
+  static bool collect_state(TransformState *state, bool break_and_uniquify);
+  static bool is_out_of_time(double stop_time, size_t num_visited);
+
   static CPT(TransformState) _identity_state;
   static CPT(TransformState) _invalid_state;
 
@@ -267,6 +299,10 @@ private:
   // remove it when the TransformState destructs.
   int _saved_entry;
 
+  // This is true while the state is in the young generation of the above
+  // set, ie. it has been added since the last garbage collection cycle.
+  bool _young;
+
   // This data structure manages the job of caching the composition of two
   // TransformStates.  It's complicated because we have to be sure to remove
   // the entry if *either* of the input TransformStates destructs.  To
@@ -295,14 +331,12 @@ private:
   UpdateSeq _cycle_detect;
   static UpdateSeq _last_cycle_detect;
 
-  // This keeps track of our current position through the garbage collection
-  // cycle.
-  static size_t _garbage_index;
-
   static bool _uniquify_matrix;
 
   static PStatCollector _cache_update_pcollector;
+  static PStatCollector _lock_wait_pcollector;
   static PStatCollector _garbage_collect_pcollector;
+  static PStatCollector _garbage_collect_young_pcollector;
   static PStatCollector _transform_compose_pcollector;
   static PStatCollector _transform_invert_pcollector;
   static PStatCollector _transform_calc_pcollector;
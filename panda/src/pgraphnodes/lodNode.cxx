@@ -34,6 +34,7 @@
 #include "geometricBoundingVolume.h"
 #include "look_at.h"
 #include "nodePath.h"
+#include "sceneGraphReducer.h"
 #include "shaderAttrib.h"
 #include "colorAttrib.h"
 #include "clipPlaneAttrib.h"
@@ -302,6 +303,59 @@ verify_child_bounds() const {
   return okflag;
 }
 
+/**
+ * Adds num_levels copies of the source subgraph as new children of this node,
+ * with each successive level simplified to about ratio times the triangles of
+ * the level before, and adds a switch for each.  The first level is an
+ * unmodified copy of the source.  The source itself is not changed.
+ *
+ * The first level is shown from the center out to the indicated distance, and
+ * each further level out to twice the distance of the previous one.  If the
+ * distance is 0, it defaults to four times the radius of the source's bounding
+ * volume, and the center of this node is set to the center of the source.
+ *
+ * See NodePath::simplify() for the simplification applied to each level.
+ */
+void LODNode::
+add_simplified_levels(PandaNode *source, int num_levels, PN_stdfloat ratio,
+                      PN_stdfloat distance) {
+  nassertv(source != nullptr && num_levels > 0);
+  nassertv(ratio > 0.0f && ratio <= 1.0f);
+
+  if (distance <= 0.0f) {
+    CPT(BoundingVolume) bounds = source->get_bounds();
+    const GeometricBoundingVolume *gbv = bounds->as_geometric_bounding_volume();
+    PT(BoundingSphere) sphere = new BoundingSphere;
+    if (gbv == nullptr || !sphere->extend_by(gbv) ||
+        sphere->is_empty() || sphere->is_infinite()) {
+      pgraph_cat.warning()
+        << "Cannot compute LOD distances for " << *source
+        << " without a bounding volume.\n";
+      return;
+    }
+    set_center(sphere->get_center());
+    distance = std::max(sphere->get_radius() * 4.0f, (PN_stdfloat)0.001f);
+  }
+
+  PN_stdfloat target_ratio = 1.0f;
+  PN_stdfloat out = 0.0f;
+  PN_stdfloat in = distance;
+  for (int level = 0; level < num_levels; ++level) {
+    PT(PandaNode) copy = source->copy_subgraph();
+    if (level > 0) {
+      target_ratio *= ratio;
+      SceneGraphReducer gr;
+      gr.simplify(copy, target_ratio);
+      gr.remove_unused_vertices(copy);
+    }
+
+    add_child(copy);
+    add_switch(in, out);
+    out = in;
+    in *= 2.0f;
+  }
+}
+
 /**
  * Determines which child should be visible according to the current camera
  * position.  If a child is visible, returns its index number; otherwise,
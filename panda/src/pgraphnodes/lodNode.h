@@ -91,6 +91,10 @@ PUBLISHED:
 
   bool verify_child_bounds() const;
 
+  void add_simplified_levels(PandaNode *source, int num_levels,
+                             PN_stdfloat ratio = 0.5f,
+                             PN_stdfloat distance = 0.0f);
+
 protected:
   int compute_child(CullTraverser *trav, CullTraverserData &data);
 
@@ -209,6 +209,9 @@ analyze_renderstate(ShaderKey &key, const RenderState *rs) {
   rs->get_attrib_def(shader_attrib);
   nassertv(shader_attrib->auto_shader());
 
+  key._octahedral_normals =
+    shader_attrib->get_flag(ShaderAttrib::F_octahedral_normals);
+
   // verify_enforce_attrib_lock();
   const AuxBitplaneAttrib *aux_bitplane;
   rs->get_attrib_def(aux_bitplane);
@@ -582,10 +585,9 @@ rehash_generated_shaders() {
 
   // With uniquify-states turned on, we can actually go through all the states
   // and check whether their generated shader is still OK.
-  size_t size = RenderState::_states.get_num_entries();
-  for (size_t si = 0; si < size; ++si) {
-    const RenderState *state = RenderState::_states.get_key(si);
-
+  pvector<const RenderState *> states;
+  RenderState::collect_states(states);
+  for (const RenderState *state : states) {
     if (state->_generated_shader != nullptr) {
       ShaderKey key;
       analyze_renderstate(key, state);
@@ -623,9 +625,9 @@ void ShaderGenerator::
 clear_generated_shaders() {
   LightReMutexHolder holder(*RenderState::_states_lock);
 
-  size_t size = RenderState::_states.get_num_entries();
-  for (size_t si = 0; si < size; ++si) {
-    const RenderState *state = RenderState::_states.get_key(si);
+  pvector<const RenderState *> states;
+  RenderState::collect_states(states);
+  for (const RenderState *state : states) {
     state->_generated_shader.clear();
   }
 
@@ -777,6 +779,24 @@ synthesize_shader(const RenderState *rs, const GeomVertexAnimationSpec &anim) {
     }
   }
 
+  // Normals, tangents and binormals may be octahedrally encoded into two
+  // signed shorts each; if so, they are decoded into these variables.
+  string normal_var = "vtx_normal";
+  string tangent_var;
+  string binormal_var;
+  const char *vector_type = "float4";
+  if (key._octahedral_normals) {
+    vector_type = "float2";
+    normal_var = "normal";
+    text << "float3 decode_octahedral(float2 packed) {\n";
+    text << "\t float2 e = max(packed / 32767.0, -1.0);\n";
+    text << "\t float3 n = float3(e, 1.0 - abs(e.x) - abs(e.y));\n";
+    text << "\t float t = saturate(-n.z);\n";
+    text << "\t n.xy += (n.xy >= 0.0) ? -t : t;\n";
+    text << "\t return normalize(n);\n";
+    text << "}\n\n";
+  }
+
   text << "void vshader(\n";
   for (size_t i = 0; i < key._textures.size(); ++i) {
     const ShaderKey::TextureInfo &tex = key._textures[i];
@@ -822,9 +842,16 @@ synthesize_shader(const RenderState *rs, const GeomVertexAnimationSpec &anim) {
 
       tangent_input = tangent_name->join("_");
       binormal_input = binormal_name->join("_");
+      if (key._octahedral_normals) {
+        tangent_var = tangent_input;
+        binormal_var = binormal_input;
+      } else {
+        tangent_var = "vtx_" + tangent_input + ".xyz";
+        binormal_var = "vtx_" + binormal_input + ".xyz";
+      }
 
-      text << "\t in float4 vtx_" << tangent_input << " : " << alloc_vreg() << ",\n";
-      text << "\t in float4 vtx_" << binormal_input << " : " << alloc_vreg() << ",\n";
+      text << "\t in " << vector_type << " vtx_" << tangent_input << " : " << alloc_vreg() << ",\n";
+      text << "\t in " << vector_type << " vtx_" << binormal_input << " : " << alloc_vreg() << ",\n";
     }
 
     if (tex._flags & ShaderKey::TF_map_glow) {
@@ -870,7 +897,11 @@ synthesize_shader(const RenderState *rs, const GeomVertexAnimationSpec &anim) {
     }
   }
   if ((key._texture_flags & ShaderKey::TF_map_height) != 0 || need_world_normal || need_eye_normal) {
-    text << "\t in float3 vtx_normal : " << normal_vreg << ",\n";
+    if (key._octahedral_normals) {
+      text << "\t in float2 vtx_normal : " << normal_vreg << ",\n";
+    } else {
+      text << "\t in float3 vtx_normal : " << normal_vreg << ",\n";
+    }
   }
   if (key._texture_flags & ShaderKey::TF_map_height) {
     text << "\t uniform float4 mspos_view,\n";
@@ -900,7 +931,7 @@ synthesize_shader(const RenderState *rs, const GeomVertexAnimationSpec &anim) {
       key._anim_spec.get_num_transforms() > 0) {
     int num_transforms;
     if (key._anim_spec.get_indexed_transforms()) {
-      num_transforms = 120;
+      num_transforms = max_indexed_transforms;
     } else {
       num_transforms = key._anim_spec.get_num_transforms();
     }
@@ -921,6 +952,16 @@ synthesize_shader(const RenderState *rs, const GeomVertexAnimationSpec &anim) {
   text << "\t uniform float4x4 mat_modelproj\n";
   text << ") {\n";
 
+  if (key._octahedral_normals) {
+    if ((key._texture_flags & ShaderKey::TF_map_height) != 0 || need_world_normal || need_eye_normal) {
+      text << "\t float3 normal = decode_octahedral(vtx_normal);\n";
+    }
+    if (!tangent_input.empty()) {
+      text << "\t float3 " << tangent_var << " = decode_octahedral(vtx_" << tangent_input << ");\n";
+      text << "\t float3 " << binormal_var << " = decode_octahedral(vtx_" << binormal_input << ");\n";
+    }
+  }
+
   if (key._anim_spec.get_animation_type() == GeomEnums::AT_hardware &&
       key._anim_spec.get_num_transforms() > 0) {
 
@@ -942,7 +983,7 @@ synthesize_shader(const RenderState *rs, const GeomVertexAnimationSpec &anim) {
 
     text << "\t vtx_position = mul(matrix, vtx_position);\n";
     if (need_world_normal || need_eye_normal) {
-      text << "\t vtx_normal = mul((float3x3)matrix, vtx_normal);\n";
+      text << "\t " << normal_var << " = mul((float3x3)matrix, " << normal_var << ");\n";
     }
   }
 
@@ -954,7 +995,7 @@ synthesize_shader(const RenderState *rs, const GeomVertexAnimationSpec &anim) {
     text << "\t l_world_position = mul(trans_model_to_world, vtx_position);\n";
   }
   if (need_world_normal) {
-    text << "\t l_world_normal = mul(trans_model_to_world, float4(vtx_normal, 0));\n";
+    text << "\t l_world_normal = mul(trans_model_to_world, float4(" << normal_var << ", 0));\n";
   }
   if (need_eye_position) {
     text << "\t l_eye_position = mul(trans_model_to_view, vtx_position);\n";
@@ -969,9 +1010,9 @@ synthesize_shader(const RenderState *rs, const GeomVertexAnimationSpec &anim) {
     text << "\t l_color = vtx_color;\n";
   }
   if (need_tangents) {
-    text << "\t l_tangent.xyz = normalize(mul((float3x3)trans_model_to_view, vtx_" << tangent_input << ".xyz));\n";
+    text << "\t l_tangent.xyz = normalize(mul((float3x3)trans_model_to_view, " << tangent_var << "));\n";
     text << "\t l_tangent.w = 0;\n";
-    text << "\t l_binormal.xyz = normalize(mul((float3x3)trans_model_to_view, -vtx_" << binormal_input << ".xyz));\n";
+    text << "\t l_binormal.xyz = normalize(mul((float3x3)trans_model_to_view, -" << binormal_var << "));\n";
     text << "\t l_binormal.w = 0;\n";
   }
   for (size_t i = 0; i < key._lights.size(); ++i) {
@@ -983,20 +1024,20 @@ synthesize_shader(const RenderState *rs, const GeomVertexAnimationSpec &anim) {
   }
   if (key._texture_flags & ShaderKey::TF_map_height) {
     text << "\t float3 eyedir = mspos_view.xyz - vtx_position.xyz;\n";
-    text << "\t l_eyevec.x = dot(vtx_" << tangent_input << ".xyz, eyedir);\n";
-    text << "\t l_eyevec.y = dot(vtx_" << binormal_input << ".xyz, eyedir);\n";
-    text << "\t l_eyevec.z = dot(vtx_normal, eyedir);\n";
+    text << "\t l_eyevec.x = dot(" << tangent_var << ", eyedir);\n";
+    text << "\t l_eyevec.y = dot(" << binormal_var << ", eyedir);\n";
+    text << "\t l_eyevec.z = dot(" << normal_var << ", eyedir);\n";
     text << "\t l_eyevec = normalize(l_eyevec);\n";
   }
   if (need_eye_normal) {
     if (pack_eye_normal) {
       // We can pack the normal into the w channels of these unused varyings.
-      text << "\t float3 eye_normal = normalize(mul((float3x3)tpose_view_to_model, vtx_normal));\n";
+      text << "\t float3 eye_normal = normalize(mul((float3x3)tpose_view_to_model, " << normal_var << "));\n";
       text << "\t l_tangent.w = eye_normal.x;\n";
       text << "\t l_binormal.w = eye_normal.y;\n";
       text << "\t l_eye_position.w = eye_normal.z;\n";
     } else {
-      text << "\t l_eye_normal = normalize(mul((float3x3)tpose_view_to_model, vtx_normal));\n";
+      text << "\t l_eye_normal = normalize(mul((float3x3)tpose_view_to_model, " << normal_var << "));\n";
     }
   }
   text << "}\n\n";
@@ -1866,6 +1907,7 @@ texture_type_as_string(Texture::TextureType ttype) {
  */
 ShaderGenerator::ShaderKey::
 ShaderKey() :
+  _octahedral_normals(false),
   _color_type(ColorAttrib::T_vertex),
   _material_flags(0),
   _texture_flags(0),
@@ -1890,6 +1932,9 @@ operator < (const ShaderKey &other) const {
   if (_anim_spec != other._anim_spec) {
     return _anim_spec < other._anim_spec;
   }
+  if (_octahedral_normals != other._octahedral_normals) {
+    return (int)_octahedral_normals < (int)other._octahedral_normals;
+  }
   if (_color_type != other._color_type) {
     return _color_type < other._color_type;
   }
@@ -1978,6 +2023,9 @@ operator == (const ShaderKey &other) const {
   if (_anim_spec != other._anim_spec) {
     return false;
   }
+  if (_octahedral_normals != other._octahedral_normals) {
+    return false;
+  }
   if (_color_type != other._color_type) {
     return false;
   }
@@ -73,6 +73,12 @@ PUBLISHED:
   void rehash_generated_shaders();
   void clear_generated_shaders();
 
+public:
+  // The size of the matrix palette declared by a generated shader that
+  // performs indexed hardware skinning.  A vertex table that refers to more
+  // transforms than this cannot be animated by a generated shader.
+  static const int max_indexed_transforms = 120;
+
 protected:
   // Shader register allocation:
 
@@ -97,6 +103,7 @@ protected:
     bool operator != (const ShaderKey &other) const { return !operator ==(other); }
 
     GeomVertexAnimationSpec _anim_spec;
+    bool _octahedral_normals;
     enum TextureFlags {
       TF_has_rgb      = 0x001,
       TF_has_alpha    = 0x002,
@@ -0,0 +1,199 @@
+/**
+ * PANDA 3D SOFTWARE
+ * Copyright (c) Carnegie Mellon University.  All rights reserved.
+ *
+ * All use of this software is subject to the terms of the revised BSD
+ * license.  You should have received a copy of this license along
+ * with this source code in a file named "LICENSE."
+ *
+ * @file workerThreadPool.cxx
+ * @author blablabla94
+ * @date 2026-10-16
+ */
+
+#include "workerThreadPool.h"
+#include "mutexHolder.h"
+#include "config_pipeline.h"
+
+/**
+ * Creates a new pool with the indicated number of worker threads.  If
+ * num_threads is 0, or if the build does not support true threads, all jobs
+ * will be run serially in the thread that calls run().
+ */
+WorkerThreadPool::
+WorkerThreadPool(const std::string &name, int num_threads) :
+  _name(name),
+  _run_lock("WorkerThreadPool::_run_lock"),
+  _lock("WorkerThreadPool::_lock"),
+  _func(nullptr),
+  _user_data(nullptr),
+  _pipeline_stage(0),
+  _num_jobs(0),
+  _next_job(0),
+  _jobs_outstanding(0),
+  _shutdown(false),
+  _work_cvar(_lock),
+  _done_cvar(_lock)
+{
+  if (Thread::is_true_threads()) {
+    start_threads(num_threads);
+  }
+}
+
+/**
+ * Stops all of the worker threads and waits for them to exit.
+ */
+WorkerThreadPool::
+~WorkerThreadPool() {
+  stop_threads();
+}
+
+/**
+ * Runs func(user_data, i, thread) for each i in the range [0, num_jobs), and
+ * returns when all of the jobs have completed.  The jobs are distributed over
+ * the worker threads as well as the calling thread.
+ *
+ * If another thread is already running a batch on this pool, the jobs are
+ * instead run serially in the calling thread, rather than waiting for the
+ * pool to become available.
+ */
+void WorkerThreadPool::
+run(int num_jobs, JobFunc *func, void *user_data, Thread *current_thread) {
+  if (num_jobs <= 0) {
+    return;
+  }
+
+  if (_threads.empty() || num_jobs == 1 || !_run_lock.try_acquire()) {
+    for (int i = 0; i < num_jobs; ++i) {
+      (*func)(user_data, i, current_thread);
+    }
+    return;
+  }
+
+  _lock.acquire();
+  nassertd(_jobs_outstanding == 0) {
+    _lock.release();
+    _run_lock.release();
+    return;
+  }
+  _func = func;
+  _user_data = user_data;
+  _pipeline_stage = current_thread->get_pipeline_stage();
+  _num_jobs = num_jobs;
+  _next_job = 0;
+  _jobs_outstanding = num_jobs;
+  _work_cvar.notify_all();
+
+  // The calling thread lends a hand, rather than sitting idle.
+  while (_next_job < _num_jobs) {
+    int job_index = _next_job++;
+    _lock.release();
+    (*func)(user_data, job_index, current_thread);
+    _lock.acquire();
+    --_jobs_outstanding;
+  }
+
+  while (_jobs_outstanding > 0) {
+    _done_cvar.wait();
+  }
+
+  _func = nullptr;
+  _user_data = nullptr;
+  _num_jobs = 0;
+  _next_job = 0;
+  _lock.release();
+  _run_lock.release();
+}
+
+/**
+ * Spawns the indicated number of worker threads.  Should only be called from
+ * the constructor.
+ */
+void WorkerThreadPool::
+start_threads(int num_threads) {
+  _threads.reserve(num_threads);
+  for (int i = 0; i < num_threads; ++i) {
+    std::ostringstream name_strm;
+    name_strm << _name << _threads.size();
+    PT(WorkerThread) thread = new WorkerThread(this, name_strm.str());
+    if (!thread->start(TP_normal, true)) {
+      pipeline_cat.warning()
+        << "Unable to start " << thread->get_name() << "\n";
+      break;
+    }
+    _threads.push_back(thread);
+  }
+}
+
+/**
+ * Signals all the threads to stop and waits for them.  Does not return until
+ * the threads have finished.
+ */
+void WorkerThreadPool::
+stop_threads() {
+  Threads threads;
+  {
+    MutexHolder holder(_lock);
+    _shutdown = true;
+    _work_cvar.notify_all();
+    threads.swap(_threads);
+  }
+
+  for (WorkerThread *thread : threads) {
+    thread->join();
+  }
+}
+
+/**
+ * Runs the indicated job of the current batch on a worker thread.  Assumes
+ * _lock is held; it is temporarily released while the job runs.
+ */
+void WorkerThreadPool::
+do_run_job(int job_index, Thread *current_thread) {
+  JobFunc *func = _func;
+  void *user_data = _user_data;
+  int pipeline_stage = _pipeline_stage;
+  _lock.release();
+
+  if (current_thread->get_pipeline_stage() != pipeline_stage) {
+    current_thread->set_pipeline_stage(pipeline_stage);
+  }
+  (*func)(user_data, job_index, current_thread);
+
+  _lock.acquire();
+  if (--_jobs_outstanding == 0) {
+    _done_cvar.notify_all();
+  }
+}
+
+/**
+ *
+ */
+WorkerThreadPool::WorkerThread::
+WorkerThread(WorkerThreadPool *pool, const std::string &name) :
+  Thread(name, name),
+  _pool(pool)
+{
+}
+
+/**
+ * The main processing loop for each worker thread.
+ */
+void WorkerThreadPool::WorkerThread::
+thread_main() {
+  WorkerThreadPool *pool = _pool;
+  pool->_lock.acquire();
+
+  while (true) {
+    while (pool->_next_job >= pool->_num_jobs) {
+      if (pool->_shutdown) {
+        pool->_lock.release();
+        return;
+      }
+      pool->_work_cvar.wait();
+    }
+
+    int job_index = pool->_next_job++;
+    pool->do_run_job(job_index, this);
+  }
+}
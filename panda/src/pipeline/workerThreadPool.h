@@ -0,0 +1,97 @@
+/**
+ * PANDA 3D SOFTWARE
+ * Copyright (c) Carnegie Mellon University.  All rights reserved.
+ *
+ * All use of this software is subject to the terms of the revised BSD
+ * license.  You should have received a copy of this license along
+ * with this source code in a file named "LICENSE."
+ *
+ * @file workerThreadPool.h
+ * @author blablabla94
+ * @date 2026-10-16
+ */
+
+#ifndef WORKERTHREADPOOL_H
+#define WORKERTHREADPOOL_H
+
+#include "pandabase.h"
+#include "thread.h"
+#include "pmutex.h"
+#include "conditionVar.h"
+#include "referenceCount.h"
+#include "pointerTo.h"
+#include "pvector.h"
+
+/**
+ * A small pool of worker threads that can be used to split up a batch of
+ * independent jobs, such as the subtrees of a cull traversal, across several
+ * CPU cores.
+ *
+ * A batch is submitted with run(), which does not return until every job in
+ * the batch has completed.  The calling thread participates in processing the
+ * batch, so a pool with zero threads simply runs all of the jobs serially.
+ * Jobs are claimed in index order by whichever thread is idle first; the
+ * order in which they *complete* is not defined, so each job should write its
+ * results to its own slot, to be merged by the caller afterwards.
+ *
+ * Each job is run with the pipeline stage of the thread that called run(), so
+ * that jobs see the same view of the scene graph as the caller would.
+ */
+class EXPCL_PANDA_PIPELINE WorkerThreadPool : public ReferenceCount {
+public:
+  typedef void JobFunc(void *user_data, int job_index, Thread *current_thread);
+
+  explicit WorkerThreadPool(const std::string &name, int num_threads);
+  virtual ~WorkerThreadPool();
+
+  INLINE int get_num_threads() const;
+
+  void run(int num_jobs, JobFunc *func, void *user_data,
+           Thread *current_thread = Thread::get_current_thread());
+
+private:
+  void start_threads(int num_threads);
+  void stop_threads();
+  void do_run_job(int job_index, Thread *current_thread);
+
+  class WorkerThread : public Thread {
+  public:
+    WorkerThread(WorkerThreadPool *pool, const std::string &name);
+
+  protected:
+    virtual void thread_main();
+
+  private:
+    WorkerThreadPool *_pool;
+  };
+  typedef pvector<PT(WorkerThread)> Threads;
+
+  std::string _name;
+  Threads _threads;
+
+  // Held for the duration of a call to run(), so that only one batch is in
+  // flight at a time.
+  Mutex _run_lock;
+
+  // Protects all of the following members.
+  Mutex _lock;
+  JobFunc *_func;
+  void *_user_data;
+  int _pipeline_stage;
+  int _num_jobs;
+  int _next_job;
+  int _jobs_outstanding;
+  bool _shutdown;
+
+  // Signaled when a new batch is posted, or when _shutdown is set true.
+  ConditionVar _work_cvar;
+
+  // Signaled when _jobs_outstanding drops to zero.
+  ConditionVar _done_cvar;
+
+  friend class WorkerThread;
+};
+
+#include "workerThreadPool.I"
+
+#endif
@@ -158,10 +158,13 @@ static LevelCollectorProperties level_properties[] = {
   { 1, "Buffer switch:Index",              { 0.8, 0.6, 0.3 } },
   { 1, "Geom cache size",                  { 0.6, 0.8, 0.6 },  "", 500 },
   { 1, "Geom cache size:Active",           { 0.9, 1.0, 0.3 },  "", 500 },
+  { 1, "Geom cache memory",                { 0.6, 0.6, 0.9 },  "MB", 64, 1048576 },
   { 1, "Geom cache operations",            { 1.0, 0.6, 0.6 },  "", 500 },
   { 1, "Geom cache operations:record",     { 0.2, 0.4, 0.8 } },
   { 1, "Geom cache operations:erase",      { 0.4, 0.8, 0.2 } },
   { 1, "Geom cache operations:evict",      { 0.8, 0.2, 0.4 } },
+  { 1, "Geom cache operations:hit",        { 0.3, 0.9, 0.6 } },
+  { 1, "Geom cache operations:miss",       { 0.9, 0.5, 0.1 } },
   { 1, "Data transferred",                 { 0.0, 0.2, 0.4 },  "MB", 12, 1048576 },
   { 1, "Primitive batches",                { 0.2, 0.5, 0.9 },  "", 500 },
   { 1, "Primitive batches:Other",          { 0.2, 0.2, 0.2 } },
@@ -207,6 +210,7 @@ static LevelCollectorProperties level_properties[] = {
   { 1, "Vertex Data:Disk",                 { 0.6, 0.9, 0.1 } },
   { 1, "Vertex Data:Disk:Unused",          { 0.8, 0.4, 0.5 } },
   { 1, "Vertex Data:Disk:Used",            { 0.2, 0.1, 0.6 } },
+  { 1, "Vertex page-in latency",           { 0.8, 0.5, 0.1 },  "", 10 },
   { 1, "TransformStates",                  { 1.0, 0.5, 0.5 },  "", 5000 },
   { 1, "TransformStates:On nodes",         { 0.2, 0.8, 1.0 } },
   { 1, "TransformStates:Cached",           { 1.0, 0.0, 0.2 } },
@@ -415,6 +415,39 @@ write_file_data(SubfileInfo &result, const SubfileInfo &source) {
   // order and queued up in the BamReader.
 }
 
+/**
+ * Writes a block of auxiliary file data from the indicated memory buffer.
+ * This must be balanced by a matching call to read_file_data() on restore.
+ *
+ * If alignment is nonzero, the file data is positioned so that it begins at
+ * a multiple of that many bytes from the start of the output file, so that
+ * the reader may map it directly into memory.
+ */
+void BamWriter::
+write_file_data(const unsigned char *data, size_t size, size_t alignment) {
+  // As above, this is preceded by a singleton datagram containing the
+  // BOC_file_data token.  The reader ignores anything following the token, so
+  // we pad this datagram to push the file data to the requested alignment.
+  Datagram dg;
+  dg.add_uint8(BOC_file_data);
+  if (alignment > 1) {
+    // Account for the length prefixes of both datagrams.
+    size_t header_size = (size >= (uint32_t)-1) ? 12 : 4;
+    uint64_t pos = (uint64_t)_target->get_file_pos() + 4 + 1 + header_size;
+    dg.pad_bytes((size_t)((alignment - pos % alignment) % alignment));
+  }
+  if (!_target->put_datagram(dg)) {
+    util_cat.error()
+      << "Unable to write data to output.\n";
+    return;
+  }
+
+  if (!_target->put_datagram(Datagram(data, size))) {
+    util_cat.error()
+      << "Unable to write file data to output.\n";
+  }
+}
+
 /**
  * Writes out the indicated CycleData object.  This should be used by classes
  * that store some or all of their data within a CycleData subclass, in
@@ -19,6 +19,9 @@
 #include "config_egg2pg.h"
 #include "config_gobj.h"
 #include "config_chan.h"
+#include "config_pgraph.h"
+#include "sceneGraphReducer.h"
+#include "lodNode.h"
 #include "pandaNode.h"
 #include "geomNode.h"
 #include "renderState.h"
@@ -88,6 +91,58 @@ EggToBam() :
      "file has been loaded, showing the nodes that will be written out.",
      &EggToBam::dispatch_none, &_ls);
 
+  add_option
+    ("optimize-vertices", "", 0,
+     "Reorders the triangles and vertices of each Geom for the "
+     "post-transform vertex cache, to reduce overdraw, and for sequential "
+     "vertex fetches.  The average cache miss ratio (ACMR) of the model "
+     "before and after is reported; lower is better.  The modeled cache "
+     "size comes from the vertex-cache-size Config.prc variable.",
+     &EggToBam::dispatch_none, &_optimize_vertices);
+
+  add_option
+    ("lod", "levels", 0,
+     "Generates the indicated number of levels of detail from the loaded "
+     "model, and stores them under an LODNode of the type named by the "
+     "default-lod-type Config.prc variable.  The first level is the "
+     "original model; each further level is simplified to a fraction of "
+     "the triangles of the one before (see -lod-ratio) and is switched in "
+     "at twice the distance.  There must be at least two levels.",
+     &EggToBam::dispatch_int, nullptr, &_lod_levels);
+
+  add_option
+    ("lod-ratio", "ratio", 0,
+     "Specifies the fraction of triangles kept by each level generated "
+     "by -lod relative to the level before.  The default is 0.5.",
+     &EggToBam::dispatch_double, nullptr, &_lod_ratio);
+
+  add_option
+    ("compress-vertices", "", 0,
+     "Stores vertex positions as 16-bit integers, with a transform on a "
+     "new GeomNode to scale them back, and texture coordinates as "
+     "half-precision floats where they are close enough to the unit "
+     "square.  This should be used only on models that will not be "
+     "flattened again after loading.",
+     &EggToBam::dispatch_none, &_compress_vertices);
+
+  add_option
+    ("compress-normals", "", 0,
+     "Also stores normals, tangents and binormals in a two-component "
+     "octahedral encoding.  The shader generator decodes these, as does "
+     "the fixed-function OpenGL renderer (at munge time), but a custom "
+     "shader must decode them itself.  Implies -compress-vertices.",
+     &EggToBam::dispatch_none, &_compress_normals);
+
+  add_option
+    ("align-vertex-data", "bytes", 0,
+     "Stores each vertex array in the bam file separately from the rest "
+     "of the model, aligned to a multiple of the indicated number of bytes "
+     "(normally the page size, 4096), so that it can be mapped directly "
+     "into memory when the model is loaded instead of being copied.  This "
+     "writes a bam file of at least version 6.46, and has no effect if the "
+     "output file is compressed.",
+     &EggToBam::dispatch_int, nullptr, &_align_vertex_data);
+
   add_option
     ("C", "quality", 0,
      "Specify the quality level for lossy channel compression.  If this "
@@ -210,6 +265,12 @@ EggToBam() :
   _egg_flatten = 0;
   _egg_combine_geoms = 0;
   _egg_suppress_hidden = 1;
+  _optimize_vertices = false;
+  _lod_levels = 0;
+  _lod_ratio = 0.5;
+  _compress_vertices = false;
+  _compress_normals = false;
+  _align_vertex_data = 0;
   _tex_txopz = false;
   _ctex_quality = "best";
 }
@@ -243,6 +304,22 @@ run() {
     compress_chan_quality = _compression_quality;
   }
 
+  if (_align_vertex_data > 0) {
+    bam_vertex_data_alignment = _align_vertex_data;
+    if (bam_version.get_num_words() < 2 || bam_version[1] < 46) {
+      // Aligned vertex data requires a newer bam version than the default.
+      bam_version.set_string_value("6 46");
+    }
+  }
+
+  if (_compress_vertices || _compress_normals) {
+    if (bam_version.get_num_words() < 2 || bam_version[1] < 47) {
+      // Half floats and octahedral normals require a newer bam version, so
+      // that older versions of Panda refuse to load the file.
+      bam_version.set_string_value("6 47");
+    }
+  }
+
   if (_ctex_quality != "default") {
     // Override the user's config file with the command-line parameter for
     // texture compression.
@@ -310,6 +387,55 @@ run() {
     }
   }
 
+  if (_lod_levels != 0) {
+    if (_lod_levels < 2) {
+      nout << "-lod must be at least 2; the first level is the original model.\n";
+      exit(1);
+    }
+    if (_lod_ratio <= 0.0 || _lod_ratio > 1.0) {
+      nout << "-lod-ratio must be between 0 and 1.\n";
+      exit(1);
+    }
+
+    // Move the model into a group node, and replace it with an LODNode that
+    // holds the simplified copies.
+    PT(PandaNode) model = new PandaNode(root->get_name());
+    model->steal_children(root);
+    PT(LODNode) lod = LODNode::make_default_lod(root->get_name());
+    lod->add_simplified_levels(model, _lod_levels, _lod_ratio);
+    root->add_child(lod);
+  }
+
+  if (_optimize_vertices) {
+    double misses_before = 0.0;
+    int num_faces = 0;
+    accumulate_acmr(root, misses_before, num_faces);
+
+    SceneGraphReducer gr;
+    gr.optimize_vertices(root);
+
+    double misses_after = 0.0;
+    num_faces = 0;
+    accumulate_acmr(root, misses_after, num_faces);
+
+    if (num_faces != 0) {
+      nout << "Vertex cache ACMR for " << num_faces << " triangles: "
+           << misses_before / num_faces << " before, "
+           << misses_after / num_faces << " after optimization.\n";
+    }
+  }
+
+  if (_compress_vertices || _compress_normals) {
+    int compress_bits =
+      SceneGraphReducer::CV_positions | SceneGraphReducer::CV_texcoords;
+    if (_compress_normals) {
+      compress_bits |= SceneGraphReducer::CV_normals;
+    }
+    SceneGraphReducer gr;
+    int num_compressed = gr.compress_vertices(root, compress_bits);
+    nout << "Compressed " << num_compressed << " vertex tables.\n";
+  }
+
   if (_ls) {
     root->ls(nout, 0);
   }
@@ -333,6 +459,37 @@ run() {
   }
 }
 
+/**
+ * Recursively adds up the number of vertex cache misses and the number of
+ * triangles of all of the Geoms at the indicated node and below, for
+ * reporting the average cache miss ratio.
+ */
+void EggToBam::
+accumulate_acmr(PandaNode *node, double &misses, int &num_faces) {
+  if (node->is_geom_node()) {
+    GeomNode *geom_node = DCAST(GeomNode, node);
+    int num_geoms = geom_node->get_num_geoms();
+    for (int i = 0; i < num_geoms; ++i) {
+      CPT(Geom) geom = geom_node->get_geom(i);
+      int num_primitives = geom->get_num_primitives();
+      for (int j = 0; j < num_primitives; ++j) {
+        CPT(GeomPrimitive) prim = geom->get_primitive(j);
+        if (prim->get_primitive_type() == GeomPrimitive::PT_polygons) {
+          int prim_faces = prim->get_num_faces();
+          misses += prim->calc_acmr(vertex_cache_size) * prim_faces;
+          num_faces += prim_faces;
+        }
+      }
+    }
+  }
+
+  PandaNode::Children children = node->get_children();
+  int num_children = children.get_num_children();
+  for (int i = 0; i < num_children; ++i) {
+    accumulate_acmr(children.get_child(i), misses, num_faces);
+  }
+}
+
 /**
  * Does something with the additional arguments on the command line (after all
  * the -options have been parsed).  Returns true if the arguments are good,
@@ -43,6 +43,7 @@ private:
   void collect_textures(PandaNode *node);
   void collect_textures(const RenderState *state);
   void convert_txo(Texture *tex);
+  void accumulate_acmr(PandaNode *node, double &misses, int &num_faces);
 
   bool make_buffer();
 
@@ -56,6 +57,12 @@ private:
   int _egg_combine_geoms;
   bool _egg_suppress_hidden;
   bool _ls;
+  bool _optimize_vertices;
+  int _lod_levels;
+  double _lod_ratio;
+  bool _compress_vertices;
+  bool _compress_normals;
+  int _align_vertex_data;
   bool _has_compression_quality;
   int _compression_quality;
   bool _compression_off;
@@ -4,6 +4,8 @@ from panda3d.core import CollisionSphere, CollisionInvSphere, CollisionBox, Coll
 from panda3d.core import CollisionLine, CollisionRay, CollisionSegment, CollisionParabola
 from panda3d.core import CollisionPlane
 from panda3d.core import Point3, Vec3, Plane, LParabola
+from panda3d.core import Geom, GeomNode, GeomTriangles, GeomVertexData, GeomVertexFormat, GeomVertexWriter
+import math
 
 
 def make_collision(solid_from, solid_into):
@@ -22,9 +24,44 @@ def make_collision(solid_from, solid_into):
     trav.add_collider(np_from, queue)
     trav.traverse(root)
 
+    # A solid may report several contacts; the first one is the main one.
     entry = None
     for e in queue.get_entries():
-        if e.get_into() == solid_into:
+        if entry is None and e.get_into() == solid_into:
             entry = e
 
     return (entry, np_from, np_into)
+
+
+def get_terrain_height(x, y):
+    return math.sin(x * 0.1) * math.cos(y * 0.13) * 2
+
+
+def make_terrain(x0, y0, size):
+    # A square of rolling terrain of size by size quads, as visible geometry.
+    vdata = GeomVertexData("terrain", GeomVertexFormat.get_v3(), Geom.UH_static)
+    vertex = GeomVertexWriter(vdata, "vertex")
+    for y in range(y0, y0 + size + 1):
+        for x in range(x0, x0 + size + 1):
+            vertex.add_data3(x, y, get_terrain_height(x, y))
+
+    tris = GeomTriangles(Geom.UH_static)
+    for y in range(size):
+        for x in range(size):
+            v = y * (size + 1) + x
+            tris.add_vertices(v, v + 1, v + size + 1)
+            tris.add_vertices(v + 1, v + size + 2, v + size + 1)
+
+    geom = Geom(vdata)
+    geom.add_primitive(tris)
+    return geom
+
+
+def make_terrain_chunks(parent, size, chunk_size=10):
+    # The same terrain, split up into one GeomNode per chunk, so that the
+    # bounding volumes rule out most of it for each collider.
+    for y in range(0, size, chunk_size):
+        for x in range(0, size, chunk_size):
+            gnode = GeomNode("chunk")
+            gnode.add_geom(make_terrain(x, y, chunk_size))
+            parent.attach_new_node(gnode)
@@ -0,0 +1,98 @@
+from panda3d.core import CollisionNode, NodePath, LODNode, BitMask32
+from panda3d.core import CollisionTraverser, CollisionHandlerQueue
+from panda3d.core import CollisionSphere, CollisionBox
+from panda3d.core import Point3
+
+
+def make_scene(num_colliders):
+    root = NodePath("root")
+
+    # A row of spheres to collide into, under a transformed parent.
+    targets = root.attach_new_node("targets")
+    targets.set_pos(0, 0, 1)
+    targets.set_scale(2)
+    for i in range(20):
+        node = CollisionNode("target%d" % i)
+        node.add_solid(CollisionSphere(0, 0, 0, 0.5))
+        targets.attach_new_node(node).set_pos(i, 0, 0)
+
+    # A box under an LOD node.
+    lod = root.attach_new_node(LODNode("lod"))
+    lod.node().add_switch(10, 0)
+    lod.node().add_switch(100, 10)
+    lod.attach_new_node("low")
+    node = CollisionNode("lod_box")
+    node.add_solid(CollisionBox(Point3(0), 1, 1, 1))
+    lod.attach_new_node(node).set_pos(5, 0, 2)
+
+    colliders = []
+    for i in range(num_colliders):
+        node = CollisionNode("collider%d" % i)
+        node.add_solid(CollisionSphere(0, 0, 0, 0.75))
+        node.set_into_collide_mask(BitMask32.bit(1))
+        np = root.attach_new_node(node)
+        np.set_pos(i * 0.5, 0, 2)
+        colliders.append(np)
+
+    return root, colliders
+
+
+def collect(trav, queue, root):
+    trav.traverse(root)
+    result = set()
+    for entry in queue.get_entries():
+        result.add((entry.get_from_node_path().get_name(),
+                    entry.get_into_node_path().get_name()))
+    return result
+
+
+def test_broadphase_matches_traversal():
+    # Use more colliders than fit in a single pass of the usual traverser.
+    root, colliders = make_scene(100)
+
+    queue = CollisionHandlerQueue()
+    trav = CollisionTraverser()
+    assert not trav.use_broadphase
+
+    bp_queue = CollisionHandlerQueue()
+    bp_trav = CollisionTraverser()
+    bp_trav.use_broadphase = True
+    assert bp_trav.get_use_broadphase()
+
+    for np in colliders:
+        trav.add_collider(np, queue)
+        bp_trav.add_collider(np, bp_queue)
+
+    expected = collect(trav, queue, root)
+    assert ("collider0", "target0") in expected
+    assert ("collider0", "collider1") in expected
+    assert ("collider10", "lod_box") in expected
+    assert collect(bp_trav, bp_queue, root) == expected
+
+    # Move things around; the broadphase must notice.
+    colliders[0].set_pos(38, 0, 2)
+    root.find("targets").set_z(-100)
+    expected = collect(trav, queue, root)
+    assert ("collider0", "target0") not in expected
+    assert collect(bp_trav, bp_queue, root) == expected
+
+    # Remove a node from the scene.
+    colliders[1].remove_node()
+    expected = collect(trav, queue, root)
+    assert not any(into == "collider1" for _, into in expected)
+    assert collect(bp_trav, bp_queue, root) == expected
+
+
+def test_broadphase_new_root():
+    root1, colliders1 = make_scene(2)
+    root2, colliders2 = make_scene(2)
+    colliders2[1].set_x(100)
+
+    queue = CollisionHandlerQueue()
+    trav = CollisionTraverser()
+    trav.use_broadphase = True
+    trav.add_collider(colliders1[0], queue)
+    trav.add_collider(colliders2[0], queue)
+
+    assert ("collider0", "collider1") in collect(trav, queue, root1)
+    assert ("collider0", "collider1") not in collect(trav, queue, root2)
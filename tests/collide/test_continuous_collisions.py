@@ -0,0 +1,171 @@
+import pytest
+import random
+from collisions import *
+from panda3d.core import CollisionMesh, CollisionHandlerFluidPusher, CollideMask
+
+
+def make_wall(kind):
+    # A thin wall in the plane x = 0, facing the -X direction.
+    if kind == "polygon":
+        return CollisionPolygon(Point3(0, -1, -1), Point3(0, -1, 1),
+                                Point3(0, 1, 1), Point3(0, 1, -1))
+    elif kind == "box":
+        return CollisionBox((0, 0, 0), 0.02, 1, 1)
+    else:
+        mesh = CollisionMesh()
+        for point in (Point3(0, -1, -1), Point3(0, -1, 1), Point3(0, 1, 1), Point3(0, 1, -1)):
+            mesh.add_vertex(point)
+        mesh.add_triangle(0, 1, 2)
+        mesh.add_triangle(0, 2, 3)
+        return mesh
+
+
+def sweep(solid_from, kind, start, end, continuous=True):
+    root = NodePath("root")
+    wall = root.attach_new_node(CollisionNode("wall"))
+    wall.node().add_solid(make_wall(kind))
+    wall.set_pos(5, 0, 0)
+
+    node_from = CollisionNode("from")
+    node_from.add_solid(solid_from)
+    node_from.set_into_collide_mask(CollideMask.all_off())
+    np_from = root.attach_new_node(node_from)
+
+    trav = CollisionTraverser()
+    trav.set_continuous(continuous)
+    queue = CollisionHandlerQueue()
+    trav.add_collider(np_from, queue)
+
+    np_from.set_pos(start)
+    np_from.set_fluid_pos(end)
+    trav.traverse(root)
+
+    if queue.get_num_entries() == 0:
+        return None
+    queue.sort_entries()
+    return queue.get_entry(0)
+
+
+@pytest.mark.parametrize("kind", ["polygon", "box", "mesh"])
+def test_continuous_sphere(kind):
+    entry = sweep(CollisionSphere(0, 0, 0, 0.25), kind, (0, 0, 0), (10, 0, 0))
+    assert entry is not None
+    surface = 5.0 if kind != "box" else 4.98
+    assert entry.get_t() == pytest.approx((surface - 0.25) / 10, abs=1e-4)
+    assert entry.get_surface_point(entry.get_into_node_path().get_parent()).almost_equal(Point3(surface, 0, 0), 0.001)
+    assert entry.get_surface_normal(entry.get_into_node_path().get_parent()).almost_equal(Vec3(-1, 0, 0), 0.001)
+
+
+@pytest.mark.parametrize("kind", ["polygon", "box", "mesh"])
+def test_continuous_capsule(kind):
+    # The capsule is tilted towards the wall, so its front end touches first.
+    capsule = CollisionCapsule((-0.5, 0, -0.5), (0.5, 0, 0.5), 0.1)
+    entry = sweep(capsule, kind, (0, 0, 0), (10, 0, 0))
+    assert entry is not None
+    surface = 5.0 if kind != "box" else 4.98
+    assert entry.get_t() == pytest.approx((surface - 0.6) / 10, abs=1e-4)
+    assert entry.get_surface_point(entry.get_into_node_path().get_parent()).almost_equal(Point3(surface, 0, 0.5), 0.001)
+    assert entry.get_surface_normal(entry.get_into_node_path().get_parent()).almost_equal(Vec3(-1, 0, 0), 0.001)
+
+
+def test_continuous_capsule_tunnels():
+    # Without continuous mode, a thin box is missed entirely.
+    capsule = CollisionCapsule((-0.5, 0, -0.5), (0.5, 0, 0.5), 0.1)
+    assert sweep(capsule, "box", (0, 0, 0), (10, 0, 0), continuous=False) is None
+
+
+def test_continuous_miss():
+    # Passing beside the wall is not a collision.
+    entry = sweep(CollisionSphere(0, 0, 0, 0.25), "box", (0, 2, 0), (10, 2, 0))
+    assert entry is None
+
+
+def test_continuous_fluid_pusher():
+    root = NodePath("root")
+    wall = root.attach_new_node(CollisionNode("wall"))
+    wall.node().add_solid(make_wall("box"))
+    wall.set_pos(5, 0, 0)
+
+    mover = root.attach_new_node(CollisionNode("mover"))
+    mover.node().add_solid(CollisionSphere(0, 0, 0, 0.25))
+
+    pusher = CollisionHandlerFluidPusher()
+    pusher.add_collider(mover, mover)
+    trav = CollisionTraverser()
+    trav.add_collider(mover, pusher)
+    trav.continuous = True
+
+    mover.set_pos(0, 0, 0)
+    mover.set_fluid_pos(10, 0.5, 0)
+    trav.traverse(root)
+    assert mover.get_pos().almost_equal(Point3(4.73, 0.5, 0), 0.001)
+
+
+@pytest.mark.parametrize("kind", ["polygon", "box", "mesh"])
+def test_continuous_like_stepping(kind):
+    # Random spheres and capsules fly through a transformed wall.  The time of
+    # impact must fall within the step at which a mover that is stepped along
+    # the same path first touches the wall.
+    rand = random.Random(42)
+    num_steps = 200
+    root = NodePath("root")
+    wall = root.attach_new_node(CollisionNode("wall"))
+    wall.node().add_solid(make_wall(kind))
+    wall.node().set_from_collide_mask(CollideMask.all_off())
+    wall.set_pos_hpr_scale((5, 0, 0), (0, 0, 30), (1, 1.2, 1))
+
+    trav = CollisionTraverser()
+    queue = CollisionHandlerQueue()
+    movers = []
+    for i in range(20):
+        radius = rand.uniform(0.05, 0.25)
+        if i % 2 == 0:
+            solid = CollisionSphere(0, 0, 0, radius)
+        else:
+            axis = Vec3(rand.uniform(-1, 1), rand.uniform(-1, 1), rand.uniform(-1, 1))
+            axis.normalize()
+            axis *= rand.uniform(0.1, 0.6)
+            solid = CollisionCapsule(Point3(-axis), Point3(axis), radius)
+        node = CollisionNode("mover%d" % i)
+        node.add_solid(solid)
+        node.set_into_collide_mask(CollideMask.all_off())
+        np = root.attach_new_node(node)
+        trav.add_collider(np, queue)
+        start = Point3(rand.uniform(0, 2), rand.uniform(-1.5, 1.5), rand.uniform(-1.5, 1.5))
+        end = Point3(rand.uniform(8, 10), rand.uniform(-1.5, 1.5), rand.uniform(-1.5, 1.5))
+        movers.append((np, start, end))
+
+    for np, start, end in movers:
+        np.set_pos(start)
+        np.set_fluid_pos(end)
+    trav.respect_prev_transform = True
+    trav.continuous = True
+    trav.traverse(root)
+    ccd_t = {}
+    for entry in queue.get_entries():
+        name = entry.get_from_node().name
+        ccd_t[name] = min(ccd_t.get(name, 2.0), entry.get_t())
+
+    trav.continuous = False
+    trav.respect_prev_transform = False
+    step_t = {}
+    for s in range(num_steps + 1):
+        t = s / num_steps
+        for np, start, end in movers:
+            np.set_pos(start + (end - start) * t)
+        trav.traverse(root)
+        for entry in queue.get_entries():
+            step_t.setdefault(entry.get_from_node().name, t)
+
+    assert len(step_t) > 0
+    num_grazes = 0
+    for np, start, end in movers:
+        name = np.name
+        if name in step_t:
+            assert name in ccd_t
+            assert step_t[name] - 1.0 / num_steps - 0.001 <= ccd_t[name] <= step_t[name] + 0.001
+        elif name in ccd_t:
+            # A mover that only grazes the wall between two steps may be
+            # missed by stepping.
+            num_grazes += 1
+    assert num_grazes <= 1
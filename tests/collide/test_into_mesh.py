@@ -0,0 +1,276 @@
+from collisions import *
+from panda3d.core import CollisionMesh, CollisionHandlerPusher, PandaNode
+import random
+
+
+def make_grid(size=4):
+    # A bumpy grid of quads facing up, as a mesh and as separate triangles.
+    mesh = CollisionMesh()
+    points = {}
+    for y in range(size + 1):
+        for x in range(size + 1):
+            point = Point3(x, y, 0.25 * ((x + y) % 2))
+            points[x, y] = point
+            mesh.add_vertex(point)
+
+    tris = []
+    for y in range(size):
+        for x in range(size):
+            v = y * (size + 1) + x
+            mesh.add_triangle(v, v + 1, v + size + 1)
+            mesh.add_triangle(v + 1, v + size + 2, v + size + 1)
+            tris.append((points[x, y], points[x + 1, y], points[x, y + 1]))
+            tris.append((points[x + 1, y], points[x + 1, y + 1], points[x, y + 1]))
+
+    return mesh, tris
+
+
+def closest_poly_entry(solid, tris, key):
+    best = None
+    for tri in tris:
+        entry, np_from, np_into = make_collision(solid, CollisionPolygon(*tri))
+        if entry is not None and (best is None or key(entry, np_from) < key(best, np_from)):
+            best = entry
+    return best
+
+
+def check_like_polygons(solid, key):
+    mesh, tris = make_grid()
+    entry, np_from, np_into = make_collision(solid, mesh)
+    expected = closest_poly_entry(solid, tris, key)
+
+    if expected is None:
+        assert entry is None
+        return
+
+    assert entry is not None
+    assert entry.get_from() == solid
+    assert entry.get_into() == mesh
+    assert entry.get_surface_point(np_from).almost_equal(expected.get_surface_point(np_from))
+    assert entry.get_surface_normal(np_from).almost_equal(expected.get_surface_normal(np_from))
+
+
+def first_along(origin):
+    return lambda entry, np_from: (entry.get_surface_point(np_from) - origin).length()
+
+
+def deepest(entry, np_from):
+    return -(entry.get_surface_point(np_from) - entry.get_interior_point(np_from)).length()
+
+
+def test_sphere_into_mesh():
+    check_like_polygons(CollisionSphere(1.3, 2.2, 0.3, 0.5), deepest)
+    check_like_polygons(CollisionSphere(2, 2, 0, 1.5), deepest)
+    check_like_polygons(CollisionSphere(10, 10, 0, 1), deepest)
+
+
+def test_ray_into_mesh():
+    check_like_polygons(CollisionRay(1.3, 2.2, 3, 0.1, 0.2, -1), first_along(Point3(1.3, 2.2, 3)))
+    check_like_polygons(CollisionRay(-1, 0.5, 0.1, 1, 0, 0), first_along(Point3(-1, 0.5, 0.1)))
+    check_like_polygons(CollisionRay(1.3, 2.2, 3, 0, 0, 1), first_along(Point3(1.3, 2.2, 3)))
+
+
+def test_line_into_mesh():
+    check_like_polygons(CollisionLine(1.3, 2.2, 3, 0, 0, 1), first_along(Point3(1.3, 2.2, -1000)))
+
+
+def test_segment_into_mesh():
+    check_like_polygons(CollisionSegment(0.5, 0.5, 1, 3.5, 3.5, 0), first_along(Point3(0.5, 0.5, 1)))
+    check_like_polygons(CollisionSegment(0.5, 0.5, 1, 0.5, 0.5, 0.5), first_along(Point3(0.5, 0.5, 1)))
+
+
+def test_capsule_into_mesh():
+    check_like_polygons(CollisionCapsule((0.5, 1.5, 0.2), (3, 1.5, 0.2), 0.3), deepest)
+    check_like_polygons(CollisionCapsule((0.5, 1.5, 2), (3, 1.5, 2), 0.3), deepest)
+
+
+def test_box_into_mesh():
+    check_like_polygons(CollisionBox((2.2, 1.7, 0.2), 0.5, 0.4, 0.3), deepest)
+    check_like_polygons(CollisionBox((2.2, 1.7, 2), 0.5, 0.4, 0.3), deepest)
+
+
+def test_parabola_into_mesh():
+    parabola = LParabola(Vec3(0, 0, -9.8), Vec3(1, 0.5, 4), Point3(0.5, 0.5, 0.5))
+    # The parabola moves along X at a constant speed.
+    check_like_polygons(CollisionParabola(parabola, 0, 2),
+                        lambda entry, np_from: entry.get_surface_point(np_from)[0])
+
+
+def test_mesh_tree():
+    mesh, tris = make_grid(10)
+    assert mesh.get_num_triangles() == 200
+    assert mesh.get_num_tree_nodes() > 1
+
+    # Degenerate triangles are ignored.
+    v = mesh.add_vertex((20, 20, 0))
+    mesh.add_triangle(v, v, v)
+    entry = make_collision(CollisionSphere(20, 20, 0, 1), mesh)[0]
+    assert entry is None
+
+
+def test_mesh_bam():
+    mesh, tris = make_grid(10)
+    mesh.build_tree()
+    node = CollisionNode("mesh")
+    node.add_solid(mesh)
+
+    node2 = PandaNode.decode_from_bam_stream(node.encode_to_bam_stream())
+    mesh2 = node2.get_solid(0)
+    assert isinstance(mesh2, CollisionMesh)
+    assert mesh2.get_num_triangles() == mesh.get_num_triangles()
+    assert mesh2.get_num_tree_nodes() == mesh.get_num_tree_nodes()
+    assert list(mesh2.vertices) == list(mesh.vertices)
+
+    solid = CollisionRay(3.3, 4.6, 3, 0, 0, -1)
+    entry, np_from, np_into = make_collision(solid, mesh)
+    entry2 = make_collision(solid, mesh2)[0]
+    assert entry2.get_surface_point(np_from) == entry.get_surface_point(np_from)
+
+
+def get_best_distances(root, colliders, key):
+    trav = CollisionTraverser()
+    queue = CollisionHandlerQueue()
+    for np in colliders:
+        trav.add_collider(np, queue)
+    trav.traverse(root)
+
+    best = {}
+    for entry in queue.get_entries():
+        name = entry.get_from_node().name
+        dist = key(entry, entry.get_from_node_path())
+        if name not in best or dist < best[name]:
+            best[name] = dist
+    return best
+
+
+def test_mesh_like_geometry():
+    # A mesh made from a Geom finds the same contacts as colliding with the
+    # visible geometry itself, split up into chunks.
+    size = 20
+    mesh = CollisionMesh()
+    mesh.add_geom(make_terrain(0, 0, size))
+    mesh_root = NodePath("mesh_root")
+    mesh_root.attach_new_node(CollisionNode("mesh")).node().add_solid(mesh)
+
+    geom_root = NodePath("geom_root")
+    make_terrain_chunks(geom_root, size)
+
+    rand = random.Random(42)
+    kinds = [
+        (lambda: CollisionSphere(0, 0, 0, 0.5), deepest),
+        (lambda: CollisionRay(0, 0, 3, rand.uniform(-0.2, 0.2), rand.uniform(-0.2, 0.2), -1),
+         first_along(Point3(0, 0, 3))),
+        (lambda: CollisionSegment(0, 0, 1, rand.uniform(-1, 1), rand.uniform(-1, 1), -1),
+         first_along(Point3(0, 0, 1))),
+        (lambda: CollisionCapsule((-0.5, 0, 0), (0.5, 0, 0), 0.3), deepest),
+        (lambda: CollisionBox((0, 0, 0), 0.4, 0.3, 0.2), deepest),
+        (lambda: CollisionParabola(LParabola(Vec3(0, 0, -9.8), Vec3(2, 1, 3), Point3(0, 0, 0)), 0, 2),
+         lambda entry, np_from: entry.get_surface_point(np_from)[0]),
+    ]
+
+    for make_solid, key in kinds:
+        mesh_colliders = []
+        geom_colliders = []
+        for i in range(50):
+            solid = make_solid()
+            x = rand.uniform(2, size - 2)
+            y = rand.uniform(2, size - 2)
+            z = get_terrain_height(x, y) + rand.uniform(-0.5, 0.5)
+
+            for root, colliders in ((mesh_root, mesh_colliders), (geom_root, geom_colliders)):
+                node = CollisionNode("collider%d" % i)
+                node.add_solid(solid)
+                node.set_from_collide_mask(CollisionNode.get_default_collide_mask() |
+                                           GeomNode.get_default_collide_mask())
+                node.set_into_collide_mask(0)
+                np = root.attach_new_node(node)
+                np.set_pos(x, y, z)
+                colliders.append(np)
+
+        mesh_best = get_best_distances(mesh_root, mesh_colliders, key)
+        geom_best = get_best_distances(geom_root, geom_colliders, key)
+        assert len(geom_best) > 0
+        assert mesh_best.keys() == geom_best.keys()
+        for name, dist in geom_best.items():
+            assert abs(mesh_best[name] - dist) < 0.001
+
+        for np in mesh_colliders + geom_colliders:
+            np.remove_node()
+
+
+def make_corner():
+    # A floor at z = 0, meeting a wall at x = 1 that faces the -X direction.
+    mesh = CollisionMesh()
+    for point in ((-5, -5, 0), (1, -5, 0), (1, 5, 0), (-5, 5, 0),
+                  (1, -5, 5), (1, 5, 5)):
+        mesh.add_vertex(point)
+    mesh.add_triangle(0, 1, 2)
+    mesh.add_triangle(0, 2, 3)
+    mesh.add_triangle(1, 4, 5)
+    mesh.add_triangle(1, 5, 2)
+    return mesh
+
+
+def test_sphere_into_mesh_corner():
+    # A sphere in the corner touches both the floor and the wall.
+    mesh = make_corner()
+    node_from = CollisionNode("from")
+    node_from.add_solid(CollisionSphere(0.5, 0, 0.5, 1))
+    node_into = CollisionNode("into")
+    node_into.add_solid(mesh)
+
+    root = NodePath("root")
+    np_from = root.attach_new_node(node_from)
+    root.attach_new_node(node_into)
+    trav = CollisionTraverser()
+    queue = CollisionHandlerQueue()
+    trav.add_collider(np_from, queue)
+    trav.traverse(root)
+
+    normals = set()
+    for entry in queue.get_entries():
+        assert entry.get_into() == mesh
+        normal = entry.get_surface_normal(root)
+        normals.add((round(normal[0], 3), round(normal[1], 3), round(normal[2], 3)))
+    assert normals == {(0, 0, 1), (-1, 0, 0)}
+
+
+def test_pusher_mesh_corner():
+    root = NodePath("root")
+    node_into = CollisionNode("into")
+    node_into.add_solid(make_corner())
+    root.attach_new_node(node_into)
+
+    mover = root.attach_new_node(CollisionNode("mover"))
+    mover.node().add_solid(CollisionSphere(0, 0, 0, 1))
+    mover.set_pos(0.5, 0, 0.5)
+
+    pusher = CollisionHandlerPusher()
+    pusher.add_collider(mover, mover)
+    trav = CollisionTraverser()
+    trav.add_collider(mover, pusher)
+    trav.traverse(root)
+
+    # The sphere is pushed out of both the floor and the wall.
+    assert mover.get_pos().almost_equal(Point3(0, 0, 1), 0.001)
+
+
+def test_mesh_bam_invalid():
+    mesh = CollisionMesh()
+    mesh.add_vertex((0, 0, 0))
+    mesh.add_vertex((1, 0, 0))
+    mesh.add_vertex((0, 1, 0))
+    mesh.add_triangle(0, 1, 2)
+    mesh.build_tree()
+    node = CollisionNode("mesh")
+    node.add_solid(mesh)
+
+    # Make the triangle refer to a vertex that doesn't exist.
+    data = node.encode_to_bam_stream()
+    triangle = (b"\x01\x00\x00\x00" b"\x00\x00\x00\x00"
+                b"\x01\x00\x00\x00" b"\x02\x00\x00\x00")
+    assert data.count(triangle) == 1
+    data = data.replace(triangle, triangle[:-4] + b"\x07\x00\x00\x00")
+
+    node2 = PandaNode.decode_from_bam_stream(data)
+    assert node2.get_num_solids() == 0
@@ -0,0 +1,217 @@
+import pytest
+import random
+from collisions import *
+from panda3d.core import CollisionRayBatch, CollisionMesh, CollideMask
+from panda3d.core import GeomNode, Geom, GeomTriangles, GeomVertexData, GeomVertexFormat, GeomVertexWriter
+
+
+def make_scene():
+    root = NodePath("root")
+
+    sphere = root.attach_new_node(CollisionNode("sphere"))
+    sphere.node().add_solid(CollisionSphere(0, 0, 0, 1))
+    sphere.set_pos(0, 10, 0)
+
+    box = root.attach_new_node(CollisionNode("box"))
+    box.node().add_solid(CollisionBox((0, 0, 0), 1, 1, 1))
+    box.set_pos(10, 0, 0)
+    box.set_scale(2)
+
+    poly = root.attach_new_node(CollisionNode("poly"))
+    poly.node().add_solid(CollisionPolygon(Point3(-1, 0, -1), Point3(1, 0, -1),
+                                           Point3(1, 0, 1), Point3(-1, 0, 1)))
+    poly.set_pos(0, -10, 0)
+
+    mesh = CollisionMesh()
+    for point in (Point3(-1, -1, 0), Point3(1, -1, 0), Point3(1, 1, 0), Point3(-1, 1, 0)):
+        mesh.add_vertex(point)
+    mesh.add_triangle(0, 1, 2)
+    mesh.add_triangle(0, 2, 3)
+    mesh_np = root.attach_new_node(CollisionNode("mesh"))
+    mesh_np.node().add_solid(mesh)
+    mesh_np.set_pos(0, 0, 10)
+
+    vdata = GeomVertexData("quad", GeomVertexFormat.get_v3(), Geom.UH_static)
+    vertex = GeomVertexWriter(vdata, "vertex")
+    for point in (Point3(-1, -1, 0), Point3(1, -1, 0), Point3(1, 1, 0), Point3(-1, 1, 0)):
+        vertex.add_data3(point)
+    tris = GeomTriangles(Geom.UH_static)
+    tris.add_vertices(0, 1, 2)
+    tris.add_vertices(0, 2, 3)
+    geom = Geom(vdata)
+    geom.add_primitive(tris)
+    geom_np = root.attach_new_node(GeomNode("geom"))
+    geom_np.node().add_geom(geom)
+    geom_np.set_pos(0, 0, -10)
+
+    return root
+
+
+def test_raycast_batch_solids():
+    root = make_scene()
+    batch = CollisionRayBatch()
+    batch.add_ray((0, 0, 0), (0, 1, 0))
+    batch.add_ray((0, 0, 0), (1, 0, 0))
+    batch.add_ray((0, 0, 0), (0, -1, 0))
+    batch.add_ray((0, 0, 0), (0, 0, 1))
+    batch.add_ray((0, 0, 0), (0, 0, -1))
+    batch.add_ray((0, 0, 0), (-1, 0, 0))
+
+    assert CollisionTraverser().raycast_batch(batch, root) == 5
+    assert batch.num_hits == 5
+
+    assert batch.get_hit_pos(0).almost_equal(Point3(0, 9, 0))
+    assert batch.get_hit_normal(0).almost_equal(Vec3(0, -1, 0))
+    assert batch.get_hit_node_path(0).name == "sphere"
+
+    assert batch.get_hit_pos(1).almost_equal(Point3(8, 0, 0))
+    assert batch.get_hit_normal(1).almost_equal(Vec3(-1, 0, 0))
+    assert batch.get_hit_node_path(1).name == "box"
+
+    assert batch.get_hit_pos(2).almost_equal(Point3(0, -10, 0))
+    assert batch.get_hit_node_path(2).name == "poly"
+
+    assert batch.get_hit_pos(3).almost_equal(Point3(0, 0, 10))
+    assert batch.get_hit_node_path(3).name == "mesh"
+
+    assert batch.get_hit_pos(4).almost_equal(Point3(0, 0, -10))
+    assert batch.get_hit_normal(4).almost_equal(Vec3(0, 0, 1))
+    assert batch.get_hit_node_path(4).name == "geom"
+
+    assert not batch.has_hit(5)
+    assert batch.get_hit_node_path(5).is_empty()
+
+
+def test_raycast_batch_segment():
+    root = make_scene()
+    batch = CollisionRayBatch()
+    batch.add_segment((0, 0, 0), (0, 5, 0))
+    batch.add_segment((0, 0, 0), (0, 15, 0))
+
+    CollisionTraverser().raycast_batch(batch, root)
+    assert not batch.has_hit(0)
+    assert batch.has_hit(1)
+    assert batch.get_hit_t(1) == pytest.approx(0.6)
+
+
+def test_raycast_batch_mask():
+    root = make_scene()
+    batch = CollisionRayBatch()
+    batch.add_ray((0, 0, 0), (0, 1, 0))
+    batch.add_ray((0, 0, 0), (0, 0, -1))
+
+    # Only the visible geometry is considered.
+    CollisionTraverser().raycast_batch(batch, root, GeomNode.get_default_collide_mask())
+    assert not batch.has_hit(0)
+    assert batch.get_hit_node_path(1).name == "geom"
+
+    # Casting again forgets the previous hits.
+    CollisionTraverser().raycast_batch(batch, root, CollideMask.all_off())
+    assert batch.num_hits == 0
+
+
+def test_raycast_batch_like_rays():
+    # Many rays at once should find the same thing as one CollisionRay each.
+    root = make_scene()
+    batch = CollisionRayBatch()
+    for i in range(200):
+        batch.add_ray((0.01 * i - 1, 0.02 * i - 2, 0.5), (0.3, 1, 0.05 * (i % 7) - 0.15))
+
+    CollisionTraverser().raycast_batch(batch, root)
+    for i in range(batch.num_rays):
+        ray = CollisionRay(batch.get_origin(i), batch.get_direction(i))
+        node = CollisionNode("ray")
+        node.add_solid(ray)
+        node.set_from_collide_mask(CollideMask.all_on())
+        node.set_into_collide_mask(0)
+        np_ray = root.attach_new_node(node)
+        trav = CollisionTraverser()
+        queue = CollisionHandlerQueue()
+        trav.add_collider(np_ray, queue)
+        trav.traverse(root)
+        queue.sort_entries()
+        np_ray.remove_node()
+
+        if queue.get_num_entries() == 0:
+            assert not batch.has_hit(i)
+        else:
+            assert batch.has_hit(i)
+            assert batch.get_hit_pos(i).almost_equal(queue.get_entry(0).get_surface_point(root), 0.001)
+
+
+def test_raycast_batch_terrain():
+    # Rays and segments across chunked terrain under a transform, with solids
+    # of each kind scattered over it, rotated and scaled.
+    rand = random.Random(42)
+    size = 30
+    root = NodePath("root")
+    terrain = root.attach_new_node("terrain")
+    terrain.set_pos(0.5, 0, 0)
+    make_terrain_chunks(terrain, size)
+
+    for i in range(40):
+        kind = i % 4
+        if kind == 0:
+            solid = CollisionSphere(0, 0, 0, rand.uniform(0.5, 2))
+        elif kind == 1:
+            solid = CollisionBox((0, 0, 0), rand.uniform(0.5, 2), rand.uniform(0.5, 2), 1)
+        elif kind == 2:
+            solid = CollisionPolygon(Point3(-1, 0, -1), Point3(1, 0, -1),
+                                     Point3(1, 0, 1), Point3(-1, 0, 1))
+        else:
+            solid = CollisionMesh()
+            solid.add_geom(make_terrain(-2, -2, 4))
+        np = root.attach_new_node(CollisionNode("solid"))
+        np.node().add_solid(solid)
+        x = rand.uniform(0, size)
+        y = rand.uniform(0, size)
+        np.set_pos(x, y, get_terrain_height(x, y) + rand.uniform(0, 3))
+        np.set_hpr(rand.uniform(0, 360), rand.uniform(-30, 30), 0)
+        np.set_scale(rand.uniform(0.5, 1.5))
+
+    batch = CollisionRayBatch()
+    for i in range(300):
+        origin = Point3(rand.uniform(0, size), rand.uniform(0, size), rand.uniform(1, 5))
+        direction = Vec3(rand.uniform(-1, 1), rand.uniform(-1, 1), -rand.uniform(0, 1))
+        if i % 3 == 0:
+            batch.add_segment(origin, origin + direction * 5)
+        else:
+            batch.add_ray(origin, direction)
+
+    CollisionTraverser().raycast_batch(batch, root)
+
+    # The same rays, in one traversal with a CollisionRay each.  A
+    # CollisionSegment reports the point closest to the surface of a box it
+    # starts inside, rather than the first point along it, so the segments
+    # are tested as rays, and hits past their ends are ignored.
+    trav = CollisionTraverser()
+    queue = CollisionHandlerQueue()
+    colliders = root.attach_new_node("colliders")
+    for i in range(batch.num_rays):
+        node = CollisionNode("ray")
+        node.add_solid(CollisionRay(batch.get_origin(i), batch.get_direction(i)))
+        node.set_from_collide_mask(CollideMask.all_on())
+        node.set_into_collide_mask(0)
+        node.set_tag("ray", str(i))
+        trav.add_collider(colliders.attach_new_node(node), queue)
+    trav.traverse(root)
+
+    best = {}
+    for entry in queue.get_entries():
+        i = int(entry.get_from_node().get_tag("ray"))
+        pos = entry.get_surface_point(root)
+        dist = (pos - batch.get_origin(i)).length()
+        if i % 3 == 0 and dist > batch.get_direction(i).length():
+            continue
+        if i not in best or dist < best[i][0]:
+            best[i] = (dist, pos)
+
+    # The normals may differ where a ray hits an edge, so only the hit points
+    # are compared.
+    assert len(best) > 0
+    for i in range(batch.num_rays):
+        if i in best:
+            assert batch.has_hit(i)
+            assert batch.get_hit_pos(i).almost_equal(best[i][1], 0.001)
+        else:
+            assert not batch.has_hit(i)
@@ -0,0 +1,102 @@
+from panda3d import core
+from collisions import get_terrain_height, make_terrain_chunks
+import random
+
+
+def make_scene(num_colliders):
+    root = core.NodePath("root")
+
+    targets = root.attach_new_node("targets")
+    targets.set_pos(0, 0, 1)
+    for i in range(20):
+        node = core.CollisionNode("target%d" % i)
+        node.add_solid(core.CollisionSphere(0, 0, 0, 0.5))
+        targets.attach_new_node(node).set_pos(i * 2, 0, 0)
+
+    colliders = []
+    for i in range(num_colliders):
+        node = core.CollisionNode("collider%d" % i)
+        node.add_solid(core.CollisionSphere(0, 0, 0, 0.75))
+        node.set_into_collide_mask(core.BitMask32.bit(1))
+        np = root.attach_new_node(node)
+        np.set_pos(i * 0.4, 0, 1.5)
+        colliders.append(np)
+
+    return root, colliders
+
+
+def make_terrain_scene(num_colliders):
+    # Spheres resting on chunked visible terrain.
+    rand = random.Random(42)
+    size = 40
+    root = core.NodePath("root")
+    make_terrain_chunks(root.attach_new_node("terrain"), size)
+
+    colliders = []
+    for i in range(num_colliders):
+        node = core.CollisionNode("collider%d" % i)
+        node.add_solid(core.CollisionSphere(0, 0, 0, 0.5))
+        node.set_from_collide_mask(core.GeomNode.get_default_collide_mask())
+        node.set_into_collide_mask(0)
+        np = root.attach_new_node(node)
+        x = rand.uniform(0, size)
+        y = rand.uniform(0, size)
+        np.set_pos(x, y, get_terrain_height(x, y) + rand.uniform(-0.5, 0.5))
+        colliders.append(np)
+
+    return root, colliders
+
+
+def collect(trav, queue, root):
+    trav.traverse(root)
+    return [(entry.get_from_node_path().get_name(),
+             entry.get_into_node_path().get_name(),
+             tuple(entry.get_surface_point(root)))
+            for entry in queue.get_entries()]
+
+
+def check_threads(use_broadphase):
+    # More colliders than fit in a single pass of the usual traverser.
+    root, colliders = make_scene(100)
+    check_scene_threads(root, colliders, use_broadphase)
+
+
+def check_scene_threads(root, colliders, use_broadphase):
+    queue = core.CollisionHandlerQueue()
+    trav = core.CollisionTraverser()
+    trav.use_broadphase = use_broadphase
+    for np in colliders:
+        trav.add_collider(np, queue)
+
+    expected = collect(trav, queue, root)
+    assert len(expected) > 0
+
+    page = core.load_prc_file_data("", "collision-threads 2")
+    try:
+        # The entries must arrive in the same order as without threads.
+        assert collect(trav, queue, root) == expected
+
+        colliders[0].set_x(38)
+        result = collect(trav, queue, root)
+    finally:
+        core.unload_prc_file(page)
+
+    assert collect(trav, queue, root) == result
+
+
+def test_traverser_threads():
+    check_threads(False)
+
+
+def test_traverser_threads_broadphase():
+    check_threads(True)
+
+
+def test_traverser_threads_terrain():
+    root, colliders = make_terrain_scene(200)
+    check_scene_threads(root, colliders, False)
+
+
+def test_traverser_threads_terrain_broadphase():
+    root, colliders = make_terrain_scene(200)
+    check_scene_threads(root, colliders, True)
@@ -75,3 +75,64 @@ def gsg(graphics_pipe, graphics_engine):
 
     if buffer is not None:
         graphics_engine.remove_window(buffer)
+
+
+@pytest.fixture(scope='module')
+def region(graphics_pipe):
+    """Returns a DisplayRegion on a 32x32 offscreen buffer, which is cleared
+    to black, for rendering small test scenes."""
+    from panda3d.core import GraphicsEngine, GraphicsPipe, FrameBufferProperties, WindowProperties
+
+    engine = GraphicsEngine()
+    engine.set_threading_model("")
+
+    fbprops = FrameBufferProperties()
+    fbprops.force_hardware = True
+    fbprops.set_rgba_bits(8, 8, 8, 8)
+
+    buffer = engine.make_output(
+        graphics_pipe,
+        'buffer',
+        0,
+        fbprops,
+        WindowProperties.size(32, 32),
+        GraphicsPipe.BF_refuse_window
+    )
+    engine.open_windows()
+
+    if buffer is None:
+        pytest.skip("GraphicsPipe cannot make offscreen buffers")
+
+    buffer.set_clear_color_active(True)
+    buffer.set_clear_color((0, 0, 0, 1))
+
+    yield buffer.make_display_region()
+
+    if buffer is not None:
+        engine.remove_window(buffer)
+
+
+@pytest.fixture
+def render_to_ram(region):
+    """Returns a function that renders a frame of the region's buffer from the
+    given camera, and returns the contents of its color buffer, in BGRA order.
+    It makes sure that something was drawn at all, so that comparing two
+    images means something."""
+    from panda3d.core import GraphicsOutput, Texture
+
+    def render(camera):
+        region.active = True
+        region.camera = camera
+
+        texture = Texture("color")
+        region.window.add_render_texture(texture,
+                                         GraphicsOutput.RTM_copy_ram,
+                                         GraphicsOutput.RTP_color)
+        region.window.engine.render_frame()
+        region.window.clear_render_textures()
+
+        data = texture.get_ram_image().get_data()
+        assert any(data[2::4])
+        return data
+
+    return render
@@ -0,0 +1,56 @@
+from panda3d import core
+import pytest
+import random
+
+
+def make_scene():
+    # Groups of overlapping cards, some of them partly or entirely outside
+    # the frustum, and some groups with several Geoms in one GeomNode.  Each
+    # card has its own color, and they are drawn in the unsorted bin without
+    # a depth test, so a card that is wrongly culled changes the image.
+    rand = random.Random(2)
+    scene = core.NodePath("root")
+    scene.set_bin("unsorted", 0)
+    scene.set_depth_test(False)
+    scene.set_depth_write(False)
+
+    for i in range(12):
+        group = scene.attach_new_node("group%d" % i)
+        group.set_pos(rand.uniform(-1.5, 1.5), 0, rand.uniform(-1.5, 1.5))
+        gnode = core.GeomNode("geoms")
+        for j in range(12):
+            cm = core.CardMaker("card")
+            x = rand.uniform(-1, 0.8)
+            z = rand.uniform(-1, 0.8)
+            cm.set_frame(x, x + 0.2, z, z + 0.2)
+            cm.set_color(rand.random(), rand.random(), rand.random(), 1)
+            card = group.attach_new_node(cm.generate())
+            if j % 3 == 0:
+                gnode.add_geoms_from(card.node())
+        group.attach_new_node(gnode)
+
+    camera = scene.attach_new_node(core.Camera("camera"))
+    camera.set_y(-5)
+    lens = core.OrthographicLens()
+    lens.set_film_size(2, 2)
+    camera.node().set_lens(lens)
+    return scene, camera
+
+
+def render_image(render_to_ram, camera, threshold):
+    var = core.ConfigVariableInt("cull-batch-threshold")
+    orig = var.value
+    var.value = threshold
+    try:
+        return render_to_ram(camera)
+    finally:
+        var.value = orig
+
+
+@pytest.mark.parametrize("threshold", [1, 4, 12])
+def test_cull_batch_matches_scalar(render_to_ram, threshold):
+    scene, camera = make_scene()
+
+    # A threshold of 0 tests each node against the frustum separately.
+    expected = render_image(render_to_ram, camera, 0)
+    assert render_image(render_to_ram, camera, threshold) == expected
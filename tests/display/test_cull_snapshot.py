@@ -0,0 +1,105 @@
+from panda3d import core
+import pytest
+
+
+class Scene:
+    # Four cards in a grid under either a CullSnapshotNode or a plain
+    # PandaNode, and a fifth one that starts out of view.
+    def __init__(self, node):
+        self.root = core.NodePath("root")
+        self.group = self.root.attach_new_node(node)
+        self.cards = []
+        for i, (x, z) in enumerate(((-1, -1), (0, -1), (-1, 0), (0, 0), (5, 5))):
+            cm = core.CardMaker("card%d" % i)
+            cm.set_frame(0.1, 0.9, 0.1, 0.9)
+            cm.set_color(1, 1, 1, 1)
+            card = self.group.attach_new_node("holder%d" % i).attach_new_node(cm.generate())
+            card.set_pos(x, 0, z)
+            self.cards.append(card)
+
+        self.camera = self.root.attach_new_node(core.Camera("camera"))
+        self.camera.set_y(-5)
+        lens = core.OrthographicLens()
+        lens.set_film_size(2, 2)
+        self.camera.node().set_lens(lens)
+
+
+def move_card(scene):
+    # Brings the hidden card into view, over one of the others.
+    scene.cards[4].set_pos(-0.5, 0, -0.5)
+    scene.cards[4].set_color_scale(1, 0, 0, 1)
+
+
+def move_holder(scene):
+    # Moves the parent of a card, rather than the card itself.
+    scene.cards[0].get_parent().set_pos(1, 0, 1)
+
+
+def recolor_card(scene):
+    scene.cards[1].set_color_scale(0, 1, 0, 1)
+
+
+def hide_card(scene):
+    scene.cards[2].hide()
+
+
+def remove_card(scene):
+    scene.cards[3].get_parent().remove_node()
+
+
+def add_card(scene):
+    cm = core.CardMaker("new")
+    cm.set_frame(-0.2, 0.2, -0.2, 0.2)
+    cm.set_color(0, 0, 1, 1)
+    scene.cards[2].get_parent().attach_new_node(cm.generate())
+
+
+def reshape_card(scene):
+    # Moves the vertices of the hidden card into view, which changes its
+    # bounds without changing any transform.
+    geom = scene.cards[4].node().modify_geom(0)
+    vertex = core.GeomVertexRewriter(geom.modify_vertex_data(), "vertex")
+    while not vertex.is_at_end():
+        x, y, z = vertex.get_data3()
+        vertex.set_data3(x - 5.5, y, z - 5.5)
+
+
+@pytest.mark.parametrize("change", [move_card, move_holder, recolor_card,
+                                    hide_card, remove_card, add_card,
+                                    reshape_card])
+def test_cull_snapshot_invalidate(render_to_ram, change):
+    snapshot = Scene(core.CullSnapshotNode("snapshot"))
+    plain = Scene(core.PandaNode("plain"))
+    before = render_to_ram(plain.camera)
+    assert render_to_ram(snapshot.camera) == before
+
+    # After the change, the snapshot must draw the same thing as the plain
+    # scene graph does, rather than what was there before.
+    change(snapshot)
+    change(plain)
+    expected = render_to_ram(plain.camera)
+    assert expected != before
+    assert render_to_ram(snapshot.camera) == expected
+
+
+@pytest.mark.parametrize("node_type", [core.CullSnapshotNode, core.PandaNode])
+def test_cull_snapshot_node_path(render_to_ram, node_type):
+    # A node that the snapshot cannot flatten is traversed normally, and must
+    # see its full NodePath, including the flattened nodes above it.
+    scene = Scene(node_type("group"))
+    inner = scene.cards[0].get_parent().attach_new_node("inner")
+    inner.set_z(0.5)
+
+    paths = []
+
+    def callback(data):
+        paths.append(data.get_data().get_node_path())
+        data.upcall()
+
+    callback_node = core.CallbackNode("callback")
+    callback_node.set_cull_callback(core.PythonCallbackObject(callback))
+    callback_np = inner.attach_new_node(callback_node)
+
+    render_to_ram(scene.camera)
+    assert paths == [callback_np]
+    assert paths[0].get_net_transform() == callback_np.get_net_transform()
@@ -0,0 +1,61 @@
+from panda3d import core
+import pytest
+import random
+
+
+def make_scene():
+    # Many overlapping quads, each with its own color, spread over several
+    # levels of the scene graph.  They are drawn in the unsorted bin without
+    # a depth test, so the image depends on the order in which they are
+    # culled.
+    rand = random.Random(1)
+    scene = core.NodePath("root")
+    scene.set_bin("unsorted", 0)
+    scene.set_depth_test(False)
+    scene.set_depth_write(False)
+
+    for i in range(8):
+        group = scene.attach_new_node("group%d" % i)
+        for j in range(8):
+            subgroup = group.attach_new_node("subgroup%d" % j)
+            for k in range(4):
+                cm = core.CardMaker("card")
+                x = rand.uniform(-1, 0.5)
+                z = rand.uniform(-1, 0.5)
+                cm.set_frame(x, x + 0.5, z, z + 0.5)
+                cm.set_color(rand.random(), rand.random(), rand.random(), 1)
+                subgroup.attach_new_node(cm.generate())
+
+    camera = scene.attach_new_node(core.Camera("camera"))
+    camera.set_y(-5)
+    lens = core.OrthographicLens()
+    lens.set_film_size(2, 2)
+    camera.node().set_lens(lens)
+    return scene, camera
+
+
+def render_image(render_to_ram, camera, num_threads):
+    var = core.ConfigVariableInt("cull-threads")
+    orig = var.value
+    var.value = num_threads
+    try:
+        return render_to_ram(camera)
+    finally:
+        var.value = orig
+
+
+@pytest.mark.parametrize("depth", [1, 2, 3])
+def test_cull_threads_order(render_to_ram, depth):
+    scene, camera = make_scene()
+
+    var = core.ConfigVariableInt("cull-parallel-depth")
+    orig = var.value
+    var.value = depth
+    try:
+        expected = render_image(render_to_ram, camera, 0)
+
+        # Changing the number of threads between frames replaces the pool.
+        for num_threads in (2, 4, 1):
+            assert render_image(render_to_ram, camera, num_threads) == expected
+    finally:
+        var.value = orig
@@ -0,0 +1,120 @@
+from panda3d import core
+import pytest
+
+
+@pytest.fixture
+def batching():
+    var = core.ConfigVariableBool("dynamic-batching")
+    orig = var.value
+    yield var
+    var.value = orig
+
+
+def make_card(color):
+    # CardMaker applies its color as a state, which would keep the cards from
+    # being batched, so we store it in the vertices instead.
+    vdata = core.GeomVertexData("card", core.GeomVertexFormat.get_v3c4(), core.Geom.UH_static)
+    vertex = core.GeomVertexWriter(vdata, "vertex")
+    rgba = core.GeomVertexWriter(vdata, "color")
+    for x, z in ((0, 0), (0.25, 0), (0.25, 0.25), (0, 0.25)):
+        vertex.add_data3(x, 0, z)
+        rgba.add_data4(color)
+
+    tris = core.GeomTriangles(core.Geom.UH_static)
+    tris.add_vertices(0, 1, 2)
+    tris.add_vertices(0, 2, 3)
+    geom = core.Geom(vdata)
+    geom.add_primitive(tris)
+
+    node = core.GeomNode("card")
+    node.add_geom(geom)
+    return node
+
+
+def make_scene():
+    # A grid of small cards, each with its own transform, in two different
+    # states.  The buffer is 32 pixels wide and the film 2 units, so that all
+    # edges fall on pixel boundaries and the image does not depend on how
+    # the vertices were transformed.
+    scene = core.NodePath("root")
+    cards = []
+    for i in range(16):
+        card = scene.attach_new_node(make_card((1, (i % 4) / 4.0, (i // 4) / 4.0, 1)))
+        card.set_pos(-0.875 + (i % 4) * 0.5, 0, -0.875 + (i // 4) * 0.5)
+        if i % 3 == 0:
+            card.set_r(90)
+            card.set_z(card.get_z() + 0.25)
+        if i % 5 == 0:
+            card.set_scale(0.5)
+        if i % 2 == 0:
+            card.set_color_scale(0.5, 1, 1, 1)
+        cards.append(card)
+
+    camera = scene.attach_new_node(core.Camera("camera"))
+    camera.set_y(-5)
+    lens = core.OrthographicLens()
+    lens.set_film_size(2, 2)
+    camera.node().set_lens(lens)
+    return scene, camera, cards
+
+
+def test_dynamic_batching_matches(render_to_ram, batching):
+    scene, camera, cards = make_scene()
+
+    batching.value = False
+    expected = render_to_ram(camera)
+
+    # The batches are built on the second frame; each frame must look the
+    # same as without batching.
+    batching.value = True
+    for i in range(3):
+        assert render_to_ram(camera) == expected
+
+
+def test_dynamic_batching_camera_moves(render_to_ram, batching):
+    scene, camera, cards = make_scene()
+    core.CullBatchCache.clear_cache()
+
+    # There is one batch for each of the two states.
+    batching.value = True
+    for i in range(3):
+        render_to_ram(camera)
+    num_entries = core.CullBatchCache.get_num_entries()
+    assert num_entries == 2
+    assert core.CullBatchCache.get_num_batches() == num_entries
+
+    # Moving the camera so that half of the cards are culled must only change
+    # which of the cards are drawn, not cause new batches to be made.
+    camera.set_x(1)
+    batching.value = False
+    expected = render_to_ram(camera)
+
+    batching.value = True
+    for i in range(3):
+        assert render_to_ram(camera) == expected
+        assert core.CullBatchCache.get_num_entries() == num_entries
+        assert core.CullBatchCache.get_num_batches() == num_entries
+
+
+def test_dynamic_batching_changes(render_to_ram, batching):
+    scene, camera, cards = make_scene()
+
+    batching.value = True
+    for i in range(3):
+        render_to_ram(camera)
+
+    # Moving a card, changing the state of another and modifying the vertex
+    # data of a third must not leave the old batches in use.
+    cards[5].set_x(cards[5].get_x() + 0.125)
+    cards[6].set_color_scale(1, 1, 0.5, 1)
+    vdata = cards[7].node().modify_geom(0).modify_vertex_data()
+    color = core.GeomVertexWriter(vdata, "color")
+    while not color.is_at_end():
+        color.set_data4(0, 1, 0, 1)
+
+    batching.value = False
+    expected = render_to_ram(camera)
+
+    batching.value = True
+    for i in range(3):
+        assert render_to_ram(camera) == expected
@@ -0,0 +1,118 @@
+from panda3d import core
+import pytest
+
+
+VERT_TEMPLATE = """#version 150
+uniform mat4 p3d_ModelViewProjectionMatrix;
+in vec4 p3d_Vertex;
+in vec4 p3d_Color;
+{inputs}
+out vec4 color;
+void main() {{
+  gl_Position = p3d_ModelViewProjectionMatrix * ({position});
+  color = p3d_Color;
+}}
+"""
+
+FRAG = """#version 150
+in vec4 color;
+out vec4 p3d_FragColor;
+void main() {
+  p3d_FragColor = color;
+}
+"""
+
+# The position, roll and scale of each instance.  They are chosen so that all
+# edges fall on pixel boundaries, so the image does not depend on how the
+# vertices were transformed.  The last one is out of view.
+INSTANCES = [
+    ((-0.875, 0, -0.875), 0, 1),
+    ((-0.375, 0, -0.5), 90, 2),
+    ((0.125, 0, 0), 180, 1),
+    ((0.5, 0, 0.375), 270, 0.5),
+    ((-0.5, 0, 0.5), 0, 2),
+    ((5, 0, 5), 0, 1),
+]
+
+
+def make_transform(pos, roll, scale):
+    return core.TransformState.make_pos_hpr_scale(pos, (0, 0, roll), (scale, scale, scale))
+
+
+class Scene:
+    # Renders a card at each of the INSTANCES, either as the instances of an
+    # InstancedNode with a shader that applies p3d_InstanceMatrix, or as
+    # separate copies of the card.  There is a transform between each
+    # instance and the card, which is folded into the instance matrices.
+    def __init__(self, instanced):
+        self.root = core.NodePath("root")
+
+        maker = core.CardMaker("card")
+        maker.set_frame(0, 0.25, 0, 0.25)
+        maker.set_color(1, 0, 0, 1)
+        card = maker.generate()
+
+        if instanced:
+            self.node = core.InstancedNode("instanced")
+            for pos, roll, scale in INSTANCES:
+                self.node.add_instance(make_transform(pos, roll, scale))
+            self.copies = [self.root.attach_new_node(self.node)]
+            vert = VERT_TEMPLATE.format(inputs="in mat4 p3d_InstanceMatrix;",
+                                        position="p3d_InstanceMatrix * p3d_Vertex")
+        else:
+            self.node = None
+            self.copies = []
+            for pos, roll, scale in INSTANCES:
+                copy = self.root.attach_new_node("copy")
+                copy.set_transform(make_transform(pos, roll, scale))
+                self.copies.append(copy)
+            vert = VERT_TEMPLATE.format(inputs="", position="p3d_Vertex")
+
+        for copy in self.copies:
+            holder = copy.attach_new_node("holder")
+            holder.set_pos(0.125, 0, 0.25)
+            holder.attach_new_node(card)
+
+        self.root.set_shader(core.Shader.make(core.Shader.SL_GLSL, vert, FRAG))
+
+        self.camera = self.root.attach_new_node(core.Camera("camera"))
+        self.camera.set_y(-5)
+        lens = core.OrthographicLens()
+        lens.set_film_size(2, 2)
+        self.camera.node().set_lens(lens)
+
+    def set_instance_transform(self, n, transform):
+        if self.node is not None:
+            self.node.set_instance_transform(n, transform)
+        else:
+            self.copies[n].set_transform(transform)
+
+
+def test_instancednode_matches_copies(region, render_to_ram):
+    gsg = region.window.gsg
+    if not gsg.supports_glsl or not gsg.supports_geometry_instancing:
+        pytest.skip("instanced GLSL rendering not supported")
+
+    # If the ShaderAttrib did not carry the number of instances, or the
+    # instance array did not reach p3d_InstanceMatrix, the instanced cards
+    # would be missing or misplaced.
+    copies = Scene(False)
+    instanced = Scene(True)
+    still = render_to_ram(copies.camera)
+    for i in range(2):
+        assert render_to_ram(instanced.camera) == still
+
+    # Moving the camera culls some of the instances, which must leave the
+    # others where they were.
+    for scene in (copies, instanced):
+        scene.camera.set_x(1)
+    expected = render_to_ram(copies.camera)
+    assert render_to_ram(instanced.camera) == expected
+
+    # A new instance transform must replace the cached instance array.
+    for scene in (copies, instanced):
+        scene.camera.set_x(0)
+        scene.set_instance_transform(0, make_transform((0.5, 0, -0.5), 90, 1))
+    moved = render_to_ram(copies.camera)
+    assert moved != still
+    assert render_to_ram(instanced.camera) == moved
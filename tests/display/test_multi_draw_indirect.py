@@ -0,0 +1,164 @@
+from panda3d import core
+import pytest
+
+
+def make_fans(indexed):
+    # Four separate quads, each drawn as a triangle fan, with a different
+    # color in each corner of the screen.
+    vdata = core.GeomVertexData("fans", core.GeomVertexFormat.get_v3c4(), core.Geom.UH_static)
+    vertex = core.GeomVertexWriter(vdata, "vertex")
+    color = core.GeomVertexWriter(vdata, "color")
+    fans = core.GeomTrifans(core.Geom.UH_static)
+
+    corners = [(-1, -1, (1, 0, 0, 1)), (0, -1, (0, 1, 0, 1)),
+               (-1, 0, (0, 0, 1, 1)), (0, 0, (1, 1, 0, 1))]
+    for i, (x, z, rgba) in enumerate(corners):
+        for dx, dz in ((0.1, 0.1), (0.9, 0.1), (0.9, 0.9), (0.1, 0.9)):
+            vertex.add_data3(x + dx, 0, z + dz)
+            color.add_data4(rgba)
+        fans.add_consecutive_vertices(i * 4, 4)
+        fans.close_primitive()
+
+    if indexed:
+        fans.make_indexed()
+    assert fans.is_indexed() == indexed
+    geom = core.Geom(vdata)
+    geom.add_primitive(fans)
+    gnode = core.GeomNode("fans")
+    gnode.add_geom(geom)
+    return gnode
+
+
+def make_quad(kind, first):
+    if kind == "lines":
+        prim = core.GeomLines(core.Geom.UH_static)
+        for i in range(4):
+            prim.add_vertices(first + i, first + (i + 1) % 4)
+    else:
+        prim = core.GeomTriangles(core.Geom.UH_static)
+        prim.add_vertices(first, first + 1, first + 2)
+        prim.add_vertices(first, first + 2, first + 3)
+    return prim
+
+
+def make_run(kind, usage=core.Geom.UH_static, num_padding_rows=0):
+    # Four quads, one in each corner of the screen, which share the same
+    # vertex data, state and transform, but each have a Geom of their own.
+    # The state-sorted bin hands them to the GSG together, which draws them
+    # with one multi-draw call if the primitives are compatible.  In the
+    # "mixed" case, one of them has a different index type, so they have to
+    # be drawn one at a time after all.  Unused rows may be added to make the
+    # vertex data larger.
+    vdata = core.GeomVertexData("run", core.GeomVertexFormat.get_v3c4(), usage)
+    vertex = core.GeomVertexWriter(vdata, "vertex")
+    color = core.GeomVertexWriter(vdata, "color")
+
+    corners = [(-1, -1, (1, 0, 0, 1)), (0, -1, (0, 1, 0, 1)),
+               (-1, 0, (0, 0, 1, 1)), (0, 0, (1, 1, 0, 1))]
+    gnode = core.GeomNode("run")
+    for i, (x, z, rgba) in enumerate(corners):
+        for dx, dz in ((0.125, 0.125), (0.875, 0.125), (0.875, 0.875), (0.125, 0.875)):
+            vertex.add_data3(x + dx, 0, z + dz)
+            color.add_data4(rgba)
+
+        prim = make_quad(kind, i * 4)
+        if kind == "mixed" and i == 2:
+            prim.set_index_type(core.GeomEnums.NT_uint32)
+        geom = core.Geom(vdata)
+        geom.add_primitive(prim)
+        gnode.add_geom(geom)
+
+    for i in range(num_padding_rows):
+        vertex.add_data3(0, 0, 0)
+        color.add_data4(0, 0, 0, 0)
+
+    return gnode
+
+
+def get_section_size():
+    # The stream buffer is divided into three sections, each rounded down to
+    # a multiple of 256 bytes.
+    return core.ConfigVariableInt("gl-stream-buffer-size").value // 3 // 256 * 256
+
+
+def make_camera(gnode):
+    scene = core.NodePath("root")
+    camera = scene.attach_new_node(core.Camera("camera"))
+    lens = core.OrthographicLens()
+    lens.set_film_size(2, 2)
+    lens.set_near_far(-10, 10)
+    camera.node().set_lens(lens)
+
+    scene.attach_new_node(gnode)
+    return camera
+
+
+def render_image(render_to_ram, camera, multi_draw_indirect):
+    var = core.ConfigVariableBool("gl-multi-draw-indirect")
+    orig = var.value
+    var.value = multi_draw_indirect
+    try:
+        return render_to_ram(camera)
+    finally:
+        var.value = orig
+
+
+@pytest.mark.parametrize("indexed", [False, True], ids=["arrays", "elements"])
+def test_multi_draw_indirect_fans(render_to_ram, indexed):
+    camera = make_camera(make_fans(indexed))
+    expected = render_image(render_to_ram, camera, False)
+    assert render_image(render_to_ram, camera, True) == expected
+
+
+@pytest.mark.parametrize("kind", ["triangles", "lines", "mixed"])
+def test_multi_draw_indirect_run(render_to_ram, kind):
+    gnode = make_run(kind)
+    camera = make_camera(gnode)
+    expected = render_image(render_to_ram, camera, False)
+    for i in range(2):
+        assert render_image(render_to_ram, camera, True) == expected
+
+    # Replacing the index data of one of the Geoms must not leave the old
+    # indices in use.
+    gnode.modify_geom(1).set_primitive(0, make_quad(kind, 12))
+    moved = render_image(render_to_ram, camera, False)
+    assert moved != expected
+    assert render_image(render_to_ram, camera, True) == moved
+
+
+@pytest.mark.parametrize("fraction", [0.9, 1.5])
+def test_multi_draw_indirect_stream(render_to_ram, fraction):
+    # The vertex data is streamed into the same buffer as the index data and
+    # commands.  Make it take up most of a section of that buffer, or more
+    # than a section, so that it does not fit together with the indices.
+    section_size = get_section_size()
+    stride = core.GeomVertexFormat.get_v3c4().get_array(0).get_stride()
+    num_rows = int(section_size * fraction) // stride
+
+    camera = make_camera(make_run("triangles", core.Geom.UH_stream, num_rows))
+    expected = render_image(render_to_ram, camera, False)
+    for i in range(2):
+        assert render_image(render_to_ram, camera, True) == expected
+
+
+def test_multi_draw_indirect_stream_wrap(render_to_ram):
+    # Streaming a different copy of the vertex data every frame goes around
+    # the stream buffer several times.  The index data and commands written
+    # after each wrap must still be aligned, or the multi-draw call fails.
+    stride = core.GeomVertexFormat.get_v3c4().get_array(0).get_stride()
+    num_rows = int(get_section_size() * 0.4) // stride + 1
+
+    gnode = make_run("triangles", core.Geom.UH_stream, num_rows)
+    camera = make_camera(gnode)
+    expected = render_image(render_to_ram, camera, False)
+
+    for i in range(8):
+        # Changing one of the unused rows makes it a new array, which is
+        # copied into the stream buffer again.
+        vdata = core.GeomVertexData(gnode.get_geom(0).get_vertex_data())
+        vertex = core.GeomVertexWriter(vdata, "vertex")
+        vertex.set_row(vdata.get_num_rows() - 1)
+        vertex.set_data3(i, 0, 0)
+        for gi in range(gnode.get_num_geoms()):
+            gnode.modify_geom(gi).set_vertex_data(vdata)
+        assert render_image(render_to_ram, camera, True) == expected
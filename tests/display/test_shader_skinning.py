@@ -0,0 +1,104 @@
+from panda3d import core
+import pytest
+
+
+def make_format():
+    array = core.GeomVertexArrayFormat()
+    array.add_column("vertex", 3, core.Geom.NT_float32, core.Geom.C_point)
+    blend_array = core.GeomVertexArrayFormat()
+    blend_array.add_column("transform_blend", 1, core.Geom.NT_uint16, core.Geom.C_index)
+    format = core.GeomVertexFormat()
+    format.add_array(array)
+    format.add_array(blend_array)
+    anim = core.GeomVertexAnimationSpec()
+    anim.set_panda()
+    format.set_animation(anim)
+    return core.GeomVertexFormat.register_format(format)
+
+
+class Scene:
+    # A row of cards whose bottom edges are bound to a fixed transform and
+    # whose top edges follow a joint.  The middle vertices are blended evenly
+    # between the two.  There is one extra transform for each of num_extra,
+    # which are not used by any vertex but take up room in the table.
+    def __init__(self, num_extra=0):
+        self.root = core.NodePath("root")
+        self.root.set_shader_auto()
+        self.root.set_color(1, 0, 0, 1)
+
+        base = core.UserVertexTransform("base")
+        self.joint = core.UserVertexTransform("joint")
+        table = core.TransformBlendTable()
+        bottom = table.add_blend(core.TransformBlend(base, 1.0))
+        middle = table.add_blend(core.TransformBlend(base, 0.5, self.joint, 0.5))
+        top = table.add_blend(core.TransformBlend(self.joint, 1.0))
+        for i in range(num_extra):
+            table.add_blend(core.TransformBlend(core.UserVertexTransform("extra%d" % i), 1.0))
+
+        vdata = core.GeomVertexData("cards", make_format(), core.Geom.UH_static)
+        vertex = core.GeomVertexWriter(vdata, "vertex")
+        blend = core.GeomVertexWriter(vdata, "transform_blend")
+        tris = core.GeomTriangles(core.Geom.UH_static)
+        for i in range(4):
+            x = -0.875 + i * 0.5
+            for z, index in ((-0.75, bottom), (0, middle), (0.5, top)):
+                vertex.add_data3(x, 0, z)
+                vertex.add_data3(x + 0.25, 0, z)
+                blend.add_data1i(index)
+                blend.add_data1i(index)
+            first = i * 6
+            for row in range(2):
+                v = first + row * 2
+                tris.add_vertices(v, v + 1, v + 3)
+                tris.add_vertices(v, v + 3, v + 2)
+
+        table.set_rows(core.SparseArray.lower_on(vdata.get_num_rows()))
+        vdata.set_transform_blend_table(table)
+
+        geom = core.Geom(vdata)
+        geom.add_primitive(tris)
+        node = core.GeomNode("cards")
+        node.add_geom(geom)
+        self.root.attach_new_node(node)
+
+        self.camera = self.root.attach_new_node(core.Camera("camera"))
+        self.camera.set_y(-5)
+        lens = core.OrthographicLens()
+        lens.set_film_size(2, 2)
+        self.camera.node().set_lens(lens)
+
+
+def render_image(render_to_ram, scene, shader_skinning):
+    # The vertex data is only munged the first time it is rendered, so each
+    # Scene must be rendered with the same setting every time.
+    hardware = core.ConfigVariableBool("hardware-animated-vertices")
+    auto = core.ConfigVariableBool("auto-shader-skinning")
+    orig_hardware = hardware.value
+    orig_auto = auto.value
+    hardware.value = False
+    auto.value = shader_skinning
+    try:
+        return render_to_ram(scene.camera)
+    finally:
+        hardware.value = orig_hardware
+        auto.value = orig_auto
+
+
+@pytest.mark.parametrize("num_extra", [0, 200])
+def test_shader_skinning_matches_cpu(render_to_ram, num_extra):
+    # With 200 extra transforms, the table no longer fits in the generated
+    # shader's matrix palette, so the vertices are animated on the CPU.  The
+    # image must be the same either way.  All positions are multiples of a
+    # pixel, so the result does not depend on where the blending happens.
+    cpu = Scene(num_extra)
+    shader = Scene(num_extra)
+    still = render_image(render_to_ram, cpu, False)
+    assert render_image(render_to_ram, shader, True) == still
+
+    # Moving the joint must update the matrices used by the shader.
+    for pos in ((0.125, 0, 0.25), (-0.25, 0, -0.125), (0, 0, 0)):
+        cpu.joint.set_matrix(core.LMatrix4.translate_mat(pos))
+        shader.joint.set_matrix(core.LMatrix4.translate_mat(pos))
+        expected = render_image(render_to_ram, cpu, False)
+        assert (expected != still) == (pos != (0, 0, 0))
+        assert render_image(render_to_ram, shader, True) == expected
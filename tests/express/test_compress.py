@@ -0,0 +1,82 @@
+from panda3d import core
+import struct
+import pytest
+
+
+ZSTD_MAGIC = b'\x28\xb5\x2f\xfd'
+
+
+def make_vertex_bytes(num_rows=2000):
+    # A grid of vertices with normals, as a stand-in for a vertex data page.
+    data = bytearray()
+    for i in range(num_rows):
+        data += struct.pack('<6f', i % 50, i // 50, 0.0, 0.0, 0.0, 1.0)
+    return bytes(data)
+
+
+@pytest.mark.parametrize("algorithm", ["none", "zlib", "lz4", "zstd"])
+def test_compress_buffer(algorithm):
+    algorithm = getattr(core, "CA_" + algorithm)
+    if not core.is_compression_algorithm_available(algorithm):
+        pytest.skip("compression algorithm not available")
+
+    data = make_vertex_bytes()
+    compressed = core.compress_buffer(algorithm, data, 6)
+    assert len(compressed) > 0
+    if algorithm != core.CA_none:
+        assert len(compressed) < len(data)
+
+    assert core.decompress_buffer(algorithm, compressed, len(data)) == data
+
+    # The size of the original data must be given exactly.
+    assert core.decompress_buffer(algorithm, compressed, len(data) + 1) == b''
+
+
+def test_compress_file_zstd(tmp_path):
+    if not core.is_compression_algorithm_available(core.CA_zstd):
+        pytest.skip("Zstandard not available")
+
+    vfs = core.VirtualFileSystem.get_global_ptr()
+    filename = core.Filename.from_os_specific(str(tmp_path / "test.dat.pz"))
+    data = make_vertex_bytes()
+
+    page = core.load_prc_file_data("", "file-compression-algorithm zstd")
+    try:
+        assert vfs.write_file(filename, data, True)
+    finally:
+        core.unload_prc_file(page)
+
+    with open(str(tmp_path / "test.dat.pz"), 'rb') as fh:
+        assert fh.read(4) == ZSTD_MAGIC
+
+    # It is recognized when reading regardless of file-compression-algorithm.
+    assert vfs.read_file(filename, True) == data
+
+
+def test_compress_multifile_zstd(tmp_path):
+    if not core.is_compression_algorithm_available(core.CA_zstd):
+        pytest.skip("Zstandard not available")
+
+    source = tmp_path / "vertices.dat"
+    data = make_vertex_bytes()
+    source.write_bytes(data)
+    mf_filename = core.Filename.from_os_specific(str(tmp_path / "test.mf"))
+
+    page = core.load_prc_file_data("", "file-compression-algorithm zstd")
+    try:
+        mf = core.Multifile()
+        assert mf.open_read_write(mf_filename)
+        mf.add_subfile("vertices.dat", core.Filename.from_os_specific(str(source)), 6)
+        assert mf.flush()
+        mf.close()
+    finally:
+        core.unload_prc_file(page)
+
+    mf = core.Multifile()
+    assert mf.open_read(mf_filename)
+    index = mf.find_subfile("vertices.dat")
+    assert index >= 0
+    assert mf.is_subfile_compressed(index)
+    assert mf.get_subfile_internal_length(index) < len(data)
+    assert mf.read_subfile(index) == data
+    mf.close()
@@ -82,3 +82,28 @@ def test_geom_calc_box_bounds():
     assert isinstance(bounds, core.BoundingBox)
     assert bounds.get_min() == (1, 1, 1)
     assert bounds.get_max() == (1, 1, 2)
+
+
+def test_geom_optimize_vertex_fetch():
+    vertex_data = core.GeomVertexData("", core.GeomVertexFormat.get_v3(), core.GeomEnums.UH_static)
+    vertex_data.set_num_rows(6)
+    vertex = core.GeomVertexWriter(vertex_data, "vertex")
+    for i in range(6):
+        vertex.set_data3(i, 0, 0)
+
+    prim = core.GeomTriangles(core.GeomEnums.UH_static)
+    prim.add_vertices(5, 3, 4)
+    prim.add_vertices(4, 3, 1)
+
+    geom = core.Geom(vertex_data)
+    geom.add_primitive(prim)
+    geom.optimize_vertex_fetch_in_place()
+
+    # Rows are renumbered in order of first use, and row 0 and 2 are dropped.
+    prim = geom.get_primitive(0)
+    assert tuple(prim.get_vertex_list()) == (0, 1, 2, 2, 1, 3)
+
+    vertex_data = geom.get_vertex_data()
+    assert vertex_data.get_num_rows() == 4
+    reader = core.GeomVertexReader(vertex_data, "vertex")
+    assert [reader.get_data3().x for i in range(4)] == [5, 3, 4, 1]
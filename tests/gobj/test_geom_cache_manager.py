@@ -0,0 +1,84 @@
+import pytest
+from panda3d import core
+
+
+@pytest.fixture
+def cache_mgr():
+    mgr = core.GeomCacheManager.get_global_ptr()
+    min_frames = core.ConfigVariableInt("geom-cache-min-frames")
+    orig = (mgr.get_max_size(), mgr.get_max_bytes(), min_frames.value)
+
+    # Let entries made during this frame be evicted, too.
+    min_frames.value = 0
+    mgr.flush()
+    yield mgr
+    mgr.flush()
+    mgr.set_max_size(orig[0])
+    mgr.set_max_bytes(orig[1])
+    min_frames.value = orig[2]
+
+
+def make_vdata(num_rows):
+    format = core.GeomVertexFormat.get_v3()
+    vdata = core.GeomVertexData("test", format, core.Geom.UH_static)
+    vdata.set_num_rows(num_rows)
+    vertex = core.GeomVertexWriter(vdata, "vertex")
+    for i in range(num_rows):
+        vertex.set_data3(i, 0, 0)
+    return vdata
+
+
+def get_double_format():
+    array = core.GeomVertexArrayFormat()
+    array.add_column("vertex", 3, core.Geom.NT_float64, core.Geom.C_point)
+    return core.GeomVertexFormat.register_format(core.GeomVertexFormat(array))
+
+
+def test_geom_cache_manager_max_bytes(cache_mgr):
+    cache_mgr.set_max_bytes(12345)
+    assert cache_mgr.get_max_bytes() == 12345
+
+    # Zero means that only the number of entries is limited.
+    cache_mgr.set_max_bytes(0)
+    assert cache_mgr.get_max_bytes() == 0
+
+
+def test_geom_cache_manager_total_bytes(cache_mgr):
+    cache_mgr.set_max_bytes(0)
+    assert cache_mgr.get_total_bytes() == 0
+
+    vdata = make_vdata(1000)
+    format = get_double_format()
+    converted = vdata.convert_to(format)
+    num_bytes = cache_mgr.get_total_bytes()
+    assert num_bytes >= 1000 * 24
+    num_entries = cache_mgr.get_total_size()
+
+    # A cache hit returns the same result, and charges nothing more.
+    assert vdata.convert_to(format).this == converted.this
+    assert cache_mgr.get_total_bytes() == num_bytes
+    assert cache_mgr.get_total_size() == num_entries
+
+    # A second conversion is a miss, and is charged separately.
+    vdata2 = make_vdata(500)
+    vdata2.convert_to(format)
+    assert cache_mgr.get_total_bytes() >= num_bytes + 500 * 24
+
+    cache_mgr.flush()
+    assert cache_mgr.get_total_bytes() == 0
+    assert cache_mgr.get_total_size() == 0
+
+
+def test_geom_cache_manager_evict_bytes(cache_mgr):
+    cache_mgr.set_max_bytes(0)
+    format = get_double_format()
+    vdata1 = make_vdata(1000)
+    vdata2 = make_vdata(1000)
+    converted1 = vdata1.convert_to(format)
+
+    # Going over the byte limit evicts the oldest result, so that converting
+    # the first data again is a miss, which makes a new result.
+    cache_mgr.set_max_bytes(1000 * 24 + 1000)
+    vdata2.convert_to(format)
+    assert cache_mgr.get_total_bytes() <= 1000 * 24 + 1000
+    assert vdata1.convert_to(format).this != converted1.this
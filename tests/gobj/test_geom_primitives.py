@@ -81,3 +81,80 @@ def test_geom_linestrips_adjacency():
         3, 4, 5, 6,
         4, 5, 6, 6,
     )
+
+
+def make_grid_triangles(size):
+    # A grid of triangles emitted in a scattered order, so that consecutive
+    # triangles rarely share vertices.
+    triangles = []
+    for y in range(size):
+        for x in range(size):
+            v = y * (size + 1) + x
+            triangles.append((v, v + 1, v + size + 1))
+            triangles.append((v + 1, v + size + 2, v + size + 1))
+    triangles = triangles[::7] + [t for i, t in enumerate(triangles) if i % 7 != 0]
+
+    prim = core.GeomTriangles(core.GeomEnums.UH_static)
+    for tri in triangles:
+        prim.add_vertices(*tri)
+    return prim
+
+
+def get_triangles(prim):
+    verts = tuple(prim.get_vertex_list())
+    return [verts[i:i + 3] for i in range(0, len(verts), 3)]
+
+
+def test_geom_triangles_optimize_vertex_cache():
+    prim = make_grid_triangles(16)
+    optimized = prim.optimize_vertex_cache(16)
+
+    # The same triangles, with their winding intact.
+    assert sorted(get_triangles(optimized)) == sorted(get_triangles(prim))
+    assert optimized.calc_acmr(16) < prim.calc_acmr(16)
+    assert optimized.calc_acmr(16) < 1.0
+
+
+def test_geom_triangles_calc_acmr():
+    prim = core.GeomTriangles(core.GeomEnums.UH_static)
+    prim.add_vertices(0, 1, 2)
+    prim.add_vertices(2, 1, 3)
+    assert prim.calc_acmr() == 2.0
+
+    strip = core.GeomTristrips(core.GeomEnums.UH_static)
+    strip.add_vertices(0, 1, 2, 3)
+    strip.close_primitive()
+    assert strip.calc_acmr() == 2.0
+
+    assert core.GeomPoints(core.GeomEnums.UH_static).calc_acmr() == 0
+
+
+def test_geom_triangles_optimize_overdraw():
+    size = 16
+    vertex_data = core.GeomVertexData("", core.GeomVertexFormat.get_v3(), core.GeomEnums.UH_static)
+    vertex = core.GeomVertexWriter(vertex_data, "vertex")
+    for y in range(size + 1):
+        for x in range(size + 1):
+            vertex.add_data3(x, y, (x - size / 2) ** 2)
+
+    prim = make_grid_triangles(size).optimize_vertex_cache()
+    optimized = prim.optimize_overdraw(vertex_data)
+    assert sorted(get_triangles(optimized)) == sorted(get_triangles(prim))
+
+
+def test_geom_triangles_simplify():
+    size = 16
+    vertex_data = core.GeomVertexData("", core.GeomVertexFormat.get_v3(), core.GeomEnums.UH_static)
+    vertex = core.GeomVertexWriter(vertex_data, "vertex")
+    for y in range(size + 1):
+        for x in range(size + 1):
+            vertex.add_data3(x, y, 0)
+
+    prim = make_grid_triangles(size)
+    simplified = prim.simplify(vertex_data, 0.25)
+    assert simplified.get_num_primitives() <= prim.get_num_primitives() // 4
+    assert simplified.get_num_primitives() > 0
+
+    # The corners of the open border can't move.
+    corners = {0, size, size * (size + 1), (size + 1) ** 2 - 1}
+    assert corners <= set(simplified.get_vertex_list())
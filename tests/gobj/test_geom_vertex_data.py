@@ -0,0 +1,328 @@
+from panda3d import core
+
+
+def make_color_data(numeric_type, contents):
+    array = core.GeomVertexArrayFormat()
+    array.add_column("vertex", 3, core.Geom.NT_float32, core.Geom.C_point)
+    array.add_column("color", 4, numeric_type, contents)
+    format = core.GeomVertexFormat.register_format(core.GeomVertexFormat(array))
+    return core.GeomVertexData("test", format, core.Geom.UH_static)
+
+
+def test_geom_vertex_data_convert_color():
+    # Enough rows to span more than one conversion batch.
+    num_rows = 200
+    vdata = make_color_data(core.Geom.NT_float32, core.Geom.C_color)
+    vdata.set_num_rows(num_rows)
+    vertex = core.GeomVertexWriter(vdata, "vertex")
+    color = core.GeomVertexWriter(vdata, "color")
+    for i in range(num_rows):
+        vertex.set_data3(i, -i, i * 0.5)
+        color.set_data4((i % 256) / 255.0, 1.0, 0.0, ((i * 7) % 256) / 255.0)
+
+    for numeric_type, contents in ((core.Geom.NT_uint8, core.Geom.C_color),
+                                   (core.Geom.NT_packed_dabc, core.Geom.C_color)):
+        packed = vdata.convert_to(make_color_data(numeric_type, contents).get_format())
+        assert packed.get_num_rows() == num_rows
+
+        back = packed.convert_to(vdata.get_format())
+        vertex = core.GeomVertexReader(back, "vertex")
+        color = core.GeomVertexReader(back, "color")
+        for i in range(num_rows):
+            assert vertex.get_data3() == (i, -i, i * 0.5)
+            assert color.get_data4().almost_equal(
+                ((i % 256) / 255.0, 1.0, 0.0, ((i * 7) % 256) / 255.0), 0.001)
+
+
+def test_geom_vertex_data_convert_last_column():
+    # A column that does not start at the beginning of the row, converted in
+    # batches through the final row.
+    num_rows = 130
+
+    def make_data(numeric_type):
+        array = core.GeomVertexArrayFormat()
+        array.add_column("vertex", 3, core.Geom.NT_float32, core.Geom.C_point)
+        array.add_column("normal", 3, numeric_type, core.Geom.C_normal)
+        format = core.GeomVertexFormat.register_format(core.GeomVertexFormat(array))
+        return core.GeomVertexData("test", format, core.Geom.UH_static)
+
+    vdata = make_data(core.Geom.NT_float32)
+    vdata.set_num_rows(num_rows)
+    normal = core.GeomVertexWriter(vdata, "normal")
+    for i in range(num_rows):
+        normal.set_data3(i, 1, -i)
+
+    wide = vdata.convert_to(make_data(core.Geom.NT_float64).get_format())
+    back = wide.convert_to(vdata.get_format())
+    for data in (wide, back):
+        assert data.get_num_rows() == num_rows
+        normal = core.GeomVertexReader(data, "normal")
+        for i in range(num_rows):
+            assert normal.get_data3() == (i, 1, -i)
+
+
+def test_geom_vertex_data_transform_float64():
+    array = core.GeomVertexArrayFormat()
+    array.add_column("vertex", 3, core.Geom.NT_float64, core.Geom.C_point)
+    format = core.GeomVertexFormat.register_format(core.GeomVertexFormat(array))
+
+    num_rows = 100
+    vdata = core.GeomVertexData("test", format, core.Geom.UH_static)
+    vdata.set_num_rows(num_rows)
+    vertex = core.GeomVertexWriter(vdata, "vertex")
+    for i in range(num_rows):
+        vertex.set_data3(i, 0, 1)
+
+    vdata.transform_vertices(core.LMatrix4.translate_mat(1, 2, 3))
+
+    vertex = core.GeomVertexReader(vdata, "vertex")
+    for i in range(num_rows):
+        assert vertex.get_data3() == (i + 1, 2, 4)
+
+
+def test_geom_vertex_data_animate_parallel():
+    # Small enough to run quickly, but split across the worker threads.
+    page = core.load_prc_file_data("", "animation-threads 2\n"
+                                       "animation-parallel-min-rows 64")
+
+    array = core.GeomVertexArrayFormat()
+    array.add_column("vertex", 3, core.Geom.NT_float32, core.Geom.C_point)
+    array.add_column("normal", 3, core.Geom.NT_float32, core.Geom.C_normal)
+    blend_array = core.GeomVertexArrayFormat()
+    blend_array.add_column("transform_blend", 1, core.Geom.NT_uint16, core.Geom.C_index)
+    format = core.GeomVertexFormat()
+    format.add_array(array)
+    format.add_array(blend_array)
+    anim = core.GeomVertexAnimationSpec()
+    anim.set_panda()
+    format.set_animation(anim)
+    format = core.GeomVertexFormat.register_format(format)
+
+    left = core.UserVertexTransform("left")
+    left.set_matrix(core.LMatrix4.translate_mat(-1, 0, 0))
+    right = core.UserVertexTransform("right")
+    right.set_matrix(core.LMatrix4.scale_mat(2) * core.LMatrix4.translate_mat(1, 0, 0))
+
+    num_rows = 1000
+    table = core.TransformBlendTable()
+    table.add_blend(core.TransformBlend(left, 1.0))
+    table.add_blend(core.TransformBlend(right, 1.0))
+    table.set_rows(core.SparseArray.lower_on(num_rows))
+
+    vdata = core.GeomVertexData("test", format, core.Geom.UH_static)
+    vdata.set_num_rows(num_rows)
+    vdata.set_transform_blend_table(table)
+    vertex = core.GeomVertexWriter(vdata, "vertex")
+    normal = core.GeomVertexWriter(vdata, "normal")
+    blend = core.GeomVertexWriter(vdata, "transform_blend")
+    for i in range(num_rows):
+        vertex.set_data3(i, 1, 0)
+        normal.set_data3(0, 0, 1)
+        # Change blends in runs of varying length.
+        blend.set_data1i((i // (i % 7 + 1)) % 2)
+
+    try:
+        animated = vdata.animate_vertices(True, core.Thread.get_current_thread())
+    finally:
+        core.unload_prc_file(page)
+
+    vertex = core.GeomVertexReader(animated, "vertex")
+    normal = core.GeomVertexReader(animated, "normal")
+    for i in range(num_rows):
+        if (i // (i % 7 + 1)) % 2 == 0:
+            assert vertex.get_data3() == (i - 1, 1, 0)
+        else:
+            assert vertex.get_data3() == (i * 2 + 1, 2, 0)
+        assert normal.get_data3().almost_equal((0, 0, 1))
+
+
+def test_geom_vertex_data_float16():
+    array = core.GeomVertexArrayFormat()
+    array.add_column("texcoord", 2, core.Geom.NT_float16, core.Geom.C_texcoord)
+    format = core.GeomVertexFormat.register_format(core.GeomVertexFormat(array))
+    vdata = core.GeomVertexData("test", format, core.Geom.UH_static)
+    assert format.get_array(0).get_stride() == 4
+
+    values = [(0, 1), (0.5, -0.25), (1.0 / 3.0, 2.0 / 3.0), (65504, -65504),
+              (1e-6, -1e-7), (70000, 1e-9)]
+    vdata.set_num_rows(len(values))
+    texcoord = core.GeomVertexWriter(vdata, "texcoord")
+    for uv in values:
+        texcoord.set_data2(uv)
+
+    texcoord = core.GeomVertexReader(vdata, "texcoord")
+    assert texcoord.get_data2() == (0, 1)
+    assert texcoord.get_data2() == (0.5, -0.25)
+    assert texcoord.get_data2().almost_equal((1.0 / 3.0, 2.0 / 3.0), 0.0005)
+    assert texcoord.get_data2() == (65504, -65504)
+    assert texcoord.get_data2().almost_equal((1e-6, -1e-7), 1e-7)
+    uv = texcoord.get_data2()
+    assert uv[0] == float("inf")
+    assert uv[1] == 0
+
+
+def test_geom_vertex_data_octahedral_normals():
+    array = core.GeomVertexArrayFormat()
+    array.add_column("normal", 2, core.Geom.NT_int16, core.Geom.C_octahedral_normal)
+    format = core.GeomVertexFormat.register_format(core.GeomVertexFormat(array))
+    vdata = core.GeomVertexData("test", format, core.Geom.UH_static)
+    assert format.get_array(0).get_stride() == 4
+
+    normals = [core.LVector3(0, 0, 1), core.LVector3(0, 0, -1),
+               core.LVector3(1, 0, 0), core.LVector3(0, -1, 0),
+               core.LVector3(1, 2, -3).normalized(),
+               core.LVector3(-4, 0.5, 0.25).normalized()]
+    vdata.set_num_rows(len(normals))
+    normal = core.GeomVertexWriter(vdata, "normal")
+    for n in normals:
+        normal.set_data3(n)
+
+    normal = core.GeomVertexReader(vdata, "normal")
+    for n in normals:
+        assert normal.get_data3().almost_equal(n, 0.0005)
+
+
+def test_geom_vertex_data_int16_vector():
+    # An ordinary two-component int16 vector column is not octahedral.
+    array = core.GeomVertexArrayFormat()
+    array.add_column("tangent", 2, core.Geom.NT_int16, core.Geom.C_vector)
+    format = core.GeomVertexFormat.register_format(core.GeomVertexFormat(array))
+    vdata = core.GeomVertexData("test", format, core.Geom.UH_static)
+    vdata.set_num_rows(2)
+    tangent = core.GeomVertexWriter(vdata, "tangent")
+    tangent.set_data2i(100, -200)
+    tangent.set_data2i(32767, 0)
+
+    tangent = core.GeomVertexReader(vdata, "tangent")
+    assert tangent.get_data2i() == (100, -200)
+    assert tangent.get_data2i() == (32767, 0)
+
+
+def write_read_bam(tmp_path, obj, version):
+    filename = core.Filename.from_os_specific(str(tmp_path / "test.bam"))
+    page = core.load_prc_file_data("", "bam-version " + version)
+    try:
+        bam = core.BamFile()
+        assert bam.open_write(filename)
+        assert bam.write_object(obj)
+        bam.close()
+    finally:
+        core.unload_prc_file(page)
+
+    bam = core.BamFile()
+    assert bam.open_read(filename)
+    obj = bam.read_object()
+    assert bam.resolve()
+    bam.close()
+    return obj
+
+
+def test_geom_vertex_data_compressed_bam(tmp_path):
+    array = core.GeomVertexArrayFormat()
+    array.add_column("normal", 2, core.Geom.NT_int16, core.Geom.C_octahedral_normal)
+    array.add_column("texcoord", 2, core.Geom.NT_float16, core.Geom.C_texcoord)
+    format = core.GeomVertexFormat.register_format(core.GeomVertexFormat(array))
+    vdata = core.GeomVertexData("test", format, core.Geom.UH_static)
+    vdata.set_num_rows(1)
+    core.GeomVertexWriter(vdata, "normal").set_data3(0, 1, 0)
+    core.GeomVertexWriter(vdata, "texcoord").set_data2(0.5, 0.25)
+
+    # These need bam 6.47 to be stored as they are.
+    vdata2 = write_read_bam(tmp_path, vdata, "6 47")
+    assert vdata2.format == vdata.format
+    assert core.GeomVertexReader(vdata2, "normal").get_data3().almost_equal((0, 1, 0), 0.0005)
+    assert core.GeomVertexReader(vdata2, "texcoord").get_data2() == (0.5, 0.25)
+
+    # An older version can't describe them, so they are stored as plain
+    # integers, which an older reader can load without misreading them.
+    vdata2 = write_read_bam(tmp_path, vdata, "6 44")
+    normal = vdata2.format.get_column("normal")
+    assert normal.get_numeric_type() == core.Geom.NT_int16
+    assert normal.get_contents() == core.Geom.C_other
+    texcoord = vdata2.format.get_column("texcoord")
+    assert texcoord.get_numeric_type() == core.Geom.NT_uint16
+    assert texcoord.get_contents() == core.Geom.C_other
+
+
+def test_geom_vertex_data_aligned_bam(tmp_path):
+    array = core.GeomVertexArrayFormat()
+    array.add_column("vertex", 3, core.Geom.NT_float32, core.Geom.C_point)
+    format = core.GeomVertexFormat.register_format(core.GeomVertexFormat(array))
+    vdata = core.GeomVertexData("test", format, core.Geom.UH_static)
+    num_rows = 1000
+    vdata.set_num_rows(num_rows)
+    vertex = core.GeomVertexWriter(vdata, "vertex")
+    for i in range(num_rows):
+        vertex.set_data3(i, -i, i * 0.5)
+
+    filename = core.Filename.from_os_specific(str(tmp_path / "aligned.bam"))
+    page = core.load_prc_file_data("", "bam-version 6 46\n"
+                                       "bam-vertex-data-alignment 4096")
+    try:
+        bam = core.BamFile()
+        assert bam.open_write(filename)
+        assert bam.write_object(vdata)
+        bam.close()
+    finally:
+        core.unload_prc_file(page)
+
+    bam = core.BamFile()
+    assert bam.open_read(filename)
+    assert bam.get_file_minor_ver() == 46
+    vdata = bam.read_object()
+    assert bam.resolve()
+    bam.close()
+
+    vertex = core.GeomVertexReader(vdata, "vertex")
+    for i in range(num_rows):
+        assert vertex.get_data3() == (i, -i, i * 0.5)
+
+    # Modifying the data must not write through to the file.
+    vertex = core.GeomVertexWriter(vdata, "vertex")
+    vertex.set_data3(1, 2, 3)
+    assert core.GeomVertexReader(vdata, "vertex").get_data3() == (1, 2, 3)
+
+
+def test_geom_vertex_data_aligned_bam_replaced(tmp_path):
+    import os
+
+    def write_aligned(path, value):
+        array = core.GeomVertexArrayFormat()
+        array.add_column("vertex", 3, core.Geom.NT_float32, core.Geom.C_point)
+        format = core.GeomVertexFormat.register_format(core.GeomVertexFormat(array))
+        vdata = core.GeomVertexData("test", format, core.Geom.UH_static)
+        vdata.set_num_rows(1000)
+        vertex = core.GeomVertexWriter(vdata, "vertex")
+        for i in range(1000):
+            vertex.set_data3(value, i, 0)
+
+        page = core.load_prc_file_data("", "bam-version 6 46\n"
+                                           "bam-vertex-data-alignment 4096")
+        try:
+            bam = core.BamFile()
+            assert bam.open_write(core.Filename.from_os_specific(path))
+            assert bam.write_object(vdata)
+            bam.close()
+        finally:
+            core.unload_prc_file(page)
+
+    def read(path):
+        bam = core.BamFile()
+        assert bam.open_read(core.Filename.from_os_specific(path))
+        vdata = bam.read_object()
+        assert bam.resolve()
+        bam.close()
+        return vdata
+
+    path = str(tmp_path / "model.bam")
+    write_aligned(path, 1)
+    old = read(path)
+
+    # Replacing the file while the old model is alive must not hand the new
+    # load the old mapping.
+    write_aligned(str(tmp_path / "new.bam"), 2)
+    os.replace(str(tmp_path / "new.bam"), path)
+    new = read(path)
+
+    assert core.GeomVertexReader(old, "vertex").get_data3() == (1, 0, 0)
+    assert core.GeomVertexReader(new, "vertex").get_data3() == (2, 0, 0)
@@ -0,0 +1,129 @@
+import pytest
+import math
+import random
+from panda3d import core
+
+
+def test_vertex_data_page_prefetch():
+    page = core.load_prc_file_data("", "vertex-data-page-threads 0\n"
+                                       "max-compressed-vertex-data -1")
+    try:
+        book = core.VertexDataBook(1024)
+        block = book.alloc(4096)
+        data_page = block.get_page()
+
+        core.VertexDataPage.reset_latency_counts()
+        assert data_page.request_prefetch()
+
+        # Without paging threads, this writes the page to disk right away.
+        data_page.evict_lru()
+        assert data_page.get_ram_class() != core.VertexDataPage.RC_resident
+
+        # It is paged back in synchronously, too.
+        assert data_page.request_prefetch()
+        assert data_page.get_ram_class() == core.VertexDataPage.RC_resident
+
+        num_buckets = core.VertexDataPage.get_num_latency_buckets()
+        counts = [core.VertexDataPage.get_latency_count(i) for i in range(num_buckets)]
+        assert sum(counts) == 1
+
+        limits = [core.VertexDataPage.get_latency_bucket_limit(i) for i in range(num_buckets)]
+        assert limits == sorted(limits)
+    finally:
+        core.unload_prc_file(page)
+
+
+@pytest.mark.parametrize("algorithm", ["zlib", "lz4", "zstd"])
+def test_vertex_data_page_compression(algorithm):
+    if not core.is_compression_algorithm_available(getattr(core, "CA_" + algorithm)):
+        pytest.skip("compression algorithm not available")
+
+    page = core.load_prc_file_data("", "vertex-data-page-threads 0\n"
+                                       "vertex-data-compression-algorithm " + algorithm)
+
+    # The limit is read from max-compressed-vertex-data only at startup.
+    compressed_lru = core.VertexDataPage.get_global_lru(core.VertexDataPage.RC_compressed)
+    max_size = compressed_lru.get_max_size()
+    compressed_lru.set_max_size(64 * 1024 * 1024)
+    try:
+        vdata = core.GeomVertexData("test", core.GeomVertexFormat.get_v3n3(), core.Geom.UH_static)
+        num_rows = 2000
+        vdata.set_num_rows(num_rows)
+        vertex = core.GeomVertexWriter(vdata, "vertex")
+        for i in range(num_rows):
+            vertex.set_data3(i % 50, i // 50, 0)
+
+        # Move the data into a page, then compress all of the pages.
+        core.GeomVertexArrayData.get_independent_lru().evict_to(0)
+        core.GeomVertexArrayData.get_small_lru().evict_to(0)
+        compressed_size = compressed_lru.get_total_size()
+        core.VertexDataPage.get_global_lru(core.VertexDataPage.RC_resident).evict_to(0)
+        assert compressed_lru.get_total_size() > compressed_size
+
+        # Reading the data brings it back.
+        vertex = core.GeomVertexReader(vdata, "vertex")
+        for i in range(num_rows):
+            assert vertex.get_data3() == (i % 50, i // 50, 0)
+    finally:
+        compressed_lru.set_max_size(max_size)
+        core.unload_prc_file(page)
+
+
+def make_terrain_array(num_rows):
+    # A regular grid of vertices, as in a terrain.
+    vdata = core.GeomVertexData("terrain", core.GeomVertexFormat.get_v3n3t2(), core.Geom.UH_static)
+    vdata.set_num_rows(num_rows)
+    vertex = core.GeomVertexWriter(vdata, "vertex")
+    normal = core.GeomVertexWriter(vdata, "normal")
+    texcoord = core.GeomVertexWriter(vdata, "texcoord")
+    for i in range(num_rows):
+        x = i % 128
+        y = i // 128
+        vertex.set_data3(x, y, math.sin(x * 0.1) * math.cos(y * 0.13) * 4)
+        normal.set_data3(core.Vec3(-0.4 * math.cos(x * 0.1), 0.52 * math.sin(y * 0.13), 1).normalized())
+        texcoord.set_data2(x / 128.0, y / 128.0)
+    return vdata.get_array(0)
+
+
+def make_organic_array(num_rows):
+    # Vertices scattered over a sphere, as in a character model.
+    rand = random.Random(42)
+    vdata = core.GeomVertexData("organic", core.GeomVertexFormat.get_v3n3c4t2(), core.Geom.UH_static)
+    vdata.set_num_rows(num_rows)
+    vertex = core.GeomVertexWriter(vdata, "vertex")
+    normal = core.GeomVertexWriter(vdata, "normal")
+    color = core.GeomVertexWriter(vdata, "color")
+    texcoord = core.GeomVertexWriter(vdata, "texcoord")
+    for i in range(num_rows):
+        n = core.Vec3(rand.uniform(-1, 1), rand.uniform(-1, 1), rand.uniform(-1, 1)).normalized()
+        vertex.set_data3(n * rand.uniform(1, 1.05))
+        normal.set_data3(n)
+        color.set_data4(0.8, 0.6, 0.5, 1)
+        texcoord.set_data2(rand.random(), rand.random())
+    return vdata.get_array(0)
+
+
+def make_index_array(num_rows):
+    # The 16-bit indices of the triangles of a grid.
+    tris = core.GeomTriangles(core.Geom.UH_static)
+    tris.set_index_type(core.Geom.NT_uint16)
+    for i in range(num_rows // 6):
+        v = (i // 127) % 127 * 128 + i % 127
+        tris.add_vertices(v, v + 1, v + 128)
+        tris.add_vertices(v + 1, v + 129, v + 128)
+    return tris.get_vertices()
+
+
+@pytest.mark.parametrize("algorithm", ["zlib", "lz4", "zstd"])
+@pytest.mark.parametrize("make_array", [make_terrain_array, make_organic_array, make_index_array])
+def test_vertex_data_page_compress_buffer(algorithm, make_array):
+    # A page's worth of typical vertex or index data survives a round trip at
+    # the default vertex-data-compression-level.
+    algorithm = getattr(core, "CA_" + algorithm)
+    if not core.is_compression_algorithm_available(algorithm):
+        pytest.skip("compression algorithm not available")
+
+    data = make_array(8192).get_handle().get_data()
+    compressed = core.compress_buffer(algorithm, data, 1)
+    assert 0 < len(compressed) < len(data)
+    assert core.decompress_buffer(algorithm, compressed, len(data)) == data
@@ -0,0 +1,159 @@
+from panda3d import core
+
+
+def make_texture(name, size, value):
+    tex = core.Texture(name)
+    tex.setup_2d_texture(size, size, core.Texture.T_unsigned_byte, core.Texture.F_rgb)
+    tex.set_ram_image(bytes([value]) * (size * size * 3))
+    return tex
+
+
+def make_card(tex):
+    vdata = core.GeomVertexData("card", core.GeomVertexFormat.get_v3t2(), core.Geom.UH_static)
+    vertex = core.GeomVertexWriter(vdata, "vertex")
+    texcoord = core.GeomVertexWriter(vdata, "texcoord")
+    for x, z in ((0, 0), (1, 0), (1, 1), (0, 1)):
+        vertex.add_data3(x, 0, z)
+        texcoord.add_data2(x, z)
+
+    tris = core.GeomTriangles(core.Geom.UH_static)
+    tris.add_vertices(0, 1, 2)
+    tris.add_vertices(0, 2, 3)
+    geom = core.Geom(vdata)
+    geom.add_primitive(tris)
+
+    node = core.GeomNode("card")
+    node.add_geom(geom, core.RenderState.make(core.TextureAttrib.make(tex)))
+    return node
+
+
+def make_scene(textures):
+    root = core.NodePath("root")
+    nodes = [root.attach_new_node(make_card(tex)).node() for tex in textures]
+    return root, nodes
+
+
+def get_texture(node):
+    attrib = node.get_geom_state(0).get_attrib(core.TextureAttrib)
+    assert attrib.get_num_on_stages() == 1
+    return attrib.get_on_texture(attrib.get_on_stage(0))
+
+
+def get_layer(node):
+    attrib = node.get_geom_state(0).get_attrib(core.ShaderAttrib)
+    name = core.TextureArrayReducer.get_layer_input_name()
+    return int(attrib.get_shader_input(name).get_vector()[0])
+
+
+def get_page(array, layer):
+    page_size = array.get_ram_page_size()
+    return array.get_ram_image().get_data()[page_size * layer:page_size * (layer + 1)]
+
+
+def test_texture_array_reducer_flatten():
+    textures = [make_texture("tex%d" % i, 4, i * 10) for i in range(3)]
+    # This one has a different size, so there is nothing to pack it with.
+    lonely = make_texture("lonely", 8, 99)
+    root, nodes = make_scene(textures + [lonely])
+
+    reducer = core.TextureArrayReducer()
+    reducer.scan(root)
+    assert reducer.flatten() == 3
+    assert reducer.get_num_textures() == 3
+    assert reducer.get_num_arrays() == 1
+
+    array = reducer.get_array(0)
+    assert array.get_texture_type() == core.Texture.TT_2d_texture_array
+    assert array.get_x_size() == 4
+    assert array.get_y_size() == 4
+    assert array.get_z_size() == 3
+
+    # Each Geom now samples its own layer of the array, which holds a copy of
+    # the original image.
+    layers = set()
+    for tex, node in zip(textures, nodes):
+        assert get_texture(node) == array
+        layer = get_layer(node)
+        layers.add(layer)
+        assert get_page(array, layer) == tex.get_ram_image().get_data()
+    assert layers == {0, 1, 2}
+
+    # The texture that was left alone is still bound normally.
+    assert get_texture(nodes[3]) == lonely
+    assert not nodes[3].get_geom_state(0).has_attrib(core.ShaderAttrib)
+
+
+def test_texture_array_reducer_shared_texture():
+    # Two Geoms with the same texture end up in the same layer.
+    textures = [make_texture("tex%d" % i, 4, i * 10) for i in range(2)]
+    root, nodes = make_scene(textures + [textures[0]])
+
+    reducer = core.TextureArrayReducer()
+    reducer.scan(root)
+    assert reducer.flatten() == 3
+    assert reducer.get_num_textures() == 2
+    assert get_layer(nodes[0]) == get_layer(nodes[2])
+    assert get_layer(nodes[0]) != get_layer(nodes[1])
+
+
+def test_texture_array_reducer_max_layers():
+    textures = [make_texture("tex%d" % i, 4, i * 10) for i in range(5)]
+    root, nodes = make_scene(textures)
+
+    reducer = core.TextureArrayReducer()
+    reducer.set_max_layers(2)
+    assert reducer.get_max_layers() == 2
+    reducer.scan(root)
+    assert reducer.flatten() == 5
+    assert reducer.get_num_textures() == 5
+    assert reducer.get_num_arrays() == 3
+    assert sorted(array.get_z_size() for array in reducer.get_arrays()) == [1, 2, 2]
+
+    # Every texture is in exactly one layer of one of the arrays.
+    seen = set()
+    for tex, node in zip(textures, nodes):
+        array = get_texture(node)
+        assert array in reducer.get_arrays()
+        layer = get_layer(node)
+        assert layer < array.get_z_size()
+        assert get_page(array, layer) == tex.get_ram_image().get_data()
+        seen.add((reducer.get_arrays().index(array), layer))
+    assert len(seen) == 5
+
+
+def test_texture_array_reducer_layer_in_texcoord():
+    textures = [make_texture("tex%d" % i, 4, i * 10) for i in range(3)]
+    root, nodes = make_scene(textures)
+
+    reducer = core.TextureArrayReducer()
+    reducer.set_layer_in_texcoord(True)
+    assert reducer.get_layer_in_texcoord()
+    reducer.scan(root)
+    assert reducer.flatten() == 3
+    array = reducer.get_array(0)
+
+    # The layer is stored in a third texture coordinate, rather than in a
+    # shader input, so the Geoms all have the same state.
+    states = set()
+    layers = set()
+    for tex, node in zip(textures, nodes):
+        state = node.get_geom_state(0)
+        assert not state.has_attrib(core.ShaderAttrib)
+        assert get_texture(node) == array
+        states.add(state)
+
+        vdata = node.get_geom(0).get_vertex_data()
+        assert vdata.get_format().get_column("texcoord").get_num_components() == 3
+        texcoord = core.GeomVertexReader(vdata, "texcoord")
+        uvw = set()
+        while not texcoord.is_at_end():
+            u, v, w = texcoord.get_data3()
+            assert 0 <= u <= 1 and 0 <= v <= 1
+            uvw.add(w)
+        assert len(uvw) == 1
+        layer = int(uvw.pop())
+        layers.add(layer)
+        assert get_page(array, layer) == tex.get_ram_image().get_data()
+
+    assert len(states) == 1
+    assert layers == {0, 1, 2}
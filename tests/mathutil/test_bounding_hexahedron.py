@@ -0,0 +1,73 @@
+from panda3d.core import BoundingHexahedron, BoundingSphere, BoundingBox, BoundingVolume
+from panda3d.core import LFrustum, TransformState, Point3, Vec3
+from panda3d.core import PTA_LVecBase3, PTA_LVecBase4
+import pytest
+import random
+
+
+def make_frustum(rand, is_ortho):
+    # A perspective or orthographic frustum, moved and rotated at random.
+    frustum = LFrustum()
+    if is_ortho:
+        frustum.make_ortho(1, 50, -10, 10, -5, 5)
+    else:
+        frustum.make_perspective_hfov(60, 1.5, 1, 50)
+    hexahedron = BoundingHexahedron(frustum, is_ortho)
+
+    pos = (rand.uniform(-5, 5), rand.uniform(-5, 5), rand.uniform(-5, 5))
+    hpr = (rand.uniform(0, 360), rand.uniform(-45, 45), rand.uniform(0, 360))
+    hexahedron.xform(TransformState.make_pos_hpr(pos, hpr).get_mat())
+    return hexahedron
+
+
+def make_volumes(rand, num_volumes):
+    # Spheres and boxes in and around the frustum; some of them are very
+    # large, enclosing it entirely.
+    volumes = []
+    for i in range(num_volumes):
+        center = Point3(rand.uniform(-40, 40), rand.uniform(-40, 40), rand.uniform(-40, 40))
+        size = rand.uniform(0, 8)
+        if i % 7 == 0:
+            size *= 20
+        volumes.append((center, size))
+    return volumes
+
+
+def test_hexahedron_contains_spheres_empty():
+    hexahedron = make_frustum(random.Random(1), False)
+    assert hexahedron.contains_spheres(PTA_LVecBase4()) == b''
+    assert hexahedron.contains_boxes(PTA_LVecBase3(), PTA_LVecBase3()) == b''
+
+
+@pytest.mark.parametrize("is_ortho", [False, True])
+def test_hexahedron_contains_spheres(is_ortho):
+    # Every batch size up to a few times the SIMD width, to cover the spheres
+    # left over at the end of a batch, and then one large batch.
+    rand = random.Random(42)
+    for f in range(10):
+        hexahedron = make_frustum(rand, is_ortho)
+        for num_spheres in list(range(1, 40)) + [1000]:
+            volumes = make_volumes(rand, num_spheres)
+            spheres = PTA_LVecBase4([(c[0], c[1], c[2], size) for c, size in volumes])
+
+            results = hexahedron.contains_spheres(spheres)
+            assert len(results) == num_spheres
+            for result, (center, size) in zip(results, volumes):
+                assert result == hexahedron.contains(BoundingSphere(center, size))
+
+
+@pytest.mark.parametrize("is_ortho", [False, True])
+def test_hexahedron_contains_boxes(is_ortho):
+    rand = random.Random(42)
+    for f in range(10):
+        hexahedron = make_frustum(rand, is_ortho)
+        for num_boxes in list(range(1, 40)) + [1000]:
+            volumes = make_volumes(rand, num_boxes)
+            min_points = PTA_LVecBase3([center - Vec3(size * 0.5) for center, size in volumes])
+            max_points = PTA_LVecBase3([center + Vec3(size) for center, size in volumes])
+
+            results = hexahedron.contains_boxes(min_points, max_points)
+            assert len(results) == num_boxes
+            for i, result in enumerate(results):
+                box = BoundingBox(min_points[i], max_points[i])
+                assert result == hexahedron.contains(box)
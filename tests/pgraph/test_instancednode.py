@@ -0,0 +1,46 @@
+from panda3d import core
+
+
+def test_instancednode_instances():
+    node = core.InstancedNode("instanced")
+    assert node.get_num_instances() == 0
+
+    ts1 = core.TransformState.make_pos((1, 2, 3))
+    ts2 = core.TransformState.make_pos((4, 5, 6))
+    assert node.add_instance(ts1) == 0
+    assert node.add_instance(ts2) == 1
+    assert node.get_num_instances() == 2
+    assert node.get_instance_transform(0) == ts1
+    assert node.get_instance_transform(1) == ts2
+
+    node.set_instance_transform(0, ts2)
+    assert node.get_instance_transform(0) == ts2
+
+    node.remove_instance(0)
+    assert node.get_num_instances() == 1
+    assert node.get_instance_transform(0) == ts2
+
+    node.clear_instances()
+    assert node.get_num_instances() == 0
+
+
+def test_instancednode_bounds():
+    node = core.InstancedNode("instanced")
+    child = core.PandaNode("child")
+    child.set_bounds(core.BoundingSphere((0, 0, 0), 1))
+    node.add_child(child)
+
+    # With no instances, nothing is rendered.
+    assert node.get_bounds().is_empty()
+
+    node.add_instance(core.TransformState.make_pos((-10, 0, 0)))
+    node.add_instance(core.TransformState.make_pos((10, 0, 0)))
+    bounds = node.get_bounds()
+    assert bounds.contains((-10, 0, 0))
+    assert bounds.contains((10, 0, 0))
+    assert bounds.contains((-10.5, 0, 0))
+    assert bounds.contains((10.5, 0, 0))
+
+    # The copy made by copy_subgraph shares the instances.
+    copy = core.NodePath(node).copy_to(core.NodePath()).node()
+    assert copy.get_num_instances() == 2
@@ -0,0 +1,113 @@
+import pytest
+from panda3d.core import TransformState, RenderState, ColorAttrib
+from panda3d.core import ConfigVariableBool, ConfigVariableDouble
+
+
+@pytest.fixture
+def gc_config():
+    enabled = ConfigVariableBool("garbage-collect-states")
+    rate = ConfigVariableDouble("garbage-collect-states-rate")
+    budget = ConfigVariableDouble("garbage-collect-states-budget")
+    orig = (enabled.value, rate.value, budget.value)
+    enabled.value = True
+    yield rate, budget
+    enabled.value, rate.value, budget.value = orig
+
+
+def make_transforms(first, count):
+    return [TransformState.make_pos((first + 0.5, i, 0)) for i in range(count)]
+
+
+def make_states(first, count):
+    return [RenderState.make(ColorAttrib.make_flat((first / 10000.0, i / 1000.0, 0, 1)))
+            for i in range(count)]
+
+
+@pytest.mark.parametrize("cls,make", [(TransformState, make_transforms),
+                                      (RenderState, make_states)])
+def test_garbage_collect_young(gc_config, cls, make):
+    rate, budget = gc_config
+
+    # Flush out what the earlier tests left behind.
+    cls.garbage_collect()
+    cls.garbage_collect()
+
+    # With the rate at zero, the old generation is not walked at all, but
+    # newly made states are still collected once they are no longer in use.
+    rate.value = 0.0
+    states = make(1001, 100)
+    num_states = cls.get_num_states()
+    del states
+    assert cls.garbage_collect() >= 100
+    assert cls.get_num_states() <= num_states - 100
+    assert cls.validate_states()
+
+    # A state that survived a cycle is old, and is left alone.
+    kept = make(1002, 10)
+    cls.garbage_collect()
+    num_states = cls.get_num_states()
+    del kept
+    assert cls.garbage_collect() == 0
+    assert cls.get_num_states() == num_states
+    assert cls.validate_states()
+
+    # Until the old generation is walked again.
+    rate.value = 1.0
+    total = 0
+    for i in range(5):
+        total += cls.garbage_collect()
+    assert total >= 10
+    assert cls.get_num_states() <= num_states - 10
+    assert cls.validate_states()
+
+
+@pytest.mark.parametrize("cls,make", [(TransformState, make_transforms),
+                                      (RenderState, make_states)])
+def test_garbage_collect_young_released(gc_config, cls, make):
+    # Releasing young states, and making the same states again before the
+    # next cycle, must leave the young generation consistent.
+    states = make(1003, 50)
+    del states
+    cls.garbage_collect()
+    assert cls.validate_states()
+
+    states = make(1003, 50)
+    other = make(1004, 50)
+    composed = [a.compose(b) for a, b in zip(states, other)]
+    del states
+    del composed
+    cls.garbage_collect()
+    assert cls.validate_states()
+
+    del other
+    cls.garbage_collect()
+    cls.garbage_collect()
+    assert cls.validate_states()
+
+
+@pytest.mark.parametrize("cls,make", [(TransformState, make_transforms),
+                                      (RenderState, make_states)])
+def test_garbage_collect_budget(gc_config, cls, make):
+    rate, budget = gc_config
+    cls.garbage_collect()
+    cls.garbage_collect()
+
+    states = make(1005, 1000)
+    num_states = cls.get_num_states()
+    del states
+
+    # A tiny budget stops each cycle early; later cycles resume the work.
+    budget.value = 1e-9
+    first = cls.garbage_collect()
+    assert 0 < first < 1000
+    assert cls.validate_states()
+
+    total = first
+    for i in range(1000):
+        collected = cls.garbage_collect()
+        total += collected
+        if collected == 0 and cls.get_num_states() <= num_states - 1000:
+            break
+    assert total >= 1000
+    assert cls.get_num_states() <= num_states - 1000
+    assert cls.validate_states()